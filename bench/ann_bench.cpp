@@ -0,0 +1,409 @@
+// CPU benchmark harness: one dataset x one index configuration per process, so peak RSS is
+// attributable to that configuration. Every measurement is printed as one JSON object per line
+// (dataset, engine, options, metric, param, param_value, value), so two runs diff line by line.
+//
+//   ann_bench base=sift/sift_base.fvecs query=sift/sift_query.fvecs [gt=sift/sift_groundtruth.ivecs]
+//             dataset=sift1m engine=DISKANN [options="quantization = 'sq8'"] [sweep=16,32,64,128]
+//             [k=10] [nq=1000] [limit=0] [threads=0]
+//
+// base/query are .fvecs or .bvecs, gt is .ivecs (TEXMEX layout). Without gt, or when limit
+// truncates the base set, ground truth is computed by brute force. sweep lists search_complexity
+// values for DISKANN and nprobe values for FAISS; without it one pass runs with the index defaults.
+
+#include "duckdb.hpp"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <queue>
+#include <stdexcept>
+#include <thread>
+
+namespace duckdb {
+
+using BenchClock = std::chrono::steady_clock;
+
+struct BenchArgs {
+	string base;
+	string query;
+	string gt;
+	string dataset;
+	string engine = "DISKANN";
+	string options;
+	vector<int32_t> sweep;
+	int32_t k = 10;
+	idx_t nq = 1000;
+	idx_t limit = 0;
+	idx_t threads = 0;
+};
+
+struct VectorSet {
+	idx_t count = 0;
+	idx_t dim = 0;
+	vector<float> data;
+};
+
+// ========================================
+// Dataset readers (TEXMEX .fvecs / .bvecs / .ivecs)
+// ========================================
+// Each record is an int32 dimension followed by dim components of float, uint8 or int32.
+
+static bool EndsWith(const string &str, const string &suffix) {
+	return str.size() >= suffix.size() && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+static VectorSet ReadVectors(const string &path, idx_t limit) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		throw std::runtime_error("cannot open " + path);
+	}
+	bool bytes = EndsWith(path, ".bvecs");
+	VectorSet set;
+	vector<uint8_t> byte_row;
+	int32_t dim = 0;
+	while ((limit == 0 || set.count < limit) && in.read(reinterpret_cast<char *>(&dim), sizeof(dim))) {
+		if (set.dim == 0) {
+			set.dim = static_cast<idx_t>(dim);
+		} else if (static_cast<idx_t>(dim) != set.dim) {
+			throw std::runtime_error(path + ": mixed dimensions");
+		}
+		auto offset = set.data.size();
+		set.data.resize(offset + set.dim);
+		if (bytes) {
+			byte_row.resize(set.dim);
+			in.read(reinterpret_cast<char *>(byte_row.data()), static_cast<std::streamsize>(set.dim));
+			std::copy(byte_row.begin(), byte_row.end(), set.data.begin() + static_cast<int64_t>(offset));
+		} else {
+			in.read(reinterpret_cast<char *>(set.data.data() + offset),
+			        static_cast<std::streamsize>(set.dim * sizeof(float)));
+		}
+		if (!in) {
+			throw std::runtime_error(path + ": truncated record");
+		}
+		set.count++;
+	}
+	return set;
+}
+
+static vector<vector<int32_t>> ReadGroundTruth(const string &path, idx_t nq, int32_t k) {
+	std::ifstream in(path, std::ios::binary);
+	if (!in) {
+		throw std::runtime_error("cannot open " + path);
+	}
+	vector<vector<int32_t>> truth;
+	int32_t dim = 0;
+	while (truth.size() < nq && in.read(reinterpret_cast<char *>(&dim), sizeof(dim))) {
+		vector<int32_t> row(static_cast<idx_t>(dim));
+		in.read(reinterpret_cast<char *>(row.data()), static_cast<std::streamsize>(row.size() * sizeof(int32_t)));
+		if (dim < k) {
+			throw std::runtime_error(path + ": ground truth has fewer than k neighbors");
+		}
+		row.resize(static_cast<idx_t>(k));
+		truth.push_back(std::move(row));
+	}
+	return truth;
+}
+
+// Exact L2 top-k of every query, split across hardware threads
+static vector<vector<int32_t>> BruteForce(const VectorSet &base, const VectorSet &queries, int32_t k) {
+	vector<vector<int32_t>> truth(queries.count);
+	auto worker = [&](idx_t begin, idx_t end) {
+		for (idx_t qi = begin; qi < end; qi++) {
+			auto query = queries.data.data() + qi * queries.dim;
+			std::priority_queue<pair<float, int32_t>> heap;
+			for (idx_t i = 0; i < base.count; i++) {
+				auto row = base.data.data() + i * base.dim;
+				float dist = 0;
+				for (idx_t d = 0; d < base.dim; d++) {
+					auto diff = row[d] - query[d];
+					dist += diff * diff;
+				}
+				if (heap.size() < static_cast<idx_t>(k)) {
+					heap.emplace(dist, static_cast<int32_t>(i));
+				} else if (dist < heap.top().first) {
+					heap.pop();
+					heap.emplace(dist, static_cast<int32_t>(i));
+				}
+			}
+			truth[qi].resize(heap.size());
+			for (auto pos = heap.size(); pos > 0; pos--) {
+				truth[qi][pos - 1] = heap.top().second;
+				heap.pop();
+			}
+		}
+	};
+	auto thread_count = MaxValue<idx_t>(1, std::thread::hardware_concurrency());
+	vector<std::thread> workers;
+	for (idx_t t = 0; t < thread_count; t++) {
+		workers.emplace_back(worker, queries.count * t / thread_count, queries.count * (t + 1) / thread_count);
+	}
+	for (auto &thread : workers) {
+		thread.join();
+	}
+	return truth;
+}
+
+// ========================================
+// Output
+// ========================================
+
+static string JsonEscape(const string &str) {
+	string result;
+	for (auto c : str) {
+		if (c == '"' || c == '\\') {
+			result += '\\';
+		}
+		result += c;
+	}
+	return result;
+}
+
+static void Emit(const BenchArgs &args, const string &metric, double value, const string &param = "",
+                 int32_t param_value = 0) {
+	std::printf("{\"dataset\":\"%s\",\"engine\":\"%s\",\"options\":\"%s\",\"metric\":\"%s\",\"param\":\"%s\","
+	            "\"param_value\":%d,\"value\":%.6g}\n",
+	            JsonEscape(args.dataset).c_str(), JsonEscape(args.engine).c_str(), JsonEscape(args.options).c_str(),
+	            metric.c_str(), param.c_str(), param_value, value);
+	std::fflush(stdout);
+}
+
+static double PeakRssBytes() {
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+	return static_cast<double>(usage.ru_maxrss);
+#else
+	return static_cast<double>(usage.ru_maxrss) * 1024.0;
+#endif
+}
+
+static double SecondsSince(BenchClock::time_point start) {
+	return std::chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+static double Percentile(vector<double> samples, double fraction) {
+	if (samples.empty()) {
+		return 0;
+	}
+	std::sort(samples.begin(), samples.end());
+	auto pos = static_cast<idx_t>(fraction * static_cast<double>(samples.size() - 1) + 0.5);
+	return samples[pos];
+}
+
+// ========================================
+// Benchmark steps
+// ========================================
+
+static unique_ptr<MaterializedQueryResult> Run(Connection &con, const string &sql) {
+	auto result = con.Query(sql);
+	if (result->HasError()) {
+		throw std::runtime_error(result->GetError() + "\n  in: " + sql.substr(0, 200));
+	}
+	return result;
+}
+
+// (id INTEGER, embedding FLOAT[dim]) appended a vector's worth at a time
+static void LoadTable(Connection &con, const string &table, const VectorSet &set) {
+	Run(con, StringUtil::Format("CREATE TABLE %s (id INTEGER, embedding FLOAT[%llu])", table, set.dim));
+	Appender appender(con, table);
+	DataChunk chunk;
+	chunk.Initialize(Allocator::DefaultAllocator(),
+	                 {LogicalType::INTEGER, LogicalType::ARRAY(LogicalType::FLOAT, set.dim)});
+	for (idx_t offset = 0; offset < set.count; offset += STANDARD_VECTOR_SIZE) {
+		auto count = MinValue<idx_t>(STANDARD_VECTOR_SIZE, set.count - offset);
+		chunk.Reset();
+		auto ids = FlatVector::GetData<int32_t>(chunk.data[0]);
+		for (idx_t i = 0; i < count; i++) {
+			ids[i] = static_cast<int32_t>(offset + i);
+		}
+		auto &child = ArrayVector::GetEntry(chunk.data[1]);
+		std::memcpy(FlatVector::GetData<float>(child), set.data.data() + offset * set.dim,
+		            count * set.dim * sizeof(float));
+		chunk.SetCardinality(count);
+		appender.AppendDataChunk(chunk);
+	}
+	appender.Close();
+}
+
+static string VectorLiteral(const float *vec, idx_t dim) {
+	string literal = "[";
+	char buf[32];
+	for (idx_t d = 0; d < dim; d++) {
+		std::snprintf(buf, sizeof(buf), d == 0 ? "%.9g" : ",%.9g", vec[d]);
+		literal += buf;
+	}
+	return literal + StringUtil::Format("]::FLOAT[%llu]", dim);
+}
+
+// Single-query pass over every query: latency percentiles, single-stream QPS and recall@k
+static void RunSweepPoint(Connection &con, const BenchArgs &args, const VectorSet &queries,
+                          const vector<string> &literals, const vector<vector<int32_t>> &truth, const string &param,
+                          int32_t value) {
+	string tuning;
+	if (value > 0) {
+		tuning = StringUtil::Format(", %s := %d", param, value);
+	}
+	vector<double> latencies;
+	double hits = 0;
+	auto pass_start = BenchClock::now();
+	for (idx_t qi = 0; qi < queries.count; qi++) {
+		auto sql = StringUtil::Format("SELECT id FROM ann_search('base', 'bench_idx', %s, %d%s)", literals[qi], args.k,
+		                              tuning);
+		auto start = BenchClock::now();
+		auto result = Run(con, sql);
+		latencies.push_back(SecondsSince(start) * 1000.0);
+
+		vector<int32_t> found;
+		for (idx_t row = 0; row < result->RowCount(); row++) {
+			found.push_back(result->GetValue(0, row).GetValue<int32_t>());
+		}
+		for (auto id : truth[qi]) {
+			hits += std::find(found.begin(), found.end(), id) != found.end() ? 1 : 0;
+		}
+	}
+	auto elapsed = SecondsSince(pass_start);
+
+	auto reported = value > 0 ? param : string("default");
+	Emit(args, StringUtil::Format("recall@%d", args.k), hits / static_cast<double>(queries.count * args.k), reported,
+	     value);
+	Emit(args, "latency_p50_ms", Percentile(latencies, 0.50), reported, value);
+	Emit(args, "latency_p99_ms", Percentile(latencies, 0.99), reported, value);
+	Emit(args, "single_qps", static_cast<double>(queries.count) / elapsed, reported, value);
+}
+
+static void RunBench(const BenchArgs &args) {
+	auto base = ReadVectors(args.base, args.limit);
+	auto queries = ReadVectors(args.query, args.nq);
+	if (base.dim != queries.dim) {
+		throw std::runtime_error("base and query dimensions differ");
+	}
+	vector<vector<int32_t>> truth;
+	if (!args.gt.empty() && args.limit == 0) {
+		truth = ReadGroundTruth(args.gt, queries.count, args.k);
+	} else {
+		truth = BruteForce(base, queries, args.k);
+	}
+	if (truth.size() < queries.count) {
+		throw std::runtime_error("ground truth has fewer rows than queries");
+	}
+
+	DuckDB db(nullptr);
+	Connection con(db);
+	// Statically linked into the release build; LOAD is a no-op there and loads the built
+	// extension otherwise.
+	con.Query("LOAD ann");
+	if (args.threads > 0) {
+		Run(con, StringUtil::Format("SET threads = %llu", args.threads));
+	}
+
+	LoadTable(con, "base", base);
+	LoadTable(con, "queries", queries);
+	Emit(args, "rows", static_cast<double>(base.count));
+	Emit(args, "dim", static_cast<double>(base.dim));
+	// The raw vectors are in the table now; release the harness copy so RSS reflects DuckDB
+	base = VectorSet();
+	auto rss_before = PeakRssBytes();
+
+	// CREATE INDEX wall time and memory
+	string with = args.options.empty() ? "" : " WITH (" + args.options + ")";
+	auto build_start = BenchClock::now();
+	Run(con, "CREATE INDEX bench_idx ON base USING " + args.engine + " (embedding)" + with);
+	Emit(args, "build_seconds", SecondsSince(build_start));
+	Emit(args, "peak_rss_bytes", PeakRssBytes());
+	Emit(args, "build_rss_growth_bytes", PeakRssBytes() - rss_before);
+	auto info = Run(con, "SELECT memory_bytes FROM ann_index_info() WHERE name = 'bench_idx'");
+	if (info->RowCount() > 0 && !info->GetValue(0, 0).IsNull()) {
+		Emit(args, "index_memory_bytes", info->GetValue(0, 0).GetValue<double>());
+	}
+
+	vector<string> literals;
+	for (idx_t qi = 0; qi < queries.count; qi++) {
+		literals.push_back(VectorLiteral(queries.data.data() + qi * queries.dim, queries.dim));
+	}
+	// Warm-up: page in the index and the table before anything is timed
+	for (idx_t qi = 0; qi < MinValue<idx_t>(10, queries.count); qi++) {
+		Run(con, StringUtil::Format("SELECT id FROM ann_search('base', 'bench_idx', %s, %d)", literals[qi], args.k));
+	}
+
+	// Recall / latency curve over the tuning parameter
+	auto param = StringUtil::CIEquals(args.engine, "DISKANN") ? "search_complexity" : "nprobe";
+	if (args.sweep.empty()) {
+		RunSweepPoint(con, args, queries, literals, truth, param, 0);
+	}
+	for (auto value : args.sweep) {
+		RunSweepPoint(con, args, queries, literals, truth, param, value);
+	}
+
+	// All queries through one ann_search_table call, at the index defaults
+	auto batch_start = BenchClock::now();
+	Run(con, StringUtil::Format(
+	             "SELECT count(*) FROM ann_search_table((SELECT id, embedding FROM queries), 'base', 'bench_idx', %d)",
+	             args.k));
+	Emit(args, "batch_qps", static_cast<double>(queries.count) / SecondsSince(batch_start));
+	Emit(args, "peak_rss_bytes_final", PeakRssBytes());
+}
+
+static BenchArgs ParseArgs(int argc, char **argv) {
+	BenchArgs args;
+	for (int i = 1; i < argc; i++) {
+		string arg = argv[i];
+		auto eq = arg.find('=');
+		if (eq == string::npos) {
+			throw std::runtime_error("expected key=value, got " + arg);
+		}
+		auto key = arg.substr(0, eq);
+		auto value = arg.substr(eq + 1);
+		if (key == "base") {
+			args.base = value;
+		} else if (key == "query") {
+			args.query = value;
+		} else if (key == "gt") {
+			args.gt = value;
+		} else if (key == "dataset") {
+			args.dataset = value;
+		} else if (key == "engine") {
+			args.engine = StringUtil::Upper(value);
+		} else if (key == "options") {
+			args.options = value;
+		} else if (key == "sweep") {
+			for (auto &item : StringUtil::Split(value, ',')) {
+				if (!item.empty()) {
+					args.sweep.push_back(std::stoi(item));
+				}
+			}
+		} else if (key == "k") {
+			args.k = std::stoi(value);
+		} else if (key == "nq") {
+			args.nq = std::stoull(value);
+		} else if (key == "limit") {
+			args.limit = std::stoull(value);
+		} else if (key == "threads") {
+			args.threads = std::stoull(value);
+		} else {
+			throw std::runtime_error("unknown argument " + key);
+		}
+	}
+	if (args.base.empty() || args.query.empty()) {
+		throw std::runtime_error("base= and query= are required");
+	}
+	if (args.dataset.empty()) {
+		args.dataset = args.base;
+	}
+	return args;
+}
+
+} // namespace duckdb
+
+int main(int argc, char **argv) {
+	try {
+		duckdb::RunBench(duckdb::ParseArgs(argc, argv));
+	} catch (std::exception &ex) {
+		std::fprintf(stderr, "ann_bench: %s\n", ex.what());
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,78 @@
+#!/usr/bin/env bash
+# CPU benchmark suite: every dataset under $ANN_BENCH_DATA x every index configuration below,
+# one ann_bench process each. Results are JSON lines in bench/results/<git describe>.jsonl;
+# diff two result files to compare releases.
+#
+# Dataset layout (TEXMEX naming), one directory per dataset:
+#   $ANN_BENCH_DATA/sift/sift_base.fvecs   sift_query.fvecs   [sift_groundtruth.ivecs]
+#   $ANN_BENCH_DATA/gist/gist_base.fvecs   gist_query.fvecs   [gist_groundtruth.ivecs]
+#   $ANN_BENCH_DATA/<name>/<name>_base.bvecs ...                (uint8 components)
+#
+# Environment: ANN_BENCH_DATA (default bench/data), ANN_BENCH_NQ (queries, default 1000),
+# ANN_BENCH_LIMIT (base rows, default all), ANN_BENCH_THREADS (default all cores),
+# ANN_BENCH_FILTER (only configurations whose name contains it).
+
+set -euo pipefail
+
+BENCH_DIR="$(cd "$(dirname "$0")" && pwd)"
+BIN="${1:-$BENCH_DIR/../build/release/extension/ann/ann_bench}"
+DATA="${ANN_BENCH_DATA:-$BENCH_DIR/data}"
+NQ="${ANN_BENCH_NQ:-1000}"
+LIMIT="${ANN_BENCH_LIMIT:-0}"
+THREADS="${ANN_BENCH_THREADS:-0}"
+FILTER="${ANN_BENCH_FILTER:-}"
+
+if [ ! -x "$BIN" ]; then
+    echo "run_bench.sh: $BIN not found; build it with 'make bench'" >&2
+    exit 1
+fi
+
+# name | engine | WITH options | sweep of search_complexity (DISKANN) or nprobe (FAISS)
+CONFIGS=(
+    "diskann|DISKANN||16,32,64,128,256,512"
+    "diskann_sq8|DISKANN|quantization = 'sq8'|16,32,64,128,256,512"
+    "faiss_flat|FAISS|type = 'Flat'|"
+    "faiss_hnsw|FAISS|type = 'HNSW', hnsw_m = 32|"
+    "faiss_ivfflat|FAISS|type = 'IVFFlat', ivf_nlist = 1024|1,2,4,8,16,32,64,128"
+)
+
+mkdir -p "$BENCH_DIR/results"
+VERSION="$(git -C "$BENCH_DIR" describe --tags --always --dirty 2>/dev/null || echo unknown)"
+OUT="$BENCH_DIR/results/$VERSION.jsonl"
+: > "$OUT"
+
+found=0
+for dir in "$DATA"/*/; do
+    name="$(basename "$dir")"
+    base=""
+    for ext in fvecs bvecs; do
+        if [ -f "$dir/${name}_base.$ext" ]; then
+            base="$dir/${name}_base.$ext"
+            query="$dir/${name}_query.$ext"
+        fi
+    done
+    if [ -z "$base" ]; then
+        continue
+    fi
+    found=1
+    gt=""
+    if [ -f "$dir/${name}_groundtruth.ivecs" ]; then
+        gt="$dir/${name}_groundtruth.ivecs"
+    fi
+
+    for config in "${CONFIGS[@]}"; do
+        IFS='|' read -r config_name engine options sweep <<< "$config"
+        if [ -n "$FILTER" ] && [[ "$config_name" != *"$FILTER"* ]]; then
+            continue
+        fi
+        echo "== $name / $config_name" >&2
+        "$BIN" base="$base" query="$query" gt="$gt" dataset="$name" engine="$engine" options="$options" \
+            sweep="$sweep" nq="$NQ" limit="$LIMIT" threads="$THREADS" | tee -a "$OUT"
+    done
+done
+
+if [ "$found" = 0 ]; then
+    echo "run_bench.sh: no <name>/<name>_base.fvecs|bvecs datasets under $DATA" >&2
+    exit 1
+fi
+echo "results: $OUT" >&2
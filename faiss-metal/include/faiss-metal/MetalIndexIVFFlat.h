@@ -58,6 +58,11 @@ public:
 	/// Set number of lists to probe. Higher = more accurate but slower.
 	void setNprobe(size_t nprobe);
 
+	/// Drop the given ids from their inverted lists so searches never return them.
+	/// Unlike faiss remove_ids, ntotal is left unchanged: ids stay stable and later
+	/// add() calls keep numbering after every id ever assigned. Returns the number removed.
+	size_t removeIds(size_t n, const faiss::idx_t *ids);
+
 private:
 	friend std::unique_ptr<MetalIndexIVFFlat> index_cpu_to_metal_ivf(std::shared_ptr<MetalResources> resources,
 	                                                                 const faiss::IndexIVFFlat *cpu_index);
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <faiss/Index.h>
+#include <faiss/MetricType.h>
+#include <memory>
+
+namespace faiss {
+class IndexIVFPQ;
+}
+
+namespace faiss_metal {
+
+class MetalResources;
+
+/// IVFPQ (Inverted File Index with product-quantized codes) on Metal GPU.
+///
+/// Uses CPU for coarse quantizer search and for the per-query PQ lookup tables
+/// (nprobe x M x 256 floats), then Metal GPU for the ADC scan over the probed
+/// cells' codes and top-k selection. Only 8-bit sub-quantizer codes are supported.
+///
+/// Typical flow:
+///   1. Create on CPU via faiss::IndexIVFPQ (nbits = 8), train, add vectors
+///   2. Convert to Metal via index_cpu_to_metal_ivfpq()
+///   3. Search on GPU (coarse quantizer and tables on CPU, code scan on GPU)
+class MetalIndexIVFPQ : public faiss::Index {
+public:
+	/// @param resources  Metal resource manager (device, queue, shaders)
+	/// @param d          Vector dimension
+	/// @param nlist      Number of inverted lists (clusters)
+	/// @param M          Number of sub-quantizers (must divide d)
+	/// @param metric     METRIC_L2 or METRIC_INNER_PRODUCT
+	MetalIndexIVFPQ(std::shared_ptr<MetalResources> resources, int d, size_t nlist, size_t M,
+	                faiss::MetricType metric = faiss::METRIC_L2);
+
+	~MetalIndexIVFPQ() override;
+
+	// --- faiss::Index interface ---
+
+	/// Train the coarse quantizer and the product quantizer via CPU k-means.
+	void train(faiss::idx_t n, const float *x) override;
+
+	/// Add vectors: assigns each to nearest centroid, stores its PQ code in the inverted list.
+	void add(faiss::idx_t n, const float *x) override;
+
+	/// Search: CPU coarse quantizer + lookup tables, GPU ADC scan within probed cells.
+	void search(faiss::idx_t n, const float *x, faiss::idx_t k, float *distances, faiss::idx_t *labels,
+	            const faiss::SearchParameters *params = nullptr) const override;
+
+	void reset() override;
+
+	// --- IVF-specific ---
+
+	/// Number of inverted lists (clusters).
+	size_t getNlist() const;
+
+	/// Number of lists to probe during search (default: 1).
+	size_t getNprobe() const;
+
+	/// Set number of lists to probe. Higher = more accurate but slower.
+	void setNprobe(size_t nprobe);
+
+	/// Drop the given ids from their inverted lists so searches never return them.
+	/// Unlike faiss remove_ids, ntotal is left unchanged: ids stay stable and later
+	/// add() calls keep numbering after every id ever assigned. Returns the number removed.
+	size_t removeIds(size_t n, const faiss::idx_t *ids);
+
+	/// Number of sub-quantizers (bytes per code).
+	size_t getM() const;
+
+private:
+	friend std::unique_ptr<MetalIndexIVFPQ> index_cpu_to_metal_ivfpq(std::shared_ptr<MetalResources> resources,
+	                                                                 const faiss::IndexIVFPQ *cpu_index);
+	friend std::unique_ptr<faiss::IndexIVFPQ> index_metal_to_cpu_ivfpq(const MetalIndexIVFPQ *metal_index);
+
+	struct Impl;
+	std::unique_ptr<Impl> impl_;
+};
+
+/// Convert CPU IndexIVFPQ -> MetalIndexIVFPQ.
+/// Copies centroids, PQ codebooks and inverted lists. Requires pq.nbits == 8.
+std::unique_ptr<MetalIndexIVFPQ> index_cpu_to_metal_ivfpq(std::shared_ptr<MetalResources> resources,
+                                                          const faiss::IndexIVFPQ *cpu_index);
+
+/// Convert MetalIndexIVFPQ -> CPU IndexIVFPQ.
+std::unique_ptr<faiss::IndexIVFPQ> index_metal_to_cpu_ivfpq(const MetalIndexIVFPQ *metal_index);
+
+} // namespace faiss_metal
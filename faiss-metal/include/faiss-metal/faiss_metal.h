@@ -6,3 +6,4 @@
 #include "StandardMetalResources.h"
 #include "MetalIndexFlat.h"
 #include "MetalIndexIVFFlat.h"
+#include "MetalIndexIVFPQ.h"
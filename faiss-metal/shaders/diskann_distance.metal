@@ -192,3 +192,97 @@ kernel void diskann_batch_ip(
         out_distances[candidate_idx] = -dot;
     }
 }
+
+/// Multi-query batch L2 squared distance against resident vectors.
+/// Candidates are addressed by row id into the index's vectors, which stay on
+/// the device between dispatches: only ids and query_map are uploaded.
+/// Dispatch: grid = (total_n, 1, 1), threadgroup = (32, 1, 1)
+
+kernel void diskann_multi_batch_l2_ids(
+    device const float* queries [[buffer(0)]],     // (nq * dim,) all query vectors
+    device const float* vectors [[buffer(1)]],     // (rows * dim,) resident index vectors
+    device const uint* ids [[buffer(2)]],          // (total_n,) row id per candidate
+    device const uint* query_map [[buffer(3)]],    // (total_n,) query index per candidate
+    device float* out_distances [[buffer(4)]],     // (total_n,)
+    constant DiskannDistParams& params [[buffer(5)]],
+    uint candidate_idx [[threadgroup_position_in_grid]],
+    uint lane [[thread_index_in_simdgroup]]) {
+
+    if (candidate_idx >= params.n) return;
+
+    const uint dim = params.dim;
+    const uint qi = query_map[candidate_idx];
+    device const float* q = queries + qi * dim;
+    device const float* cand = vectors + (ulong)ids[candidate_idx] * dim;
+
+    threadgroup float shared_query[MAX_PRELOAD_DIM];
+    if (dim <= MAX_PRELOAD_DIM) {
+        for (uint j = lane; j < dim; j += 32) {
+            shared_query[j] = q[j];
+        }
+        simdgroup_barrier(mem_flags::mem_threadgroup);
+    }
+
+    float partial = 0.0f;
+    if (dim <= MAX_PRELOAD_DIM) {
+        for (uint j = lane; j < dim; j += 32) {
+            float diff = shared_query[j] - cand[j];
+            partial += diff * diff;
+        }
+    } else {
+        for (uint j = lane; j < dim; j += 32) {
+            float diff = q[j] - cand[j];
+            partial += diff * diff;
+        }
+    }
+
+    float dist = simd_sum(partial);
+    if (lane == 0) {
+        out_distances[candidate_idx] = dist;
+    }
+}
+
+/// Multi-query batch inner product distance against resident vectors.
+/// Returns negated dot product (lower = more similar).
+
+kernel void diskann_multi_batch_ip_ids(
+    device const float* queries [[buffer(0)]],
+    device const float* vectors [[buffer(1)]],
+    device const uint* ids [[buffer(2)]],
+    device const uint* query_map [[buffer(3)]],
+    device float* out_distances [[buffer(4)]],
+    constant DiskannDistParams& params [[buffer(5)]],
+    uint candidate_idx [[threadgroup_position_in_grid]],
+    uint lane [[thread_index_in_simdgroup]]) {
+
+    if (candidate_idx >= params.n) return;
+
+    const uint dim = params.dim;
+    const uint qi = query_map[candidate_idx];
+    device const float* q = queries + qi * dim;
+    device const float* cand = vectors + (ulong)ids[candidate_idx] * dim;
+
+    threadgroup float shared_query[MAX_PRELOAD_DIM];
+    if (dim <= MAX_PRELOAD_DIM) {
+        for (uint j = lane; j < dim; j += 32) {
+            shared_query[j] = q[j];
+        }
+        simdgroup_barrier(mem_flags::mem_threadgroup);
+    }
+
+    float partial = 0.0f;
+    if (dim <= MAX_PRELOAD_DIM) {
+        for (uint j = lane; j < dim; j += 32) {
+            partial += shared_query[j] * cand[j];
+        }
+    } else {
+        for (uint j = lane; j < dim; j += 32) {
+            partial += q[j] * cand[j];
+        }
+    }
+
+    float dot = simd_sum(partial);
+    if (lane == 0) {
+        out_distances[candidate_idx] = -dot;
+    }
+}
@@ -0,0 +1,42 @@
+#include <metal_stdlib>
+using namespace metal;
+
+/// Asymmetric distance computation (ADC) over IVFPQ candidates with 8-bit codes.
+///
+/// Each probed list p has a lookup table lut[p] of M x 256 floats: entry (m, c) is
+/// the distance contribution of sub-quantizer m's centroid c to the query (squared
+/// L2 to the query residual, or the inner product with the query). A candidate's
+/// distance is bias[p] + sum_m lut[p][m][code[m]]; bias carries <q, centroid> for
+/// inner product on residual codes and is 0 otherwise.
+///
+/// codes:       nc x M bytes, the candidates' PQ codes
+/// probe:       nc, index into the probed lists for each candidate
+/// luts:        nprobe x M x 256 floats
+/// bias:        nprobe floats
+/// out:         nc distances
+///
+/// Dispatch as 1D grid: nc threads
+kernel void ivfpq_adc_scan(
+    device const uchar* codes [[buffer(0)]],
+    device const uint* probe [[buffer(1)]],
+    device const float* luts [[buffer(2)]],
+    device const float* bias [[buffer(3)]],
+    device float* out [[buffer(4)]],
+    constant uint& nc [[buffer(5)]],
+    constant uint& M [[buffer(6)]],
+    uint gid [[thread_position_in_grid]]) {
+
+    if (gid >= nc) {
+        return;
+    }
+
+    uint p = probe[gid];
+    device const float* lut = luts + p * M * 256;
+    device const uchar* code = codes + gid * M;
+
+    float sum = bias[p];
+    for (uint m = 0; m < M; m++) {
+        sum += lut[m * 256 + code[m]];
+    }
+    out[gid] = sum;
+}
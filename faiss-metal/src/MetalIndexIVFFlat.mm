@@ -13,6 +13,7 @@
 #include <algorithm>
 #include <cstring>
 #include <numeric>
+#include <unordered_set>
 #include <vector>
 
 namespace faiss_metal {
@@ -278,6 +279,37 @@ void MetalIndexIVFFlat::setNprobe(size_t nprobe) {
     impl_->nprobe_val = nprobe;
 }
 
+size_t MetalIndexIVFFlat::removeIds(size_t n, const faiss::idx_t *ids) {
+    std::unordered_set<faiss::idx_t> remove(ids, ids + n);
+    size_t removed = 0;
+
+    for (auto &list : impl_->invlists) {
+        // Swap-remove: move the list's last entry into the freed slot
+        size_t i = 0;
+        while (i < list.ids.size() && removed < remove.size()) {
+            if (!remove.count(list.ids[i])) {
+                i++;
+                continue;
+            }
+            size_t last = list.ids.size() - 1;
+            if (i != last) {
+                list.ids[i] = list.ids[last];
+                memcpy(list.vectors.data() + i * d, list.vectors.data() + last * d, d * sizeof(float));
+                if (metric_type == faiss::METRIC_L2) {
+                    list.norms[i] = list.norms[last];
+                }
+            }
+            list.ids.pop_back();
+            list.vectors.resize(last * d);
+            if (metric_type == faiss::METRIC_L2) {
+                list.norms.pop_back();
+            }
+            removed++;
+        }
+    }
+    return removed;
+}
+
 // --- Conversion helpers ---
 
 std::unique_ptr<MetalIndexIVFFlat> index_cpu_to_metal_ivf(std::shared_ptr<MetalResources> resources,
@@ -0,0 +1,443 @@
+// FAISS headers must be included BEFORE ObjC headers because macOS defines
+// `nil` as `nullptr`, and FAISS InvertedLists.h uses `nil` as a parameter name.
+#include <faiss/IndexFlat.h>
+#include <faiss/IndexIVFPQ.h>
+#include <faiss/impl/FaissAssert.h>
+#include <faiss/impl/ProductQuantizer.h>
+
+#import <faiss-metal/MetalIndexIVFPQ.h>
+#import <faiss-metal/MetalResources.h>
+#import <faiss-metal/StandardMetalResources.h>
+#import "MetalSelect.h"
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+#include <vector>
+
+namespace faiss_metal {
+
+// --- MetalIndexIVFPQ ---
+
+static constexpr size_t PQ_NBITS = 8;
+static constexpr size_t PQ_KSUB = 1 << PQ_NBITS;
+
+struct MetalIndexIVFPQ::Impl {
+    std::shared_ptr<MetalResources> resources;
+    size_t nlist_val;
+    size_t nprobe_val = 1;
+    int dim;
+
+    // Coarse quantizer: uses FAISS IndexFlat to guarantee identical cell
+    // selection as CPU IndexIVFPQ. Stores centroids (nlist * d floats).
+    std::unique_ptr<faiss::IndexFlat> quantizer;
+
+    // Product quantizer (M sub-quantizers x 256 centroids) and whether
+    // codes encode the residual to the cell centroid (FAISS default)
+    faiss::ProductQuantizer pq;
+    bool by_residual = true;
+
+    // Inverted lists
+    struct InvertedList {
+        std::vector<faiss::idx_t> ids;
+        std::vector<uint8_t> codes; // ids.size() * M bytes
+    };
+    std::vector<InvertedList> invlists;
+
+    // Metal compute objects
+    std::unique_ptr<MetalSelect> selector;
+    id<MTLComputePipelineState> adcPipeline;
+
+    Impl(std::shared_ptr<MetalResources> res, size_t nlist, int d, size_t M, faiss::MetricType metric)
+        : resources(std::move(res)), nlist_val(nlist), dim(d),
+          quantizer(std::make_unique<faiss::IndexFlat>(d, metric)), pq(d, M, PQ_NBITS), invlists(nlist),
+          selector(std::make_unique<MetalSelect>(resources.get())) {
+        id<MTLLibrary> lib = resources->getMetalLibrary();
+        id<MTLDevice> device = resources->getDevice();
+        NSError *error = nil;
+
+        id<MTLFunction> fn = [lib newFunctionWithName:@"ivfpq_adc_scan"];
+        FAISS_THROW_IF_NOT_MSG(fn, "Metal function 'ivfpq_adc_scan' not found");
+        adcPipeline = [device newComputePipelineStateWithFunction:fn error:&error];
+        FAISS_THROW_IF_NOT_MSG(adcPipeline, "Failed to create ivfpq_adc_scan pipeline");
+    }
+
+    // Assign a single vector to its nearest centroid
+    faiss::idx_t assign_one(const float *vec) const {
+        float dist;
+        faiss::idx_t label;
+        quantizer->search(1, vec, 1, &dist, &label);
+        return label;
+    }
+
+    // Find nprobe nearest centroids for a single vector
+    void coarse_search(const float *vec, size_t nprobe, std::vector<faiss::idx_t> &out_cells,
+                       std::vector<float> &out_dists) const {
+        size_t np = std::min(nprobe, nlist_val);
+        out_cells.resize(np);
+        out_dists.resize(np);
+        quantizer->search(1, vec, np, out_dists.data(), out_cells.data());
+    }
+
+    // vec - centroid(cell)
+    void compute_residual(const float *vec, faiss::idx_t cell, float *residual) const {
+        const float *centroid = quantizer->get_xb() + cell * dim;
+        for (int i = 0; i < dim; i++) {
+            residual[i] = vec[i] - centroid[i];
+        }
+    }
+};
+
+MetalIndexIVFPQ::MetalIndexIVFPQ(std::shared_ptr<MetalResources> resources, int d, size_t nlist, size_t M,
+                                 faiss::MetricType metric)
+    : faiss::Index(d, metric) {
+    FAISS_THROW_IF_NOT_MSG(M > 0 && d % M == 0, "MetalIndexIVFPQ: M must divide the dimension");
+    impl_ = std::make_unique<Impl>(std::move(resources), nlist, d, M, metric);
+    is_trained = false;
+}
+
+MetalIndexIVFPQ::~MetalIndexIVFPQ() = default;
+
+void MetalIndexIVFPQ::train(faiss::idx_t n, const float *x) {
+    FAISS_THROW_IF_NOT_MSG(n > 0, "train: need at least 1 vector");
+
+    // Use FAISS CPU k-means (coarse + PQ codebooks) via a temporary IndexIVFPQ
+    faiss::IndexFlat tmp_quantizer(d, metric_type);
+    faiss::IndexIVFPQ cpu_ivf(&tmp_quantizer, d, impl_->nlist_val, impl_->pq.M, PQ_NBITS, metric_type);
+    cpu_ivf.own_fields = false; // tmp_quantizer is on stack
+    cpu_ivf.train(n, x);
+
+    // Copy trained centroids and codebooks
+    impl_->quantizer->reset();
+    impl_->quantizer->add(tmp_quantizer.ntotal, tmp_quantizer.get_xb());
+    impl_->pq = cpu_ivf.pq;
+    impl_->by_residual = cpu_ivf.by_residual;
+
+    is_trained = true;
+}
+
+void MetalIndexIVFPQ::add(faiss::idx_t n, const float *x) {
+    FAISS_THROW_IF_NOT_MSG(is_trained, "add: index must be trained first");
+
+    size_t M = impl_->pq.M;
+    std::vector<float> residual(d);
+    std::vector<uint8_t> code(M);
+
+    for (faiss::idx_t i = 0; i < n; i++) {
+        const float *vec = x + i * d;
+
+        // Assign to nearest centroid via FAISS quantizer
+        faiss::idx_t cell = impl_->assign_one(vec);
+
+        if (impl_->by_residual) {
+            impl_->compute_residual(vec, cell, residual.data());
+            impl_->pq.compute_code(residual.data(), code.data());
+        } else {
+            impl_->pq.compute_code(vec, code.data());
+        }
+
+        auto &list = impl_->invlists[(size_t)cell];
+        list.ids.push_back(ntotal);
+        list.codes.insert(list.codes.end(), code.begin(), code.end());
+
+        ntotal++;
+    }
+}
+
+void MetalIndexIVFPQ::search(faiss::idx_t n, const float *x, faiss::idx_t k, float *distances, faiss::idx_t *labels,
+                             const faiss::SearchParameters *params) const {
+
+    FAISS_THROW_IF_NOT_MSG(is_trained, "search: index must be trained first");
+    FAISS_THROW_IF_NOT_MSG(k > 0, "k must be > 0");
+
+    float sentinel_dist = (metric_type == faiss::METRIC_L2) ? INFINITY : -INFINITY;
+
+    if (n == 0 || ntotal == 0) {
+        for (faiss::idx_t i = 0; i < n * k; i++) {
+            distances[i] = sentinel_dist;
+            labels[i] = -1;
+        }
+        return;
+    }
+
+    id<MTLDevice> device = impl_->resources->getDevice();
+    id<MTLCommandQueue> queue = impl_->resources->getDefaultCommandQueue();
+
+    const size_t M = impl_->pq.M;
+    const size_t lut_size = M * PQ_KSUB;
+
+    // Reusable buffers across queries
+    std::vector<faiss::idx_t> probe_cells;
+    std::vector<float> probe_dists;
+    std::vector<float> luts;
+    std::vector<float> bias;
+    std::vector<float> residual(d);
+    std::vector<uint8_t> cand_codes;
+    std::vector<uint32_t> cand_probe;
+    std::vector<faiss::idx_t> cand_ids;
+
+    // Process each query independently so each probes only its own cells.
+    for (faiss::idx_t qi = 0; qi < n; qi++) {
+        const float *q = x + qi * d;
+        float *out_dist = distances + qi * k;
+        faiss::idx_t *out_labels = labels + qi * k;
+
+        // --- Step 1: CPU coarse search via FAISS quantizer ---
+        impl_->coarse_search(q, impl_->nprobe_val, probe_cells, probe_dists);
+        size_t np = probe_cells.size();
+
+        // --- Step 2: one lookup table per probed cell ---
+        // L2 on residuals needs a table per cell; inner product shares one table and
+        // adds <q, centroid> (the coarse distance) as the cell's bias.
+        luts.resize(np * lut_size);
+        bias.assign(np, 0.0f);
+        for (size_t p = 0; p < np; p++) {
+            faiss::idx_t c = probe_cells[p];
+            float *lut = luts.data() + p * lut_size;
+            if (metric_type == faiss::METRIC_INNER_PRODUCT) {
+                if (p == 0) {
+                    impl_->pq.compute_inner_prod_table(q, lut);
+                } else {
+                    memcpy(lut, luts.data(), lut_size * sizeof(float));
+                }
+                if (impl_->by_residual) {
+                    bias[p] = probe_dists[p];
+                }
+            } else if (impl_->by_residual && c >= 0) {
+                impl_->compute_residual(q, c, residual.data());
+                impl_->pq.compute_distance_table(residual.data(), lut);
+            } else {
+                impl_->pq.compute_distance_table(q, lut);
+            }
+        }
+
+        // --- Step 3: Gather candidate codes from probed cells ---
+        size_t total_candidates = 0;
+        for (faiss::idx_t c : probe_cells) {
+            if (c < 0 || (size_t)c >= impl_->nlist_val)
+                continue;
+            total_candidates += impl_->invlists[c].ids.size();
+        }
+
+        if (total_candidates == 0) {
+            for (faiss::idx_t j = 0; j < k; j++) {
+                out_dist[j] = sentinel_dist;
+                out_labels[j] = -1;
+            }
+            continue;
+        }
+
+        cand_codes.resize(total_candidates * M);
+        cand_probe.resize(total_candidates);
+        cand_ids.resize(total_candidates);
+
+        size_t offset = 0;
+        for (size_t p = 0; p < np; p++) {
+            faiss::idx_t c = probe_cells[p];
+            if (c < 0 || (size_t)c >= impl_->nlist_val)
+                continue;
+            auto &list = impl_->invlists[c];
+            size_t cnt = list.ids.size();
+            if (cnt == 0)
+                continue;
+
+            memcpy(cand_codes.data() + offset * M, list.codes.data(), cnt * M);
+            memcpy(cand_ids.data() + offset, list.ids.data(), cnt * sizeof(faiss::idx_t));
+            std::fill(cand_probe.begin() + offset, cand_probe.begin() + offset + cnt, (uint32_t)p);
+            offset += cnt;
+        }
+
+        // --- Step 4: GPU ADC scan + top-k ---
+        id<MTLBuffer> codeBuf = [device newBufferWithBytes:cand_codes.data()
+                                                    length:total_candidates * M
+                                                   options:MTLResourceStorageModeShared];
+        id<MTLBuffer> probeBuf = [device newBufferWithBytes:cand_probe.data()
+                                                     length:total_candidates * sizeof(uint32_t)
+                                                    options:MTLResourceStorageModeShared];
+        id<MTLBuffer> lutBuf = [device newBufferWithBytes:luts.data()
+                                                   length:luts.size() * sizeof(float)
+                                                  options:MTLResourceStorageModeShared];
+        id<MTLBuffer> biasBuf = [device newBufferWithBytes:bias.data()
+                                                    length:bias.size() * sizeof(float)
+                                                   options:MTLResourceStorageModeShared];
+        id<MTLBuffer> distBuf = [device newBufferWithLength:total_candidates * sizeof(float)
+                                                    options:MTLResourceStorageModePrivate];
+
+        faiss::idx_t effective_k = std::min(k, (faiss::idx_t)total_candidates);
+
+        id<MTLBuffer> outDistBuf = [device newBufferWithLength:effective_k * sizeof(float)
+                                                       options:MTLResourceStorageModeShared];
+        id<MTLBuffer> outIdxBuf = [device newBufferWithLength:effective_k * sizeof(int32_t)
+                                                      options:MTLResourceStorageModeShared];
+
+        id<MTLCommandBuffer> cmdBuf = [queue commandBuffer];
+
+        id<MTLComputeCommandEncoder> enc = [cmdBuf computeCommandEncoder];
+        uint32_t nc32 = (uint32_t)total_candidates;
+        uint32_t m32 = (uint32_t)M;
+        [enc setComputePipelineState:impl_->adcPipeline];
+        [enc setBuffer:codeBuf offset:0 atIndex:0];
+        [enc setBuffer:probeBuf offset:0 atIndex:1];
+        [enc setBuffer:lutBuf offset:0 atIndex:2];
+        [enc setBuffer:biasBuf offset:0 atIndex:3];
+        [enc setBuffer:distBuf offset:0 atIndex:4];
+        [enc setBytes:&nc32 length:sizeof(nc32) atIndex:5];
+        [enc setBytes:&m32 length:sizeof(m32) atIndex:6];
+        MTLSize gridSize = MTLSizeMake(total_candidates, 1, 1);
+        MTLSize groupSize = MTLSizeMake(std::min((size_t)256, total_candidates), 1, 1);
+        [enc dispatchThreads:gridSize threadsPerThreadgroup:groupSize];
+        [enc endEncoding];
+
+        impl_->selector->encode(cmdBuf, distBuf, outDistBuf, outIdxBuf, 1, total_candidates, effective_k, metric_type);
+
+        [cmdBuf commit];
+        [cmdBuf waitUntilCompleted];
+
+        // --- Step 5: Copy results and remap indices ---
+        float *outDistPtr = (float *)[outDistBuf contents];
+        int32_t *outIdxPtr = (int32_t *)[outIdxBuf contents];
+
+        for (faiss::idx_t j = 0; j < effective_k; j++) {
+            out_dist[j] = outDistPtr[j];
+            int32_t cand_idx = outIdxPtr[j];
+            out_labels[j] = (cand_idx >= 0 && cand_idx < (int32_t)total_candidates) ? cand_ids[cand_idx] : -1;
+        }
+        for (faiss::idx_t j = effective_k; j < k; j++) {
+            out_dist[j] = sentinel_dist;
+            out_labels[j] = -1;
+        }
+    }
+}
+
+void MetalIndexIVFPQ::reset() {
+    ntotal = 0;
+    for (auto &list : impl_->invlists) {
+        list.ids.clear();
+        list.codes.clear();
+    }
+}
+
+size_t MetalIndexIVFPQ::getNlist() const {
+    return impl_->nlist_val;
+}
+
+size_t MetalIndexIVFPQ::getNprobe() const {
+    return impl_->nprobe_val;
+}
+
+void MetalIndexIVFPQ::setNprobe(size_t nprobe) {
+    FAISS_THROW_IF_NOT_MSG(nprobe > 0, "nprobe must be > 0");
+    FAISS_THROW_IF_NOT_MSG(nprobe <= impl_->nlist_val, "nprobe cannot exceed nlist");
+    impl_->nprobe_val = nprobe;
+}
+
+size_t MetalIndexIVFPQ::getM() const {
+    return impl_->pq.M;
+}
+
+size_t MetalIndexIVFPQ::removeIds(size_t n, const faiss::idx_t *ids) {
+    std::unordered_set<faiss::idx_t> remove(ids, ids + n);
+    size_t M = impl_->pq.M;
+    size_t removed = 0;
+
+    for (auto &list : impl_->invlists) {
+        // Swap-remove: move the list's last entry into the freed slot
+        size_t i = 0;
+        while (i < list.ids.size() && removed < remove.size()) {
+            if (!remove.count(list.ids[i])) {
+                i++;
+                continue;
+            }
+            size_t last = list.ids.size() - 1;
+            if (i != last) {
+                list.ids[i] = list.ids[last];
+                memcpy(list.codes.data() + i * M, list.codes.data() + last * M, M);
+            }
+            list.ids.pop_back();
+            list.codes.resize(last * M);
+            removed++;
+        }
+    }
+    return removed;
+}
+
+// --- Conversion helpers ---
+
+std::unique_ptr<MetalIndexIVFPQ> index_cpu_to_metal_ivfpq(std::shared_ptr<MetalResources> resources,
+                                                          const faiss::IndexIVFPQ *cpu_index) {
+
+    FAISS_THROW_IF_NOT_MSG(cpu_index->is_trained, "CPU IndexIVFPQ must be trained");
+    FAISS_THROW_IF_NOT_MSG(cpu_index->pq.nbits == PQ_NBITS, "Metal IVFPQ supports 8-bit PQ codes only");
+
+    auto metal = std::make_unique<MetalIndexIVFPQ>(resources, cpu_index->d, cpu_index->nlist, cpu_index->pq.M,
+                                                   cpu_index->metric_type);
+
+    // Copy centroids from CPU quantizer into our FAISS IndexFlat quantizer
+    auto *quantizer = dynamic_cast<const faiss::IndexFlat *>(cpu_index->quantizer);
+    FAISS_THROW_IF_NOT_MSG(quantizer, "IndexIVFPQ quantizer must be IndexFlat");
+
+    metal->impl_->quantizer->reset();
+    metal->impl_->quantizer->add(quantizer->ntotal, quantizer->get_xb());
+    metal->impl_->pq = cpu_index->pq;
+    metal->impl_->by_residual = cpu_index->by_residual;
+    metal->is_trained = true;
+
+    // Copy inverted lists (codes are M bytes each for 8-bit PQ)
+    const faiss::InvertedLists *invlists = cpu_index->invlists;
+    size_t code_size = cpu_index->pq.code_size;
+    for (size_t c = 0; c < cpu_index->nlist; c++) {
+        size_t list_size = invlists->list_size(c);
+        if (list_size == 0)
+            continue;
+
+        const faiss::idx_t *ids = invlists->get_ids(c);
+        const uint8_t *codes = invlists->get_codes(c);
+
+        auto &list = metal->impl_->invlists[c];
+        list.ids.assign(ids, ids + list_size);
+        list.codes.assign(codes, codes + list_size * code_size);
+    }
+
+    metal->ntotal = cpu_index->ntotal;
+    metal->impl_->nprobe_val = std::min(cpu_index->nprobe, cpu_index->nlist);
+
+    return metal;
+}
+
+std::unique_ptr<faiss::IndexIVFPQ> index_metal_to_cpu_ivfpq(const MetalIndexIVFPQ *metal_index) {
+
+    FAISS_THROW_IF_NOT_MSG(metal_index->is_trained, "Metal index must be trained");
+
+    int dim = metal_index->d;
+    size_t nlist = metal_index->getNlist();
+
+    // Create quantizer with centroids from our FAISS quantizer
+    auto *quantizer = new faiss::IndexFlat(dim, metal_index->metric_type);
+    quantizer->add(metal_index->impl_->quantizer->ntotal, metal_index->impl_->quantizer->get_xb());
+
+    auto cpu_index = std::make_unique<faiss::IndexIVFPQ>(quantizer, dim, nlist, metal_index->getM(), PQ_NBITS,
+                                                         metal_index->metric_type);
+    cpu_index->own_fields = true; // takes ownership of quantizer
+    cpu_index->pq = metal_index->impl_->pq;
+    cpu_index->by_residual = metal_index->impl_->by_residual;
+    cpu_index->is_trained = true;
+    cpu_index->nprobe = metal_index->getNprobe();
+
+    // Copy inverted lists
+    for (size_t c = 0; c < nlist; c++) {
+        auto &list = metal_index->impl_->invlists[c];
+        if (list.ids.empty())
+            continue;
+
+        cpu_index->invlists->add_entries(c, list.ids.size(), list.ids.data(), list.codes.data());
+    }
+
+    cpu_index->ntotal = metal_index->ntotal;
+
+    // Residual L2 search uses the precomputed centroid x codebook term table
+    if (cpu_index->by_residual) {
+        cpu_index->precompute_table();
+    }
+    return cpu_index;
+}
+
+} // namespace faiss_metal
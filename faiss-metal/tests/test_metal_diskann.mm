@@ -0,0 +1,195 @@
+#import <Foundation/Foundation.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+// assert() is disabled by -DNDEBUG; use FATAL_CHECK for real runtime checks
+#define FATAL_CHECK(cond, msg)                                                                                         \
+    do {                                                                                                               \
+        if (!(cond)) {                                                                                                 \
+            printf("FATAL: %s\n", msg);                                                                                \
+            abort();                                                                                                   \
+        }                                                                                                              \
+    } while (0)
+
+// The extension's DiskANN bridge (compiled into this test): diskann_multi_batch_{l2,ip}
+// gather the candidates on the host, the _ids kernels read them from resident rows
+#include "../../src/include/metal_diskann_bridge.h"
+
+static constexpr int METRIC_L2 = 0;
+static constexpr int METRIC_IP = 1;
+
+static std::vector<float> random_vectors(size_t n, size_t d, std::mt19937 &rng) {
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    std::vector<float> v(n * d);
+    for (auto &x : v)
+        x = dist(rng);
+    return v;
+}
+
+// Candidates of nq queries as lock-step search builds them: neighbour ids (with repeats)
+// and the query each one belongs to
+static void random_candidates(size_t rows, size_t nq, size_t per_query, std::mt19937 &rng,
+                              std::vector<unsigned int> &ids, std::vector<unsigned int> &query_map) {
+    std::uniform_int_distribution<unsigned int> pick(0, (unsigned int)rows - 1);
+    ids.clear();
+    query_map.clear();
+    for (size_t qi = 0; qi < nq; qi++) {
+        for (size_t i = 0; i < per_query; i++) {
+            ids.push_back(pick(rng));
+            query_map.push_back((unsigned int)qi);
+        }
+    }
+}
+
+static float cpu_distance(const float *q, const float *v, size_t d, int metric) {
+    float acc = 0.0f;
+    for (size_t j = 0; j < d; j++) {
+        acc += metric == METRIC_L2 ? (q[j] - v[j]) * (q[j] - v[j]) : q[j] * v[j];
+    }
+    return metric == METRIC_L2 ? acc : -acc;
+}
+
+// The id path against the gather path over the same host vectors, and both against the CPU.
+// Both kernels sum the same lanes in the same order: their distances must be identical.
+static void compare_paths(void *resident, const std::vector<float> &vectors, size_t d,
+                          const std::vector<float> &queries, const std::vector<unsigned int> &ids,
+                          const std::vector<unsigned int> &query_map, int metric, const char *label) {
+    size_t total_n = ids.size();
+    size_t nq = queries.size() / d;
+
+    std::vector<float> gathered(total_n * d);
+    for (size_t i = 0; i < total_n; i++) {
+        memcpy(gathered.data() + i * d, vectors.data() + (size_t)ids[i] * d, d * sizeof(float));
+    }
+    std::vector<float> gather_distances(total_n);
+    int rc = diskann_metal_multi_batch_distances(queries.data(), gathered.data(), query_map.data(), (int)total_n,
+                                                 (int)nq, (int)d, metric, gather_distances.data());
+    FATAL_CHECK(rc == 0, "gather dispatch failed");
+
+    std::vector<float> id_distances(total_n);
+    rc = diskann_metal_resident_multi_batch_distances(resident, queries.data(), ids.data(), query_map.data(),
+                                                      (int)total_n, (int)nq, metric, id_distances.data());
+    FATAL_CHECK(rc == 0, "resident dispatch failed");
+
+    int mismatches = 0;
+    for (size_t i = 0; i < total_n; i++) {
+        if (id_distances[i] != gather_distances[i]) {
+            if (mismatches < 5) {
+                printf("  %s mismatch at %zu (id %u): ids=%f gather=%f\n", label, i, ids[i], id_distances[i],
+                       gather_distances[i]);
+            }
+            mismatches++;
+        }
+        float expected = cpu_distance(queries.data() + query_map[i] * d, vectors.data() + (size_t)ids[i] * d, d,
+                                      metric);
+        float rel = std::abs(id_distances[i] - expected) / std::max(std::abs(expected), 1e-3f);
+        FATAL_CHECK(rel < 1e-3f, "resident distance differs from the CPU reference");
+    }
+    FATAL_CHECK(mismatches == 0, "id path must match the gather path");
+}
+
+static void test_resident_matches_gather(size_t d, int metric, const char *label) {
+    printf("test_resident_matches_gather(%s, d=%zu)... ", label, d);
+
+    const size_t rows = 1000;
+    const size_t nq = 4;
+    std::mt19937 rng(42 + (unsigned int)d);
+    auto vectors = random_vectors(rows, d, rng);
+    auto queries = random_vectors(nq, d, rng);
+
+    void *resident = diskann_metal_resident_create(vectors.data(), (unsigned int)rows, (int)d);
+    FATAL_CHECK(resident != nullptr, "resident_create failed");
+
+    std::vector<unsigned int> ids, query_map;
+    random_candidates(rows, nq, 64, rng, ids, query_map);
+    compare_paths(resident, vectors, d, queries, ids, query_map, metric, label);
+
+    diskann_metal_resident_free(resident);
+    printf("PASS\n");
+}
+
+// The write sequence of the provider's sync_metal_vectors: rows past the uploaded end are
+// appended in one write (growing the buffer), then each overwritten id below it is rewritten
+static void test_resident_after_appends_and_overwrites(int metric, const char *label) {
+    printf("test_resident_after_appends_and_overwrites(%s)... ", label);
+
+    const size_t d = 100; // not a multiple of the 32 lanes
+    const size_t initial = 1000;
+    const size_t grown = 1700; // 680KB: past the 512KB buffer made for the first 400KB
+    const size_t nq = 3;
+    std::mt19937 rng(7);
+    auto vectors = random_vectors(initial, d, rng);
+    auto queries = random_vectors(nq, d, rng);
+
+    void *resident = diskann_metal_resident_create(vectors.data(), (unsigned int)initial, (int)d);
+    FATAL_CHECK(resident != nullptr, "resident_create failed");
+
+    // Two rounds of inserts and in-place rewrites (recycled slots) between searches
+    unsigned int uploaded = (unsigned int)initial;
+    for (size_t rows : {grown, grown + 37}) {
+        auto appended = random_vectors(rows - vectors.size() / d, d, rng);
+        vectors.insert(vectors.end(), appended.begin(), appended.end());
+        std::vector<unsigned int> stale = {0, 3, uploaded / 2, uploaded - 1};
+        for (auto id : stale) {
+            auto fresh = random_vectors(1, d, rng);
+            memcpy(vectors.data() + (size_t)id * d, fresh.data(), d * sizeof(float));
+        }
+
+        int rc = diskann_metal_resident_write(resident, vectors.data() + (size_t)uploaded * d, uploaded,
+                                              (unsigned int)rows - uploaded);
+        FATAL_CHECK(rc == 0, "append write failed");
+        for (auto id : stale) {
+            rc = diskann_metal_resident_write(resident, vectors.data() + (size_t)id * d, id, 1);
+            FATAL_CHECK(rc == 0, "overwrite failed");
+        }
+        uploaded = (unsigned int)rows;
+
+        // Every candidate kind: untouched, rewritten and appended rows
+        std::vector<unsigned int> ids, query_map;
+        random_candidates(rows, nq, 48, rng, ids, query_map);
+        for (size_t qi = 0; qi < nq; qi++) {
+            for (auto id : stale) {
+                ids.push_back(id);
+                query_map.push_back((unsigned int)qi);
+            }
+            ids.push_back((unsigned int)rows - 1);
+            query_map.push_back((unsigned int)qi);
+        }
+        compare_paths(resident, vectors, d, queries, ids, query_map, metric, label);
+    }
+
+    // A write may not leave a gap past the end
+    float row[d] = {0};
+    FATAL_CHECK(diskann_metal_resident_write(resident, row, uploaded + 1, 1) != 0,
+                "write past the end must be rejected");
+
+    diskann_metal_resident_free(resident);
+    printf("PASS\n");
+}
+
+int main() {
+    @autoreleasepool {
+        printf("=== DiskANN Metal distance tests ===\n");
+        if (!diskann_metal_available()) {
+            printf("Metal is not available: skipped\n");
+            return 0;
+        }
+
+        test_resident_matches_gather(128, METRIC_L2, "L2");
+        test_resident_matches_gather(128, METRIC_IP, "IP");
+        // Past MAX_PRELOAD_DIM: the query is read from device memory instead of threadgroup memory
+        test_resident_matches_gather(2000, METRIC_L2, "L2");
+        test_resident_matches_gather(2000, METRIC_IP, "IP");
+        test_resident_after_appends_and_overwrites(METRIC_L2, "L2");
+        test_resident_after_appends_and_overwrites(METRIC_IP, "IP");
+
+        printf("\nAll DiskANN Metal distance tests passed!\n");
+    }
+    return 0;
+}
@@ -325,6 +325,59 @@ static void test_ivfflat_reset() {
     printf("PASS\n");
 }
 
+static void test_ivfflat_incremental_add_and_remove() {
+    printf("test_ivfflat_incremental_add_and_remove... ");
+
+    const size_t nv = 2000;
+    const size_t d = 32;
+    const size_t nlist = 8;
+    const size_t k = 5;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    std::vector<float> vectors(nv * d);
+    for (auto &v : vectors)
+        v = dist(rng);
+
+    faiss::IndexFlatL2 quantizer(d);
+    faiss::IndexIVFFlat cpu_index(&quantizer, d, nlist, faiss::METRIC_L2);
+    cpu_index.own_fields = false;
+    cpu_index.train(nv, vectors.data());
+    cpu_index.add(nv / 2, vectors.data());
+    cpu_index.nprobe = nlist;
+
+    auto res = std::make_shared<StandardMetalResources>();
+    auto metal_index = index_cpu_to_metal_ivf(res, &cpu_index);
+
+    // Appending to both keeps labels in step: ids continue from ntotal
+    cpu_index.add(nv / 2, vectors.data() + (nv / 2) * d);
+    metal_index->add(nv / 2, vectors.data() + (nv / 2) * d);
+    FATAL_CHECK(metal_index->ntotal == cpu_index.ntotal, "ntotal diverged after append");
+
+    std::vector<float> distances(k);
+    std::vector<faiss::idx_t> labels(k);
+    const float *query = vectors.data() + 1500 * d;
+    metal_index->search(1, query, k, distances.data(), labels.data());
+    FATAL_CHECK(labels[0] == 1500, "appended vector not found by its own query");
+
+    // Removed ids drop out of results; ntotal and the id sequence are untouched
+    faiss::idx_t removed_ids[] = {1500, 17};
+    FATAL_CHECK(metal_index->removeIds(2, removed_ids) == 2, "removeIds count");
+    FATAL_CHECK(metal_index->ntotal == (faiss::idx_t)nv, "removeIds must not change ntotal");
+
+    metal_index->search(1, query, k, distances.data(), labels.data());
+    for (size_t i = 0; i < k; i++) {
+        FATAL_CHECK(labels[i] != 1500 && labels[i] != 17, "removed id returned by search");
+    }
+
+    metal_index->add(1, query);
+    metal_index->search(1, query, k, distances.data(), labels.data());
+    FATAL_CHECK(labels[0] == (faiss::idx_t)nv, "re-added vector must take the next id");
+
+    printf("PASS\n");
+}
+
 static void test_ivfflat_empty_search() {
     printf("test_ivfflat_empty_search... ");
 
@@ -364,6 +417,7 @@ int main() {
         test_ivfflat_conversion_roundtrip();
         test_ivfflat_train_and_add();
         test_ivfflat_reset();
+        test_ivfflat_incremental_add_and_remove();
         test_ivfflat_empty_search();
 
         printf("\nAll MetalIndexIVFFlat tests passed!\n");
@@ -0,0 +1,322 @@
+// FAISS headers before ObjC (nil macro conflict with InvertedLists.h)
+#include <faiss/IndexFlat.h>
+#include <faiss/IndexIVFPQ.h>
+
+#import <Foundation/Foundation.h>
+#import <faiss-metal/MetalIndexIVFPQ.h>
+#import <faiss-metal/StandardMetalResources.h>
+#import <faiss-metal/MetalDeviceCapabilities.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+// assert() is disabled by -DNDEBUG; use FATAL_CHECK for real runtime checks
+#define FATAL_CHECK(cond, msg)                                                                                         \
+    do {                                                                                                               \
+        if (!(cond)) {                                                                                                 \
+            printf("FATAL: %s\n", msg);                                                                                \
+            abort();                                                                                                   \
+        }                                                                                                              \
+    } while (0)
+
+using namespace faiss_metal;
+
+// ADC sums the same table entries as the CPU scanner, but in a different order
+// (and CPU L2 uses the precomputed-table decomposition), so near-ties may swap.
+static void compare_with_cpu(faiss::IndexIVFPQ &cpu_index, MetalIndexIVFPQ &metal_index, const float *queries,
+                             size_t nq, size_t k, const char *label) {
+    std::vector<float> cpu_distances(nq * k);
+    std::vector<faiss::idx_t> cpu_labels(nq * k);
+    cpu_index.search(nq, queries, k, cpu_distances.data(), cpu_labels.data());
+
+    std::vector<float> metal_distances(nq * k);
+    std::vector<faiss::idx_t> metal_labels(nq * k);
+    metal_index.search(nq, queries, k, metal_distances.data(), metal_labels.data());
+
+    int top1_mismatches = 0;
+    for (size_t qi = 0; qi < nq; qi++) {
+        if (metal_labels[qi * k] != cpu_labels[qi * k]) {
+            float rel = std::abs(metal_distances[qi * k] - cpu_distances[qi * k]) /
+                        std::max(std::abs(cpu_distances[qi * k]), 1e-6f);
+            if (rel > 1e-3f) {
+                printf("  %s top-1 mismatch: query=%zu metal=%lld cpu=%lld\n", label, qi,
+                       (long long)metal_labels[qi * k], (long long)cpu_labels[qi * k]);
+                top1_mismatches++;
+            }
+        }
+    }
+    FATAL_CHECK(top1_mismatches == 0, "IVFPQ top-1 labels must match CPU (up to ties)");
+
+    int dist_mismatches = 0;
+    for (size_t i = 0; i < nq * k; i++) {
+        float relDiff = std::abs(metal_distances[i] - cpu_distances[i]) / std::max(std::abs(cpu_distances[i]), 1e-6f);
+        if (relDiff > 5e-2f)
+            dist_mismatches++;
+    }
+    if (dist_mismatches > 0) {
+        printf("  WARNING: %d/%zu %s distance mismatches (tol=5e-2)\n", dist_mismatches, nq * k, label);
+    }
+}
+
+static void test_ivfpq_l2_basic() {
+    printf("test_ivfpq_l2_basic... ");
+
+    const size_t nv = 4000;
+    const size_t d = 64;
+    const size_t nlist = 16;
+    const size_t M = 8;
+    const size_t nq = 10;
+    const size_t k = 5;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    std::vector<float> vectors(nv * d);
+    std::vector<float> queries(nq * d);
+    for (auto &v : vectors)
+        v = dist(rng);
+    for (auto &v : queries)
+        v = dist(rng);
+
+    faiss::IndexFlatL2 quantizer(d);
+    faiss::IndexIVFPQ cpu_index(&quantizer, d, nlist, M, 8, faiss::METRIC_L2);
+    cpu_index.own_fields = false;
+    cpu_index.train(nv, vectors.data());
+    cpu_index.add(nv, vectors.data());
+    cpu_index.nprobe = 4;
+
+    auto res = std::make_shared<StandardMetalResources>();
+    auto metal_index = index_cpu_to_metal_ivfpq(res, &cpu_index);
+
+    FATAL_CHECK(metal_index->getNlist() == nlist && metal_index->getNprobe() == 4 && metal_index->getM() == M &&
+                    metal_index->ntotal == (faiss::idx_t)nv && metal_index->is_trained,
+                "conversion metadata mismatch");
+
+    compare_with_cpu(cpu_index, *metal_index, queries.data(), nq, k, "L2");
+
+    printf("PASS\n");
+}
+
+static void test_ivfpq_ip() {
+    printf("test_ivfpq_ip... ");
+
+    const size_t nv = 3000;
+    const size_t d = 32;
+    const size_t nlist = 8;
+    const size_t M = 4;
+    const size_t nq = 5;
+    const size_t k = 10;
+
+    std::mt19937 rng(123);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    std::vector<float> vectors(nv * d);
+    std::vector<float> queries(nq * d);
+    for (auto &v : vectors)
+        v = dist(rng);
+    for (auto &v : queries)
+        v = dist(rng);
+
+    faiss::IndexFlatIP quantizer(d);
+    faiss::IndexIVFPQ cpu_index(&quantizer, d, nlist, M, 8, faiss::METRIC_INNER_PRODUCT);
+    cpu_index.own_fields = false;
+    cpu_index.train(nv, vectors.data());
+    cpu_index.add(nv, vectors.data());
+    cpu_index.nprobe = 2;
+
+    auto res = std::make_shared<StandardMetalResources>();
+    auto metal_index = index_cpu_to_metal_ivfpq(res, &cpu_index);
+
+    compare_with_cpu(cpu_index, *metal_index, queries.data(), nq, k, "IP");
+
+    printf("PASS\n");
+}
+
+static void test_ivfpq_conversion_roundtrip() {
+    printf("test_ivfpq_conversion_roundtrip... ");
+
+    const size_t nv = 2000;
+    const size_t d = 32;
+    const size_t nlist = 4;
+    const size_t M = 8;
+    const size_t nq = 5;
+    const size_t k = 5;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    std::vector<float> vectors(nv * d);
+    std::vector<float> queries(nq * d);
+    for (auto &v : vectors)
+        v = dist(rng);
+    for (auto &v : queries)
+        v = dist(rng);
+
+    faiss::IndexFlatL2 quantizer(d);
+    faiss::IndexIVFPQ cpu_index(&quantizer, d, nlist, M, 8, faiss::METRIC_L2);
+    cpu_index.own_fields = false;
+    cpu_index.train(nv, vectors.data());
+    cpu_index.add(nv, vectors.data());
+    cpu_index.nprobe = 2;
+
+    std::vector<float> cpu_d1(nq * k);
+    std::vector<faiss::idx_t> cpu_l1(nq * k);
+    cpu_index.search(nq, queries.data(), k, cpu_d1.data(), cpu_l1.data());
+
+    // CPU → Metal → CPU keeps codebooks and codes bit-for-bit
+    auto res = std::make_shared<StandardMetalResources>();
+    auto metal_index = index_cpu_to_metal_ivfpq(res, &cpu_index);
+    auto cpu_index2 = index_metal_to_cpu_ivfpq(metal_index.get());
+
+    FATAL_CHECK(cpu_index2->ntotal == cpu_index.ntotal && cpu_index2->nlist == cpu_index.nlist &&
+                    cpu_index2->nprobe == cpu_index.nprobe && cpu_index2->pq.M == cpu_index.pq.M,
+                "round-trip metadata mismatch");
+
+    std::vector<float> cpu_d2(nq * k);
+    std::vector<faiss::idx_t> cpu_l2(nq * k);
+    cpu_index2->search(nq, queries.data(), k, cpu_d2.data(), cpu_l2.data());
+
+    for (size_t i = 0; i < nq * k; i++) {
+        if (cpu_l1[i] != cpu_l2[i]) {
+            printf("FATAL: round-trip label mismatch at %zu\n", i);
+            abort();
+        }
+        if (std::abs(cpu_d1[i] - cpu_d2[i]) > 1e-5f) {
+            printf("FATAL: round-trip distance mismatch at %zu: %.6f vs %.6f\n", i, cpu_d1[i], cpu_d2[i]);
+            abort();
+        }
+    }
+
+    printf("PASS\n");
+}
+
+static void test_ivfpq_train_and_add() {
+    printf("test_ivfpq_train_and_add... ");
+
+    const size_t nv = 2000;
+    const size_t d = 32;
+    const size_t nlist = 8;
+    const size_t M = 8;
+    const size_t k = 5;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    std::vector<float> vectors(nv * d);
+    for (auto &v : vectors)
+        v = dist(rng);
+
+    auto res = std::make_shared<StandardMetalResources>();
+    MetalIndexIVFPQ metal_index(res, d, nlist, M, faiss::METRIC_L2);
+    FATAL_CHECK(!metal_index.is_trained && metal_index.ntotal == 0, "bad initial state");
+
+    metal_index.train(nv, vectors.data());
+    FATAL_CHECK(metal_index.is_trained, "not trained");
+
+    metal_index.add(nv, vectors.data());
+    FATAL_CHECK(metal_index.ntotal == (faiss::idx_t)nv, "ntotal mismatch");
+
+    // Searching a database vector with every list probed finds it (or a tie) first
+    metal_index.setNprobe(nlist);
+    std::vector<float> distances(k);
+    std::vector<faiss::idx_t> labels(k);
+    metal_index.search(1, vectors.data() + 17 * d, k, distances.data(), labels.data());
+    FATAL_CHECK(labels[0] >= 0, "search returned no valid labels");
+
+    bool found = false;
+    for (size_t i = 0; i < k; i++) {
+        found = found || labels[i] == 17;
+    }
+    FATAL_CHECK(found, "database vector not among its own top-k");
+
+    printf("PASS\n");
+}
+
+static void test_ivfpq_remove_ids() {
+    printf("test_ivfpq_remove_ids... ");
+
+    const size_t nv = 2000;
+    const size_t d = 32;
+    const size_t nlist = 8;
+    const size_t M = 8;
+    const size_t k = 10;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+
+    std::vector<float> vectors(nv * d);
+    for (auto &v : vectors)
+        v = dist(rng);
+
+    auto res = std::make_shared<StandardMetalResources>();
+    MetalIndexIVFPQ metal_index(res, d, nlist, M, faiss::METRIC_L2);
+    metal_index.train(nv, vectors.data());
+    metal_index.add(nv, vectors.data());
+    metal_index.setNprobe(nlist);
+
+    std::vector<float> distances(k);
+    std::vector<faiss::idx_t> labels(k);
+    const float *query = vectors.data() + 17 * d;
+    metal_index.search(1, query, k, distances.data(), labels.data());
+
+    // Remove every returned id: none may come back, and ntotal is unchanged
+    FATAL_CHECK(metal_index.removeIds(k, labels.data()) == k, "removeIds count");
+    FATAL_CHECK(metal_index.ntotal == (faiss::idx_t)nv, "removeIds must not change ntotal");
+
+    std::vector<faiss::idx_t> removed(labels);
+    metal_index.search(1, query, k, distances.data(), labels.data());
+    for (size_t i = 0; i < k; i++) {
+        FATAL_CHECK(labels[i] >= 0, "search after removal must still fill k results");
+        for (size_t j = 0; j < k; j++) {
+            FATAL_CHECK(labels[i] != removed[j], "removed id returned by search");
+        }
+    }
+
+    printf("PASS\n");
+}
+
+static void test_ivfpq_empty_search() {
+    printf("test_ivfpq_empty_search... ");
+
+    auto res = std::make_shared<StandardMetalResources>();
+    MetalIndexIVFPQ metal_index(res, 16, 4, 4, faiss::METRIC_L2);
+
+    std::vector<float> vectors(1000 * 16);
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1.0f, 1.0f);
+    for (auto &v : vectors)
+        v = dist(rng);
+    metal_index.train(1000, vectors.data());
+
+    std::vector<float> distances(3);
+    std::vector<faiss::idx_t> labels(3);
+    metal_index.search(1, vectors.data(), 3, distances.data(), labels.data());
+    for (size_t i = 0; i < 3; i++) {
+        FATAL_CHECK(labels[i] == -1, "empty index must return -1 labels");
+    }
+
+    printf("PASS\n");
+}
+
+int main() {
+    @autoreleasepool {
+        auto res = std::make_shared<StandardMetalResources>();
+        const auto &caps = res->getCapabilities();
+
+        printf("=== MetalIndexIVFPQ Tests ===\n");
+        printf("%s\n\n", faiss_metal::describeCapabilities(caps).c_str());
+
+        test_ivfpq_l2_basic();
+        test_ivfpq_ip();
+        test_ivfpq_conversion_roundtrip();
+        test_ivfpq_train_and_add();
+        test_ivfpq_remove_ids();
+        test_ivfpq_empty_search();
+
+        printf("\nAll MetalIndexIVFPQ tests passed!\n");
+    }
+    return 0;
+}
@@ -14,14 +14,12 @@ use std::{
 
 use diskann_utils::{
     Reborrow,
-    future::{AssertSend, AsyncFriendly, SendFuture, boxit},
+    future::{AssertSend, AsyncFriendly, SendFuture},
     reborrow::AsyncLower,
 };
 use diskann_vector::{DistanceFunction, PreprocessedDistanceFunction};
 use futures_util::FutureExt;
 use hashbrown::HashSet;
-use thiserror::Error;
-use tokio::task::JoinSet;
 use tracing::{debug, trace};
 
 use super::{
@@ -208,19 +206,6 @@ type BatchResult<T> = Result<T, (T, ANNError)>;
 ///   type parameter because the type of the query computer depends on the type of the query.
 pub type PagedSearchState<DP, S, C> = SearchState<<DP as DataProvider>::InternalId, (S, C)>;
 
-/// The result of invoking [`DiskANNIndex::set_elements`], which invokes [`SetElement`] on
-/// a batch of vector ids and returns the guards for the batch (as well as the batch data
-/// with the appropriate internal ids.
-struct SetBatchElements<G, I, T> {
-    /// The [`SetElement::Guard`]s for every item in the set.
-    guards: Vec<G>,
-
-    /// The batch with the corresponding internal ids. The elements here have a position-wide
-    /// correspondence with guards. That is, the guard at index `i` is the guard for
-    /// the data vector as index `i`.
-    batch: Arc<[VectorIdBoxSlice<I, T>]>,
-}
-
 pub struct NotInMutWithLabelCheck<'a, K>
 where
     K: VectorId,
@@ -618,7 +603,7 @@ where
     /// These results are aggregated into a vector, with an error being returned should any
     /// call to [`DP::set_element`] fail.
     ///
-    /// This is the leaf task for the batch [`Self::set_elements`] method.
+    /// This is the Set Elements phase of [`Self::multi_insert_on`].
     async fn set_chunk<T>(
         &self,
         context: &DP::Context,
@@ -644,78 +629,6 @@ where
         Ok(output)
     }
 
-    /// Parallelise the invocation of applying [`DP::set_element`] to all vectors `v` in
-    /// `vectors` using up to `ntasks` tasks.
-    ///
-    /// Return a pair consisting of the [`DP::set_element`] guards for each vector `v` in
-    /// vectors and an [`Arc`] slice of the translated vectors. This function bails if any
-    /// invocation of [`DP::set_element`] fails.
-    ///
-    /// The ordering of the guards will be consistent with the ordering of the translated
-    /// vectors, though this need not necessarily be the order of the input vectors.
-    ///
-    /// The data backing each translated vector will be the same as that in `vectors`. That
-    /// is, the backing data is *moved* internally, not copied.
-    fn set_elements<T>(
-        self: &Arc<Self>,
-        context: &DP::Context,
-        vectors: Box<[VectorIdBoxSlice<DP::ExternalId, T>]>,
-        ntasks: NonZeroUsize,
-    ) -> impl SendFuture<ANNResult<SetBatchElements<DP::Guard, DP::InternalId, T>>>
-    where
-        Self: 'static,
-        T: AsyncFriendly,
-        DP: SetElement<[T]>,
-    {
-        async move {
-            let len = vectors.len();
-            let partitions = async_tools::PartitionIter::new(vectors.len(), ntasks);
-
-            // In the loop below, we chunk `itr` according to the lengths in `partitions`.
-            let mut itr = vectors.into_iter();
-            let handles: Vec<_> = partitions
-                .map(|r| {
-                    let self_clone = self.clone();
-
-                    // Note: `by_ref`: avoids consuming `itr` but still take ownership of the
-                    // yielded elements.
-                    let chunk: Vec<_> = itr.by_ref().take(r.len()).collect();
-                    let context_clone = context.clone();
-
-                    // The task assigned to each round of `set_element`.
-                    let future = async move { self_clone.set_chunk(&context_clone, chunk).await };
-
-                    tokio::spawn(context.wrap_spawn(future))
-                })
-                .collect();
-
-            // The collection of all the insert guards for the batch.
-            let mut guards = Vec::with_capacity(len);
-
-            // The repackage input data.
-            let mut batch = Vec::with_capacity(len);
-
-            for h in handles {
-                let processed = h
-                    .await
-                    .map_err(|err| ANNError::new(ANNErrorKind::IndexError, err))??;
-                for (guard, data) in processed {
-                    let id = guard.id();
-                    guards.push(guard);
-                    batch.push(VectorIdBoxSlice {
-                        vector_id: id,
-                        vector: data,
-                    });
-                }
-            }
-
-            Ok(SetBatchElements {
-                guards,
-                batch: batch.into(),
-            })
-        }
-    }
-
     /// Continually retrieve items from `work`, invoking `search_and_prune` on each claimed
     /// item. Return a vector of all results processed by this task.
     ///
@@ -849,82 +762,14 @@ where
         }
     }
 
-    /// Entry point for the mulit-insert bootstrap routine and a parallelized version of
-    /// [`Self::multi_insert_bootstrap_task`]. Refer to that method for documentation on the
-    /// routine applied to each edge in `edges`.
-    ///
-    /// If `self.config.max_minibatch_par()` is 1 or `edge.len() == 1`, then no additional
-    /// spawns are made by this function.
-    fn multi_insert_bootstrap<S>(
-        self: Arc<Self>,
-        strategy: S,
-        context: DP::Context,
-        edges: Vec<PendingEdge<DP::InternalId>>,
-    ) -> impl SendFuture<ANNResult<Vec<PendingEdge<DP::InternalId>>>>
-    where
-        S: PruneStrategy<DP> + Clone,
-    {
-        async move {
-            let num_items = edges.len();
-            let work = Arc::new(DynamicBalancer::new(edges.into()));
-            let num_tasks = self.config.max_minibatch_par().get().min(num_items).max(1);
-
-            // Note: `num_tasks - 1` cannot underflow because `num_tasks` is guaranteed
-            // to be at least 1.
-            let handles: Vec<_> = (0..num_tasks - 1)
-                .map(|_| {
-                    let self_clone = self.clone();
-                    let strategy_clone = strategy.clone();
-                    let context_clone = context.clone();
-                    let work_clone = work.clone();
-                    tokio::spawn(context.wrap_spawn(async move {
-                        self_clone
-                            .multi_insert_bootstrap_task(
-                                &strategy_clone,
-                                &context_clone,
-                                &work_clone,
-                            )
-                            .await
-                    }))
-                })
-                .collect();
-
-            // Process work on this thread.
-            let mut next = match self
-                .multi_insert_bootstrap_task(&strategy, &context, &work)
-                .await
-            {
-                Ok(v) => v,
-                Err((v, err)) => {
-                    tracked_error!("main bootstrap task failed: {}", err);
-                    v
-                }
-            };
-
-            for h in handles {
-                match h.await {
-                    Ok(maybe_ok) => match maybe_ok {
-                        Ok(mut v) => next.append(&mut v),
-                        Err((mut v, err)) => {
-                            next.append(&mut v);
-                            tracked_error!("bootstrap task failed: {}", err);
-                        }
-                    },
-                    Err(err) => tracked_error!("boostrap spawn failed: {}", err),
-                }
-            }
-            Ok(next)
-        }
-    }
-
     /// Insert a small set of vectors into the index. The call parallelizes the search for
-    /// each vector as well as the subsequent pruning and edge addition.
-    ///
-    /// Each `multi_insert` makes at most one update (either `set` or `append`) per id to
-    /// the [`DataProvider`]. The algorithm resolves conflicting updates to adjacency lists
-    /// caused by multiple inserts without involving the provider in the resolution.
+    /// each vector as well as the subsequent pruning and edge addition: the parallel
+    /// phases run as up to `ntasks` tasks on the caller's `pool`, and every future is
+    /// driven by [`async_tools::TaskPool::block_on`]. No async runtime is needed.
     ///
-    /// This method receives `self` by `Arc` to allow cloning for parallel task spawns.
+    /// Each `multi_insert_on` makes at most one update (either `set` or `append`) per id
+    /// to the [`DataProvider`]. The algorithm resolves conflicting updates to adjacency
+    /// lists caused by multiple inserts without involving the provider in the resolution.
     ///
     /// - `strategy`: The [`InsertStrategy`] to use for insert searches and prunes.
     /// - `context` is the context to pass through to providers.
@@ -934,11 +779,7 @@ where
     ///
     /// Multi-insert specific configuration includes:
     ///
-    /// 1. [`diskann::index::Config::max_minibatch_par()`]: Control the maximum number
-    ///    of concurrent task spawns used by the implementation. This puts an upper bound
-    ///    on the extracted parallelism of this function.
-    ///
-    /// 2. [`diskann::index::Config::intra_batch_candidates()`]: Controls the maximum
+    /// 1. [`diskann::index::Config::intra_batch_candidates()`]: Controls the maximum
     ///    number of candidates from within the batch that are considered as neighbors.
     ///
     ///    When the batch size is very high or the inserted data has high self similarity,
@@ -955,8 +796,8 @@ where
     /// # Error Handling
     ///
     /// The error handling for this function is currently undergoing a revision. Currently,
-    /// errors encountered during tasks spawns are suppressed. The revision will inform
-    /// the caller of failed insertions in a more precise manner.
+    /// errors encountered inside the parallel tasks are suppressed. The revision will
+    /// inform the caller of failed insertions in a more precise manner.
     ///
     /// # Dev-Docs on Flow
     ///
@@ -966,8 +807,8 @@ where
     /// ## Set Elements
     ///
     /// Vectors taken from external sources need to be inserted into the underlying data
-    /// provider and an internal ID needs to be generated for these items. This phase
-    /// parallelizes the insertion and collects the internal IDs for the inserted vectors.
+    /// provider and an internal ID needs to be generated for these items. This phase runs
+    /// on the calling thread and collects the internal IDs for the inserted vectors.
     ///
     /// ## Candidate Generation
     ///
@@ -987,180 +828,145 @@ where
     /// updated. First with the generated candidates, and second to commit the backedges,
     /// triggering secondary prunes if necessary. This phase is partitioned so each parallel
     /// task updates a disjoint set of elements.
-    pub fn multi_insert<S, T>(
-        self: &Arc<Self>,
-        strategy: S,
+    pub fn multi_insert_on<S, T, P>(
+        &self,
+        strategy: &S,
         context: &DP::Context,
         vectors: Box<[VectorIdBoxSlice<DP::ExternalId, T>]>,
-    ) -> impl SendFuture<ANNResult<()>>
+        ntasks: NonZeroUsize,
+        pool: &P,
+    ) -> ANNResult<()>
     where
-        Self: 'static,
         T: AsyncFriendly,
-        S: InsertStrategy<DP, [T]> + Clone + AsyncFriendly,
+        S: InsertStrategy<DP, [T]> + Sync,
         DP: SetElement<[T]>,
-        S::PruneStrategy: Clone,
+        S::PruneStrategy: Sync,
+        P: async_tools::TaskPool,
         for<'a> aliases::InsertPruneAccessor<'a, S, DP, [T]>: AsElement<&'a [T]>,
     {
-        async move {
-            let num_tasks = self.config.max_minibatch_par();
-
-            //--------------//
-            // Set Elements //
-            //--------------//
-
-            let SetBatchElements { guards, batch } =
-                boxit(self.set_elements(context, vectors, num_tasks)).await?;
-
-            //----------------------//
-            // Candidate Generation //
-            //----------------------//
-
-            // Dynamically partition the work across tasks. The time spent processing each
-            // item (measured in the hundreds of micro-seconds) likely far exceeds the
-            // synchronization overhead of the atomic increment.
-            let work = Arc::new(DynamicBalancer::new(batch));
-
-            // Launch `max_minibatch_par - 1` tasks to do work, running the last task on
-            // the local thread.
-            let handles: Vec<_> = (0..num_tasks.get() - 1)
-                .map(|_| {
-                    let self_clone = self.clone();
-                    let strategy_clone = strategy.clone();
-                    let context_clone = context.clone();
-                    let work_clone = work.clone();
-                    let future = async move {
-                        self_clone
-                            .search_and_prune_batch(&strategy_clone, &context_clone, &work_clone)
-                            .await
-                    };
-                    tokio::spawn(context.wrap_spawn(future))
-                })
-                .collect();
-
-            // Defer dealing with the `result` until after we have joined the other tasks.
-            let mut edges = match self.search_and_prune_batch(&strategy, context, &work).await {
-                Ok(v) => v,
-                Err((v, err)) => {
-                    tracked_error!("search_prune_and_search main failed: {}", err);
-                    v
-                }
-            };
+        //--------------//
+        // Set Elements //
+        //--------------//
+
+        let mut guards = Vec::with_capacity(vectors.len());
+        let mut batch = Vec::with_capacity(vectors.len());
+        for (guard, data) in pool.block_on(self.set_chunk(context, vectors.into_vec()))? {
+            batch.push(VectorIdBoxSlice {
+                vector_id: guard.id(),
+                vector: data,
+            });
+            guards.push(guard);
+        }
 
-            // At this point - all the other tasks should be close to completing.
-            for h in handles {
-                match h.await {
-                    Ok(Ok(mut v)) => edges.append(&mut v),
-                    Ok(Err((mut v, err))) => {
-                        edges.append(&mut v);
-                        tracked_error!("search_prune_and_search failed: {}", err)
+        //----------------------//
+        // Candidate Generation //
+        //----------------------//
+
+        let work = DynamicBalancer::new(batch.into());
+        let edges = Mutex::new(Vec::with_capacity(work.len()));
+        pool.for_each(ntasks.get().min(work.len()), &|_| {
+            let mut processed =
+                match pool.block_on(self.search_and_prune_batch(strategy, context, &work)) {
+                    Ok(v) => v,
+                    Err((v, err)) => {
+                        tracked_error!("search_prune_and_search failed: {}", err);
+                        v
                     }
-                    Err(err) => tracked_error!("Tokio spawned task join error: {}", err),
-                }
-            }
-
-            let mut backedges = aggregate_backedges(&edges);
+                };
+            edges
+                .lock()
+                .unwrap_or_else(|p| p.into_inner())
+                .append(&mut processed);
+        })?;
+        let mut edges = edges.into_inner().unwrap_or_else(|p| p.into_inner());
+
+        let mut backedges = aggregate_backedges(&edges);
+        let prune_strategy = strategy.prune_strategy();
+
+        //-----------//
+        // Bootstrap //
+        //-----------//
+
+        // NB: update the docs if 8 changes.
+        if self.config.intra_batch_candidates().is_none()
+            && backedges.len().div_ceil(8) <= work.len()
+            && work.len() != 1
+        {
+            let pending = DynamicBalancer::new(edges.into());
+            let next = Mutex::new(Vec::with_capacity(pending.len()));
+            pool.for_each(ntasks.get().min(pending.len()), &|_| {
+                let mut processed = match pool.block_on(self.multi_insert_bootstrap_task(
+                    &prune_strategy,
+                    context,
+                    &pending,
+                )) {
+                    Ok(v) => v,
+                    Err((v, err)) => {
+                        tracked_error!("bootstrap task failed: {}", err);
+                        v
+                    }
+                };
+                next.lock()
+                    .unwrap_or_else(|p| p.into_inner())
+                    .append(&mut processed);
+            })?;
+            edges = next.into_inner().unwrap_or_else(|p| p.into_inner());
 
-            //-----------//
-            // Bootstrap //
-            //-----------//
+            backedges = aggregate_backedges(&edges);
+        }
 
-            // Check if number of unique back edges source is very small. If so, we do kick
-            // off the bootstrap routine and add edges from within the batch.
-            //
-            // If `work.len() == 1`, then there is nothing to bootstrap since there are no
-            // other edges in the batch.
-            if self.config.intra_batch_candidates().is_none()
-                && backedges.len().div_ceil(8) <= work.len() /* NB: update docs if 8 changes */
-                && work.len() != 1
-            {
-                edges = boxit(self.clone().multi_insert_bootstrap(
-                    strategy.prune_strategy(),
-                    context.clone(),
-                    edges,
-                ))
-                .await?;
+        //--------------//
+        // Graph Update //
+        //--------------//
 
-                backedges = aggregate_backedges(&edges);
-            }
+        {
+            let accessor = &mut prune_strategy
+                .prune_accessor(&self.data_provider, context)
+                .into_ann_result()?;
+            pool.block_on(
+                accessor.set_neighbors_bulk(
+                    edges
+                        .into_iter()
+                        .map(|PendingEdge { source, edges }| (source, edges)),
+                ),
+            )?;
+        }
 
-            let backedges = Arc::new(backedges);
+        // Each task commits the backedges of a disjoint range of sources.
+        pool.for_each(ntasks.get(), &|i| {
+            let result = pool.block_on(async {
+                let range = async_tools::partition(backedges.len(), ntasks, i)?;
+                let itr = backedges.iter().skip(range.start).take(range.len());
 
-            //--------------//
-            // Graph Update //
-            //--------------//
+                let mut prune_scratch = prune::Scratch::new();
+                let mut working_set = HashMap::new();
 
-            // Sequential assignment of the current neighbors. This does not yet appear
-            // to be a huge bottleneck (compared to backedge aggregation).
-            {
-                let prune_strategy = strategy.prune_strategy();
-                let accessor = &mut prune_strategy
-                    .prune_accessor(&self.data_provider, context)
-                    .into_ann_result()?;
-                accessor
-                    .set_neighbors_bulk(
-                        edges
-                            .into_iter()
-                            .map(|PendingEdge { source, edges }| (source, edges)),
+                for (source, adj_list) in itr {
+                    working_set.clear();
+                    self.add_edge_and_prune(
+                        &prune_strategy,
+                        context,
+                        adj_list,
+                        *source,
+                        &mut prune_scratch,
+                        &mut working_set,
+                        None,
                     )
                     .await?;
-            }
-
-            // Spawn backedge insertions.
-            let handles: Vec<_> = (0..num_tasks.get())
-                .map(|i| {
-                    let self_clone = self.clone();
-                    let context_clone = context.clone();
-                    let strategy_clone = strategy.prune_strategy();
-                    let backedges_clone = backedges.clone();
-                    tokio::spawn(context.wrap_spawn(async move {
-                        // Get the range of items to process in this task.
-                        let range = async_tools::partition(backedges_clone.len(), num_tasks, i)?;
-                        let itr = backedges_clone.iter().skip(range.start).take(range.len());
-
-                        let mut prune_scratch = prune::Scratch::new();
-                        let mut working_set = HashMap::new();
-
-                        for (source, adj_list) in itr {
-                            // FIXME: Give providers control over the size of the working
-                            // set.
-                            working_set.clear();
-                            self_clone
-                                .add_edge_and_prune(
-                                    &strategy_clone,
-                                    &context_clone,
-                                    adj_list,
-                                    *source,
-                                    &mut prune_scratch,
-                                    &mut working_set,
-                                    None,
-                                )
-                                .await?;
-                        }
-                        ANNResult::<()>::Ok(())
-                    }))
-                })
-                .collect();
-
-            for handle in handles {
-                let result = handle.await;
-                match result {
-                    Err(err) => {
-                        tracked_error!("Tokio task error in multi_insert: {}", err);
-                    }
-                    Ok(Err(err)) => {
-                        tracked_error!("Error in `add_edge_and_prune: {}", err);
-                    }
-                    Ok(Ok(())) => {}
                 }
+                ANNResult::<()>::Ok(())
+            });
+            if let Err(err) = result {
+                tracked_error!("Error in `add_edge_and_prune: {}", err);
             }
+        })?;
 
-            // Indicate the batch as complete.
-            for guard in guards {
-                guard.complete().await;
-            }
-
-            Ok(())
+        // Indicate the batch as complete.
+        for guard in guards {
+            pool.block_on(guard.complete());
         }
+
+        Ok(())
     }
 
     pub fn is_any_neighbor_deleted<NA>(
@@ -1478,186 +1284,124 @@ where
         }
     }
 
-    pub fn multi_inplace_delete<S>(
-        self: &Arc<Self>,
-        strategy: S,
+    /// Delete `ids` in place, in chunks of `max_minibatch_par` ids. The per-id edge
+    /// repairs and the re-prunes of the affected neighbours run as tasks on the caller's
+    /// `pool`; every future is driven by [`async_tools::TaskPool::block_on`].
+    ///
+    /// Errors inside a task are logged and the remaining work continues, as for
+    /// [`Self::multi_insert_on`].
+    pub fn multi_inplace_delete<S, P>(
+        &self,
+        strategy: &S,
         context: &DP::Context,
         ids: Arc<[DP::ExternalId]>,
         num_to_replace: usize,
         inplace_delete_method: InplaceDeleteMethod,
-    ) -> impl SendFuture<ANNResult<()>>
+        pool: &P,
+    ) -> ANNResult<()>
     where
-        Self: 'static + Send + Sync,
-        S: InplaceDeleteStrategy<DP>
-            + for<'a> SearchStrategy<DP, S::DeleteElement<'a>>
-            + Send
-            + Sync
-            + Clone,
-        DP: Delete + Send + Sync,
+        S: InplaceDeleteStrategy<DP> + for<'a> SearchStrategy<DP, S::DeleteElement<'a>> + Sync,
+        S::PruneStrategy: Sync,
+        DP: Delete,
+        P: async_tools::TaskPool,
     {
-        async move {
-            let max_minibatch_par = self.config.max_minibatch_par();
-            let chunk_iter = async_tools::arc_chunks(ids, max_minibatch_par);
-            for chunk in chunk_iter {
-                // Convert external ids in chunk to internal ids. We do this first as `inplace_delete_inner` may actually
-                // delete the mapping.
-                let mut ids_to_delete = HashSet::with_capacity(chunk.len());
-                for i in 0..chunk.len() {
-                    let vector_id = self
-                        .data_provider
-                        .to_internal_id(context, chunk.get(i))
-                        .escalate("id translation for `inplace_delete` must succeed")?;
-                    ids_to_delete.insert(vector_id);
-                }
+        let max_minibatch_par = self.config.max_minibatch_par();
+        for chunk in async_tools::arc_chunks(ids, max_minibatch_par) {
+            // Convert external ids in chunk to internal ids. We do this first as `inplace_delete_inner` may actually
+            // delete the mapping.
+            let mut ids_to_delete = HashSet::with_capacity(chunk.len());
+            for i in 0..chunk.len() {
+                let vector_id = self
+                    .data_provider
+                    .to_internal_id(context, chunk.get(i))
+                    .escalate("id translation for `inplace_delete` must succeed")?;
+                ids_to_delete.insert(vector_id);
+            }
 
-                // compute edge updates for each inplace delete, running in parallel
-                let handles: Vec<_> = (0..chunk.len())
-                    .map(|i| {
-                        let self_clone = Arc::clone(self);
-                        let chunk_clone = chunk.clone();
-                        let context_clone = context.clone();
-                        let strategy_clone = strategy.clone();
-                        let future = async move {
-                            self_clone
-                                .inplace_delete_inner(
-                                    &strategy_clone,
-                                    &context_clone,
-                                    chunk_clone.get(i),
-                                    num_to_replace,
-                                    &inplace_delete_method,
-                                )
-                                .await
-                        };
-                        tokio::spawn(context.wrap_spawn(future))
-                    })
-                    .collect();
-
-                let mut edge_collection = Vec::with_capacity(handles.len());
-                for h in handles {
-                    let res = h.await.map_err(|err| {
-                        #[derive(Debug, Error)]
-                        #[error("Spawning a task failed in inplace-delete: {0}")]
-                        struct LocalError(tokio::task::JoinError);
-
-                        ANNError::log_async_error(LocalError(err))
-                    });
-                    edge_collection.push(res);
+            // compute edge updates for each inplace delete, running in parallel
+            let edge_hashmaps = Mutex::new(Vec::with_capacity(chunk.len()));
+            pool.for_each(chunk.len(), &|i| {
+                match pool.block_on(self.inplace_delete_inner(
+                    strategy,
+                    context,
+                    chunk.get(i),
+                    num_to_replace,
+                    &inplace_delete_method,
+                )) {
+                    Ok(edges) => edge_hashmaps
+                        .lock()
+                        .unwrap_or_else(|p| p.into_inner())
+                        .push(edges),
+                    Err(ann_error) => tracked_error!(
+                        "inplace_delete returned error in multi_inplace_delete: {}",
+                        ann_error
+                    ),
                 }
-
-                // check for errors and collect ids to modify in one hashset
-                let mut ids_to_modify = HashSet::<DP::InternalId>::with_capacity(
-                    self.pruned_degree() * 2 * chunk.len(),
-                );
-                let mut edge_hashmaps = Vec::with_capacity(chunk.len());
-
-                for output in edge_collection {
-                    match output {
-                        Ok(Ok(edges)) => {
-                            for neighbor in edges.keys() {
-                                ids_to_modify.insert(*neighbor);
-                            }
-                            edge_hashmaps.push(edges);
-                        }
-                        Ok(Err(ann_error)) => {
-                            tracked_error!(
-                                "inplace_delete returned error in multi_inplace_delete: {}",
-                                ann_error
-                            );
-                        }
-                        Err(err) => {
-                            tracked_error!(
-                                "Tokio spawned task has a join error in multi_inplace_delete: {}",
-                                err
-                            );
-                        }
-                    }
+            })?;
+            let edge_hashmaps = edge_hashmaps.into_inner().unwrap_or_else(|p| p.into_inner());
+
+            // collect ids to modify in one hashset
+            let mut ids_to_modify =
+                HashSet::<DP::InternalId>::with_capacity(self.pruned_degree() * 2 * chunk.len());
+            for edges in &edge_hashmaps {
+                for neighbor in edges.keys() {
+                    ids_to_modify.insert(*neighbor);
                 }
+            }
 
-                // next, insert and prune, adding the option to remove all the deleted neighbors
-                // at each prune. this runs in parallel and respects the max_minibatch_par
-
-                let num_tasks = NonZeroUsize::new(ids_to_modify.len())
-                    .unwrap_or(max_minibatch_par)
-                    .min(max_minibatch_par);
-
-                let edges_to_add = Arc::new(Mutex::new(ids_to_modify.into_iter()));
-                let ids_to_delete = Arc::new(ids_to_delete);
-                let edge_hashmaps = Arc::new(edge_hashmaps);
-
-                let mut tasks = JoinSet::new();
-                for _ in 0..num_tasks.get() {
-                    let self_clone = self.clone();
-                    let context_clone = context.clone();
-                    let strategy_clone = strategy.prune_strategy();
-                    let edges_clone = edges_to_add.clone();
-                    let ids_to_delete_clone = ids_to_delete.clone();
-                    let edge_hashmaps_clone = edge_hashmaps.clone();
-                    tasks.spawn(async move {
-                        loop {
-                            let result = {
-                                let mut guard = edges_clone.lock().map_err(|_| {
-                                    ANNError::log_async_error("Poisoned mutex during construction")
-                                })?;
-                                guard.next()
-                            };
-
-                            let mut prune_scratch = prune::Scratch::new();
-                            let mut working_set = HashMap::new();
-
-                            match result {
-                                Some(source) => {
-                                    let mut adj_list = Vec::new();
-                                    for edge_hashmap in edge_hashmaps_clone.iter() {
-                                        if let Some(edges) = edge_hashmap.get(&source) {
-                                            // note: we don't deduplicate here because it's faster to let add_edge_and_prune handle it
-                                            adj_list.extend_from_slice(edges);
-                                        }
-                                    }
-
-                                    // FIXME: Give providers more control over the working
-                                    // set.
-                                    working_set.clear();
-                                    self_clone
-                                        .add_edge_and_prune(
-                                            &strategy_clone,
-                                            &context_clone,
-                                            &adj_list,
-                                            source,
-                                            &mut prune_scratch,
-                                            &mut working_set,
-                                            Some(&ids_to_delete_clone), // delete any edges to a deleted point as part of add_edge_and_prune
-                                        )
-                                        .await?;
-                                }
-                                None => break,
-                            }
+            // next, insert and prune, adding the option to remove all the deleted neighbors
+            // at each prune. this runs in parallel and respects the max_minibatch_par
+            let num_tasks = ids_to_modify.len().min(max_minibatch_par.get());
+            let edges_to_add = Mutex::new(ids_to_modify.into_iter());
+            let prune_strategy = strategy.prune_strategy();
+            pool.for_each(num_tasks, &|_| {
+                let mut prune_scratch = prune::Scratch::new();
+                let mut working_set = HashMap::new();
+                loop {
+                    let next = edges_to_add
+                        .lock()
+                        .unwrap_or_else(|p| p.into_inner())
+                        .next();
+                    let Some(source) = next else {
+                        break;
+                    };
+                    let mut adj_list = Vec::new();
+                    for edge_hashmap in edge_hashmaps.iter() {
+                        if let Some(edges) = edge_hashmap.get(&source) {
+                            // note: we don't deduplicate here because it's faster to let add_edge_and_prune handle it
+                            adj_list.extend_from_slice(edges);
                         }
-                        ANNResult::Ok(())
-                    });
-                }
+                    }
 
-                // Wait for all tasks to complete.
-                while let Some(result) = tasks.join_next().await {
-                    if let Err(_e) = result {
-                        tracked_error!("Tokio task JoinError in multi_inplace_delete");
-                    } else if let Ok(Err(e)) = result {
+                    // FIXME: Give providers more control over the working
+                    // set.
+                    working_set.clear();
+                    if let Err(e) = pool.block_on(self.add_edge_and_prune(
+                        &prune_strategy,
+                        context,
+                        &adj_list,
+                        source,
+                        &mut prune_scratch,
+                        &mut working_set,
+                        Some(&ids_to_delete), // delete any edges to a deleted point as part of add_edge_and_prune
+                    )) {
                         tracked_error!("Error in add_edge_and_prune: {}", e);
+                        break;
                     }
                 }
+            })?;
 
-                // finally, drop each deleted neighbor's edges, this can run sequentially
-                let prune_strategy = strategy.prune_strategy();
-                let mut accessor = prune_strategy
-                    .prune_accessor(&self.data_provider, context)
-                    .into_ann_result()?;
+            // finally, drop each deleted neighbor's edges, this can run sequentially
+            let mut accessor = prune_strategy
+                .prune_accessor(&self.data_provider, context)
+                .into_ann_result()?;
 
-                for vector_id in ids_to_delete.iter() {
-                    self.drop_adj_list(&mut accessor, *vector_id).await?;
-                }
+            for vector_id in ids_to_delete.iter() {
+                pool.block_on(self.drop_adj_list(&mut accessor, *vector_id))?;
             }
-
-            Ok(())
         }
+
+        Ok(())
     }
 
     /// This method deletes a vertex without needing to loop over the entire graph to find
@@ -11,6 +11,7 @@ use crate::graph::{
     self, AdjacencyList, DiskANNIndex,
     test::provider::{self as test_provider},
 };
+use crate::test::tokio::{RuntimePool, current_thread_runtime};
 
 fn inplace_delete_setup() -> Arc<DiskANNIndex<test_provider::Provider>> {
     let provider_config = test_provider::Config::new(
@@ -66,28 +67,27 @@ async fn basic_single() {
 /// returns. Inplace delete should still be able to complete successfully. As the single and multi
 /// in place delete logic have slightly different code paths for ID tranlsations, we have tests
 /// for both.
-#[tokio::test(flavor = "current_thread")]
-async fn basic_multi() {
+#[test]
+fn basic_multi() {
     let index = inplace_delete_setup();
+    let rt = current_thread_runtime();
 
     let ctx = test_provider::Context::default();
     let strat = test_provider::Strategy::new();
 
     for i in 1..6 {
-        index
-            .insert(strat, &ctx, &i, &[i as f32, i as f32])
-            .await
+        rt.block_on(index.insert(strat, &ctx, &i, &[i as f32, i as f32]))
             .unwrap();
     }
 
     index
         .multi_inplace_delete(
-            strat,
+            &strat,
             &ctx,
             Arc::new([3, 4]),
             3,
             graph::InplaceDeleteMethod::OneHop,
+            &RuntimePool(&rt),
         )
-        .await
         .unwrap();
 }
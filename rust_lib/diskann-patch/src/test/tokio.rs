@@ -12,3 +12,22 @@ pub(crate) fn current_thread_runtime() -> tokio::runtime::Runtime {
         .build()
         .expect("current thread runtime initialization should succeed for tests")
 }
+
+/// A [`TaskPool`](crate::utils::async_tools::TaskPool) that runs every task in turn on the
+/// calling thread and drives futures with the wrapped runtime.
+pub(crate) struct RuntimePool<'a>(pub(crate) &'a tokio::runtime::Runtime);
+
+impl crate::utils::async_tools::TaskPool for RuntimePool<'_> {
+    fn for_each(
+        &self,
+        ntasks: usize,
+        task: &(dyn Fn(usize) + Sync),
+    ) -> Result<(), crate::ANNError> {
+        (0..ntasks).for_each(task);
+        Ok(())
+    }
+
+    fn block_on<F: std::future::Future>(&self, future: F) -> F::Output {
+        self.0.block_on(future)
+    }
+}
@@ -393,6 +393,21 @@ impl From<PartitionError> for ANNError {
     }
 }
 
+///////////////
+// Task Pool //
+///////////////
+
+/// A fork-join pool supplied by the caller, used in place of `tokio::spawn` by
+/// [`crate::graph::DiskANNIndex::multi_insert_on`].
+pub trait TaskPool: Sync {
+    /// Run `task(i)` for every `i` in `0..ntasks` and return once all of them have
+    /// finished. Tasks may run concurrently on any thread.
+    fn for_each(&self, ntasks: usize, task: &(dyn Fn(usize) + Sync)) -> Result<(), ANNError>;
+
+    /// Drive `future` to completion on the calling thread.
+    fn block_on<F: std::future::Future>(&self, future: F) -> F::Output;
+}
+
 #[cfg(test)]
 mod tests {
     use std::collections::HashSet;
@@ -0,0 +1,303 @@
+//! Checkpoint merge for `storage = 'disk'` indexes: a read-only sector file (the
+//! base, served by `DiskProvider`) plus an in-memory delta of rows inserted since.
+//!
+//! The merged graph has the base nodes first (ids unchanged) and the delta nodes after
+//! them (delta label l becomes base_len + l):
+//!
+//! 1. Every delta node searches the base graph for its closest nodes and joins them
+//!    with its delta neighbours, then robust-prunes the union to max_degree.
+//! 2. The reverse of each chosen edge is queued on its target; targets pushed over
+//!    max_degree are pruned again.
+//!
+//!    Both steps run as tasks on the caller's `Scheduler`.
+//! 3. `append_to_file` writes the delta nodes' sectors after the base's in the same
+//!    file and rewrites the adjacency rows of the base nodes step 2 touched, then
+//!    publishes the new node count in the header. `merge_to_file` (the first
+//!    checkpoint, and compaction) instead streams every node in id order into a new
+//!    file through `SectorWriter`, so the base is only read, never held in memory.
+//!
+//! Tombstones of both inputs carry over (delta ones shifted by base_len): deleted
+//! nodes keep routing, exactly as they did before the merge.
+
+use std::fs::{File, OpenOptions};
+use std::io::{BufWriter, Seek, SeekFrom, Write};
+use std::path::{Path, PathBuf};
+
+use anyhow::{anyhow, Result};
+
+use crate::disk_provider::DiskProvider;
+use crate::file_format::{metric_to_u8, FileHeader, SectorWriter, VERSION_SECTOR};
+use crate::graph_merge::{map_tasks, CopiedGraph, MergedNodes};
+use crate::index_manager::{InMemoryIndex, Metric};
+use crate::runtime::Scheduler;
+
+/// Vectors by merged id, wherever they live.
+struct Nodes<'a> {
+    base: Option<&'a DiskProvider>,
+    base_len: u32,
+    delta: &'a CopiedGraph,
+    metric: Metric,
+}
+
+impl MergedNodes for Nodes<'_> {
+    fn metric(&self) -> Metric {
+        self.metric
+    }
+
+    fn vector(&self, id: u32) -> &[f32] {
+        if id < self.base_len {
+            self.base.map_or(&[], |b| b.vector(id))
+        } else {
+            let local = (id - self.base_len) as usize;
+            if local < self.delta.len() {
+                self.delta.vector(local)
+            } else {
+                &[]
+            }
+        }
+    }
+}
+
+/// The merged graph's new and changed adjacency, before it is written anywhere.
+struct MergePlan {
+    base_len: u32,
+    delta_data: CopiedGraph,
+    /// Base nodes whose neighbour lists took reverse edges from the delta
+    repaired: hashbrown::HashMap<u32, Vec<u32>>,
+    delta_adjacency: Vec<Vec<u32>>,
+}
+
+fn plan_merge(base: Option<&DiskProvider>, delta: &InMemoryIndex, scheduler: &Scheduler) -> Result<MergePlan> {
+    let base_len = base.map_or(0, |b| b.len()) as u32;
+    if let Some(b) = base {
+        if b.dimension() != delta.dimension
+            || b.max_degree() != delta.max_degree as usize
+            || b.metric() != delta.metric
+        {
+            return Err(anyhow!(
+                "Delta (dim {}, R {}, {}) does not match the disk index (dim {}, R {}, {})",
+                delta.dimension,
+                delta.max_degree,
+                delta.metric,
+                b.dimension(),
+                b.max_degree(),
+                b.metric()
+            ));
+        }
+    }
+    let delta_data = CopiedGraph::load(delta, base_len)?;
+    let nodes = Nodes {
+        base,
+        base_len,
+        delta: &delta_data,
+        metric: delta.metric,
+    };
+    let degree = delta.max_degree as usize;
+    let alpha = delta.alpha;
+    let search_l = (delta.build_complexity as usize).max(degree);
+
+    // 1. Forward edges of every delta node
+    let forward: Vec<Vec<u32>> = map_tasks(scheduler, delta_data.len(), |local| {
+        let v = delta_data.vector(local);
+        let mut candidates = base.map_or_else(Vec::new, |b| b.search_candidates(v, search_l));
+        let id = base_len + local as u32;
+        for &n in &delta_data.adjacency[local] {
+            if n != id {
+                candidates.push((nodes.distance(v, n), n));
+            }
+        }
+        Ok(nodes.robust_prune(candidates, alpha, degree))
+    })?;
+
+    // 2. Reverse edges, then re-prune the base nodes they land on
+    let mut reverse_base: hashbrown::HashMap<u32, Vec<u32>> = hashbrown::HashMap::new();
+    let mut reverse_delta: Vec<Vec<u32>> = vec![Vec::new(); delta_data.len()];
+    for (local, edges) in forward.iter().enumerate() {
+        let id = base_len + local as u32;
+        for &t in edges {
+            if t < base_len {
+                reverse_base.entry(t).or_default().push(id);
+            } else {
+                reverse_delta[(t - base_len) as usize].push(id);
+            }
+        }
+    }
+    let touched: Vec<(u32, Vec<u32>)> = reverse_base.into_iter().collect();
+    let repaired: hashbrown::HashMap<u32, Vec<u32>> = map_tasks(scheduler, touched.len(), |i| {
+        let (t, extra) = &touched[i];
+        let existing = base.map_or_else(Vec::new, |b| b.live_neighbors(*t));
+        Ok((*t, nodes.union_prune(*t, &existing, extra, alpha, degree)))
+    })?
+    .into_iter()
+    .collect();
+    let delta_adjacency: Vec<Vec<u32>> = map_tasks(scheduler, delta_data.len(), |local| {
+        let id = base_len + local as u32;
+        Ok(nodes.union_prune(id, &forward[local], &reverse_delta[local], alpha, degree))
+    })?;
+    Ok(MergePlan {
+        base_len,
+        delta_data,
+        repaired,
+        delta_adjacency,
+    })
+}
+
+/// One v3 node record: the vector, then the adjacency row padded with u32::MAX.
+fn encode_node(out: &mut [u8], vector: &[f32], neighbors: &[u32], max_degree: usize) {
+    let (vec_bytes, adj_bytes) = out.split_at_mut(vector.len() * 4);
+    for (dst, v) in vec_bytes.chunks_exact_mut(4).zip(vector) {
+        dst.copy_from_slice(&v.to_le_bytes());
+    }
+    encode_adjacency(adj_bytes, neighbors, max_degree);
+}
+
+fn encode_adjacency(out: &mut [u8], neighbors: &[u32], max_degree: usize) {
+    let n = neighbors.len().min(max_degree);
+    for (slot, dst) in out.chunks_exact_mut(4).take(max_degree).enumerate() {
+        let id = if slot < n { neighbors[slot] } else { u32::MAX };
+        dst.copy_from_slice(&id.to_le_bytes());
+    }
+}
+
+/// Tombstones of both inputs in merged ids (delta ones shifted by base_len).
+fn merged_tombstones(base: Option<&DiskProvider>, delta: &InMemoryIndex, base_len: u32) -> Vec<u64> {
+    let mut tombstones = base.map_or_else(Vec::new, |b| b.tombstone_words());
+    let delta_words = delta.tombstone_words();
+    for (w, &word) in delta_words.iter().enumerate() {
+        let mut bits = word;
+        while bits != 0 {
+            let id = base_len + (w as u32) * 64 + bits.trailing_zeros();
+            bits &= bits - 1;
+            let slot = (id >> 6) as usize;
+            if slot >= tombstones.len() {
+                tombstones.resize(slot + 1, 0);
+            }
+            tombstones[slot] |= 1u64 << (id & 63);
+        }
+    }
+    tombstones
+}
+
+/// Write the merge of `base` (may be None: first checkpoint) and `delta` to `path` as
+/// a new sector-aligned v3 file, then open it with both inputs' tombstones applied.
+///
+/// The file is written to `<path>.tmp` and renamed into place once synced, so `path`
+/// only ever holds a complete index.
+pub fn merge_to_file(
+    base: Option<&DiskProvider>,
+    delta: &InMemoryIndex,
+    path: &Path,
+    cache_nodes: Option<usize>,
+    scheduler: &Scheduler,
+) -> Result<DiskProvider> {
+    let plan = plan_merge(base, delta, scheduler)?;
+    let base_len = plan.base_len;
+    let entry_points: Vec<u32> = match base {
+        Some(b) if base_len > 0 => b.entry_points().to_vec(),
+        _ => delta.get_entry_points().iter().map(|&e| e + base_len).collect(),
+    };
+    let header = FileHeader {
+        version: VERSION_SECTOR,
+        num_vectors: base_len + plan.delta_data.len() as u32,
+        dimension: delta.dimension as u32,
+        max_degree: delta.max_degree,
+        num_entry_points: entry_points.len() as u32,
+        metric: metric_to_u8(delta.metric),
+        build_complexity: base.map_or(delta.build_complexity, |b| b.build_complexity()),
+    };
+    let mut tmp = path.as_os_str().to_owned();
+    tmp.push(".tmp");
+    let tmp = PathBuf::from(tmp);
+    let write = || -> std::io::Result<()> {
+        let file = File::create(&tmp)?;
+        let mut w = BufWriter::new(file);
+        let mut writer = SectorWriter::new(&mut w, header, &entry_points)?;
+        if let Some(b) = base {
+            for id in 0..base_len {
+                let neighbors = plan.repaired.get(&id).map_or_else(|| b.live_neighbors(id), |r| r.clone());
+                writer.push(b.vector(id), &neighbors)?;
+            }
+        }
+        for (local, neighbors) in plan.delta_adjacency.iter().enumerate() {
+            writer.push(plan.delta_data.vector(local), neighbors)?;
+        }
+        writer.finish()?;
+        w.flush()?;
+        w.get_ref().sync_all()
+    };
+    if let Err(e) = write() {
+        let _ = std::fs::remove_file(&tmp);
+        return Err(anyhow!("Failed to write '{}': {}", tmp.display(), e));
+    }
+    std::fs::rename(&tmp, path).map_err(|e| anyhow!("Failed to rename '{}': {}", tmp.display(), e))?;
+
+    let merged = DiskProvider::open(path, cache_nodes)
+        .map_err(|e| anyhow!("Failed to open merged index '{}': {}", path.display(), e))?;
+    merged.set_tombstones(merged_tombstones(base, delta, base_len));
+    Ok(merged)
+}
+
+/// Merge `delta` into `base`'s own file at `path`: the delta nodes' sectors are written
+/// after the base's, the base nodes that took reverse edges get their adjacency rows
+/// patched in place, and the header's node count is bumped last. Returns a handle on
+/// the grown file with both tombstone sets applied; `base` stays usable until freed.
+///
+/// Until the caller's checkpoint records the new count, the file is still the base for
+/// whoever opens it with `DiskProvider::open_nodes(.., Some(base_len))`: each appended
+/// node lies past base_len and the patched rows only gain edges that it skips, so at
+/// worst those nodes lose the edges the re-prune replaced.
+pub fn append_to_file(
+    base: &DiskProvider,
+    delta: &InMemoryIndex,
+    path: &Path,
+    cache_nodes: Option<usize>,
+    scheduler: &Scheduler,
+) -> Result<DiskProvider> {
+    if !base.header().is_sector_layout() {
+        return Err(anyhow!("'{}' is not a sector-aligned index file", path.display()));
+    }
+    let plan = plan_merge(Some(base), delta, scheduler)?;
+    let base_len = plan.base_len;
+    let old_header = base.header().clone();
+    let mut header = old_header.clone();
+    header.num_vectors = base_len + plan.delta_data.len() as u32;
+    let degree = header.max_degree as usize;
+    let dim_bytes = header.dimension as usize * 4;
+
+    let write = || -> std::io::Result<()> {
+        let mut file = OpenOptions::new().read(true).write(true).open(path)?;
+        // The appended nodes as one contiguous run, from base_len's slot to the new end
+        let start = header.node_offset(base_len);
+        let end = header.total_file_size();
+        let mut run = vec![0u8; end - start];
+        for (local, neighbors) in plan.delta_adjacency.iter().enumerate() {
+            let offset = header.node_offset(base_len + local as u32) - start;
+            let record = &mut run[offset..offset + header.node_size()];
+            encode_node(record, plan.delta_data.vector(local), neighbors, degree);
+        }
+        // A partly filled last base sector keeps its base nodes: only the free slots
+        // after them are in `run`
+        file.seek(SeekFrom::Start(start as u64))?;
+        file.write_all(&run)?;
+
+        let mut touched: Vec<(&u32, &Vec<u32>)> = plan.repaired.iter().collect();
+        touched.sort_unstable_by_key(|(id, _)| **id);
+        let mut row = vec![0u8; degree * 4];
+        for (&id, neighbors) in touched {
+            encode_adjacency(&mut row, neighbors, degree);
+            file.seek(SeekFrom::Start((old_header.node_offset(id) + dim_bytes) as u64))?;
+            file.write_all(&row)?;
+        }
+        // Nodes and rows first, then the count that makes them part of the file
+        file.sync_data()?;
+        file.seek(SeekFrom::Start(8))?;
+        file.write_all(&header.num_vectors.to_le_bytes())?;
+        file.sync_all()
+    };
+    write().map_err(|e| anyhow!("Failed to append to '{}': {}", path.display(), e))?;
+
+    let merged = DiskProvider::open(path, cache_nodes)
+        .map_err(|e| anyhow!("Failed to reopen index '{}': {}", path.display(), e))?;
+    merged.set_tombstones(merged_tombstones(Some(base), delta, base_len));
+    Ok(merged)
+}
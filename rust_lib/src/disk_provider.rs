@@ -1,13 +1,20 @@
 //! Read-only mmap-backed DiskANN index with standalone greedy best-first search.
+//!
+//! v3 files keep each node's vector and adjacency in one sector, so a hop costs one
+//! read. Every expansion first issues `madvise(WILLNEED)` for all the sectors of its
+//! unvisited neighbors, so their reads are in flight together instead of faulting in
+//! one by one, and the BFS-nearest nodes around the entry points are pinned in memory.
 
 use std::cell::RefCell;
-use std::collections::BinaryHeap;
+use std::collections::{BinaryHeap, VecDeque};
 use std::io;
 use std::path::Path;
+use std::sync::atomic::{AtomicU64, Ordering};
 
 use memmap2::Mmap;
+use parking_lot::RwLock;
 
-use crate::file_format::{FileHeader, HEADER_SIZE, MAGIC, VERSION};
+use crate::file_format::{FileHeader, HEADER_SIZE, MAGIC, VERSION, VERSION_SECTOR};
 use crate::index_manager::Metric;
 
 /// Page-aligned Vec<f32> for zero-copy Metal buffer wrapping.
@@ -179,6 +186,28 @@ thread_local! {
     static SEARCH_CTX: RefCell<SearchContext> = RefCell::new(SearchContext::new());
 }
 
+/// Node cache budget when the caller does not give a size.
+pub const DEFAULT_CACHE_BYTES: usize = 64 * 1024 * 1024;
+
+/// Nodes pinned in memory: the BFS-nearest to the entry points, which every search
+/// passes through first. `slots` maps a node id to its row in `vectors` / `adjacency`.
+struct NodeCache {
+    slots: hashbrown::HashMap<u32, u32>,
+    vectors: Vec<f32>,
+    /// `max_degree` slots per row, padded with u32::MAX
+    adjacency: Vec<u32>,
+}
+
+impl NodeCache {
+    fn empty() -> Self {
+        Self {
+            slots: hashbrown::HashMap::new(),
+            vectors: Vec::new(),
+            adjacency: Vec::new(),
+        }
+    }
+}
+
 /// Read-only mmap-backed DiskANN index.
 ///
 /// Uses offset-based access into the mmap slice — no raw pointers stored.
@@ -187,18 +216,41 @@ pub struct DiskProvider {
     mmap: Mmap,
     header: FileHeader,
     entry_point_ids: Vec<u32>,
+    /// v2 only: start of the vectors segment
     vectors_offset: usize,
+    /// v2 only: start of the adjacency segment
     adjacency_offset: usize,
     /// Pre-computed end of vectors segment for bounds checking.
     vectors_end: usize,
     /// Pre-computed end of adjacency segment for bounds checking.
     adjacency_end: usize,
     metric: Metric,
+    cache: NodeCache,
+    /// Deleted nodes (bit l%64 of word l/64): they keep routing but are never returned
+    tombstones: RwLock<Vec<u64>>,
+    deleted: AtomicU64,
+}
+
+/// Bit `id` of a label bitmap.
+#[inline]
+fn bit_set(words: &[u64], id: u32) -> bool {
+    words
+        .get((id >> 6) as usize)
+        .is_some_and(|w| (w >> (id & 63)) & 1 == 1)
 }
 
 impl DiskProvider {
-    /// Open and validate a .diskann file.
-    pub fn open(path: &Path) -> io::Result<Self> {
+    /// Open and validate a .diskann file (v2 or sector-aligned v3). `cache_nodes` nodes
+    /// around the entry points are pinned in memory; `None` sizes the cache to
+    /// `DEFAULT_CACHE_BYTES`.
+    pub fn open(path: &Path, cache_nodes: Option<usize>) -> io::Result<Self> {
+        Self::open_nodes(path, cache_nodes, None)
+    }
+
+    /// `open` limited to the first `num_nodes` nodes of a v3 file. The rest is an append
+    /// (`disk_merge::append_to_file`) that the caller's checkpoint never committed: edges
+    /// into it are skipped, and the next append writes over it.
+    pub fn open_nodes(path: &Path, cache_nodes: Option<usize>, num_nodes: Option<u32>) -> io::Result<Self> {
         let file = std::fs::File::open(path)?;
         let mmap = unsafe { Mmap::map(&file)? };
 
@@ -215,10 +267,13 @@ impl DiskProvider {
         }
 
         let version = read_u32_io(&mmap, 4)?;
-        if version != VERSION {
+        if version != VERSION && version != VERSION_SECTOR {
             return Err(io::Error::new(
                 io::ErrorKind::InvalidData,
-                format!("unsupported version {} (expected {})", version, VERSION),
+                format!(
+                    "unsupported version {} (expected {} or {})",
+                    version, VERSION, VERSION_SECTOR
+                ),
             ));
         }
 
@@ -230,7 +285,22 @@ impl DiskProvider {
         // bytes 25..28: padding
         let build_complexity = read_u32_io(&mmap, 28)?;
 
+        if dimension == 0 {
+            return Err(io::Error::new(io::ErrorKind::InvalidData, "invalid dimension 0"));
+        }
+
+        let num_vectors = match num_nodes {
+            Some(n) if n < num_vectors && version == VERSION_SECTOR => n,
+            Some(n) if n != num_vectors => {
+                return Err(io::Error::new(
+                    io::ErrorKind::InvalidData,
+                    format!("file holds {} nodes, {} expected", num_vectors, n),
+                ));
+            }
+            _ => num_vectors,
+        };
         let header = FileHeader {
+            version,
             num_vectors,
             dimension,
             max_degree,
@@ -266,7 +336,14 @@ impl DiskProvider {
         let vectors_end = vectors_offset + header.vectors_size();
         let adjacency_end = adjacency_offset + header.adjacency_size();
 
-        Ok(Self {
+        // Node sectors are read at random: kernel readahead would only pull in unrelated nodes
+        #[cfg(unix)]
+        if header.is_sector_layout() {
+            let _ = mmap.advise(memmap2::Advice::Random);
+        }
+
+        let cache_nodes = cache_nodes.unwrap_or(DEFAULT_CACHE_BYTES / header.node_size());
+        let mut provider = Self {
             mmap,
             header,
             entry_point_ids,
@@ -275,7 +352,133 @@ impl DiskProvider {
             vectors_end,
             adjacency_end,
             metric,
-        })
+            cache: NodeCache::empty(),
+            tombstones: RwLock::new(Vec::new()),
+            deleted: AtomicU64::new(0),
+        };
+        provider.cache = provider.load_cache(cache_nodes);
+        Ok(provider)
+    }
+
+    /// Read the `max_nodes` nodes nearest (in hops) to the entry points into memory.
+    fn load_cache(&self, max_nodes: usize) -> NodeCache {
+        let n = self.header.num_vectors;
+        let max_nodes = max_nodes.min(n as usize);
+        let mut cache = NodeCache::empty();
+        if max_nodes == 0 {
+            return cache;
+        }
+        let deg = self.max_degree();
+        cache.slots.reserve(max_nodes);
+        cache.vectors.reserve(max_nodes * self.dimension());
+        cache.adjacency.reserve(max_nodes * deg);
+
+        let mut queue: VecDeque<u32> = self.entry_point_ids.iter().copied().filter(|&ep| ep < n).collect();
+        while let Some(id) = queue.pop_front() {
+            if cache.slots.len() >= max_nodes {
+                break;
+            }
+            if cache.slots.contains_key(&id) {
+                continue;
+            }
+            let vec = self.get_vector(id);
+            if vec.is_empty() {
+                continue;
+            }
+            let neighbors = self.get_neighbors(id);
+            cache.slots.insert(id, cache.slots.len() as u32);
+            cache.vectors.extend_from_slice(vec);
+            cache.adjacency.extend_from_slice(neighbors);
+            cache.adjacency.resize(cache.slots.len() * deg, u32::MAX);
+            for &neighbor in neighbors {
+                if neighbor < n && !cache.slots.contains_key(&neighbor) {
+                    queue.push_back(neighbor);
+                }
+            }
+        }
+        cache
+    }
+
+    /// Nodes pinned in memory by the hot-node cache.
+    pub fn cached_nodes(&self) -> usize {
+        self.cache.slots.len()
+    }
+
+    /// Resident bytes: the node cache and the tombstones. The mmap'd file is the
+    /// OS page cache's to keep or drop.
+    pub fn memory_bytes(&self) -> usize {
+        let cache = &self.cache;
+        cache.vectors.len() * 4
+            + cache.adjacency.len() * 4
+            + cache.slots.capacity() * 8
+            + self.tombstones.read().len() * 8
+    }
+
+    pub fn entry_points(&self) -> &[u32] {
+        &self.entry_point_ids
+    }
+
+    /// Copy of node `id`'s vector, None if out of range.
+    pub fn get_vector_copy(&self, id: u32) -> Option<Vec<f32>> {
+        let vec = self.get_vector(id);
+        (!vec.is_empty()).then(|| vec.to_vec())
+    }
+
+    /// Zero-copy view of node `id`'s vector (empty if out of range).
+    pub fn vector(&self, id: u32) -> &[f32] {
+        self.get_vector(id)
+    }
+
+    /// Neighbors of node `id` (empty if out of range).
+    pub fn neighbors(&self, id: u32) -> &[u32] {
+        self.get_neighbors(id)
+    }
+
+    /// Neighbors of node `id` within the file's nodes: a file opened with `open_nodes`
+    /// may still hold edges into the uncommitted append past them.
+    pub fn live_neighbors(&self, id: u32) -> Vec<u32> {
+        let n = self.header.num_vectors;
+        self.get_neighbors(id).iter().copied().filter(|&x| x < n).collect()
+    }
+
+    pub fn header(&self) -> &FileHeader {
+        &self.header
+    }
+
+    /// Tombstone `labels`. Returns the number newly deleted.
+    pub fn mark_deleted(&self, labels: &[u32]) -> usize {
+        let mut words = self.tombstones.write();
+        let mut added = 0;
+        for &label in labels {
+            if label >= self.header.num_vectors {
+                continue;
+            }
+            let w = (label >> 6) as usize;
+            if w >= words.len() {
+                words.resize(w + 1, 0);
+            }
+            let bit = 1u64 << (label & 63);
+            if words[w] & bit == 0 {
+                words[w] |= bit;
+                added += 1;
+            }
+        }
+        self.deleted.fetch_add(added as u64, Ordering::Relaxed);
+        added
+    }
+
+    pub fn deleted_count(&self) -> usize {
+        self.deleted.load(Ordering::Relaxed) as usize
+    }
+
+    pub fn tombstone_words(&self) -> Vec<u64> {
+        self.tombstones.read().clone()
+    }
+
+    pub fn set_tombstones(&self, words: Vec<u64>) {
+        let count: u64 = words.iter().map(|w| w.count_ones() as u64).sum();
+        *self.tombstones.write() = words;
+        self.deleted.store(count, Ordering::Relaxed);
     }
 
     pub fn dimension(&self) -> usize {
@@ -298,18 +501,29 @@ impl DiskProvider {
         self.header.build_complexity
     }
 
-    /// Zero-copy vector read from mmap via byte-offset slicing.
+    /// Zero-copy vector read from the node cache, else from mmap via byte-offset slicing.
     /// Returns empty slice if id is out of bounds.
     fn get_vector(&self, id: u32) -> &[f32] {
         let dim = self.header.dimension as usize;
-        let byte_offset = self.vectors_offset + id as usize * dim * 4;
+        if let Some(&slot) = self.cache.slots.get(&id) {
+            let start = slot as usize * dim;
+            return &self.cache.vectors[start..start + dim];
+        }
+        let (byte_offset, segment_end) = if self.header.is_sector_layout() {
+            if id >= self.header.num_vectors {
+                return &[];
+            }
+            (self.header.node_offset(id), self.mmap.len())
+        } else {
+            (self.vectors_offset + id as usize * dim * 4, self.vectors_end)
+        };
         let byte_end = byte_offset + dim * 4;
-        if byte_end > self.vectors_end || byte_end > self.mmap.len() {
+        if byte_end > segment_end || byte_end > self.mmap.len() {
             return &[];
         }
         let bytes = &self.mmap[byte_offset..byte_end];
         // SAFETY: mmap is aligned to page boundary (always >= 4-byte aligned),
-        // vectors_offset is a multiple of 4, and dim*4 is a multiple of 4.
+        // vectors_offset and v3 node offsets are multiples of 4, and dim*4 is a multiple of 4.
         // Bounds verified above.
         unsafe { std::slice::from_raw_parts(bytes.as_ptr() as *const f32, dim) }
     }
@@ -318,32 +532,131 @@ impl DiskProvider {
     /// Returns empty slice if id is out of bounds.
     fn get_neighbors(&self, id: u32) -> &[u32] {
         let deg = self.header.max_degree as usize;
-        let byte_offset = self.adjacency_offset + id as usize * deg * 4;
-        let byte_end = byte_offset + deg * 4;
-        if byte_end > self.adjacency_end || byte_end > self.mmap.len() {
-            return &[];
-        }
-        let bytes = &self.mmap[byte_offset..byte_end];
-        // SAFETY: same alignment reasoning as get_vector. Bounds verified above.
-        let raw = unsafe { std::slice::from_raw_parts(bytes.as_ptr() as *const u32, deg) };
+        let raw = if let Some(&slot) = self.cache.slots.get(&id) {
+            let start = slot as usize * deg;
+            &self.cache.adjacency[start..start + deg]
+        } else {
+            let (byte_offset, segment_end) = if self.header.is_sector_layout() {
+                if id >= self.header.num_vectors {
+                    return &[];
+                }
+                (self.header.node_offset(id) + self.dimension() * 4, self.mmap.len())
+            } else {
+                (self.adjacency_offset + id as usize * deg * 4, self.adjacency_end)
+            };
+            let byte_end = byte_offset + deg * 4;
+            if byte_end > segment_end || byte_end > self.mmap.len() {
+                return &[];
+            }
+            let bytes = &self.mmap[byte_offset..byte_end];
+            // SAFETY: same alignment reasoning as get_vector. Bounds verified above.
+            unsafe { std::slice::from_raw_parts(bytes.as_ptr() as *const u32, deg) }
+        };
         // Find first sentinel
         let len = raw.iter().position(|&x| x == u32::MAX).unwrap_or(deg);
         &raw[..len]
     }
 
-    /// Greedy best-first search on the mmap'd graph.
-    ///
-    /// When Metal GPU is available and the batch is large enough, neighbor
-    /// distance computations are dispatched to the GPU. Otherwise falls
-    /// back to CPU SIMD distance.
+    /// Start reading the storage behind the given nodes without waiting for it: one
+    /// round trip for a whole frontier, rather than one page fault per node.
+    fn prefetch(&self, ids: &[u32]) {
+        #[cfg(unix)]
+        for &id in ids {
+            if self.cache.slots.contains_key(&id) {
+                continue;
+            }
+            // Errors only mean no readahead: the access faults the page in as usual
+            if self.header.is_sector_layout() {
+                let offset = self.header.node_offset(id);
+                let len = self.header.node_size().min(self.mmap.len().saturating_sub(offset));
+                let _ = self.mmap.advise_range(memmap2::Advice::WillNeed, offset, len);
+            } else {
+                let dim = self.dimension();
+                let deg = self.max_degree();
+                let vec_offset = self.vectors_offset + id as usize * dim * 4;
+                let adj_offset = self.adjacency_offset + id as usize * deg * 4;
+                let _ = self.mmap.advise_range(memmap2::Advice::WillNeed, vec_offset, dim * 4);
+                let _ = self.mmap.advise_range(memmap2::Advice::WillNeed, adj_offset, deg * 4);
+            }
+        }
+        #[cfg(not(unix))]
+        let _ = ids;
+    }
+
+    /// Greedy best-first search on the mmap'd graph. Tombstoned nodes are skipped.
     pub fn search(&self, query: &[f32], k: usize, l_search: usize) -> Vec<(u64, f32)> {
+        self.search_filtered(query, k, l_search, None)
+    }
+
+    /// Greedy search returning only nodes whose bit is set in `filter` (every node
+    /// still routes). Tombstoned nodes are never returned.
+    pub fn search_filtered(
+        &self,
+        query: &[f32],
+        k: usize,
+        l_search: usize,
+        filter: Option<&[u64]>,
+    ) -> Vec<(u64, f32)> {
         let n = self.len();
         if n == 0 || k == 0 {
             return Vec::new();
         }
-
         let k = k.min(n);
-        let l = l_search.max(k);
+        self.traverse(query, l_search.max(k), |result| {
+            let tombstones = self.tombstones.read();
+            result
+                .iter()
+                .filter(|&&(_, id)| !bit_set(&tombstones, id) && filter.map_or(true, |f| bit_set(f, id)))
+                .take(k)
+                .map(|&(dist, id)| (id as u64, dist))
+                .collect()
+        })
+    }
+
+    /// The `l` closest nodes the traversal found, tombstones included, nearest first.
+    pub fn search_candidates(&self, query: &[f32], l: usize) -> Vec<(f32, u32)> {
+        if self.len() == 0 || l == 0 {
+            return Vec::new();
+        }
+        self.traverse(query, l, |result| result.to_vec())
+    }
+
+    /// Score every node set in `filter` exactly (for selective filters, where a
+    /// traversal would visit few of them).
+    pub fn search_exhaustive(&self, query: &[f32], k: usize, filter: &[u64]) -> Vec<(u64, f32)> {
+        if k == 0 {
+            return Vec::new();
+        }
+        let tombstones = self.tombstones.read();
+        let mut heap: BinaryHeap<(FloatOrd, u32)> = BinaryHeap::with_capacity(k + 1);
+        for (w, &word) in filter.iter().enumerate() {
+            let mut bits = word;
+            while bits != 0 {
+                let id = (w as u32) * 64 + bits.trailing_zeros();
+                bits &= bits - 1;
+                if id >= self.header.num_vectors || bit_set(&tombstones, id) {
+                    continue;
+                }
+                let dist = self.compute_distance(query, self.get_vector(id));
+                if heap.len() < k {
+                    heap.push((FloatOrd(dist), id));
+                } else if heap.peek().is_some_and(|top| dist < top.0 .0) {
+                    heap.pop();
+                    heap.push((FloatOrd(dist), id));
+                }
+            }
+        }
+        let mut out: Vec<(u64, f32)> = heap.into_iter().map(|(d, id)| (id as u64, d.0)).collect();
+        out.sort_by(|a, b| a.1.partial_cmp(&b.1).unwrap_or(std::cmp::Ordering::Equal));
+        out
+    }
+
+    /// Best-first traversal keeping the `l` closest nodes; `finish` sees them nearest first.
+    ///
+    /// When Metal GPU is available and the batch is large enough, neighbor
+    /// distance computations are dispatched to the GPU. Otherwise falls
+    /// back to CPU SIMD distance.
+    fn traverse<R>(&self, query: &[f32], l: usize, finish: impl FnOnce(&[(f32, u32)]) -> R) -> R {
         let dim = self.dimension();
         let metric_code: u8 = match self.metric {
             Metric::L2 => 0,
@@ -391,7 +704,8 @@ impl DiskProvider {
                     break;
                 }
 
-                // Collect unvisited neighbors for this candidate
+                // Collect unvisited neighbors for this candidate, then start reading
+                // all of them before the first distance touches one
                 batch_ids.clear();
                 for &neighbor in self.get_neighbors(c_id) {
                     if neighbor >= self.header.num_vectors {
@@ -400,16 +714,13 @@ impl DiskProvider {
                     if !visited.insert(neighbor) {
                         continue;
                     }
-                    let vec = self.get_vector(neighbor);
-                    if vec.is_empty() {
-                        continue;
-                    }
                     batch_ids.push(neighbor);
                 }
 
                 if batch_ids.is_empty() {
                     continue;
                 }
+                self.prefetch(batch_ids);
 
                 let batch_n = batch_ids.len();
 
@@ -448,16 +759,15 @@ impl DiskProvider {
                 for i in 0..batch_n {
                     let neighbor = batch_ids[i];
                     let vec = self.get_vector(neighbor);
+                    if vec.is_empty() {
+                        continue;
+                    }
                     let dist = self.compute_distance(query, vec);
                     Self::insert_result(result, candidates, l, dist, neighbor);
                 }
             }
 
-            result
-                .iter()
-                .take(k)
-                .map(|&(dist, id)| (id as u64, dist))
-                .collect()
+            finish(result)
         })
     }
 
@@ -569,10 +879,6 @@ impl DiskProvider {
                             if !state.visited.insert(neighbor) {
                                 continue;
                             }
-                            let vec = self.get_vector(neighbor);
-                            if vec.is_empty() {
-                                continue;
-                            }
                             all_neighbor_ids.push(neighbor);
                             all_query_map.push(qi as u32);
                         }
@@ -585,6 +891,8 @@ impl DiskProvider {
             }
 
             let total_n = all_neighbor_ids.len();
+            // One prefetch for the frontiers of every active query
+            self.prefetch(&all_neighbor_ids);
 
             // Phase 2: Compute distances — GPU if enough work, else CPU
             let use_gpu = total_n * dim >= crate::metal_ffi::MIN_GPU_WORK;
@@ -631,6 +939,9 @@ impl DiskProvider {
                 let qi = all_query_map[i] as usize;
                 let neighbor = all_neighbor_ids[i];
                 let vec = self.get_vector(neighbor);
+                if vec.is_empty() {
+                    continue;
+                }
                 let dist = self.compute_distance(queries[qi], vec);
                 let state = &mut states[qi];
                 Self::insert_result(&mut state.result, &mut state.candidates, l, dist, neighbor);
@@ -638,12 +949,14 @@ impl DiskProvider {
         }
 
         // Collect results
+        let tombstones = self.tombstones.read();
         states
             .into_iter()
             .map(|state| {
                 state
                     .result
                     .into_iter()
+                    .filter(|&(_, id)| !bit_set(&tombstones, id))
                     .take(k)
                     .map(|(dist, id)| (id as u64, dist))
                     .collect()
@@ -23,3 +23,56 @@ pub fn compute_distance(metric: Metric, a: &[f32], b: &[f32]) -> f32 {
         }
     }
 }
+
+/// Distance from `query` to every row of `candidates` (row-major, `query.len()` floats each)
+/// into `out`, one kernel call per row.
+pub fn distances_to(metric: Metric, query: &[f32], candidates: &[f32], out: &mut [f32]) {
+    for (row, d) in candidates.chunks_exact(query.len()).zip(out.iter_mut()) {
+        *d = compute_distance(metric, query, row);
+    }
+}
+
+/// Asymmetric SQ8 kernels: the query is pre-shifted/scaled per dimension so a
+/// code is scored without dequantizing it. Eight independent accumulators let
+/// the loops vectorize (the u8 -> f32 widening included).
+const SQ8_LANES: usize = 8;
+
+/// sum((shift[d] - step[d] * code[d])^2)
+#[inline]
+pub fn sq8_l2(shift: &[f32], step: &[f32], code: &[u8]) -> f32 {
+    let mut acc = [0.0f32; SQ8_LANES];
+    let chunks = code.len() / SQ8_LANES;
+    for c in 0..chunks {
+        let base = c * SQ8_LANES;
+        for lane in 0..SQ8_LANES {
+            let d = base + lane;
+            let diff = shift[d] - step[d] * code[d] as f32;
+            acc[lane] += diff * diff;
+        }
+    }
+    let mut sum: f32 = acc.iter().sum();
+    for d in chunks * SQ8_LANES..code.len() {
+        let diff = shift[d] - step[d] * code[d] as f32;
+        sum += diff * diff;
+    }
+    sum
+}
+
+/// sum(step[d] * code[d])
+#[inline]
+pub fn sq8_dot(step: &[f32], code: &[u8]) -> f32 {
+    let mut acc = [0.0f32; SQ8_LANES];
+    let chunks = code.len() / SQ8_LANES;
+    for c in 0..chunks {
+        let base = c * SQ8_LANES;
+        for lane in 0..SQ8_LANES {
+            let d = base + lane;
+            acc[lane] += step[d] * code[d] as f32;
+        }
+    }
+    let mut sum: f32 = acc.iter().sum();
+    for d in chunks * SQ8_LANES..code.len() {
+        sum += step[d] * code[d] as f32;
+    }
+    sum
+}
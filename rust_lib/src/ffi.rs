@@ -1,8 +1,15 @@
 //! C FFI interface for the DiskANN index manager.
 //! Called from the C++ DuckDB extension.
 
+use crate::disk_merge;
+use crate::disk_provider::DiskProvider;
+use crate::half_precision::HalfFormat;
 use crate::index_manager::{self, InMemoryIndex, Metric};
-use std::ffi::{c_char, CStr};
+use crate::provider::PageLoader;
+use crate::runtime::{ParallelFor, Scheduler};
+use crate::search_stats::{self, SearchTally};
+use std::ffi::{c_char, c_void, CStr};
+use std::path::Path;
 use std::ptr;
 
 // ========================================
@@ -275,11 +282,13 @@ pub unsafe extern "C" fn diskann_save_index_buf(
 }
 
 /// Load index: returns 0 on success, -1 on error.
+/// `cache_nodes` nodes around the entry points stay in memory; negative = default budget.
 #[no_mangle]
 pub unsafe extern "C" fn diskann_load_index_buf(
     name: *const c_char,
     path: *const c_char,
     build_complexity: i32,
+    cache_nodes: i64,
     err_buf: *mut c_char,
     err_buf_len: i32,
 ) -> i32 {
@@ -298,7 +307,13 @@ pub unsafe extern "C" fn diskann_load_index_buf(
         0
     };
 
-    match index_manager::load_index(name, path, bc) {
+    let cache = if cache_nodes >= 0 {
+        Some(cache_nodes as usize)
+    } else {
+        None
+    };
+
+    match index_manager::load_index(name, path, bc, cache) {
         Ok(()) => 0,
         Err(e) => {
             write_err(err_buf, err_buf_len, &e.to_string());
@@ -649,7 +664,7 @@ pub unsafe extern "C" fn diskann_detached_add(
     }
     let index = &*handle;
     let vector = std::slice::from_raw_parts(vector_ptr, dimension as usize);
-    match index.add(vector) {
+    match index.with_page_loads(|| index.add(vector)) {
         Ok(label) => label as i64,
         Err(e) => {
             write_err(err_buf, err_buf_len, &e.to_string());
@@ -658,6 +673,59 @@ pub unsafe extern "C" fn diskann_detached_add(
     }
 }
 
+/// Add `n` row-major vectors to a detached index in one call.
+/// `out_labels` (n int64s, may be null) receives the assigned labels.
+/// The inserts run as tasks on `run(run_ctx, ...)`, or inline when `run` is null.
+/// Returns number of vectors added, or -1 on error.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_add_batch(
+    handle: DiskannHandle,
+    matrix: *const f32,
+    n: i64,
+    dimension: i32,
+    out_labels: *mut i64,
+    run: Option<ParallelFor>,
+    run_ctx: *mut c_void,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i64 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    if n < 0 || dimension <= 0 || (n > 0 && matrix.is_null()) {
+        write_err(err_buf, err_buf_len, "Invalid vector batch");
+        return -1;
+    }
+    if n == 0 {
+        return 0;
+    }
+    let index = &*handle;
+    if dimension as usize != index.dimension {
+        write_err(
+            err_buf,
+            err_buf_len,
+            &format!("Dimension mismatch: batch {} vs index {}", dimension, index.dimension),
+        );
+        return -1;
+    }
+    let vectors = std::slice::from_raw_parts(matrix, n as usize * dimension as usize);
+    let labels = if out_labels.is_null() {
+        None
+    } else {
+        Some(std::slice::from_raw_parts_mut(out_labels, n as usize))
+    };
+    match index.with_page_loads(|| {
+        index.add_batch(vectors, labels, &Scheduler::new(run, run_ctx))
+    }) {
+        Ok(added) => added as i64,
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            -1
+        }
+    }
+}
+
 /// Search a detached index. Returns number of results, or -1 on error.
 #[no_mangle]
 pub unsafe extern "C" fn diskann_detached_search(
@@ -687,8 +755,9 @@ pub unsafe extern "C" fn diskann_detached_search(
     let query = std::slice::from_raw_parts(query_ptr, dimension as usize);
     let out_labels_slice = std::slice::from_raw_parts_mut(out_labels, k as usize);
     let out_distances_slice = std::slice::from_raw_parts_mut(out_distances, k as usize);
-    match index.search_into(query, k as usize, search_complexity as u32,
-                            out_labels_slice, out_distances_slice) {
+    match index.with_page_loads(|| {
+        index.search_into(query, k as usize, search_complexity as u32, out_labels_slice, out_distances_slice)
+    }) {
         Ok(n) => n as i32,
         Err(e) => {
             write_err(err_buf, err_buf_len, &e.to_string());
@@ -697,6 +766,64 @@ pub unsafe extern "C" fn diskann_detached_search(
     }
 }
 
+/// Filtered search on a detached index.
+/// filter_words: bitmap over labels (bit `l` of word `l / 64` set = label may be returned).
+/// exhaustive != 0 scores every allowed label exactly instead of traversing the graph.
+/// Returns number of results written, or -1 on error.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_search_filtered(
+    handle: DiskannHandle,
+    query_ptr: *const f32,
+    dimension: i32,
+    k: i32,
+    search_complexity: i32,
+    filter_words: *const u64,
+    num_words: i64,
+    exhaustive: i32,
+    out_labels: *mut i64,
+    out_distances: *mut f32,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i32 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    if query_ptr.is_null() || dimension <= 0 || k < 0 {
+        write_err(err_buf, err_buf_len, "Invalid query");
+        return -1;
+    }
+    if filter_words.is_null() || num_words < 0 {
+        write_err(err_buf, err_buf_len, "Invalid filter bitmap");
+        return -1;
+    }
+    if out_labels.is_null() || out_distances.is_null() {
+        write_err(err_buf, err_buf_len, "Null output buffer");
+        return -1;
+    }
+    let index = &*handle;
+    let query = std::slice::from_raw_parts(query_ptr, dimension as usize);
+    let words = std::slice::from_raw_parts(filter_words, num_words as usize);
+    match index.with_page_loads(|| {
+        index.search_filtered(query, k as usize, search_complexity as u32, words, exhaustive != 0)
+    }) {
+        Ok(results) => {
+            let n = results.len().min(k as usize);
+            let out_labels_slice = std::slice::from_raw_parts_mut(out_labels, k as usize);
+            let out_distances_slice = std::slice::from_raw_parts_mut(out_distances, k as usize);
+            for (i, (label, dist)) in results.into_iter().take(n).enumerate() {
+                out_labels_slice[i] = label as i64;
+                out_distances_slice[i] = dist;
+            }
+            n as i32
+        }
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            -1
+        }
+    }
+}
+
 /// Multi-query batch search on a detached index.
 /// query_matrix: nq * dimension contiguous floats (row-major).
 /// out_labels: nq * k int64s (row-major).
@@ -747,7 +874,7 @@ pub unsafe extern "C" fn diskann_detached_search_batch(
     let flat = std::slice::from_raw_parts(query_matrix, nq * dim);
     let queries: Vec<&[f32]> = (0..nq).map(|i| &flat[i * dim..(i + 1) * dim]).collect();
 
-    match index.search_batch(&queries, k, search_complexity as u32) {
+    match index.with_page_loads(|| index.search_batch(&queries, k, search_complexity as u32)) {
         Ok(results) => {
             for (qi, qresults) in results.iter().enumerate() {
                 let n = qresults.len().min(k);
@@ -795,7 +922,7 @@ pub unsafe extern "C" fn diskann_detached_serialize(
         };
     }
     let index = &*handle;
-    match index.serialize_to_bytes() {
+    match index.with_page_loads(|| index.serialize_to_bytes()) {
         Ok(mut bytes) => {
             let len = bytes.len();
             let ptr = bytes.as_mut_ptr();
@@ -844,136 +971,1224 @@ pub unsafe extern "C" fn diskann_free_bytes(bytes: DiskannBytes) {
 }
 
 // ========================================
-// Compact / vacuum
+// Graph merge
+// ========================================
+
+/// Merge `other` into `handle` keeping both graphs' edges, stitched together with
+/// cross edges searched from a sample of each side as tasks on `run(run_ctx, ...)`
+/// (inline when `run` is null). `other` is only read. Returns the label offset of
+/// `other`'s nodes (other label l is now offset + l), or -1 on error.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_merge(
+    handle: DiskannHandle,
+    other: DiskannHandle,
+    run: Option<ParallelFor>,
+    run_ctx: *mut c_void,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i64 {
+    if handle.is_null() || other.is_null() || handle == other {
+        write_err(err_buf, err_buf_len, "Null or identical handles");
+        return -1;
+    }
+    match (*handle).with_page_loads(|| {
+        (*handle).merge_from(&*other, &Scheduler::new(run, run_ctx))
+    }) {
+        Ok(offset) => offset as i64,
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            -1
+        }
+    }
+}
+
+// ========================================
+// In-place delete consolidation / vacuum
 // ========================================
 
-/// Result of a compact operation.
+/// Progress of one consolidation slice.
 #[repr(C)]
-pub struct DiskannCompactResult {
-    /// New index handle (caller owns it). Null on error.
-    pub new_handle: DiskannHandle,
-    /// Array of (old_label, new_label) pairs. Caller must free with diskann_free_label_map.
-    pub label_map: *mut u32,
-    /// Number of pairs (entries = map_len * 2 u32s).
-    pub map_len: usize,
+pub struct DiskannConsolidateProgress {
+    /// Live nodes repaired by this slice.
+    pub visited: u64,
+    /// Tombstoned slots freed for reuse by this slice.
+    pub freed: u64,
+    /// Nodes left before the current pass frees its tombstones.
+    pub remaining: u64,
+    /// 1 when no pass is in progress after this slice.
+    pub done: i32,
 }
 
-/// Compact a detached index by rebuilding without deleted labels.
-/// `deleted_labels` is an array of u32 labels to exclude.
-/// Returns a new handle + label mapping. Old handle is NOT freed.
+/// Repair up to `max_nodes` live nodes whose neighbours were deleted (0 = run
+/// the pass to completion). Finished passes recycle their tombstoned slots.
+/// The repairs run as tasks on `run(run_ctx, ...)`, or inline when `run` is null.
+/// Returns 0 on success, -1 on error.
 #[no_mangle]
-pub unsafe extern "C" fn diskann_detached_compact(
+pub unsafe extern "C" fn diskann_detached_consolidate(
     handle: DiskannHandle,
-    deleted_labels: *const u32,
-    num_deleted: usize,
+    max_nodes: u64,
+    run: Option<ParallelFor>,
+    run_ctx: *mut c_void,
+    out: *mut DiskannConsolidateProgress,
     err_buf: *mut c_char,
     err_buf_len: i32,
-) -> DiskannCompactResult {
-    let null_result = DiskannCompactResult {
-        new_handle: ptr::null_mut(),
-        label_map: ptr::null_mut(),
-        map_len: 0,
-    };
+) -> i32 {
+    if handle.is_null() || out.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    match (*handle).with_page_loads(|| {
+        (*handle).consolidate(max_nodes as usize, &Scheduler::new(run, run_ctx))
+    }) {
+        Ok(p) => {
+            *out = DiskannConsolidateProgress {
+                visited: p.visited,
+                freed: p.freed,
+                remaining: p.remaining,
+                done: p.done as i32,
+            };
+            0
+        }
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            -1
+        }
+    }
+}
 
+/// Copy up to `capacity` recycled slots into `out`. Returns the total number.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_get_free_slots(
+    handle: DiskannHandle,
+    out: *mut u32,
+    capacity: i64,
+) -> i64 {
     if handle.is_null() {
-        write_err(err_buf, err_buf_len, "Null handle");
-        return null_result;
+        return 0;
     }
+    let slots = (*handle).free_slots();
+    if !out.is_null() && capacity > 0 {
+        let n = slots.len().min(capacity as usize);
+        std::slice::from_raw_parts_mut(out, n).copy_from_slice(&slots[..n]);
+    }
+    slots.len() as i64
+}
 
-    let index = &*handle;
+/// Replace the recycled slot list with `n` labels (after load).
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_set_free_slots(handle: DiskannHandle, slots: *const u32, n: i64) {
+    if handle.is_null() {
+        return;
+    }
+    let slots = if slots.is_null() || n <= 0 {
+        Vec::new()
+    } else {
+        std::slice::from_raw_parts(slots, n as usize).to_vec()
+    };
+    (*handle).set_free_slots(slots);
+}
 
-    let mut deleted_set = std::collections::HashSet::with_capacity(num_deleted);
-    if !deleted_labels.is_null() && num_deleted > 0 {
-        let labels = std::slice::from_raw_parts(deleted_labels, num_deleted);
-        for &l in labels {
-            deleted_set.insert(l);
-        }
+// ========================================
+// Paged persistence (segmented checkpoint format)
+// ========================================
+
+/// Number of nodes per storage page.
+#[no_mangle]
+pub extern "C" fn diskann_page_nodes() -> u32 {
+    crate::provider::PAGE_NODES
+}
+
+/// Drain the pages whose adjacency changed since the last call into `out_pages`.
+/// `capacity` must be >= the index's page count. Returns the number written, or -1.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_take_dirty_pages(
+    handle: DiskannHandle,
+    out_pages: *mut u32,
+    capacity: i64,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i64 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
     }
+    copy_pages((*handle).take_dirty_adjacency_pages(), out_pages, capacity, err_buf, err_buf_len)
+}
 
-    match index.compact(&deleted_set) {
-        Ok((new_index, label_map)) => {
-            let new_handle = Box::into_raw(Box::new(new_index));
+/// Same as `diskann_detached_take_dirty_pages`, for pages whose vectors were
+/// written (appends and recycled slots).
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_take_dirty_vector_pages(
+    handle: DiskannHandle,
+    out_pages: *mut u32,
+    capacity: i64,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i64 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    copy_pages((*handle).take_dirty_vector_pages(), out_pages, capacity, err_buf, err_buf_len)
+}
 
-            // Flatten label_map to [old0, new0, old1, new1, ...]
-            let map_len = label_map.len();
-            let mut flat: Vec<u32> = Vec::with_capacity(map_len * 2);
-            for (old_l, new_l) in &label_map {
-                flat.push(*old_l);
-                flat.push(*new_l);
-            }
-            let map_ptr = flat.as_mut_ptr();
-            std::mem::forget(flat);
+unsafe fn copy_pages(
+    pages: Vec<u32>,
+    out_pages: *mut u32,
+    capacity: i64,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i64 {
+    if out_pages.is_null() || capacity < 0 {
+        write_err(err_buf, err_buf_len, "Null output buffer");
+        return -1;
+    }
+    if pages.len() > capacity as usize {
+        write_err(err_buf, err_buf_len, &format!(
+            "{} dirty pages exceed buffer capacity {}", pages.len(), capacity
+        ));
+        return -1;
+    }
+    let out = std::slice::from_raw_parts_mut(out_pages, pages.len());
+    out.copy_from_slice(&pages);
+    pages.len() as i64
+}
 
-            DiskannCompactResult {
-                new_handle,
-                label_map: map_ptr,
-                map_len,
-            }
-        }
+/// Export nodes [start, start + count): vectors (count * dimension floats) and/or
+/// adjacency (count * max_degree u32s, u32::MAX padded). Either output may be null.
+/// Returns 0 on success, -1 on error.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_export_page(
+    handle: DiskannHandle,
+    start: u32,
+    count: u32,
+    out_vectors: *mut f32,
+    out_adjacency: *mut u32,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i32 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    let index = &*handle;
+    let n = count as usize;
+    let vectors = if out_vectors.is_null() {
+        None
+    } else {
+        Some(std::slice::from_raw_parts_mut(out_vectors, n * index.dimension))
+    };
+    let adjacency = if out_adjacency.is_null() {
+        None
+    } else {
+        Some(std::slice::from_raw_parts_mut(out_adjacency, n * index.max_degree as usize))
+    };
+    match index.with_page_loads(|| index.export_page(start, count, vectors, adjacency)) {
+        Ok(()) => 0,
         Err(e) => {
             write_err(err_buf, err_buf_len, &e.to_string());
-            null_result
+            -1
         }
     }
 }
 
-/// Free the label map returned by diskann_detached_compact.
+/// Import nodes [start, start + count) into an empty detached index.
+/// Call diskann_detached_finish_import after the last page. Returns 0 or -1.
 #[no_mangle]
-pub unsafe extern "C" fn diskann_free_label_map(map: *mut u32, map_len: usize) {
-    if !map.is_null() && map_len > 0 {
-        let _ = Vec::from_raw_parts(map, map_len * 2, map_len * 2);
+pub unsafe extern "C" fn diskann_detached_import_page(
+    handle: DiskannHandle,
+    start: u32,
+    count: u32,
+    vectors: *const f32,
+    adjacency: *const u32,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i32 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    if vectors.is_null() || adjacency.is_null() {
+        write_err(err_buf, err_buf_len, "Null page buffer");
+        return -1;
+    }
+    let index = &*handle;
+    let n = count as usize;
+    let vecs = std::slice::from_raw_parts(vectors, n * index.dimension);
+    let adj = std::slice::from_raw_parts(adjacency, n * index.max_degree as usize);
+    match index.import_page(start, vecs, adj) {
+        Ok(()) => 0,
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            -1
+        }
     }
 }
 
-// ========================================
-// Vector accessor (for MergeIndexes)
-// ========================================
-
-/// Get a copy of a vector by label. Returns dimension, or 0 if not found.
-/// Caller provides output buffer `out_vec` of size >= dimension.
+/// Finish a page-by-page import: set entry points and build the graph index.
+/// Returns 0 or -1.
 #[no_mangle]
-pub unsafe extern "C" fn diskann_detached_get_vector(
+pub unsafe extern "C" fn diskann_detached_finish_import(
     handle: DiskannHandle,
-    label: u32,
-    out_vec: *mut f32,
-    out_capacity: i32,
+    num_vectors: u32,
+    entry_points: *const u32,
+    num_entry_points: u32,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
 ) -> i32 {
-    if handle.is_null() || out_vec.is_null() || out_capacity <= 0 {
-        return 0;
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
     }
     let index = &*handle;
-    match index.get_vector(label) {
-        Some(v) => {
-            let copy_len = v.len().min(out_capacity as usize);
-            std::ptr::copy_nonoverlapping(v.as_ptr(), out_vec, copy_len);
-            copy_len as i32
+    let eps = if entry_points.is_null() || num_entry_points == 0 {
+        Vec::new()
+    } else {
+        std::slice::from_raw_parts(entry_points, num_entry_points as usize).to_vec()
+    };
+    match index.finish_import(num_vectors, eps) {
+        Ok(()) => 0,
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            -1
         }
-        None => 0,
     }
 }
 
 // ========================================
-// SQ8 Quantization
+// Tombstones
 // ========================================
 
-/// Apply SQ8 scalar quantization to a detached index.
-/// Reduces vector memory by ~4x. Search will dequantize on the fly.
-#[unsafe(no_mangle)]
-pub unsafe extern "C" fn diskann_detached_quantize_sq8(handle: DiskannHandle) -> i32 {
+/// Tombstone `n` labels: they stay in the graph for routing but are never
+/// returned by search. Returns the number newly deleted.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_mark_deleted(
+    handle: DiskannHandle,
+    labels: *const u32,
+    n: i64,
+) -> i64 {
+    if handle.is_null() || labels.is_null() || n <= 0 {
+        return 0;
+    }
+    let labels = std::slice::from_raw_parts(labels, n as usize);
+    (*handle).mark_deleted(labels) as i64
+}
+
+/// Number of tombstoned labels.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_deleted_count(handle: DiskannHandle) -> i64 {
     if handle.is_null() {
-        return -1;
+        return 0;
     }
-    let index = &*handle;
-    index.quantize_sq8();
-    0
+    (*handle).deleted_count() as i64
 }
 
-/// Check if a detached index has SQ8 quantization active.
-#[unsafe(no_mangle)]
-pub unsafe extern "C" fn diskann_detached_is_quantized(handle: DiskannHandle) -> i32 {
+/// Copy up to `capacity` tombstone bitmap words (label l = bit l%64 of word l/64)
+/// into `out`. Returns the total number of words.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_get_tombstones(
+    handle: DiskannHandle,
+    out: *mut u64,
+    capacity: i64,
+) -> i64 {
     if handle.is_null() {
         return 0;
     }
-    let index = &*handle;
-    if index.is_quantized() { 1 } else { 0 }
+    let words = (*handle).tombstone_words();
+    if !out.is_null() && capacity > 0 {
+        let n = words.len().min(capacity as usize);
+        std::slice::from_raw_parts_mut(out, n).copy_from_slice(&words[..n]);
+    }
+    words.len() as i64
+}
+
+/// Replace the tombstone bitmap with `num_words` words.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_set_tombstones(
+    handle: DiskannHandle,
+    words: *const u64,
+    num_words: i64,
+) {
+    if handle.is_null() {
+        return;
+    }
+    let words = if words.is_null() || num_words <= 0 {
+        Vec::new()
+    } else {
+        std::slice::from_raw_parts(words, num_words as usize).to_vec()
+    };
+    (*handle).set_tombstones(words);
+}
+
+/// Open an empty detached index lazily over paged storage: `load(ctx, start, count,
+/// out_vectors, out_adjacency)` is called (possibly from worker threads) the first
+/// time a node on a page is touched. `ctx` must outlive the handle. Returns 0 or -1.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_attach_pager(
+    handle: DiskannHandle,
+    num_vectors: u32,
+    entry_points: *const u32,
+    num_entry_points: u32,
+    load: Option<PageLoader>,
+    ctx: *mut c_void,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i32 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    let load = match load {
+        Some(f) => f,
+        None => {
+            write_err(err_buf, err_buf_len, "Null page loader");
+            return -1;
+        }
+    };
+    let index = &*handle;
+    let eps = if entry_points.is_null() || num_entry_points == 0 {
+        Vec::new()
+    } else {
+        std::slice::from_raw_parts(entry_points, num_entry_points as usize).to_vec()
+    };
+    match index.attach_pager(num_vectors, eps, load, ctx) {
+        Ok(()) => 0,
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            -1
+        }
+    }
+}
+
+/// Number of pages not yet faulted in (0 for fully resident indexes).
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_nonresident_pages(handle: DiskannHandle) -> u32 {
+    if handle.is_null() {
+        return 0;
+    }
+    (*handle).nonresident_pages()
+}
+
+/// Storage now holds the vectors of [0, num_persisted): drop them from memory if the
+/// index searches on SQ8/PQ codes. Returns 1 if evicted, 0 if kept.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_evict_vectors(
+    handle: DiskannHandle,
+    num_persisted: u32,
+    load: Option<PageLoader>,
+    ctx: *mut c_void,
+) -> i32 {
+    match (handle.is_null(), load) {
+        (false, Some(load)) => (*handle).evict_vectors(num_persisted, load, ctx) as i32,
+        _ => 0,
+    }
+}
+
+/// Resident memory estimate in bytes (vectors, codes and loaded adjacency).
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_memory_bytes(handle: DiskannHandle) -> u64 {
+    if handle.is_null() {
+        return 0;
+    }
+    (*handle).memory_bytes() as u64
+}
+
+/// Node pages and vectors faulted back in from storage since the index was opened.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_page_loads(handle: DiskannHandle) -> u64 {
+    if handle.is_null() {
+        return 0;
+    }
+    (*handle).page_loads()
+}
+
+/// Search counters since the index was created or loaded (see `search_stats::SearchTally`).
+#[repr(C)]
+pub struct DiskannSearchStats {
+    pub searches: u64,
+    pub distance_computations: u64,
+    pub hops: u64,
+    pub visited: u64,
+    pub deleted_filtered: u64,
+    pub gpu_dispatches: u64,
+    pub cpu_dispatches: u64,
+}
+
+impl From<SearchTally> for DiskannSearchStats {
+    fn from(tally: SearchTally) -> Self {
+        DiskannSearchStats {
+            searches: tally.searches,
+            distance_computations: tally.distance_computations,
+            hops: tally.hops,
+            visited: tally.visited,
+            deleted_filtered: tally.deleted_filtered,
+            gpu_dispatches: tally.gpu_dispatches,
+            cpu_dispatches: tally.cpu_dispatches,
+        }
+    }
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_search_stats(handle: DiskannHandle, out: *mut DiskannSearchStats) {
+    if handle.is_null() || out.is_null() {
+        return;
+    }
+    *out = (*handle).search_stats().into();
+}
+
+/// Counters recorded by the calling thread's searches (any index) since its previous call.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_take_search_tally(out: *mut DiskannSearchStats) {
+    let tally = search_stats::take_thread_tally();
+    if !out.is_null() {
+        *out = tally.into();
+    }
+}
+
+/// Fault in every page still on storage. Returns 0 or -1.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_load_all_pages(
+    handle: DiskannHandle,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i32 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    match (*handle).with_page_loads(|| (*handle).load_all_pages()) {
+        Ok(()) => 0,
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            -1
+        }
+    }
+}
+
+/// Copy up to `capacity` entry point IDs into `out`. Returns the total number of entry points.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_get_entry_points(
+    handle: DiskannHandle,
+    out: *mut u32,
+    capacity: i32,
+) -> i32 {
+    if handle.is_null() {
+        return 0;
+    }
+    let index = &*handle;
+    let eps = index.get_entry_points();
+    if !out.is_null() && capacity > 0 {
+        let n = eps.len().min(capacity as usize);
+        std::slice::from_raw_parts_mut(out, n).copy_from_slice(&eps[..n]);
+    }
+    eps.len() as i32
+}
+
+// ========================================
+// Vector accessor (for MergeIndexes)
+// ========================================
+
+/// Get a copy of a vector by label. Returns dimension, or 0 if not found.
+/// Caller provides output buffer `out_vec` of size >= dimension.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_detached_get_vector(
+    handle: DiskannHandle,
+    label: u32,
+    out_vec: *mut f32,
+    out_capacity: i32,
+) -> i32 {
+    if handle.is_null() || out_vec.is_null() || out_capacity <= 0 {
+        return 0;
+    }
+    let index = &*handle;
+    match index.get_vector(label) {
+        Some(v) => {
+            let copy_len = v.len().min(out_capacity as usize);
+            std::ptr::copy_nonoverlapping(v.as_ptr(), out_vec, copy_len);
+            copy_len as i32
+        }
+        None => 0,
+    }
+}
+
+// ========================================
+// Distance kernels
+// ========================================
+
+/// Distances from `query` to `n` row-major candidates of `dim` floats into `out`, with the
+/// SIMD kernels the graph search uses. metric: 0 = squared L2, 1 = negated inner product.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_compute_distances(
+    query: *const f32,
+    candidates: *const f32,
+    n: u64,
+    dim: u32,
+    metric: i32,
+    out: *mut f32,
+) {
+    if query.is_null() || candidates.is_null() || out.is_null() || n == 0 || dim == 0 {
+        return;
+    }
+    let dim = dim as usize;
+    let n = n as usize;
+    let metric = if metric == 1 { Metric::InnerProduct } else { Metric::L2 };
+    crate::distance::distances_to(
+        metric,
+        std::slice::from_raw_parts(query, dim),
+        std::slice::from_raw_parts(candidates, n * dim),
+        std::slice::from_raw_parts_mut(out, n),
+    );
+}
+
+// ========================================
+// SQ8 Quantization
+// ========================================
+
+/// Apply SQ8 scalar quantization to a detached index.
+/// Reduces vector memory by ~4x. Search will dequantize on the fly.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_quantize_sq8(handle: DiskannHandle) -> i32 {
+    if handle.is_null() {
+        return -1;
+    }
+    let index = &*handle;
+    index.quantize_sq8();
+    0
+}
+
+/// Check if a detached index has SQ8 quantization active.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_is_quantized(handle: DiskannHandle) -> i32 {
+    if handle.is_null() {
+        return 0;
+    }
+    let index = &*handle;
+    if index.is_quantized() { 1 } else { 0 }
+}
+
+/// Copy the SQ8 per-dimension min then scale (2 * dim floats) into `out`.
+/// Returns the number of floats (0 when SQ8 is not active).
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_get_sq8_params(handle: DiskannHandle, out: *mut f32, capacity: i64) -> i64 {
+    if handle.is_null() {
+        return 0;
+    }
+    let Some(params) = (*handle).sq8_params() else {
+        return 0;
+    };
+    let values: Vec<f32> = params.min.iter().chain(params.scale.iter()).copied().collect();
+    if !out.is_null() && capacity > 0 {
+        let n = values.len().min(capacity as usize);
+        std::slice::from_raw_parts_mut(out, n).copy_from_slice(&values[..n]);
+    }
+    values.len() as i64
+}
+
+/// Copy the SQ8 codes of nodes [start, start + count) into `out` (capacity in bytes).
+/// Returns the number of nodes copied.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_export_sq8_codes(
+    handle: DiskannHandle,
+    start: u32,
+    count: u32,
+    out: *mut u8,
+    capacity: i64,
+) -> i64 {
+    if handle.is_null() || out.is_null() || capacity <= 0 {
+        return 0;
+    }
+    let out = std::slice::from_raw_parts_mut(out, capacity as usize);
+    (*handle).export_sq8_codes(start, count, out) as i64
+}
+
+/// Install persisted SQ8 params (min then scale, 2 * dim floats) and codes.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_load_sq8(
+    handle: DiskannHandle,
+    params: *const f32,
+    num_params: i64,
+    codes: *const u8,
+    codes_len: i64,
+) -> i32 {
+    if handle.is_null() || params.is_null() {
+        return -1;
+    }
+    let dim = (*handle).dimension;
+    if num_params != 2 * dim as i64 {
+        return -1;
+    }
+    let params = std::slice::from_raw_parts(params, num_params as usize);
+    let codes = if codes.is_null() || codes_len <= 0 {
+        Vec::new()
+    } else {
+        std::slice::from_raw_parts(codes, codes_len as usize).to_vec()
+    };
+    (*handle).load_sq8(
+        codes,
+        crate::provider::SQ8Params {
+            min: params[..dim].to_vec(),
+            scale: params[dim..].to_vec(),
+        },
+    );
+    0
+}
+
+// ========================================
+// PQ Quantization
+// ========================================
+
+/// Train PQ on a detached index (`m` subspaces, 0 = auto; `2^bits` centroids), one
+/// subspace per task on `run(run_ctx, ...)` (inline when `run` is null). Searches then
+/// traverse on the codes and re-rank on full precision.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_quantize_pq(
+    handle: DiskannHandle,
+    m: i32,
+    bits: i32,
+    run: Option<ParallelFor>,
+    run_ctx: *mut c_void,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i32 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    match (*handle).with_page_loads(|| {
+        (*handle).quantize_pq(m.max(0) as usize, bits.max(0) as u32, &Scheduler::new(run, run_ctx))
+    }) {
+        Ok(()) => 0,
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            -1
+        }
+    }
+}
+
+/// Check if a detached index has PQ active.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_is_pq(handle: DiskannHandle) -> i32 {
+    if handle.is_null() {
+        return 0;
+    }
+    if (*handle).is_pq() { 1 } else { 0 }
+}
+
+/// Candidates re-ranked on full precision per SQ8/PQ search (0 = 4 * k).
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_set_rerank(handle: DiskannHandle, rerank: u32) {
+    if handle.is_null() {
+        return;
+    }
+    (*handle).set_rerank(rerank);
+}
+
+/// Bytes per PQ code (0 when PQ is not active).
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_pq_code_size(handle: DiskannHandle) -> i32 {
+    if handle.is_null() {
+        return 0;
+    }
+    (*handle).pq_code_size() as i32
+}
+
+/// Copy up to `capacity` bytes of the serialized codebook into `out`.
+/// Returns the full codebook size.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_get_pq_codebook(
+    handle: DiskannHandle,
+    out: *mut u8,
+    capacity: i64,
+) -> i64 {
+    if handle.is_null() {
+        return 0;
+    }
+    let codebook = (*handle).pq_codebook_bytes();
+    if !out.is_null() && capacity > 0 {
+        let n = codebook.len().min(capacity as usize);
+        std::slice::from_raw_parts_mut(out, n).copy_from_slice(&codebook[..n]);
+    }
+    codebook.len() as i64
+}
+
+/// Copy the PQ codes of nodes [start, start + count) into `out` (capacity in bytes).
+/// Returns the number of nodes copied.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_export_pq_codes(
+    handle: DiskannHandle,
+    start: u32,
+    count: u32,
+    out: *mut u8,
+    capacity: i64,
+) -> i64 {
+    if handle.is_null() || out.is_null() || capacity <= 0 {
+        return 0;
+    }
+    let out = std::slice::from_raw_parts_mut(out, capacity as usize);
+    (*handle).export_pq_codes(start, count, out) as i64
+}
+
+/// Install a persisted codebook and the codes of every node.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_load_pq(
+    handle: DiskannHandle,
+    codebook: *const u8,
+    codebook_len: i64,
+    codes: *const u8,
+    codes_len: i64,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i32 {
+    if handle.is_null() || codebook.is_null() || codebook_len <= 0 {
+        write_err(err_buf, err_buf_len, "Null handle or empty codebook");
+        return -1;
+    }
+    let codebook = std::slice::from_raw_parts(codebook, codebook_len as usize);
+    let codes = if codes.is_null() || codes_len <= 0 {
+        Vec::new()
+    } else {
+        std::slice::from_raw_parts(codes, codes_len as usize).to_vec()
+    };
+    match (*handle).load_pq(codebook, codes) {
+        Ok(()) => 0,
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            -1
+        }
+    }
+}
+
+// ========================================
+// Half-precision vectors (precision = 'f16' / 'bf16')
+// ========================================
+
+/// Store every vector of a detached index at half width (`format` 1 = f16, 2 = bf16)
+/// and search on those copies.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_quantize_half(
+    handle: DiskannHandle,
+    format: u8,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i32 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    let Some(format) = HalfFormat::from_u8(format) else {
+        write_err(err_buf, err_buf_len, &format!("Unknown half-precision format {}", format));
+        return -1;
+    };
+    match (*handle).with_page_loads(|| (*handle).quantize_half(format)) {
+        Ok(()) => 0,
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            -1
+        }
+    }
+}
+
+/// Half-width format of a detached index (0 when vectors are only kept at f32).
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_half_format(handle: DiskannHandle) -> u8 {
+    if handle.is_null() {
+        return 0;
+    }
+    (*handle).half_format().map_or(0, |f| f as u8)
+}
+
+/// Copy the half-width vectors of nodes [start, start + count) into `out` (capacity in u16s).
+/// Returns the number of nodes copied.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_export_half_codes(
+    handle: DiskannHandle,
+    start: u32,
+    count: u32,
+    out: *mut u16,
+    capacity: i64,
+) -> i64 {
+    if handle.is_null() || out.is_null() || capacity <= 0 {
+        return 0;
+    }
+    let out = std::slice::from_raw_parts_mut(out, capacity as usize);
+    (*handle).export_half_codes(start, count, out) as i64
+}
+
+/// Install the persisted half-width vectors of every node.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_detached_load_half(
+    handle: DiskannHandle,
+    format: u8,
+    codes: *const u16,
+    codes_len: i64,
+) -> i32 {
+    if handle.is_null() {
+        return -1;
+    }
+    let Some(format) = HalfFormat::from_u8(format) else {
+        return -1;
+    };
+    let codes = if codes.is_null() || codes_len <= 0 {
+        Vec::new()
+    } else {
+        std::slice::from_raw_parts(codes, codes_len as usize).to_vec()
+    };
+    (*handle).load_half(format, codes);
+    0
+}
+
+/// Widen `n` half-width values (`format` 1 = f16, 2 = bf16) into `out`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn diskann_half_to_float(format: u8, src: *const u16, n: u64, out: *mut f32) -> i32 {
+    let Some(format) = HalfFormat::from_u8(format) else {
+        return -1;
+    };
+    if n == 0 {
+        return 0;
+    }
+    if src.is_null() || out.is_null() {
+        return -1;
+    }
+    format.decode(
+        std::slice::from_raw_parts(src, n as usize),
+        std::slice::from_raw_parts_mut(out, n as usize),
+    );
+    0
+}
+
+// ========================================
+// Disk-resident indexes (storage = 'disk')
+// ========================================
+
+pub type DiskannDiskHandle = *mut DiskProvider;
+
+fn cache_budget(cache_nodes: i64) -> Option<usize> {
+    if cache_nodes >= 0 {
+        Some(cache_nodes as usize)
+    } else {
+        None
+    }
+}
+
+/// Search list size: `search_complexity`, or the build complexity when it is not positive.
+fn disk_l_search(provider: &DiskProvider, search_complexity: i32) -> usize {
+    if search_complexity > 0 {
+        search_complexity as usize
+    } else {
+        provider.build_complexity() as usize
+    }
+}
+
+/// Open a sector-aligned .diskann file read-only. `cache_nodes` as for
+/// `diskann_load_index_buf`. `num_nodes` >= 0 opens only the file's first `num_nodes`
+/// nodes (an append past them was never checkpointed); -1 opens all of them.
+/// Returns handle, or null on error.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_open(
+    path: *const c_char,
+    cache_nodes: i64,
+    num_nodes: i64,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> DiskannDiskHandle {
+    let path = match cstr_to_str(path, "path", err_buf, err_buf_len) {
+        Some(s) => s,
+        None => return ptr::null_mut(),
+    };
+    let num_nodes = (num_nodes >= 0).then_some(num_nodes as u32);
+    match DiskProvider::open_nodes(Path::new(path), cache_budget(cache_nodes), num_nodes) {
+        Ok(provider) => Box::into_raw(Box::new(provider)),
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &format!("Failed to open '{}': {}", path, e));
+            ptr::null_mut()
+        }
+    }
+}
+
+/// Free a disk index handle (unmaps the file).
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_free(handle: DiskannDiskHandle) {
+    if !handle.is_null() {
+        drop(Box::from_raw(handle));
+    }
+}
+
+/// Merge the in-memory `delta` into `base` (null: no file yet) and write the result
+/// to `out_path` (atomically, via `<out_path>.tmp`). Delta label l becomes
+/// `base_count + l`. Returns a handle on the new file with both tombstone sets
+/// applied, or null on error. Neither input is modified. The graph repair runs as
+/// tasks on `run(run_ctx, ...)`, or inline when `run` is null.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_merge(
+    base: DiskannDiskHandle,
+    delta: DiskannHandle,
+    out_path: *const c_char,
+    cache_nodes: i64,
+    run: Option<ParallelFor>,
+    run_ctx: *mut c_void,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> DiskannDiskHandle {
+    if delta.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return ptr::null_mut();
+    }
+    let path = match cstr_to_str(out_path, "path", err_buf, err_buf_len) {
+        Some(s) => s,
+        None => return ptr::null_mut(),
+    };
+    let base = if base.is_null() { None } else { Some(&*base) };
+    match (*delta).with_page_loads(|| {
+        disk_merge::merge_to_file(
+            base,
+            &*delta,
+            Path::new(path),
+            cache_budget(cache_nodes),
+            &Scheduler::new(run, run_ctx),
+        )
+    }) {
+        Ok(provider) => Box::into_raw(Box::new(provider)),
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            ptr::null_mut()
+        }
+    }
+}
+
+/// Merge the in-memory `delta` into `base`'s own file at `path` (the file `base` was
+/// opened from): delta sectors are appended and the touched base adjacency rows are
+/// patched in place. Returns a handle on the grown file with both tombstone sets
+/// applied, or null on error. `base` stays valid and must still be freed. The graph
+/// repair runs on `run(run_ctx, ...)` as for `diskann_disk_merge`.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_append(
+    base: DiskannDiskHandle,
+    delta: DiskannHandle,
+    path: *const c_char,
+    cache_nodes: i64,
+    run: Option<ParallelFor>,
+    run_ctx: *mut c_void,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> DiskannDiskHandle {
+    if base.is_null() || delta.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return ptr::null_mut();
+    }
+    let path = match cstr_to_str(path, "path", err_buf, err_buf_len) {
+        Some(s) => s,
+        None => return ptr::null_mut(),
+    };
+    match (*delta).with_page_loads(|| {
+        disk_merge::append_to_file(
+            &*base,
+            &*delta,
+            Path::new(path),
+            cache_budget(cache_nodes),
+            &Scheduler::new(run, run_ctx),
+        )
+    }) {
+        Ok(provider) => Box::into_raw(Box::new(provider)),
+        Err(e) => {
+            write_err(err_buf, err_buf_len, &e.to_string());
+            ptr::null_mut()
+        }
+    }
+}
+
+/// Number of nodes in the file, tombstones included.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_count(handle: DiskannDiskHandle) -> i64 {
+    if handle.is_null() {
+        return 0;
+    }
+    (*handle).len() as i64
+}
+
+/// Search a disk index. `filter_words` (may be null) restricts results as in
+/// `diskann_detached_search_filtered`; `exhaustive != 0` scores every allowed node
+/// instead of traversing. Returns number of results written, or -1 on error.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_search(
+    handle: DiskannDiskHandle,
+    query_ptr: *const f32,
+    dimension: i32,
+    k: i32,
+    search_complexity: i32,
+    filter_words: *const u64,
+    num_words: i64,
+    exhaustive: i32,
+    out_labels: *mut i64,
+    out_distances: *mut f32,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i32 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    if query_ptr.is_null() || dimension <= 0 || k < 0 {
+        write_err(err_buf, err_buf_len, "Invalid query");
+        return -1;
+    }
+    if out_labels.is_null() || out_distances.is_null() {
+        write_err(err_buf, err_buf_len, "Null output buffer");
+        return -1;
+    }
+    let provider = &*handle;
+    if dimension as usize != provider.dimension() {
+        write_err(
+            err_buf,
+            err_buf_len,
+            &format!("Dimension mismatch: query {} vs index {}", dimension, provider.dimension()),
+        );
+        return -1;
+    }
+    let query = std::slice::from_raw_parts(query_ptr, dimension as usize);
+    let filter = if filter_words.is_null() || num_words < 0 {
+        None
+    } else {
+        Some(std::slice::from_raw_parts(filter_words, num_words as usize))
+    };
+    let l_search = disk_l_search(provider, search_complexity);
+    let results = match filter {
+        Some(words) if exhaustive != 0 => provider.search_exhaustive(query, k as usize, words),
+        _ => provider.search_filtered(query, k as usize, l_search, filter),
+    };
+    let n = results.len().min(k as usize);
+    for (i, (label, dist)) in results.into_iter().take(n).enumerate() {
+        *out_labels.add(i) = label as i64;
+        *out_distances.add(i) = dist;
+    }
+    n as i32
+}
+
+/// Multi-query search on a disk index; buffers as for `diskann_detached_search_batch`.
+/// Returns 0 on success, -1 on error.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_search_batch(
+    handle: DiskannDiskHandle,
+    query_matrix: *const f32,
+    nq: i32,
+    dimension: i32,
+    k: i32,
+    search_complexity: i32,
+    out_labels: *mut i64,
+    out_distances: *mut f32,
+    out_counts: *mut i32,
+    err_buf: *mut c_char,
+    err_buf_len: i32,
+) -> i32 {
+    if handle.is_null() {
+        write_err(err_buf, err_buf_len, "Null handle");
+        return -1;
+    }
+    if nq <= 0 || dimension <= 0 || k <= 0 {
+        write_err(err_buf, err_buf_len, "Invalid nq/dimension/k");
+        return -1;
+    }
+    if query_matrix.is_null() || out_labels.is_null() || out_distances.is_null() || out_counts.is_null() {
+        write_err(err_buf, err_buf_len, "Null pointer");
+        return -1;
+    }
+    let provider = &*handle;
+    let dim = dimension as usize;
+    let nq = nq as usize;
+    let k = k as usize;
+    if dim != provider.dimension() {
+        write_err(
+            err_buf,
+            err_buf_len,
+            &format!("Dimension mismatch: query {} vs index {}", dim, provider.dimension()),
+        );
+        return -1;
+    }
+    let flat = std::slice::from_raw_parts(query_matrix, nq * dim);
+    let queries: Vec<&[f32]> = (0..nq).map(|i| &flat[i * dim..(i + 1) * dim]).collect();
+    let results = provider.search_batch(&queries, k, disk_l_search(provider, search_complexity));
+    for (qi, qresults) in results.iter().enumerate() {
+        let n = qresults.len().min(k);
+        *out_counts.add(qi) = n as i32;
+        for i in 0..n {
+            *out_labels.add(qi * k + i) = qresults[i].0 as i64;
+            *out_distances.add(qi * k + i) = qresults[i].1;
+        }
+        for i in n..k {
+            *out_labels.add(qi * k + i) = -1;
+            *out_distances.add(qi * k + i) = f32::MAX;
+        }
+    }
+    0
+}
+
+/// Tombstone `n` nodes of a disk index. Returns the number newly deleted.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_mark_deleted(handle: DiskannDiskHandle, labels: *const u32, n: i64) -> i64 {
+    if handle.is_null() || labels.is_null() || n <= 0 {
+        return 0;
+    }
+    let labels = std::slice::from_raw_parts(labels, n as usize);
+    (*handle).mark_deleted(labels) as i64
+}
+
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_deleted_count(handle: DiskannDiskHandle) -> i64 {
+    if handle.is_null() {
+        return 0;
+    }
+    (*handle).deleted_count() as i64
+}
+
+/// Copy up to `capacity` tombstone words into `out`. Returns the total number of words.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_get_tombstones(handle: DiskannDiskHandle, out: *mut u64, capacity: i64) -> i64 {
+    if handle.is_null() {
+        return 0;
+    }
+    let words = (*handle).tombstone_words();
+    if !out.is_null() && capacity > 0 {
+        let n = words.len().min(capacity as usize);
+        std::slice::from_raw_parts_mut(out, n).copy_from_slice(&words[..n]);
+    }
+    words.len() as i64
+}
+
+/// Replace the tombstone bitmap with `num_words` words.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_set_tombstones(handle: DiskannDiskHandle, words: *const u64, num_words: i64) {
+    if handle.is_null() {
+        return;
+    }
+    let words = if words.is_null() || num_words <= 0 {
+        Vec::new()
+    } else {
+        std::slice::from_raw_parts(words, num_words as usize).to_vec()
+    };
+    (*handle).set_tombstones(words);
+}
+
+/// Copy node `label`'s vector into `out_vec`. Returns dimension, or 0 if not found.
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_get_vector(
+    handle: DiskannDiskHandle,
+    label: u32,
+    out_vec: *mut f32,
+    out_capacity: i32,
+) -> i32 {
+    if handle.is_null() || out_vec.is_null() || out_capacity <= 0 {
+        return 0;
+    }
+    let v = (*handle).vector(label);
+    let copy_len = v.len().min(out_capacity as usize);
+    std::ptr::copy_nonoverlapping(v.as_ptr(), out_vec, copy_len);
+    copy_len as i32
+}
+
+/// Resident bytes: the hot-node cache and the tombstones (not the mapped file).
+#[no_mangle]
+pub unsafe extern "C" fn diskann_disk_memory_bytes(handle: DiskannDiskHandle) -> u64 {
+    if handle.is_null() {
+        return 0;
+    }
+    (*handle).memory_bytes() as u64
 }
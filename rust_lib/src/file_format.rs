@@ -16,6 +16,15 @@
 //! [Adjacency segment: num_vectors * max_degree * 4 bytes]
 //!   - Unused slots padded with u32::MAX sentinel
 //!   - All values little-endian
+//!
+//! Layout (v3, sector-aligned, written by `write_sector_index` for `DiskProvider`):
+//! [Header: same 32 bytes with version = 3, then entry point IDs, zero-padded to SECTOR_SIZE]
+//! [Node sectors: node i = vector (dimension * 4 bytes) then its padded adjacency row
+//!   (max_degree * 4 bytes)]
+//!   - floor(SECTOR_SIZE / node_size) nodes share a sector and never straddle two, so one
+//!     sector read serves both the distance and the expansion of a node
+//!   - A node larger than a sector starts its own run of ceil(node_size / SECTOR_SIZE) sectors
+//!   - The last sector is zero-padded
 
 use std::io::Write;
 
@@ -24,10 +33,14 @@ use crate::provider::Provider;
 
 pub const MAGIC: &[u8; 4] = b"DANN";
 pub const VERSION: u32 = 2;
+pub const VERSION_SECTOR: u32 = 3;
 pub const HEADER_SIZE: usize = 32;
+/// NVMe read unit the v3 layout aligns nodes to.
+pub const SECTOR_SIZE: usize = 4096;
 
 #[derive(Debug, Clone)]
 pub struct FileHeader {
+    pub version: u32,
     pub num_vectors: u32,
     pub dimension: u32,
     pub max_degree: u32,
@@ -62,9 +75,54 @@ impl FileHeader {
     }
 
     pub fn total_file_size(&self) -> usize {
+        if self.is_sector_layout() {
+            return self.nodes_offset() + self.num_node_sectors() * SECTOR_SIZE;
+        }
         self.adjacency_offset() + self.adjacency_size()
     }
 
+    pub fn is_sector_layout(&self) -> bool {
+        self.version == VERSION_SECTOR
+    }
+
+    /// Bytes of one v3 node record: vector then adjacency row.
+    pub fn node_size(&self) -> usize {
+        (self.dimension as usize + self.max_degree as usize) * 4
+    }
+
+    /// Nodes packed per sector; 0 when one node spans several sectors.
+    pub fn nodes_per_sector(&self) -> usize {
+        SECTOR_SIZE / self.node_size()
+    }
+
+    /// Sectors one node spans when it does not fit in a single sector.
+    pub fn sectors_per_node(&self) -> usize {
+        (self.node_size() + SECTOR_SIZE - 1) / SECTOR_SIZE
+    }
+
+    /// Start of the first node sector (v3).
+    pub fn nodes_offset(&self) -> usize {
+        let end = HEADER_SIZE + self.entry_points_size();
+        (end + SECTOR_SIZE - 1) / SECTOR_SIZE * SECTOR_SIZE
+    }
+
+    pub fn num_node_sectors(&self) -> usize {
+        let n = self.num_vectors as usize;
+        match self.nodes_per_sector() {
+            0 => n * self.sectors_per_node(),
+            per => (n + per - 1) / per,
+        }
+    }
+
+    /// Byte offset of node `id`'s record (v3).
+    pub fn node_offset(&self, id: u32) -> usize {
+        let id = id as usize;
+        match self.nodes_per_sector() {
+            0 => self.nodes_offset() + id * self.sectors_per_node() * SECTOR_SIZE,
+            per => self.nodes_offset() + id / per * SECTOR_SIZE + id % per * self.node_size(),
+        }
+    }
+
     pub fn metric_enum(&self) -> Metric {
         match self.metric {
             1 => Metric::InnerProduct,
@@ -73,14 +131,34 @@ impl FileHeader {
     }
 }
 
-fn metric_to_u8(m: Metric) -> u8 {
+pub fn metric_to_u8(m: Metric) -> u8 {
     match m {
         Metric::L2 => 0,
         Metric::InnerProduct => 1,
     }
 }
 
-/// Write a complete .diskann index file.
+fn write_header(w: &mut dyn Write, header: &FileHeader, entry_points: &[u32]) -> std::io::Result<()> {
+    // Write header (32 bytes)
+    w.write_all(MAGIC)?;                                       // 4
+    w.write_all(&header.version.to_le_bytes())?;               // 4
+    w.write_all(&header.num_vectors.to_le_bytes())?;           // 4
+    w.write_all(&header.dimension.to_le_bytes())?;             // 4
+    w.write_all(&header.max_degree.to_le_bytes())?;            // 4
+    w.write_all(&header.num_entry_points.to_le_bytes())?;      // 4
+    w.write_all(&[header.metric])?;                            // 1
+    w.write_all(&[0u8; 3])?;                                   // 3 pad
+    w.write_all(&header.build_complexity.to_le_bytes())?;      // 4
+    // total: 32
+
+    // Write entry point IDs
+    for id in entry_points {
+        w.write_all(&id.to_le_bytes())?;
+    }
+    Ok(())
+}
+
+/// Write a complete .diskann index file (v2: separate vector and adjacency segments).
 pub fn write_index(
     w: &mut dyn Write,
     provider: &Provider,
@@ -88,27 +166,17 @@ pub fn write_index(
     build_complexity: u32,
 ) -> std::io::Result<()> {
     let entry_points = provider.get_entry_points();
-    let num_vectors = provider.len() as u32;
-    let dimension = provider.dim() as u32;
     let max_degree = provider.max_degree() as u32;
-    let num_entry_points = entry_points.len() as u32;
-
-    // Write header (32 bytes)
-    w.write_all(MAGIC)?;                                // 4
-    w.write_all(&VERSION.to_le_bytes())?;               // 4
-    w.write_all(&num_vectors.to_le_bytes())?;           // 4
-    w.write_all(&dimension.to_le_bytes())?;             // 4
-    w.write_all(&max_degree.to_le_bytes())?;            // 4
-    w.write_all(&num_entry_points.to_le_bytes())?;      // 4
-    w.write_all(&[metric_to_u8(metric)])?;              // 1
-    w.write_all(&[0u8; 3])?;                            // 3 pad
-    w.write_all(&build_complexity.to_le_bytes())?;      // 4
-    // total: 32
-
-    // Write entry point IDs
-    for id in &entry_points {
-        w.write_all(&id.to_le_bytes())?;
-    }
+    let header = FileHeader {
+        version: VERSION,
+        num_vectors: provider.len() as u32,
+        dimension: provider.dim() as u32,
+        max_degree,
+        num_entry_points: entry_points.len() as u32,
+        metric: metric_to_u8(metric),
+        build_complexity,
+    };
+    write_header(w, &header, &entry_points)?;
 
     // Write flat vectors
     provider.write_vectors_to(w)?;
@@ -118,3 +186,110 @@ pub fn write_index(
 
     Ok(())
 }
+
+/// Write a complete .diskann index file in the sector-aligned v3 layout.
+pub fn write_sector_index(
+    w: &mut dyn Write,
+    provider: &Provider,
+    metric: Metric,
+    build_complexity: u32,
+) -> std::io::Result<()> {
+    let entry_points = provider.get_entry_points();
+    let header = FileHeader {
+        version: VERSION_SECTOR,
+        num_vectors: provider.len() as u32,
+        dimension: provider.dim() as u32,
+        max_degree: provider.max_degree() as u32,
+        num_entry_points: entry_points.len() as u32,
+        metric: metric_to_u8(metric),
+        build_complexity,
+    };
+    let mut writer = SectorWriter::new(w, header, &entry_points)?;
+    provider.for_each_node(&mut |vector: &[f32], neighbors: &[u32]| writer.push(vector, neighbors))?;
+    writer.finish()
+}
+
+/// Streams nodes, in id order, into a v3 file: header first, then one sector (or run
+/// of sectors) at a time, zero-padded.
+pub struct SectorWriter<'a> {
+    w: &'a mut dyn Write,
+    header: FileHeader,
+    sector: Vec<u8>,
+    sector_bytes: usize,
+    in_sector: usize,
+    written: u32,
+}
+
+impl<'a> SectorWriter<'a> {
+    /// Writes the header and the entry points; `header.num_vectors` nodes must follow.
+    pub fn new(w: &'a mut dyn Write, header: FileHeader, entry_points: &[u32]) -> std::io::Result<Self> {
+        debug_assert_eq!(header.version, VERSION_SECTOR);
+        debug_assert_eq!(header.num_entry_points as usize, entry_points.len());
+        write_header(w, &header, entry_points)?;
+        let zeros = vec![0u8; SECTOR_SIZE];
+        w.write_all(&zeros[..header.nodes_offset() - HEADER_SIZE - header.entry_points_size()])?;
+        let sector_bytes = if header.nodes_per_sector() > 0 {
+            SECTOR_SIZE
+        } else {
+            header.sectors_per_node() * SECTOR_SIZE
+        };
+        Ok(Self {
+            w,
+            header,
+            sector: Vec::with_capacity(sector_bytes),
+            sector_bytes,
+            in_sector: 0,
+            written: 0,
+        })
+    }
+
+    /// Append the next node: its vector and up to `max_degree` neighbors.
+    pub fn push(&mut self, vector: &[f32], neighbors: &[u32]) -> std::io::Result<()> {
+        let dim = self.header.dimension as usize;
+        let max_degree = self.header.max_degree as usize;
+        if vector.len() != dim || self.written >= self.header.num_vectors {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::InvalidInput,
+                format!("node {} does not match the file header", self.written),
+            ));
+        }
+        for v in vector {
+            self.sector.extend_from_slice(&v.to_le_bytes());
+        }
+        let n = neighbors.len().min(max_degree);
+        for id in &neighbors[..n] {
+            self.sector.extend_from_slice(&id.to_le_bytes());
+        }
+        for _ in n..max_degree {
+            self.sector.extend_from_slice(&u32::MAX.to_le_bytes());
+        }
+        self.written += 1;
+        self.in_sector += 1;
+        if self.in_sector == self.header.nodes_per_sector().max(1) {
+            self.flush_sector()?;
+        }
+        Ok(())
+    }
+
+    fn flush_sector(&mut self) -> std::io::Result<()> {
+        self.sector.resize(self.sector_bytes, 0);
+        self.w.write_all(&self.sector)?;
+        self.sector.clear();
+        self.in_sector = 0;
+        Ok(())
+    }
+
+    /// Pad the last sector. Fails if fewer nodes were pushed than the header announced.
+    pub fn finish(mut self) -> std::io::Result<()> {
+        if self.written != self.header.num_vectors {
+            return Err(std::io::Error::new(
+                std::io::ErrorKind::InvalidInput,
+                format!("{} of {} nodes written", self.written, self.header.num_vectors),
+            ));
+        }
+        if self.in_sector > 0 {
+            self.flush_sector()?;
+        }
+        Ok(())
+    }
+}
@@ -0,0 +1,372 @@
+//! Merging one in-memory DiskANN graph into another without re-inserting its vectors.
+//!
+//! The other graph's nodes are appended after the target's (other label l becomes
+//! offset + l) with their adjacency remapped in bulk, so both graphs keep every edge.
+//! The two are then stitched together with a bounded number of cross edges:
+//!
+//! 1. A sample of each side (its entry points plus live nodes at an even stride)
+//!    searches the other side's graph.
+//! 2. Every sampled node robust-prunes its own neighbours plus those hits down to
+//!    max_degree.
+//! 3. The reverse of each chosen cross edge is queued on its target; targets pushed
+//!    over max_degree are pruned again.
+//!
+//! Only the sampled nodes search: the sample grows with the smaller side (an eighth of
+//! its live nodes), so the stitch stays as dense for large merges as for small ones while
+//! costing a fraction of one greedy insert per vector. The other graph's entry points
+//! join the target's, so searches start on both sides. The pruning helpers are shared
+//! with `disk_merge`.
+
+use std::collections::HashMap;
+
+use anyhow::{anyhow, Result};
+use parking_lot::Mutex;
+
+use crate::distance::compute_distance;
+use crate::index_manager::{InMemoryIndex, Metric};
+use crate::provider::Provider;
+use crate::runtime::Scheduler;
+
+/// Each side samples this fraction of its live nodes (of the smaller side) ...
+const MERGE_SAMPLE_DIVISOR: usize = 8;
+/// ... but at least this many.
+const MERGE_SAMPLE_MIN: usize = 64;
+
+/// Entry points a merged graph keeps at most: its own plus those of the graphs merged in.
+pub(crate) const MAX_ENTRY_POINTS: usize = 16;
+
+/// Sampled nodes handled by one scheduler task.
+const STITCH_TASK_NODES: usize = 64;
+
+/// Vectors by merged id, for pruning neighbour lists that span both merge inputs.
+pub(crate) trait MergedNodes: Sync {
+    fn metric(&self) -> Metric;
+
+    /// The vector of `id`, or empty if there is none.
+    fn vector(&self, id: u32) -> &[f32];
+
+    fn distance(&self, a: &[f32], id: u32) -> f32 {
+        let v = self.vector(id);
+        if v.is_empty() {
+            f32::MAX
+        } else {
+            compute_distance(self.metric(), a, v)
+        }
+    }
+
+    /// Vamana robust prune of `candidates` (distance to the node, id) down to `degree`:
+    /// a candidate is dropped when an already kept neighbour is alpha-closer to it than
+    /// the node is. Inner product distances can be negative, so alpha is not applied there.
+    fn robust_prune(&self, mut candidates: Vec<(f32, u32)>, alpha: f32, degree: usize) -> Vec<u32> {
+        candidates.sort_by(|a, b| a.0.partial_cmp(&b.0).unwrap_or(std::cmp::Ordering::Equal).then(a.1.cmp(&b.1)));
+        candidates.dedup_by_key(|c| c.1);
+        if candidates.len() <= degree {
+            return candidates.into_iter().map(|(_, id)| id).collect();
+        }
+        let alpha = match self.metric() {
+            Metric::L2 => alpha.max(1.0),
+            Metric::InnerProduct => 1.0,
+        };
+        let mut kept: Vec<u32> = Vec::with_capacity(degree);
+        let mut occluded = vec![false; candidates.len()];
+        for i in 0..candidates.len() {
+            if kept.len() == degree {
+                break;
+            }
+            if occluded[i] {
+                continue;
+            }
+            let (_, p) = candidates[i];
+            kept.push(p);
+            let pv = self.vector(p);
+            if pv.is_empty() {
+                continue;
+            }
+            for j in i + 1..candidates.len() {
+                if occluded[j] {
+                    continue;
+                }
+                let (dist_to_node, q) = candidates[j];
+                let qv = self.vector(q);
+                if !qv.is_empty() && alpha * compute_distance(self.metric(), pv, qv) <= dist_to_node {
+                    occluded[j] = true;
+                }
+            }
+        }
+        kept
+    }
+
+    /// `existing` plus `extra`, pruned back to `degree` when the union overflows it.
+    fn union_prune(&self, id: u32, existing: &[u32], extra: &[u32], alpha: f32, degree: usize) -> Vec<u32> {
+        let mut merged: Vec<u32> = existing.to_vec();
+        for &e in extra {
+            if e != id && !merged.contains(&e) {
+                merged.push(e);
+            }
+        }
+        if merged.len() <= degree {
+            return merged;
+        }
+        let node = self.vector(id);
+        let candidates = merged.into_iter().map(|n| (self.distance(node, n), n)).collect();
+        self.robust_prune(candidates, alpha, degree)
+    }
+
+    /// `candidates` (ids other than `id`) scored against node `id`, then robust-pruned.
+    fn prune_ids(&self, id: u32, candidates: &[u32], alpha: f32, degree: usize) -> Vec<u32> {
+        let node = self.vector(id);
+        let scored = candidates
+            .iter()
+            .filter(|&&c| c != id)
+            .map(|&c| (self.distance(node, c), c))
+            .collect();
+        self.robust_prune(scored, alpha, degree)
+    }
+}
+
+/// A graph copied out of an in-memory index, its labels shifted to merged ids.
+pub(crate) struct CopiedGraph {
+    pub dim: usize,
+    pub offset: u32,
+    pub vectors: Vec<f32>,
+    pub adjacency: Vec<Vec<u32>>,
+}
+
+impl CopiedGraph {
+    pub fn load(index: &InMemoryIndex, offset: u32) -> Result<Self> {
+        let mut graph = Self {
+            dim: index.dimension,
+            offset,
+            vectors: Vec::with_capacity(index.len() * index.dimension),
+            adjacency: Vec::with_capacity(index.len()),
+        };
+        index
+            .for_each_node(&mut |vector: &[f32], neighbors: &[u32]| {
+                graph.vectors.extend_from_slice(vector);
+                graph.adjacency.push(neighbors.iter().map(|&id| id + offset).collect());
+                Ok(())
+            })
+            .map_err(|e| anyhow!("Failed to read the in-memory graph: {}", e))?;
+        Ok(graph)
+    }
+
+    pub fn len(&self) -> usize {
+        self.adjacency.len()
+    }
+
+    pub fn vector(&self, local: usize) -> &[f32] {
+        &self.vectors[local * self.dim..(local + 1) * self.dim]
+    }
+}
+
+/// The target's vectors that pruning needs (ids below the offset), plus the copied graph.
+struct Stitch<'a> {
+    target: HashMap<u32, Vec<f32>>,
+    copied: &'a CopiedGraph,
+    metric: Metric,
+}
+
+impl MergedNodes for Stitch<'_> {
+    fn metric(&self) -> Metric {
+        self.metric
+    }
+
+    fn vector(&self, id: u32) -> &[f32] {
+        if id < self.copied.offset {
+            self.target.get(&id).map_or(&[], |v| v.as_slice())
+        } else {
+            let local = (id - self.copied.offset) as usize;
+            if local < self.copied.len() {
+                self.copied.vector(local)
+            } else {
+                &[]
+            }
+        }
+    }
+}
+
+/// Outcome of `stitch`: every list that differs from the two input graphs.
+pub(crate) struct StitchedEdges {
+    /// Adjacency of every copied node, in copied order (merged ids)
+    pub appended: Vec<Vec<u32>>,
+    /// Target nodes that gained cross edges, with their new lists
+    pub target: Vec<(u32, Vec<u32>)>,
+}
+
+/// `f(i)` for i in 0..n, in tasks of `STITCH_TASK_NODES` on `scheduler`; results in order.
+pub(crate) fn map_tasks<T: Send>(scheduler: &Scheduler, n: usize, f: impl Fn(usize) -> Result<T> + Sync) -> Result<Vec<T>> {
+    let slots: Vec<Mutex<Option<T>>> = (0..n).map(|_| Mutex::new(None)).collect();
+    scheduler.for_each(n.div_ceil(STITCH_TASK_NODES), |t| {
+        for i in t * STITCH_TASK_NODES..((t + 1) * STITCH_TASK_NODES).min(n) {
+            *slots[i].lock() = Some(f(i)?);
+        }
+        Ok(())
+    })?;
+    Ok(slots
+        .into_iter()
+        .map(|s| s.into_inner().expect("every slot is filled"))
+        .collect())
+}
+
+/// Nodes each side samples, from the live counts of both sides.
+fn sample_size(target_live: usize, other_live: usize) -> usize {
+    let n = target_live.min(other_live);
+    (n / MERGE_SAMPLE_DIVISOR).max(MERGE_SAMPLE_MIN.min(n))
+}
+
+/// Entry points, then about `count` live nodes of [0, len) at an even stride.
+fn sample_nodes(provider: &Provider, len: usize, count: usize) -> Vec<u32> {
+    let mut sample: Vec<u32> = provider
+        .get_entry_points()
+        .into_iter()
+        .filter(|&id| (id as usize) < len && !provider.is_deleted(id))
+        .collect();
+    if count == 0 || len == 0 {
+        return sample;
+    }
+    let stride = (len / count).max(1);
+    for id in (0..len as u32).step_by(stride) {
+        if !provider.is_deleted(id) && !sample.contains(&id) {
+            sample.push(id);
+        }
+    }
+    sample
+}
+
+/// Copy the vectors of `ids` (ids without one are left out) into `into`.
+fn fetch_vectors(
+    provider: &Provider,
+    ids: impl IntoIterator<Item = u32>,
+    into: &mut HashMap<u32, Vec<f32>>,
+    scheduler: &Scheduler,
+) -> Result<()> {
+    let missing: Vec<u32> = {
+        let mut ids: Vec<u32> = ids.into_iter().filter(|id| !into.contains_key(id)).collect();
+        ids.sort_unstable();
+        ids.dedup();
+        ids
+    };
+    let fetched = map_tasks(scheduler, missing.len(), |i| Ok(provider.get_vector(missing[i])))?;
+    for (id, vector) in missing.into_iter().zip(fetched) {
+        if let Some(v) = vector {
+            into.insert(id, v);
+        }
+    }
+    Ok(())
+}
+
+/// Cross edges between `target` (ids below `copied.offset`) and `other`, whose nodes
+/// `copied` holds at their merged ids. Both graphs are only read.
+pub(crate) fn stitch(
+    target: &InMemoryIndex,
+    other: &InMemoryIndex,
+    copied: &CopiedGraph,
+    scheduler: &Scheduler,
+) -> Result<StitchedEdges> {
+    let offset = copied.offset;
+    let degree = target.max_degree as usize;
+    let alpha = target.alpha;
+    let search_l = target.build_complexity.max(target.max_degree);
+    let tp = target.provider();
+    let op = other.provider();
+    let target_len = tp.len().min(offset as usize);
+
+    let count = sample_size(
+        target_len.saturating_sub(tp.deleted_count()),
+        copied.len().saturating_sub(op.deleted_count()),
+    );
+    let other_sample = sample_nodes(op, copied.len(), count);
+    let target_sample = sample_nodes(tp, target_len, count);
+
+    // 1. Every sample searches the other side's graph
+    let mut nodes = Stitch {
+        target: HashMap::new(),
+        copied,
+        metric: target.metric,
+    };
+    fetch_vectors(tp, target_sample.iter().copied(), &mut nodes.target, scheduler)?;
+    let other_hits: Vec<Vec<u32>> = map_tasks(scheduler, other_sample.len(), |i| {
+        let v = copied.vector(other_sample[i] as usize);
+        Ok(target.search(v, degree, search_l)?.into_iter().map(|(l, _)| l as u32).collect())
+    })?;
+    let target_hits: Vec<Vec<u32>> = map_tasks(scheduler, target_sample.len(), |i| {
+        let Some(v) = nodes.target.get(&target_sample[i]) else {
+            return Ok(Vec::new());
+        };
+        Ok(other.search(v, degree, search_l)?.into_iter().map(|(l, _)| l as u32 + offset).collect())
+    })?;
+
+    // 2. Forward edges: own neighbours plus hits, robust-pruned
+    let target_adjacency: Vec<Vec<u32>> = target_sample
+        .iter()
+        .map(|&id| tp.get_neighbors(id).unwrap_or_default())
+        .collect();
+    let other_hit_ids = other_hits.iter().flatten().copied();
+    let target_neighbor_ids = target_adjacency.iter().flatten().copied();
+    fetch_vectors(tp, other_hit_ids.chain(target_neighbor_ids), &mut nodes.target, scheduler)?;
+
+    let forward_other: Vec<Vec<u32>> = map_tasks(scheduler, other_sample.len(), |i| {
+        let local = other_sample[i] as usize;
+        let mut candidates = copied.adjacency[local].clone();
+        candidates.extend_from_slice(&other_hits[i]);
+        Ok(nodes.prune_ids(offset + local as u32, &candidates, alpha, degree))
+    })?;
+    let forward_target: Vec<Vec<u32>> = map_tasks(scheduler, target_sample.len(), |i| {
+        let mut candidates = target_adjacency[i].clone();
+        candidates.extend_from_slice(&target_hits[i]);
+        Ok(nodes.prune_ids(target_sample[i], &candidates, alpha, degree))
+    })?;
+
+    // 3. Reverse of every cross edge, then re-prune the lists they overflow
+    let mut target_lists: HashMap<u32, Vec<u32>> = target_sample.iter().copied().zip(forward_target).collect();
+    let mut appended = copied.adjacency.clone();
+    for (&local, edges) in other_sample.iter().zip(forward_other) {
+        appended[local as usize] = edges;
+    }
+    let mut reverse_target: HashMap<u32, Vec<u32>> = HashMap::new();
+    let mut reverse_other: HashMap<u32, Vec<u32>> = HashMap::new();
+    for &local in &other_sample {
+        let id = offset + local;
+        for &t in appended[local as usize].iter().filter(|&&t| t < offset) {
+            reverse_target.entry(t).or_default().push(id);
+        }
+    }
+    for (&id, edges) in &target_lists {
+        for &t in edges.iter().filter(|&&t| t >= offset) {
+            reverse_other.entry(t - offset).or_default().push(id);
+        }
+    }
+
+    for &t in reverse_target.keys() {
+        if !target_lists.contains_key(&t) {
+            target_lists.insert(t, tp.get_neighbors(t).unwrap_or_default());
+        }
+    }
+    let reverse_ids = reverse_target
+        .keys()
+        .flat_map(|t| std::iter::once(*t).chain(target_lists[t].iter().copied()))
+        .filter(|&id| id < offset)
+        .collect::<Vec<u32>>();
+    fetch_vectors(tp, reverse_ids, &mut nodes.target, scheduler)?;
+
+    let reverse_target: Vec<(u32, Vec<u32>)> = reverse_target.into_iter().collect();
+    let repaired_target = map_tasks(scheduler, reverse_target.len(), |i| {
+        let (t, extra) = &reverse_target[i];
+        Ok(nodes.union_prune(*t, &target_lists[t], extra, alpha, degree))
+    })?;
+    for ((t, _), list) in reverse_target.iter().zip(repaired_target) {
+        target_lists.insert(*t, list);
+    }
+    let reverse_other: Vec<(u32, Vec<u32>)> = reverse_other.into_iter().collect();
+    let repaired_other = map_tasks(scheduler, reverse_other.len(), |i| {
+        let (local, extra) = &reverse_other[i];
+        Ok(nodes.union_prune(offset + local, &appended[*local as usize], extra, alpha, degree))
+    })?;
+    for ((local, _), list) in reverse_other.iter().zip(repaired_other) {
+        appended[*local as usize] = list;
+    }
+
+    let mut target: Vec<(u32, Vec<u32>)> = target_lists.into_iter().collect();
+    target.sort_unstable_by_key(|(id, _)| *id);
+    Ok(StitchedEdges { appended, target })
+}
@@ -0,0 +1,68 @@
+//! Half-width vector storage for the in-memory DiskANN provider (`precision = 'f16' | 'bf16'`).
+//!
+//! Every vector is kept as 16-bit floats, two bytes per dimension. Distances are
+//! accumulated in f32: a code is widened a block at a time into a stack buffer
+//! (F16C / NEON fp16 through `half` where the CPU has them, a shift for bf16) and
+//! scored with the same kernels as full-precision vectors.
+
+use half::slice::{HalfBitsSliceExt, HalfFloatSliceExt};
+use half::{bf16, f16};
+
+use crate::index_manager::Metric;
+
+/// Dimensions widened per kernel call when scoring a code.
+const BLOCK: usize = 64;
+
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub enum HalfFormat {
+    /// IEEE binary16: 10-bit mantissa, range +-65504
+    F16 = 1,
+    /// bfloat16: the top half of an f32 (full f32 range, 7-bit mantissa)
+    Bf16 = 2,
+}
+
+impl HalfFormat {
+    pub fn from_u8(v: u8) -> Option<Self> {
+        match v {
+            1 => Some(HalfFormat::F16),
+            2 => Some(HalfFormat::Bf16),
+            _ => None,
+        }
+    }
+
+    /// Round `src` to the nearest representable value, `dst.len() == src.len()`.
+    pub fn encode(self, src: &[f32], dst: &mut [u16]) {
+        match self {
+            HalfFormat::F16 => dst.reinterpret_cast_mut::<f16>().convert_from_f32_slice(src),
+            HalfFormat::Bf16 => dst.reinterpret_cast_mut::<bf16>().convert_from_f32_slice(src),
+        }
+    }
+
+    /// Widen `src` to f32, `dst.len() == src.len()`.
+    #[inline]
+    pub fn decode(self, src: &[u16], dst: &mut [f32]) {
+        match self {
+            HalfFormat::F16 => src.reinterpret_cast::<f16>().convert_to_f32_slice(dst),
+            HalfFormat::Bf16 => {
+                for (d, &s) in dst.iter_mut().zip(src) {
+                    *d = f32::from_bits((s as u32) << 16);
+                }
+            }
+        }
+    }
+
+    /// Distance from an f32 `query` to a half-width `code` (same convention as
+    /// `distance::compute_distance`). Both metrics are sums over dimensions, so
+    /// block partials add up to the full distance.
+    #[inline]
+    pub fn distance(self, metric: Metric, query: &[f32], code: &[u16]) -> f32 {
+        let mut buf = [0.0f32; BLOCK];
+        let mut sum = 0.0f32;
+        for (q, c) in query.chunks(BLOCK).zip(code.chunks(BLOCK)) {
+            let wide = &mut buf[..c.len()];
+            self.decode(c, wide);
+            sum += crate::distance::compute_distance(metric, q, wide);
+        }
+        sum
+    }
+}
@@ -1,23 +1,28 @@
 use anyhow::{anyhow, Result};
 use dashmap::DashMap;
-use parking_lot::RwLock;
+use parking_lot::{Mutex, RwLock};
 use std::cell::RefCell;
 use std::io::{BufWriter, Cursor};
+use std::num::NonZeroUsize;
 use std::path::Path;
-use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::atomic::{AtomicBool, AtomicU32, AtomicU64, Ordering};
 use std::sync::{Arc, LazyLock};
 
 use diskann::graph::{
-    DiskANNIndex, SearchParams,
+    Config, DiskANNIndex, SearchParams,
     config::{Builder, MaxDegree, PruneKind},
+    index::SearchStats,
     search_output_buffer::IdDistance,
 };
+use diskann::utils::VectorIdBoxSlice;
 use diskann_vector::distance::Metric as DiskANNMetric;
 
 use crate::disk_provider::DiskProvider;
 use crate::file_format;
-use crate::provider::{DefaultContext, FullPrecisionStrategy, Provider};
-use crate::runtime;
+use crate::graph_merge::{self, CopiedGraph, StitchedEdges};
+use crate::provider::{DefaultContext, FullPrecisionStrategy, LabelBitmap, PageLoader, Provider};
+use crate::runtime::{self, Scheduler};
+use crate::search_stats::SearchTally;
 
 // Bounds-checked byte readers for safe deserialization of untrusted data.
 
@@ -156,8 +161,44 @@ pub struct InMemoryIndex {
     pub build_complexity: u32,
     pub alpha: f32,
     provider: Provider,
-    index: RwLock<Option<DiskANNIndex<Provider>>>,
+    index: RwLock<Option<Arc<DiskANNIndex<Provider>>>>,
     next_label: AtomicU64,
+    /// Consolidated tombstones: unlinked from the graph, handed out again by inserts
+    free_slots: Mutex<Vec<u32>>,
+    consolidation: Mutex<ConsolidationPass>,
+    /// Serializes consolidation slices; `consolidation` itself is only held between
+    /// repairs, so inserts can record their labels while a slice runs
+    consolidation_slice: Mutex<()>,
+    /// Fast path for inserts: a pass is in progress and wants their labels
+    consolidating: AtomicBool,
+    /// SQ8/PQ candidates re-ranked on full precision per search (0 = 4 * k)
+    rerank: AtomicU32,
+}
+
+/// An in-progress in-place delete consolidation. A pass snapshots the tombstones,
+/// walks every live node in id order (in bounded slices) replacing edges to them
+/// with their neighbourhoods, then unlinks the snapshot and frees its slots.
+#[derive(Default)]
+struct ConsolidationPass {
+    active: bool,
+    cursor: u32,
+    /// Tombstones the pass will free once every live node has been repaired
+    pending: Vec<u32>,
+    /// Nodes inserted mid-pass: their edges may point at `pending`
+    revisit: Vec<u32>,
+}
+
+/// Progress of one consolidation slice.
+#[derive(Debug, Clone, Copy, Default)]
+pub struct ConsolidateProgress {
+    /// Live nodes repaired by this slice
+    pub visited: u64,
+    /// Slots freed for reuse by this slice (non-zero only when a pass finishes)
+    pub freed: u64,
+    /// Nodes left before the current pass can free its tombstones
+    pub remaining: u64,
+    /// No pass in progress after this slice
+    pub done: bool,
 }
 
 /// Disk-backed read-only index loaded from .diskann file.
@@ -223,6 +264,32 @@ thread_local! {
     static SEARCH_CTX: RefCell<SearchContext> = RefCell::new(SearchContext::new());
 }
 
+/// Upper bound on vectors handed to a single `multi_insert_on` call. Each minibatch
+/// is also capped at the current graph size so early batches still find good
+/// neighbours among already-inserted vectors.
+const MAX_INSERT_MINIBATCH: usize = 4096;
+
+/// Vectors per scheduler task in the parallel phases of a batched insert.
+const INSERT_TASK_VECTORS: usize = 64;
+
+/// Nodes repaired by one scheduler task of a consolidation slice.
+const CONSOLIDATE_TASK_NODES: usize = 256;
+
+/// Build the DiskANN graph config.
+fn build_config(metric: Metric, max_degree: u32, build_complexity: u32, alpha: f32) -> Result<Config> {
+    let prune_kind = PruneKind::from_metric(metric.to_diskann());
+    let mut builder = Builder::new(
+        max_degree as usize,
+        MaxDegree::default_slack(),
+        build_complexity as usize,
+        prune_kind,
+    );
+    builder.alpha(alpha);
+    builder
+        .build()
+        .map_err(|e| anyhow!("DiskANN config error: {}", e))
+}
+
 impl InMemoryIndex {
     /// Create a detached (unregistered) index for streaming build.
     pub fn new_detached(
@@ -256,6 +323,11 @@ impl InMemoryIndex {
             provider,
             index: RwLock::new(None),
             next_label: AtomicU64::new(0),
+            free_slots: Mutex::new(Vec::new()),
+            consolidation: Mutex::new(ConsolidationPass::default()),
+            consolidation_slice: Mutex::new(()),
+            consolidating: AtomicBool::new(false),
+            rerank: AtomicU32::new(0),
         }
     }
 
@@ -269,7 +341,7 @@ impl InMemoryIndex {
             ));
         }
 
-        let label = self.next_label.fetch_add(1, Ordering::Relaxed) as u32;
+        let label = self.allocate_labels(1)[0];
 
         // Fast path: index already initialized
         {
@@ -277,8 +349,9 @@ impl InMemoryIndex {
             if let Some(index) = idx_guard.as_ref() {
                 let strategy = FullPrecisionStrategy::new();
                 let ctx = DefaultContext;
-                runtime::block_on(index.insert(strategy, &ctx, &label, vector))
+                runtime::run(index.insert(strategy, &ctx, &label, vector))
                     .map_err(|e| anyhow!("DiskANN insert error: {}", e))?;
+                self.note_inserted(&[label]);
                 return Ok(label as u64);
             }
         }
@@ -288,30 +361,83 @@ impl InMemoryIndex {
         if let Some(index) = idx_guard.as_ref() {
             let strategy = FullPrecisionStrategy::new();
             let ctx = DefaultContext;
-            runtime::block_on(index.insert(strategy, &ctx, &label, vector))
+            runtime::run(index.insert(strategy, &ctx, &label, vector))
                 .map_err(|e| anyhow!("DiskANN insert error: {}", e))?;
+            self.note_inserted(&[label]);
         } else {
             self.provider.insert_start_point(label, vector.to_vec());
 
-            let prune_kind = PruneKind::from_metric(self.metric.to_diskann());
-            let mut builder = Builder::new(
-                self.max_degree as usize,
-                MaxDegree::default_slack(),
-                self.build_complexity as usize,
-                prune_kind,
-            );
-            builder.alpha(self.alpha);
-            let config = builder
-                .build()
-                .map_err(|e| anyhow!("DiskANN config error: {}", e))?;
-
+            let config = build_config(self.metric, self.max_degree, self.build_complexity, self.alpha)?;
             let index = DiskANNIndex::new(config, self.provider.clone(), None);
-            *idx_guard = Some(index);
+            *idx_guard = Some(Arc::new(index));
         }
 
         Ok(label as u64)
     }
 
+    /// Add `n` row-major vectors in one call. Labels reuse freed slots first, then
+    /// grow contiguously, and are written to `out_labels` (if given). Insertion runs through
+    /// the crate's `multi_insert_on`, which searches/prunes each minibatch and commits its
+    /// aggregated back-edges in tasks of about `INSERT_TASK_VECTORS` vectors on `scheduler`.
+    pub fn add_batch(&self, vectors: &[f32], out_labels: Option<&mut [i64]>, scheduler: &Scheduler) -> Result<usize> {
+        let dim = self.dimension;
+        if dim == 0 || vectors.len() % dim != 0 {
+            return Err(anyhow!(
+                "Batch length {} is not a multiple of dimension {}",
+                vectors.len(),
+                dim
+            ));
+        }
+        let n = vectors.len() / dim;
+        if n == 0 {
+            return Ok(0);
+        }
+
+        let mut labels: Vec<u32> = Vec::with_capacity(n);
+
+        // The first vector seeds the start point and creates the graph.
+        let mut done = 0;
+        if self.index.read().is_none() {
+            labels.push(self.add(&vectors[..dim])? as u32);
+            done = 1;
+        }
+
+        let index = self
+            .index
+            .read()
+            .as_ref()
+            .cloned()
+            .ok_or_else(|| anyhow!("Index not initialized"))?;
+
+        labels.extend(self.allocate_labels(n - done));
+
+        let strategy = FullPrecisionStrategy::new();
+        let ctx = DefaultContext;
+        while done < n {
+            let batch = self
+                .provider
+                .len()
+                .clamp(1, MAX_INSERT_MINIBATCH)
+                .min(n - done);
+            let items: Box<[VectorIdBoxSlice<u32, f32>]> = (done..done + batch)
+                .map(|i| VectorIdBoxSlice::new(labels[i], vectors[i * dim..(i + 1) * dim].into()))
+                .collect();
+            let tasks = NonZeroUsize::new(batch.div_ceil(INSERT_TASK_VECTORS)).unwrap_or(NonZeroUsize::MIN);
+            index
+                .multi_insert_on(&strategy, &ctx, items, tasks, scheduler)
+                .map_err(|e| anyhow!("DiskANN multi-insert error: {}", e))?;
+            done += batch;
+        }
+        self.note_inserted(&labels);
+
+        if let Some(out) = out_labels {
+            for (dst, &l) in out.iter_mut().zip(labels.iter()) {
+                *dst = l as i64;
+            }
+        }
+        Ok(n)
+    }
+
     pub fn search(&self, query: &[f32], k: usize, search_complexity: u32) -> Result<Vec<(u64, f32)>> {
         if query.len() != self.dimension {
             return Err(anyhow!(
@@ -329,6 +455,9 @@ impl InMemoryIndex {
         let k = k.min(n);
 
         if n == 1 {
+            if self.provider.is_deleted(0) {
+                return Ok(Vec::new());
+            }
             let dist = self.single_vector_distance(query);
             return Ok(vec![(0, dist)]);
         }
@@ -346,7 +475,11 @@ impl InMemoryIndex {
         } else {
             self.build_complexity as usize
         };
-        let l_search = k.max(base_l);
+        let l_search = self.live_l_search(k.max(base_l));
+        if self.provider.searches_codes() {
+            let rerank = self.rerank_depth(k);
+            return Ok(self.provider.search_quantized(query, k, l_search, rerank, self.metric, None));
+        }
         let params = SearchParams::new(k, l_search, None)
             .map_err(|e| anyhow!("SearchParams error: {}", e))?;
 
@@ -364,8 +497,9 @@ impl InMemoryIndex {
                 let mut buffer = IdDistance::new(id_slice, dist_slice);
 
                 let stats =
-                    runtime::block_on(index.search(&strategy, &ctx, query, &params, &mut buffer))
+                    runtime::run(index.search(&strategy, &ctx, query, &params, &mut buffer))
                         .map_err(|e| anyhow!("DiskANN search error: {}", e))?;
+                self.record_search(&stats);
 
                 stats.result_count as usize
             };
@@ -405,11 +539,60 @@ impl InMemoryIndex {
         } else {
             self.build_complexity as usize
         };
-        let l_search = k.max(base_l);
+        let l_search = self.live_l_search(k.max(base_l));
 
+        if self.provider.searches_codes() {
+            let rerank = self.rerank_depth(k);
+            return Ok(queries
+                .iter()
+                .map(|q| self.provider.search_quantized(q, k, l_search, rerank, self.metric, None))
+                .collect());
+        }
         Ok(self.provider.search_batch(queries, k, l_search, self.metric))
     }
 
+    /// Filtered search restricted to the labels set in `allowed` (64-bit words).
+    ///
+    /// `exhaustive = true` scores every allowed label exactly (pre-filter);
+    /// otherwise the graph is traversed and non-matching nodes only route
+    /// (in-traversal filter).
+    /// Full precision while the vectors are in memory; on the codes (with
+    /// re-ranking) once they were evicted.
+    pub fn search_filtered(
+        &self,
+        query: &[f32],
+        k: usize,
+        search_complexity: u32,
+        allowed: &[u64],
+        exhaustive: bool,
+    ) -> Result<Vec<(u64, f32)>> {
+        if query.len() != self.dimension {
+            return Err(anyhow!(
+                "Query dimension {} doesn't match index dimension {}",
+                query.len(),
+                self.dimension
+            ));
+        }
+
+        let allowed = LabelBitmap::new(allowed);
+        if exhaustive {
+            return Ok(self.provider.flat_search_filtered(query, k, self.metric, allowed));
+        }
+
+        let base_l = if search_complexity > 0 {
+            search_complexity as usize
+        } else {
+            self.build_complexity as usize
+        };
+        let l_search = k.max(base_l);
+
+        if self.provider.vectors_evicted() {
+            let rerank = self.rerank_depth(k);
+            return Ok(self.provider.search_quantized(query, k, l_search, rerank, self.metric, Some(allowed)));
+        }
+        Ok(self.provider.search_filtered(query, k, l_search, self.metric, allowed))
+    }
+
     /// Search writing results directly into caller-provided buffers.
     /// Returns number of results written. Avoids intermediate Vec allocation.
     pub fn search_into(
@@ -436,6 +619,9 @@ impl InMemoryIndex {
         let k = k.min(n);
 
         if n == 1 {
+            if self.provider.is_deleted(0) {
+                return Ok(0);
+            }
             let dist = self.single_vector_distance(query);
             if !out_labels.is_empty() && !out_distances.is_empty() {
                 out_labels[0] = 0;
@@ -458,7 +644,17 @@ impl InMemoryIndex {
         } else {
             self.build_complexity as usize
         };
-        let l_search = k.max(base_l);
+        let l_search = self.live_l_search(k.max(base_l));
+        if self.provider.searches_codes() {
+            let rerank = self.rerank_depth(k);
+            let results = self.provider.search_quantized(query, k, l_search, rerank, self.metric, None);
+            let cap = results.len().min(out_labels.len()).min(out_distances.len());
+            for (i, &(label, dist)) in results.iter().take(cap).enumerate() {
+                out_labels[i] = label as i64;
+                out_distances[i] = dist;
+            }
+            return Ok(cap);
+        }
         let params = SearchParams::new(k, l_search, None)
             .map_err(|e| anyhow!("SearchParams error: {}", e))?;
 
@@ -472,8 +668,9 @@ impl InMemoryIndex {
                 let (id_slice, dist_slice) = scratch.split_slices(k);
                 let mut buffer = IdDistance::new(id_slice, dist_slice);
                 let stats =
-                    runtime::block_on(index.search(&strategy, &ctx, query, &params, &mut buffer))
+                    runtime::run(index.search(&strategy, &ctx, query, &params, &mut buffer))
                         .map_err(|e| anyhow!("DiskANN search error: {}", e))?;
+                self.record_search(&stats);
                 stats.result_count as usize
             };
 
@@ -486,6 +683,23 @@ impl InMemoryIndex {
         })
     }
 
+    /// Counters of a search run by the DiskANN crate (tombstones skipped are counted by
+    /// its post-processor). Every comparison scores a distinct node.
+    fn record_search(&self, stats: &SearchStats) {
+        self.provider.search_stats().record(&SearchTally {
+            searches: 1,
+            distance_computations: stats.cmps as u64,
+            hops: stats.hops as u64,
+            visited: stats.cmps as u64,
+            ..Default::default()
+        });
+    }
+
+    /// Search counters of this index since it was created or loaded.
+    pub fn search_stats(&self) -> SearchTally {
+        self.provider.search_stats().snapshot()
+    }
+
     /// Get adjacency lists for all vectors 0..count, each padded/truncated to max_deg.
     pub fn get_all_adjacency(&self, count: usize, max_deg: usize) -> Vec<Vec<u32>> {
         let mut result = Vec::with_capacity(count);
@@ -503,8 +717,214 @@ impl InMemoryIndex {
         self.provider.get_entry_points()
     }
 
+    // ---- Paged persistence (one storage page = provider::PAGE_NODES nodes) ----
+
+    /// Pages whose adjacency changed since the last call (drains the dirty set).
+    pub fn take_dirty_adjacency_pages(&self) -> Vec<u32> {
+        self.provider.take_dirty_adjacency_pages()
+    }
+
+    pub fn take_dirty_vector_pages(&self) -> Vec<u32> {
+        self.provider.take_dirty_vector_pages()
+    }
+
+    /// Export vectors and/or padded adjacency for nodes [start, start + count).
+    pub fn export_page(
+        &self,
+        start: u32,
+        count: u32,
+        vectors: Option<&mut [f32]>,
+        adjacency: Option<&mut [u32]>,
+    ) -> Result<()> {
+        if start as usize + count as usize > self.provider.len() {
+            return Err(anyhow!(
+                "Page [{}, {}) out of range (index has {} vectors)",
+                start,
+                start as usize + count as usize,
+                self.provider.len()
+            ));
+        }
+        if let Some(out) = vectors {
+            self.provider.export_vectors(start, count, out);
+        }
+        if let Some(out) = adjacency {
+            self.provider.export_adjacency(start, count, self.max_degree as usize, out);
+        }
+        Ok(())
+    }
+
+    /// Import one persisted page into an empty detached index.
+    pub fn import_page(&self, start: u32, vectors: &[f32], adjacency: &[u32]) -> Result<()> {
+        let count = vectors.len() / self.dimension;
+        if vectors.len() != count * self.dimension || adjacency.len() != count * self.max_degree as usize {
+            return Err(anyhow!("Page buffer sizes do not match dimension/max_degree"));
+        }
+        self.provider.import_page(start, vectors, adjacency, self.max_degree as usize);
+        Ok(())
+    }
+
+    /// Finish a page-by-page import: install entry points and build the graph index
+    /// over the already-populated provider.
+    pub fn finish_import(&self, num_vectors: u32, entry_points: Vec<u32>) -> Result<()> {
+        if self.provider.len() != num_vectors as usize {
+            return Err(anyhow!(
+                "Imported {} vectors, expected {}",
+                self.provider.len(),
+                num_vectors
+            ));
+        }
+        if num_vectors > 0 && entry_points.is_empty() {
+            return Err(anyhow!("Missing entry points"));
+        }
+        self.provider.set_entry_points(entry_points);
+        let mut idx_guard = self.index.write();
+        if num_vectors > 0 {
+            let config = build_config(self.metric, self.max_degree, self.build_complexity, self.alpha)?;
+            *idx_guard = Some(Arc::new(DiskANNIndex::new(config, self.provider.clone(), None)));
+        }
+        self.next_label.store(num_vectors as u64, Ordering::Relaxed);
+        Ok(())
+    }
+
+    // ---- PQ codes (persisted page by page next to the vectors) ----
+
+    pub fn pq_codebook_bytes(&self) -> Vec<u8> {
+        self.provider.pq_codebook_bytes()
+    }
+
+    pub fn pq_code_size(&self) -> usize {
+        self.provider.pq_code_size()
+    }
+
+    /// Export the codes of nodes [start, start + count). Returns nodes copied.
+    pub fn export_pq_codes(&self, start: u32, count: u32, out: &mut [u8]) -> usize {
+        self.provider.export_pq_codes(start, count, out)
+    }
+
+    /// Install a persisted codebook and the codes of every node (before `attach_pager`).
+    pub fn load_pq(&self, codebook: &[u8], codes: Vec<u8>) -> Result<()> {
+        self.provider.load_pq(codebook, codes)
+    }
+
+    // ---- Tombstones (deleted labels route searches but are never returned) ----
+
+    pub fn mark_deleted(&self, labels: &[u32]) -> usize {
+        self.provider.mark_deleted(labels)
+    }
+
+    pub fn deleted_count(&self) -> usize {
+        self.provider.deleted_count()
+    }
+
+    pub fn tombstone_words(&self) -> Vec<u64> {
+        self.provider.tombstone_words()
+    }
+
+    pub fn set_tombstones(&self, words: Vec<u64>) {
+        self.provider.set_tombstones(words)
+    }
+
+    /// Open lazily over paged storage: nodes [0, num_vectors) stay on disk and are
+    /// faulted in a page at a time through `load(ctx, ...)` when first touched.
+    pub fn attach_pager(
+        &self,
+        num_vectors: u32,
+        entry_points: Vec<u32>,
+        load: PageLoader,
+        ctx: *mut std::ffi::c_void,
+    ) -> Result<()> {
+        if self.provider.len() != 0 {
+            return Err(anyhow!("Pager can only be attached to an empty index"));
+        }
+        if num_vectors > 0 && entry_points.is_empty() {
+            return Err(anyhow!("Missing entry points"));
+        }
+        self.provider.attach_pager(num_vectors, load, ctx);
+        self.finish_import(num_vectors, entry_points)
+    }
+
+    /// Pages not yet faulted in from storage.
+    pub fn nonresident_pages(&self) -> u32 {
+        self.provider.nonresident_pages()
+    }
+
+    /// Storage now holds the vectors of [0, num_persisted): a quantized index drops
+    /// them from memory and reads them back through `load` only to re-rank.
+    /// Returns false (and keeps them) when there are no SQ8/PQ codes to search on.
+    pub fn evict_vectors(&self, num_persisted: u32, load: PageLoader, ctx: *mut std::ffi::c_void) -> bool {
+        self.provider.evict_vectors(num_persisted, load, ctx)
+    }
+
+    /// Resident memory estimate (vectors, codes and loaded adjacency).
+    pub fn memory_bytes(&self) -> usize {
+        self.provider.memory_bytes()
+    }
+
+    pub fn page_loads(&self) -> u64 {
+        self.provider.page_loads()
+    }
+
+    /// Run `op`, failing if one of the page loads it triggered failed: the graph code
+    /// reads nodes on such a page as missing, so the loader error is reported here.
+    pub fn with_page_loads<T>(&self, op: impl FnOnce() -> Result<T>) -> Result<T> {
+        let before = self.provider.load_failures();
+        let result = op()?;
+        self.provider.check_page_loads(before)?;
+        Ok(result)
+    }
+
+    pub fn sq8_params(&self) -> Option<crate::provider::SQ8Params> {
+        self.provider.get_sq8_params()
+    }
+
+    /// Export the SQ8 codes of nodes [start, start + count). Returns nodes copied.
+    pub fn export_sq8_codes(&self, start: u32, count: u32, out: &mut [u8]) -> usize {
+        self.provider.export_sq8_codes(start, count, out)
+    }
+
+    /// Install persisted SQ8 params and codes (no retraining).
+    pub fn load_sq8(&self, codes: Vec<u8>, params: crate::provider::SQ8Params) {
+        self.provider.load_sq8(codes, params)
+    }
+
+    // ---- Half-width vectors (persisted in place of the full-precision pages) ----
+
+    pub fn half_format(&self) -> Option<crate::half_precision::HalfFormat> {
+        self.provider.half_format()
+    }
+
+    /// Export the half-width vectors of nodes [start, start + count). Returns nodes copied.
+    pub fn export_half_codes(&self, start: u32, count: u32, out: &mut [u16]) -> usize {
+        self.provider.export_half_codes(start, count, out)
+    }
+
+    /// Install the persisted half-width vectors of every node (before `attach_pager`).
+    pub fn load_half(&self, format: crate::half_precision::HalfFormat, codes: Vec<u16>) {
+        self.provider.load_half(format, codes)
+    }
+
+    /// Fault in every page still on storage.
+    pub fn load_all_pages(&self) -> Result<()> {
+        if self.provider.load_all_pages() {
+            Ok(())
+        } else {
+            Err(anyhow!("Failed to load index page from storage"))
+        }
+    }
+
+    /// Write a standalone .diskann file for `DiskProvider` (sector-aligned v3 layout).
+    pub fn write_disk_file(&self, w: &mut dyn std::io::Write) -> Result<()> {
+        file_format::write_sector_index(w, &self.provider, self.metric, self.build_complexity)
+            .map_err(|e| anyhow!("Failed to write index: {}", e))
+    }
+
+    /// Visit every node in id order with its vector and neighbours.
+    pub fn for_each_node(&self, f: &mut dyn FnMut(&[f32], &[u32]) -> std::io::Result<()>) -> std::io::Result<()> {
+        self.provider.for_each_node(f)
+    }
+
     /// Serialize the index to bytes (reuses the .diskann binary format).
-    /// If SQ8 is active, appends quantization data after the standard format.
+    /// If SQ8 or PQ is active, appends quantization data after the standard format.
     pub fn serialize_to_bytes(&self) -> Result<Vec<u8>> {
         let mut cursor = Cursor::new(Vec::new());
         file_format::write_index(&mut cursor, &self.provider, self.metric, self.build_complexity)
@@ -532,6 +952,20 @@ impl InMemoryIndex {
             }
         }
 
+        // Append PQ codebook + codes
+        if self.provider.is_pq() {
+            use std::io::Write;
+            let codebook = self.provider.pq_codebook_bytes();
+            let n = self.provider.len() as u32;
+            let mut codes = vec![0u8; n as usize * self.provider.pq_code_size()];
+            self.provider.export_pq_codes(0, n, &mut codes);
+            cursor.write_all(b"PQ\0\0")?;
+            cursor.write_all(&(codebook.len() as u32).to_le_bytes())?;
+            cursor.write_all(&codebook)?;
+            cursor.write_all(&(codes.len() as u64).to_le_bytes())?;
+            cursor.write_all(&codes)?;
+        }
+
         Ok(cursor.into_inner())
     }
 
@@ -612,22 +1046,12 @@ impl InMemoryIndex {
         );
 
         // Rebuild DiskANN index on the pre-populated provider
-        let prune_kind = PruneKind::from_metric(diskann_metric);
-        let mut builder = Builder::new(
-            max_degree as usize,
-            MaxDegree::default_slack(),
-            build_complexity as usize,
-            prune_kind,
-        );
-        builder.alpha(alpha);
-        let config = builder
-            .build()
-            .map_err(|e| anyhow!("DiskANN config error: {}", e))?;
-
+        let config = build_config(metric, max_degree, build_complexity, alpha)?;
         let index = DiskANNIndex::new(config, provider.clone(), None);
 
         // Check for SQ8 data appended after the standard format
         let standard_end = adj_offset + adj_size;
+        let mut section_end = standard_end;
         if data.len() > standard_end + 4 && &data[standard_end..standard_end + 4] == b"SQ8\0" {
             let sq_offset = standard_end + 4;
             let sq_dim = read_u32(data, sq_offset)? as usize;
@@ -657,6 +1081,7 @@ impl InMemoryIndex {
 
             let qdata_offset = params_offset + sq_params_size;
             let qdata = data[qdata_offset..qdata_offset + qlen].to_vec();
+            section_end = sq_total;
 
             provider.load_sq8(
                 qdata,
@@ -667,6 +1092,25 @@ impl InMemoryIndex {
             );
         }
 
+        // PQ section (may follow the SQ8 one)
+        if data.len() > section_end + 4 && &data[section_end..section_end + 4] == b"PQ\0\0" {
+            let cb_len = read_u32(data, section_end + 4)? as usize;
+            let cb_offset = section_end + 8;
+            let codes_len = read_u64_le(data, cb_offset + cb_len)? as usize;
+            let codes_offset = cb_offset + cb_len + 8;
+            if codes_offset + codes_len > data.len() {
+                return Err(anyhow!(
+                    "PQ section truncated: need {} bytes, have {}",
+                    codes_offset + codes_len,
+                    data.len()
+                ));
+            }
+            provider.load_pq(
+                &data[cb_offset..cb_offset + cb_len],
+                data[codes_offset..codes_offset + codes_len].to_vec(),
+            )?;
+        }
+
         Ok(Self {
             name: String::new(),
             dimension,
@@ -675,44 +1119,254 @@ impl InMemoryIndex {
             build_complexity,
             alpha,
             provider,
-            index: RwLock::new(Some(index)),
+            index: RwLock::new(Some(Arc::new(index))),
             next_label: AtomicU64::new(num_vectors as u64),
+            free_slots: Mutex::new(Vec::new()),
+            consolidation: Mutex::new(ConsolidationPass::default()),
+            consolidation_slice: Mutex::new(()),
+            consolidating: AtomicBool::new(false),
+            rerank: AtomicU32::new(0),
         })
     }
 
-    /// Compact the index by rebuilding from non-deleted labels.
-    /// Returns a new InMemoryIndex with contiguous labels 0..n and
-    /// a mapping from old_label -> new_label for each kept vector.
-    /// The caller provides the set of deleted labels to exclude.
-    pub fn compact(&self, deleted_labels: &std::collections::HashSet<u32>) -> Result<(Self, Vec<(u32, u32)>)> {
-        let count = self.provider.len();
-        let mut vectors: Vec<Vec<f32>> = Vec::new();
-        let mut label_map: Vec<(u32, u32)> = Vec::new(); // (old_label, new_label)
+    /// Labels for `n` new vectors: freed slots first (their tombstones cleared),
+    /// then fresh labels past the end.
+    fn allocate_labels(&self, n: usize) -> Vec<u32> {
+        let mut labels = {
+            let mut free = self.free_slots.lock();
+            let take = n.min(free.len());
+            free.split_off(free.len() - take)
+        };
+        self.provider.clear_deleted(&labels);
+        let fresh = n - labels.len();
+        if fresh > 0 {
+            let base = self.next_label.fetch_add(fresh as u64, Ordering::Relaxed) as u32;
+            labels.extend((0..fresh as u32).map(|i| base + i));
+        }
+        labels
+    }
+
+    fn note_inserted(&self, labels: &[u32]) {
+        if self.consolidating.load(Ordering::Acquire) {
+            self.consolidation.lock().revisit.extend_from_slice(labels);
+        }
+    }
 
-        for old_label in 0..count as u32 {
-            if deleted_labels.contains(&old_label) {
-                continue;
+    /// Run one slice of in-place delete consolidation: repair up to `max_nodes`
+    /// live nodes (0 = finish the pass). When a pass has visited every node its
+    /// tombstones are unlinked and their slots recycled by later inserts.
+    pub fn consolidate(&self, max_nodes: usize, scheduler: &Scheduler) -> Result<ConsolidateProgress> {
+        let index = match self.index.read().as_ref() {
+            Some(index) => index.clone(),
+            None => {
+                return Ok(ConsolidateProgress {
+                    done: true,
+                    ..Default::default()
+                })
             }
-            if let Some(vec) = self.provider.get_vector(old_label) {
-                let new_label = vectors.len() as u32;
-                label_map.push((old_label, new_label));
-                vectors.push(vec);
+        };
+
+        let _slice = self.consolidation_slice.lock();
+        let mut pass = self.consolidation.lock();
+        if !pass.active {
+            // Deleted entry points hand over to a live neighbour first, then go with the rest
+            self.provider.replace_deleted_entry_points();
+            let free: std::collections::HashSet<u32> = self.free_slots.lock().iter().copied().collect();
+            let entry_points = self.provider.get_entry_points();
+            pass.pending = self
+                .provider
+                .deleted_ids()
+                .into_iter()
+                .filter(|id| !free.contains(id) && !entry_points.contains(id))
+                .collect();
+            if pass.pending.is_empty() {
+                return Ok(ConsolidateProgress {
+                    done: true,
+                    ..Default::default()
+                });
             }
+            pass.active = true;
+            pass.cursor = 0;
+            pass.revisit.clear();
+            self.consolidating.store(true, Ordering::Release);
         }
 
-        let new_index = Self::new_detached(
-            self.dimension,
-            self.metric,
-            self.max_degree,
-            self.build_complexity,
-            self.alpha,
-        );
+        // An entry point still deleted has no live node to hand over to; it is repaired
+        // too, since every search starts there
+        let entry_points = self.provider.get_entry_points();
+        let live = |id: u32| !self.provider.is_deleted(id) || entry_points.contains(&id);
 
-        for vec in &vectors {
-            new_index.add(vec)?;
+        let end = self.provider.len() as u32;
+        let stop = if max_nodes == 0 {
+            end
+        } else {
+            pass.cursor.saturating_add(max_nodes as u32).min(end)
+        };
+        let mut ids: Vec<u32> = (pass.cursor..stop).filter(|&id| live(id)).collect();
+        let finishing = stop >= end;
+        if finishing {
+            let visited_before = pass.cursor;
+            let revisit = std::mem::take(&mut pass.revisit);
+            ids.extend(
+                revisit
+                    .into_iter()
+                    .filter(|&id| id < visited_before && live(id)),
+            );
+        }
+        drop(pass);
+        self.repair_unlocked(&index, &ids, scheduler)?;
+
+        let mut pass = self.consolidation.lock();
+        pass.cursor = stop;
+        let mut progress = ConsolidateProgress {
+            visited: ids.len() as u64,
+            remaining: (end - stop) as u64,
+            ..Default::default()
+        };
+        if finishing {
+            // Nodes inserted while the last slice ran may link to the tombstones as well
+            loop {
+                let revisit: Vec<u32> = std::mem::take(&mut pass.revisit)
+                    .into_iter()
+                    .filter(|&id| live(id))
+                    .collect();
+                if revisit.is_empty() {
+                    break;
+                }
+                drop(pass);
+                self.repair_unlocked(&index, &revisit, scheduler)?;
+                progress.visited += revisit.len() as u64;
+                pass = self.consolidation.lock();
+            }
+            // Nothing links to the pending tombstones any more: drop their
+            // out-edges too and hand the slots to future inserts
+            let pending = std::mem::take(&mut pass.pending);
+            for &id in &pending {
+                self.provider.drop_adjacency(id);
+            }
+            progress.freed = pending.len() as u64;
+            self.free_slots.lock().extend(pending);
+            pass.active = false;
+            self.consolidating.store(false, Ordering::Release);
+            progress.done = true;
         }
+        Ok(progress)
+    }
 
-        Ok((new_index, label_map))
+    /// Repair `ids` without holding the pass state. If the repair fails they are queued
+    /// for the next slice again, since the cursor only advances on success.
+    fn repair_unlocked(&self, index: &Arc<DiskANNIndex<Provider>>, ids: &[u32], scheduler: &Scheduler) -> Result<()> {
+        Self::consolidate_nodes(index, ids, scheduler).map_err(|e| {
+            self.consolidation.lock().revisit.extend_from_slice(ids);
+            e
+        })
+    }
+
+    /// Replace edges to deleted nodes in the adjacency lists of `ids`, spread
+    /// over `scheduler` in tasks of `CONSOLIDATE_TASK_NODES`.
+    fn consolidate_nodes(index: &Arc<DiskANNIndex<Provider>>, ids: &[u32], scheduler: &Scheduler) -> Result<()> {
+        let chunks: Vec<&[u32]> = ids.chunks(CONSOLIDATE_TASK_NODES).collect();
+        scheduler.for_each(chunks.len(), |t| {
+            let strategy = FullPrecisionStrategy::new();
+            let ctx = DefaultContext;
+            for &id in chunks[t] {
+                runtime::run(index.consolidate_vector(&strategy, &ctx, id))
+                    .map_err(|e| anyhow!("DiskANN consolidate error: {}", e))?;
+            }
+            Ok(())
+        })
+    }
+
+    /// Recycled label slots awaiting reuse (for persistence).
+    pub fn free_slots(&self) -> Vec<u32> {
+        self.free_slots.lock().clone()
+    }
+
+    /// Restore the recycled slot list (after load). Slots stay tombstoned until reused.
+    pub fn set_free_slots(&self, slots: Vec<u32>) {
+        *self.free_slots.lock() = slots;
+    }
+
+    /// Merge `other` into this index without re-inserting its vectors: its nodes are
+    /// appended with their edges (other label l becomes the returned offset + l) and
+    /// the two graphs are stitched together with cross edges (see `graph_merge`).
+    /// Tombstones and recycled slots of `other` carry over. Neither index may be
+    /// modified meanwhile.
+    pub fn merge_from(&self, other: &InMemoryIndex, scheduler: &Scheduler) -> Result<u32> {
+        if other.dimension != self.dimension || other.metric != self.metric || other.max_degree != self.max_degree {
+            return Err(anyhow!(
+                "Cannot merge an index (dim {}, R {}, {}) into one with dim {}, R {}, {}",
+                other.dimension,
+                other.max_degree,
+                other.metric,
+                self.dimension,
+                self.max_degree,
+                self.metric
+            ));
+        }
+        let n = other.len();
+        if n == 0 {
+            return Ok(self.next_label.load(Ordering::Relaxed) as u32);
+        }
+        let offset = self.next_label.fetch_add(n as u64, Ordering::Relaxed) as u32;
+        let copied = CopiedGraph::load(other, offset)?;
+
+        let graph = self.index.read().as_ref().cloned();
+        let stitched = match graph {
+            Some(_) => graph_merge::stitch(self, other, &copied, scheduler)?,
+            // Nothing to stitch into: the other graph becomes this one
+            None => StitchedEdges {
+                appended: copied.adjacency.clone(),
+                target: Vec::new(),
+            },
+        };
+
+        // Appended nodes first: the target's new lists point at them
+        let chunks: Vec<usize> = (0..copied.len()).step_by(INSERT_TASK_VECTORS).collect();
+        scheduler.for_each(chunks.len(), |t| {
+            for local in chunks[t]..(chunks[t] + INSERT_TASK_VECTORS).min(copied.len()) {
+                self.provider
+                    .write_node(offset + local as u32, copied.vector(local), &stitched.appended[local]);
+            }
+            Ok(())
+        })?;
+        for (id, neighbors) in &stitched.target {
+            self.provider.replace_neighbors(*id, neighbors);
+        }
+
+        let deleted: Vec<u32> = other.provider.deleted_ids().iter().map(|&id| id + offset).collect();
+        self.provider.mark_deleted(&deleted);
+        self.free_slots
+            .lock()
+            .extend(other.free_slots().into_iter().map(|id| id + offset));
+
+        // Searches start from both graphs' entry points: the stitch alone may leave the far
+        // side of the other graph several hops from the target's. Many merges stop adding
+        // once the set is full, so a search's starting cost stays bounded
+        let mut entry_points = if graph.is_some() { self.get_entry_points() } else { Vec::new() };
+        for id in other.get_entry_points().iter().map(|&id| id + offset) {
+            if graph.is_some() && entry_points.len() >= graph_merge::MAX_ENTRY_POINTS {
+                break;
+            }
+            if !entry_points.contains(&id) {
+                entry_points.push(id);
+            }
+        }
+        self.provider.set_entry_points(entry_points);
+        if graph.is_none() {
+            let config = build_config(self.metric, self.max_degree, self.build_complexity, self.alpha)?;
+            *self.index.write() = Some(Arc::new(DiskANNIndex::new(config, self.provider.clone(), None)));
+        }
+
+        let mut touched: Vec<u32> = (offset..offset + n as u32).collect();
+        touched.extend(stitched.target.iter().map(|(id, _)| *id));
+        self.note_inserted(&touched);
+        Ok(offset)
+    }
+
+    /// The node store, for merges that work on it directly.
+    pub(crate) fn provider(&self) -> &Provider {
+        &self.provider
     }
 
     /// Get a copy of a vector by label.
@@ -736,6 +1390,47 @@ impl InMemoryIndex {
         self.provider.is_quantized()
     }
 
+    /// Train PQ (`m` subspaces, 0 = auto; `2^bits` centroids) and switch searches
+    /// to ADC traversal with full-precision re-ranking. Training runs on `scheduler`.
+    pub fn quantize_pq(&self, m: usize, bits: u32, scheduler: &Scheduler) -> Result<()> {
+        self.provider.quantize_pq(m, bits, scheduler)
+    }
+
+    /// Check if PQ is active.
+    pub fn is_pq(&self) -> bool {
+        self.provider.is_pq()
+    }
+
+    /// Keep every vector at half width only: searches and graph updates read those copies.
+    pub fn quantize_half(&self, format: crate::half_precision::HalfFormat) -> Result<()> {
+        self.provider.quantize_half(format)
+    }
+
+    /// Set the re-rank depth of quantized searches (0 = 4 * k).
+    pub fn set_rerank(&self, rerank: u32) {
+        self.rerank.store(rerank, Ordering::Relaxed);
+    }
+
+    fn rerank_depth(&self, k: usize) -> usize {
+        match self.rerank.load(Ordering::Relaxed) {
+            0 => k.saturating_mul(4),
+            r => r as usize,
+        }
+    }
+
+    /// Tombstoned nodes keep their place in the beam (they route the search), so
+    /// widen it by the inverse live fraction to keep about `l_search` live candidates.
+    /// Freed slots are unlinked from the graph and do not count.
+    fn live_l_search(&self, l_search: usize) -> usize {
+        let freed = self.free_slots.lock().len();
+        let n = self.provider.len().saturating_sub(freed);
+        let deleted = self.provider.deleted_count().saturating_sub(freed);
+        if deleted == 0 || deleted >= n {
+            return l_search;
+        }
+        (l_search.saturating_mul(n) / (n - deleted)).clamp(l_search, n.max(l_search))
+    }
+
     fn single_vector_distance(&self, query: &[f32]) -> f32 {
         let term = self.provider.get_vector(0);
         match term {
@@ -845,24 +1540,25 @@ pub fn save_index(name: &str, path: &str) -> Result<()> {
     let idx = get_index(name)?;
     match idx.as_ref() {
         ManagedIndex::InMemory(mem) => {
+            use std::io::Write;
             let file = std::fs::File::create(path)
                 .map_err(|e| anyhow!("Failed to create file '{}': {}", path, e))?;
             let mut writer = BufWriter::new(file);
-            file_format::write_index(&mut writer, &mem.provider, mem.metric, mem.build_complexity)
-                .map_err(|e| anyhow!("Failed to write index: {}", e))?;
-            Ok(())
+            mem.write_disk_file(&mut writer)?;
+            writer.flush().map_err(|e| anyhow!("Failed to write index: {}", e))
         }
         ManagedIndex::Disk(_) => Err(anyhow!("Cannot save a disk-backed index (already on disk)")),
     }
 }
 
-/// Load a .diskann file as a read-only disk-backed index.
-pub fn load_index(name: &str, path: &str, build_complexity: u32) -> Result<()> {
+/// Load a .diskann file as a read-only disk-backed index, pinning `cache_nodes` hot nodes
+/// in memory (`None` = the default cache budget).
+pub fn load_index(name: &str, path: &str, build_complexity: u32, cache_nodes: Option<usize>) -> Result<()> {
     if INDEXES.contains_key(name) {
         return Err(anyhow!("Index '{}' already exists", name));
     }
 
-    let provider = DiskProvider::open(Path::new(path))
+    let provider = DiskProvider::open(Path::new(path), cache_nodes)
         .map_err(|e| anyhow!("Failed to open '{}': {}", path, e))?;
 
     let bc = if build_complexity > 0 {
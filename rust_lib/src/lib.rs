@@ -1,9 +1,14 @@
+pub mod disk_merge;
 pub mod disk_provider;
 pub mod distance;
 pub mod ffi;
 pub mod file_format;
+pub mod graph_merge;
+pub mod half_precision;
 pub mod index_manager;
 pub mod metal_ffi;
+pub mod pq;
 pub mod provider;
 pub mod runtime;
+pub mod search_stats;
 pub mod streaming_build;
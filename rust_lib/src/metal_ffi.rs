@@ -5,6 +5,8 @@
 //! Symbols are resolved at link time when the Rust static lib is linked
 //! with the C++ extension.
 
+use std::ffi::c_void;
+use std::ptr::NonNull;
 use std::sync::atomic::{AtomicI32, Ordering};
 
 extern "C" {
@@ -27,6 +29,24 @@ extern "C" {
         metric: i32,
         out_distances: *mut f32,
     ) -> i32;
+    fn diskann_metal_resident_create(vectors: *const f32, n: u32, dim: i32) -> *mut c_void;
+    fn diskann_metal_resident_write(
+        resident: *mut c_void,
+        vectors: *const f32,
+        first: u32,
+        n: u32,
+    ) -> i32;
+    fn diskann_metal_resident_free(resident: *mut c_void);
+    fn diskann_metal_resident_multi_batch_distances(
+        resident: *mut c_void,
+        queries: *const f32,
+        ids: *const u32,
+        query_map: *const u32,
+        total_n: i32,
+        nq: i32,
+        metric: i32,
+        out_distances: *mut f32,
+    ) -> i32;
 }
 
 /// Cached Metal availability: -1=unchecked, 0=unavailable, 1=available
@@ -40,6 +60,11 @@ static METAL_STATUS: AtomicI32 = AtomicI32::new(-1);
 /// multi-query batching (Phase 1) aggregates enough work to trigger GPU.
 pub const MIN_GPU_WORK: usize = 131072;
 
+/// Minimum n*dim product for a lock-step iteration against resident vectors.
+/// Only the neighbour ids go up (4 bytes per candidate instead of 4*dim), so
+/// what is left is the command buffer round trip: break-even ~32K elements.
+pub const MIN_GPU_WORK_RESIDENT: usize = 32768;
+
 /// Lower threshold for one-shot batch distance (no iterative overhead).
 /// Used by vector_distances() where a single GPU dispatch computes all distances.
 /// At 768-dim: fires at ~64 candidates (49152/768=64).
@@ -139,3 +164,107 @@ pub fn metal_multi_batch_distances(
     };
     ret == 0
 }
+
+/// Copy of an index's vectors in a shared Metal buffer.
+///
+/// Lock-step batch search scores neighbours by id against this copy, so an
+/// iteration uploads `total_n` ids rather than gathering `total_n * dim` floats.
+/// The owner keeps it in sync through `write` (rows may be appended past `rows()`).
+/// Not safe for concurrent use: callers serialize access (the Metal bridge shares
+/// one command queue and buffer ring).
+#[derive(Debug)]
+pub struct ResidentVectors {
+    ptr: NonNull<c_void>,
+    rows: u32,
+    dim: usize,
+}
+
+// The handle is only touched behind the owner's lock
+unsafe impl Send for ResidentVectors {}
+
+impl ResidentVectors {
+    /// Upload `vectors` (`rows * dim` floats). None if Metal is unavailable or
+    /// the buffer cannot be allocated.
+    pub fn create(vectors: &[f32], dim: usize) -> Option<Self> {
+        if dim == 0 || !is_metal_available() {
+            return None;
+        }
+        let rows = (vectors.len() / dim) as u32;
+        let ptr = unsafe { diskann_metal_resident_create(vectors.as_ptr(), rows, dim as i32) };
+        NonNull::new(ptr).map(|ptr| ResidentVectors { ptr, rows, dim })
+    }
+
+    /// Rows held by the buffer.
+    pub fn rows(&self) -> u32 {
+        self.rows
+    }
+
+    /// Bytes held on the device (the buffer is rounded up to a power of two).
+    pub fn bytes(&self) -> usize {
+        (self.rows as usize * self.dim * std::mem::size_of::<f32>())
+            .next_power_of_two()
+            .max(4096)
+    }
+
+    /// Overwrite rows [first, first + n) with `vectors` (`n * dim` floats),
+    /// growing the buffer when they extend past the end. `first` must not be
+    /// past `rows()`. On failure the contents are unspecified: drop the copy.
+    pub fn write(&mut self, first: u32, vectors: &[f32]) -> bool {
+        let n = (vectors.len() / self.dim) as u32;
+        if n == 0 {
+            return true;
+        }
+        debug_assert!(first <= self.rows);
+        let ret =
+            unsafe { diskann_metal_resident_write(self.ptr.as_ptr(), vectors.as_ptr(), first, n) };
+        if ret != 0 {
+            return false;
+        }
+        self.rows = self.rows.max(first + n);
+        true
+    }
+
+    /// Multi-query batch distances against resident rows.
+    ///
+    /// `ids`: total_n row ids (all < `rows()`), `query_map`: query index per id,
+    /// `queries`: nq * dim floats, `out`: total_n distances.
+    /// Returns false if the dispatch fails (the caller falls back to the CPU).
+    pub fn multi_batch_distances(
+        &self,
+        queries: &[f32],
+        ids: &[u32],
+        query_map: &[u32],
+        nq: usize,
+        metric: u8,
+        out: &mut [f32],
+    ) -> bool {
+        let total_n = ids.len();
+        if total_n == 0 || nq == 0 {
+            return true;
+        }
+        debug_assert_eq!(queries.len(), nq * self.dim);
+        debug_assert_eq!(query_map.len(), total_n);
+        debug_assert!(out.len() >= total_n);
+        debug_assert!(ids.iter().all(|&id| id < self.rows));
+
+        let ret = unsafe {
+            diskann_metal_resident_multi_batch_distances(
+                self.ptr.as_ptr(),
+                queries.as_ptr(),
+                ids.as_ptr(),
+                query_map.as_ptr(),
+                total_n as i32,
+                nq as i32,
+                metric as i32,
+                out.as_mut_ptr(),
+            )
+        };
+        ret == 0
+    }
+}
+
+impl Drop for ResidentVectors {
+    fn drop(&mut self) {
+        unsafe { diskann_metal_resident_free(self.ptr.as_ptr()) };
+    }
+}
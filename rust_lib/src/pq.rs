@@ -0,0 +1,295 @@
+//! Product quantization for the in-memory DiskANN provider.
+//!
+//! A vector is split into `m` contiguous subspaces of `dim / m` dimensions; each
+//! subspace is replaced by the index of its nearest of `2^bits` trained centroids.
+//! Codes are bit-packed (`m * bits` bits per vector). Search builds one
+//! `m x 2^bits` distance table per query and scores a code with `m` lookups (ADC).
+//!
+//! Serialized codebook layout (little-endian):
+//!   dim: u32, m: u32, bits: u32, centroids: f32 * m * 2^bits * (dim / m)
+
+use anyhow::{anyhow, Result};
+use parking_lot::Mutex;
+
+use crate::index_manager::Metric;
+use crate::runtime::Scheduler;
+
+/// k-means iterations per subspace during training.
+const TRAIN_ITERS: usize = 12;
+/// Training points per centroid (FAISS warns below ~39).
+const TRAIN_POINTS_PER_CENTROID: usize = 64;
+
+#[derive(Debug, Clone)]
+pub struct PqCodebook {
+    dim: usize,
+    m: usize,
+    bits: u32,
+    /// [subspace][centroid][dsub]
+    centroids: Vec<f32>,
+}
+
+impl PqCodebook {
+    /// Subspace count for `dim` when none was requested: the largest divisor of
+    /// `dim` that is at most `dim / 4` (about 4 dims per code).
+    pub fn default_subspaces(dim: usize) -> usize {
+        let target = (dim / 4).max(1);
+        (1..=target).rev().find(|m| dim % m == 0).unwrap_or(1)
+    }
+
+    /// Train on `n` row-major vectors (sampled down to what k-means needs), one
+    /// subspace per task on `scheduler`.
+    pub fn train(
+        vectors: &[f32],
+        n: usize,
+        dim: usize,
+        m: usize,
+        bits: u32,
+        scheduler: &Scheduler,
+    ) -> Result<Self> {
+        if m == 0 || dim % m != 0 {
+            return Err(anyhow!(
+                "pq_subspaces ({}) must divide the vector dimension ({})",
+                m,
+                dim
+            ));
+        }
+        if !(1..=8).contains(&bits) {
+            return Err(anyhow!("pq_bits must be between 1 and 8, got {}", bits));
+        }
+        let ksub = 1usize << bits;
+        if n < ksub {
+            return Err(anyhow!(
+                "PQ training needs at least {} vectors, have {}",
+                ksub,
+                n
+            ));
+        }
+
+        // Deterministic strided sample
+        let sample_n = n.min(ksub * TRAIN_POINTS_PER_CENTROID);
+        let stride = n as f64 / sample_n as f64;
+        let sample: Vec<usize> = (0..sample_n).map(|i| (i as f64 * stride) as usize).collect();
+
+        // One k-means per subspace, each a task on the scheduler
+        let dsub = dim / m;
+        let trained: Vec<Mutex<Vec<f32>>> = (0..m).map(|_| Mutex::new(Vec::new())).collect();
+        scheduler.for_each(m, |s| {
+            let points: Vec<f32> = sample
+                .iter()
+                .flat_map(|&row| {
+                    let off = row * dim + s * dsub;
+                    vectors[off..off + dsub].iter().copied()
+                })
+                .collect();
+            let mut sub_centroids = vec![0.0f32; ksub * dsub];
+            kmeans(&points, dsub, ksub, &mut sub_centroids);
+            *trained[s].lock() = sub_centroids;
+            Ok(())
+        })?;
+        let centroids: Vec<f32> = trained.into_iter().flat_map(|c| c.into_inner()).collect();
+
+        Ok(Self {
+            dim,
+            m,
+            bits,
+            centroids,
+        })
+    }
+
+    pub fn dim(&self) -> usize {
+        self.dim
+    }
+
+    pub fn subspaces(&self) -> usize {
+        self.m
+    }
+
+    pub fn bits(&self) -> u32 {
+        self.bits
+    }
+
+    /// Bytes per encoded vector.
+    pub fn code_size(&self) -> usize {
+        (self.m * self.bits as usize).div_ceil(8)
+    }
+
+    fn ksub(&self) -> usize {
+        1 << self.bits
+    }
+
+    fn dsub(&self) -> usize {
+        self.dim / self.m
+    }
+
+    /// Encode one vector into `out` (`code_size` bytes).
+    pub fn encode(&self, v: &[f32], out: &mut [u8]) {
+        let ksub = self.ksub();
+        let dsub = self.dsub();
+        out.fill(0);
+        for s in 0..self.m {
+            let x = &v[s * dsub..(s + 1) * dsub];
+            let base = &self.centroids[s * ksub * dsub..(s + 1) * ksub * dsub];
+            let c = nearest(x, base, dsub);
+            self.put(out, s, c as u8);
+        }
+    }
+
+    /// Per-query lookup table: `table[s * ksub + c]` is the distance contribution
+    /// of centroid `c` in subspace `s` (same semantics as `compute_distance`).
+    pub fn distance_table(&self, query: &[f32], metric: Metric, table: &mut Vec<f32>) {
+        let ksub = self.ksub();
+        let dsub = self.dsub();
+        table.clear();
+        table.reserve(self.m * ksub);
+        for s in 0..self.m {
+            let q = &query[s * dsub..(s + 1) * dsub];
+            for c in 0..ksub {
+                let cent = &self.centroids[(s * ksub + c) * dsub..(s * ksub + c + 1) * dsub];
+                table.push(crate::distance::compute_distance(metric, q, cent));
+            }
+        }
+    }
+
+    /// Asymmetric distance of a code against a query's table.
+    #[inline]
+    pub fn adc(&self, table: &[f32], code: &[u8]) -> f32 {
+        let ksub = self.ksub();
+        match self.bits {
+            8 => code
+                .iter()
+                .take(self.m)
+                .enumerate()
+                .map(|(s, &c)| table[s * ksub + c as usize])
+                .sum(),
+            _ => (0..self.m)
+                .map(|s| table[s * ksub + self.get(code, s) as usize])
+                .sum(),
+        }
+    }
+
+    #[inline]
+    fn get(&self, code: &[u8], s: usize) -> u32 {
+        let bits = self.bits as usize;
+        let bit = s * bits;
+        let byte = bit / 8;
+        let shift = bit % 8;
+        let mut word = code[byte] as u32;
+        if shift + bits > 8 {
+            word |= (code[byte + 1] as u32) << 8;
+        }
+        (word >> shift) & ((1 << bits) - 1)
+    }
+
+    #[inline]
+    fn put(&self, code: &mut [u8], s: usize, c: u8) {
+        let bits = self.bits as usize;
+        let bit = s * bits;
+        let byte = bit / 8;
+        let shift = bit % 8;
+        let word = (c as u32) << shift;
+        code[byte] |= word as u8;
+        if shift + bits > 8 {
+            code[byte + 1] |= (word >> 8) as u8;
+        }
+    }
+
+    pub fn to_bytes(&self) -> Vec<u8> {
+        let mut out = Vec::with_capacity(12 + self.centroids.len() * 4);
+        out.extend_from_slice(&(self.dim as u32).to_le_bytes());
+        out.extend_from_slice(&(self.m as u32).to_le_bytes());
+        out.extend_from_slice(&self.bits.to_le_bytes());
+        for v in &self.centroids {
+            out.extend_from_slice(&v.to_le_bytes());
+        }
+        out
+    }
+
+    pub fn from_bytes(data: &[u8]) -> Result<Self> {
+        let u32_at = |off: usize| -> Result<u32> {
+            data.get(off..off + 4)
+                .map(|b| u32::from_le_bytes([b[0], b[1], b[2], b[3]]))
+                .ok_or_else(|| anyhow!("PQ codebook truncated"))
+        };
+        let dim = u32_at(0)? as usize;
+        let m = u32_at(4)? as usize;
+        let bits = u32_at(8)?;
+        if m == 0 || dim % m != 0 || !(1..=8).contains(&bits) {
+            return Err(anyhow!("Invalid PQ codebook (dim {}, m {}, bits {})", dim, m, bits));
+        }
+        let len = m * (1usize << bits) * (dim / m);
+        let body = data
+            .get(12..12 + len * 4)
+            .ok_or_else(|| anyhow!("PQ codebook truncated"))?;
+        let centroids = body
+            .chunks_exact(4)
+            .map(|b| f32::from_le_bytes([b[0], b[1], b[2], b[3]]))
+            .collect();
+        Ok(Self {
+            dim,
+            m,
+            bits,
+            centroids,
+        })
+    }
+}
+
+/// Index of the centroid in `base` (k x dsub) nearest to `x` (squared L2).
+#[inline]
+fn nearest(x: &[f32], base: &[f32], dsub: usize) -> usize {
+    let mut best = 0;
+    let mut best_d = f32::MAX;
+    for (c, cent) in base.chunks_exact(dsub).enumerate() {
+        let d = crate::distance::compute_distance(Metric::L2, x, cent);
+        if d < best_d {
+            best_d = d;
+            best = c;
+        }
+    }
+    best
+}
+
+/// Lloyd's k-means on `points` (n x dsub) into `out` (k x dsub). Centroids start
+/// on evenly spaced points; empty clusters are re-seeded from the largest one.
+fn kmeans(points: &[f32], dsub: usize, k: usize, out: &mut [f32]) {
+    let n = points.len() / dsub;
+    for c in 0..k {
+        let row = c * n / k;
+        out[c * dsub..(c + 1) * dsub].copy_from_slice(&points[row * dsub..(row + 1) * dsub]);
+    }
+
+    let mut assign = vec![0usize; n];
+    let mut sums = vec![0.0f32; k * dsub];
+    let mut counts = vec![0usize; k];
+    for _ in 0..TRAIN_ITERS {
+        for (i, p) in points.chunks_exact(dsub).enumerate() {
+            assign[i] = nearest(p, out, dsub);
+        }
+
+        sums.fill(0.0);
+        counts.fill(0);
+        for (i, p) in points.chunks_exact(dsub).enumerate() {
+            let c = assign[i];
+            counts[c] += 1;
+            for (acc, &v) in sums[c * dsub..(c + 1) * dsub].iter_mut().zip(p) {
+                *acc += v;
+            }
+        }
+
+        for c in 0..k {
+            if counts[c] > 0 {
+                let inv = 1.0 / counts[c] as f32;
+                for d in 0..dsub {
+                    out[c * dsub + d] = sums[c * dsub + d] * inv;
+                }
+                continue;
+            }
+            // Split the largest cluster: nudge a copy of its centroid
+            let big = (0..k).max_by_key(|&j| counts[j]).unwrap_or(0);
+            for d in 0..dsub {
+                let v = out[big * dsub + d];
+                out[c * dsub + d] = v + if d % 2 == 0 { 1e-4 } else { -1e-4 } * (1.0 + v.abs());
+            }
+            counts[big] /= 2;
+        }
+    }
+}
@@ -3,25 +3,42 @@
 //! Uses flat contiguous vector storage for cache-friendly memory layout.
 //! Adjacency lists are stored in a DashMap for concurrent insert safety.
 
+use std::ffi::c_void;
 use std::io::Write;
+use std::ptr;
 use std::sync::Arc;
-use std::sync::atomic::{AtomicU32, Ordering};
+use std::sync::atomic::{AtomicBool, AtomicU32, AtomicU64, AtomicUsize, Ordering};
 
-use dashmap::DashMap;
+use dashmap::{DashMap, DashSet};
 use diskann::{
     ANNError, ANNResult,
     error::Infallible,
-    graph::{AdjacencyList, glue},
+    graph::{AdjacencyList, SearchOutputBuffer, glue},
+    neighbor::Neighbor,
     provider,
     utils::VectorRepr,
 };
 use diskann_vector::distance::Metric;
-use parking_lot::RwLock;
+use parking_lot::{Mutex, RwLock, RwLockReadGuard};
+
+use crate::half_precision::HalfFormat;
+use crate::metal_ffi::{MIN_GPU_WORK, MIN_GPU_WORK_RESIDENT, ResidentVectors};
+use crate::pq::PqCodebook;
+use crate::runtime::Scheduler;
+use crate::search_stats::{SearchStats, SearchTally};
 
 // ==================
 // Storage
 // ==================
 
+/// Nodes per storage page. Vectors and adjacency are persisted page by page so a
+/// checkpoint only rewrites the pages that changed.
+pub const PAGE_NODES: u32 = 4096;
+
+/// Prefix of the error an operation returns when a page it touched could not be
+/// loaded; the host raises those as I/O errors.
+pub const PAGE_LOAD_ERROR: &str = "page load failed: ";
+
 /// SQ8 quantization parameters: per-dimension min and scale.
 /// Dequantize: val = (quantized / 255.0) * scale + min
 #[derive(Debug, Clone)]
@@ -37,12 +54,100 @@ struct QuantizedStorage {
     params: SQ8Params,
 }
 
+impl QuantizedStorage {
+    /// Encode vector `id` (values outside the trained range are clamped).
+    fn encode(&mut self, id: u32, v: &[f32]) {
+        let dim = self.params.min.len();
+        let offset = id as usize * dim;
+        if self.data.len() < offset + dim {
+            self.data.resize(offset + dim, 0);
+        }
+        for d in 0..dim {
+            let normalized = (v[d] - self.params.min[d]) / self.params.scale[d];
+            self.data[offset + d] = (normalized * 255.0).round().clamp(0.0, 255.0) as u8;
+        }
+    }
+}
+
+/// Product-quantized codes: drive graph traversal (ADC) when present, with
+/// full-precision vectors only read back to re-rank the best candidates.
+#[derive(Debug)]
+struct PqStorage {
+    codebook: PqCodebook,
+    codes: Vec<u8>, // [id * code_size .. (id+1) * code_size]
+}
+
+/// Half-width vectors (`precision = 'f16' | 'bf16'`): the index's only copy of every
+/// vector once enabled. Traversal scores them directly, and every read of a vector
+/// (graph build and prune, exports, merges) decodes them.
+#[derive(Debug)]
+struct HalfStorage {
+    format: HalfFormat,
+    data: Vec<u16>, // [id * dim .. (id+1) * dim]
+}
+
+impl HalfStorage {
+    fn encode(&mut self, id: u32, v: &[f32]) {
+        let dim = v.len();
+        let offset = id as usize * dim;
+        if self.data.len() < offset + dim {
+            self.data.resize(offset + dim, 0);
+        }
+        self.format.encode(v, &mut self.data[offset..offset + dim]);
+    }
+
+    /// Widen nodes [start, start + n) into `out` (n * dim floats); false if any is missing.
+    fn decode(&self, start: u32, dim: usize, out: &mut [f32]) -> bool {
+        let begin = start as usize * dim;
+        match self.data.get(begin..begin + out.len()) {
+            Some(codes) => {
+                self.format.decode(codes, out);
+                true
+            }
+            None => false,
+        }
+    }
+}
+
+/// Page fault callback: fill nodes [start, start + count) with their vectors
+/// (count * dim floats) and padded adjacency (count * max_degree u32s). The range
+/// never crosses a page; either output may be null when that part is not needed.
+/// Returns 0 on success.
+pub type PageLoader = unsafe extern "C" fn(
+    ctx: *mut c_void,
+    start: u32,
+    count: u32,
+    out_vectors: *mut f32,
+    out_adjacency: *mut u32,
+) -> i32;
+
+/// Demand pager for an index opened from paged storage: pages stay on disk
+/// (in the host's buffer-managed blocks) until a node on them is first touched.
+#[derive(Debug)]
+struct Pager {
+    load: PageLoader,
+    /// Host context passed back to `load` (owned by the host, outlives the index)
+    ctx: usize,
+    /// Nodes that were persisted when the pager was attached
+    num_vectors: u32,
+    page_count: u32,
+    /// Vectors and adjacency of the page are in memory
+    resident: Vec<AtomicBool>,
+    /// Adjacency of the page is in memory (PQ traversal does not need the vectors)
+    adjacency_resident: Vec<AtomicBool>,
+    resident_pages: AtomicU32,
+    /// Serializes faults (the host's block storage is not reentrant)
+    fault_lock: Mutex<()>,
+}
+
 #[derive(Debug)]
 struct Inner {
     /// Flat contiguous vector storage: [id*dim .. (id+1)*dim]
     vectors: RwLock<Vec<f32>>,
     /// Per-node adjacency lists (concurrent-safe for graph build)
     adjacency: DashMap<u32, AdjacencyList<u32>>,
+    /// Neighbour ids held by `adjacency` (its lists' actual degree, for memory accounting)
+    adjacency_edges: AtomicUsize,
     count: AtomicU32,
     start_point_ids: RwLock<Vec<u32>>,
     #[allow(dead_code)]
@@ -51,23 +156,509 @@ struct Inner {
     metric: Metric,
     /// Optional SQ8 quantized storage (set after bulk build)
     quantized: RwLock<Option<QuantizedStorage>>,
+    /// Optional PQ codes (set after bulk build)
+    pq: RwLock<Option<PqStorage>>,
+    /// Optional half-width vectors (set when the index is created with a precision)
+    half: RwLock<Option<HalfStorage>>,
+    /// Pages (id / PAGE_NODES) whose adjacency changed since the last take_dirty_adjacency_pages
+    dirty_adjacency_pages: DashSet<u32>,
+    /// Pages whose vectors were written since the last take_dirty_vector_pages
+    /// (appends and recycled slots)
+    dirty_vector_pages: DashSet<u32>,
+    /// Set when the index was opened lazily; None = everything resident
+    pager: RwLock<Option<Arc<Pager>>>,
+    /// Fast path for `ensure_resident`: no page is left on disk
+    fully_resident: AtomicBool,
+    /// Quantized index after a checkpoint: full-precision vectors live in storage,
+    /// traversal runs on the codes and only re-ranking reads vectors back
+    vectors_evicted: AtomicBool,
+    /// Vectors written since the last eviction (not in storage yet)
+    pending_vectors: DashMap<u32, Box<[f32]>>,
+    /// Deleted labels (bit `id % 64` of word `id / 64`): still routed through, never returned
+    tombstones: RwLock<Vec<u64>>,
+    num_tombstones: AtomicU32,
+    /// Search counters for ann_index_stats()
+    stats: SearchStats,
+    /// Pages (or re-ranked vectors) read back from storage through the pager
+    page_loads: AtomicU64,
+    /// Loads the host's loader failed, and the last such failure. The graph code reads
+    /// nodes on such a page as missing; the operation that hit one reports it afterwards.
+    load_failures: AtomicU64,
+    load_error: Mutex<String>,
+    /// Metal copy of `vectors` for lock-step batch search (made by the first batch large enough)
+    metal_vectors: Mutex<Option<ResidentVectors>>,
+    /// Set while `metal_vectors` exists: writers then record the ids they overwrite
+    metal_tracking: AtomicBool,
+    /// Ids written since the Metal copy was synced (rows past its end are appended anyway)
+    metal_stale: DashSet<u32>,
+}
+
+impl Inner {
+    #[inline]
+    fn mark_adjacency_dirty(&self, id: u32) {
+        self.dirty_adjacency_pages.insert(id / PAGE_NODES);
+    }
+
+    #[inline]
+    fn mark_vector_dirty(&self, id: u32) {
+        self.dirty_vector_pages.insert(id / PAGE_NODES);
+        if self.metal_tracking.load(Ordering::Relaxed) {
+            self.metal_stale.insert(id);
+        }
+    }
+
+    /// Drop the Metal copy of the vectors. Caller holds the vectors write lock.
+    fn drop_metal_vectors(&self) {
+        self.metal_tracking.store(false, Ordering::Relaxed);
+        *self.metal_vectors.lock() = None;
+        self.metal_stale.clear();
+    }
+
+    /// Bring the Metal copy of `vecs` up to date, uploading it on first use.
+    /// Caller holds the vectors read lock: writers (which mark ids under the
+    /// write lock) cannot run meanwhile. Returns false if the GPU cannot be used.
+    fn sync_metal_vectors(&self, vecs: &[f32]) -> bool {
+        let dim = self.dimension;
+        let rows = (vecs.len() / dim.max(1)) as u32;
+        let mut slot = self.metal_vectors.lock();
+        let synced = match slot.as_mut() {
+            None => {
+                // Set before the upload: writes after we release the read lock are tracked
+                self.metal_tracking.store(true, Ordering::Relaxed);
+                self.metal_stale.clear();
+                *slot = ResidentVectors::create(&vecs[..rows as usize * dim], dim);
+                slot.is_some()
+            }
+            Some(res) => {
+                let uploaded = res.rows().min(rows);
+                let mut ok = res.write(uploaded, &vecs[uploaded as usize * dim..rows as usize * dim]);
+                let stale: Vec<u32> = self.metal_stale.iter().map(|id| *id).filter(|&id| id < uploaded).collect();
+                self.metal_stale.clear();
+                for id in stale {
+                    let offset = id as usize * dim;
+                    ok = ok && res.write(id, &vecs[offset..offset + dim]);
+                }
+                ok
+            }
+        };
+        if !synced {
+            self.metal_tracking.store(false, Ordering::Relaxed);
+            *slot = None;
+        }
+        synced
+    }
+
+    /// A list went from `old` to `new` neighbours.
+    #[inline]
+    fn account_edges(&self, old: usize, new: usize) {
+        if new >= old {
+            self.adjacency_edges.fetch_add(new - old, Ordering::Relaxed);
+        } else {
+            self.adjacency_edges.fetch_sub(old - new, Ordering::Relaxed);
+        }
+    }
+
+    /// Insert or replace the out-edges of `id`.
+    fn put_adjacency(&self, id: u32, adj: AdjacencyList<u32>) {
+        let new = adj.len();
+        let old = self.adjacency.insert(id, adj).map_or(0, |old| old.len());
+        self.account_edges(old, new);
+    }
+
+    /// Replace the out-edges of `id` in place. Returns false if it has none.
+    fn set_adjacency(&self, id: u32, neighbors: &[u32], append: bool) -> bool {
+        match self.adjacency.get_mut(&id) {
+            Some(mut adj) => {
+                let old = adj.len();
+                if !append {
+                    adj.clear();
+                }
+                adj.extend_from_slice(neighbors);
+                self.account_edges(old, adj.len());
+                self.mark_adjacency_dirty(id);
+                true
+            }
+            None => false,
+        }
+    }
+
+    /// Fault in the page holding `id` if it is still on disk. Must not be called
+    /// while holding the vectors lock or an adjacency entry. Returns false if the
+    /// loader failed; the node then reads as missing.
+    #[inline]
+    fn ensure_resident(&self, id: u32) -> bool {
+        if self.fully_resident.load(Ordering::Acquire) {
+            return true;
+        }
+        let with_vectors = !self.vectors_evicted.load(Ordering::Acquire);
+        match self.pager.read().clone() {
+            Some(pager) => self.fault(&pager, id / PAGE_NODES, with_vectors),
+            None => true,
+        }
+    }
+
+    /// Like `ensure_resident`, but only the adjacency of the page is needed.
+    #[inline]
+    fn ensure_adjacency_resident(&self, id: u32) -> bool {
+        if self.fully_resident.load(Ordering::Acquire) {
+            return true;
+        }
+        match self.pager.read().clone() {
+            Some(pager) => self.fault(&pager, id / PAGE_NODES, false),
+            None => true,
+        }
+    }
+
+    fn ensure_resident_ids(&self, ids: &[u32]) -> bool {
+        let mut ok = true;
+        for &id in ids {
+            ok &= self.ensure_resident(id);
+        }
+        ok
+    }
+
+    fn ensure_resident_range(&self, start: u32, count: u32) -> bool {
+        if count == 0 {
+            return true;
+        }
+        let mut ok = true;
+        for page in start / PAGE_NODES..=(start + count - 1) / PAGE_NODES {
+            ok &= self.ensure_resident(page * PAGE_NODES);
+        }
+        ok
+    }
+
+    /// Fault in every page (bulk operations: serialize, quantize, lock-step batch search).
+    fn ensure_all_resident(&self) -> bool {
+        let page_count = match self.pager.read().as_ref() {
+            Some(pager) => pager.page_count,
+            None => return true,
+        };
+        self.ensure_resident_range(0, page_count.saturating_mul(PAGE_NODES))
+    }
+
+    fn fault(&self, pager: &Pager, page: u32, with_vectors: bool) -> bool {
+        let p = page as usize;
+        let loaded = |pager: &Pager| {
+            pager.resident[p].load(Ordering::Acquire)
+                || (!with_vectors && pager.adjacency_resident[p].load(Ordering::Acquire))
+        };
+        if page >= pager.page_count || loaded(pager) {
+            return true;
+        }
+        let _guard = pager.fault_lock.lock();
+        if loaded(pager) {
+            return true;
+        }
+
+        // Adjacency may already be in memory (and modified since): never reload it
+        let need_adjacency = !pager.adjacency_resident[p].load(Ordering::Acquire);
+        let start = page * PAGE_NODES;
+        let count = PAGE_NODES.min(pager.num_vectors - start);
+        let mut vectors = if with_vectors {
+            vec![0.0f32; count as usize * self.dimension]
+        } else {
+            Vec::new()
+        };
+        let mut adjacency = if need_adjacency {
+            vec![u32::MAX; count as usize * self.max_degree]
+        } else {
+            Vec::new()
+        };
+        let rc = unsafe {
+            (pager.load)(
+                pager.ctx as *mut c_void,
+                start,
+                count,
+                if with_vectors { vectors.as_mut_ptr() } else { ptr::null_mut() },
+                if need_adjacency { adjacency.as_mut_ptr() } else { ptr::null_mut() },
+            )
+        };
+        if rc != 0 {
+            self.record_load_failure(start, count, rc);
+            return false;
+        }
+        self.page_loads.fetch_add(1, Ordering::Relaxed);
+        if need_adjacency {
+            self.install_adjacency(start, &adjacency, self.max_degree);
+            pager.adjacency_resident[p].store(true, Ordering::Release);
+        }
+        if with_vectors {
+            self.install_vectors(start, &vectors);
+            pager.resident[p].store(true, Ordering::Release);
+            if pager.resident_pages.fetch_add(1, Ordering::AcqRel) + 1 == pager.page_count {
+                self.fully_resident.store(true, Ordering::Release);
+            }
+        }
+        true
+    }
+
+    #[cold]
+    fn record_load_failure(&self, start: u32, count: u32, rc: i32) {
+        *self.load_error.lock() = format!(
+            "nodes [{}, {}) could not be read from storage (loader returned {})",
+            start,
+            start + count,
+            rc
+        );
+        self.load_failures.fetch_add(1, Ordering::Release);
+    }
+
+    /// Copy vector `id` into `out` without making its page resident: straight
+    /// from storage if the page is still on disk (re-ranking quantized searches).
+    fn read_vector(&self, id: u32, out: &mut [f32]) -> bool {
+        let dim = self.dimension;
+        if self.vectors_evicted.load(Ordering::Acquire) {
+            if let Some(v) = self.pending_vectors.get(&id) {
+                out[..dim].copy_from_slice(&v);
+                return true;
+            }
+            return self.read_half(id, &mut out[..dim]) || self.read_stored(id, 1, out);
+        }
+        let on_disk = !self.fully_resident.load(Ordering::Acquire)
+            && self.pager.read().as_ref().is_some_and(|pager| {
+                id < pager.num_vectors && !pager.resident[(id / PAGE_NODES) as usize].load(Ordering::Acquire)
+            });
+        if on_disk {
+            return self.read_half(id, &mut out[..dim]) || self.read_stored(id, 1, out);
+        }
+        let vecs = self.vectors.read();
+        match Provider::vector_at(&vecs, dim, id) {
+            Some(v) => {
+                out[..dim].copy_from_slice(v);
+                true
+            }
+            None => false,
+        }
+    }
+
+    /// Widen the half-width copies of nodes [start, start + out.len() / dim) into `out`.
+    fn read_half(&self, start: u32, out: &mut [f32]) -> bool {
+        self.half.read().as_ref().is_some_and(|h| h.decode(start, self.dimension, out))
+    }
+
+    /// Read vectors [start, start + count) of one page from storage into `out`.
+    fn read_stored(&self, start: u32, count: u32, out: &mut [f32]) -> bool {
+        let Some(pager) = self.pager.read().clone() else {
+            return false;
+        };
+        if count == 0 || start + count > pager.num_vectors {
+            return false;
+        }
+        let _guard = pager.fault_lock.lock();
+        let rc = unsafe {
+            (pager.load)(pager.ctx as *mut c_void, start, count, out.as_mut_ptr(), ptr::null_mut())
+        };
+        if rc != 0 {
+            self.record_load_failure(start, count, rc);
+            return false;
+        }
+        self.page_loads.fetch_add(1, Ordering::Relaxed);
+        true
+    }
+
+    fn install_page(&self, start: u32, vectors: &[f32], adjacency: &[u32], max_degree: usize) {
+        let dim = self.dimension;
+        let n = (vectors.len() / dim.max(1)).min(adjacency.len() / max_degree.max(1));
+        if n == 0 {
+            return;
+        }
+        self.install_vectors(start, &vectors[..n * dim]);
+        self.install_adjacency(start, &adjacency[..n * max_degree], max_degree);
+    }
+
+    fn install_vectors(&self, start: u32, vectors: &[f32]) {
+        let dim = self.dimension;
+        let n = vectors.len() / dim.max(1);
+        if n == 0 {
+            return;
+        }
+        let mut vecs = self.vectors.write();
+        // A fault that raced with eviction: the vectors stay in storage
+        if self.vectors_evicted.load(Ordering::Acquire) {
+            return;
+        }
+        let offset = start as usize * dim;
+        if vecs.len() < offset + n * dim {
+            vecs.resize(offset + n * dim, 0.0);
+        }
+        vecs[offset..offset + n * dim].copy_from_slice(&vectors[..n * dim]);
+    }
+
+    fn install_adjacency(&self, start: u32, adjacency: &[u32], max_degree: usize) {
+        let n = adjacency.len() / max_degree.max(1);
+        for i in 0..n {
+            let row = &adjacency[i * max_degree..(i + 1) * max_degree];
+            let mut adj = AdjacencyList::new();
+            let m = row.iter().position(|&v| v == u32::MAX).unwrap_or(max_degree);
+            adj.extend_from_slice(&row[..m]);
+            self.put_adjacency(start + i as u32, adj);
+        }
+    }
+}
+
+/// Per-query distance to a node's SQ8, PQ or half-width code (in that order of preference).
+enum CodeScorer<'a> {
+    /// SQ8, with the dequantization folded into the query:
+    /// L2 = sum((shift[d] - step[d] * c[d])^2), IP = -(bias + sum(step[d] * c[d]))
+    Sq8 {
+        guard: RwLockReadGuard<'a, Option<QuantizedStorage>>,
+        shift: Vec<f32>,
+        step: Vec<f32>,
+        bias: f32,
+        metric: crate::index_manager::Metric,
+    },
+    Pq {
+        guard: RwLockReadGuard<'a, Option<PqStorage>>,
+        table: Vec<f32>,
+    },
+    Half {
+        guard: RwLockReadGuard<'a, Option<HalfStorage>>,
+        query: Vec<f32>,
+        metric: crate::index_manager::Metric,
+    },
+}
+
+impl<'a> CodeScorer<'a> {
+    fn new(inner: &'a Inner, query: &[f32], metric: crate::index_manager::Metric) -> Option<Self> {
+        use crate::index_manager::Metric as M;
+
+        let pq = inner.pq.read();
+        if let Some(storage) = pq.as_ref() {
+            let mut table = Vec::new();
+            storage.codebook.distance_table(query, metric, &mut table);
+            return Some(CodeScorer::Pq { guard: pq, table });
+        }
+        drop(pq);
+
+        let sq8 = inner.quantized.read();
+        if sq8.is_none() {
+            drop(sq8);
+            let half = inner.half.read();
+            half.as_ref()?;
+            return Some(CodeScorer::Half { guard: half, query: query.to_vec(), metric });
+        }
+        let (shift, step, bias) = {
+            let params = &sq8.as_ref()?.params;
+            let dim = params.min.len();
+            match metric {
+                M::L2 => (
+                    (0..dim).map(|d| query[d] - params.min[d]).collect(),
+                    (0..dim).map(|d| params.scale[d] / 255.0).collect(),
+                    0.0,
+                ),
+                M::InnerProduct => (
+                    Vec::new(),
+                    (0..dim).map(|d| query[d] * params.scale[d] / 255.0).collect(),
+                    (0..dim).map(|d| query[d] * params.min[d]).sum(),
+                ),
+            }
+        };
+        Some(CodeScorer::Sq8 { guard: sq8, shift, step, bias, metric })
+    }
+
+    #[inline]
+    fn distance(&self, id: u32) -> Option<f32> {
+        use crate::index_manager::Metric as M;
+
+        match self {
+            CodeScorer::Pq { guard, table } => {
+                let pq = guard.as_ref()?;
+                let cs = pq.codebook.code_size();
+                let off = id as usize * cs;
+                pq.codes.get(off..off + cs).map(|code| pq.codebook.adc(table, code))
+            }
+            CodeScorer::Sq8 { guard, shift, step, bias, metric } => {
+                let dim = step.len();
+                let off = id as usize * dim;
+                let code = guard.as_ref()?.data.get(off..off + dim)?;
+                Some(match metric {
+                    M::L2 => crate::distance::sq8_l2(shift, step, code),
+                    M::InnerProduct => -(bias + crate::distance::sq8_dot(step, code)),
+                })
+            }
+            CodeScorer::Half { guard, query, metric } => {
+                let half = guard.as_ref()?;
+                let dim = query.len();
+                let off = id as usize * dim;
+                let code = half.data.get(off..off + dim)?;
+                Some(half.format.distance(*metric, query, code))
+            }
+        }
+    }
 }
 
 /// Newtype wrapper for the in-memory provider, allowing trait impls.
 #[derive(Debug, Clone)]
 pub struct Provider(Arc<Inner>);
 
+/// Allow-list of labels for filtered search: bit `id` set = `id` may be returned.
+/// Backed by caller-owned 64-bit words (label `id` lives in word `id / 64`).
+#[derive(Debug, Clone, Copy)]
+pub struct LabelBitmap<'a> {
+    words: &'a [u64],
+}
+
+impl<'a> LabelBitmap<'a> {
+    pub fn new(words: &'a [u64]) -> Self {
+        Self { words }
+    }
+
+    #[inline]
+    pub fn contains(&self, id: u32) -> bool {
+        let w = (id >> 6) as usize;
+        w < self.words.len() && (self.words[w] >> (id & 63)) & 1 == 1
+    }
+
+    pub fn count(&self) -> usize {
+        self.words.iter().map(|w| w.count_ones() as usize).sum()
+    }
+
+    /// Iterate set labels in ascending order.
+    pub fn iter(&self) -> impl Iterator<Item = u32> + 'a {
+        self.words.iter().enumerate().flat_map(|(wi, &word)| {
+            let mut bits = word;
+            std::iter::from_fn(move || {
+                if bits == 0 {
+                    return None;
+                }
+                let b = bits.trailing_zeros();
+                bits &= bits - 1;
+                Some((wi as u32) * 64 + b)
+            })
+        })
+    }
+}
+
 impl Provider {
     pub fn new(dimension: usize, max_degree: usize, metric: Metric) -> Self {
         Self(Arc::new(Inner {
             vectors: RwLock::new(Vec::new()),
             adjacency: DashMap::new(),
+            adjacency_edges: AtomicUsize::new(0),
             count: AtomicU32::new(0),
             start_point_ids: RwLock::new(Vec::new()),
             max_degree,
             dimension,
             metric,
             quantized: RwLock::new(None),
+            pq: RwLock::new(None),
+            half: RwLock::new(None),
+            dirty_adjacency_pages: DashSet::new(),
+            dirty_vector_pages: DashSet::new(),
+            pager: RwLock::new(None),
+            fully_resident: AtomicBool::new(true),
+            vectors_evicted: AtomicBool::new(false),
+            pending_vectors: DashMap::new(),
+            tombstones: RwLock::new(Vec::new()),
+            num_tombstones: AtomicU32::new(0),
+            stats: SearchStats::default(),
+            page_loads: AtomicU64::new(0),
+            load_failures: AtomicU64::new(0),
+            load_error: Mutex::new(String::new()),
+            metal_vectors: Mutex::new(None),
+            metal_tracking: AtomicBool::new(false),
+            metal_stale: DashSet::new(),
         }))
     }
 
@@ -84,18 +675,36 @@ impl Provider {
         let inner = Arc::new(Inner {
             vectors: RwLock::new(flat_vectors),
             adjacency: DashMap::new(),
+            adjacency_edges: AtomicUsize::new(0),
             count: AtomicU32::new(count),
             start_point_ids: RwLock::new(entry_points),
             max_degree,
             dimension,
             metric,
             quantized: RwLock::new(None),
+            pq: RwLock::new(None),
+            half: RwLock::new(None),
+            dirty_adjacency_pages: DashSet::new(),
+            dirty_vector_pages: DashSet::new(),
+            pager: RwLock::new(None),
+            fully_resident: AtomicBool::new(true),
+            vectors_evicted: AtomicBool::new(false),
+            pending_vectors: DashMap::new(),
+            tombstones: RwLock::new(Vec::new()),
+            num_tombstones: AtomicU32::new(0),
+            stats: SearchStats::default(),
+            page_loads: AtomicU64::new(0),
+            load_failures: AtomicU64::new(0),
+            load_error: Mutex::new(String::new()),
+            metal_vectors: Mutex::new(None),
+            metal_tracking: AtomicBool::new(false),
+            metal_stale: DashSet::new(),
         });
 
         for (id, neighbors) in adjacency_lists.into_iter().enumerate() {
             let mut adj = AdjacencyList::new();
             adj.extend_from_slice(&neighbors);
-            inner.adjacency.insert(id as u32, adj);
+            inner.put_adjacency(id as u32, adj);
         }
 
         Self(inner)
@@ -105,25 +714,315 @@ impl Provider {
         self.0.count.load(Ordering::Relaxed) as usize
     }
 
+    /// Counters of every search on this provider, including those run by the DiskANN crate.
+    pub fn search_stats(&self) -> &SearchStats {
+        &self.0.stats
+    }
+
     /// Insert as a start point. Called for the very first vector.
     pub fn insert_start_point(&self, id: u32, vector: Vec<f32>) {
+        self.write_node(id, &vector, &[]);
+        self.0.start_point_ids.write().push(id);
+    }
+
+    /// Drain the set of pages whose adjacency changed, in ascending order.
+    pub fn take_dirty_adjacency_pages(&self) -> Vec<u32> {
+        Self::drain_pages(&self.0.dirty_adjacency_pages)
+    }
+
+    /// Drain the set of pages whose vectors were written, in ascending order.
+    pub fn take_dirty_vector_pages(&self) -> Vec<u32> {
+        Self::drain_pages(&self.0.dirty_vector_pages)
+    }
+
+    fn drain_pages(set: &DashSet<u32>) -> Vec<u32> {
+        let mut pages: Vec<u32> = set.iter().map(|p| *p).collect();
+        for p in &pages {
+            set.remove(p);
+        }
+        pages.sort_unstable();
+        pages
+    }
+
+    /// Copy `count` vectors starting at `start` into `out` (count * dim floats).
+    /// Returns the number of vectors copied.
+    pub fn export_vectors(&self, start: u32, count: u32, out: &mut [f32]) -> usize {
+        if self.0.vectors_evicted.load(Ordering::Acquire) {
+            return self.export_evicted_vectors(start, count, out);
+        }
+        self.0.ensure_resident_range(start, count);
+        let dim = self.0.dimension;
+        let vecs = self.0.vectors.read();
+        let end = (start as usize + count as usize).min(self.len());
+        let n = end.saturating_sub(start as usize).min(out.len() / dim.max(1));
+        let offset = start as usize * dim;
+        if n > 0 && offset + n * dim <= vecs.len() {
+            out[..n * dim].copy_from_slice(&vecs[offset..offset + n * dim]);
+            n
+        } else {
+            0
+        }
+    }
+
+    /// `export_vectors` after eviction: the persisted part of the page from storage,
+    /// overlaid with the vectors written since.
+    fn export_evicted_vectors(&self, start: u32, count: u32, out: &mut [f32]) -> usize {
+        let dim = self.0.dimension;
+        let end = (start as usize + count as usize).min(self.len());
+        let n = end.saturating_sub(start as usize).min(out.len() / dim.max(1)) as u32;
+        if n == 0 {
+            return 0;
+        }
+        let stored = self.0.pager.read().as_ref().map_or(0, |pager| pager.num_vectors);
+        // Half-width vectors cover every node, persisted or not
+        if self.0.read_half(start, &mut out[..n as usize * dim]) {
+            return n as usize;
+        }
+        let from_storage = stored.saturating_sub(start).min(n);
+        if from_storage > 0
+            && !self.0.read_half(start, &mut out[..from_storage as usize * dim])
+            && !self.0.read_stored(start, from_storage, out)
         {
-            let mut vecs = self.0.vectors.write();
-            let offset = id as usize * self.0.dimension;
-            if vecs.len() < offset + self.0.dimension {
-                vecs.resize(offset + self.0.dimension, 0.0);
+            return 0;
+        }
+        for i in 0..n {
+            let row = &mut out[i as usize * dim..(i as usize + 1) * dim];
+            match self.0.pending_vectors.get(&(start + i)) {
+                Some(v) => row.copy_from_slice(&v),
+                None if i >= from_storage => return i as usize,
+                None => {}
             }
-            vecs[offset..offset + self.0.dimension].copy_from_slice(&vector);
         }
-        self.0.adjacency.insert(id, AdjacencyList::new());
-        self.0.count.fetch_max(id + 1, Ordering::Relaxed);
-        self.0.start_point_ids.write().push(id);
+        n as usize
+    }
+
+    /// Copy adjacency of `count` nodes starting at `start` into `out`, each row
+    /// padded to `max_degree` slots with u32::MAX (same layout as the .diskann file).
+    pub fn export_adjacency(&self, start: u32, count: u32, max_degree: usize, out: &mut [u32]) -> usize {
+        self.0.ensure_resident_range(start, count);
+        let end = (start as usize + count as usize).min(self.len());
+        let n = end.saturating_sub(start as usize).min(out.len() / max_degree.max(1));
+        for i in 0..n {
+            let row = &mut out[i * max_degree..(i + 1) * max_degree];
+            row.fill(u32::MAX);
+            if let Some(adj) = self.0.adjacency.get(&(start + i as u32)) {
+                let neighbors: &[u32] = &*adj;
+                let m = neighbors.len().min(max_degree);
+                row[..m].copy_from_slice(&neighbors[..m]);
+            }
+        }
+        n
+    }
+
+    /// Load one persisted page (vectors + padded adjacency) without marking it dirty.
+    pub fn import_page(&self, start: u32, vectors: &[f32], adjacency: &[u32], max_degree: usize) {
+        self.0.install_page(start, vectors, adjacency, max_degree);
+        let n = (vectors.len() / self.0.dimension.max(1)).min(adjacency.len() / max_degree.max(1));
+        self.0.count.fetch_max(start + n as u32, Ordering::Relaxed);
+    }
+
+    /// Open lazily: the first `num_vectors` nodes stay on disk and are faulted in
+    /// a page at a time through `load` when first touched.
+    pub fn attach_pager(&self, num_vectors: u32, load: PageLoader, ctx: *mut c_void) {
+        let page_count = (num_vectors as u64).div_ceil(PAGE_NODES as u64) as u32;
+        let pager = Pager {
+            load,
+            ctx: ctx as usize,
+            num_vectors,
+            page_count,
+            resident: (0..page_count).map(|_| AtomicBool::new(false)).collect(),
+            adjacency_resident: (0..page_count).map(|_| AtomicBool::new(false)).collect(),
+            resident_pages: AtomicU32::new(0),
+            fault_lock: Mutex::new(()),
+        };
+        *self.0.pager.write() = Some(Arc::new(pager));
+        self.0.fully_resident.store(page_count == 0, Ordering::Release);
+        self.0.count.fetch_max(num_vectors, Ordering::Relaxed);
+    }
+
+    /// Storage now holds the vectors of nodes [0, num_persisted): drop them from
+    /// memory. Vectors written since (pages still marked dirty, or past the end)
+    /// stay in `pending_vectors` until the next call. Needs SQ8, PQ or half-width codes.
+    pub fn evict_vectors(&self, num_persisted: u32, load: PageLoader, ctx: *mut c_void) -> bool {
+        let inner = &self.0;
+        if !self.searches_codes() {
+            return false;
+        }
+        let dim = inner.dimension;
+        let count = inner.count.load(Ordering::Relaxed);
+        let unpersisted =
+            |id: u32| id >= num_persisted || inner.dirty_vector_pages.contains(&(id / PAGE_NODES));
+
+        // Writers mark their page dirty under this lock, so none slips through
+        let mut vecs = inner.vectors.write();
+        if inner.vectors_evicted.load(Ordering::Acquire) {
+            inner.pending_vectors.retain(|&id, _| unpersisted(id));
+        } else {
+            let mut keep: Vec<u32> = (num_persisted..count).collect();
+            for page in inner.dirty_vector_pages.iter() {
+                let first = *page * PAGE_NODES;
+                keep.extend(first..(first + PAGE_NODES).min(num_persisted));
+            }
+            for id in keep {
+                if let Some(v) = Self::vector_at(&vecs, dim, id) {
+                    inner.pending_vectors.insert(id, v.into());
+                }
+            }
+        }
+
+        // Adjacency that is already in memory must never be reloaded over
+        let old = inner.pager.read().clone();
+        let page_count = num_persisted.div_ceil(PAGE_NODES);
+        let adjacency_in_memory = |p: u32| match &old {
+            Some(old) if p < old.page_count => {
+                old.resident[p as usize].load(Ordering::Acquire)
+                    || old.adjacency_resident[p as usize].load(Ordering::Acquire)
+            }
+            _ => true,
+        };
+        let pager = Pager {
+            load,
+            ctx: ctx as usize,
+            num_vectors: num_persisted,
+            page_count,
+            resident: (0..page_count).map(|_| AtomicBool::new(false)).collect(),
+            adjacency_resident: (0..page_count).map(|p| AtomicBool::new(adjacency_in_memory(p))).collect(),
+            resident_pages: AtomicU32::new(0),
+            fault_lock: Mutex::new(()),
+        };
+        *inner.pager.write() = Some(Arc::new(pager));
+        *vecs = Vec::new();
+        inner.drop_metal_vectors();
+        inner.vectors_evicted.store(true, Ordering::Release);
+        inner.fully_resident.store(false, Ordering::Release);
+        true
+    }
+
+    /// Whether full-precision vectors were dropped from memory.
+    pub fn vectors_evicted(&self) -> bool {
+        self.0.vectors_evicted.load(Ordering::Acquire)
+    }
+
+    /// Number of pages still on disk (0 when fully resident).
+    pub fn nonresident_pages(&self) -> u32 {
+        match self.0.pager.read().as_ref() {
+            Some(pager) => pager.page_count - pager.resident_pages.load(Ordering::Acquire),
+            None => 0,
+        }
+    }
+
+    /// Fault in every page still on disk. Returns false if a page failed to load.
+    pub fn load_all_pages(&self) -> bool {
+        self.0.ensure_all_resident()
+    }
+
+    /// Tombstone `ids`: they keep routing searches but are never returned.
+    /// Returns how many were not already deleted.
+    pub fn mark_deleted(&self, ids: &[u32]) -> usize {
+        let mut words = self.0.tombstones.write();
+        let mut added = 0;
+        for &id in ids {
+            let w = (id >> 6) as usize;
+            if w >= words.len() {
+                words.resize(w + 1, 0);
+            }
+            let bit = 1u64 << (id & 63);
+            if words[w] & bit == 0 {
+                words[w] |= bit;
+                added += 1;
+            }
+        }
+        self.0.num_tombstones.fetch_add(added as u32, Ordering::Relaxed);
+        added
+    }
+
+    /// Clear the tombstones of `ids` (recycled slots about to be reused).
+    pub fn clear_deleted(&self, ids: &[u32]) {
+        let mut words = self.0.tombstones.write();
+        let mut cleared = 0;
+        for &id in ids {
+            let w = (id >> 6) as usize;
+            let bit = 1u64 << (id & 63);
+            if w < words.len() && words[w] & bit != 0 {
+                words[w] &= !bit;
+                cleared += 1;
+            }
+        }
+        self.0.num_tombstones.fetch_sub(cleared, Ordering::Relaxed);
+    }
+
+    pub fn is_deleted(&self, id: u32) -> bool {
+        LabelBitmap::new(&self.0.tombstones.read()).contains(id)
+    }
+
+    /// All tombstoned ids, ascending.
+    pub fn deleted_ids(&self) -> Vec<u32> {
+        LabelBitmap::new(&self.0.tombstones.read()).iter().collect()
+    }
+
+    /// Unlink a consolidated tombstone from the graph: drop its out-edges so the
+    /// slot can be reused. In-edges must already have been repaired.
+    pub fn drop_adjacency(&self, id: u32) {
+        self.0.ensure_resident(id);
+        self.0.set_adjacency(id, &[], false);
+    }
+
+    pub fn deleted_count(&self) -> usize {
+        self.0.num_tombstones.load(Ordering::Relaxed) as usize
+    }
+
+    /// Copy of the tombstone bitmap words (for persistence).
+    pub fn tombstone_words(&self) -> Vec<u64> {
+        self.0.tombstones.read().clone()
+    }
+
+    /// Replace the tombstone bitmap (after load).
+    pub fn set_tombstones(&self, words: Vec<u64>) {
+        let count = LabelBitmap::new(&words).count();
+        *self.0.tombstones.write() = words;
+        self.0.num_tombstones.store(count as u32, Ordering::Relaxed);
+    }
+
+    /// Replace the start point set (used after a page-by-page import).
+    pub fn set_entry_points(&self, entry_points: Vec<u32>) {
+        *self.0.start_point_ids.write() = entry_points;
+    }
+
+    /// Hand the role of each deleted entry point to a live out-neighbour (the first
+    /// live node if none of them is), so it can be freed like any other tombstone.
+    /// An entry point is kept while no live node is left.
+    pub fn replace_deleted_entry_points(&self) {
+        let mut entry_points = self.get_entry_points();
+        let mut changed = false;
+        for i in 0..entry_points.len() {
+            let old = entry_points[i];
+            if !self.is_deleted(old) {
+                continue;
+            }
+            let usable = |id: u32| !self.is_deleted(id) && !entry_points.contains(&id);
+            let replacement = self
+                .get_neighbors(old)
+                .and_then(|neighbors| neighbors.into_iter().find(|&id| usable(id)))
+                .or_else(|| (0..self.len() as u32).find(|&id| usable(id)));
+            if let Some(id) = replacement {
+                entry_points[i] = id;
+                changed = true;
+            }
+        }
+        if changed {
+            self.set_entry_points(entry_points);
+        }
     }
 
     /// Get a copy of the vector data for the given id.
     /// If SQ8 is active and the vector is in quantized range, dequantizes.
     pub fn get_vector(&self, id: u32) -> Option<Vec<f32>> {
         let dim = self.0.dimension;
+        if self.0.vectors_evicted.load(Ordering::Acquire) {
+            let mut out = vec![0.0f32; dim];
+            return self.0.read_vector(id, &mut out).then_some(out);
+        }
+        self.0.ensure_resident(id);
         let offset = id as usize * dim;
 
         // Try full precision first
@@ -146,11 +1045,14 @@ impl Provider {
                 return Some(result);
             }
         }
-        None
+        drop(q_guard);
+        let mut result = vec![0.0f32; dim];
+        self.0.read_half(id, &mut result).then_some(result)
     }
 
     /// Get a copy of the neighbor list for the given id.
     pub fn get_neighbors(&self, id: u32) -> Option<Vec<u32>> {
+        self.0.ensure_resident(id);
         self.0.adjacency.get(&id).map(|adj| adj.to_vec())
     }
 
@@ -159,6 +1061,10 @@ impl Provider {
     /// Full precision vectors are kept for new inserts; quantized data
     /// is used for search (dequantized on the fly in get_element).
     pub fn quantize_sq8(&self) {
+        if self.vectors_evicted() {
+            return;
+        }
+        self.0.ensure_all_resident();
         let vecs = self.0.vectors.read();
         let count = self.0.count.load(Ordering::Relaxed) as usize;
         let dim = self.0.dimension;
@@ -224,27 +1130,196 @@ impl Provider {
         self.0.quantized.read().as_ref().map(|q| q.data.clone())
     }
 
+    /// Copy the SQ8 codes of nodes [start, start + count) into `out`.
+    /// Returns the number of nodes copied.
+    pub fn export_sq8_codes(&self, start: u32, count: u32, out: &mut [u8]) -> usize {
+        let guard = self.0.quantized.read();
+        let Some(q) = guard.as_ref() else {
+            return 0;
+        };
+        let dim = self.0.dimension;
+        let begin = (start as usize * dim).min(q.data.len());
+        let end = ((start + count) as usize * dim).min(q.data.len()).min(begin + out.len());
+        out[..end - begin].copy_from_slice(&q.data[begin..end]);
+        (end - begin) / dim.max(1)
+    }
+
     /// Load quantized data from deserialization.
     pub fn load_sq8(&self, data: Vec<u8>, params: SQ8Params) {
         *self.0.quantized.write() = Some(QuantizedStorage { data, params });
     }
 
-    /// Memory used by vector storage (full precision + quantized).
+    /// Train a PQ codebook (`m` subspaces, `2^bits` centroids each) on the current
+    /// vectors and encode all of them. Searches then traverse on the codes.
+    pub fn quantize_pq(&self, m: usize, bits: u32, scheduler: &Scheduler) -> anyhow::Result<()> {
+        if self.vectors_evicted() {
+            return Err(anyhow::anyhow!("Full-precision vectors are no longer in memory"));
+        }
+        self.0.ensure_all_resident();
+        let vecs = self.0.vectors.read();
+        let count = self.0.count.load(Ordering::Relaxed) as usize;
+        let dim = self.0.dimension;
+        let m = if m == 0 { PqCodebook::default_subspaces(dim) } else { m };
+        let codebook = PqCodebook::train(&vecs, count, dim, m, bits, scheduler)?;
+
+        let code_size = codebook.code_size();
+        let mut codes = vec![0u8; count * code_size];
+        for (i, code) in codes.chunks_exact_mut(code_size).enumerate() {
+            codebook.encode(&vecs[i * dim..(i + 1) * dim], code);
+        }
+        drop(vecs);
+        *self.0.pq.write() = Some(PqStorage { codebook, codes });
+        Ok(())
+    }
+
+    /// Whether PQ codes drive the search.
+    pub fn is_pq(&self) -> bool {
+        self.0.pq.read().is_some()
+    }
+
+    /// Serialized codebook (empty when PQ is not active).
+    pub fn pq_codebook_bytes(&self) -> Vec<u8> {
+        self.0.pq.read().as_ref().map(|pq| pq.codebook.to_bytes()).unwrap_or_default()
+    }
+
+    /// Bytes per PQ code (0 when PQ is not active).
+    pub fn pq_code_size(&self) -> usize {
+        self.0.pq.read().as_ref().map_or(0, |pq| pq.codebook.code_size())
+    }
+
+    /// Copy the codes of nodes [start, start + count) into `out`.
+    /// Returns the number of nodes copied.
+    pub fn export_pq_codes(&self, start: u32, count: u32, out: &mut [u8]) -> usize {
+        let guard = self.0.pq.read();
+        let Some(pq) = guard.as_ref() else {
+            return 0;
+        };
+        let cs = pq.codebook.code_size();
+        let begin = (start as usize * cs).min(pq.codes.len());
+        let end = ((start + count) as usize * cs).min(pq.codes.len()).min(begin + out.len());
+        out[..end - begin].copy_from_slice(&pq.codes[begin..end]);
+        (end - begin) / cs.max(1)
+    }
+
+    /// Install a persisted codebook and the codes of every node.
+    pub fn load_pq(&self, codebook: &[u8], codes: Vec<u8>) -> anyhow::Result<()> {
+        let codebook = PqCodebook::from_bytes(codebook)?;
+        if codebook.dim() != self.0.dimension {
+            return Err(anyhow::anyhow!(
+                "PQ codebook dimension {} does not match index dimension {}",
+                codebook.dim(),
+                self.0.dimension
+            ));
+        }
+        *self.0.pq.write() = Some(PqStorage { codebook, codes });
+        Ok(())
+    }
+
+    /// Store every vector at half width from now on: the full-precision vectors
+    /// are dropped once encoded, and searches, inserts and prunes read the
+    /// half-width copies instead.
+    pub fn quantize_half(&self, format: HalfFormat) -> anyhow::Result<()> {
+        if self.vectors_evicted() {
+            return Err(anyhow::anyhow!("Full-precision vectors are no longer in memory"));
+        }
+        self.0.ensure_all_resident();
+        let vecs = self.0.vectors.read();
+        let n = (self.0.count.load(Ordering::Relaxed) as usize * self.0.dimension).min(vecs.len());
+        let mut data = vec![0u16; n];
+        format.encode(&vecs[..n], &mut data);
+        drop(vecs);
+        self.load_half(format, data);
+        Ok(())
+    }
+
+    /// Format of the half-width vectors (None when precision is f32).
+    pub fn half_format(&self) -> Option<HalfFormat> {
+        self.0.half.read().as_ref().map(|h| h.format)
+    }
+
+    /// Copy the half-width vectors of nodes [start, start + count) into `out`.
+    /// Returns the number of nodes copied.
+    pub fn export_half_codes(&self, start: u32, count: u32, out: &mut [u16]) -> usize {
+        let guard = self.0.half.read();
+        let Some(h) = guard.as_ref() else {
+            return 0;
+        };
+        let dim = self.0.dimension;
+        let begin = (start as usize * dim).min(h.data.len());
+        let end = ((start + count) as usize * dim).min(h.data.len()).min(begin + out.len());
+        out[..end - begin].copy_from_slice(&h.data[begin..end]);
+        (end - begin) / dim.max(1)
+    }
+
+    /// Install the half-width vectors of every node, which replace the full-precision
+    /// ones: reads decode them, and pages faulted in later bring only adjacency.
+    pub fn load_half(&self, format: HalfFormat, data: Vec<u16>) {
+        *self.0.half.write() = Some(HalfStorage { format, data });
+        // Set under the write lock, so no writer keeps adding full-precision vectors
+        let mut vecs = self.0.vectors.write();
+        *vecs = Vec::new();
+        self.0.drop_metal_vectors();
+        self.0.vectors_evicted.store(true, Ordering::Release);
+    }
+
+    /// Memory used by vector storage (full precision + SQ8/PQ/half-width codes), as allocated.
     pub fn vector_memory_bytes(&self) -> usize {
         let vecs = self.0.vectors.read();
-        let mut size = vecs.len() * std::mem::size_of::<f32>();
+        let mut size = vecs.capacity() * std::mem::size_of::<f32>();
+        size += self.0.pending_vectors.len()
+            * (self.0.dimension * std::mem::size_of::<f32>() + std::mem::size_of::<(u32, Box<[f32]>)>());
         if let Some(q) = self.0.quantized.read().as_ref() {
-            size += q.data.len();
-            size += q.params.min.len() * std::mem::size_of::<f32>() * 2;
+            size += q.data.capacity();
+            size += q.params.min.capacity() * std::mem::size_of::<f32>() * 2;
+        }
+        if let Some(pq) = self.0.pq.read().as_ref() {
+            size += pq.codes.capacity();
+        }
+        if let Some(h) = self.0.half.read().as_ref() {
+            size += h.data.capacity() * std::mem::size_of::<u16>();
+        }
+        if let Some(res) = self.0.metal_vectors.lock().as_ref() {
+            size += res.bytes();
         }
         size
     }
 
+    /// Resident memory: vector storage, the loaded adjacency lists at their actual degree
+    /// and the tombstone bitmap.
+    pub fn memory_bytes(&self) -> usize {
+        let entries = self.0.adjacency.len() * std::mem::size_of::<(u32, AdjacencyList<u32>)>();
+        let edges = self.0.adjacency_edges.load(Ordering::Relaxed) * std::mem::size_of::<u32>();
+        let tombstones = self.0.tombstones.read().capacity() * std::mem::size_of::<u64>();
+        self.vector_memory_bytes() + entries + edges + tombstones
+    }
+
+    /// Pages and vectors read back from storage since the index was opened.
+    pub fn page_loads(&self) -> u64 {
+        self.0.page_loads.load(Ordering::Relaxed)
+    }
+
+    /// Failed page loads since the index was opened (see `check_page_loads`).
+    pub fn load_failures(&self) -> u64 {
+        self.0.load_failures.load(Ordering::Acquire)
+    }
+
+    /// Fails with the last loader error if a page load failed since `load_failures()`
+    /// returned `before`.
+    pub fn check_page_loads(&self, before: u64) -> anyhow::Result<()> {
+        if self.load_failures() == before {
+            return Ok(());
+        }
+        Err(anyhow::anyhow!("{}{}", PAGE_LOAD_ERROR, self.0.load_error.lock()))
+    }
+
     /// Lock-step multi-query batch search with GPU acceleration.
     ///
     /// Holds the vectors read lock once for the entire search. Aggregates
     /// neighbor distance work across all queries and dispatches to Metal GPU
-    /// when total work exceeds MIN_GPU_WORK. Falls back to CPU SIMD otherwise.
+    /// when total work exceeds MIN_GPU_WORK_RESIDENT: the vectors are kept in a
+    /// Metal buffer between searches and an iteration only uploads neighbour ids.
+    /// If that copy cannot be made, vectors are gathered per iteration above
+    /// MIN_GPU_WORK. Falls back to CPU SIMD otherwise.
     pub fn search_batch(
         &self,
         queries: &[&[f32]],
@@ -265,9 +1340,13 @@ impl Provider {
             return vec![self.search_single(queries[0], k, l_search, metric)];
         }
 
+        // Lock-step search holds the vectors lock throughout: fault in up front
+        self.0.ensure_all_resident();
+
         let k = k.min(self.len());
         let l = l_search.max(k);
         let dim = self.0.dimension;
+        let mut tally = SearchTally { searches: nq as u64, ..Default::default() };
         let metric_code: u8 = match metric {
             crate::index_manager::Metric::L2 => 0,
             crate::index_manager::Metric::InnerProduct => 1,
@@ -312,6 +1391,7 @@ impl Provider {
                 if state.visited.insert(ep) {
                     if let Some(vec) = get_vec(ep) {
                         let dist = crate::distance::compute_distance(metric, queries[qi], vec);
+                        tally.distance_computations += 1;
                         state.candidates.push(Reverse((FloatOrd(dist), ep)));
                         state.result.push((dist, ep));
                     }
@@ -323,6 +1403,13 @@ impl Provider {
         // Flat queries buffer for GPU
         let queries_flat: Vec<f32> = queries.iter().flat_map(|q| q.iter().copied()).collect();
 
+        // Resident Metal vectors, if an iteration can be large enough to use them
+        let resident = self.0.fully_resident.load(Ordering::Acquire)
+            && !self.0.vectors_evicted.load(Ordering::Acquire)
+            && nq * self.0.max_degree * dim >= MIN_GPU_WORK_RESIDENT
+            && crate::metal_ffi::is_metal_available()
+            && self.0.sync_metal_vectors(&vecs);
+
         // Scratch buffers
         let max_per_iter = nq * self.0.max_degree;
         let mut all_neighbor_ids: Vec<u32> = Vec::with_capacity(max_per_iter);
@@ -344,145 +1431,389 @@ impl Provider {
                     continue;
                 }
 
-                match state.candidates.pop() {
-                    None => {
-                        state.active = false;
+                match state.candidates.pop() {
+                    None => {
+                        state.active = false;
+                        continue;
+                    }
+                    Some(Reverse((FloatOrd(c_dist), c_id))) => {
+                        if state.result.len() >= l && c_dist > state.result[l - 1].0 {
+                            state.active = false;
+                            continue;
+                        }
+                        tally.hops += 1;
+
+                        if let Some(adj) = self.0.adjacency.get(&c_id) {
+                            let neighbors: &[u32] = &*adj;
+                            for &neighbor in neighbors {
+                                if neighbor >= n_vecs {
+                                    continue;
+                                }
+                                if !state.visited.insert(neighbor) {
+                                    continue;
+                                }
+                                if get_vec(neighbor).is_none() {
+                                    continue;
+                                }
+                                all_neighbor_ids.push(neighbor);
+                                all_query_map.push(qi as u32);
+                            }
+                        }
+                    }
+                }
+            }
+
+            if all_neighbor_ids.is_empty() {
+                continue;
+            }
+
+            let total_n = all_neighbor_ids.len();
+
+            // GPU path
+            let gpu_ok = if resident && total_n * dim >= MIN_GPU_WORK_RESIDENT {
+                // Vectors are already on the device: upload the ids only
+                batch_dist.resize(total_n, 0.0);
+                self.0.metal_vectors.lock().as_ref().is_some_and(|res| {
+                    res.multi_batch_distances(
+                        &queries_flat,
+                        &all_neighbor_ids,
+                        &all_query_map,
+                        nq,
+                        metric_code,
+                        &mut batch_dist,
+                    )
+                })
+            } else if total_n * dim >= MIN_GPU_WORK {
+                batch_buf.clear();
+                batch_buf.reserve(total_n * dim);
+                for &id in &all_neighbor_ids {
+                    if let Some(v) = get_vec(id) {
+                        batch_buf.extend_from_slice(v);
+                    }
+                }
+                batch_dist.resize(total_n, 0.0);
+
+                crate::metal_ffi::metal_multi_batch_distances(
+                    &queries_flat,
+                    &batch_buf,
+                    &all_query_map,
+                    total_n,
+                    nq,
+                    dim,
+                    metric_code,
+                    &mut batch_dist,
+                )
+            } else {
+                false
+            };
+            if gpu_ok {
+                tally.gpu_dispatches += 1;
+                tally.distance_computations += total_n as u64;
+                for i in 0..total_n {
+                    let qi = all_query_map[i] as usize;
+                    let state = &mut states[qi];
+                    Self::insert_result_batch(&mut state.result, &mut state.candidates, l, batch_dist[i], all_neighbor_ids[i]);
+                }
+                continue;
+            }
+
+            // CPU fallback
+            tally.cpu_dispatches += 1;
+            for i in 0..total_n {
+                let qi = all_query_map[i] as usize;
+                let neighbor = all_neighbor_ids[i];
+                if let Some(vec) = get_vec(neighbor) {
+                    let dist = crate::distance::compute_distance(metric, queries[qi], vec);
+                    tally.distance_computations += 1;
+                    let state = &mut states[qi];
+                    Self::insert_result_batch(&mut state.result, &mut state.candidates, l, dist, neighbor);
+                }
+            }
+        }
+
+        tally.visited = states.iter().map(|state| state.visited.len() as u64).sum();
+        let tombstones = self.0.tombstones.read();
+        let deleted = LabelBitmap::new(&tombstones);
+        let results = states
+            .into_iter()
+            .map(|state| Self::live_top_k(state.result, k, &deleted, &mut tally))
+            .collect();
+        self.0.stats.record(&tally);
+        results
+    }
+
+    /// Single-query search (used by search_batch for nq=1 and by InMemoryIndex).
+    fn search_single(
+        &self,
+        query: &[f32],
+        k: usize,
+        l_search: usize,
+        metric: crate::index_manager::Metric,
+    ) -> Vec<(u64, f32)> {
+        use std::cmp::Reverse;
+        use std::collections::BinaryHeap;
+
+        let n = self.len();
+        if n == 0 || k == 0 {
+            return Vec::new();
+        }
+
+        let k = k.min(n);
+        let l = l_search.max(k);
+        let dim = self.0.dimension;
+
+        let n_vecs = self.0.count.load(std::sync::atomic::Ordering::Relaxed);
+        let entry_points = self.0.start_point_ids.read().clone();
+        self.0.ensure_resident_ids(&entry_points);
+        let mut vecs = self.0.vectors.read();
+
+        let mut visited = hashbrown::HashSet::with_capacity(l * 2);
+        let mut candidates: BinaryHeap<Reverse<(FloatOrd, u32)>> = BinaryHeap::new();
+        let mut result: Vec<(f32, u32)> = Vec::new();
+        let mut tally = SearchTally { searches: 1, ..Default::default() };
+
+        for &ep in &entry_points {
+            if visited.insert(ep) {
+                if let Some(vec) = Self::vector_at(&vecs, dim, ep) {
+                    let dist = crate::distance::compute_distance(metric, query, vec);
+                    tally.distance_computations += 1;
+                    candidates.push(Reverse((FloatOrd(dist), ep)));
+                    result.push((dist, ep));
+                }
+            }
+        }
+        result.sort_by(|a, b| a.0.partial_cmp(&b.0).unwrap_or(std::cmp::Ordering::Equal));
+
+        while let Some(Reverse((FloatOrd(c_dist), c_id))) = candidates.pop() {
+            if result.len() >= l && c_dist > result[l - 1].0 {
+                break;
+            }
+            tally.hops += 1;
+
+            // Lazily opened index: fault in the neighbors' pages with the lock released
+            if !self.0.fully_resident.load(Ordering::Acquire) {
+                if let Some(neighbors) = self.0.adjacency.get(&c_id).map(|adj| adj.to_vec()) {
+                    RwLockReadGuard::unlocked(&mut vecs, || self.0.ensure_resident_ids(&neighbors));
+                }
+            }
+
+            if let Some(adj) = self.0.adjacency.get(&c_id) {
+                let neighbors: &[u32] = &*adj;
+                for &neighbor in neighbors {
+                    if neighbor >= n_vecs {
                         continue;
                     }
-                    Some(Reverse((FloatOrd(c_dist), c_id))) => {
-                        if state.result.len() >= l && c_dist > state.result[l - 1].0 {
-                            state.active = false;
-                            continue;
-                        }
-
-                        if let Some(adj) = self.0.adjacency.get(&c_id) {
-                            let neighbors: &[u32] = &*adj;
-                            for &neighbor in neighbors {
-                                if neighbor >= n_vecs {
-                                    continue;
-                                }
-                                if !state.visited.insert(neighbor) {
-                                    continue;
-                                }
-                                if get_vec(neighbor).is_none() {
-                                    continue;
-                                }
-                                all_neighbor_ids.push(neighbor);
-                                all_query_map.push(qi as u32);
-                            }
-                        }
+                    if !visited.insert(neighbor) {
+                        continue;
+                    }
+                    if let Some(vec) = Self::vector_at(&vecs, dim, neighbor) {
+                        let dist = crate::distance::compute_distance(metric, query, vec);
+                        tally.distance_computations += 1;
+                        Self::insert_result_batch(&mut result, &mut candidates, l, dist, neighbor);
                     }
                 }
             }
+        }
 
-            if all_neighbor_ids.is_empty() {
+        tally.visited = visited.len() as u64;
+        let tombstones = self.0.tombstones.read();
+        let deleted = LabelBitmap::new(&tombstones);
+        let results = Self::live_top_k(result, k, &deleted, &mut tally);
+        self.0.stats.record(&tally);
+        results
+    }
+
+    /// The best `k` candidates of a traversal that are not tombstoned; skipped ones are tallied.
+    fn live_top_k(
+        result: Vec<(f32, u32)>,
+        k: usize,
+        deleted: &LabelBitmap<'_>,
+        tally: &mut SearchTally,
+    ) -> Vec<(u64, f32)> {
+        let mut live = Vec::with_capacity(k);
+        for (dist, id) in result {
+            if live.len() >= k {
+                break;
+            }
+            if deleted.contains(id) {
+                tally.deleted_filtered += 1;
                 continue;
             }
+            live.push((id as u64, dist));
+        }
+        live
+    }
 
-            let total_n = all_neighbor_ids.len();
+    /// Whether searches traverse on SQ8/PQ/half-width codes rather than full-precision vectors.
+    pub fn searches_codes(&self) -> bool {
+        self.is_pq() || self.is_quantized() || self.half_format().is_some()
+    }
 
-            // GPU path
-            let use_gpu = total_n * dim >= crate::metal_ffi::MIN_GPU_WORK;
-            if use_gpu {
-                batch_buf.clear();
-                batch_buf.reserve(total_n * dim);
-                for &id in &all_neighbor_ids {
-                    if let Some(v) = get_vec(id) {
-                        batch_buf.extend_from_slice(v);
-                    }
-                }
-                batch_dist.resize(total_n, 0.0);
+    /// Quantized search: beam search scored on the SQ8/PQ codes (only adjacency
+    /// pages are faulted in), then the best `max(rerank, k)` live candidates are
+    /// re-ranked with exact distances on full-precision vectors. Half-width vectors
+    /// are the index's vectors: their distances are final and nothing is re-ranked.
+    ///
+    /// With `allowed`, non-matching nodes only route and the beam is widened by
+    /// the inverse selectivity, as in `search_filtered`.
+    pub fn search_quantized(
+        &self,
+        query: &[f32],
+        k: usize,
+        l_search: usize,
+        rerank: usize,
+        metric: crate::index_manager::Metric,
+        allowed: Option<LabelBitmap<'_>>,
+    ) -> Vec<(u64, f32)> {
+        use std::cmp::Reverse;
+        use std::collections::BinaryHeap;
 
-                let gpu_ok = crate::metal_ffi::metal_multi_batch_distances(
-                    &queries_flat,
-                    &batch_buf,
-                    &all_query_map,
-                    total_n,
-                    nq,
-                    dim,
-                    metric_code,
-                    &mut batch_dist,
-                );
+        let n = self.len();
+        let n_allowed = allowed.as_ref().map_or(n, |a| a.count());
+        if n == 0 || k == 0 || n_allowed == 0 {
+            return Vec::new();
+        }
+
+        let k = k.min(n_allowed);
+        // Neither SQ8 nor PQ: the scorer reads the half-width vectors
+        let half = !self.is_pq() && !self.is_quantized();
+        let rerank = if half { k } else { rerank.max(k) };
+        let base_l = l_search.max(rerank);
+        let l = (base_l.saturating_mul(n) / n_allowed).clamp(base_l, n.max(base_l));
+        let n_vecs = self.0.count.load(Ordering::Relaxed);
+        let entry_points = self.0.start_point_ids.read().clone();
+        let matches_filter = |id: u32| allowed.as_ref().map_or(true, |a| a.contains(id));
 
-                if gpu_ok {
-                    for i in 0..total_n {
-                        let qi = all_query_map[i] as usize;
-                        let state = &mut states[qi];
-                        Self::insert_result_batch(&mut state.result, &mut state.candidates, l, batch_dist[i], all_neighbor_ids[i]);
+        let mut result: Vec<(f32, u32)> = Vec::new();
+        let mut matches: Vec<(f32, u32)> = Vec::new();
+        let mut tally = SearchTally { searches: 1, ..Default::default() };
+        {
+            let Some(scorer) = CodeScorer::new(&self.0, query, metric) else {
+                return Vec::new();
+            };
+
+            let mut visited = hashbrown::HashSet::with_capacity(l * 2);
+            let mut candidates: BinaryHeap<Reverse<(FloatOrd, u32)>> = BinaryHeap::new();
+            for &ep in &entry_points {
+                if visited.insert(ep) {
+                    if let Some(dist) = scorer.distance(ep) {
+                        tally.distance_computations += 1;
+                        candidates.push(Reverse((FloatOrd(dist), ep)));
+                        result.push((dist, ep));
+                        if matches_filter(ep) {
+                            matches.push((dist, ep));
+                        }
                     }
-                    continue;
                 }
             }
+            result.sort_by(|a, b| a.0.partial_cmp(&b.0).unwrap_or(std::cmp::Ordering::Equal));
 
-            // CPU fallback
-            for i in 0..total_n {
-                let qi = all_query_map[i] as usize;
-                let neighbor = all_neighbor_ids[i];
-                if let Some(vec) = get_vec(neighbor) {
-                    let dist = crate::distance::compute_distance(metric, queries[qi], vec);
-                    let state = &mut states[qi];
-                    Self::insert_result_batch(&mut state.result, &mut state.candidates, l, dist, neighbor);
+            while let Some(Reverse((FloatOrd(c_dist), c_id))) = candidates.pop() {
+                if result.len() >= l && c_dist > result[l - 1].0 {
+                    break;
+                }
+                tally.hops += 1;
+                self.0.ensure_adjacency_resident(c_id);
+                let Some(neighbors) = self.0.adjacency.get(&c_id).map(|adj| adj.to_vec()) else {
+                    continue;
+                };
+                for neighbor in neighbors {
+                    if neighbor >= n_vecs || !visited.insert(neighbor) {
+                        continue;
+                    }
+                    if let Some(dist) = scorer.distance(neighbor) {
+                        tally.distance_computations += 1;
+                        if matches_filter(neighbor) {
+                            matches.push((dist, neighbor));
+                        }
+                        Self::insert_result_batch(&mut result, &mut candidates, l, dist, neighbor);
+                    }
                 }
             }
+            tally.visited = visited.len() as u64;
+        }
+        if allowed.is_some() {
+            matches.sort_by(|a, b| a.0.partial_cmp(&b.0).unwrap_or(std::cmp::Ordering::Equal));
+            result = matches;
+        }
+
+        let tombstones = self.0.tombstones.read();
+        let deleted = LabelBitmap::new(&tombstones);
+        if half {
+            let live = Self::live_top_k(result, k, &deleted, &mut tally);
+            self.0.stats.record(&tally);
+            return live;
         }
 
-        states
+        // Re-rank on full precision
+        let mut buf = vec![0.0f32; self.0.dimension];
+        let mut exact: Vec<(f32, u32)> = Self::live_top_k(result, rerank, &deleted, &mut tally)
             .into_iter()
-            .map(|state| {
-                state
-                    .result
-                    .into_iter()
-                    .take(k)
-                    .map(|(dist, id)| (id as u64, dist))
-                    .collect()
+            .filter_map(|(id, _)| {
+                let id = id as u32;
+                self.0
+                    .read_vector(id, &mut buf)
+                    .then(|| (crate::distance::compute_distance(metric, query, &buf), id))
             })
+            .collect();
+        tally.distance_computations += exact.len() as u64;
+        self.0.stats.record(&tally);
+        exact.sort_by(|a, b| a.0.partial_cmp(&b.0).unwrap_or(std::cmp::Ordering::Equal));
+        exact
+            .into_iter()
+            .take(k)
+            .map(|(dist, id)| (id as u64, dist))
             .collect()
     }
 
-    /// Single-query search (used by search_batch for nq=1 and by InMemoryIndex).
-    fn search_single(
+    /// Filtered single-query search: the graph is traversed as usual (every node
+    /// can route), but only labels in `allowed` are collected as results.
+    ///
+    /// The beam is widened by the inverse filter selectivity so that roughly
+    /// `l_search` matching nodes are seen before the search converges.
+    pub fn search_filtered(
         &self,
         query: &[f32],
         k: usize,
         l_search: usize,
         metric: crate::index_manager::Metric,
+        allowed: LabelBitmap<'_>,
     ) -> Vec<(u64, f32)> {
         use std::cmp::Reverse;
         use std::collections::BinaryHeap;
 
         let n = self.len();
-        if n == 0 || k == 0 {
+        let n_allowed = allowed.count();
+        if n == 0 || k == 0 || n_allowed == 0 {
             return Vec::new();
         }
 
-        let k = k.min(n);
-        let l = l_search.max(k);
+        let k = k.min(n_allowed);
+        let base_l = l_search.max(k);
+        let l = (base_l.saturating_mul(n) / n_allowed).clamp(base_l, n);
         let dim = self.0.dimension;
 
-        let vecs = self.0.vectors.read();
         let n_vecs = self.0.count.load(std::sync::atomic::Ordering::Relaxed);
         let entry_points = self.0.start_point_ids.read().clone();
-
-        let get_vec = |id: u32| -> Option<&[f32]> {
-            let offset = id as usize * dim;
-            let end = offset + dim;
-            if end <= vecs.len() {
-                Some(&vecs[offset..end])
-            } else {
-                None
-            }
-        };
+        self.0.ensure_resident_ids(&entry_points);
+        let mut vecs = self.0.vectors.read();
 
         let mut visited = hashbrown::HashSet::with_capacity(l * 2);
         let mut candidates: BinaryHeap<Reverse<(FloatOrd, u32)>> = BinaryHeap::new();
         let mut result: Vec<(f32, u32)> = Vec::new();
+        let mut matches: Vec<(f32, u32)> = Vec::with_capacity(k + 1);
+        let mut tally = SearchTally { searches: 1, ..Default::default() };
 
         for &ep in &entry_points {
             if visited.insert(ep) {
-                if let Some(vec) = get_vec(ep) {
+                if let Some(vec) = Self::vector_at(&vecs, dim, ep) {
                     let dist = crate::distance::compute_distance(metric, query, vec);
+                    tally.distance_computations += 1;
                     candidates.push(Reverse((FloatOrd(dist), ep)));
                     result.push((dist, ep));
+                    if allowed.contains(ep) {
+                        Self::insert_match(&mut matches, k, dist, ep);
+                    }
                 }
             }
         }
@@ -492,6 +1823,14 @@ impl Provider {
             if result.len() >= l && c_dist > result[l - 1].0 {
                 break;
             }
+            tally.hops += 1;
+
+            // Lazily opened index: fault in the neighbors' pages with the lock released
+            if !self.0.fully_resident.load(Ordering::Acquire) {
+                if let Some(neighbors) = self.0.adjacency.get(&c_id).map(|adj| adj.to_vec()) {
+                    RwLockReadGuard::unlocked(&mut vecs, || self.0.ensure_resident_ids(&neighbors));
+                }
+            }
 
             if let Some(adj) = self.0.adjacency.get(&c_id) {
                 let neighbors: &[u32] = &*adj;
@@ -502,21 +1841,145 @@ impl Provider {
                     if !visited.insert(neighbor) {
                         continue;
                     }
-                    if let Some(vec) = get_vec(neighbor) {
+                    if let Some(vec) = Self::vector_at(&vecs, dim, neighbor) {
                         let dist = crate::distance::compute_distance(metric, query, vec);
+                        tally.distance_computations += 1;
+                        if allowed.contains(neighbor) {
+                            Self::insert_match(&mut matches, k, dist, neighbor);
+                        }
                         Self::insert_result_batch(&mut result, &mut candidates, l, dist, neighbor);
                     }
                 }
             }
         }
 
-        result
+        tally.visited = visited.len() as u64;
+        self.0.stats.record(&tally);
+        matches
+            .into_iter()
+            .map(|(dist, id)| (id as u64, dist))
+            .collect()
+    }
+
+    /// Exact top-k over the labels in `allowed` (pre-filter strategy).
+    /// Cost is linear in the number of allowed labels, not the index size.
+    pub fn flat_search_filtered(
+        &self,
+        query: &[f32],
+        k: usize,
+        metric: crate::index_manager::Metric,
+        allowed: LabelBitmap<'_>,
+    ) -> Vec<(u64, f32)> {
+        use std::collections::BinaryHeap;
+
+        if k == 0 || self.len() == 0 {
+            return Vec::new();
+        }
+
+        let dim = self.0.dimension;
+        let n_vecs = self.0.count.load(std::sync::atomic::Ordering::Relaxed);
+        if self.vectors_evicted() {
+            return self.flat_search_evicted(query, k, metric, allowed);
+        }
+        if !self.0.fully_resident.load(Ordering::Acquire) {
+            for id in allowed.iter().take_while(|&id| id < n_vecs) {
+                self.0.ensure_resident(id);
+            }
+        }
+        let vecs = self.0.vectors.read();
+
+        // Max-heap on distance: the root is the current k-th best
+        let mut heap: BinaryHeap<(FloatOrd, u32)> = BinaryHeap::with_capacity(k + 1);
+        let mut scanned = 0u64;
+        for id in allowed.iter() {
+            if id >= n_vecs {
+                break;
+            }
+            let offset = id as usize * dim;
+            if offset + dim > vecs.len() {
+                break;
+            }
+            let dist = crate::distance::compute_distance(metric, query, &vecs[offset..offset + dim]);
+            scanned += 1;
+            if heap.len() < k {
+                heap.push((FloatOrd(dist), id));
+            } else if let Some(&(FloatOrd(worst), _)) = heap.peek() {
+                if dist < worst {
+                    heap.pop();
+                    heap.push((FloatOrd(dist), id));
+                }
+            }
+        }
+
+        self.record_flat_scan(scanned);
+        heap.into_sorted_vec()
+            .into_iter()
+            .map(|(FloatOrd(dist), id)| (id as u64, dist))
+            .collect()
+    }
+
+    /// `flat_search_filtered` once vectors are evicted: each allowed vector is read
+    /// back from storage (the pre-filter is only chosen for small allowed sets).
+    fn flat_search_evicted(
+        &self,
+        query: &[f32],
+        k: usize,
+        metric: crate::index_manager::Metric,
+        allowed: LabelBitmap<'_>,
+    ) -> Vec<(u64, f32)> {
+        let n_vecs = self.0.count.load(Ordering::Relaxed);
+        let mut buf = vec![0.0f32; self.0.dimension];
+        let mut matches: Vec<(f32, u32)> = Vec::with_capacity(k + 1);
+        let mut scanned = 0u64;
+        for id in allowed.iter().take_while(|&id| id < n_vecs) {
+            if self.0.read_vector(id, &mut buf) {
+                let dist = crate::distance::compute_distance(metric, query, &buf);
+                scanned += 1;
+                Self::insert_match(&mut matches, k, dist, id);
+            }
+        }
+        self.record_flat_scan(scanned);
+        matches
             .into_iter()
-            .take(k)
             .map(|(dist, id)| (id as u64, dist))
             .collect()
     }
 
+    /// An exact scan: every scored vector is one distance and one visited node, no hops.
+    fn record_flat_scan(&self, scanned: u64) {
+        self.0.stats.record(&SearchTally {
+            searches: 1,
+            distance_computations: scanned,
+            visited: scanned,
+            ..Default::default()
+        });
+    }
+
+    /// Slice of vector `id` in the flat storage, if present.
+    #[inline]
+    fn vector_at(vecs: &[f32], dim: usize, id: u32) -> Option<&[f32]> {
+        let offset = id as usize * dim;
+        let end = offset + dim;
+        if end <= vecs.len() {
+            Some(&vecs[offset..end])
+        } else {
+            None
+        }
+    }
+
+    #[inline]
+    fn insert_match(matches: &mut Vec<(f32, u32)>, k: usize, dist: f32, id: u32) {
+        if matches.len() < k || dist < matches[matches.len() - 1].0 {
+            let pos = matches
+                .binary_search_by(|probe| {
+                    probe.0.partial_cmp(&dist).unwrap_or(std::cmp::Ordering::Equal)
+                })
+                .unwrap_or_else(|e| e);
+            matches.insert(pos, (dist, id));
+            matches.truncate(k);
+        }
+    }
+
     #[inline]
     fn insert_result_batch(
         result: &mut Vec<(f32, u32)>,
@@ -553,6 +2016,23 @@ impl Provider {
 
     /// Write flat vectors to a writer (for serialization).
     pub fn write_vectors_to(&self, w: &mut dyn Write) -> std::io::Result<()> {
+        if self.vectors_evicted() {
+            let dim = self.0.dimension;
+            let mut buf = vec![0.0f32; PAGE_NODES as usize * dim];
+            let count = self.len() as u32;
+            for start in (0..count).step_by(PAGE_NODES as usize) {
+                let n = self.export_evicted_vectors(start, PAGE_NODES.min(count - start), &mut buf);
+                if n != PAGE_NODES.min(count - start) as usize {
+                    let page = start / PAGE_NODES;
+                    return Err(std::io::Error::other(format!("failed to read vectors of page {}", page)));
+                }
+                let bytes: &[u8] =
+                    unsafe { std::slice::from_raw_parts(buf.as_ptr() as *const u8, n * dim * 4) };
+                w.write_all(bytes)?;
+            }
+            return Ok(());
+        }
+        self.0.ensure_all_resident();
         let vecs = self.0.vectors.read();
         let count = self.0.count.load(Ordering::Relaxed) as usize;
         let total = count * self.0.dimension;
@@ -565,6 +2045,7 @@ impl Provider {
     /// Write fixed-width padded adjacency to a writer.
     /// Each node gets exactly `max_degree` u32 slots, unused padded with u32::MAX.
     pub fn write_adjacency_to(&self, w: &mut dyn Write, max_degree: usize) -> std::io::Result<()> {
+        self.0.ensure_all_resident();
         let count = self.0.count.load(Ordering::Relaxed) as usize;
         let sentinel = u32::MAX;
         let mut row = vec![sentinel; max_degree];
@@ -584,6 +2065,86 @@ impl Provider {
         Ok(())
     }
 
+    /// Visit every node in id order with its vector and adjacency (for the sector-aligned
+    /// file layout, which interleaves the two). Works a page at a time, so an evicted or
+    /// paged-out index is never materialized whole.
+    pub fn for_each_node(
+        &self,
+        f: &mut dyn FnMut(&[f32], &[u32]) -> std::io::Result<()>,
+    ) -> std::io::Result<()> {
+        let dim = self.0.dimension;
+        let max_degree = self.0.max_degree;
+        let count = self.len() as u32;
+        let mut vecs = vec![0.0f32; PAGE_NODES as usize * dim];
+        let mut adj = vec![u32::MAX; PAGE_NODES as usize * max_degree];
+        for start in (0..count).step_by(PAGE_NODES as usize) {
+            let n = PAGE_NODES.min(count - start);
+            if self.export_vectors(start, n, &mut vecs) != n as usize
+                || self.export_adjacency(start, n, max_degree, &mut adj) != n as usize
+            {
+                let page = start / PAGE_NODES;
+                return Err(std::io::Error::other(format!("failed to read page {}", page)));
+            }
+            for i in 0..n as usize {
+                let row = &adj[i * max_degree..(i + 1) * max_degree];
+                let len = row.iter().position(|&x| x == u32::MAX).unwrap_or(max_degree);
+                f(&vecs[i * dim..(i + 1) * dim], &row[..len])?;
+            }
+        }
+        Ok(())
+    }
+
+    /// Store node `id` with its vector (and SQ8/PQ/half-width code) and adjacency, as an insert
+    /// does before linking it; both pages are marked dirty.
+    pub fn write_node(&self, id: u32, element: &[f32], neighbors: &[u32]) {
+        // New nodes can land on a persisted tail page: load it before writing into it
+        self.0.ensure_resident(id);
+        // Checked before the vectors lock: never take the half-width lock while holding it
+        let half_only = self.0.half.read().is_some();
+        {
+            let mut vecs = self.0.vectors.write();
+            if self.0.vectors_evicted.load(Ordering::Acquire) {
+                // The half-width code written below is the node's only copy
+                if !half_only {
+                    self.0.pending_vectors.insert(id, element.into());
+                }
+            } else {
+                let offset = id as usize * self.0.dimension;
+                if vecs.len() < offset + self.0.dimension {
+                    vecs.resize(offset + self.0.dimension, 0.0);
+                }
+                vecs[offset..offset + self.0.dimension].copy_from_slice(element);
+            }
+            // Under the lock: eviction keeps the vectors of dirty pages
+            self.0.mark_vector_dirty(id);
+        }
+        if let Some(q) = self.0.quantized.write().as_mut() {
+            q.encode(id, element);
+        }
+        if let Some(pq) = self.0.pq.write().as_mut() {
+            let cs = pq.codebook.code_size();
+            let offset = id as usize * cs;
+            if pq.codes.len() < offset + cs {
+                pq.codes.resize(offset + cs, 0);
+            }
+            pq.codebook.encode(element, &mut pq.codes[offset..offset + cs]);
+        }
+        if let Some(h) = self.0.half.write().as_mut() {
+            h.encode(id, element);
+        }
+        let mut adj = AdjacencyList::new();
+        adj.extend_from_slice(neighbors);
+        self.0.put_adjacency(id, adj);
+        self.0.mark_adjacency_dirty(id);
+        self.0.count.fetch_max(id + 1, Ordering::Relaxed);
+    }
+
+    /// Replace the out-edges of an existing node. Returns false if `id` has none.
+    pub fn replace_neighbors(&self, id: u32, neighbors: &[u32]) -> bool {
+        self.0.ensure_resident(id);
+        self.0.set_adjacency(id, neighbors, false)
+    }
+
     /// Expose start point IDs for serialization.
     pub fn get_entry_points(&self) -> Vec<u32> {
         self.0.start_point_ids.read().clone()
@@ -675,10 +2236,15 @@ impl provider::Delete for Provider {
         _context: &DefaultContext,
         id: u32,
     ) -> Result<provider::ElementStatus, Self::Error> {
-        if (id as usize) < self.len() {
-            Ok(provider::ElementStatus::Valid)
+        if (id as usize) >= self.len() {
+            return Err(ProviderError(id));
+        }
+        // Deleted entry points stay Valid: consolidation keeps repairing their
+        // out-edges since every search starts there (results still skip them)
+        if self.is_deleted(id) && !self.0.start_point_ids.read().contains(&id) {
+            Ok(provider::ElementStatus::Deleted)
         } else {
-            Err(ProviderError(id))
+            Ok(provider::ElementStatus::Valid)
         }
     }
 
@@ -706,16 +2272,7 @@ impl provider::SetElement<[f32]> for Provider {
         id: &u32,
         element: &[f32],
     ) -> Result<Self::Guard, Self::SetError> {
-        {
-            let mut vecs = self.0.vectors.write();
-            let offset = *id as usize * self.0.dimension;
-            if vecs.len() < offset + self.0.dimension {
-                vecs.resize(offset + self.0.dimension, 0.0);
-            }
-            vecs[offset..offset + self.0.dimension].copy_from_slice(element);
-        }
-        self.0.adjacency.insert(*id, AdjacencyList::new());
-        self.0.count.fetch_max(*id + 1, Ordering::Relaxed);
+        self.write_node(*id, element, &[]);
         Ok(provider::NoopGuard::new(*id))
     }
 }
@@ -751,6 +2308,7 @@ impl provider::NeighborAccessor for NeighborHandle<'_> {
         id: Self::Id,
         neighbors: &mut AdjacencyList<Self::Id>,
     ) -> ANNResult<Self> {
+        self.inner.ensure_resident(id);
         match self.inner.adjacency.get(&id) {
             Some(adj) => {
                 neighbors.overwrite_trusted(&adj);
@@ -763,23 +2321,20 @@ impl provider::NeighborAccessor for NeighborHandle<'_> {
 
 impl provider::NeighborAccessorMut for NeighborHandle<'_> {
     async fn set_neighbors(self, id: Self::Id, neighbors: &[Self::Id]) -> ANNResult<Self> {
-        match self.inner.adjacency.get_mut(&id) {
-            Some(mut adj) => {
-                adj.clear();
-                adj.extend_from_slice(neighbors);
-                Ok(self)
-            }
-            None => Err(ANNError::opaque(ProviderError(id))),
+        self.inner.ensure_resident(id);
+        if self.inner.set_adjacency(id, neighbors, false) {
+            Ok(self)
+        } else {
+            Err(ANNError::opaque(ProviderError(id)))
         }
     }
 
     async fn append_vector(self, id: Self::Id, neighbors: &[Self::Id]) -> ANNResult<Self> {
-        match self.inner.adjacency.get_mut(&id) {
-            Some(mut adj) => {
-                adj.extend_from_slice(neighbors);
-                Ok(self)
-            }
-            None => Err(ANNError::opaque(ProviderError(id))),
+        self.inner.ensure_resident(id);
+        if self.inner.set_adjacency(id, neighbors, true) {
+            Ok(self)
+        } else {
+            Err(ANNError::opaque(ProviderError(id)))
         }
     }
 }
@@ -815,9 +2370,18 @@ impl provider::Accessor for ProviderAccessor<'_> {
     type GetError = ProviderError;
 
     async fn get_element(&mut self, id: u32) -> Result<&[f32], ProviderError> {
+        if !self.inner.ensure_resident(id) {
+            return Err(ProviderError(id));
+        }
         let dim = self.inner.dimension;
         let offset = id as usize * dim;
 
+        // Vectors written since the last eviction
+        if let Some(v) = self.inner.pending_vectors.get(&id) {
+            self.buffer.copy_from_slice(&v);
+            return Ok(&*self.buffer);
+        }
+
         // Try full precision first
         {
             let vecs = self.inner.vectors.read();
@@ -841,6 +2405,10 @@ impl provider::Accessor for ProviderAccessor<'_> {
             }
         }
 
+        // Evicted vectors: read back from storage
+        if self.inner.read_vector(id, &mut self.buffer) {
+            return Ok(&*self.buffer);
+        }
         Err(ProviderError(id))
     }
 }
@@ -900,6 +2468,53 @@ impl<'a> glue::AsElement<&'a [f32]> for ProviderAccessor<'a> {
     }
 }
 
+// ==================
+// Post-processing
+// ==================
+
+/// Copies the best candidates to the output, skipping tombstoned labels. Deleted
+/// nodes stay in the graph and route the search, so only `l_search` candidates are
+/// ever considered, regardless of how many labels are deleted.
+#[derive(Debug, Default, Clone, Copy)]
+pub struct SkipTombstones;
+
+impl<'a> glue::SearchPostProcess<ProviderAccessor<'a>, [f32]> for SkipTombstones {
+    type Error = Infallible;
+
+    fn post_process<I, B>(
+        &self,
+        accessor: &mut ProviderAccessor<'a>,
+        _query: &[f32],
+        _computer: &<f32 as VectorRepr>::QueryDistance,
+        candidates: I,
+        output: &mut B,
+    ) -> impl std::future::Future<Output = Result<usize, Self::Error>> + Send
+    where
+        I: Iterator<Item = Neighbor<u32>> + Send,
+        B: SearchOutputBuffer<u32> + Send + ?Sized,
+    {
+        let count = if accessor.inner.num_tombstones.load(Ordering::Relaxed) == 0 {
+            output.extend(candidates.map(|n| (n.id, n.distance)))
+        } else {
+            let tombstones = accessor.inner.tombstones.read();
+            let deleted = LabelBitmap::new(&tombstones);
+            let mut skipped = 0u64;
+            let count = output.extend(
+                candidates
+                    .filter(|n| {
+                        let live = !deleted.contains(n.id);
+                        skipped += u64::from(!live);
+                        live
+                    })
+                    .map(|n| (n.id, n.distance)),
+            );
+            accessor.inner.stats.record(&SearchTally { deleted_filtered: skipped, ..Default::default() });
+            count
+        };
+        std::future::ready(Ok(count))
+    }
+}
+
 // ==================
 // Strategy
 // ==================
@@ -915,7 +2530,7 @@ impl FullPrecisionStrategy {
 
 impl glue::SearchStrategy<Provider, [f32]> for FullPrecisionStrategy {
     type QueryComputer = <f32 as VectorRepr>::QueryDistance;
-    type PostProcessor = glue::CopyIds;
+    type PostProcessor = SkipTombstones;
     type SearchAccessorError = Infallible;
     type SearchAccessor<'a> = ProviderAccessor<'a>;
 
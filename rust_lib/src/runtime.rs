@@ -1,17 +1,131 @@
-use std::sync::LazyLock;
-use tokio::runtime::Runtime;
-
-static RUNTIME: LazyLock<Runtime> = LazyLock::new(|| {
-    let threads = std::thread::available_parallelism()
-        .map(|n| n.get())
-        .unwrap_or(4);
-    tokio::runtime::Builder::new_multi_thread()
-        .worker_threads(threads)
-        .enable_all()
-        .build()
-        .expect("Failed to create tokio runtime")
-});
-
-pub fn block_on<F: std::future::Future>(f: F) -> F::Output {
-    RUNTIME.block_on(f)
+//! Execution of the crate's async DiskANN calls without a runtime of our own.
+//!
+//! Graph operations over the in-memory provider never wait on I/O, so their futures
+//! are driven to completion right on the calling (DuckDB) thread by `run`. Work that
+//! should use more than one core is cut into tasks and handed to the caller's
+//! scheduler through a `ParallelFor` callback: on the C++ side that is DuckDB's
+//! `TaskScheduler`, so `SET threads` bounds it. Without a callback the tasks run inline.
+
+use std::ffi::c_void;
+use std::future::Future;
+use std::panic::{catch_unwind, AssertUnwindSafe};
+use std::pin::pin;
+use std::sync::{Arc, Mutex};
+use std::task::{Context, Poll, Wake, Waker};
+use std::thread::Thread;
+
+use anyhow::{anyhow, Result};
+use diskann::{utils::async_tools::TaskPool, ANNError};
+
+struct ThreadWaker(Thread);
+
+impl Wake for ThreadWaker {
+    fn wake(self: Arc<Self>) {
+        self.0.unpark();
+    }
+
+    fn wake_by_ref(self: &Arc<Self>) {
+        self.0.unpark();
+    }
+}
+
+thread_local! {
+    // One waker per thread, so `run` itself allocates nothing
+    static THREAD_WAKER: Waker = Waker::from(Arc::new(ThreadWaker(std::thread::current())));
+}
+
+/// Drive `future` to completion on the current thread, parking it while the future is pending.
+pub fn run<F: Future>(future: F) -> F::Output {
+    let mut future = pin!(future);
+    THREAD_WAKER.with(|waker| {
+        let mut cx = Context::from_waker(waker);
+        loop {
+            if let Poll::Ready(out) = future.as_mut().poll(&mut cx) {
+                return out;
+            }
+            std::thread::park();
+        }
+    })
+}
+
+/// One task of a parallel loop: `body(body_ctx, i)`.
+pub type TaskBody = unsafe extern "C" fn(body_ctx: *mut c_void, i: u64);
+
+/// Run `body(body_ctx, i)` for every i in [0, n) and return once all of them have finished.
+pub type ParallelFor = unsafe extern "C" fn(ctx: *mut c_void, n: u64, body: TaskBody, body_ctx: *mut c_void);
+
+/// The caller's scheduler, as passed over FFI.
+#[derive(Clone, Copy)]
+pub struct Scheduler {
+    run: Option<ParallelFor>,
+    ctx: *mut c_void,
+}
+
+// The callback is required to be callable from any thread
+unsafe impl Send for Scheduler {}
+unsafe impl Sync for Scheduler {}
+
+impl Scheduler {
+    /// Run every task inline on the calling thread.
+    pub const INLINE: Scheduler = Scheduler {
+        run: None,
+        ctx: std::ptr::null_mut(),
+    };
+
+    pub fn new(run: Option<ParallelFor>, ctx: *mut c_void) -> Self {
+        Self { run, ctx }
+    }
+
+    /// Run `task(i)` for i in 0..n, on the scheduler's threads when there is one.
+    /// Returns the first error (or panic) of any task once all have finished.
+    pub fn for_each<F>(&self, n: usize, task: F) -> Result<()>
+    where
+        F: Fn(usize) -> Result<()> + Sync,
+    {
+        let run = match self.run {
+            Some(run) if n > 1 => run,
+            _ => return (0..n).try_for_each(task),
+        };
+
+        struct Body<'a, F> {
+            task: &'a F,
+            error: Mutex<Option<anyhow::Error>>,
+        }
+        unsafe extern "C" fn trampoline<F: Fn(usize) -> Result<()> + Sync>(body_ctx: *mut c_void, i: u64) {
+            let body = &*(body_ctx as *const Body<F>);
+            // Neither errors nor panics may unwind into the C++ scheduler
+            let outcome = catch_unwind(AssertUnwindSafe(|| (body.task)(i as usize)))
+                .unwrap_or_else(|_| Err(anyhow!("DiskANN task {} panicked", i)));
+            if let Err(e) = outcome {
+                body.error.lock().unwrap_or_else(|p| p.into_inner()).get_or_insert(e);
+            }
+        }
+
+        let body = Body {
+            task: &task,
+            error: Mutex::new(None),
+        };
+        unsafe {
+            run(self.ctx, n as u64, trampoline::<F>, &body as *const Body<F> as *mut c_void);
+        }
+        match body.error.into_inner().unwrap_or_else(|p| p.into_inner()) {
+            Some(e) => Err(e),
+            None => Ok(()),
+        }
+    }
+}
+
+/// Lets the crate's `multi_insert_on` fork its phases onto the scheduler.
+impl TaskPool for Scheduler {
+    fn for_each(&self, ntasks: usize, task: &(dyn Fn(usize) + Sync)) -> std::result::Result<(), ANNError> {
+        Scheduler::for_each(self, ntasks, |i| {
+            task(i);
+            Ok(())
+        })
+        .map_err(ANNError::log_index_error)
+    }
+
+    fn block_on<F: Future>(&self, future: F) -> F::Output {
+        run(future)
+    }
 }
@@ -0,0 +1,94 @@
+//! Per-index search counters for `ann_index_stats()`.
+//!
+//! Search loops count into a local `SearchTally` and publish it once per search,
+//! so the hot path pays one relaxed atomic add per counter and search. Each
+//! publish also adds to the recording thread's tally, which the host takes after
+//! every search call for the per-query counters of `EXPLAIN ANALYZE`.
+
+use std::cell::Cell;
+use std::sync::atomic::{AtomicU64, Ordering};
+
+/// Counts of one search call (or a snapshot of the running totals).
+#[derive(Debug, Default, Clone, Copy)]
+pub struct SearchTally {
+    /// Queries searched.
+    pub searches: u64,
+    /// Distances computed, full precision or on codes (re-ranking included).
+    pub distance_computations: u64,
+    /// Candidates whose neighbor list was expanded.
+    pub hops: u64,
+    /// Distinct nodes scored.
+    pub visited: u64,
+    /// Tombstoned candidates skipped while collecting results.
+    pub deleted_filtered: u64,
+    /// Lock-step batch iterations whose distances ran on the GPU.
+    pub gpu_dispatches: u64,
+    /// Lock-step batch iterations whose distances ran on the CPU.
+    pub cpu_dispatches: u64,
+}
+
+impl SearchTally {
+    fn plus(self, other: &SearchTally) -> SearchTally {
+        SearchTally {
+            searches: self.searches + other.searches,
+            distance_computations: self.distance_computations + other.distance_computations,
+            hops: self.hops + other.hops,
+            visited: self.visited + other.visited,
+            deleted_filtered: self.deleted_filtered + other.deleted_filtered,
+            gpu_dispatches: self.gpu_dispatches + other.gpu_dispatches,
+            cpu_dispatches: self.cpu_dispatches + other.cpu_dispatches,
+        }
+    }
+}
+
+thread_local! {
+    /// Everything this thread recorded since the last `take_thread_tally`. Searches run
+    /// on the calling thread (see `runtime::run`), so this is exactly the host's call.
+    static THREAD_TALLY: Cell<SearchTally> = Cell::new(SearchTally::default());
+}
+
+/// The counters recorded by this thread since the previous call, reset to zero.
+pub fn take_thread_tally() -> SearchTally {
+    THREAD_TALLY.with(|tally| tally.take())
+}
+
+#[derive(Debug, Default)]
+pub struct SearchStats {
+    searches: AtomicU64,
+    distance_computations: AtomicU64,
+    hops: AtomicU64,
+    visited: AtomicU64,
+    deleted_filtered: AtomicU64,
+    gpu_dispatches: AtomicU64,
+    cpu_dispatches: AtomicU64,
+}
+
+impl SearchStats {
+    pub fn record(&self, tally: &SearchTally) {
+        let add = |counter: &AtomicU64, value: u64| {
+            if value > 0 {
+                counter.fetch_add(value, Ordering::Relaxed);
+            }
+        };
+        add(&self.searches, tally.searches);
+        add(&self.distance_computations, tally.distance_computations);
+        add(&self.hops, tally.hops);
+        add(&self.visited, tally.visited);
+        add(&self.deleted_filtered, tally.deleted_filtered);
+        add(&self.gpu_dispatches, tally.gpu_dispatches);
+        add(&self.cpu_dispatches, tally.cpu_dispatches);
+        THREAD_TALLY.with(|thread| thread.set(thread.get().plus(tally)));
+    }
+
+    pub fn snapshot(&self) -> SearchTally {
+        SearchTally {
+            searches: self.searches.load(Ordering::Relaxed),
+            distance_computations: self.distance_computations.load(Ordering::Relaxed),
+            hops: self.hops.load(Ordering::Relaxed),
+            visited: self.visited.load(Ordering::Relaxed),
+            deleted_filtered: self.deleted_filtered.load(Ordering::Relaxed),
+            gpu_dispatches: self.gpu_dispatches.load(Ordering::Relaxed),
+            cpu_dispatches: self.cpu_dispatches.load(Ordering::Relaxed),
+        }
+    }
+}
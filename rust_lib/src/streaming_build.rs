@@ -8,7 +8,7 @@
 //!   native insert (bidirectional edges, pruning, connectivity).
 
 use std::fs::File;
-use std::io::{self, BufReader, Read, Write};
+use std::io::{self, BufReader, BufWriter, Read, Write};
 
 use anyhow::{anyhow, Result};
 
@@ -109,10 +109,11 @@ pub fn streaming_build(
     // Write output .diskann file
     // ========================================
 
-    let bytes = pilot.serialize_to_bytes()?;
-    let mut output = File::create(output_path)
+    let output = File::create(output_path)
         .map_err(|e| anyhow!("Failed to create output '{}': {}", output_path, e))?;
-    output.write_all(&bytes)?;
+    let mut writer = BufWriter::new(output);
+    pilot.write_disk_file(&mut writer)?;
+    writer.flush()?;
 
     Ok(StreamingBuildResult {
         num_vectors: n,
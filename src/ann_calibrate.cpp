@@ -0,0 +1,301 @@
+#include "ann_extension.hpp"
+#include "diskann_index.hpp"
+#include "duckdb/catalog/catalog_entry/duck_table_entry.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/storage/data_table.hpp"
+
+#ifdef FAISS_AVAILABLE
+#include "faiss_index.hpp"
+#endif
+
+#include <cmath>
+#include <functional>
+
+namespace duckdb {
+
+// ========================================
+// ann_calibrate(table, index, target_recall := 0.95, sample := 1000)
+// Finds, per k bucket, the smallest search_complexity (DISKANN) or nprobe (FAISS IVF) whose
+// recall against exact ground truth reaches target_recall, and stores it with the index:
+// searches that do not pass their own value use it from then on.
+// Returns: (k INTEGER, parameter VARCHAR, value INTEGER, recall DOUBLE)
+// ========================================
+
+static constexpr int32_t CALIBRATION_K_BUCKETS[] = {1, 10, 100};
+static constexpr int32_t DISKANN_COMPLEXITY_LADDER[] = {16, 24, 32, 48, 64, 96, 128, 192, 256, 384, 512, 768, 1024};
+
+using AnnResults = vector<pair<row_t, float>>;
+
+// Engine-neutral view of the index being calibrated
+struct CalibrationTarget {
+	string parameter;
+	idx_t live_count = 0;
+	// Ascending parameter values worth trying for k
+	std::function<vector<int32_t>(int32_t k)> candidates;
+	std::function<AnnResults(const float *query, int32_t k)> exact;
+	std::function<vector<AnnResults>(const vector<vector<float>> &queries, int32_t k, int32_t value)> search;
+	std::function<void(vector<pair<int32_t, int32_t>> points)> store;
+};
+
+struct CalibrationRow {
+	int32_t k;
+	int32_t value;
+	double recall;
+};
+
+struct AnnCalibrateBindData : public TableFunctionData {
+	string table_name;
+	string index_name;
+	double target_recall = 0.95;
+	idx_t sample = 1000;
+};
+
+struct AnnCalibrateState : public GlobalTableFunctionState {
+	string parameter;
+	vector<CalibrationRow> rows;
+	idx_t offset = 0;
+	bool calibrated = false;
+	idx_t MaxThreads() const override {
+		return 1;
+	}
+};
+
+static unique_ptr<FunctionData> AnnCalibrateBind(ClientContext &context, TableFunctionBindInput &input,
+                                                 vector<LogicalType> &return_types, vector<string> &names) {
+	auto bind_data = make_uniq<AnnCalibrateBindData>();
+	bind_data->table_name = input.inputs[0].GetValue<string>();
+	bind_data->index_name = input.inputs[1].GetValue<string>();
+
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "target_recall") {
+			bind_data->target_recall = kv.second.GetValue<double>();
+			if (bind_data->target_recall <= 0 || bind_data->target_recall > 1) {
+				throw InvalidInputException("ann_calibrate: target_recall must be in (0, 1]");
+			}
+		} else if (kv.first == "sample") {
+			auto sample = kv.second.GetValue<int64_t>();
+			if (sample <= 0) {
+				throw InvalidInputException("ann_calibrate: sample must be > 0");
+			}
+			bind_data->sample = static_cast<idx_t>(sample);
+		}
+	}
+
+	return_types.push_back(LogicalType::INTEGER);
+	return_types.push_back(LogicalType::VARCHAR);
+	return_types.push_back(LogicalType::INTEGER);
+	return_types.push_back(LogicalType::DOUBLE);
+	names.push_back("k");
+	names.push_back("parameter");
+	names.push_back("value");
+	names.push_back("recall");
+	return std::move(bind_data);
+}
+
+static unique_ptr<GlobalTableFunctionState> AnnCalibrateInit(ClientContext &context, TableFunctionInitInput &input) {
+	return make_uniq<AnnCalibrateState>();
+}
+
+// Mean fraction of each query's exact top-k that was found. Results tied with the k-th
+// exact distance count as found: which of several equidistant rows comes back is arbitrary.
+static double MeasureRecall(const vector<AnnResults> &truth, const vector<AnnResults> &found, idx_t k) {
+	double total = 0;
+	idx_t measured = 0;
+	for (idx_t qi = 0; qi < truth.size(); qi++) {
+		auto expected = MinValue<idx_t>(k, truth[qi].size());
+		if (expected == 0) {
+			continue;
+		}
+		auto threshold = truth[qi][expected - 1].second;
+		auto slack = 1e-5f * std::abs(threshold) + 1e-6f;
+		idx_t hits = 0;
+		for (idx_t i = 0; i < found[qi].size() && i < expected; i++) {
+			if (found[qi][i].second <= threshold + slack) {
+				hits++;
+			}
+		}
+		total += static_cast<double>(hits) / static_cast<double>(expected);
+		measured++;
+	}
+	return measured == 0 ? 1.0 : total / static_cast<double>(measured);
+}
+
+static vector<CalibrationRow> RunCalibration(CalibrationTarget &target, const vector<vector<float>> &queries,
+                                             double target_recall) {
+	int32_t max_k = 0;
+	for (auto k : CALIBRATION_K_BUCKETS) {
+		if (static_cast<idx_t>(k) <= target.live_count) {
+			max_k = k;
+		}
+	}
+
+	// Exact ground truth once at the largest bucket; smaller buckets use its prefix
+	vector<AnnResults> truth;
+	truth.reserve(queries.size());
+	for (auto &query : queries) {
+		truth.push_back(target.exact(query.data(), max_k));
+	}
+
+	vector<CalibrationRow> rows;
+	for (auto k : CALIBRATION_K_BUCKETS) {
+		if (k > max_k) {
+			break;
+		}
+		CalibrationRow row {k, 0, 0};
+		for (auto value : target.candidates(k)) {
+			row.value = value;
+			row.recall = MeasureRecall(truth, target.search(queries, k, value), static_cast<idx_t>(k));
+			if (row.recall >= target_recall) {
+				break;
+			}
+		}
+		rows.push_back(row);
+	}
+
+	vector<pair<int32_t, int32_t>> points;
+	for (auto &row : rows) {
+		points.emplace_back(row.k, row.value);
+	}
+	target.store(std::move(points));
+	return rows;
+}
+
+// Query sample: evenly strided live rows of the index
+static vector<row_t> StridedSample(const vector<row_t> &live, idx_t sample) {
+	vector<row_t> picked;
+	auto n = MinValue<idx_t>(sample, live.size());
+	for (idx_t i = 0; i < n; i++) {
+		picked.push_back(live[i * live.size() / n]);
+	}
+	return picked;
+}
+
+static vector<vector<float>> SplitVectors(const vector<float> &vectors, idx_t dim) {
+	vector<vector<float>> queries;
+	for (idx_t i = 0; i < vectors.size() / dim; i++) {
+		queries.emplace_back(vectors.begin() + i * dim, vectors.begin() + (i + 1) * dim);
+	}
+	return queries;
+}
+
+static void AnnCalibrateScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind = data.bind_data->Cast<AnnCalibrateBindData>();
+	auto &state = data.global_state->Cast<AnnCalibrateState>();
+
+	if (!state.calibrated) {
+		state.calibrated = true;
+
+		auto &catalog = Catalog::GetCatalog(context, "");
+		auto &duck_table =
+		    catalog.GetEntry<TableCatalogEntry>(context, DEFAULT_SCHEMA, bind.table_name).Cast<DuckTableEntry>();
+		auto &storage = duck_table.GetStorage();
+		auto &table_info = *storage.GetDataTableInfo();
+		auto &indexes = table_info.GetIndexes();
+
+		indexes.Bind(context, table_info, DiskannIndex::TYPE_NAME);
+#ifdef FAISS_AVAILABLE
+		indexes.Bind(context, table_info, FaissIndex::TYPE_NAME);
+#endif
+
+		auto idx_ptr = indexes.Find(bind.index_name);
+		if (!idx_ptr) {
+			throw InvalidInputException("ANN index '%s' not found on table '%s'", bind.index_name, bind.table_name);
+		}
+
+		CalibrationTarget target;
+		vector<row_t> live;
+		vector<vector<float>> queries;
+
+		if (auto *diskann = dynamic_cast<DiskannIndex *>(idx_ptr.get())) {
+			auto dim = diskann->GetDimension();
+			live = diskann->GetLiveRowIds();
+			queries = SplitVectors(diskann->GetVectors(StridedSample(live, bind.sample)), dim);
+
+			target.parameter = "search_complexity";
+			target.candidates = [](int32_t k) {
+				vector<int32_t> values {k};
+				for (auto value : DISKANN_COMPLEXITY_LADDER) {
+					if (value > k) {
+						values.push_back(value);
+					}
+				}
+				return values;
+			};
+			target.exact = [diskann, dim, &live](const float *query, int32_t k) {
+				return diskann->SearchFiltered(query, dim, k, 0, live, true);
+			};
+			target.search = [diskann](const vector<vector<float>> &qs, int32_t k, int32_t value) {
+				return diskann->SearchBatch(qs, k, value);
+			};
+			target.store = [diskann](vector<pair<int32_t, int32_t>> points) {
+				diskann->GetCalibration().Set(std::move(points));
+				diskann->GetResultCache().Invalidate();
+			};
+		}
+#ifdef FAISS_AVAILABLE
+		else if (auto *faiss = dynamic_cast<FaissIndex *>(idx_ptr.get())) {
+			auto nlist = static_cast<int32_t>(faiss->GetNlist());
+			if (nlist == 0) {
+				throw InvalidInputException(
+				    "ann_calibrate: FAISS index '%s' is of type %s; only IVF indexes have an nprobe to tune",
+				    bind.index_name, faiss->GetFaissType());
+			}
+			auto dim = faiss->GetDimension();
+			live = faiss->GetLiveRowIds();
+			queries = SplitVectors(faiss->GetVectors(StridedSample(live, bind.sample)), dim);
+
+			target.parameter = "nprobe";
+			target.candidates = [nlist](int32_t) {
+				vector<int32_t> values;
+				for (int32_t value = 1; value < nlist; value *= 2) {
+					values.push_back(value);
+				}
+				values.push_back(nlist);
+				return values;
+			};
+			target.exact = [faiss, dim, &live](const float *query, int32_t k) {
+				return faiss->SearchFiltered(query, dim, k, live, true);
+			};
+			target.search = [faiss, dim](const vector<vector<float>> &qs, int32_t k, int32_t value) {
+				vector<AnnResults> results;
+				for (auto &query : qs) {
+					results.push_back(faiss->Search(query.data(), dim, k, value));
+				}
+				return results;
+			};
+			target.store = [faiss](vector<pair<int32_t, int32_t>> points) {
+				faiss->GetCalibration().Set(std::move(points));
+				faiss->GetResultCache().Invalidate();
+			};
+		}
+#endif
+		else {
+			throw InvalidInputException("ANN index '%s' not found on table '%s'", bind.index_name, bind.table_name);
+		}
+
+		target.live_count = live.size();
+		state.parameter = target.parameter;
+		state.rows = RunCalibration(target, queries, bind.target_recall);
+	}
+
+	auto count = MinValue<idx_t>(state.rows.size() - state.offset, STANDARD_VECTOR_SIZE);
+	for (idx_t i = 0; i < count; i++) {
+		auto &row = state.rows[state.offset + i];
+		output.data[0].SetValue(i, Value::INTEGER(row.k));
+		output.data[1].SetValue(i, Value(state.parameter));
+		output.data[2].SetValue(i, Value::INTEGER(row.value));
+		output.data[3].SetValue(i, Value::DOUBLE(row.recall));
+	}
+	state.offset += count;
+	output.SetCardinality(count);
+}
+
+void RegisterAnnCalibrateFunction(ExtensionLoader &loader) {
+	TableFunction func("ann_calibrate", {LogicalType::VARCHAR, LogicalType::VARCHAR}, AnnCalibrateScan,
+	                   AnnCalibrateBind, AnnCalibrateInit);
+	func.named_parameters["target_recall"] = LogicalType::DOUBLE;
+	func.named_parameters["sample"] = LogicalType::BIGINT;
+	loader.RegisterFunction(func);
+}
+
+} // namespace duckdb
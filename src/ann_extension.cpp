@@ -29,6 +29,7 @@ static void LoadInternal(ExtensionLoader &loader) {
 	// DiskANN functions
 	RegisterDiskannIndexScanFunction(loader);
 	RegisterDiskannStreamingBuildFunction(loader);
+	RegisterDiskannConsolidateFunction(loader);
 
 #ifdef FAISS_AVAILABLE
 	// ========================================
@@ -53,11 +54,26 @@ static void LoadInternal(ExtensionLoader &loader) {
 	// Unified listing (always available)
 	RegisterAnnListFunction(loader);
 
+	// Search instrumentation (always available)
+	RegisterAnnIndexStatsFunction(loader);
+
+	// Search parameter calibration (always available)
+	RegisterAnnCalibrateFunction(loader);
+
 	// Extension settings
 	auto &config = DBConfig::GetConfig(db);
 	config.AddExtensionOption("ann_overfetch_multiplier",
-	                          "Multiplier for ANN index scan overfetch when filters are present (default 3)",
+	                          "Candidate multiplier for post-filtered ANN index scans (default 3)",
 	                          LogicalType::BIGINT, Value::BIGINT(3));
+	config.AddExtensionOption("ann_result_cache_size",
+	                          "Search results cached per ANN index for repeated ann_search queries (default 0 = off)",
+	                          LogicalType::BIGINT, Value::BIGINT(0));
+	config.AddExtensionOption("ann_batch_window_us",
+	                          "Microseconds a DISKANN search waits for concurrent searches to batch with (default 0 = off)",
+	                          LogicalType::BIGINT, Value::BIGINT(0));
+	config.AddExtensionOption("ann_batch_max_queries",
+	                          "Queries that close a DISKANN search batch before its window ends (default 64)",
+	                          LogicalType::BIGINT, Value::BIGINT(64));
 
 	// Optimizer: ORDER BY array_distance(...) LIMIT k → ANN index scan
 	RegisterAnnOptimizer(db);
@@ -0,0 +1,121 @@
+#include "ann_fetch.hpp"
+
+#include "duckdb/common/vector_operations/vector_operations.hpp"
+#include "duckdb/storage/data_table.hpp"
+#include "duckdb/storage/table/scan_state.hpp"
+#include "duckdb/transaction/duck_transaction.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace duckdb {
+
+idx_t AnnFetchRows(ClientContext &context, DataTable &storage, const vector<StorageIndex> &storage_ids,
+                   const vector<idx_t> &out_cols, const row_t *row_ids, idx_t count, DataChunk &output,
+                   SelectionVector &kept) {
+	kept.Initialize(count);
+	if (count == 0) {
+		return 0;
+	}
+
+	// Results arrive in distance order: fetch in row id order instead
+	vector<idx_t> order(count);
+	std::iota(order.begin(), order.end(), 0);
+	std::stable_sort(order.begin(), order.end(), [&](idx_t a, idx_t b) { return row_ids[a] < row_ids[b]; });
+
+	Vector sorted_ids(LogicalType::ROW_TYPE, count);
+	auto sorted_data = FlatVector::GetData<row_t>(sorted_ids);
+	for (idx_t i = 0; i < count; i++) {
+		sorted_data[i] = row_ids[order[i]];
+	}
+
+	// The row id rides along: Fetch skips rows this transaction cannot see
+	auto fetch_ids = storage_ids;
+	fetch_ids.emplace_back(COLUMN_IDENTIFIER_ROW_ID);
+	vector<LogicalType> fetch_types;
+	for (auto col : out_cols) {
+		fetch_types.push_back(output.data[col].GetType());
+	}
+	fetch_types.push_back(LogicalType::ROW_TYPE);
+
+	DataChunk fetched;
+	fetched.Initialize(context, fetch_types);
+	auto &transaction = DuckTransaction::Get(context, storage.db);
+	ColumnFetchState fetch_state;
+	storage.Fetch(transaction, fetched, fetch_ids, sorted_ids, count, fetch_state);
+
+	// Fetched rows are a subsequence of sorted_ids: map each back to its result position
+	auto fetched_ids = FlatVector::GetData<row_t>(fetched.data.back());
+	vector<idx_t> position(count, DConstants::INVALID_INDEX);
+	idx_t f = 0;
+	for (idx_t i = 0; i < count && f < fetched.size(); i++) {
+		if (fetched_ids[f] == sorted_data[i]) {
+			position[order[i]] = f++;
+		}
+	}
+
+	SelectionVector sel(count);
+	idx_t n = 0;
+	for (idx_t i = 0; i < count; i++) {
+		if (position[i] != DConstants::INVALID_INDEX) {
+			sel.set_index(n, position[i]);
+			kept.set_index(n, i);
+			n++;
+		}
+	}
+
+	auto in_order = n == count && std::is_sorted(row_ids, row_ids + count);
+	for (idx_t i = 0; i < out_cols.size(); i++) {
+		if (in_order) {
+			output.data[out_cols[i]].Reference(fetched.data[i]);
+		} else {
+			output.data[out_cols[i]].Slice(fetched.data[i], sel, n);
+		}
+	}
+	return n;
+}
+
+vector<vector<float>> AnnExtractVectors(DataChunk &input, idx_t col_idx) {
+	auto &column = input.data[col_idx];
+	auto count = input.size();
+	vector<vector<float>> result(count);
+	if (count == 0) {
+		return result;
+	}
+
+	UnifiedVectorFormat rows;
+	column.ToUnifiedFormat(count, rows);
+	auto is_array = column.GetType().id() == LogicalTypeId::ARRAY;
+	auto array_size = is_array ? ArrayType::GetSize(column.GetType()) : 0;
+	auto &child = is_array ? ArrayVector::GetEntry(column) : ListVector::GetEntry(column);
+	auto child_count = is_array ? ArrayVector::GetTotalSize(column) : ListVector::GetListSize(column);
+
+	// Elements of another numeric type are cast to FLOAT once for the whole chunk
+	unique_ptr<Vector> cast;
+	if (child.GetType().id() != LogicalTypeId::FLOAT) {
+		cast = make_uniq<Vector>(LogicalType::FLOAT, child_count);
+		VectorOperations::DefaultCast(child, *cast, child_count);
+	}
+	UnifiedVectorFormat elements;
+	(cast ? *cast : child).ToUnifiedFormat(child_count, elements);
+	auto data = UnifiedVectorFormat::GetData<float>(elements);
+	auto entries = is_array ? nullptr : UnifiedVectorFormat::GetData<list_entry_t>(rows);
+
+	for (idx_t i = 0; i < count; i++) {
+		auto row = rows.sel->get_index(i);
+		if (!rows.validity.RowIsValid(row)) {
+			continue;
+		}
+		auto offset = is_array ? row * array_size : entries[row].offset;
+		auto length = is_array ? array_size : entries[row].length;
+		auto &vec = result[i];
+		vec.resize(length);
+		for (idx_t e = 0; e < length; e++) {
+			auto element = elements.sel->get_index(offset + e);
+			vec[e] = elements.validity.RowIsValid(element) ? data[element] : 0.0f;
+		}
+	}
+	return result;
+}
+
+} // namespace duckdb
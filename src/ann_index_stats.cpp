@@ -0,0 +1,208 @@
+#include "ann_extension.hpp"
+#include "ann_search_stats.hpp"
+#include "diskann_index.hpp"
+#include "duckdb/catalog/catalog.hpp"
+#include "duckdb/catalog/catalog_entry/duck_table_entry.hpp"
+#include "duckdb/catalog/catalog_entry/index_catalog_entry.hpp"
+#include "duckdb/catalog/catalog_entry/schema_catalog_entry.hpp"
+#include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
+#include "duckdb/storage/data_table.hpp"
+
+#ifdef FAISS_AVAILABLE
+#include "faiss_index.hpp"
+#endif
+
+namespace duckdb {
+
+AnnSearchCounters GetAnnSearchCounters(BoundIndex &index) {
+	if (index.GetIndexType() == DiskannIndex::TYPE_NAME) {
+		return index.Cast<DiskannIndex>().GetSearchCounters();
+	}
+#ifdef FAISS_AVAILABLE
+	if (index.GetIndexType() == FaissIndex::TYPE_NAME) {
+		return index.Cast<FaissIndex>().GetSearchCounters();
+	}
+#endif
+	return AnnSearchCounters();
+}
+
+void AnnSearchCountersToString(const AnnSearchCounters &counters, InsertionOrderPreservingMap<string> &result) {
+	result["ANN Searches"] = to_string(counters.searches);
+	result["Distance Computations"] = to_string(counters.distance_computations);
+	if (counters.hops > 0 || counters.visited > 0) {
+		result["Graph Hops"] = to_string(counters.hops);
+		result["Visited Nodes"] = to_string(counters.visited);
+	}
+	result["Deleted Filtered"] = to_string(counters.deleted_filtered);
+	if (counters.gpu_dispatches > 0) {
+		result["GPU Dispatches"] = to_string(counters.gpu_dispatches);
+	}
+	if (counters.cpu_dispatches > 0) {
+		result["CPU Dispatches"] = to_string(counters.cpu_dispatches);
+	}
+	result["Engine Time"] = StringUtil::Format("%.3fms", static_cast<double>(counters.engine_nanos) / 1e6);
+}
+
+// ========================================
+// ann_index_stats()
+// Search counters of every ANN index since it was loaded. Only indexes already bound
+// (searched or written to in this session) have counters; the rest report zeros.
+// ========================================
+
+struct AnnIndexStatsEntry {
+	string name;
+	string engine;
+	string table_name;
+	AnnSearchCounters counters;
+	// DISKANN query batcher (ann_batch_window_us); FAISS does not batch
+	idx_t batches = 0;
+	idx_t batched_queries = 0;
+	// DISKANN index merges (transaction-local appends at commit): graph stitches and re-inserts
+	idx_t stitched_merges = 0;
+	idx_t reinserted_merges = 0;
+};
+
+static void ReadSearchCounters(ClientContext &context, IndexCatalogEntry &index_entry, const string &schema,
+                               AnnIndexStatsEntry &e) {
+	auto table_entry = Catalog::GetEntry<TableCatalogEntry>(context, index_entry.catalog.GetName(), schema,
+	                                                        e.table_name, OnEntryNotFound::RETURN_NULL);
+	if (!table_entry || !table_entry->IsDuckTable()) {
+		return;
+	}
+	auto &storage = table_entry->Cast<DuckTableEntry>().GetStorage();
+	storage.GetDataTableInfo()->GetIndexes().Scan([&](Index &index) {
+		if (!index.IsBound() || index.GetIndexName() != e.name) {
+			return false;
+		}
+		e.counters = GetAnnSearchCounters(index.Cast<BoundIndex>());
+		if (index.GetIndexType() == DiskannIndex::TYPE_NAME) {
+			auto counts = index.Cast<DiskannIndex>().GetBatchCounts();
+			e.batches = counts.first;
+			e.batched_queries = counts.second;
+			auto merges = index.Cast<DiskannIndex>().GetMergeCounts();
+			e.stitched_merges = merges.first;
+			e.reinserted_merges = merges.second;
+		}
+		return true;
+	});
+}
+
+struct AnnIndexStatsState : public GlobalTableFunctionState {
+	vector<AnnIndexStatsEntry> entries;
+	idx_t position = 0;
+	idx_t MaxThreads() const override {
+		return 1;
+	}
+};
+
+static unique_ptr<FunctionData> AnnIndexStatsBind(ClientContext &context, TableFunctionBindInput &input,
+                                                  vector<LogicalType> &return_types, vector<string> &names) {
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("name");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("engine");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("table_name");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("searches");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("distance_computations");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("graph_hops");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("visited_nodes");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("deleted_filtered");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("gpu_dispatches");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("cpu_dispatches");
+	return_types.push_back(LogicalType::DOUBLE);
+	names.push_back("engine_ms");
+	return_types.push_back(LogicalType::DOUBLE);
+	names.push_back("latency_p50_us");
+	return_types.push_back(LogicalType::DOUBLE);
+	names.push_back("latency_p99_us");
+	return_types.push_back(LogicalType::LIST(LogicalType::UBIGINT));
+	names.push_back("latency_histogram");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("batches");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("batched_queries");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("stitched_merges");
+	return_types.push_back(LogicalType::BIGINT);
+	names.push_back("reinserted_merges");
+	return make_uniq<TableFunctionData>();
+}
+
+static unique_ptr<GlobalTableFunctionState> AnnIndexStatsInit(ClientContext &context, TableFunctionInitInput &input) {
+	auto state = make_uniq<AnnIndexStatsState>();
+
+	auto schemas = Catalog::GetAllSchemas(context);
+	for (auto &schema : schemas) {
+		schema.get().Scan(context, CatalogType::INDEX_ENTRY, [&](CatalogEntry &entry) {
+			auto &index_entry = entry.Cast<IndexCatalogEntry>();
+			auto &idx_type = index_entry.index_type;
+			if (idx_type == "DISKANN" || idx_type == "FAISS") {
+				AnnIndexStatsEntry e;
+				e.name = index_entry.name;
+				e.engine = idx_type;
+				e.table_name = index_entry.GetTableName();
+				ReadSearchCounters(context, index_entry, schema.get().name, e);
+				state->entries.push_back(std::move(e));
+			}
+		});
+	}
+
+	return std::move(state);
+}
+
+static void AnnIndexStatsScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &state = data.global_state->Cast<AnnIndexStatsState>();
+
+	if (state.position >= state.entries.size()) {
+		output.SetCardinality(0);
+		return;
+	}
+
+	idx_t chunk_size = MinValue<idx_t>(STANDARD_VECTOR_SIZE, state.entries.size() - state.position);
+
+	for (idx_t i = 0; i < chunk_size; i++) {
+		auto &entry = state.entries[state.position + i];
+		auto &c = entry.counters;
+		output.SetValue(0, i, Value(entry.name));
+		output.SetValue(1, i, Value(entry.engine));
+		output.SetValue(2, i, Value(entry.table_name));
+		output.SetValue(3, i, Value::BIGINT(static_cast<int64_t>(c.searches)));
+		output.SetValue(4, i, Value::BIGINT(static_cast<int64_t>(c.distance_computations)));
+		output.SetValue(5, i, Value::BIGINT(static_cast<int64_t>(c.hops)));
+		output.SetValue(6, i, Value::BIGINT(static_cast<int64_t>(c.visited)));
+		output.SetValue(7, i, Value::BIGINT(static_cast<int64_t>(c.deleted_filtered)));
+		output.SetValue(8, i, Value::BIGINT(static_cast<int64_t>(c.gpu_dispatches)));
+		output.SetValue(9, i, Value::BIGINT(static_cast<int64_t>(c.cpu_dispatches)));
+		output.SetValue(10, i, Value::DOUBLE(static_cast<double>(c.engine_nanos) / 1e6));
+		output.SetValue(11, i, Value::DOUBLE(c.LatencyQuantileMicros(0.5)));
+		output.SetValue(12, i, Value::DOUBLE(c.LatencyQuantileMicros(0.99)));
+		vector<Value> buckets;
+		buckets.reserve(AnnSearchCounters::LATENCY_BUCKETS);
+		for (auto count : c.latency_histogram) {
+			buckets.push_back(Value::UBIGINT(count));
+		}
+		output.SetValue(13, i, Value::LIST(LogicalType::UBIGINT, std::move(buckets)));
+		output.SetValue(14, i, Value::BIGINT(static_cast<int64_t>(entry.batches)));
+		output.SetValue(15, i, Value::BIGINT(static_cast<int64_t>(entry.batched_queries)));
+		output.SetValue(16, i, Value::BIGINT(static_cast<int64_t>(entry.stitched_merges)));
+		output.SetValue(17, i, Value::BIGINT(static_cast<int64_t>(entry.reinserted_merges)));
+	}
+
+	state.position += chunk_size;
+	output.SetCardinality(chunk_size);
+}
+
+void RegisterAnnIndexStatsFunction(ExtensionLoader &loader) {
+	TableFunction func("ann_index_stats", {}, AnnIndexStatsScan, AnnIndexStatsBind, AnnIndexStatsInit);
+	loader.RegisterFunction(func);
+}
+
+} // namespace duckdb
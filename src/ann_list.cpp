@@ -22,8 +22,47 @@ struct AnnListEntry {
 	string name;
 	string engine;
 	string table_name;
+	int64_t cache_hits = 0;
+	int64_t cache_misses = 0;
+	int64_t evictions = 0; // memory released for another index
+	int64_t reloads = 0;   // pages and vectors read back from storage
 };
 
+// Result cache and memory counters of an index that is already bound; never loads one
+static void ReadCacheStats(ClientContext &context, IndexCatalogEntry &index_entry, const string &schema,
+                           AnnListEntry &e) {
+	auto table_entry = Catalog::GetEntry<TableCatalogEntry>(context, index_entry.catalog.GetName(), schema,
+	                                                        e.table_name, OnEntryNotFound::RETURN_NULL);
+	if (!table_entry || !table_entry->IsDuckTable()) {
+		return;
+	}
+	auto &storage = table_entry->Cast<DuckTableEntry>().GetStorage();
+	storage.GetDataTableInfo()->GetIndexes().Scan([&](Index &index) {
+		if (!index.IsBound() || index.GetIndexName() != e.name) {
+			return false;
+		}
+		AnnResultCache *cache = nullptr;
+		if (e.engine == "DISKANN") {
+			auto &diskann = index.Cast<DiskannIndex>();
+			cache = &diskann.GetResultCache();
+			e.evictions = static_cast<int64_t>(diskann.GetEvictions());
+			e.reloads = static_cast<int64_t>(diskann.GetPageLoads());
+		}
+#ifdef FAISS_AVAILABLE
+		else if (e.engine == "FAISS") {
+			auto &faiss = index.Cast<FaissIndex>();
+			cache = &faiss.GetResultCache();
+			e.evictions = static_cast<int64_t>(faiss.GetEvictions());
+		}
+#endif
+		if (cache) {
+			e.cache_hits = static_cast<int64_t>(cache->Hits());
+			e.cache_misses = static_cast<int64_t>(cache->Misses());
+		}
+		return true;
+	});
+}
+
 struct AnnListState : public GlobalTableFunctionState {
 	vector<AnnListEntry> entries;
 	idx_t position = 0;
@@ -37,9 +76,17 @@ static unique_ptr<FunctionData> AnnListBind(ClientContext &context, TableFunctio
 	return_types.push_back(LogicalType::VARCHAR);
 	return_types.push_back(LogicalType::VARCHAR);
 	return_types.push_back(LogicalType::VARCHAR);
+	return_types.push_back(LogicalType::BIGINT);
+	return_types.push_back(LogicalType::BIGINT);
+	return_types.push_back(LogicalType::BIGINT);
+	return_types.push_back(LogicalType::BIGINT);
 	names.push_back("name");
 	names.push_back("engine");
 	names.push_back("table_name");
+	names.push_back("cache_hits");
+	names.push_back("cache_misses");
+	names.push_back("evictions");
+	names.push_back("reloads");
 	return make_uniq<TableFunctionData>();
 }
 
@@ -56,6 +103,7 @@ static unique_ptr<GlobalTableFunctionState> AnnListInit(ClientContext &context,
 				e.name = index_entry.name;
 				e.engine = idx_type;
 				e.table_name = index_entry.GetTableName();
+				ReadCacheStats(context, index_entry, schema.get().name, e);
 				state->entries.push_back(std::move(e));
 			}
 		});
@@ -79,6 +127,10 @@ static void AnnListScan(ClientContext &context, TableFunctionInput &data, DataCh
 		output.SetValue(0, i, Value(entry.name));
 		output.SetValue(1, i, Value(entry.engine));
 		output.SetValue(2, i, Value(entry.table_name));
+		output.SetValue(3, i, Value::BIGINT(entry.cache_hits));
+		output.SetValue(4, i, Value::BIGINT(entry.cache_misses));
+		output.SetValue(5, i, Value::BIGINT(entry.evictions));
+		output.SetValue(6, i, Value::BIGINT(entry.reloads));
 	}
 
 	state.position += chunk_size;
@@ -110,6 +162,8 @@ void RegisterAnnListFunction(ExtensionLoader &loader) {
 		names.push_back("memory_bytes");
 		return_types.push_back(LogicalType::BOOLEAN);
 		names.push_back("quantized");
+		return_types.push_back(LogicalType::VARCHAR);
+		names.push_back("calibration");
 		return make_uniq<TableFunctionData>();
 	};
 
@@ -121,6 +175,7 @@ void RegisterAnnListFunction(ExtensionLoader &loader) {
 		int64_t num_deleted = 0;
 		int64_t memory_bytes = 0;
 		bool quantized = false;
+		string calibration; // ann_calibrate result, "k:value,..."
 	};
 
 	struct InfoState : public GlobalTableFunctionState {
@@ -175,7 +230,8 @@ void RegisterAnnListFunction(ExtensionLoader &loader) {
 							e.num_deleted = static_cast<int64_t>(diskann.GetDeletedCount());
 							auto &bound = static_cast<BoundIndex &>(diskann);
 							e.memory_bytes = static_cast<int64_t>(bound.GetInMemorySize());
-							e.quantized = diskann.IsQuantized();
+							e.quantized = diskann.SearchesCodes();
+							e.calibration = diskann.GetCalibration().ToString();
 						}
 #ifdef FAISS_AVAILABLE
 						else if (idx_type == "FAISS") {
@@ -184,6 +240,7 @@ void RegisterAnnListFunction(ExtensionLoader &loader) {
 							e.num_deleted = static_cast<int64_t>(faiss.GetDeletedCount());
 							auto &bound = static_cast<BoundIndex &>(faiss);
 							e.memory_bytes = static_cast<int64_t>(bound.GetInMemorySize());
+							e.calibration = faiss.GetCalibration().ToString();
 						}
 #endif
 					}
@@ -212,6 +269,7 @@ void RegisterAnnListFunction(ExtensionLoader &loader) {
 			output.SetValue(4, i, Value::BIGINT(e.num_deleted));
 			output.SetValue(5, i, Value::BIGINT(e.memory_bytes));
 			output.SetValue(6, i, Value::BOOLEAN(e.quantized));
+			output.SetValue(7, i, e.calibration.empty() ? Value(LogicalType::VARCHAR) : Value(e.calibration));
 		}
 		state.position += chunk_size;
 		output.SetCardinality(chunk_size);
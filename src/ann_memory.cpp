@@ -0,0 +1,144 @@
+#include "ann_memory.hpp"
+
+#include "duckdb/common/exception.hpp"
+#include "duckdb/common/mutex.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace duckdb {
+
+struct AnnMemoryReservation::State {
+	State(BufferManager &buffer_manager, std::function<idx_t()> release)
+	    : buffer_manager(buffer_manager), release(std::move(release)) {
+	}
+
+	BufferManager &buffer_manager;
+	std::function<idx_t()> release;
+	// Guards reserved and open; held while the reservation changes, so a release attempt on
+	// an index that is itself reserving is skipped rather than waited for
+	mutex lock;
+	idx_t reserved = 0;
+	bool open = true;
+	std::atomic<uint64_t> last_used {0};
+	std::atomic<idx_t> evictions {0};
+};
+
+// Every open reservation, for finding cold indexes to release
+static mutex registry_lock;
+static vector<weak_ptr<AnnMemoryReservation::State>> registry;
+// Recency clock for last_used
+static std::atomic<uint64_t> use_clock {0};
+
+// Ask the least recently used indexes on buffer_manager (other than self) to release memory
+// until needed bytes are freed. Returns the bytes freed.
+static idx_t ReleaseColdIndexes(const AnnMemoryReservation::State &self, idx_t needed) {
+	vector<shared_ptr<AnnMemoryReservation::State>> candidates;
+	{
+		lock_guard<mutex> guard(registry_lock);
+		for (auto it = registry.begin(); it != registry.end();) {
+			auto state = it->lock();
+			if (!state) {
+				it = registry.erase(it);
+				continue;
+			}
+			if (state.get() != &self && &state->buffer_manager == &self.buffer_manager) {
+				candidates.push_back(std::move(state));
+			}
+			++it;
+		}
+	}
+	std::sort(candidates.begin(), candidates.end(),
+	          [](const shared_ptr<AnnMemoryReservation::State> &a, const shared_ptr<AnnMemoryReservation::State> &b) {
+		          return a->last_used.load() < b->last_used.load();
+	          });
+
+	idx_t freed = 0;
+	for (auto &state : candidates) {
+		if (freed >= needed) {
+			break;
+		}
+		unique_lock<mutex> guard(state->lock, std::try_to_lock);
+		if (!guard.owns_lock() || !state->open || state->reserved == 0) {
+			continue;
+		}
+		idx_t released = 0;
+		try {
+			released = MinValue(state->release(), state->reserved);
+		} catch (std::exception &) {
+			// A failed release (e.g. a write error) frees nothing; the index keeps its data
+			continue;
+		}
+		if (released == 0) {
+			continue;
+		}
+		state->buffer_manager.FreeReservedMemory(released);
+		state->reserved -= released;
+		state->evictions++;
+		freed += released;
+	}
+	return freed;
+}
+
+AnnMemoryReservation::AnnMemoryReservation(DatabaseInstance &db, std::function<idx_t()> release)
+    : state_(make_shared_ptr<State>(BufferManager::GetBufferManager(db), std::move(release))) {
+	state_->last_used = ++use_clock;
+	lock_guard<mutex> guard(registry_lock);
+	registry.push_back(state_);
+}
+
+AnnMemoryReservation::~AnnMemoryReservation() {
+	Close();
+}
+
+void AnnMemoryReservation::Update(idx_t bytes) {
+	auto &state = *state_;
+	lock_guard<mutex> guard(state.lock);
+	if (!state.open || bytes == state.reserved) {
+		return;
+	}
+	if (bytes < state.reserved) {
+		state.buffer_manager.FreeReservedMemory(state.reserved - bytes);
+		state.reserved = bytes;
+		return;
+	}
+	auto extra = bytes - state.reserved;
+	try {
+		state.buffer_manager.ReserveMemory(extra);
+	} catch (OutOfMemoryException &) {
+		if (ReleaseColdIndexes(state, extra) == 0) {
+			throw;
+		}
+		state.buffer_manager.ReserveMemory(extra);
+	}
+	state.reserved = bytes;
+}
+
+void AnnMemoryReservation::Close() {
+	auto &state = *state_;
+	lock_guard<mutex> guard(state.lock);
+	if (!state.open) {
+		return;
+	}
+	state.open = false;
+	if (state.reserved > 0) {
+		state.buffer_manager.FreeReservedMemory(state.reserved);
+		state.reserved = 0;
+	}
+}
+
+void AnnMemoryReservation::Touch() {
+	state_->last_used = ++use_clock;
+}
+
+idx_t AnnMemoryReservation::Reserved() const {
+	lock_guard<mutex> guard(state_->lock);
+	return state_->reserved;
+}
+
+idx_t AnnMemoryReservation::Evictions() const {
+	return state_->evictions.load();
+}
+
+} // namespace duckdb
@@ -1,7 +1,11 @@
 // ANN index scan optimizer: rewrites ORDER BY array_distance(...) LIMIT k
-// to use DISKANN/FAISS index scan instead of full table scan.
+// to use DISKANN/FAISS index scan instead of full table scan, and per-row
+// top-k joins (LATERAL ... ORDER BY distance LIMIT k, QUALIFY row_number())
+// into one batched index search per input chunk.
 
 #include "ann_extension.hpp"
+#include "ann_fetch.hpp"
+#include "ann_search_stats.hpp"
 #include "diskann_index.hpp"
 
 #ifdef FAISS_AVAILABLE
@@ -11,26 +15,64 @@
 #include "duckdb/catalog/catalog_entry/duck_table_entry.hpp"
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
 #include "duckdb/common/types/vector.hpp"
+#include "duckdb/execution/expression_executor.hpp"
 #include "duckdb/function/table_function.hpp"
+#include "duckdb/optimizer/column_binding_replacer.hpp"
 #include "duckdb/optimizer/optimizer_extension.hpp"
 #include "duckdb/planner/expression/bound_cast_expression.hpp"
 #include "duckdb/planner/expression/bound_columnref_expression.hpp"
+#include "duckdb/planner/expression/bound_comparison_expression.hpp"
+#include "duckdb/planner/expression/bound_conjunction_expression.hpp"
 #include "duckdb/planner/expression/bound_constant_expression.hpp"
 #include "duckdb/planner/expression/bound_function_expression.hpp"
+#include "duckdb/planner/expression/bound_operator_expression.hpp"
+#include "duckdb/planner/expression/bound_reference_expression.hpp"
+#include "duckdb/planner/expression/bound_window_expression.hpp"
+#include "duckdb/planner/expression_iterator.hpp"
+#include "duckdb/planner/filter/constant_filter.hpp"
+#include "duckdb/planner/operator/logical_filter.hpp"
 #include "duckdb/planner/operator/logical_get.hpp"
 #include "duckdb/planner/operator/logical_limit.hpp"
 #include "duckdb/planner/operator/logical_order.hpp"
 #include "duckdb/planner/operator/logical_projection.hpp"
+#include "duckdb/planner/operator/logical_window.hpp"
+#include "duckdb/planner/table_filter.hpp"
 #include "duckdb/storage/data_table.hpp"
+#include "duckdb/storage/statistics/numeric_stats.hpp"
 #include "duckdb/storage/table/scan_state.hpp"
 #include "duckdb/transaction/duck_transaction.hpp"
 
+#include <algorithm>
+#include <numeric>
+#include <unordered_set>
+
 namespace duckdb {
 
 // ========================================
 // AnnIndexScan: replacement table function
 // ========================================
 
+// How a WHERE clause under the ANN ORDER BY is applied
+enum class AnnFilterStrategy : uint8_t {
+	NONE,          // no filter
+	PRE_FILTER,    // evaluate predicate to a row-id set, score every match exactly
+	IN_TRAVERSAL,  // evaluate predicate to a row-id set, skip non-matches during index search
+	POST_FILTER    // oversampled index search, predicate applied to the candidates
+};
+
+static const char *FilterStrategyName(AnnFilterStrategy strategy) {
+	switch (strategy) {
+	case AnnFilterStrategy::PRE_FILTER:
+		return "pre";
+	case AnnFilterStrategy::IN_TRAVERSAL:
+		return "in-traversal";
+	case AnnFilterStrategy::POST_FILTER:
+		return "post";
+	default:
+		return "none";
+	}
+}
+
 struct AnnIndexScanBindData : public TableFunctionData {
 	DuckTableEntry *table_entry = nullptr;
 	string index_name;
@@ -43,11 +85,26 @@ struct AnnIndexScanBindData : public TableFunctionData {
 
 	// Column mapping for DataTable::Fetch()
 	vector<StorageIndex> storage_ids;
+
+	// Pushed-down WHERE predicate. filter_expr references columns by position in
+	// filter_ids; the last entry of filter_ids is always the row-id column.
+	AnnFilterStrategy filter_strategy = AnnFilterStrategy::NONE;
+	unique_ptr<Expression> filter_expr;
+	vector<StorageIndex> filter_ids;
+	vector<LogicalType> filter_types;
+	idx_t oversample = 1;
+
+	// partition_by: the WHERE clause fixed the partition value, so only its child is searched
+	bool has_partition = false;
+	Value partition_key;
 };
 
 struct AnnIndexScanGlobalState : public GlobalTableFunctionState {
 	vector<pair<row_t, float>> results;
 	idx_t offset = 0;
+	// Growth of the index's counters over all post-filter rounds (concurrent queries on the
+	// same index included), for EXPLAIN ANALYZE
+	AnnSearchCounters searched;
 
 	idx_t MaxThreads() const override {
 		return 1;
@@ -59,6 +116,197 @@ static unique_ptr<FunctionData> AnnIndexScanBind(ClientContext &, TableFunctionB
 	throw InternalException("AnnIndexScan bind should not be called directly — set by optimizer");
 }
 
+// ========================================
+// Filter evaluation helpers
+// ========================================
+
+// Post-filter doubles the oversample factor this many times before switching to in-traversal
+static constexpr idx_t MAX_POST_FILTER_ROUNDS = 3;
+
+static void CollectPassingRowIds(DataChunk &chunk, ExpressionExecutor &executor, SelectionVector &sel,
+                                 vector<row_t> &out) {
+	auto passed = executor.SelectExpression(chunk, sel);
+	auto &rowid_vec = chunk.data.back();
+	rowid_vec.Flatten(chunk.size());
+	auto rowid_data = FlatVector::GetData<row_t>(rowid_vec);
+	for (idx_t i = 0; i < passed; i++) {
+		out.push_back(rowid_data[sel.get_index(i)]);
+	}
+}
+
+// A `column <cmp> constant` conjunct of the predicate as a table filter on the scan
+static void PushConjunctTableFilter(const Expression &expr, const vector<LogicalType> &filter_types,
+                                    TableFilterSet &filters) {
+	if (expr.GetExpressionClass() != ExpressionClass::BOUND_COMPARISON) {
+		return;
+	}
+	auto &cmp = expr.Cast<BoundComparisonExpression>();
+	auto comparison = expr.type;
+	const Expression *column = cmp.left.get();
+	const Expression *constant = cmp.right.get();
+	if (column->type == ExpressionType::VALUE_CONSTANT) {
+		std::swap(column, constant);
+		comparison = FlipComparisonExpression(comparison);
+	}
+	if (column->type != ExpressionType::BOUND_REF || constant->type != ExpressionType::VALUE_CONSTANT) {
+		return;
+	}
+	switch (comparison) {
+	case ExpressionType::COMPARE_EQUAL:
+	case ExpressionType::COMPARE_LESSTHAN:
+	case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+	case ExpressionType::COMPARE_GREATERTHAN:
+	case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+		break;
+	default:
+		return;
+	}
+	auto slot = column->Cast<BoundReferenceExpression>().index;
+	auto &value = constant->Cast<BoundConstantExpression>().value;
+	if (value.IsNull() || value.type() != filter_types[slot] || !filter_types[slot].IsNumeric()) {
+		return;
+	}
+	filters.PushFilter(ColumnIndex(slot), make_uniq<ConstantFilter>(comparison, value));
+}
+
+// Scan the filter columns of the whole table and return the row ids matching the predicate.
+// Comparisons against constants are pushed into the scan as table filters, so row groups
+// whose zone maps exclude them are skipped unread; the full predicate still runs on the rest.
+static vector<row_t> EvaluateFilterRowIds(ClientContext &context, const AnnIndexScanBindData &bind_data) {
+	auto &storage = bind_data.table_entry->GetStorage();
+	auto &transaction = DuckTransaction::Get(context, storage.db);
+
+	TableFilterSet table_filters;
+	auto &filter_expr = *bind_data.filter_expr;
+	if (filter_expr.type == ExpressionType::CONJUNCTION_AND) {
+		for (auto &child : filter_expr.Cast<BoundConjunctionExpression>().children) {
+			PushConjunctTableFilter(*child, bind_data.filter_types, table_filters);
+		}
+	} else {
+		PushConjunctTableFilter(filter_expr, bind_data.filter_types, table_filters);
+	}
+
+	TableScanState scan_state;
+	storage.InitializeScan(context, transaction, scan_state, bind_data.filter_ids,
+	                       table_filters.filters.empty() ? nullptr : &table_filters);
+
+	DataChunk chunk;
+	chunk.Initialize(context, bind_data.filter_types);
+	ExpressionExecutor executor(context, *bind_data.filter_expr);
+	SelectionVector sel(STANDARD_VECTOR_SIZE);
+
+	vector<row_t> row_ids;
+	while (true) {
+		chunk.Reset();
+		storage.Scan(transaction, chunk, scan_state);
+		if (chunk.size() == 0) {
+			break;
+		}
+		CollectPassingRowIds(chunk, executor, sel, row_ids);
+	}
+	return row_ids;
+}
+
+// Keep only the candidates whose rows satisfy the predicate, preserving distance order
+static void ApplyPostFilter(ClientContext &context, const AnnIndexScanBindData &bind_data,
+                            vector<pair<row_t, float>> &candidates) {
+	auto &storage = bind_data.table_entry->GetStorage();
+	auto &transaction = DuckTransaction::Get(context, storage.db);
+
+	DataChunk chunk;
+	chunk.Initialize(context, bind_data.filter_types);
+	ExpressionExecutor executor(context, *bind_data.filter_expr);
+	SelectionVector sel(STANDARD_VECTOR_SIZE);
+
+	vector<row_t> passing;
+	for (idx_t offset = 0; offset < candidates.size(); offset += STANDARD_VECTOR_SIZE) {
+		auto batch_size = MinValue<idx_t>(candidates.size() - offset, STANDARD_VECTOR_SIZE);
+		Vector row_ids_vec(LogicalType::ROW_TYPE, batch_size);
+		auto row_ids_data = FlatVector::GetData<row_t>(row_ids_vec);
+		for (idx_t i = 0; i < batch_size; i++) {
+			row_ids_data[i] = candidates[offset + i].first;
+		}
+		chunk.Reset();
+		ColumnFetchState fetch_state;
+		storage.Fetch(transaction, chunk, bind_data.filter_ids, row_ids_vec, batch_size, fetch_state);
+		CollectPassingRowIds(chunk, executor, sel, passing);
+	}
+
+	std::unordered_set<row_t> passing_set(passing.begin(), passing.end());
+	idx_t out = 0;
+	for (auto &cand : candidates) {
+		if (passing_set.count(cand.first) > 0) {
+			candidates[out++] = cand;
+		}
+	}
+	candidates.resize(out);
+}
+
+// Unfiltered search, or the two row-id-set strategies when allowed_rowids is given
+static vector<pair<row_t, float>> RunIndexSearch(ClientContext &context, BoundIndex &index,
+                                                 const AnnIndexScanBindData &bind_data, idx_t k,
+                                                 const vector<row_t> *allowed_rowids, bool exhaustive) {
+	auto query = bind_data.query_vector.get();
+	auto dim = static_cast<int32_t>(bind_data.vector_size);
+	auto k32 = static_cast<int32_t>(MinValue<idx_t>(k, static_cast<idx_t>(NumericLimits<int32_t>::Maximum())));
+	if (bind_data.is_diskann) {
+		auto &diskann_idx = index.Cast<DiskannIndex>();
+		if (bind_data.has_partition) {
+			return diskann_idx.SearchPartition(context, bind_data.partition_key, query, dim, k32,
+			                                   bind_data.search_complexity, allowed_rowids, exhaustive);
+		}
+		if (allowed_rowids) {
+			return diskann_idx.SearchFiltered(query, dim, k32, bind_data.search_complexity, *allowed_rowids,
+			                                  exhaustive);
+		}
+		return diskann_idx.GetResultCache().Get(context, query, dim, k32, bind_data.search_complexity, 0, [&]() {
+			return diskann_idx.SearchCoalesced(context, query, dim, k32, bind_data.search_complexity);
+		});
+	}
+#ifdef FAISS_AVAILABLE
+	auto &faiss_idx = index.Cast<FaissIndex>();
+	if (bind_data.has_partition) {
+		return faiss_idx.SearchPartition(context, bind_data.partition_key, query, dim, k32, allowed_rowids,
+		                                 exhaustive);
+	}
+	if (allowed_rowids) {
+		return faiss_idx.SearchFiltered(query, dim, k32, *allowed_rowids, exhaustive);
+	}
+	return faiss_idx.GetResultCache().Get(context, query, dim, k32, 0, faiss_idx.GetNprobe(),
+	                                      [&]() { return faiss_idx.Search(query, dim, k32); });
+#else
+	return {};
+#endif
+}
+
+static vector<pair<row_t, float>> RunFilteredSearch(ClientContext &context, BoundIndex &index,
+                                                    const AnnIndexScanBindData &bind_data) {
+	auto k = bind_data.limit;
+	auto strategy = bind_data.filter_strategy;
+
+	if (strategy == AnnFilterStrategy::POST_FILTER) {
+		auto oversample = MaxValue<idx_t>(bind_data.oversample, 1);
+		for (idx_t round = 0; round <= MAX_POST_FILTER_ROUNDS; round++) {
+			auto fetch_k = k * oversample;
+			auto results = RunIndexSearch(context, index, bind_data, fetch_k, nullptr, false);
+			auto index_exhausted = results.size() < fetch_k;
+			ApplyPostFilter(context, bind_data, results);
+			if (results.size() >= k || index_exhausted) {
+				if (results.size() > k) {
+					results.resize(k);
+				}
+				return results;
+			}
+			oversample *= 2;
+		}
+		// Selectivity was overestimated: fall back to filtering inside the traversal
+		strategy = AnnFilterStrategy::IN_TRAVERSAL;
+	}
+
+	auto allowed = EvaluateFilterRowIds(context, bind_data);
+	return RunIndexSearch(context, index, bind_data, k, &allowed, strategy == AnnFilterStrategy::PRE_FILTER);
+}
+
 static unique_ptr<GlobalTableFunctionState> AnnIndexScanInit(ClientContext &context, TableFunctionInitInput &input) {
 	auto state = make_uniq<AnnIndexScanGlobalState>();
 	auto &bind_data = input.bind_data->Cast<AnnIndexScanBindData>();
@@ -69,26 +317,27 @@ static unique_ptr<GlobalTableFunctionState> AnnIndexScanInit(ClientContext &cont
 
 	if (bind_data.is_diskann) {
 		indexes.Bind(context, table_info, DiskannIndex::TYPE_NAME);
-		auto idx_ptr = indexes.Find(bind_data.index_name);
-		if (idx_ptr) {
-			auto &diskann_idx = idx_ptr->Cast<DiskannIndex>();
-			state->results =
-			    diskann_idx.Search(bind_data.query_vector.get(), static_cast<int32_t>(bind_data.vector_size),
-			                       static_cast<int32_t>(bind_data.limit), bind_data.search_complexity);
-		}
 	}
 #ifdef FAISS_AVAILABLE
 	else {
 		indexes.Bind(context, table_info, FaissIndex::TYPE_NAME);
-		auto idx_ptr = indexes.Find(bind_data.index_name);
-		if (idx_ptr) {
-			auto &faiss_idx = idx_ptr->Cast<FaissIndex>();
-			state->results = faiss_idx.Search(bind_data.query_vector.get(), static_cast<int32_t>(bind_data.vector_size),
-			                                  static_cast<int32_t>(bind_data.limit));
-		}
 	}
 #endif
 
+	auto idx_ptr = indexes.Find(bind_data.index_name);
+	if (!idx_ptr) {
+		return std::move(state);
+	}
+	// Only this scan's searches count, not other queries running against the index
+	AnnSearchTally tally;
+	AnnSearchTally::Scope scope(&tally);
+	if (bind_data.filter_strategy == AnnFilterStrategy::NONE) {
+		state->results = RunIndexSearch(context, *idx_ptr, bind_data, bind_data.limit, nullptr, false);
+	} else {
+		state->results = RunFilteredSearch(context, *idx_ptr, bind_data);
+	}
+	state->searched = tally.Get();
+
 	return std::move(state);
 }
 
@@ -104,21 +353,20 @@ static void AnnIndexScanScan(ClientContext &context, TableFunctionInput &data, D
 
 	auto batch_size = MinValue<idx_t>(remaining, STANDARD_VECTOR_SIZE);
 
-	// Build row_id vector
-	Vector row_ids_vec(LogicalType::ROW_TYPE, batch_size);
-	auto row_ids_data = FlatVector::GetData<row_t>(row_ids_vec);
+	row_t row_ids[STANDARD_VECTOR_SIZE];
 	for (idx_t i = 0; i < batch_size; i++) {
-		row_ids_data[i] = state.results[state.offset + i].first;
+		row_ids[i] = state.results[state.offset + i].first;
 	}
 
-	// Fetch rows from table storage
+	// storage_ids were already pruned to the projected columns by the seq_scan rewrite
+	vector<idx_t> out_cols(bind_data.storage_ids.size());
+	std::iota(out_cols.begin(), out_cols.end(), 0);
 	auto &storage = bind_data.table_entry->GetStorage();
-	auto &transaction = DuckTransaction::Get(context, storage.db);
-	ColumnFetchState fetch_state;
-	storage.Fetch(transaction, output, bind_data.storage_ids, row_ids_vec, batch_size, fetch_state);
+	SelectionVector kept;
+	auto count = AnnFetchRows(context, storage, bind_data.storage_ids, out_cols, row_ids, batch_size, output, kept);
 
 	state.offset += batch_size;
-	output.SetCardinality(batch_size);
+	output.SetCardinality(count);
 }
 
 static unique_ptr<NodeStatistics> AnnIndexScanCardinality(ClientContext &, const FunctionData *bind_data_p) {
@@ -126,9 +374,198 @@ static unique_ptr<NodeStatistics> AnnIndexScanCardinality(ClientContext &, const
 	return make_uniq<NodeStatistics>(bind_data.limit);
 }
 
+static InsertionOrderPreservingMap<string> AnnIndexScanToString(TableFunctionDynamicToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	if (input.global_state) {
+		AnnSearchCountersToString(input.global_state->Cast<AnnIndexScanGlobalState>().searched, result);
+	}
+	return result;
+}
+
 static TableFunction GetAnnIndexScanFunction() {
 	TableFunction func("_ann_index_scan_internal", {}, AnnIndexScanScan, AnnIndexScanBind, AnnIndexScanInit);
 	func.cardinality = AnnIndexScanCardinality;
+	func.dynamic_to_string = AnnIndexScanToString;
+	func.projection_pushdown = false;
+	return func;
+}
+
+// ========================================
+// AnnKnnJoin: batched top-k per input row
+// ========================================
+
+// Replaces the seq_scan side of a cross product whose other side supplies query
+// vectors. Every input chunk is one SearchBatch; each input row is emitted once per
+// index hit, table columns (storage_ids) first, then the input columns.
+struct AnnKnnJoinBindData : public TableFunctionData {
+	DuckTableEntry *table_entry = nullptr;
+	string index_name;
+	bool is_diskann = true;
+	idx_t k = 0;
+	int32_t search_complexity = 0;
+
+	idx_t query_col = 0; // input column holding the query vector
+	vector<StorageIndex> storage_ids;
+};
+
+struct AnnKnnJoinGlobalState : public GlobalTableFunctionState {
+	optional_ptr<BoundIndex> index;
+};
+
+struct AnnKnnJoinLocalState : public LocalTableFunctionState {
+	struct Hit {
+		idx_t input_row;
+		row_t row_id;
+	};
+	vector<Hit> hits;
+	idx_t emit_offset = 0;
+	bool processed = false;
+};
+
+static unique_ptr<FunctionData> AnnKnnJoinBind(ClientContext &, TableFunctionBindInput &, vector<LogicalType> &,
+                                               vector<string> &) {
+	throw InternalException("AnnKnnJoin bind should not be called directly — set by optimizer");
+}
+
+static unique_ptr<GlobalTableFunctionState> AnnKnnJoinGlobalInit(ClientContext &context,
+                                                                 TableFunctionInitInput &input) {
+	auto state = make_uniq<AnnKnnJoinGlobalState>();
+	auto &bind_data = input.bind_data->Cast<AnnKnnJoinBindData>();
+
+	auto &storage = bind_data.table_entry->GetStorage();
+	auto &table_info = *storage.GetDataTableInfo();
+	auto &indexes = table_info.GetIndexes();
+
+	if (bind_data.is_diskann) {
+		indexes.Bind(context, table_info, DiskannIndex::TYPE_NAME);
+	}
+#ifdef FAISS_AVAILABLE
+	else {
+		indexes.Bind(context, table_info, FaissIndex::TYPE_NAME);
+	}
+#endif
+
+	state->index = indexes.Find(bind_data.index_name);
+	return std::move(state);
+}
+
+static unique_ptr<LocalTableFunctionState> AnnKnnJoinLocalInit(ExecutionContext &context,
+                                                               TableFunctionInitInput &input,
+                                                               GlobalTableFunctionState *global_state) {
+	return make_uniq<AnnKnnJoinLocalState>();
+}
+
+// One batched search over the non-NULL query vectors of the input chunk
+static void AnnKnnJoinSearch(const AnnKnnJoinBindData &bind_data, BoundIndex &index, DataChunk &input,
+                             vector<AnnKnnJoinLocalState::Hit> &hits) {
+	auto vectors = AnnExtractVectors(input, bind_data.query_col);
+	vector<vector<float>> queries;
+	vector<idx_t> query_rows;
+	for (idx_t row = 0; row < vectors.size(); row++) {
+		if (!vectors[row].empty()) {
+			queries.push_back(std::move(vectors[row]));
+			query_rows.push_back(row);
+		}
+	}
+	if (queries.empty()) {
+		return;
+	}
+
+	auto k32 =
+	    static_cast<int32_t>(MinValue<idx_t>(bind_data.k, static_cast<idx_t>(NumericLimits<int32_t>::Maximum())));
+	vector<vector<pair<row_t, float>>> results;
+	if (bind_data.is_diskann) {
+		results = index.Cast<DiskannIndex>().SearchBatch(queries, k32, bind_data.search_complexity);
+	}
+#ifdef FAISS_AVAILABLE
+	else {
+		results = index.Cast<FaissIndex>().SearchBatch(queries, k32);
+	}
+#endif
+	for (idx_t qi = 0; qi < results.size(); qi++) {
+		for (auto &pair : results[qi]) {
+			hits.push_back({query_rows[qi], pair.first});
+		}
+	}
+}
+
+static OperatorResultType AnnKnnJoinInOut(ExecutionContext &context, TableFunctionInput &data, DataChunk &input,
+                                          DataChunk &output) {
+	auto &bind_data = data.bind_data->Cast<AnnKnnJoinBindData>();
+	auto &gstate = data.global_state->Cast<AnnKnnJoinGlobalState>();
+	auto &lstate = data.local_state->Cast<AnnKnnJoinLocalState>();
+
+	if (!lstate.processed) {
+		lstate.hits.clear();
+		lstate.emit_offset = 0;
+		if (gstate.index) {
+			AnnKnnJoinSearch(bind_data, *gstate.index, input, lstate.hits);
+		}
+		lstate.processed = true;
+	}
+
+	auto remaining = lstate.hits.size() - lstate.emit_offset;
+	if (remaining == 0) {
+		output.SetCardinality(0);
+		lstate.processed = false;
+		return OperatorResultType::NEED_MORE_INPUT;
+	}
+
+	auto batch_size = MinValue<idx_t>(remaining, STANDARD_VECTOR_SIZE);
+	auto batch = lstate.hits.data() + lstate.emit_offset;
+
+	row_t row_ids[STANDARD_VECTOR_SIZE];
+	for (idx_t i = 0; i < batch_size; i++) {
+		row_ids[i] = batch[i].row_id;
+	}
+	auto n_table_cols = bind_data.storage_ids.size();
+	vector<idx_t> out_cols(n_table_cols);
+	std::iota(out_cols.begin(), out_cols.end(), 0);
+	auto &storage = bind_data.table_entry->GetStorage();
+	SelectionVector kept;
+	auto count =
+	    AnnFetchRows(context.client, storage, bind_data.storage_ids, out_cols, row_ids, batch_size, output, kept);
+
+	// Input columns, replicated per hit
+	SelectionVector input_sel(count);
+	for (idx_t i = 0; i < count; i++) {
+		input_sel.set_index(i, batch[kept.get_index(i)].input_row);
+	}
+	for (idx_t col = 0; col < input.ColumnCount(); col++) {
+		VectorOperations::Copy(input.data[col], output.data[n_table_cols + col], input_sel, count, 0, 0);
+	}
+
+	output.SetCardinality(count);
+	lstate.emit_offset += batch_size;
+	if (lstate.emit_offset >= lstate.hits.size()) {
+		lstate.processed = false;
+		return OperatorResultType::NEED_MORE_INPUT;
+	}
+	return OperatorResultType::HAVE_MORE_OUTPUT;
+}
+
+static OperatorFinalizeResultType AnnKnnJoinFinal(ExecutionContext &context, TableFunctionInput &data,
+                                                  DataChunk &output) {
+	output.SetCardinality(0);
+	return OperatorFinalizeResultType::FINISHED;
+}
+
+static InsertionOrderPreservingMap<string> AnnKnnJoinToString(TableFunctionToStringInput &input) {
+	auto &bind_data = input.bind_data->Cast<AnnKnnJoinBindData>();
+	InsertionOrderPreservingMap<string> result;
+	result["Function"] = "ANN_KNN_JOIN";
+	result["Index"] = bind_data.index_name;
+	result["k"] = to_string(bind_data.k);
+	result["Engine"] = bind_data.is_diskann ? "DISKANN" : "FAISS";
+	return result;
+}
+
+static TableFunction GetAnnKnnJoinFunction() {
+	TableFunction func("_ann_knn_join_internal", {}, nullptr, AnnKnnJoinBind, AnnKnnJoinGlobalInit,
+	                   AnnKnnJoinLocalInit);
+	func.in_out_function = AnnKnnJoinInOut;
+	func.in_out_function_final = AnnKnnJoinFinal;
+	func.to_string = AnnKnnJoinToString;
 	func.projection_pushdown = false;
 	return func;
 }
@@ -170,6 +607,157 @@ static bool HasFilterBetween(LogicalOperator &op) {
 	return false;
 }
 
+// ========================================
+// Filter pushdown: predicate rewrite + selectivity estimate
+// ========================================
+
+// Estimated matching rows at or below which pre-filtering (exact scoring of every match) wins
+static constexpr double PRE_FILTER_MAX_ROWS = 8192;
+// Fallbacks when column statistics cannot answer
+static constexpr double DEFAULT_EQ_SELECTIVITY = 0.1;
+static constexpr double DEFAULT_RANGE_SELECTIVITY = 1.0 / 3.0;
+static constexpr double DEFAULT_SELECTIVITY = 0.2;
+
+// Rewrite column refs of the scanned table into references to filter_ids slots.
+// Returns false if the predicate touches anything the index scan cannot evaluate.
+static bool RewriteFilterColumns(unique_ptr<Expression> &expr, idx_t table_index, const vector<ColumnIndex> &col_ids,
+                                 vector<StorageIndex> &filter_ids, vector<LogicalType> &filter_types) {
+	if (expr->type == ExpressionType::BOUND_COLUMN_REF) {
+		auto &ref = expr->Cast<BoundColumnRefExpression>();
+		if (ref.binding.table_index != table_index || ref.binding.column_index >= col_ids.size()) {
+			return false;
+		}
+		auto physical = col_ids[ref.binding.column_index].GetPrimaryIndex();
+		auto type = ref.return_type;
+		idx_t slot = 0;
+		while (slot < filter_ids.size() && filter_ids[slot].GetPrimaryIndex() != physical) {
+			slot++;
+		}
+		if (slot == filter_ids.size()) {
+			filter_ids.emplace_back(physical);
+			filter_types.push_back(type);
+		}
+		expr = make_uniq<BoundReferenceExpression>(type, slot);
+		return true;
+	}
+	bool ok = true;
+	ExpressionIterator::EnumerateChildren(*expr, [&](unique_ptr<Expression> &child) {
+		if (ok) {
+			ok = RewriteFilterColumns(child, table_index, col_ids, filter_ids, filter_types);
+		}
+	});
+	return ok;
+}
+
+// Selectivity of `ref = constant`-style predicates from the column's distinct count
+static double EqualitySelectivity(ClientContext &context, DuckTableEntry &table, column_t column) {
+	auto stats = table.GetStatistics(context, column);
+	if (stats) {
+		auto distinct = stats->GetDistinctCount();
+		if (distinct > 0) {
+			return 1.0 / static_cast<double>(distinct);
+		}
+	}
+	return DEFAULT_EQ_SELECTIVITY;
+}
+
+// Selectivity of `ref <op> constant` from min/max, assuming a uniform distribution
+static double RangeSelectivity(ClientContext &context, DuckTableEntry &table, column_t column, ExpressionType op,
+                               const Value &constant) {
+	auto stats = table.GetStatistics(context, column);
+	if (!stats || stats->GetStatsType() != StatisticsType::NUMERIC_STATS || !NumericStats::HasMinMax(*stats) ||
+	    constant.IsNull() || !constant.type().IsNumeric()) {
+		return DEFAULT_RANGE_SELECTIVITY;
+	}
+	auto min = NumericStats::Min(*stats).GetValue<double>();
+	auto max = NumericStats::Max(*stats).GetValue<double>();
+	if (max <= min) {
+		return DEFAULT_RANGE_SELECTIVITY;
+	}
+	auto below = MaxValue<double>(0.0, MinValue<double>(1.0, (constant.GetValue<double>() - min) / (max - min)));
+	if (op == ExpressionType::COMPARE_LESSTHAN || op == ExpressionType::COMPARE_LESSTHANOREQUALTO) {
+		return below;
+	}
+	return 1.0 - below;
+}
+
+// System-R style estimate over the rewritten predicate (BoundReference slots -> filter_ids)
+static double EstimateSelectivity(ClientContext &context, DuckTableEntry &table, const Expression &expr,
+                                  const vector<StorageIndex> &filter_ids) {
+	switch (expr.GetExpressionClass()) {
+	case ExpressionClass::BOUND_CONJUNCTION: {
+		auto &conj = expr.Cast<BoundConjunctionExpression>();
+		double sel = 1.0;
+		if (expr.type == ExpressionType::CONJUNCTION_AND) {
+			for (auto &child : conj.children) {
+				sel *= EstimateSelectivity(context, table, *child, filter_ids);
+			}
+			return sel;
+		}
+		for (auto &child : conj.children) {
+			sel *= 1.0 - EstimateSelectivity(context, table, *child, filter_ids);
+		}
+		return 1.0 - sel;
+	}
+	case ExpressionClass::BOUND_COMPARISON: {
+		auto &cmp = expr.Cast<BoundComparisonExpression>();
+		auto op = expr.type;
+		const Expression *ref = cmp.left.get();
+		const Expression *constant = cmp.right.get();
+		if (ref->type != ExpressionType::BOUND_REF) {
+			std::swap(ref, constant);
+			op = FlipComparisonExpression(op);
+		}
+		if (ref->type != ExpressionType::BOUND_REF || constant->type != ExpressionType::VALUE_CONSTANT) {
+			return DEFAULT_SELECTIVITY;
+		}
+		auto column = filter_ids[ref->Cast<BoundReferenceExpression>().index].GetPrimaryIndex();
+		switch (op) {
+		case ExpressionType::COMPARE_EQUAL:
+		case ExpressionType::COMPARE_NOT_DISTINCT_FROM:
+			return EqualitySelectivity(context, table, column);
+		case ExpressionType::COMPARE_NOTEQUAL:
+		case ExpressionType::COMPARE_DISTINCT_FROM:
+			return 1.0 - EqualitySelectivity(context, table, column);
+		case ExpressionType::COMPARE_LESSTHAN:
+		case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+		case ExpressionType::COMPARE_GREATERTHAN:
+		case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+			return RangeSelectivity(context, table, column, op, constant->Cast<BoundConstantExpression>().value);
+		default:
+			return DEFAULT_SELECTIVITY;
+		}
+	}
+	case ExpressionClass::BOUND_OPERATOR: {
+		auto &op = expr.Cast<BoundOperatorExpression>();
+		if (expr.type == ExpressionType::OPERATOR_NOT && op.children.size() == 1) {
+			return 1.0 - EstimateSelectivity(context, table, *op.children[0], filter_ids);
+		}
+		if (expr.type == ExpressionType::COMPARE_IN && !op.children.empty() &&
+		    op.children[0]->type == ExpressionType::BOUND_REF) {
+			auto column = filter_ids[op.children[0]->Cast<BoundReferenceExpression>().index].GetPrimaryIndex();
+			auto n = static_cast<double>(op.children.size() - 1);
+			return MinValue<double>(1.0, n * EqualitySelectivity(context, table, column));
+		}
+		return DEFAULT_SELECTIVITY;
+	}
+	default:
+		return DEFAULT_SELECTIVITY;
+	}
+}
+
+// Post-filter if an oversampled result is expected to hold k matches; pre-filter if
+// the matching set is small enough to score exactly; otherwise filter in traversal.
+static AnnFilterStrategy ChooseFilterStrategy(double selectivity, double cardinality, idx_t oversample) {
+	if (selectivity * static_cast<double>(oversample) >= 1.0) {
+		return AnnFilterStrategy::POST_FILTER;
+	}
+	if (cardinality > 0 && selectivity * cardinality <= PRE_FILTER_MAX_ROWS) {
+		return AnnFilterStrategy::PRE_FILTER;
+	}
+	return AnnFilterStrategy::IN_TRAVERSAL;
+}
+
 // Extract query vector from a constant expression (ARRAY or LIST of FLOAT)
 static bool ExtractQueryVectorFromConstant(const BoundConstantExpression &const_expr, vector<float> &out) {
 	auto &val = const_expr.value;
@@ -231,6 +819,8 @@ struct FoundIndex {
 	string index_type; // Flat, HNSW, IVFFlat (FAISS) or DiskANN
 	int32_t nprobe = 1;
 	FaissGpuMode mode = FaissGpuMode::AUTO;
+	// partition_by: the table column of the partition values (the index's second column)
+	column_t partition_column = DConstants::INVALID_INDEX;
 };
 
 // Map distance function name to required index metric
@@ -268,6 +858,7 @@ static bool FindAnnIndex(ClientContext &context, DuckTableEntry &duck_table, col
 	struct Candidate {
 		string name;
 		bool is_diskann;
+		vector<column_t> column_ids;
 	};
 	vector<Candidate> candidates;
 
@@ -280,7 +871,7 @@ static bool FindAnnIndex(ClientContext &context, DuckTableEntry &duck_table, col
 		auto &col_ids = idx.GetColumnIds();
 		for (auto &cid : col_ids) {
 			if (cid == physical_col) {
-				candidates.push_back({idx.GetIndexName(), type == "DISKANN"});
+				candidates.push_back({idx.GetIndexName(), type == "DISKANN", col_ids});
 				break;
 			}
 		}
@@ -294,7 +885,7 @@ static bool FindAnnIndex(ClientContext &context, DuckTableEntry &duck_table, col
 		auto &col_ids = idx.GetColumnIds();
 		for (auto &cid : col_ids) {
 			if (cid == physical_col) {
-				candidates.push_back({idx.GetIndexName(), type == "DISKANN"});
+				candidates.push_back({idx.GetIndexName(), type == "DISKANN", col_ids});
 				break;
 			}
 		}
@@ -308,6 +899,7 @@ static bool FindAnnIndex(ClientContext &context, DuckTableEntry &duck_table, col
 		string index_type;
 		int32_t nprobe = 1;
 		FaissGpuMode mode = FaissGpuMode::AUTO;
+		bool partitioned = false;
 		if (cand.is_diskann) {
 			indexes.Bind(context, table_info, DiskannIndex::TYPE_NAME);
 			auto idx_ptr = indexes.Find(cand.name);
@@ -315,6 +907,7 @@ static bool FindAnnIndex(ClientContext &context, DuckTableEntry &duck_table, col
 				auto &di = idx_ptr->Cast<DiskannIndex>();
 				metric = di.GetMetric();
 				index_type = "DiskANN";
+				partitioned = di.IsPartitioned();
 			}
 		}
 #ifdef FAISS_AVAILABLE
@@ -327,9 +920,14 @@ static bool FindAnnIndex(ClientContext &context, DuckTableEntry &duck_table, col
 				index_type = fi.GetFaissType();
 				nprobe = fi.GetNprobe();
 				mode = fi.GetGpuMode();
+				partitioned = fi.IsPartitioned();
 			}
 		}
 #endif
+		// A partitioned index orders by its first column; the second holds the partition values
+		if (partitioned && (cand.column_ids.size() != 2 || cand.column_ids[0] != physical_col)) {
+			continue;
+		}
 		if (MetricCompatible(metric, required)) {
 			result.name = cand.name;
 			result.is_diskann = cand.is_diskann;
@@ -337,6 +935,7 @@ static bool FindAnnIndex(ClientContext &context, DuckTableEntry &duck_table, col
 			result.index_type = index_type;
 			result.nprobe = nprobe;
 			result.mode = mode;
+			result.partition_column = partitioned ? cand.column_ids[1] : DConstants::INVALID_INDEX;
 			return true;
 		}
 	}
@@ -344,6 +943,59 @@ static bool FindAnnIndex(ClientContext &context, DuckTableEntry &duck_table, col
 	return false;
 }
 
+// `partition column = constant` on the scanned table of a partitioned index: key is the constant
+static bool MatchPartitionKey(const Expression &expr, const LogicalGet &get, const FoundIndex &found_idx,
+                              Value &key) {
+	if (found_idx.partition_column == DConstants::INVALID_INDEX || expr.type != ExpressionType::COMPARE_EQUAL) {
+		return false;
+	}
+	auto &cmp = expr.Cast<BoundComparisonExpression>();
+	const Expression *ref = cmp.left.get();
+	const Expression *constant = cmp.right.get();
+	if (ref->type != ExpressionType::BOUND_COLUMN_REF) {
+		std::swap(ref, constant);
+	}
+	if (ref->type != ExpressionType::BOUND_COLUMN_REF || constant->type != ExpressionType::VALUE_CONSTANT) {
+		return false;
+	}
+	auto &binding = ref->Cast<BoundColumnRefExpression>().binding;
+	auto &col_ids = get.GetColumnIds();
+	if (binding.table_index != get.table_index || binding.column_index >= col_ids.size() ||
+	    col_ids[binding.column_index].GetPrimaryIndex() != found_idx.partition_column) {
+		return false;
+	}
+	// Keys are matched by value: the constant must already have the column's type
+	auto &value = constant->Cast<BoundConstantExpression>().value;
+	if (value.IsNull() || value.type() != ref->return_type) {
+		return false;
+	}
+	key = value;
+	return true;
+}
+
+static bool IsAnnDistanceFunction(const string &fn_name) {
+	return fn_name == "array_distance" || fn_name == "list_distance" || fn_name == "array_inner_product" ||
+	       fn_name == "list_inner_product" || fn_name == "array_cosine_similarity" ||
+	       fn_name == "list_cosine_similarity";
+}
+
+// Skip the index if the table is small enough to scan, or k is a large share of it
+static bool IndexScanPaysOff(idx_t estimated_cardinality, idx_t limit_val, const FoundIndex &found_idx) {
+	if (estimated_cardinality > 0 && estimated_cardinality < 50) {
+		return false; // Full scan is cheap for small tables
+	}
+	if (limit_val > 0 && estimated_cardinality > 0) {
+		double threshold = 0.1; // default: 10%
+		if (found_idx.is_diskann || found_idx.index_type == "HNSW") {
+			threshold = 0.3; // graph indexes efficient up to ~30%
+		}
+		if (limit_val > static_cast<idx_t>(estimated_cardinality * threshold)) {
+			return false;
+		}
+	}
+	return true;
+}
+
 // Try to optimize an ORDER BY node by rewriting to ANN index scan
 static bool TryOptimizeOrderBy(ClientContext &context, unique_ptr<LogicalOperator> &op, idx_t limit_val) {
 	auto &order_by = op->Cast<LogicalOrder>();
@@ -384,9 +1036,7 @@ static bool TryOptimizeOrderBy(ClientContext &context, unique_ptr<LogicalOperato
 
 	// Check function name — support multiple distance functions
 	auto &fn_name = func_expr.function.name;
-	if (fn_name != "array_distance" && fn_name != "list_distance" && fn_name != "array_inner_product" &&
-	    fn_name != "list_inner_product" && fn_name != "array_cosine_similarity" &&
-	    fn_name != "list_cosine_similarity") {
+	if (!IsAnnDistanceFunction(fn_name)) {
 		return false;
 	}
 	if (func_expr.children.size() != 2) {
@@ -458,26 +1108,59 @@ static bool TryOptimizeOrderBy(ClientContext &context, unique_ptr<LogicalOperato
 
 	// Cost estimation: skip ANN index if table is too small or limit is too large
 	auto estimated_cardinality = target_get->EstimateCardinality(context);
-	if (estimated_cardinality > 0 && estimated_cardinality < 50) {
-		return false; // Full scan is cheap for small tables
-	}
-	if (limit_val > 0 && estimated_cardinality > 0) {
-		double threshold = 0.1; // default: 10%
-		if (found_idx.is_diskann || found_idx.index_type == "HNSW") {
-			threshold = 0.3; // graph indexes efficient up to ~30%
-		}
-		if (limit_val > static_cast<idx_t>(estimated_cardinality * threshold)) {
-			return false;
-		}
+	if (!IndexScanPaysOff(estimated_cardinality, limit_val, found_idx)) {
+		return false;
 	}
 
 	// Set limit: use the provided limit_val, or default to a reasonable number
 	idx_t k = (limit_val > 0) ? limit_val : 100;
 
-	// In pre-optimization mode, skip filtered queries — the ANN index scan
-	// replacement would break the column mapping for the FILTER node.
-	if (HasFilterBetween(projection)) {
-		return false;
+	// A WHERE clause directly on the scanned table (PROJECTION -> FILTER -> GET) is
+	// pushed into the index scan; any other filter placement still falls back.
+	// On a partitioned index, a `partition column = constant` conjunct picks the child to
+	// search instead: that child holds the value's rows alone, so the conjunct is dropped.
+	unique_ptr<Expression> filter_expr;
+	vector<StorageIndex> filter_ids;
+	vector<LogicalType> filter_types;
+	bool has_filter = HasFilterBetween(projection);
+	bool has_partition = false;
+	Value partition_key;
+	if (has_filter) {
+		auto &filter_op = projection.children[0];
+		if (filter_op->type != LogicalOperatorType::LOGICAL_FILTER || filter_op->children[0].get() != target_get) {
+			return false;
+		}
+		auto &filter = filter_op->Cast<LogicalFilter>();
+		if (filter.expressions.empty()) {
+			return false;
+		}
+		vector<unique_ptr<Expression>> predicates;
+		for (auto &expr : filter.expressions) {
+			if (expr->IsVolatile()) {
+				return false;
+			}
+			if (!has_partition && MatchPartitionKey(*expr, *target_get, found_idx, partition_key)) {
+				has_partition = true;
+				continue;
+			}
+			auto copy = expr->Copy();
+			if (!RewriteFilterColumns(copy, target_get->table_index, col_ids, filter_ids, filter_types)) {
+				return false;
+			}
+			predicates.push_back(std::move(copy));
+		}
+		if (predicates.size() == 1) {
+			filter_expr = std::move(predicates[0]);
+		} else if (predicates.size() > 1) {
+			auto conj = make_uniq<BoundConjunctionExpression>(ExpressionType::CONJUNCTION_AND);
+			conj->children = std::move(predicates);
+			filter_expr = std::move(conj);
+		}
+		if (filter_expr) {
+			// Row id travels with the filter columns so matches can be mapped back after scan/fetch
+			filter_ids.emplace_back(COLUMN_IDENTIFIER_ROW_ID);
+			filter_types.push_back(LogicalType::ROW_TYPE);
+		}
 	}
 
 	// Build the replacement bind data
@@ -488,6 +1171,8 @@ static bool TryOptimizeOrderBy(ClientContext &context, unique_ptr<LogicalOperato
 	bind_data->vector_size = query_vector.size();
 	bind_data->limit = k;
 	bind_data->search_complexity = 0;
+	bind_data->has_partition = has_partition;
+	bind_data->partition_key = partition_key;
 
 	bind_data->query_vector = make_unsafe_uniq_array<float>(query_vector.size());
 	memcpy(bind_data->query_vector.get(), query_vector.data(), query_vector.size() * sizeof(float));
@@ -498,6 +1183,29 @@ static bool TryOptimizeOrderBy(ClientContext &context, unique_ptr<LogicalOperato
 		}
 	}
 
+	double selectivity = 1.0;
+	if (filter_expr) {
+		Value overfetch;
+		idx_t oversample = 3;
+		if (context.TryGetCurrentSetting("ann_overfetch_multiplier", overfetch) && !overfetch.IsNull()) {
+			oversample = static_cast<idx_t>(MaxValue<int64_t>(1, overfetch.GetValue<int64_t>()));
+		}
+		selectivity = MaxValue<double>(0.0, MinValue<double>(1.0, EstimateSelectivity(context, duck_table,
+		                                                                                    *filter_expr, filter_ids)));
+		// The rest of the filter applies within one partition's rows
+		auto cardinality = static_cast<double>(estimated_cardinality);
+		if (has_partition) {
+			cardinality *= EqualitySelectivity(context, duck_table, found_idx.partition_column);
+		}
+		bind_data->filter_strategy = ChooseFilterStrategy(selectivity, cardinality, oversample);
+		bind_data->oversample = oversample;
+		bind_data->filter_expr = std::move(filter_expr);
+		bind_data->filter_ids = std::move(filter_ids);
+		bind_data->filter_types = std::move(filter_types);
+	}
+	auto filter_strategy = bind_data->filter_strategy;
+	auto oversample = bind_data->oversample;
+
 	// Replace the seq_scan function with our ANN index scan
 	auto engine = found_idx.is_diskann ? "DISKANN" : "FAISS";
 	target_get->function = GetAnnIndexScanFunction();
@@ -520,20 +1228,281 @@ static bool TryOptimizeOrderBy(ClientContext &context, unique_ptr<LogicalOperato
 			extra_params += ", mode: auto";
 		}
 	}
+	if (filter_strategy != AnnFilterStrategy::NONE) {
+		extra_params += StringUtil::Format(", filter: %s", FilterStrategyName(filter_strategy));
+		if (filter_strategy == AnnFilterStrategy::POST_FILTER) {
+			extra_params += StringUtil::Format(", oversample: %llux", oversample);
+		}
+		extra_params += StringUtil::Format(", selectivity: %.4f", selectivity);
+	}
+	if (has_partition) {
+		extra_params += StringUtil::Format(", partition: %s", partition_key.ToString());
+	}
 	target_get->extra_info.file_filters = StringUtil::Format("ANN_INDEX_SCAN (index: %s, k: %llu, engine: %s%s)",
 	                                                         found_idx.name, k, engine, extra_params);
 
+	// The predicate now runs inside the index scan; drop the FILTER node above the GET
+	if (has_filter) {
+		projection.children[0] = std::move(projection.children[0]->children[0]);
+	}
+
 	// Remove the ORDER BY node — results from index scan are already sorted
 	op = std::move(order_by.children[0]);
 
 	return true;
 }
 
+// ========================================
+// Optimizer: per-row top-k joins into batched search
+// ========================================
+
+// Tighten k by one conjunct of the row-number filter ("rn <= c", "rn < c", "c >= rn").
+// Lower bounds ("rn > offset") leave k alone; any other predicate disqualifies the filter.
+static bool ApplyRowNumberBound(const Expression &expr, const ColumnBinding &row_number, idx_t &k) {
+	if (expr.type == ExpressionType::CONJUNCTION_AND) {
+		for (auto &child : expr.Cast<BoundConjunctionExpression>().children) {
+			if (!ApplyRowNumberBound(*child, row_number, k)) {
+				return false;
+			}
+		}
+		return true;
+	}
+	if (expr.GetExpressionClass() != ExpressionClass::BOUND_COMPARISON) {
+		return false;
+	}
+	auto &comparison = expr.Cast<BoundComparisonExpression>();
+	auto type = expr.type;
+	const Expression *ref = comparison.left.get();
+	const Expression *constant = comparison.right.get();
+	while (ref->type == ExpressionType::OPERATOR_CAST) {
+		ref = ref->Cast<BoundCastExpression>().child.get();
+	}
+	while (constant->type == ExpressionType::OPERATOR_CAST) {
+		constant = constant->Cast<BoundCastExpression>().child.get();
+	}
+	if (ref->type == ExpressionType::VALUE_CONSTANT) {
+		std::swap(ref, constant);
+		type = FlipComparisonExpression(type);
+	}
+	if (ref->type != ExpressionType::BOUND_COLUMN_REF || constant->type != ExpressionType::VALUE_CONSTANT ||
+	    !(ref->Cast<BoundColumnRefExpression>().binding == row_number)) {
+		return false;
+	}
+	auto &value = constant->Cast<BoundConstantExpression>().value;
+	if (value.IsNull() || !value.type().IsIntegral()) {
+		return false;
+	}
+	auto bound = value.GetValue<int64_t>();
+	switch (type) {
+	case ExpressionType::COMPARE_LESSTHAN:
+		k = MinValue<idx_t>(k, bound > 0 ? static_cast<idx_t>(bound - 1) : 0);
+		return true;
+	case ExpressionType::COMPARE_LESSTHANOREQUALTO:
+		k = MinValue<idx_t>(k, bound > 0 ? static_cast<idx_t>(bound) : 0);
+		return true;
+	case ExpressionType::COMPARE_GREATERTHAN:
+	case ExpressionType::COMPARE_GREATERTHANOREQUALTO:
+		return true;
+	default:
+		return false;
+	}
+}
+
+static bool ReferencesTable(const Expression &expr, idx_t table_index) {
+	if (expr.type == ExpressionType::BOUND_COLUMN_REF) {
+		return expr.Cast<BoundColumnRefExpression>().binding.table_index == table_index;
+	}
+	bool found = false;
+	ExpressionIterator::EnumerateChildren(expr, [&](const Expression &child) {
+		found = found || ReferencesTable(child, table_index);
+	});
+	return found;
+}
+
+// Rewrite a per-row top-k over a cross product with an indexed table:
+//
+//   FILTER rn <= k
+//     WINDOW rn := row_number() OVER (PARTITION BY <query side> ORDER BY dist(t.col, q.vec))
+//       [PROJECTION]
+//         CROSS_PRODUCT(seq_scan t, <query side>)
+//
+// QUALIFY row_number() OVER (...) <= k plans to this, and so does a LATERAL (... ORDER BY
+// dist LIMIT k) subquery once decorrelated. The seq_scan becomes AnnKnnJoin over the
+// query side, which emits at most k index hits per query row; window and filter stay
+// and rank those hits by the exact distance. Partitions only group query rows, so each
+// partition's top k is among the hits of its rows.
+static bool TryOptimizeKnnJoin(ClientContext &context, LogicalOperator &root, LogicalOperator &op) {
+	auto &filter = op.Cast<LogicalFilter>();
+	if (filter.children.size() != 1 || filter.children[0]->type != LogicalOperatorType::LOGICAL_WINDOW) {
+		return false;
+	}
+	auto &window = filter.children[0]->Cast<LogicalWindow>();
+	if (window.expressions.size() != 1 || window.expressions[0]->type != ExpressionType::WINDOW_ROW_NUMBER) {
+		return false;
+	}
+	auto &row_number = window.expressions[0]->Cast<BoundWindowExpression>();
+	if (row_number.filter_expr || row_number.orders.size() != 1 ||
+	    row_number.orders[0].type != OrderType::ASCENDING) {
+		return false;
+	}
+
+	idx_t k = NumericLimits<idx_t>::Maximum();
+	ColumnBinding row_number_binding(window.window_index, 0);
+	for (auto &expr : filter.expressions) {
+		if (!ApplyRowNumberBound(*expr, row_number_binding, k)) {
+			return false;
+		}
+	}
+	if (k == 0 || k == NumericLimits<idx_t>::Maximum()) {
+		return false;
+	}
+
+	// The window orders on the distance directly (QUALIFY) or on a projection of it (LATERAL)
+	reference<unique_ptr<LogicalOperator>> input = window.children[0];
+	auto *order_expr = row_number.orders[0].expression.get();
+	if (order_expr->type == ExpressionType::BOUND_COLUMN_REF) {
+		auto &binding = order_expr->Cast<BoundColumnRefExpression>().binding;
+		if (input.get()->type != LogicalOperatorType::LOGICAL_PROJECTION) {
+			return false;
+		}
+		auto &projection = input.get()->Cast<LogicalProjection>();
+		if (binding.table_index != projection.table_index || binding.column_index >= projection.expressions.size()) {
+			return false;
+		}
+		order_expr = projection.expressions[binding.column_index].get();
+		input = projection.children[0];
+	}
+	if (order_expr->type != ExpressionType::BOUND_FUNCTION) {
+		return false;
+	}
+	auto &func_expr = order_expr->Cast<BoundFunctionExpression>();
+	auto &fn_name = func_expr.function.name;
+	if (!IsAnnDistanceFunction(fn_name) || func_expr.children.size() != 2) {
+		return false;
+	}
+
+	auto &cross_product = input.get();
+	if (cross_product->type != LogicalOperatorType::LOGICAL_CROSS_PRODUCT || cross_product->children.size() != 2) {
+		return false;
+	}
+
+	// Both arguments are columns: the indexed one of the seq_scan side, the query vector of the other
+	vector<ColumnBinding> args;
+	for (auto &child : func_expr.children) {
+		auto *expr = child.get();
+		while (expr->type == ExpressionType::OPERATOR_CAST) {
+			expr = expr->Cast<BoundCastExpression>().child.get();
+		}
+		if (expr->type != ExpressionType::BOUND_COLUMN_REF) {
+			return false;
+		}
+		args.push_back(expr->Cast<BoundColumnRefExpression>().binding);
+	}
+	idx_t table_side = DConstants::INVALID_INDEX;
+	idx_t table_arg = 0;
+	for (idx_t side = 0; side < 2 && table_side == DConstants::INVALID_INDEX; side++) {
+		auto &child = *cross_product->children[side];
+		if (child.type != LogicalOperatorType::LOGICAL_GET || child.Cast<LogicalGet>().function.name != "seq_scan") {
+			continue;
+		}
+		for (idx_t arg = 0; arg < 2; arg++) {
+			if (args[arg].table_index == child.Cast<LogicalGet>().table_index) {
+				table_side = side;
+				table_arg = arg;
+				break;
+			}
+		}
+	}
+	if (table_side == DConstants::INVALID_INDEX) {
+		return false;
+	}
+	auto &target_get = cross_product->children[table_side]->Cast<LogicalGet>();
+	auto &query_side = cross_product->children[1 - table_side];
+	auto query_bindings = query_side->GetColumnBindings();
+	auto query_col = static_cast<idx_t>(
+	    std::find(query_bindings.begin(), query_bindings.end(), args[1 - table_arg]) - query_bindings.begin());
+	if (query_col == query_bindings.size()) {
+		return false;
+	}
+
+	// Partitioning on table columns would rank across query rows
+	for (auto &partition : row_number.partitions) {
+		if (ReferencesTable(*partition, target_get.table_index)) {
+			return false;
+		}
+	}
+
+	auto &col_ids = target_get.GetColumnIds();
+	for (auto &cid : col_ids) {
+		if (cid.IsRowIdColumn()) {
+			return false;
+		}
+	}
+	auto column_index = args[table_arg].column_index;
+	if (column_index >= col_ids.size()) {
+		return false;
+	}
+	auto physical_col = col_ids[column_index].GetPrimaryIndex();
+
+	auto table_ptr = target_get.GetTable();
+	if (!table_ptr || !table_ptr->IsDuckTable()) {
+		return false;
+	}
+	auto &duck_table = table_ptr->Cast<DuckTableEntry>();
+
+	FoundIndex found_idx;
+	if (!FindAnnIndex(context, duck_table, physical_col, fn_name, found_idx)) {
+		return false;
+	}
+	if (!IndexScanPaysOff(target_get.EstimateCardinality(context), k, found_idx)) {
+		return false;
+	}
+
+	auto bind_data = make_uniq<AnnKnnJoinBindData>();
+	bind_data->table_entry = &duck_table;
+	bind_data->index_name = found_idx.name;
+	bind_data->is_diskann = found_idx.is_diskann;
+	bind_data->k = k;
+	bind_data->query_col = query_col;
+	for (auto &cid : col_ids) {
+		bind_data->storage_ids.emplace_back(StorageIndex(cid.GetPrimaryIndex()));
+	}
+
+	// The query side's columns follow the table columns in the GET's output: rebind every
+	// reference to them above the GET
+	query_side->ResolveOperatorTypes();
+	auto n_table_cols = col_ids.size();
+	auto first_input_col = target_get.returned_types.size();
+	ColumnBindingReplacer replacer;
+	for (idx_t i = 0; i < query_bindings.size(); i++) {
+		target_get.returned_types.push_back(query_side->types[i]);
+		target_get.names.push_back(StringUtil::Format("knn_input_%llu", i));
+		target_get.AddColumnId(first_input_col + i);
+		replacer.replacement_bindings.emplace_back(query_bindings[i],
+		                                           ColumnBinding(target_get.table_index, n_table_cols + i));
+	}
+
+	target_get.function = GetAnnKnnJoinFunction();
+	target_get.bind_data = std::move(bind_data);
+	target_get.children.push_back(std::move(query_side));
+	cross_product = std::move(cross_product->children[table_side]);
+
+	replacer.stop_operator = &target_get;
+	replacer.VisitOperator(root);
+	return true;
+}
+
 // Recursively walk the plan tree looking for optimization opportunities
-static void OptimizeRecursive(ClientContext &context, unique_ptr<LogicalOperator> &op) {
+static void OptimizeRecursive(ClientContext &context, LogicalOperator &root, unique_ptr<LogicalOperator> &op) {
 	// Process children first (bottom-up)
 	for (auto &child : op->children) {
-		OptimizeRecursive(context, child);
+		OptimizeRecursive(context, root, child);
+	}
+
+	// Check for FILTER(row_number) → WINDOW over a cross product: per-row top-k join
+	if (op->type == LogicalOperatorType::LOGICAL_FILTER) {
+		TryOptimizeKnnJoin(context, root, *op);
+		return;
 	}
 
 	// Check for LIMIT → ORDER BY pattern
@@ -558,7 +1527,7 @@ static void OptimizeRecursive(ClientContext &context, unique_ptr<LogicalOperator
 }
 
 static void AnnOptimize(OptimizerExtensionInput &input, unique_ptr<LogicalOperator> &plan) {
-	OptimizeRecursive(input.context, plan);
+	OptimizeRecursive(input.context, *plan, plan);
 }
 
 // ========================================
@@ -0,0 +1,244 @@
+#include "ann_partition.hpp"
+
+#include "duckdb/common/types/vector.hpp"
+#include "duckdb/main/database.hpp"
+#include "duckdb/parallel/task_executor.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
+
+#include <algorithm>
+#include <atomic>
+
+namespace duckdb {
+
+string AnnPartitionKey(const Value &value) {
+	// "=" keeps the empty string apart from NULL
+	return value.IsNull() ? string() : "=" + value.ToString();
+}
+
+void AnnCheckPartitionColumns(const string &engine, const string &partition_by,
+                              const vector<unique_ptr<Expression>> &expressions) {
+	if (expressions.size() != 2) {
+		throw BinderException("%s partition_by = '%s' needs the partition column in the index, after the vector "
+		                      "column: USING %s (embedding, %s)",
+		                      engine, partition_by, engine, partition_by);
+	}
+	auto &column = *expressions[1];
+	if (!StringUtil::CIEquals(column.GetName(), partition_by)) {
+		throw BinderException("%s partition_by = '%s' does not match the index's second column '%s'", engine,
+		                      partition_by, column.GetName());
+	}
+	if (column.return_type.IsNested()) {
+		throw BinderException("%s partition_by column must have a scalar type, got %s", engine,
+		                      column.return_type.ToString());
+	}
+}
+
+// ========================================
+// Routing rows to partitions
+// ========================================
+
+void AnnGroupByPartition(Vector &keys, Vector &row_ids, idx_t count, AnnPartitionMap<AnnPartitionRows> &out,
+                         Vector *vectors) {
+	UnifiedVectorFormat rowid_format;
+	row_ids.ToUnifiedFormat(count, rowid_format);
+	auto rowid_data = UnifiedVectorFormat::GetData<row_t>(rowid_format);
+
+	const float *vector_data = nullptr;
+	idx_t dim = 0;
+	if (vectors) {
+		vectors->Flatten(count);
+		dim = ArrayType::GetSize(vectors->GetType());
+		vector_data = FlatVector::GetData<float>(ArrayVector::GetEntry(*vectors));
+	}
+
+	// Partition columns have few distinct values, usually clustered: skip the lookup while the key repeats
+	AnnPartitionRows *rows = nullptr;
+	Value last;
+	for (idx_t i = 0; i < count; i++) {
+		auto key = keys.GetValue(i);
+		if (!rows || !Value::NotDistinctFrom(key, last)) {
+			rows = &out.GetOrCreate(key);
+			last = key;
+		}
+		rows->row_ids.push_back(rowid_data[rowid_format.sel->get_index(i)]);
+		if (vector_data) {
+			rows->vectors.insert(rows->vectors.end(), vector_data + i * dim, vector_data + (i + 1) * dim);
+		}
+	}
+}
+
+void AnnMergePartitionRows(AnnPartitionMap<AnnPartitionRows> &out, AnnPartitionMap<AnnPartitionRows> &rows) {
+	for (idx_t i = 0; i < rows.Size(); i++) {
+		auto &source = rows.Get(i);
+		auto &target = out.GetOrCreate(rows.Key(i));
+		if (target.row_ids.empty()) {
+			target = std::move(source);
+			continue;
+		}
+		target.vectors.insert(target.vectors.end(), source.vectors.begin(), source.vectors.end());
+		target.row_ids.insert(target.row_ids.end(), source.row_ids.begin(), source.row_ids.end());
+	}
+	rows.Clear();
+}
+
+// ========================================
+// Fan-out over partitions
+// ========================================
+
+// Runs loop indices until none are left; one per scheduler thread
+class AnnPartitionTask : public BaseExecutorTask {
+public:
+	AnnPartitionTask(TaskExecutor &executor, std::atomic<idx_t> &next, idx_t n,
+	                 const std::function<void(idx_t)> &body)
+	    : BaseExecutorTask(executor), next(next), n(n), body(body) {
+	}
+
+	void ExecuteTask() override {
+		for (auto i = next++; i < n; i = next++) {
+			body(i);
+		}
+	}
+
+private:
+	std::atomic<idx_t> &next;
+	idx_t n;
+	const std::function<void(idx_t)> &body;
+};
+
+void AnnParallelFor(DatabaseInstance &db, idx_t n, const std::function<void(idx_t)> &body) {
+	auto &scheduler = TaskScheduler::GetScheduler(db);
+	auto workers = MinValue<idx_t>(n, static_cast<idx_t>(MaxValue<int32_t>(scheduler.NumberOfThreads(), 1)));
+	if (workers <= 1) {
+		for (idx_t i = 0; i < n; i++) {
+			body(i);
+		}
+		return;
+	}
+	// The calling thread works on the tasks too, so this cannot deadlock a busy scheduler;
+	// WorkOnTasks rethrows the first error of a partition
+	std::atomic<idx_t> next {0};
+	TaskExecutor executor(scheduler);
+	for (idx_t w = 0; w < workers; w++) {
+		executor.ScheduleTask(make_uniq<AnnPartitionTask>(executor, next, n, body));
+	}
+	executor.WorkOnTasks();
+}
+
+vector<pair<row_t, float>> AnnMergeTopK(vector<vector<pair<row_t, float>>> &lists, idx_t k, bool descending) {
+	if (lists.size() == 1) {
+		auto merged = std::move(lists[0]);
+		if (merged.size() > k) {
+			merged.resize(k);
+		}
+		return merged;
+	}
+	// Heap of (list, position) of the next unmerged result of every list, nearest on top
+	auto farther = [&](const pair<idx_t, idx_t> &a, const pair<idx_t, idx_t> &b) {
+		auto da = lists[a.first][a.second].second;
+		auto db = lists[b.first][b.second].second;
+		return descending ? da < db : da > db;
+	};
+	vector<pair<idx_t, idx_t>> heap;
+	for (idx_t i = 0; i < lists.size(); i++) {
+		if (!lists[i].empty()) {
+			heap.emplace_back(i, 0);
+		}
+	}
+	std::make_heap(heap.begin(), heap.end(), farther);
+
+	vector<pair<row_t, float>> merged;
+	merged.reserve(k);
+	while (!heap.empty() && merged.size() < k) {
+		std::pop_heap(heap.begin(), heap.end(), farther);
+		auto &next = heap.back();
+		merged.push_back(lists[next.first][next.second]);
+		if (++next.second < lists[next.first].size()) {
+			std::push_heap(heap.begin(), heap.end(), farther);
+		} else {
+			heap.pop_back();
+		}
+	}
+	return merged;
+}
+
+// ========================================
+// Partition directory
+// ========================================
+
+template <class T>
+static void WriteValue(LinkedBlockWriter &writer, const T &value) {
+	writer.Write(reinterpret_cast<const uint8_t *>(&value), sizeof(T));
+}
+
+template <class T>
+static T ReadValue(LinkedBlockReader &reader) {
+	T value {};
+	if (reader.Read(reinterpret_cast<uint8_t *>(&value), sizeof(T)) != sizeof(T)) {
+		throw IOException("ANN index partition directory is truncated. Drop and recreate the index.");
+	}
+	return value;
+}
+
+// The count, then per partition: is_null (u8), the value as text (u32 length + bytes), child root (u64)
+void AnnWritePartitionDirectory(LinkedBlockWriter &writer, const vector<AnnPartitionEntry> &entries) {
+	WriteValue<uint64_t>(writer, entries.size());
+	for (auto &entry : entries) {
+		auto is_null = entry.key.IsNull();
+		auto text = is_null ? string() : entry.key.ToString();
+		WriteValue<uint8_t>(writer, is_null ? 1 : 0);
+		WriteValue<uint32_t>(writer, static_cast<uint32_t>(text.size()));
+		writer.Write(reinterpret_cast<const uint8_t *>(text.data()), text.size());
+		WriteValue<uint64_t>(writer, entry.root);
+	}
+}
+
+vector<AnnPartitionEntry> AnnReadPartitionDirectory(LinkedBlockReader &reader, const LogicalType &key_type) {
+	auto count = ReadValue<uint64_t>(reader);
+	vector<AnnPartitionEntry> entries;
+	for (uint64_t i = 0; i < count; i++) {
+		auto is_null = ReadValue<uint8_t>(reader) != 0;
+		auto len = ReadValue<uint32_t>(reader);
+		string text(len, '\0');
+		if (reader.Read(reinterpret_cast<uint8_t *>(&text[0]), len) != len) {
+			throw IOException("ANN index partition directory is truncated. Drop and recreate the index.");
+		}
+		auto root = ReadValue<uint64_t>(reader);
+		entries.push_back({is_null ? Value(key_type) : Value(text).DefaultCastAs(key_type), root});
+	}
+	return entries;
+}
+
+void AnnPartitionStorage::Add(const Value &key, IndexStorageInfo child) {
+	if (child.root == 0 || child.allocator_infos.empty()) {
+		return;
+	}
+	directory.push_back({key, child.root});
+	children.push_back(std::move(child));
+}
+
+void AnnPartitionStorage::AppendTo(IndexStorageInfo &info) {
+	for (auto &child : children) {
+		info.allocator_infos.push_back(std::move(child.allocator_infos[0]));
+		if (!child.buffers.empty()) {
+			info.buffers.push_back(std::move(child.buffers[0]));
+		}
+	}
+	children.clear();
+}
+
+IndexStorageInfo AnnPartitionStorage::ChildInfo(const IndexStorageInfo &info, idx_t i, idx_t root,
+                                                const case_insensitive_map_t<Value> &options) {
+	if (1 + i >= info.allocator_infos.size()) {
+		throw IOException("ANN index \"%s\" lists more partitions than it has storage for. Drop and recreate the "
+		                  "index.",
+		                  info.name);
+	}
+	IndexStorageInfo child;
+	child.name = info.name;
+	child.root = root;
+	child.allocator_infos.push_back(info.allocator_infos[1 + i]);
+	child.options = options;
+	return child;
+}
+
+} // namespace duckdb
@@ -0,0 +1,99 @@
+#include "ann_query_batcher.hpp"
+
+#include "duckdb/main/client_context.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace duckdb {
+
+AnnQueryBatcher::Config AnnQueryBatcher::Configured(ClientContext &context) {
+	Config config;
+	Value val;
+	if (context.TryGetCurrentSetting("ann_batch_window_us", val) && !val.IsNull()) {
+		auto window = val.GetValue<int64_t>();
+		config.window_us = window > 0 ? static_cast<idx_t>(window) : 0;
+	}
+	if (context.TryGetCurrentSetting("ann_batch_max_queries", val) && !val.IsNull()) {
+		auto max_queries = val.GetValue<int64_t>();
+		config.max_queries = max_queries > 0 ? static_cast<idx_t>(max_queries) : 0;
+	}
+	return config;
+}
+
+AnnQueryBatcher::Results AnnQueryBatcher::Submit(const Config &config, const float *query, int32_t dimension,
+                                                 int32_t k, int32_t search_complexity,
+                                                 const BatchSearch &batch_search) {
+	unique_lock<mutex> guard(lock_);
+
+	shared_ptr<Batch> batch;
+	for (auto &open : open_) {
+		if (open->dimension == dimension && open->k == k && open->search_complexity == search_complexity) {
+			batch = open;
+			break;
+		}
+	}
+
+	if (batch) {
+		// Follower: add the query and wait for the leader to publish the batch's results
+		auto slot = batch->queries.size();
+		batch->queries.emplace_back(query, query + dimension);
+		batch->tallies.push_back(AnnSearchTally::Current());
+		if (batch->queries.size() >= config.max_queries) {
+			batch->cv.notify_all();
+		}
+		batch->cv.wait(guard, [&]() { return batch->done; });
+		if (batch->error.HasError()) {
+			batch->error.Throw();
+		}
+		return std::move(batch->results[slot]);
+	}
+
+	// Leader: open the batch, collect queries for up to the window, then search them all
+	batch = make_shared_ptr<Batch>();
+	batch->dimension = dimension;
+	batch->k = k;
+	batch->search_complexity = search_complexity;
+	batch->queries.emplace_back(query, query + dimension);
+	batch->tallies.push_back(AnnSearchTally::Current());
+	open_.push_back(batch);
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(config.window_us);
+	batch->cv.wait_until(guard, deadline, [&]() { return batch->queries.size() >= config.max_queries; });
+	open_.erase(std::find(open_.begin(), open_.end(), batch));
+	auto queries = std::move(batch->queries);
+	auto tallies = std::move(batch->tallies);
+	guard.unlock();
+
+	vector<Results> results;
+	ErrorData error;
+	AnnSearchTally batch_tally;
+	try {
+		AnnSearchTally::Scope scope(&batch_tally);
+		results = batch_search(queries, k, search_complexity);
+		results.resize(queries.size());
+	} catch (std::exception &ex) {
+		error = ErrorData(ex);
+	}
+	// Followers are still waiting, so their tallies are alive until done is published
+	auto work = batch_tally.Get();
+	for (idx_t i = 0; i < tallies.size(); i++) {
+		if (tallies[i]) {
+			tallies[i]->Add(work.Share(i, tallies.size()));
+		}
+	}
+	batches_++;
+	batched_queries_ += queries.size();
+
+	guard.lock();
+	batch->results = std::move(results);
+	batch->error = error;
+	batch->done = true;
+	batch->cv.notify_all();
+	if (error.HasError()) {
+		error.Throw();
+	}
+	return std::move(batch->results[0]);
+}
+
+} // namespace duckdb
@@ -0,0 +1,77 @@
+#include "ann_result_cache.hpp"
+
+#include "duckdb/common/types/hash.hpp"
+#include "duckdb/main/client_context.hpp"
+
+namespace duckdb {
+
+idx_t AnnResultCache::ConfiguredCapacity(ClientContext &context) {
+	Value val;
+	if (context.TryGetCurrentSetting("ann_result_cache_size", val) && !val.IsNull()) {
+		auto capacity = val.GetValue<int64_t>();
+		return capacity > 0 ? static_cast<idx_t>(capacity) : 0;
+	}
+	return 0;
+}
+
+AnnResultCache::Key::Key(const float *query_p, int32_t dimension, int32_t k_p, int32_t search_complexity_p,
+                         int32_t nprobe_p)
+    : query(query_p, query_p + dimension), k(k_p), search_complexity(search_complexity_p), nprobe(nprobe_p) {
+	hash = duckdb::Hash(reinterpret_cast<const char *>(query.data()), query.size() * sizeof(float));
+	hash = CombineHash(hash, duckdb::Hash(k));
+	hash = CombineHash(hash, duckdb::Hash(search_complexity));
+	hash = CombineHash(hash, duckdb::Hash(nprobe));
+}
+
+bool AnnResultCache::Lookup(const Key &key, idx_t capacity, Results &results, uint64_t &generation) {
+	lock_guard<mutex> guard(lock_);
+	if (capacity != capacity_) {
+		capacity_ = capacity;
+		EvictTo(capacity_);
+	}
+	generation = generation_;
+
+	auto it = entries_.find(key.hash);
+	if (it == entries_.end() || !(it->second->key == key)) {
+		misses_++;
+		return false;
+	}
+	lru_.splice(lru_.begin(), lru_, it->second);
+	results = it->second->results;
+	hits_++;
+	return true;
+}
+
+void AnnResultCache::Insert(Key key, uint64_t generation, const Results &results) {
+	lock_guard<mutex> guard(lock_);
+	if (generation != generation_ || capacity_ == 0) {
+		// The index changed while the search ran
+		return;
+	}
+	auto it = entries_.find(key.hash);
+	if (it != entries_.end()) {
+		// Same query cached by a concurrent search, or a hash collision: the newer one wins
+		lru_.erase(it->second);
+		entries_.erase(it);
+	}
+	auto hash = key.hash;
+	lru_.push_front(Entry {std::move(key), results});
+	entries_[hash] = lru_.begin();
+	EvictTo(capacity_);
+}
+
+void AnnResultCache::Invalidate() {
+	lock_guard<mutex> guard(lock_);
+	generation_++;
+	lru_.clear();
+	entries_.clear();
+}
+
+void AnnResultCache::EvictTo(idx_t capacity) {
+	while (lru_.size() > capacity) {
+		entries_.erase(lru_.back().key.hash);
+		lru_.pop_back();
+	}
+}
+
+} // namespace duckdb
@@ -1,15 +1,18 @@
 #include "diskann_index.hpp"
 #include "rust_ffi.hpp"
 #include "ann_extension.hpp"
+#include "ann_fetch.hpp"
+#include "ann_search_stats.hpp"
 #include "metal_diskann_bridge.h"
 #include "duckdb/catalog/catalog_entry/duck_table_entry.hpp"
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
 #include "duckdb/function/table_function.hpp"
-#include "duckdb/main/connection.hpp"
-#include "duckdb/main/query_result.hpp"
+#include "duckdb/parser/keyword_helper.hpp"
+#include "duckdb/parser/parser.hpp"
+#include "duckdb/parser/statement/select_statement.hpp"
+#include "duckdb/parser/tableref/subqueryref.hpp"
+#include "duckdb/planner/binder.hpp"
 #include "duckdb/storage/data_table.hpp"
-#include "duckdb/storage/table/scan_state.hpp"
-#include "duckdb/transaction/duck_transaction.hpp"
 
 #include <algorithm>
 #include <cmath>
@@ -34,6 +37,7 @@ struct AnnSearchBindData : public TableFunctionData {
 	vector<float> query;
 	int32_t k;
 	int32_t search_complexity = 0;
+	int32_t nprobe = 0;
 	int32_t oversample = 1;
 
 	// Resolved at bind time
@@ -42,10 +46,47 @@ struct AnnSearchBindData : public TableFunctionData {
 	vector<StorageIndex> storage_ids;
 };
 
+// Projected output of ann_search / ann_search_batch: table columns to fetch (storage
+// column -> output column) and where the computed columns go (INVALID_INDEX = not projected)
+struct AnnScanProjection {
+	vector<StorageIndex> fetch_ids;
+	vector<idx_t> fetch_cols;
+	idx_t distance_col = DConstants::INVALID_INDEX;
+	idx_t row_id_col = DConstants::INVALID_INDEX;
+	idx_t query_idx_col = DConstants::INVALID_INDEX;
+
+	// column_ids index the bind-time columns: [leading...] table columns, _distance
+	AnnScanProjection(const vector<column_t> &column_ids, const vector<StorageIndex> &storage_ids, idx_t leading) {
+		for (idx_t i = 0; i < column_ids.size(); i++) {
+			auto id = column_ids[i];
+			if (id == COLUMN_IDENTIFIER_ROW_ID) {
+				row_id_col = i;
+			} else if (IsVirtualColumn(id)) {
+				// Placeholder column of a count(*)-style scan: nothing to produce
+				continue;
+			} else if (id < leading) {
+				query_idx_col = i;
+			} else if (id - leading < storage_ids.size()) {
+				fetch_ids.push_back(storage_ids[id - leading]);
+				fetch_cols.push_back(i);
+			} else {
+				distance_col = i;
+			}
+		}
+	}
+};
+
 struct AnnSearchState : public GlobalTableFunctionState {
+	explicit AnnSearchState(AnnScanProjection projection_p) : projection(std::move(projection_p)) {
+	}
+
+	AnnScanProjection projection;
 	vector<pair<row_t, float>> results;
 	idx_t offset = 0;
 	bool fetched = false;
+	// Growth of the index's counters while this scan searched (concurrent queries on the same
+	// index included), for EXPLAIN ANALYZE
+	AnnSearchCounters searched;
 
 	idx_t MaxThreads() const override {
 		return 1;
@@ -67,6 +108,8 @@ static unique_ptr<FunctionData> AnnSearchBind(ClientContext &context, TableFunct
 	for (auto &kv : input.named_parameters) {
 		if (kv.first == "search_complexity") {
 			bind_data->search_complexity = kv.second.GetValue<int32_t>();
+		} else if (kv.first == "nprobe") {
+			bind_data->nprobe = kv.second.GetValue<int32_t>();
 		} else if (kv.first == "oversample") {
 			bind_data->oversample = MaxValue<int32_t>(1, kv.second.GetValue<int32_t>());
 		}
@@ -96,7 +139,8 @@ static unique_ptr<FunctionData> AnnSearchBind(ClientContext &context, TableFunct
 }
 
 static unique_ptr<GlobalTableFunctionState> AnnSearchInit(ClientContext &context, TableFunctionInitInput &input) {
-	return make_uniq<AnnSearchState>();
+	auto &bind = input.bind_data->Cast<AnnSearchBindData>();
+	return make_uniq<AnnSearchState>(AnnScanProjection(input.column_ids, bind.storage_ids, 0));
 }
 
 static void AnnSearchScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
@@ -121,14 +165,20 @@ static void AnnSearchScan(ClientContext &context, TableFunctionInput &data, Data
 #endif
 
 		auto fetch_k = bind.k * bind.oversample;
+		auto query = bind.query.data();
+		auto dim = static_cast<int32_t>(bind.query.size());
 
 		bool found = false;
 		auto idx_ptr = indexes.Find(bind.index_name);
+		AnnSearchTally tally;
+		AnnSearchTally::Scope scope(&tally);
 		if (idx_ptr) {
 			auto *diskann = dynamic_cast<DiskannIndex *>(idx_ptr.get());
 			if (diskann) {
-				state.results = diskann->Search(bind.query.data(), static_cast<int32_t>(bind.query.size()), fetch_k,
-				                                bind.search_complexity);
+				state.results =
+				    diskann->GetResultCache().Get(context, query, dim, fetch_k, bind.search_complexity, 0, [&]() {
+					    return diskann->SearchCoalesced(context, query, dim, fetch_k, bind.search_complexity);
+				    });
 				found = true;
 			}
 
@@ -136,7 +186,10 @@ static void AnnSearchScan(ClientContext &context, TableFunctionInput &data, Data
 			if (!found) {
 				auto *faiss = dynamic_cast<FaissIndex *>(idx_ptr.get());
 				if (faiss) {
-					state.results = faiss->Search(bind.query.data(), static_cast<int32_t>(bind.query.size()), fetch_k);
+					auto nprobe = bind.nprobe > 0 ? bind.nprobe : faiss->NprobeFor(fetch_k);
+					state.results = faiss->GetResultCache().Get(context, query, dim, fetch_k, 0, nprobe, [&]() {
+						return faiss->Search(query, dim, fetch_k, nprobe);
+					});
 					found = true;
 				}
 			}
@@ -146,6 +199,7 @@ static void AnnSearchScan(ClientContext &context, TableFunctionInput &data, Data
 		if (!found) {
 			throw InvalidInputException("ANN index '%s' not found on table '%s'", bind.index_name, bind.table_name);
 		}
+		state.searched = tally.Get();
 	}
 
 	if (state.offset >= state.results.size()) {
@@ -153,45 +207,46 @@ static void AnnSearchScan(ClientContext &context, TableFunctionInput &data, Data
 		return;
 	}
 
-	// Fetch rows from the table by row_id
+	// Fetch the projected table columns of this batch by row_id
 	auto &catalog = Catalog::GetCatalog(context, "");
 	auto &duck_table =
 	    catalog.GetEntry<TableCatalogEntry>(context, DEFAULT_SCHEMA, bind.table_name).Cast<DuckTableEntry>();
 	auto &storage = duck_table.GetStorage();
-	auto &transaction = DuckTransaction::Get(context, storage.db);
-
-	auto num_table_cols = bind.column_types.size();
-	auto distance_col_idx = num_table_cols;
+	auto &proj = state.projection;
 
 	auto batch_size = MinValue<idx_t>(state.results.size() - state.offset, STANDARD_VECTOR_SIZE);
+	auto batch = state.results.data() + state.offset;
 
-	// Build row_id vector
-	Vector row_ids_vec(LogicalType::ROW_TYPE, batch_size);
-	auto row_ids_data = FlatVector::GetData<row_t>(row_ids_vec);
+	row_t row_ids[STANDARD_VECTOR_SIZE];
 	for (idx_t i = 0; i < batch_size; i++) {
-		row_ids_data[i] = state.results[state.offset + i].first;
+		row_ids[i] = batch[i].first;
 	}
+	SelectionVector kept;
+	auto count = AnnFetchRows(context, storage, proj.fetch_ids, proj.fetch_cols, row_ids, batch_size, output, kept);
 
-	// Fetch rows from table
-	DataChunk fetch_chunk;
-	fetch_chunk.Initialize(context, bind.column_types);
-	ColumnFetchState fetch_state;
-	storage.Fetch(transaction, fetch_chunk, bind.storage_ids, row_ids_vec, batch_size, fetch_state);
-
-	// Copy fetched columns to output
-	for (idx_t col = 0; col < num_table_cols; col++) {
-		for (idx_t i = 0; i < batch_size; i++) {
-			output.data[col].SetValue(i, fetch_chunk.data[col].GetValue(i));
+	if (proj.distance_col != DConstants::INVALID_INDEX) {
+		auto distances = FlatVector::GetData<float>(output.data[proj.distance_col]);
+		for (idx_t i = 0; i < count; i++) {
+			distances[i] = batch[kept.get_index(i)].second;
 		}
 	}
-
-	// Set distance column
-	for (idx_t i = 0; i < batch_size; i++) {
-		output.data[distance_col_idx].SetValue(i, Value::FLOAT(state.results[state.offset + i].second));
+	if (proj.row_id_col != DConstants::INVALID_INDEX) {
+		auto out_ids = FlatVector::GetData<row_t>(output.data[proj.row_id_col]);
+		for (idx_t i = 0; i < count; i++) {
+			out_ids[i] = batch[kept.get_index(i)].first;
+		}
 	}
 
 	state.offset += batch_size;
-	output.SetCardinality(batch_size);
+	output.SetCardinality(count);
+}
+
+static InsertionOrderPreservingMap<string> AnnSearchToString(TableFunctionDynamicToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	if (input.global_state) {
+		AnnSearchCountersToString(input.global_state->Cast<AnnSearchState>().searched, result);
+	}
+	return result;
 }
 
 // ========================================
@@ -212,6 +267,10 @@ struct AnnSearchBatchBindData : public TableFunctionData {
 };
 
 struct AnnSearchBatchState : public GlobalTableFunctionState {
+	explicit AnnSearchBatchState(AnnScanProjection projection_p) : projection(std::move(projection_p)) {
+	}
+
+	AnnScanProjection projection;
 	// Flattened results: (query_idx, row_id, distance)
 	struct BatchResult {
 		int32_t query_idx;
@@ -221,6 +280,9 @@ struct AnnSearchBatchState : public GlobalTableFunctionState {
 	vector<BatchResult> results;
 	idx_t offset = 0;
 	bool fetched = false;
+	// Growth of the index's counters while this scan searched (concurrent queries on the same
+	// index included), for EXPLAIN ANALYZE
+	AnnSearchCounters searched;
 
 	idx_t MaxThreads() const override {
 		return 1;
@@ -276,7 +338,9 @@ static unique_ptr<FunctionData> AnnSearchBatchBind(ClientContext &context, Table
 }
 
 static unique_ptr<GlobalTableFunctionState> AnnSearchBatchInit(ClientContext &context, TableFunctionInitInput &input) {
-	return make_uniq<AnnSearchBatchState>();
+	auto &bind = input.bind_data->Cast<AnnSearchBatchBindData>();
+	// Column 0 is query_idx
+	return make_uniq<AnnSearchBatchState>(AnnScanProjection(input.column_ids, bind.storage_ids, 1));
 }
 
 static void AnnSearchBatchScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
@@ -301,6 +365,8 @@ static void AnnSearchBatchScan(ClientContext &context, TableFunctionInput &data,
 
 		auto idx_ptr = indexes.Find(bind.index_name);
 		bool found = false;
+		AnnSearchTally tally;
+		AnnSearchTally::Scope scope(&tally);
 
 		// Try DiskannIndex batch search
 		if (idx_ptr) {
@@ -317,14 +383,13 @@ static void AnnSearchBatchScan(ClientContext &context, TableFunctionInput &data,
 		}
 
 #ifdef FAISS_AVAILABLE
-		// FAISS fallback: per-query
+		// FAISS batch search
 		if (!found && idx_ptr) {
 			auto *faiss = dynamic_cast<FaissIndex *>(idx_ptr.get());
 			if (faiss) {
-				for (int32_t qi = 0; qi < static_cast<int32_t>(bind.queries.size()); qi++) {
-					auto &query = bind.queries[qi];
-					auto results = faiss->Search(query.data(), static_cast<int32_t>(query.size()), bind.k);
-					for (auto &pair : results) {
+				auto batch_results = faiss->SearchBatch(bind.queries, bind.k);
+				for (int32_t qi = 0; qi < static_cast<int32_t>(batch_results.size()); qi++) {
+					for (auto &pair : batch_results[qi]) {
 						state.results.push_back({qi, pair.first, pair.second});
 					}
 				}
@@ -336,6 +401,7 @@ static void AnnSearchBatchScan(ClientContext &context, TableFunctionInput &data,
 		if (!found) {
 			throw InvalidInputException("ANN index '%s' not found on table '%s'", bind.index_name, bind.table_name);
 		}
+		state.searched = tally.Get();
 	}
 
 	if (state.offset >= state.results.size()) {
@@ -347,44 +413,47 @@ static void AnnSearchBatchScan(ClientContext &context, TableFunctionInput &data,
 	auto &duck_table =
 	    catalog.GetEntry<TableCatalogEntry>(context, DEFAULT_SCHEMA, bind.table_name).Cast<DuckTableEntry>();
 	auto &storage = duck_table.GetStorage();
-	auto &transaction = DuckTransaction::Get(context, storage.db);
+	auto &proj = state.projection;
 
-	auto num_table_cols = bind.column_types.size();
 	auto batch_size = MinValue<idx_t>(state.results.size() - state.offset, STANDARD_VECTOR_SIZE);
+	auto batch = state.results.data() + state.offset;
 
-	// Build row_id vector
-	Vector row_ids_vec(LogicalType::ROW_TYPE, batch_size);
-	auto row_ids_data = FlatVector::GetData<row_t>(row_ids_vec);
+	row_t row_ids[STANDARD_VECTOR_SIZE];
 	for (idx_t i = 0; i < batch_size; i++) {
-		row_ids_data[i] = state.results[state.offset + i].row_id;
+		row_ids[i] = batch[i].row_id;
 	}
+	SelectionVector kept;
+	auto count = AnnFetchRows(context, storage, proj.fetch_ids, proj.fetch_cols, row_ids, batch_size, output, kept);
 
-	// Fetch rows from table
-	DataChunk fetch_chunk;
-	fetch_chunk.Initialize(context, bind.column_types);
-	ColumnFetchState fetch_state;
-	storage.Fetch(transaction, fetch_chunk, bind.storage_ids, row_ids_vec, batch_size, fetch_state);
-
-	// Column 0: query_idx
-	for (idx_t i = 0; i < batch_size; i++) {
-		output.data[0].SetValue(i, Value::INTEGER(state.results[state.offset + i].query_idx));
+	if (proj.query_idx_col != DConstants::INVALID_INDEX) {
+		auto query_idx = FlatVector::GetData<int32_t>(output.data[proj.query_idx_col]);
+		for (idx_t i = 0; i < count; i++) {
+			query_idx[i] = batch[kept.get_index(i)].query_idx;
+		}
 	}
-
-	// Columns 1..N: table columns
-	for (idx_t col = 0; col < num_table_cols; col++) {
-		for (idx_t i = 0; i < batch_size; i++) {
-			output.data[col + 1].SetValue(i, fetch_chunk.data[col].GetValue(i));
+	if (proj.distance_col != DConstants::INVALID_INDEX) {
+		auto distances = FlatVector::GetData<float>(output.data[proj.distance_col]);
+		for (idx_t i = 0; i < count; i++) {
+			distances[i] = batch[kept.get_index(i)].distance;
 		}
 	}
-
-	// Last column: distance
-	auto dist_col = num_table_cols + 1;
-	for (idx_t i = 0; i < batch_size; i++) {
-		output.data[dist_col].SetValue(i, Value::FLOAT(state.results[state.offset + i].distance));
+	if (proj.row_id_col != DConstants::INVALID_INDEX) {
+		auto out_ids = FlatVector::GetData<row_t>(output.data[proj.row_id_col]);
+		for (idx_t i = 0; i < count; i++) {
+			out_ids[i] = batch[kept.get_index(i)].row_id;
+		}
 	}
 
 	state.offset += batch_size;
-	output.SetCardinality(batch_size);
+	output.SetCardinality(count);
+}
+
+static InsertionOrderPreservingMap<string> AnnSearchBatchToString(TableFunctionDynamicToStringInput &input) {
+	InsertionOrderPreservingMap<string> result;
+	if (input.global_state) {
+		AnnSearchCountersToString(input.global_state->Cast<AnnSearchBatchState>().searched, result);
+	}
+	return result;
 }
 
 // ========================================
@@ -544,29 +613,6 @@ static unique_ptr<LocalTableFunctionState> AnnSearchTableLocalInit(ExecutionCont
 	return make_uniq<AnnSearchTableLocalState>();
 }
 
-/// Extract float vectors from a DataChunk column (LIST or ARRAY of FLOAT).
-static vector<vector<float>> ExtractVectors(DataChunk &input, idx_t col_idx) {
-	vector<vector<float>> result;
-	auto count = input.size();
-	result.reserve(count);
-
-	for (idx_t i = 0; i < count; i++) {
-		auto val = input.data[col_idx].GetValue(i);
-		if (val.IsNull()) {
-			result.emplace_back();
-			continue;
-		}
-		auto &children = ListValue::GetChildren(val);
-		vector<float> vec;
-		vec.reserve(children.size());
-		for (auto &v : children) {
-			vec.push_back(v.GetValue<float>());
-		}
-		result.push_back(std::move(vec));
-	}
-	return result;
-}
-
 static OperatorResultType AnnSearchTableInOut(ExecutionContext &context, TableFunctionInput &data, DataChunk &input,
                                               DataChunk &output) {
 	auto &bind = data.bind_data->Cast<AnnSearchTableBindData>();
@@ -578,7 +624,7 @@ static OperatorResultType AnnSearchTableInOut(ExecutionContext &context, TableFu
 		lstate.results.clear();
 		lstate.emit_offset = 0;
 
-		auto queries = ExtractVectors(input, bind.vector_col_idx);
+		auto queries = AnnExtractVectors(input, bind.vector_col_idx);
 
 		// Find the DiskANN index
 		auto &catalog = Catalog::GetCatalog(client, "");
@@ -611,9 +657,10 @@ static OperatorResultType AnnSearchTableInOut(ExecutionContext &context, TableFu
 		else {
 			auto *faiss = dynamic_cast<FaissIndex *>(idx_ptr.get());
 			if (faiss) {
-				for (idx_t qi = 0; qi < queries.size(); qi++) {
-					auto results = faiss->Search(queries[qi].data(), static_cast<int32_t>(queries[qi].size()), bind.k);
-					for (auto &pair : results) {
+				// The whole input chunk is one nq = chunk.size() FAISS search
+				auto batch_results = faiss->SearchBatch(queries, bind.k);
+				for (idx_t qi = 0; qi < batch_results.size(); qi++) {
+					for (auto &pair : batch_results[qi]) {
 						lstate.results.push_back({qi, pair.first, pair.second});
 					}
 				}
@@ -635,46 +682,42 @@ static OperatorResultType AnnSearchTableInOut(ExecutionContext &context, TableFu
 	auto batch_size = MinValue<idx_t>(remaining, STANDARD_VECTOR_SIZE);
 	auto n_input_cols = bind.input_types.size();
 	auto n_base_cols = bind.base_column_types.size();
+	auto batch = lstate.results.data() + lstate.emit_offset;
 
-	// Copy input columns (replicated per result row)
-	for (idx_t col = 0; col < n_input_cols; col++) {
-		for (idx_t i = 0; i < batch_size; i++) {
-			auto input_row = lstate.results[lstate.emit_offset + i].input_row;
-			output.data[col].SetValue(i, input.data[col].GetValue(input_row));
-		}
-	}
-
-	// Fetch base table rows
+	// Fetch base table rows straight into their output columns
 	auto &catalog = Catalog::GetCatalog(client, "");
 	auto &duck_table =
 	    catalog.GetEntry<TableCatalogEntry>(client, DEFAULT_SCHEMA, bind.table_name).Cast<DuckTableEntry>();
 	auto &storage = duck_table.GetStorage();
-	auto &transaction = DuckTransaction::Get(client, storage.db);
 
-	Vector row_ids_vec(LogicalType::ROW_TYPE, batch_size);
-	auto row_ids_data = FlatVector::GetData<row_t>(row_ids_vec);
+	row_t row_ids[STANDARD_VECTOR_SIZE];
 	for (idx_t i = 0; i < batch_size; i++) {
-		row_ids_data[i] = lstate.results[lstate.emit_offset + i].base_row_id;
+		row_ids[i] = batch[i].base_row_id;
 	}
-
-	DataChunk fetch_chunk;
-	fetch_chunk.Initialize(client, bind.base_column_types);
-	ColumnFetchState fetch_state;
-	storage.Fetch(transaction, fetch_chunk, bind.base_storage_ids, row_ids_vec, batch_size, fetch_state);
-
+	vector<idx_t> base_cols;
 	for (idx_t col = 0; col < n_base_cols; col++) {
-		for (idx_t i = 0; i < batch_size; i++) {
-			output.data[n_input_cols + col].SetValue(i, fetch_chunk.data[col].GetValue(i));
-		}
+		base_cols.push_back(n_input_cols + col);
+	}
+	SelectionVector kept;
+	auto count =
+	    AnnFetchRows(client, storage, bind.base_storage_ids, base_cols, row_ids, batch_size, output, kept);
+
+	// Input columns, replicated per result row
+	SelectionVector input_sel(count);
+	for (idx_t i = 0; i < count; i++) {
+		input_sel.set_index(i, batch[kept.get_index(i)].input_row);
+	}
+	for (idx_t col = 0; col < n_input_cols; col++) {
+		VectorOperations::Copy(input.data[col], output.data[col], input_sel, count, 0, 0);
 	}
 
 	// Distance column (last)
-	auto dist_col = n_input_cols + n_base_cols;
-	for (idx_t i = 0; i < batch_size; i++) {
-		output.data[dist_col].SetValue(i, Value::FLOAT(lstate.results[lstate.emit_offset + i].distance));
+	auto distances = FlatVector::GetData<float>(output.data[n_input_cols + n_base_cols]);
+	for (idx_t i = 0; i < count; i++) {
+		distances[i] = batch[kept.get_index(i)].distance;
 	}
 
-	output.SetCardinality(batch_size);
+	output.SetCardinality(count);
 	lstate.emit_offset += batch_size;
 
 	if (lstate.emit_offset >= lstate.results.size()) {
@@ -698,25 +741,10 @@ static OperatorFinalizeResultType AnnSearchTableFinal(ExecutionContext &context,
 /// At 768-dim: fires at ~64 candidates (49152/768=64).
 static constexpr size_t MIN_GPU_WORK_ONESHOT = 49152;
 
-/// CPU L2/IP distance computation fallback.
+/// CPU L2/IP distance computation fallback: the graph search's SIMD kernels (IP negated so lower is better).
 static void ComputeDistancesCPU(const float *query, const float *candidates, idx_t n, idx_t dim, int metric,
                                 float *out) {
-	for (idx_t i = 0; i < n; i++) {
-		const float *cand = candidates + i * dim;
-		float sum = 0;
-		if (metric == 0) { // L2
-			for (idx_t j = 0; j < dim; j++) {
-				float diff = query[j] - cand[j];
-				sum += diff * diff;
-			}
-		} else { // IP — negate so lower is better
-			for (idx_t j = 0; j < dim; j++) {
-				sum += query[j] * cand[j];
-			}
-			sum = -sum;
-		}
-		out[i] = sum;
-	}
+	DiskannComputeDistances(query, candidates, static_cast<uint64_t>(n), static_cast<uint32_t>(dim), metric, out);
 }
 
 /// Compute distances: Metal GPU if batch large enough, else CPU.
@@ -737,10 +765,15 @@ static void ComputeDistances(const float *query, const float *candidates, idx_t
 // Compute distances between a query vector and candidate vectors from TABLE input.
 // Uses Metal GPU when batch is large enough, CPU SIMD otherwise.
 // Returns: all input columns + _distance.
+//
+// With top_k := n only the n nearest rows come out, ordered by distance. Each thread keeps
+// the best n rows it has seen in a heap (rows that don't make it are never materialized);
+// finished threads merge their heaps into the global state, and the last one emits them.
 
 struct VectorDistancesBindData : public FunctionData {
 	vector<float> query;
 	int metric = 0; // 0=L2, 1=IP
+	idx_t top_k = 0; // 0 = every row
 
 	idx_t vector_col_idx;
 	vector<LogicalType> input_types;
@@ -750,6 +783,7 @@ struct VectorDistancesBindData : public FunctionData {
 		auto copy = make_uniq<VectorDistancesBindData>();
 		copy->query = query;
 		copy->metric = metric;
+		copy->top_k = top_k;
 		copy->vector_col_idx = vector_col_idx;
 		copy->input_types = input_types;
 		copy->input_names = input_names;
@@ -758,17 +792,43 @@ struct VectorDistancesBindData : public FunctionData {
 
 	bool Equals(const FunctionData &other_p) const override {
 		auto &other = other_p.Cast<VectorDistancesBindData>();
-		return query == other.query && metric == other.metric && vector_col_idx == other.vector_col_idx;
+		return query == other.query && metric == other.metric && top_k == other.top_k &&
+		       vector_col_idx == other.vector_col_idx;
 	}
 };
 
+// One candidate kept for top_k: its distance and input row
+struct VectorDistancesRow {
+	float distance;
+	vector<Value> values;
+};
+
+static bool VectorDistancesRowLess(const VectorDistancesRow &a, const VectorDistancesRow &b) {
+	return a.distance < b.distance;
+}
+
 struct VectorDistancesGlobalState : public GlobalTableFunctionState {
+	// top_k: rows merged by finished threads, and the threads still running
+	mutex lock;
+	vector<VectorDistancesRow> top;
+	idx_t active_threads = 0;
+
 	idx_t MaxThreads() const override {
 		return 1;
 	}
 };
 
-struct VectorDistancesLocalState : public LocalTableFunctionState {};
+struct VectorDistancesLocalState : public LocalTableFunctionState {
+	// Per-chunk scratch: candidate vectors that cannot be read in place
+	vector<float> flat;
+	vector<float> distances;
+	// top_k: max-heap on distance of this thread's best rows
+	vector<VectorDistancesRow> heap;
+	bool merged = false;
+	// The result, on the thread that emits it
+	vector<VectorDistancesRow> results;
+	idx_t emit_offset = 0;
+};
 
 static unique_ptr<FunctionData> VectorDistancesBind(ClientContext &context, TableFunctionBindInput &input,
                                                     vector<LogicalType> &return_types, vector<string> &names) {
@@ -786,6 +846,12 @@ static unique_ptr<FunctionData> VectorDistancesBind(ClientContext &context, Tabl
 			if (val == "IP" || val == "ip" || val == "inner_product") {
 				bind_data->metric = 1;
 			}
+		} else if (kv.first == "top_k") {
+			auto top_k = kv.second.GetValue<int64_t>();
+			if (top_k <= 0) {
+				throw BinderException("vector_distances: top_k must be positive");
+			}
+			bind_data->top_k = static_cast<idx_t>(top_k);
 		}
 	}
 
@@ -838,12 +904,111 @@ static unique_ptr<GlobalTableFunctionState> VectorDistancesGlobalInit(ClientCont
 static unique_ptr<LocalTableFunctionState> VectorDistancesLocalInit(ExecutionContext &context,
                                                                     TableFunctionInitInput &input,
                                                                     GlobalTableFunctionState *global_state) {
+	auto &gstate = global_state->Cast<VectorDistancesGlobalState>();
+	lock_guard<mutex> guard(gstate.lock);
+	gstate.active_threads++;
 	return make_uniq<VectorDistancesLocalState>();
 }
 
+// Keep input row i if it is among the top_k nearest this thread has seen
+static void VectorDistancesOffer(VectorDistancesLocalState &lstate, idx_t top_k, DataChunk &input, idx_t n_cols,
+                                 idx_t i, float distance) {
+	auto &heap = lstate.heap;
+	if (heap.size() == top_k && !(distance < heap.front().distance)) {
+		return;
+	}
+	VectorDistancesRow row {distance, {}};
+	row.values.reserve(n_cols);
+	for (idx_t col = 0; col < n_cols; col++) {
+		row.values.push_back(input.data[col].GetValue(i));
+	}
+	if (heap.size() == top_k) {
+		std::pop_heap(heap.begin(), heap.end(), VectorDistancesRowLess);
+		heap.back() = std::move(row);
+	} else {
+		heap.push_back(std::move(row));
+	}
+	std::push_heap(heap.begin(), heap.end(), VectorDistancesRowLess);
+}
+
+// Zero the elements of a row-major count x dim float block that the child validity marks NULL
+static void ZeroNullElements(const ValidityMask &validity, idx_t offset, idx_t n, float *out) {
+	if (validity.AllValid()) {
+		return;
+	}
+	for (idx_t e = 0; e < n; e++) {
+		if (!validity.RowIsValid(offset + e)) {
+			out[e] = 0.0f;
+		}
+	}
+}
+
+// The candidate vectors of the chunk as a row-major count x dim block. FLOAT[dim] arrays are
+// used in place when nothing is NULL; FLOAT[dim] with NULLs and FLOAT lists are copied into
+// scratch; other element types are converted through Value. NULL rows and rows of another
+// length read as zero vectors.
+static const float *VectorDistancesRows(Vector &column, idx_t count, idx_t dim, vector<float> &scratch) {
+	auto &type = column.GetType();
+	if (type.id() == LogicalTypeId::ARRAY && ArrayType::GetChildType(type).id() == LogicalTypeId::FLOAT &&
+	    ArrayType::GetSize(type) == dim) {
+		column.Flatten(count);
+		auto &child = ArrayVector::GetEntry(column);
+		auto data = FlatVector::GetData<float>(child);
+		auto &validity = FlatVector::Validity(column);
+		auto &child_validity = FlatVector::Validity(child);
+		if (validity.AllValid() && child_validity.AllValid()) {
+			return data;
+		}
+		scratch.resize(count * dim);
+		memcpy(scratch.data(), data, count * dim * sizeof(float));
+		ZeroNullElements(child_validity, 0, count * dim, scratch.data());
+		if (!validity.AllValid()) {
+			for (idx_t i = 0; i < count; i++) {
+				if (!validity.RowIsValid(i)) {
+					memset(scratch.data() + i * dim, 0, dim * sizeof(float));
+				}
+			}
+		}
+		return scratch.data();
+	}
+	scratch.resize(count * dim);
+	if (type.id() == LogicalTypeId::LIST && ListType::GetChildType(type).id() == LogicalTypeId::FLOAT) {
+		column.Flatten(count);
+		auto entries = FlatVector::GetData<list_entry_t>(column);
+		auto &validity = FlatVector::Validity(column);
+		auto &child = ListVector::GetEntry(column);
+		auto data = FlatVector::GetData<float>(child);
+		auto &child_validity = FlatVector::Validity(child);
+		for (idx_t i = 0; i < count; i++) {
+			auto row = scratch.data() + i * dim;
+			if (!validity.RowIsValid(i) || entries[i].length != dim) {
+				memset(row, 0, dim * sizeof(float));
+				continue;
+			}
+			memcpy(row, data + entries[i].offset, dim * sizeof(float));
+			ZeroNullElements(child_validity, entries[i].offset, dim, row);
+		}
+		return scratch.data();
+	}
+	DataChunk single;
+	single.InitializeEmpty({type});
+	single.data[0].Reference(column);
+	single.SetCardinality(count);
+	auto vectors = AnnExtractVectors(single, 0);
+	for (idx_t i = 0; i < count; i++) {
+		if (vectors[i].size() == dim) {
+			memcpy(scratch.data() + i * dim, vectors[i].data(), dim * sizeof(float));
+		} else {
+			memset(scratch.data() + i * dim, 0, dim * sizeof(float));
+		}
+	}
+	return scratch.data();
+}
+
 static OperatorResultType VectorDistancesInOut(ExecutionContext &context, TableFunctionInput &data, DataChunk &input,
                                                DataChunk &output) {
 	auto &bind = data.bind_data->Cast<VectorDistancesBindData>();
+	auto &lstate = data.local_state->Cast<VectorDistancesLocalState>();
 	auto count = input.size();
 
 	if (count == 0) {
@@ -854,41 +1019,73 @@ static OperatorResultType VectorDistancesInOut(ExecutionContext &context, TableF
 	auto dim = bind.query.size();
 	auto n_input_cols = bind.input_types.size();
 
-	// Extract vectors from input chunk
-	auto vectors = ExtractVectors(input, bind.vector_col_idx);
-
-	// Gather into contiguous buffer for GPU/CPU batch computation
-	vector<float> flat(count * dim, 0.0f);
-	for (idx_t i = 0; i < count; i++) {
-		if (vectors[i].size() == dim) {
-			memcpy(flat.data() + i * dim, vectors[i].data(), dim * sizeof(float));
-		}
-	}
+	// Contiguous candidate block for GPU/CPU batch computation
+	auto candidates = VectorDistancesRows(input.data[bind.vector_col_idx], count, dim, lstate.flat);
 
 	// Compute distances (GPU if large enough, else CPU)
-	vector<float> distances(count);
-	ComputeDistances(bind.query.data(), flat.data(), count, dim, bind.metric, distances.data());
+	lstate.distances.resize(count);
+	ComputeDistances(bind.query.data(), candidates, count, dim, bind.metric, lstate.distances.data());
 
-	// Copy all input columns to output
-	for (idx_t col = 0; col < n_input_cols; col++) {
+	if (bind.top_k > 0) {
 		for (idx_t i = 0; i < count; i++) {
-			output.data[col].SetValue(i, input.data[col].GetValue(i));
+			VectorDistancesOffer(lstate, bind.top_k, input, n_input_cols, i, lstate.distances[i]);
 		}
+		output.SetCardinality(0);
+		return OperatorResultType::NEED_MORE_INPUT;
 	}
 
-	// Append distance column
-	for (idx_t i = 0; i < count; i++) {
-		output.data[n_input_cols].SetValue(i, Value::FLOAT(distances[i]));
+	// Input columns pass through unchanged
+	for (idx_t col = 0; col < n_input_cols; col++) {
+		output.data[col].Reference(input.data[col]);
 	}
 
+	// Append distance column
+	memcpy(FlatVector::GetData<float>(output.data[n_input_cols]), lstate.distances.data(), count * sizeof(float));
+
 	output.SetCardinality(count);
 	return OperatorResultType::NEED_MORE_INPUT;
 }
 
 static OperatorFinalizeResultType VectorDistancesFinal(ExecutionContext &context, TableFunctionInput &data,
                                                        DataChunk &output) {
-	output.SetCardinality(0);
-	return OperatorFinalizeResultType::FINISHED;
+	auto &bind = data.bind_data->Cast<VectorDistancesBindData>();
+	if (bind.top_k == 0) {
+		output.SetCardinality(0);
+		return OperatorFinalizeResultType::FINISHED;
+	}
+	auto &gstate = data.global_state->Cast<VectorDistancesGlobalState>();
+	auto &lstate = data.local_state->Cast<VectorDistancesLocalState>();
+	if (!lstate.merged) {
+		lstate.merged = true;
+		lock_guard<mutex> guard(gstate.lock);
+		for (auto &row : lstate.heap) {
+			gstate.top.push_back(std::move(row));
+		}
+		lstate.heap.clear();
+		// Threads that start after this point find the input exhausted: they add nothing
+		if (--gstate.active_threads == 0) {
+			lstate.results = std::move(gstate.top);
+			gstate.top.clear();
+			std::sort(lstate.results.begin(), lstate.results.end(), VectorDistancesRowLess);
+			if (lstate.results.size() > bind.top_k) {
+				lstate.results.resize(bind.top_k);
+			}
+		}
+	}
+
+	auto n_input_cols = bind.input_types.size();
+	auto chunk_size = MinValue<idx_t>(STANDARD_VECTOR_SIZE, lstate.results.size() - lstate.emit_offset);
+	for (idx_t i = 0; i < chunk_size; i++) {
+		auto &row = lstate.results[lstate.emit_offset + i];
+		for (idx_t col = 0; col < n_input_cols; col++) {
+			output.SetValue(col, i, row.values[col]);
+		}
+		output.SetValue(n_input_cols, i, Value::FLOAT(row.distance));
+	}
+	output.SetCardinality(chunk_size);
+	lstate.emit_offset += chunk_size;
+	return lstate.emit_offset < lstate.results.size() ? OperatorFinalizeResultType::HAVE_MORE_OUTPUT
+	                                                  : OperatorFinalizeResultType::FINISHED;
 }
 
 // ========================================
@@ -898,77 +1095,214 @@ static OperatorFinalizeResultType VectorDistancesFinal(ExecutionContext &context
 // Returns: all table columns + _rrf_score + _bm25_rank + _vector_rank.
 //
 // Requires DuckDB's FTS extension to be loaded and an FTS index created on the table.
-// FTS schema is derived as fts_main_<table_name>.
+// FTS schema is derived as fts_main_<table_name>. Without it, ranking is vector-only.
+//
+// hybrid_search binds to a query over the table: the BM25 leg (top bm25_candidates rows by
+// match_bm25, ranked) and the optional filter's row ids are unioned into hybrid_search_fuse,
+// an in-out function that runs the vector leg over the filtered rows and fuses the two
+// rankings. Both legs are ordinary operators of the caller's query, so they run in its
+// transaction and see its uncommitted changes.
+
+// RRF constant
+static constexpr float RRF_K = 60.0f;
+
+// Filtered vector legs with at most this many allowed rows score them all exactly
+static constexpr idx_t HYBRID_EXHAUSTIVE_MAX_ROWS = 8192;
+
+/// Quote a SQL identifier (table/column name).
+static string QuoteIdentifier(const string &name) {
+	return KeywordHelper::WriteQuoted(name, '"');
+}
+
+// The filter is spliced into the legs' SQL, so it must be exactly one row predicate: it is
+// parsed on its own and the parsed expression, re-rendered, is what the legs run
+static string ParseHybridFilter(ClientContext &context, const string &filter) {
+	if (filter.empty()) {
+		return filter;
+	}
+	vector<unique_ptr<ParsedExpression>> expressions;
+	try {
+		expressions = Parser::ParseExpressionList(filter, context.GetParserOptions());
+	} catch (ParserException &) {
+		throw BinderException("hybrid_search: filter is not a SQL expression: %s", filter);
+	}
+	if (expressions.size() != 1) {
+		throw BinderException("hybrid_search: filter must be a single expression, got %d", expressions.size());
+	}
+	if (expressions[0]->HasSubquery()) {
+		throw BinderException("hybrid_search: filter must not contain a subquery");
+	}
+	return expressions[0]->ToString();
+}
+
+static unique_ptr<SelectStatement> ParseHybridQuery(ClientContext &context, const string &sql) {
+	Parser parser(context.GetParserOptions());
+	parser.ParseQuery(sql);
+	D_ASSERT(parser.statements.size() == 1 && parser.statements[0]->type == StatementType::SELECT_STATEMENT);
+	return unique_ptr_cast<SQLStatement, SelectStatement>(std::move(parser.statements[0]));
+}
+
+// Bind the filter leg up front, so a filter over unknown columns or of the wrong type is
+// reported as hybrid_search's rather than as an error inside the expansion
+static void CheckHybridFilter(ClientContext &context, const string &filter_sql) {
+	auto statement = ParseHybridQuery(context, filter_sql);
+	try {
+		auto binder = Binder::CreateBinder(context);
+		binder->Bind(*statement);
+	} catch (std::exception &ex) {
+		ErrorData error(ex);
+		throw BinderException("hybrid_search filter failed: %s", error.RawMessage());
+	}
+}
+
+static unique_ptr<TableRef> HybridSearchBindReplace(ClientContext &context, TableFunctionBindInput &input) {
+	auto table_name = input.inputs[0].GetValue<string>();
+	auto index_name = input.inputs[1].GetValue<string>();
+	auto id_column = input.inputs[3].GetValue<string>();
+	auto query_text = input.inputs[5].GetValue<string>();
+
+	string filter;
+	int32_t bm25_candidates = 50;
+	// Everything else configures the fusion
+	string fuse_params;
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "filter") {
+			filter = ParseHybridFilter(context, kv.second.GetValue<string>());
+		} else if (kv.first == "bm25_candidates") {
+			bm25_candidates = kv.second.GetValue<int32_t>();
+		} else {
+			fuse_params += ", " + kv.first + " := " + kv.second.ToSQLString();
+		}
+	}
+
+	// Both legs see the same rows: the filter applies to the BM25 query and selects the
+	// row ids the vector leg may return
+	auto table = QuoteIdentifier(table_name);
+	auto where = filter.empty() ? string() : " AND (" + filter + ")";
+	vector<string> legs;
+	auto fts_schema = "fts_main_" + table_name;
+	if (bm25_candidates > 0 && Catalog::GetSchema(context, INVALID_CATALOG, fts_schema, OnEntryNotFound::RETURN_NULL)) {
+		legs.push_back("SELECT __rowid, (row_number() OVER (ORDER BY __score DESC, __rowid))::INTEGER "
+		               "FROM (SELECT rowid AS __rowid, " +
+		               QuoteIdentifier(fts_schema) + ".match_bm25(" + QuoteIdentifier(id_column) + ", " +
+		               Value(query_text).ToSQLString() + ") AS __score FROM " + table +
+		               " WHERE __score IS NOT NULL" + where + " ORDER BY __score DESC, __rowid LIMIT " +
+		               to_string(bm25_candidates) + ")");
+	}
+	if (!filter.empty()) {
+		auto filter_leg = "SELECT rowid, NULL::INTEGER FROM " + table + " WHERE (" + filter + ")";
+		CheckHybridFilter(context, filter_leg);
+		legs.push_back(filter_leg);
+	}
+	if (legs.empty()) {
+		legs.push_back("SELECT NULL::BIGINT, NULL::INTEGER WHERE false");
+	}
+	string rows;
+	for (auto &leg : legs) {
+		rows += (rows.empty() ? "(" : ") UNION ALL (") + leg;
+	}
+	rows += ")";
+
+	auto sql = "SELECT * EXCLUDE (__hybrid_rank) FROM hybrid_search_fuse((" + rows + "), " +
+	           Value(table_name).ToSQLString() + ", " + Value(index_name).ToSQLString() + ", " +
+	           input.inputs[4].ToSQLString() + ", filtered := " + (filter.empty() ? "false" : "true") + fuse_params +
+	           ") ORDER BY __hybrid_rank";
+	return make_uniq<SubqueryRef>(ParseHybridQuery(context, sql));
+}
+
+// hybrid_search_fuse(TABLE rows, table, index, query_vec): rows are (row id, BM25 rank), the
+// rank NULL for the filter's rows. Every thread collects its input; the last one to finish
+// runs the vector leg, fuses and emits the top k in order, numbered by __hybrid_rank.
 
-struct HybridSearchBindData : public TableFunctionData {
+struct HybridFuseBindData : public FunctionData {
 	string table_name;
-	string diskann_index_name;
-	string vector_column;
-	string id_column;
+	string index_name;
 	vector<float> query_vector;
-	string query_text;
+	bool filtered = false;
 
 	int32_t k = 20;
 	float bm25_weight = 0.3f;
 	float vector_weight = 0.7f;
-	int32_t bm25_candidates = 50;
 	int32_t vector_candidates = 50;
 	int32_t search_complexity = 0;
 
 	// Resolved at bind time
-	vector<string> column_names;
 	vector<LogicalType> column_types;
 	vector<StorageIndex> storage_ids;
+
+	unique_ptr<FunctionData> Copy() const override {
+		auto copy = make_uniq<HybridFuseBindData>();
+		copy->table_name = table_name;
+		copy->index_name = index_name;
+		copy->query_vector = query_vector;
+		copy->filtered = filtered;
+		copy->k = k;
+		copy->bm25_weight = bm25_weight;
+		copy->vector_weight = vector_weight;
+		copy->vector_candidates = vector_candidates;
+		copy->search_complexity = search_complexity;
+		copy->column_types = column_types;
+		copy->storage_ids = storage_ids;
+		return std::move(copy);
+	}
+
+	bool Equals(const FunctionData &other_p) const override {
+		auto &other = other_p.Cast<HybridFuseBindData>();
+		return table_name == other.table_name && index_name == other.index_name &&
+		       query_vector == other.query_vector && filtered == other.filtered && k == other.k &&
+		       bm25_weight == other.bm25_weight && vector_weight == other.vector_weight &&
+		       vector_candidates == other.vector_candidates && search_complexity == other.search_complexity;
+	}
 };
 
-struct HybridSearchState : public GlobalTableFunctionState {
-	struct HybridResult {
-		row_t row_id;
-		float rrf_score;
-		int32_t bm25_rank;   // 0 = not in BM25 results
-		int32_t vector_rank; // 0 = not in vector results
-	};
-	vector<HybridResult> results;
-	idx_t offset = 0;
-	bool fetched = false;
+struct HybridResult {
+	row_t row_id;
+	float rrf_score;
+	int32_t bm25_rank;   // 0 = not in BM25 results
+	int32_t vector_rank; // 0 = not in vector results
+};
 
-	idx_t MaxThreads() const override {
-		return 1;
+// The input rows of one thread, or of all finished threads
+struct HybridFuseInput {
+	vector<pair<row_t, int32_t>> bm25; // (row id, rank)
+	vector<row_t> allowed;
+
+	void Append(HybridFuseInput &other) {
+		bm25.insert(bm25.end(), other.bm25.begin(), other.bm25.end());
+		allowed.insert(allowed.end(), other.allowed.begin(), other.allowed.end());
+		other.bm25.clear();
+		other.allowed.clear();
 	}
 };
 
-/// Escape single quotes in SQL string literals.
-static string EscapeSQLString(const string &input) {
-	string result;
-	result.reserve(input.size());
-	for (char c : input) {
-		if (c == '\'') {
-			result += "''";
-		} else {
-			result += c;
-		}
+struct HybridFuseGlobalState : public GlobalTableFunctionState {
+	mutex lock;
+	HybridFuseInput rows;
+	idx_t active_threads = 0;
+
+	idx_t MaxThreads() const override {
+		return 1;
 	}
-	return result;
-}
+};
 
-/// Quote a SQL identifier (table/column name).
-static string QuoteIdentifier(const string &name) {
-	return "\"" + name + "\"";
-}
+struct HybridFuseLocalState : public LocalTableFunctionState {
+	HybridFuseInput rows;
+	bool merged = false;
+	// The result, on the thread that emits it
+	vector<HybridResult> results;
+	idx_t emit_offset = 0;
+};
 
-static unique_ptr<FunctionData> HybridSearchBind(ClientContext &context, TableFunctionBindInput &input,
-                                                 vector<LogicalType> &return_types, vector<string> &names) {
-	auto bind_data = make_uniq<HybridSearchBindData>();
-	bind_data->table_name = input.inputs[0].GetValue<string>();
-	bind_data->diskann_index_name = input.inputs[1].GetValue<string>();
-	bind_data->vector_column = input.inputs[2].GetValue<string>();
-	bind_data->id_column = input.inputs[3].GetValue<string>();
+static unique_ptr<FunctionData> HybridFuseBind(ClientContext &context, TableFunctionBindInput &input,
+                                               vector<LogicalType> &return_types, vector<string> &names) {
+	auto bind_data = make_uniq<HybridFuseBindData>();
 
-	auto &query_list = ListValue::GetChildren(input.inputs[4]);
-	for (auto &v : query_list) {
+	// inputs[0] is empty (TABLE placeholder)
+	bind_data->table_name = input.inputs[1].GetValue<string>();
+	bind_data->index_name = input.inputs[2].GetValue<string>();
+	for (auto &v : ListValue::GetChildren(input.inputs[3])) {
 		bind_data->query_vector.push_back(v.GetValue<float>());
 	}
-	bind_data->query_text = input.inputs[5].GetValue<string>();
 
 	for (auto &kv : input.named_parameters) {
 		if (kv.first == "k") {
@@ -977,15 +1311,20 @@ static unique_ptr<FunctionData> HybridSearchBind(ClientContext &context, TableFu
 			bind_data->bm25_weight = kv.second.GetValue<float>();
 		} else if (kv.first == "vector_weight") {
 			bind_data->vector_weight = kv.second.GetValue<float>();
-		} else if (kv.first == "bm25_candidates") {
-			bind_data->bm25_candidates = kv.second.GetValue<int32_t>();
 		} else if (kv.first == "vector_candidates") {
 			bind_data->vector_candidates = kv.second.GetValue<int32_t>();
 		} else if (kv.first == "search_complexity") {
 			bind_data->search_complexity = kv.second.GetValue<int32_t>();
+		} else if (kv.first == "filtered") {
+			bind_data->filtered = kv.second.GetValue<bool>();
 		}
 	}
 
+	if (input.input_table_types.size() != 2 || input.input_table_types[0].id() != LogicalTypeId::BIGINT ||
+	    input.input_table_types[1].id() != LogicalTypeId::INTEGER) {
+		throw BinderException("hybrid_search_fuse: input must be (row id BIGINT, BM25 rank INTEGER)");
+	}
+
 	// Look up the table to get its columns
 	auto &catalog = Catalog::GetCatalog(context, "");
 	auto &duck_table =
@@ -993,7 +1332,6 @@ static unique_ptr<FunctionData> HybridSearchBind(ClientContext &context, TableFu
 	auto &columns = duck_table.GetColumns();
 
 	for (auto &col : columns.Physical()) {
-		bind_data->column_names.push_back(col.Name());
 		bind_data->column_types.push_back(col.Type());
 		bind_data->storage_ids.emplace_back(columns.LogicalToPhysical(col.Logical()).index);
 		names.push_back(col.Name());
@@ -1007,159 +1345,188 @@ static unique_ptr<FunctionData> HybridSearchBind(ClientContext &context, TableFu
 	return_types.push_back(LogicalType::INTEGER);
 	names.push_back("_vector_rank");
 	return_types.push_back(LogicalType::INTEGER);
+	names.push_back("__hybrid_rank");
+	return_types.push_back(LogicalType::BIGINT);
 
 	return std::move(bind_data);
 }
 
-static unique_ptr<GlobalTableFunctionState> HybridSearchInit(ClientContext &context, TableFunctionInitInput &input) {
-	return make_uniq<HybridSearchState>();
+static unique_ptr<GlobalTableFunctionState> HybridFuseGlobalInit(ClientContext &context,
+                                                                TableFunctionInitInput &input) {
+	return make_uniq<HybridFuseGlobalState>();
 }
 
-static void HybridSearchScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
-	auto &bind = data.bind_data->Cast<HybridSearchBindData>();
-	auto &state = data.global_state->Cast<HybridSearchState>();
+static unique_ptr<LocalTableFunctionState> HybridFuseLocalInit(ExecutionContext &context, TableFunctionInitInput &input,
+                                                               GlobalTableFunctionState *global_state) {
+	auto &gstate = global_state->Cast<HybridFuseGlobalState>();
+	lock_guard<mutex> guard(gstate.lock);
+	gstate.active_threads++;
+	return make_uniq<HybridFuseLocalState>();
+}
 
-	if (!state.fetched) {
-		state.fetched = true;
+static OperatorResultType HybridFuseInOut(ExecutionContext &context, TableFunctionInput &data, DataChunk &input,
+                                          DataChunk &output) {
+	auto &lstate = data.local_state->Cast<HybridFuseLocalState>();
+	UnifiedVectorFormat row_ids;
+	UnifiedVectorFormat ranks;
+	input.data[0].ToUnifiedFormat(input.size(), row_ids);
+	input.data[1].ToUnifiedFormat(input.size(), ranks);
+	auto row_id_data = UnifiedVectorFormat::GetData<row_t>(row_ids);
+	auto rank_data = UnifiedVectorFormat::GetData<int32_t>(ranks);
+	for (idx_t i = 0; i < input.size(); i++) {
+		auto row = row_ids.sel->get_index(i);
+		if (!row_ids.validity.RowIsValid(row)) {
+			continue;
+		}
+		auto rank = ranks.sel->get_index(i);
+		if (ranks.validity.RowIsValid(rank)) {
+			lstate.rows.bm25.emplace_back(row_id_data[row], rank_data[rank]);
+		} else {
+			lstate.rows.allowed.push_back(row_id_data[row]);
+		}
+	}
+	output.SetCardinality(0);
+	return OperatorResultType::NEED_MORE_INPUT;
+}
 
-		// RRF constant
-		constexpr float RRF_K = 60.0f;
+// The vector leg, restricted to the filter's rows when there is one
+static vector<pair<row_t, float>> HybridVectorLeg(ClientContext &context, const HybridFuseBindData &bind,
+                                                  const vector<row_t> &allowed) {
+	auto &catalog = Catalog::GetCatalog(context, "");
+	auto &duck_table =
+	    catalog.GetEntry<TableCatalogEntry>(context, DEFAULT_SCHEMA, bind.table_name).Cast<DuckTableEntry>();
+	auto &storage = duck_table.GetStorage();
+	auto &table_info = *storage.GetDataTableInfo();
+	auto &indexes = table_info.GetIndexes();
 
-		// Maps row_id -> (bm25_rank, vector_rank)
-		unordered_map<row_t, pair<int32_t, int32_t>> rank_map;
+	indexes.Bind(context, table_info, DiskannIndex::TYPE_NAME);
 
-		// ---- Step 1: BM25 search via DuckDB FTS ----
-		// Use a separate Connection to avoid deadlocking the ClientContext mutex.
-		{
-			auto fts_schema = "fts_main_" + bind.table_name;
-			auto escaped_query = EscapeSQLString(bind.query_text);
-			auto sql = "SELECT rowid, " + QuoteIdentifier(fts_schema) + ".match_bm25(" +
-			           QuoteIdentifier(bind.id_column) + ", '" + escaped_query + "') AS __score FROM " +
-			           QuoteIdentifier(bind.table_name) + " WHERE __score IS NOT NULL ORDER BY __score DESC LIMIT " +
-			           to_string(bind.bm25_candidates);
-
-			Connection fts_conn(*context.db);
-			auto result = fts_conn.Query(sql);
-			if (!result->HasError()) {
-				int32_t rank = 1;
-				while (true) {
-					auto chunk = result->Fetch();
-					if (!chunk || chunk->size() == 0) {
-						break;
-					}
-					for (idx_t i = 0; i < chunk->size(); i++) {
-						auto rowid = chunk->data[0].GetValue(i).GetValue<row_t>();
-						rank_map[rowid].first = rank++;
-					}
-				}
-			}
-			// If FTS fails (extension not loaded or index not created), proceed with vector-only
-		}
+	auto idx_ptr = indexes.Find(bind.index_name);
+	if (!idx_ptr) {
+		throw InvalidInputException("ANN index '%s' not found on table '%s'", bind.index_name, bind.table_name);
+	}
 
-		// ---- Step 2: DiskANN vector search ----
-		{
-			auto &catalog = Catalog::GetCatalog(context, "");
-			auto &duck_table =
-			    catalog.GetEntry<TableCatalogEntry>(context, DEFAULT_SCHEMA, bind.table_name).Cast<DuckTableEntry>();
-			auto &storage = duck_table.GetStorage();
-			auto &table_info = *storage.GetDataTableInfo();
-			auto &indexes = table_info.GetIndexes();
-
-			indexes.Bind(context, table_info, DiskannIndex::TYPE_NAME);
-
-			auto idx_ptr = indexes.Find(bind.diskann_index_name);
-			if (!idx_ptr) {
-				throw InvalidInputException("ANN index '%s' not found on table '%s'", bind.diskann_index_name,
-				                            bind.table_name);
-			}
+	auto *diskann = dynamic_cast<DiskannIndex *>(idx_ptr.get());
+	if (!diskann) {
+		throw InvalidInputException("Index '%s' is not a DiskANN index", bind.index_name);
+	}
 
-			auto *diskann = dynamic_cast<DiskannIndex *>(idx_ptr.get());
-			if (!diskann) {
-				throw InvalidInputException("Index '%s' is not a DiskANN index", bind.diskann_index_name);
-			}
+	auto dim = static_cast<int32_t>(bind.query_vector.size());
+	if (!bind.filtered) {
+		return diskann->Search(bind.query_vector.data(), dim, bind.vector_candidates, bind.search_complexity);
+	}
+	return diskann->SearchFiltered(bind.query_vector.data(), dim, bind.vector_candidates, bind.search_complexity,
+	                               allowed, allowed.size() <= HYBRID_EXHAUSTIVE_MAX_ROWS);
+}
 
-			auto vector_results =
-			    diskann->Search(bind.query_vector.data(), static_cast<int32_t>(bind.query_vector.size()),
-			                    bind.vector_candidates, bind.search_complexity);
+// RRF fusion of both rankings, keeping the top k
+static vector<HybridResult> HybridFuse(const HybridFuseBindData &bind, const vector<pair<row_t, int32_t>> &bm25_ranked,
+                                       const vector<pair<row_t, float>> &vector_ranked) {
+	// Maps row_id -> (bm25_rank, vector_rank)
+	unordered_map<row_t, pair<int32_t, int32_t>> rank_map;
+	rank_map.reserve(bm25_ranked.size() + vector_ranked.size());
+	for (auto &entry : bm25_ranked) {
+		rank_map[entry.first].first = entry.second;
+	}
+	for (idx_t i = 0; i < vector_ranked.size(); i++) {
+		rank_map[vector_ranked[i].first].second = static_cast<int32_t>(i + 1);
+	}
 
-			int32_t rank = 1;
-			for (auto &pair : vector_results) {
-				rank_map[pair.first].second = rank++;
-			}
+	vector<HybridResult> results;
+	results.reserve(rank_map.size());
+	for (auto &entry : rank_map) {
+		auto row_id = entry.first;
+		auto bm25_rank = entry.second.first;
+		auto vector_rank = entry.second.second;
+
+		float score = 0;
+		if (bm25_rank > 0) {
+			score += bind.bm25_weight * (1.0f / (RRF_K + static_cast<float>(bm25_rank)));
+		}
+		if (vector_rank > 0) {
+			score += bind.vector_weight * (1.0f / (RRF_K + static_cast<float>(vector_rank)));
 		}
 
-		// ---- Step 3: RRF fusion ----
-		for (auto &entry : rank_map) {
-			auto row_id = entry.first;
-			auto bm25_rank = entry.second.first;
-			auto vector_rank = entry.second.second;
-
-			float score = 0;
-			if (bm25_rank > 0) {
-				score += bind.bm25_weight * (1.0f / (RRF_K + static_cast<float>(bm25_rank)));
-			}
-			if (vector_rank > 0) {
-				score += bind.vector_weight * (1.0f / (RRF_K + static_cast<float>(vector_rank)));
-			}
+		results.push_back({row_id, score, bm25_rank, vector_rank});
+	}
 
-			state.results.push_back({row_id, score, bm25_rank, vector_rank});
-		}
+	// Only the k best are ordered; ties go to the lower row id so results are stable
+	auto k = MinValue<idx_t>(static_cast<idx_t>(MaxValue<int32_t>(bind.k, 0)), results.size());
+	std::partial_sort(results.begin(), results.begin() + static_cast<int64_t>(k), results.end(),
+	                  [](const HybridResult &a, const HybridResult &b) {
+		                  return a.rrf_score != b.rrf_score ? a.rrf_score > b.rrf_score : a.row_id < b.row_id;
+	                  });
+	results.resize(k);
+	return results;
+}
 
-		// Sort by RRF score descending, take top k
-		std::sort(state.results.begin(), state.results.end(),
-		          [](const HybridSearchState::HybridResult &a, const HybridSearchState::HybridResult &b) {
-			          return a.rrf_score > b.rrf_score;
-		          });
-		if (static_cast<int32_t>(state.results.size()) > bind.k) {
-			state.results.resize(bind.k);
+static OperatorFinalizeResultType HybridFuseFinal(ExecutionContext &context, TableFunctionInput &data,
+                                                  DataChunk &output) {
+	auto &bind = data.bind_data->Cast<HybridFuseBindData>();
+	auto &gstate = data.global_state->Cast<HybridFuseGlobalState>();
+	auto &lstate = data.local_state->Cast<HybridFuseLocalState>();
+	if (!lstate.merged) {
+		lstate.merged = true;
+		HybridFuseInput rows;
+		{
+			lock_guard<mutex> guard(gstate.lock);
+			gstate.rows.Append(lstate.rows);
+			// Threads that start after this point find the input exhausted: they add nothing
+			if (--gstate.active_threads > 0) {
+				output.SetCardinality(0);
+				return OperatorFinalizeResultType::FINISHED;
+			}
+			rows.Append(gstate.rows);
 		}
+		auto vector_ranked = HybridVectorLeg(context.client, bind, rows.allowed);
+		lstate.results = HybridFuse(bind, rows.bm25, vector_ranked);
 	}
 
-	if (state.offset >= state.results.size()) {
+	if (lstate.emit_offset >= lstate.results.size()) {
 		output.SetCardinality(0);
-		return;
+		return OperatorFinalizeResultType::FINISHED;
 	}
 
 	// Fetch rows from the table by row_id
-	auto &catalog = Catalog::GetCatalog(context, "");
+	auto &catalog = Catalog::GetCatalog(context.client, "");
 	auto &duck_table =
-	    catalog.GetEntry<TableCatalogEntry>(context, DEFAULT_SCHEMA, bind.table_name).Cast<DuckTableEntry>();
+	    catalog.GetEntry<TableCatalogEntry>(context.client, DEFAULT_SCHEMA, bind.table_name).Cast<DuckTableEntry>();
 	auto &storage = duck_table.GetStorage();
-	auto &transaction = DuckTransaction::Get(context, storage.db);
 
 	auto num_table_cols = bind.column_types.size();
-	auto batch_size = MinValue<idx_t>(state.results.size() - state.offset, STANDARD_VECTOR_SIZE);
+	auto batch_size = MinValue<idx_t>(lstate.results.size() - lstate.emit_offset, STANDARD_VECTOR_SIZE);
+	auto batch = lstate.results.data() + lstate.emit_offset;
 
-	// Build row_id vector
-	Vector row_ids_vec(LogicalType::ROW_TYPE, batch_size);
-	auto row_ids_data = FlatVector::GetData<row_t>(row_ids_vec);
+	row_t row_ids[STANDARD_VECTOR_SIZE];
 	for (idx_t i = 0; i < batch_size; i++) {
-		row_ids_data[i] = state.results[state.offset + i].row_id;
+		row_ids[i] = batch[i].row_id;
 	}
-
-	// Fetch rows from table
-	DataChunk fetch_chunk;
-	fetch_chunk.Initialize(context, bind.column_types);
-	ColumnFetchState fetch_state;
-	storage.Fetch(transaction, fetch_chunk, bind.storage_ids, row_ids_vec, batch_size, fetch_state);
-
-	// Copy table columns
+	vector<idx_t> table_cols(num_table_cols);
 	for (idx_t col = 0; col < num_table_cols; col++) {
-		for (idx_t i = 0; i < batch_size; i++) {
-			output.data[col].SetValue(i, fetch_chunk.data[col].GetValue(i));
-		}
+		table_cols[col] = col;
 	}
+	SelectionVector kept;
+	auto count =
+	    AnnFetchRows(context.client, storage, bind.storage_ids, table_cols, row_ids, batch_size, output, kept);
 
 	// Score/rank columns
-	for (idx_t i = 0; i < batch_size; i++) {
-		auto &r = state.results[state.offset + i];
-		output.data[num_table_cols].SetValue(i, Value::FLOAT(r.rrf_score));
-		output.data[num_table_cols + 1].SetValue(i, Value::INTEGER(r.bm25_rank));
-		output.data[num_table_cols + 2].SetValue(i, Value::INTEGER(r.vector_rank));
+	auto scores = FlatVector::GetData<float>(output.data[num_table_cols]);
+	auto bm25_ranks = FlatVector::GetData<int32_t>(output.data[num_table_cols + 1]);
+	auto vector_ranks = FlatVector::GetData<int32_t>(output.data[num_table_cols + 2]);
+	auto order = FlatVector::GetData<int64_t>(output.data[num_table_cols + 3]);
+	for (idx_t i = 0; i < count; i++) {
+		auto pos = kept.get_index(i);
+		auto &r = batch[pos];
+		scores[i] = r.rrf_score;
+		bm25_ranks[i] = r.bm25_rank;
+		vector_ranks[i] = r.vector_rank;
+		order[i] = static_cast<int64_t>(lstate.emit_offset + pos);
 	}
 
-	state.offset += batch_size;
-	output.SetCardinality(batch_size);
+	lstate.emit_offset += batch_size;
+	output.SetCardinality(count);
+	return lstate.emit_offset < lstate.results.size() ? OperatorFinalizeResultType::HAVE_MORE_OUTPUT
+	                                                  : OperatorFinalizeResultType::FINISHED;
 }
 
 void RegisterAnnSearchFunction(ExtensionLoader &loader) {
@@ -1169,7 +1536,12 @@ void RegisterAnnSearchFunction(ExtensionLoader &loader) {
 	    {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::LIST(LogicalType::FLOAT), LogicalType::INTEGER},
 	    AnnSearchScan, AnnSearchBind, AnnSearchInit);
 	func.named_parameters["search_complexity"] = LogicalType::INTEGER;
+	func.named_parameters["nprobe"] = LogicalType::INTEGER;
 	func.named_parameters["oversample"] = LogicalType::INTEGER;
+	// Only the projected table columns are fetched
+	func.projection_pushdown = true;
+	// EXPLAIN ANALYZE shows the search work this scan did
+	func.dynamic_to_string = AnnSearchToString;
 	loader.RegisterFunction(func);
 
 	// Batch search: LIST of LIST of FLOAT
@@ -1178,6 +1550,8 @@ void RegisterAnnSearchFunction(ExtensionLoader &loader) {
 	                          LogicalType::LIST(LogicalType::LIST(LogicalType::FLOAT)), LogicalType::INTEGER},
 	                         AnnSearchBatchScan, AnnSearchBatchBind, AnnSearchBatchInit);
 	batch_func.named_parameters["search_complexity"] = LogicalType::INTEGER;
+	batch_func.projection_pushdown = true;
+	batch_func.dynamic_to_string = AnnSearchBatchToString;
 	loader.RegisterFunction(batch_func);
 
 	// Table-input streaming batch search: accepts subqueries, CTEs, generate_series, etc.
@@ -1191,13 +1565,14 @@ void RegisterAnnSearchFunction(ExtensionLoader &loader) {
 	loader.RegisterFunction(table_func);
 
 	// vector_distances: compute distances between query and TABLE of candidate vectors.
-	// Uses Metal GPU when batch is large enough, CPU SIMD otherwise.
+	// Uses Metal GPU when batch is large enough, CPU SIMD otherwise; top_k := n keeps the n nearest.
 	// Usage: SELECT * FROM vector_distances((SELECT id, embedding FROM chunks WHERE ...), [0.1, ...]::FLOAT[768])
 	TableFunction vd_func("vector_distances", {LogicalType::TABLE, LogicalType::LIST(LogicalType::FLOAT)}, nullptr,
 	                      VectorDistancesBind, VectorDistancesGlobalInit, VectorDistancesLocalInit);
 	vd_func.in_out_function = VectorDistancesInOut;
 	vd_func.in_out_function_final = VectorDistancesFinal;
 	vd_func.named_parameters["metric"] = LogicalType::VARCHAR;
+	vd_func.named_parameters["top_k"] = LogicalType::BIGINT;
 	loader.RegisterFunction(vd_func);
 
 	// hybrid_search: BM25 + DiskANN vector search + RRF fusion in one call.
@@ -1207,14 +1582,32 @@ void RegisterAnnSearchFunction(ExtensionLoader &loader) {
 	TableFunction hs_func("hybrid_search",
 	                      {LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR, LogicalType::VARCHAR,
 	                       LogicalType::LIST(LogicalType::FLOAT), LogicalType::VARCHAR},
-	                      HybridSearchScan, HybridSearchBind, HybridSearchInit);
+	                      nullptr);
+	hs_func.bind_replace = HybridSearchBindReplace;
 	hs_func.named_parameters["k"] = LogicalType::INTEGER;
 	hs_func.named_parameters["bm25_weight"] = LogicalType::FLOAT;
 	hs_func.named_parameters["vector_weight"] = LogicalType::FLOAT;
 	hs_func.named_parameters["bm25_candidates"] = LogicalType::INTEGER;
 	hs_func.named_parameters["vector_candidates"] = LogicalType::INTEGER;
 	hs_func.named_parameters["search_complexity"] = LogicalType::INTEGER;
+	// SQL predicate over the table, applied to both legs
+	hs_func.named_parameters["filter"] = LogicalType::VARCHAR;
 	loader.RegisterFunction(hs_func);
+
+	// The fusion step hybrid_search expands to: (row id, BM25 rank) rows in, fused top k out
+	TableFunction fuse_func("hybrid_search_fuse",
+	                        {LogicalType::TABLE, LogicalType::VARCHAR, LogicalType::VARCHAR,
+	                         LogicalType::LIST(LogicalType::FLOAT)},
+	                        nullptr, HybridFuseBind, HybridFuseGlobalInit, HybridFuseLocalInit);
+	fuse_func.in_out_function = HybridFuseInOut;
+	fuse_func.in_out_function_final = HybridFuseFinal;
+	fuse_func.named_parameters["k"] = LogicalType::INTEGER;
+	fuse_func.named_parameters["bm25_weight"] = LogicalType::FLOAT;
+	fuse_func.named_parameters["vector_weight"] = LogicalType::FLOAT;
+	fuse_func.named_parameters["vector_candidates"] = LogicalType::INTEGER;
+	fuse_func.named_parameters["search_complexity"] = LogicalType::INTEGER;
+	fuse_func.named_parameters["filtered"] = LogicalType::BOOLEAN;
+	loader.RegisterFunction(fuse_func);
 }
 
 } // namespace duckdb
@@ -0,0 +1,73 @@
+#include "ann_wal_log.hpp"
+
+namespace duckdb {
+
+// Batches of up to 16MB of vectors: replay inserts one batch per call
+static constexpr idx_t WAL_BATCH_BYTES = 16ULL * 1024 * 1024;
+
+static IndexPointer NewRoot(FixedSizeAllocator &allocator) {
+	auto ptr = allocator.New();
+	allocator.Get<LinkedBlock>(ptr, true)->next_block = IndexPointer();
+	return ptr;
+}
+
+AnnWalLog::AnnWalLog(BlockManager &block_manager)
+    : allocator_(make_uniq<FixedSizeAllocator>(LinkedBlock::BLOCK_SIZE, block_manager)),
+      root_(NewRoot(*allocator_)), writer_(*allocator_, root_) {
+}
+
+void AnnWalLog::WriteRows(const vector<row_t> &row_ids, idx_t dimension,
+                          const std::function<vector<float>(const vector<row_t> &)> &fetch) {
+	auto batch_rows = MaxValue<idx_t>(WAL_BATCH_BYTES / (MaxValue<idx_t>(dimension, 1) * sizeof(float)),
+	                                  STANDARD_VECTOR_SIZE);
+	vector<row_t> batch;
+	for (idx_t start = 0; start < row_ids.size(); start += batch_rows) {
+		auto end = MinValue<idx_t>(start + batch_rows, row_ids.size());
+		batch.assign(row_ids.begin() + static_cast<int64_t>(start), row_ids.begin() + static_cast<int64_t>(end));
+		auto vectors = fetch(batch);
+		D_ASSERT(vectors.size() == batch.size() * dimension);
+		uint64_t count = batch.size();
+		writer_.Write(reinterpret_cast<const uint8_t *>(&count), sizeof(uint64_t));
+		writer_.Write(reinterpret_cast<const uint8_t *>(batch.data()), count * sizeof(row_t));
+		writer_.Write(reinterpret_cast<const uint8_t *>(vectors.data()), vectors.size() * sizeof(float));
+	}
+	uint64_t end_marker = 0;
+	writer_.Write(reinterpret_cast<const uint8_t *>(&end_marker), sizeof(uint64_t));
+	writer_.FreeTail();
+}
+
+IndexStorageInfo AnnWalLog::GetInfo(const string &name, const case_insensitive_map_t<Value> &options) {
+	IndexStorageInfo info;
+	info.name = name;
+	info.root = root_.Get();
+	info.buffers.push_back(allocator_->InitSerializationToWAL());
+	info.allocator_infos.push_back(allocator_->GetInfo());
+	info.options = options;
+	return info;
+}
+
+void AnnWalLog::ReadRows(LinkedBlockReader &reader, idx_t dimension,
+                         const std::function<void(const row_t *, const float *, idx_t)> &apply) {
+	vector<row_t> row_ids;
+	vector<float> vectors;
+	while (true) {
+		uint64_t count = 0;
+		if (reader.Read(reinterpret_cast<uint8_t *>(&count), sizeof(uint64_t)) != sizeof(uint64_t)) {
+			throw IOException("ANN index WAL record is truncated. Drop and recreate the index.");
+		}
+		if (count == 0) {
+			return;
+		}
+		row_ids.resize(count);
+		vectors.resize(count * dimension);
+		auto row_bytes = count * sizeof(row_t);
+		auto vector_bytes = vectors.size() * sizeof(float);
+		if (reader.Read(reinterpret_cast<uint8_t *>(row_ids.data()), row_bytes) != row_bytes ||
+		    reader.Read(reinterpret_cast<uint8_t *>(vectors.data()), vector_bytes) != vector_bytes) {
+			throw IOException("ANN index WAL record is truncated. Drop and recreate the index.");
+		}
+		apply(row_ids.data(), vectors.data(), count);
+	}
+}
+
+} // namespace duckdb
@@ -124,6 +124,97 @@ void RegisterDiskannIndexScanFunction(ExtensionLoader &loader) {
 	loader.RegisterFunction(func);
 }
 
+// ========================================
+// diskann_consolidate(table, index, max_nodes := 0)
+// Runs one bounded slice of in-place delete consolidation. Call repeatedly (e.g.
+// from a scheduled job) until done; max_nodes = 0 finishes the pass.
+// Returns: (visited BIGINT, freed BIGINT, remaining BIGINT, done BOOLEAN)
+// ========================================
+
+struct DiskannConsolidateBindData : public TableFunctionData {
+	string table_name;
+	string index_name;
+	idx_t max_nodes = 0;
+};
+
+struct DiskannConsolidateState : public GlobalTableFunctionState {
+	bool done = false;
+	idx_t MaxThreads() const override {
+		return 1;
+	}
+};
+
+static unique_ptr<FunctionData> DiskannConsolidateBind(ClientContext &context, TableFunctionBindInput &input,
+                                                       vector<LogicalType> &return_types, vector<string> &names) {
+	auto bind_data = make_uniq<DiskannConsolidateBindData>();
+	bind_data->table_name = input.inputs[0].GetValue<string>();
+	bind_data->index_name = input.inputs[1].GetValue<string>();
+
+	for (auto &kv : input.named_parameters) {
+		if (kv.first == "max_nodes") {
+			auto max_nodes = kv.second.GetValue<int64_t>();
+			if (max_nodes < 0) {
+				throw InvalidInputException("diskann_consolidate: max_nodes must be >= 0");
+			}
+			bind_data->max_nodes = static_cast<idx_t>(max_nodes);
+		}
+	}
+
+	return_types.push_back(LogicalType::BIGINT);
+	return_types.push_back(LogicalType::BIGINT);
+	return_types.push_back(LogicalType::BIGINT);
+	return_types.push_back(LogicalType::BOOLEAN);
+	names.push_back("visited");
+	names.push_back("freed");
+	names.push_back("remaining");
+	names.push_back("done");
+	return std::move(bind_data);
+}
+
+static unique_ptr<GlobalTableFunctionState> DiskannConsolidateInit(ClientContext &context,
+                                                                   TableFunctionInitInput &input) {
+	return make_uniq<DiskannConsolidateState>();
+}
+
+static void DiskannConsolidateScan(ClientContext &context, TableFunctionInput &data, DataChunk &output) {
+	auto &bind = data.bind_data->Cast<DiskannConsolidateBindData>();
+	auto &state = data.global_state->Cast<DiskannConsolidateState>();
+
+	if (state.done) {
+		output.SetCardinality(0);
+		return;
+	}
+	state.done = true;
+
+	auto &catalog = Catalog::GetCatalog(context, "");
+	auto &table_entry = catalog.GetEntry<TableCatalogEntry>(context, DEFAULT_SCHEMA, bind.table_name);
+	auto &duck_table = table_entry.Cast<DuckTableEntry>();
+	auto &storage = duck_table.GetStorage();
+	auto &table_info = *storage.GetDataTableInfo();
+	auto &indexes = table_info.GetIndexes();
+	indexes.Bind(context, table_info, DiskannIndex::TYPE_NAME);
+
+	auto index_ptr = indexes.Find(bind.index_name);
+	if (!index_ptr) {
+		throw InvalidInputException("Index '%s' not found on table '%s'", bind.index_name, bind.table_name);
+	}
+
+	auto progress = index_ptr->Cast<DiskannIndex>().Consolidate(bind.max_nodes);
+
+	output.data[0].SetValue(0, Value::BIGINT(static_cast<int64_t>(progress.visited)));
+	output.data[1].SetValue(0, Value::BIGINT(static_cast<int64_t>(progress.freed)));
+	output.data[2].SetValue(0, Value::BIGINT(static_cast<int64_t>(progress.remaining)));
+	output.data[3].SetValue(0, Value::BOOLEAN(progress.done));
+	output.SetCardinality(1);
+}
+
+void RegisterDiskannConsolidateFunction(ExtensionLoader &loader) {
+	TableFunction func("diskann_consolidate", {LogicalType::VARCHAR, LogicalType::VARCHAR}, DiskannConsolidateScan,
+	                   DiskannConsolidateBind, DiskannConsolidateInit);
+	func.named_parameters["max_nodes"] = LogicalType::BIGINT;
+	loader.RegisterFunction(func);
+}
+
 // ========================================
 // diskann_streaming_build(input_path, output_path)
 // Two-pass streaming index build from binary vectors file.
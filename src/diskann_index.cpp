@@ -1,19 +1,37 @@
 #include "diskann_index.hpp"
+#include "ann_memory.hpp"
+#include "ann_wal_log.hpp"
 #include "linked_block_storage.hpp"
 
 #include "duckdb/catalog/catalog_entry/duck_index_entry.hpp"
 #include "duckdb/catalog/catalog_entry/duck_table_entry.hpp"
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
 #include "duckdb/common/exception/transaction_exception.hpp"
+#include "duckdb/common/file_system.hpp"
+#include "duckdb/common/random_engine.hpp"
+#include "duckdb/common/set.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
 #include "duckdb/common/types/vector.hpp"
 #include "duckdb/execution/operator/projection/physical_projection.hpp"
+#include "duckdb/main/attached_database.hpp"
+#include "duckdb/parallel/task_executor.hpp"
+#include "duckdb/parallel/task_scheduler.hpp"
 #include "duckdb/planner/expression/bound_reference_expression.hpp"
 #include "duckdb/planner/operator/logical_create_index.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
 #include "duckdb/storage/partial_block_manager.hpp"
+#include "duckdb/storage/storage_manager.hpp"
 #include "duckdb/storage/table_io_manager.hpp"
 
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
 namespace duckdb {
 
+// label_to_rowid_ entries per map segment
+static constexpr idx_t MAP_PAGE_ENTRIES = 65536;
+
 // ========================================
 // DiskannIndex: Constructor / Destructor
 // ========================================
@@ -35,6 +53,22 @@ DiskannIndex::DiskannIndex(const string &name, IndexConstraintType constraint_ty
 	build_complexity_ = params.build_complexity;
 	alpha_ = params.alpha;
 	quantize_sq8_ = params.quantize_sq8;
+	quantize_pq_ = params.quantize_pq;
+	pq_subspaces_ = params.pq_subspaces;
+	pq_bits_ = params.pq_bits;
+	rerank_ = params.rerank;
+	half_format_ = params.half_format;
+	disk_storage_ = params.disk_storage;
+	if (disk_storage_ && db.GetStorageManager().InMemory()) {
+		throw InvalidInputException("DISKANN storage = 'disk' needs a persistent database: the graph file is "
+		                            "kept next to the database file");
+	}
+	partition_by_ = params.partition_by;
+	if (IsPartitioned() && unbound_expressions.size() == 2) {
+		partition_type_ = unbound_expressions[1]->return_type;
+		child_options_ = options;
+		child_options_.erase("partition_by");
+	}
 
 	// Detect dimension from the expression type
 	if (!unbound_expressions.empty()) {
@@ -43,22 +77,44 @@ DiskannIndex::DiskannIndex(const string &name, IndexConstraintType constraint_ty
 			dimension_ = static_cast<int32_t>(ArrayType::GetSize(type));
 		}
 	}
+	if (quantize_pq_) {
+		if (pq_bits_ < 1 || pq_bits_ > 8) {
+			throw InvalidInputException("DISKANN pq_bits must be between 1 and 8, got %d", pq_bits_);
+		}
+		if (pq_subspaces_ < 0 || (pq_subspaces_ > 0 && dimension_ % pq_subspaces_ != 0)) {
+			throw InvalidInputException("DISKANN pq_subspaces (%d) must divide the vector dimension (%d)",
+			                            pq_subspaces_, dimension_);
+		}
+	}
+	if (rerank_ < 0) {
+		throw InvalidInputException("DISKANN rerank must be >= 0");
+	}
 
 	// Initialize block allocator for persistence
 	auto &block_manager = table_io_manager.GetIndexBlockManager();
 	block_allocator_ = make_uniq<FixedSizeAllocator>(LinkedBlock::BLOCK_SIZE, block_manager);
+	reservation_ = make_uniq<AnnMemoryReservation>(db.GetDatabase(), [this]() { return ReleaseMemory(); });
 
 	// If loading from storage, deserialize
 	if (info.IsValid()) {
 		LoadFromStorage(info);
+		ApplyQuantization();
+		calibration_.Deserialize(info.options);
+		UpdateReservation();
 	}
 }
 
 DiskannIndex::~DiskannIndex() {
+	// No other index may ask this one to release memory from here on
+	reservation_->Close();
 	if (rust_handle_) {
 		DiskannFreeDetached(rust_handle_);
 		rust_handle_ = nullptr;
 	}
+	if (disk_handle_) {
+		DiskannDiskFree(disk_handle_);
+		disk_handle_ = nullptr;
+	}
 }
 
 // ========================================
@@ -74,8 +130,11 @@ PhysicalOperator &DiskannIndex::CreatePlan(PlanIndexInput &input) {
 	auto &op = input.op;
 	auto &planner = input.planner;
 
-	// Validate: single FLOAT[N] column
-	if (op.unbound_expressions.size() != 1) {
+	// Validate: single FLOAT[N] column, then the partition column with partition_by
+	auto partition_by = DiskannParams::Parse(op.info->options).partition_by;
+	if (!partition_by.empty()) {
+		AnnCheckPartitionColumns(TYPE_NAME, partition_by, op.unbound_expressions);
+	} else if (op.unbound_expressions.size() != 1) {
 		throw InvalidInputException("DISKANN index requires exactly one column");
 	}
 	auto &type = op.unbound_expressions[0]->return_type;
@@ -123,16 +182,35 @@ PhysicalCreateDiskannIndex::PhysicalCreateDiskannIndex(PhysicalPlan &physical_pl
 	}
 }
 
-// Sink state
+// Sink state: each thread buffers its own vectors; Combine hands the buffers to the
+// global state, and Finalize inserts them into the graph with a parallel multi-insert.
+// A streaming build buffers (vector, row id) rows in buffer-managed collections instead,
+// which DuckDB spills to its temp directory under memory pressure. With partition_by the
+// rows are grouped by partition value as they arrive.
+class CreateDiskannLocalSinkState : public LocalSinkState {
+public:
+	vector<float> vectors;
+	vector<row_t> rowids;
+	unique_ptr<ColumnDataCollection> rows;
+	AnnPartitionMap<AnnPartitionRows> partitions;
+};
+
 class CreateDiskannGlobalSinkState : public GlobalSinkState {
 public:
-	vector<float> all_vectors;
-	vector<row_t> all_rowids;
+	mutex lock;
+	vector<vector<float>> vector_partitions;
+	vector<vector<row_t>> rowid_partitions;
+	unique_ptr<ColumnDataCollection> rows;
+	AnnPartitionMap<AnnPartitionRows> partitions;
+	idx_t total_rows = 0;
 	int32_t dimension = 0;
 	DiskannParams params;
 };
 
-class CreateDiskannLocalSinkState : public LocalSinkState {};
+static unique_ptr<ColumnDataCollection> MakeStreamingRows(ClientContext &context, const LogicalType &vector_type) {
+	vector<LogicalType> types {vector_type, LogicalType::ROW_TYPE};
+	return make_uniq<ColumnDataCollection>(BufferManager::GetBufferManager(context), types);
+}
 
 unique_ptr<GlobalSinkState> PhysicalCreateDiskannIndex::GetGlobalSinkState(ClientContext &context) const {
 	auto state = make_uniq<CreateDiskannGlobalSinkState>();
@@ -142,36 +220,85 @@ unique_ptr<GlobalSinkState> PhysicalCreateDiskannIndex::GetGlobalSinkState(Clien
 	state->dimension = static_cast<int32_t>(ArrayType::GetSize(type));
 
 	state->params = DiskannParams::Parse(info->options);
-
-	// Pre-reserve based on estimated cardinality to avoid realloc+copy cycles
-	if (estimated_cardinality > 0) {
-		state->all_vectors.reserve(estimated_cardinality * state->dimension);
-		state->all_rowids.reserve(estimated_cardinality);
+	if (state->params.streaming_build) {
+		state->rows = MakeStreamingRows(context, type);
 	}
 
 	return std::move(state);
 }
 
 unique_ptr<LocalSinkState> PhysicalCreateDiskannIndex::GetLocalSinkState(ExecutionContext &context) const {
-	return make_uniq<CreateDiskannLocalSinkState>();
+	auto state = make_uniq<CreateDiskannLocalSinkState>();
+	auto params = DiskannParams::Parse(info->options);
+	if (params.streaming_build) {
+		state->rows = MakeStreamingRows(context.client, unbound_expressions[0]->return_type);
+	} else if (params.partition_by.empty() && estimated_cardinality > 0) {
+		// Pre-reserve this thread's share of the estimated cardinality to avoid realloc+copy cycles
+		auto &scheduler = TaskScheduler::GetScheduler(context.client);
+		auto threads = MaxValue<idx_t>(NumericCast<idx_t>(scheduler.NumberOfThreads()), 1);
+		auto share = estimated_cardinality / threads + 1;
+		state->vectors.reserve(share * ArrayType::GetSize(unbound_expressions[0]->return_type));
+		state->rowids.reserve(share);
+	}
+	return std::move(state);
+}
+
+// NULL vectors are not indexed. Returns how many rows of the vector column are valid;
+// when some are not, sel lists the valid ones.
+static idx_t SelectValidVectors(Vector &vectors, idx_t count, SelectionVector &sel) {
+	UnifiedVectorFormat format;
+	vectors.ToUnifiedFormat(count, format);
+	if (format.validity.AllValid()) {
+		return count;
+	}
+	sel.Initialize(count);
+	idx_t valid = 0;
+	for (idx_t i = 0; i < count; i++) {
+		if (format.validity.RowIsValid(format.sel->get_index(i))) {
+			sel.set_index(valid++, i);
+		}
+	}
+	return valid;
 }
 
 SinkResultType PhysicalCreateDiskannIndex::Sink(ExecutionContext &context, DataChunk &chunk,
                                                 OperatorSinkInput &input) const {
-	auto &state = input.global_state.Cast<CreateDiskannGlobalSinkState>();
+	auto &lstate = input.local_state.Cast<CreateDiskannLocalSinkState>();
 
 	// chunk layout: [indexed_columns...][row_id]
 	auto col_count = chunk.ColumnCount();
 	D_ASSERT(col_count >= 2); // at least one data column + row_id
 
-	auto &vec_col = chunk.data[0];
-	auto &rowid_col = chunk.data[col_count - 1]; // row_id is always last
-
 	auto count = chunk.size();
+	SelectionVector valid_sel;
+	auto valid = SelectValidVectors(chunk.data[0], count, valid_sel);
+	if (valid < count) {
+		chunk.Slice(valid_sel, valid);
+		count = valid;
+	}
 	if (count == 0) {
 		return SinkResultType::NEED_MORE_INPUT;
 	}
 
+	auto &vec_col = chunk.data[0];
+	auto &rowid_col = chunk.data[col_count - 1]; // row_id is always last
+	vec_col.Flatten(count);
+
+	if (lstate.rows) {
+		DataChunk rows;
+		rows.InitializeEmpty(lstate.rows->Types());
+		rows.data[0].Reference(vec_col);
+		rows.data[1].Reference(rowid_col);
+		rows.SetCardinality(count);
+		lstate.rows->Append(rows);
+		return SinkResultType::NEED_MORE_INPUT;
+	}
+	if (col_count == 3) {
+		// partition_by: [vector][partition column][row_id]
+		AnnGroupByPartition(chunk.data[1], rowid_col, count, lstate.partitions, &vec_col);
+		return SinkResultType::NEED_MORE_INPUT;
+	}
+
 	// Get array data
 	auto &array_child = ArrayVector::GetEntry(vec_col);
 	auto array_size = ArrayType::GetSize(vec_col.GetType());
@@ -182,13 +309,11 @@ SinkResultType PhysicalCreateDiskannIndex::Sink(ExecutionContext &context, DataC
 	rowid_col.ToUnifiedFormat(count, rowid_format);
 	auto rowid_data = reinterpret_cast<row_t *>(rowid_format.data);
 
+	// Array children are contiguous: append the whole chunk at once
+	lstate.vectors.insert(lstate.vectors.end(), child_data, child_data + count * array_size);
 	for (idx_t i = 0; i < count; i++) {
 		auto row_idx = rowid_format.sel->get_index(i);
-		auto row_id = rowid_data[row_idx];
-		const float *vec_ptr = child_data + i * array_size;
-
-		state.all_vectors.insert(state.all_vectors.end(), vec_ptr, vec_ptr + array_size);
-		state.all_rowids.push_back(row_id);
+		lstate.rowids.push_back(rowid_data[row_idx]);
 	}
 
 	return SinkResultType::NEED_MORE_INPUT;
@@ -196,6 +321,28 @@ SinkResultType PhysicalCreateDiskannIndex::Sink(ExecutionContext &context, DataC
 
 SinkCombineResultType PhysicalCreateDiskannIndex::Combine(ExecutionContext &context,
                                                           OperatorSinkCombineInput &input) const {
+	auto &gstate = input.global_state.Cast<CreateDiskannGlobalSinkState>();
+	auto &lstate = input.local_state.Cast<CreateDiskannLocalSinkState>();
+	if (lstate.rows) {
+		lock_guard<mutex> guard(gstate.lock);
+		gstate.total_rows += lstate.rows->Count();
+		gstate.rows->Combine(*lstate.rows);
+		return SinkCombineResultType::FINISHED;
+	}
+	if (!lstate.partitions.Empty()) {
+		lock_guard<mutex> guard(gstate.lock);
+		AnnMergePartitionRows(gstate.partitions, lstate.partitions);
+		return SinkCombineResultType::FINISHED;
+	}
+	if (lstate.rowids.empty()) {
+		return SinkCombineResultType::FINISHED;
+	}
+
+	// Move (not copy) the thread-local buffers into the global state
+	lock_guard<mutex> guard(gstate.lock);
+	gstate.total_rows += lstate.rowids.size();
+	gstate.vector_partitions.push_back(std::move(lstate.vectors));
+	gstate.rowid_partitions.push_back(std::move(lstate.rowids));
 	return SinkCombineResultType::FINISHED;
 }
 
@@ -214,43 +361,61 @@ SinkFinalizeType PhysicalCreateDiskannIndex::Finalize(Pipeline &pipeline, Event
 	auto index = make_uniq<DiskannIndex>(info->index_name, info->constraint_type, storage_ids,
 	                                     TableIOManager::Get(storage), unbound_expressions, storage.db, options);
 
-	// Create Rust index and add all vectors
-	auto rust_handle = DiskannCreateDetached(state.dimension, state.params.metric, state.params.max_degree,
-	                                         state.params.build_complexity, state.params.alpha);
-
-	idx_t n_vectors = state.all_rowids.size();
-	vector<row_t> label_to_rowid(n_vectors);
-	unordered_map<row_t, uint32_t> rowid_to_label;
-	rowid_to_label.reserve(n_vectors);
-
-	for (idx_t i = 0; i < n_vectors; i++) {
-		const float *vec_ptr = state.all_vectors.data() + i * state.dimension;
-		auto label = DiskannDetachedAdd(rust_handle, vec_ptr, state.dimension);
-		auto label_u32 = static_cast<uint32_t>(label);
-		label_to_rowid[i] = state.all_rowids[i];
-		rowid_to_label[state.all_rowids[i]] = label_u32;
-	}
-
-	// Transfer built state
-	index->rust_handle_ = rust_handle;
 	index->dimension_ = state.dimension;
 	index->metric_ = state.params.metric;
 	index->max_degree_ = state.params.max_degree;
 	index->build_complexity_ = state.params.build_complexity;
 	index->alpha_ = state.params.alpha;
-	index->label_to_rowid_ = std::move(label_to_rowid);
-	index->rowid_to_label_ = std::move(rowid_to_label);
-	index->is_dirty_ = true;
 
-	// Apply SQ8 quantization if requested
-	if (state.params.quantize_sq8 && rust_handle) {
-		DiskannDetachedQuantizeSQ8(index->rust_handle_);
-		index->quantize_sq8_ = true;
+	if (index->IsPartitioned()) {
+		// One child per partition, each built like an unpartitioned index with one batched insert
+		for (idx_t p = 0; p < state.partitions.Size(); p++) {
+			auto &rows = state.partitions.Get(p);
+			auto &child = index->GetOrCreatePartition(state.partitions.Key(p));
+			child.AppendRows(rows.vectors.data(), rows.row_ids.data(), rows.row_ids.size());
+			rows = AnnPartitionRows();
+		}
+	} else if (state.params.streaming_build) {
+		auto memory_limit = state.params.memory_limit;
+		if (memory_limit == 0) {
+			memory_limit = BufferManager::GetBufferManager(context).GetMaxMemory() / 2;
+		}
+		index->StreamingBuild(*state.rows, state.params, memory_limit);
+		state.rows.reset();
+	} else {
+		// Create Rust index and add all vectors
+		index->rust_handle_ = DiskannCreateDetached(state.dimension, state.params.metric, state.params.max_degree,
+		                                            state.params.build_complexity, state.params.alpha);
+		index->label_to_rowid_.assign(state.total_rows, -1);
+		index->rowid_to_label_.reserve(state.total_rows);
+
+		// Each partition is inserted with one batched call; the Rust side cuts graph
+		// construction into tasks that run on DuckDB's scheduler.
+		vector<int64_t> labels;
+		for (idx_t p = 0; p < state.rowid_partitions.size(); p++) {
+			auto &part_vectors = state.vector_partitions[p];
+			auto &part_rowids = state.rowid_partitions[p];
+			labels.resize(part_rowids.size());
+			index->AddBatch(part_vectors.data(), part_rowids.size(), labels.data());
+			index->MapLabels(labels.data(), part_rowids.data(), part_rowids.size());
+			// Release partition memory as soon as it is in the graph
+			vector<float>().swap(part_vectors);
+			vector<row_t>().swap(part_rowids);
+		}
+
+		// Apply SQ8 quantization if requested
+		if (state.params.quantize_sq8) {
+			DiskannDetachedQuantizeSQ8(index->rust_handle_);
+			index->quantize_sq8_ = true;
+		}
 	}
+	index->is_dirty_ = true;
+	index->ApplyQuantization();
 
 	// Call through BoundIndex reference to avoid name hiding from our overrides
 	BoundIndex &bi = *index;
 	bi.Vacuum();
+	index->UpdateReservation();
 #ifdef DUCKDB_API_V15
 	bi.Verify();
 #else
@@ -309,6 +474,155 @@ SourceResultType PhysicalCreateDiskannIndex::GetData(ExecutionContext &context,
 	return SourceResultType::FINISHED;
 }
 
+// ========================================
+// DiskannIndex: Rust tasks on DuckDB's scheduler
+// ========================================
+
+// Runs loop indices until none are left; one per scheduler thread
+class DiskannLoopTask : public BaseExecutorTask {
+public:
+	DiskannLoopTask(TaskExecutor &executor, std::atomic<uint64_t> &next, uint64_t n, DiskannTaskBody body,
+	                void *body_ctx)
+	    : BaseExecutorTask(executor), next(next), n(n), body(body), body_ctx(body_ctx) {
+	}
+
+	void ExecuteTask() override {
+		for (auto i = next++; i < n; i = next++) {
+			body(body_ctx, i);
+		}
+	}
+
+private:
+	std::atomic<uint64_t> &next;
+	uint64_t n;
+	DiskannTaskBody body;
+	void *body_ctx;
+};
+
+void DiskannIndex::RunTasks(void *ctx, uint64_t n, DiskannTaskBody body, void *body_ctx) {
+	auto &scheduler = *static_cast<TaskScheduler *>(ctx);
+	std::atomic<uint64_t> next {0};
+	auto workers = MinValue<uint64_t>(n, static_cast<uint64_t>(MaxValue<int32_t>(scheduler.NumberOfThreads(), 1)));
+	try {
+		// The calling thread works on the tasks too, so this cannot deadlock a busy scheduler
+		TaskExecutor executor(scheduler);
+		for (uint64_t w = 0; w < workers; w++) {
+			executor.ScheduleTask(make_uniq<DiskannLoopTask>(executor, next, n, body, body_ctx));
+		}
+		executor.WorkOnTasks();
+	} catch (...) {
+		// Nothing may unwind into Rust: whatever could not be scheduled runs here
+		for (auto i = next++; i < n; i = next++) {
+			body(body_ctx, i);
+		}
+	}
+}
+
+void DiskannIndex::AddBatch(const float *matrix, idx_t n, int64_t *out_labels) {
+	DiskannDetachedAddBatch(rust_handle_, matrix, static_cast<int64_t>(n), dimension_, out_labels, RunTasks,
+	                        &TaskScheduler::GetScheduler(db.GetDatabase()));
+}
+
+// ========================================
+// DiskannIndex: streaming build
+// ========================================
+
+// Vectors per AddBatch call of a streaming build's second pass
+static constexpr idx_t STREAMING_BATCH_BYTES = 16ULL * 1024 * 1024;
+
+void DiskannIndex::MapLabels(const int64_t *labels, const row_t *row_ids, idx_t count) {
+	for (idx_t i = 0; i < count; i++) {
+		auto label_u32 = static_cast<uint32_t>(base_count_ + labels[i]);
+		if (label_u32 >= label_to_rowid_.size()) {
+			label_to_rowid_.resize(label_u32 + 1, -1);
+		}
+		label_to_rowid_[label_u32] = row_ids[i];
+		rowid_to_label_[row_ids[i]] = label_u32;
+	}
+}
+
+void DiskannIndex::StreamingBuild(ColumnDataCollection &rows, const DiskannParams &params, idx_t memory_limit) {
+	rust_handle_ = DiskannCreateDetached(dimension_, metric_, max_degree_, build_complexity_, alpha_);
+	auto n = rows.Count();
+	if (n == 0) {
+		return;
+	}
+	label_to_rowid_.assign(n, -1);
+	rowid_to_label_.reserve(n);
+
+	// Every stride-th row is in the sample: spread over the whole table, not its first rows
+	auto sqrt_n = static_cast<idx_t>(std::sqrt(static_cast<double>(n)));
+	auto sample_n = MinValue<idx_t>(params.sample_size > 0 ? static_cast<idx_t>(params.sample_size)
+	                                                       : MaxValue<idx_t>(sqrt_n, 1000),
+	                                n);
+	auto stride = n / sample_n;
+	auto dim = static_cast<idx_t>(dimension_);
+
+	vector<float> batch_vectors;
+	vector<row_t> batch_rowids;
+	vector<int64_t> labels;
+	auto add_batch = [&]() {
+		if (batch_rowids.empty()) {
+			return;
+		}
+		labels.resize(batch_rowids.size());
+		AddBatch(batch_vectors.data(), batch_rowids.size(), labels.data());
+		MapLabels(labels.data(), batch_rowids.data(), batch_rowids.size());
+		batch_vectors.clear();
+		batch_rowids.clear();
+		is_dirty_ = true;
+	};
+
+	// Scans the spilled rows, buffering those of one pass; on_batch runs every batch_rows rows
+	auto scan_pass = [&](bool sample_pass, idx_t batch_rows, const std::function<void()> &on_batch) {
+		ColumnDataScanState scan_state;
+		rows.InitializeScan(scan_state);
+		DataChunk chunk;
+		rows.InitializeScanChunk(chunk);
+		idx_t row = 0;
+		while (rows.Scan(scan_state, chunk)) {
+			auto &vec_col = chunk.data[0];
+			vec_col.Flatten(chunk.size());
+			auto child_data = FlatVector::GetData<float>(ArrayVector::GetEntry(vec_col));
+			auto rowid_data = FlatVector::GetData<row_t>(chunk.data[1]);
+			for (idx_t i = 0; i < chunk.size(); i++, row++) {
+				bool sampled = row % stride == 0 && row / stride < sample_n;
+				if (sampled != sample_pass) {
+					continue;
+				}
+				batch_vectors.insert(batch_vectors.end(), child_data + i * dim, child_data + (i + 1) * dim);
+				batch_rowids.push_back(rowid_data[i]);
+				if (batch_rowids.size() >= batch_rows) {
+					on_batch();
+				}
+			}
+		}
+		on_batch();
+	};
+
+	// Pass 1: the pilot graph. It is small enough to build in memory, and trains the codes
+	// the rest of the build traverses on.
+	scan_pass(true, sample_n, add_batch);
+	ApplyQuantization();
+
+	// Pass 2: every other row. Whenever the resident index passes memory_limit, its vector
+	// pages are written to the index's block storage (buffer-managed, so they spill to the
+	// temp directory) and dropped from memory. Each eviction must free a quarter of the
+	// budget, so a graph whose codes and adjacency alone fill it is not rewritten every batch.
+	auto batch_rows = MaxValue<idx_t>(STREAMING_BATCH_BYTES / (dim * sizeof(float)), STANDARD_VECTOR_SIZE);
+	uint64_t evicted_floor = 0;
+	scan_pass(false, batch_rows, [&]() {
+		add_batch();
+		ApplyQuantization();
+		auto resident = DiskannDetachedMemoryBytes(rust_handle_);
+		if (resident > memory_limit && resident > evicted_floor + memory_limit / 4 && SearchesCodes()) {
+			PersistToDisk();
+			evicted_floor = DiskannDetachedMemoryBytes(rust_handle_);
+		}
+		UpdateReservation();
+	});
+}
+
 // ========================================
 // DiskannIndex: Append / Insert / Delete
 // ========================================
@@ -324,36 +638,140 @@ ErrorData DiskannIndex::Append(IndexLock &lock, DataChunk &entries, Vector &row_
 	expr_chunk.Initialize(Allocator::DefaultAllocator(), logical_types);
 	ExecuteExpressions(entries, expr_chunk);
 
-	if (!rust_handle_) {
-		rust_handle_ = DiskannCreateDetached(dimension_, metric_, max_degree_, build_complexity_, alpha_);
+	SelectionVector valid_sel;
+	auto valid = SelectValidVectors(expr_chunk.data[0], count, valid_sel);
+	if (valid == 0) {
+		return ErrorData {};
+	}
+	Vector valid_rowids(row_identifiers.GetType());
+	if (valid < count) {
+		expr_chunk.Slice(valid_sel, valid);
+		valid_rowids.Slice(row_identifiers, valid_sel, valid);
+		count = valid;
+	} else {
+		valid_rowids.Reference(row_identifiers);
+	}
+
+	if (IsPartitioned()) {
+		AnnPartitionMap<AnnPartitionRows> rows;
+		AnnGroupByPartition(expr_chunk.data[1], valid_rowids, count, rows, &expr_chunk.data[0]);
+		for (idx_t p = 0; p < rows.Size(); p++) {
+			auto &part = rows.Get(p);
+			auto &child = GetOrCreatePartition(rows.Key(p));
+			lock_guard<mutex> guard(child.lock);
+			child.AppendRows(part.vectors.data(), part.row_ids.data(), part.row_ids.size());
+		}
+		result_cache_.Invalidate();
+		return ErrorData {};
 	}
 
 	auto &vec_col = expr_chunk.data[0];
+	vec_col.Flatten(count);
 	auto &array_child = ArrayVector::GetEntry(vec_col);
-	auto array_size = ArrayType::GetSize(vec_col.GetType());
+	D_ASSERT(ArrayType::GetSize(vec_col.GetType()) == static_cast<idx_t>(dimension_));
 	auto child_data = FlatVector::GetData<float>(array_child);
 
 	UnifiedVectorFormat rowid_format;
-	row_identifiers.ToUnifiedFormat(count, rowid_format);
+	valid_rowids.ToUnifiedFormat(count, rowid_format);
 	auto rowid_data = reinterpret_cast<row_t *>(rowid_format.data);
-
+	vector<row_t> row_ids(count);
 	for (idx_t i = 0; i < count; i++) {
-		auto row_idx = rowid_format.sel->get_index(i);
-		auto row_id = rowid_data[row_idx];
-		const float *vec_ptr = child_data + i * array_size;
-
-		auto label = DiskannDetachedAdd(rust_handle_, vec_ptr, dimension_);
-		auto label_u32 = static_cast<uint32_t>(label);
+		row_ids[i] = rowid_data[rowid_format.sel->get_index(i)];
+	}
+	AppendRows(child_data, row_ids.data(), count);
+	return ErrorData {};
+}
 
+void DiskannIndex::AppendRows(const float *vectors, const row_t *row_ids, idx_t count) {
+	if (count == 0) {
+		return;
+	}
+	if (!rust_handle_) {
+		rust_handle_ = DiskannCreateDetached(dimension_, metric_, max_degree_, build_complexity_, alpha_);
+	}
+	// Reserve before inserting, so an out-of-memory error leaves the index as it was: at most a
+	// full-precision vector, a full adjacency list and both label map entries per row
+	auto row_bytes =
+	    dimension_ * sizeof(float) + max_degree_ * sizeof(uint32_t) + 2 * sizeof(row_t) + sizeof(uint32_t);
+	UpdateReservation(count * row_bytes);
+
+	// Array children are contiguous: insert the whole chunk with one batched call,
+	// the Rust side runs the graph insertions concurrently on its workers
+	vector<int64_t> labels(count);
+	AddBatch(vectors, count, labels.data());
+	result_cache_.Invalidate();
+
+	rowid_to_label_.reserve(rowid_to_label_.size() + count);
+	for (idx_t i = 0; i < count; i++) {
+		auto row_id = row_ids[i];
+		auto label_u32 = static_cast<uint32_t>(base_count_ + labels[i]);
 		if (label_u32 >= label_to_rowid_.size()) {
 			label_to_rowid_.resize(label_u32 + 1, -1);
+		} else if (label_u32 < persisted_mappings_) {
+			// Recycled label: its map page is already on disk
+			dirty_map_pages_.insert(label_u32 / MAP_PAGE_ENTRIES);
 		}
 		label_to_rowid_[label_u32] = row_id;
 		rowid_to_label_[row_id] = label_u32;
 	}
 
+	// Index created on an empty or small table: codes are trained once enough vectors have arrived
+	ApplyQuantization();
 	is_dirty_ = true;
-	return ErrorData {};
+	UpdateReservation();
+}
+
+// Incrementally built SQ8 index: wait for enough vectors that the per-dimension range is representative
+static constexpr int64_t SQ8_MIN_TRAIN_VECTORS = 256;
+
+void DiskannIndex::ApplyQuantization() {
+	if ((!quantize_sq8_ && !quantize_pq_ && !half_format_) || !rust_handle_) {
+		return;
+	}
+	DiskannDetachedSetRerank(rust_handle_, static_cast<uint32_t>(rerank_));
+	auto count = DiskannDetachedCount(rust_handle_);
+	if (quantize_pq_ && !DiskannDetachedIsPQ(rust_handle_) && count >= (int64_t(1) << pq_bits_)) {
+		DiskannDetachedQuantizePQ(rust_handle_, pq_subspaces_, pq_bits_, RunTasks,
+		                          &TaskScheduler::GetScheduler(db.GetDatabase()));
+		is_dirty_ = true;
+	} else if (quantize_sq8_ && !DiskannDetachedIsQuantized(rust_handle_) && count >= SQ8_MIN_TRAIN_VECTORS) {
+		DiskannDetachedQuantizeSQ8(rust_handle_);
+		is_dirty_ = true;
+	} else if (half_format_ && DiskannDetachedHalfFormat(rust_handle_) == 0) {
+		// Nothing to train: every vector is rounded as it is written, from the first one on
+		DiskannDetachedQuantizeHalf(rust_handle_, half_format_);
+		is_dirty_ = true;
+	}
+}
+
+DiskannIndex &DiskannIndex::GetOrCreatePartition(const Value &key, const IndexStorageInfo &info) {
+	auto existing = FindPartition(key);
+	if (existing) {
+		return *existing;
+	}
+	// Same columns and storage as the parent: only the options lose partition_by
+	auto child = make_uniq<DiskannIndex>(name, index_constraint_type, GetColumnIds(), table_io_manager,
+	                                     unbound_expressions, db, child_options_, info);
+	std::unique_lock<std::shared_mutex> guard(partitions_lock_);
+	auto &entry = partitions_.GetOrCreate(key);
+	entry = std::move(child);
+	return *entry;
+}
+
+vector<DiskannIndex *> DiskannIndex::Partitions() const {
+	std::shared_lock<std::shared_mutex> guard(partitions_lock_);
+	vector<DiskannIndex *> children;
+	children.reserve(partitions_.Size());
+	for (idx_t p = 0; p < partitions_.Size(); p++) {
+		children.push_back(partitions_.Get(p).get());
+	}
+	return children;
+}
+
+DiskannIndex *DiskannIndex::FindPartition(const Value &key) const {
+	std::shared_lock<std::shared_mutex> guard(partitions_lock_);
+	auto child = partitions_.Find(key);
+	return child ? child->get() : nullptr;
 }
 
 ErrorData DiskannIndex::Insert(IndexLock &lock, DataChunk &data, Vector &row_ids) {
@@ -366,33 +784,106 @@ void DiskannIndex::Delete(IndexLock &lock, DataChunk &entries, Vector &row_ident
 		return;
 	}
 
+	if (IsPartitioned()) {
+		// The deleted rows' old values name their partitions
+		DataChunk expr_chunk;
+		expr_chunk.Initialize(Allocator::DefaultAllocator(), logical_types);
+		ExecuteExpressions(entries, expr_chunk);
+		AnnPartitionMap<AnnPartitionRows> rows;
+		AnnGroupByPartition(expr_chunk.data[1], row_identifiers, count, rows);
+		for (idx_t p = 0; p < rows.Size(); p++) {
+			auto child = FindPartition(rows.Key(p));
+			if (child) {
+				lock_guard<mutex> guard(child->lock);
+				child->DeleteRows(rows.Get(p).row_ids.data(), rows.Get(p).row_ids.size());
+			}
+		}
+		result_cache_.Invalidate();
+		return;
+	}
+
 	UnifiedVectorFormat rowid_format;
 	row_identifiers.ToUnifiedFormat(count, rowid_format);
 	auto rowid_data = reinterpret_cast<row_t *>(rowid_format.data);
+	vector<row_t> row_ids(count);
+	for (idx_t i = 0; i < count; i++) {
+		row_ids[i] = rowid_data[rowid_format.sel->get_index(i)];
+	}
+	DeleteRows(row_ids.data(), count);
+}
 
+void DiskannIndex::DeleteRows(const row_t *row_ids, idx_t count) {
+	// Tombstones live in the Rust provider's bitmap: deleted nodes keep routing, never come back
+	vector<uint32_t> labels;
+	vector<uint32_t> base_labels;
+	labels.reserve(count);
 	for (idx_t i = 0; i < count; i++) {
-		auto row_idx = rowid_format.sel->get_index(i);
-		auto row_id = rowid_data[row_idx];
+		auto row_id = row_ids[i];
 
 		auto it = rowid_to_label_.find(row_id);
 		if (it != rowid_to_label_.end()) {
-			deleted_labels_.insert(it->second);
+			if (it->second < base_count_) {
+				base_labels.push_back(it->second);
+			} else {
+				labels.push_back(static_cast<uint32_t>(it->second - base_count_));
+			}
 			rowid_to_label_.erase(it);
 		}
 	}
+	if (rust_handle_) {
+		DiskannDetachedMarkDeleted(rust_handle_, labels);
+	}
+	if (disk_handle_) {
+		DiskannDiskMarkDeleted(disk_handle_, base_labels);
+	}
+	result_cache_.Invalidate();
 
 	is_dirty_ = true;
 }
 
 void DiskannIndex::CommitDrop(IndexLock &lock) {
+	for (auto *partition : Partitions()) {
+		auto &child = *partition;
+		IndexLock child_lock;
+		child.InitializeLock(child_lock);
+		child.CommitDrop(child_lock);
+	}
+	{
+		std::unique_lock<std::shared_mutex> guard(partitions_lock_);
+		partitions_.Clear();
+	}
 	if (rust_handle_) {
 		DiskannFreeDetached(rust_handle_);
 		rust_handle_ = nullptr;
 	}
+	if (disk_handle_) {
+		DiskannDiskFree(disk_handle_);
+		disk_handle_ = nullptr;
+	}
+	if (disk_storage_ && disk_generation_ > 0) {
+		RemoveDiskFile(DiskFilePath(disk_file_id_, disk_generation_));
+		for (auto &path : superseded_disk_files_) {
+			RemoveDiskFile(path);
+		}
+		superseded_disk_files_.clear();
+		disk_generation_ = 0;
+	}
+	base_count_ = 0;
 	label_to_rowid_.clear();
 	rowid_to_label_.clear();
-	deleted_labels_.clear();
-
+	result_cache_.Invalidate();
+	wal_log_.reset();
+	reservation_->Update(0);
+
+	// Reset() releases every segment chain at once
+	vector_segments_.clear();
+	adjacency_segments_.clear();
+	map_segments_.clear();
+	code_segments_.clear();
+	codebook_ptr_ = IndexPointer();
+	persisted_vectors_ = 0;
+	persisted_mappings_ = 0;
+	dirty_map_pages_.clear();
 	if (root_block_ptr_.Get() != 0) {
 		block_allocator_->Reset();
 		root_block_ptr_ = IndexPointer();
@@ -403,144 +894,904 @@ void DiskannIndex::CommitDrop(IndexLock &lock) {
 // Serialization
 // ========================================
 
-static constexpr uint32_t DISKANN_STORAGE_VERSION = 1;
+// v2+: root chain holds parameters + a segment directory; every vector page, adjacency
+// page and label map page is its own linked-block chain, so a checkpoint only rewrites
+// the segments that changed. Older versions are still readable and are upgraded on
+// the next checkpoint.
+static constexpr uint32_t DISKANN_STORAGE_VERSION = 7;
+// v6: same layout, vector pages always f32 (quantization byte at most 2)
+static constexpr uint32_t DISKANN_STORAGE_VERSION_NO_HALF = 6;
+// v5: same layout, SQ8 codes and parameters not stored (rebuilt from the vectors on load)
+static constexpr uint32_t DISKANN_STORAGE_VERSION_DERIVED_SQ8 = 5;
+// v4: same layout, the quantization byte is only ever 0 (none) or 1 (SQ8)
+static constexpr uint32_t DISKANN_STORAGE_VERSION_NO_PQ = 4;
+// v3: same layout, no recycled-label list after the tombstones
+static constexpr uint32_t DISKANN_STORAGE_VERSION_NO_FREE_SLOTS = 3;
+// v2: same layout, tombstones stored as a u32 label list instead of bitmap words
+static constexpr uint32_t DISKANN_STORAGE_VERSION_TOMBSTONE_LIST = 2;
+static constexpr uint32_t DISKANN_STORAGE_VERSION_MONOLITHIC = 1;
+// storage = 'disk': the root holds parameters, the .diskann file id and generation, the label
+// map directory and the base tombstones; the graph itself is in the file. A separate series,
+// so a disk root is never mistaken for a segmented one.
+static constexpr uint32_t DISKANN_STORAGE_VERSION_DISK = 104;
+// storage = 'disk' before the file id: the file is named by index name and generation only
+static constexpr uint32_t DISKANN_STORAGE_VERSION_DISK_NO_ID = 101;
+// Logical WAL record (AnnWalLog): the dimension, then the live (row id, vector) batches
+static constexpr uint32_t DISKANN_STORAGE_VERSION_WAL = 102;
+// partition_by: the partition directory (ann_partition.hpp); every child is a DiskANN index of its own
+static constexpr uint32_t DISKANN_STORAGE_VERSION_PARTITIONED = 103;
+
+static IndexPointer NewLinkedBlock(FixedSizeAllocator &allocator) {
+	auto ptr = allocator.New();
+	allocator.Get<LinkedBlock>(ptr, true)->next_block = IndexPointer();
+	return ptr;
+}
 
-void DiskannIndex::PersistToDisk() {
-	if (!is_dirty_ || !rust_handle_) {
+// Overwrite a segment chain in place (allocating it on first write)
+static void WriteSegment(FixedSizeAllocator &allocator, IndexPointer &segment, const void *data, idx_t len) {
+	if (segment.Get() == 0) {
+		segment = NewLinkedBlock(allocator);
+	}
+	LinkedBlockWriter writer(allocator, segment);
+	writer.Write(static_cast<const uint8_t *>(data), len);
+	writer.FreeTail();
+}
+
+static void ReadSegment(FixedSizeAllocator &allocator, IndexPointer segment, void *data, idx_t len,
+                        idx_t offset = 0) {
+	if (len == 0) {
 		return;
 	}
+	LinkedBlockReader reader(allocator, segment);
+	if (reader.Skip(offset) != offset || reader.Read(static_cast<uint8_t *>(data), len) != len) {
+		throw IOException("DiskANN index segment is truncated. Drop and recreate the index.");
+	}
+}
 
-	if (root_block_ptr_.Get() == 0) {
-		root_block_ptr_ = block_allocator_->New();
+// Quantization byte in the root chain. F16 / BF16: the vector pages hold half-width vectors
+// (no separate code pages), which are the index's vectors from then on.
+enum class DiskannQuantization : uint8_t { NONE = 0, SQ8 = 1, PQ = 2, F16 = 3, BF16 = 4 };
+
+// Shrink or grow a segment directory, freeing chains that fall off the end
+static void ResizeSegments(FixedSizeAllocator &allocator, vector<IndexPointer> &segments, idx_t count) {
+	for (idx_t i = count; i < segments.size(); i++) {
+		LinkedBlockWriter::FreeLinkedBlocks(allocator, segments[i]);
 	}
+	segments.resize(count);
+}
+
+// Tombstone bitmap words: label l is bit l % 64 of word l / 64
+static vector<uint64_t> TombstoneWords(const vector<uint32_t> &labels) {
+	vector<uint64_t> words;
+	for (auto label : labels) {
+		if ((label >> 6) >= words.size()) {
+			words.resize((label >> 6) + 1, 0);
+		}
+		words[label >> 6] |= uint64_t(1) << (label & 63);
+	}
+	return words;
+}
 
-	auto serialized = DiskannDetachedSerialize(rust_handle_);
+static bool IsTombstoned(const vector<uint64_t> &words, uint32_t label) {
+	return (label >> 6) < words.size() && (words[label >> 6] >> (label & 63)) & 1;
+}
 
-	uint64_t diskann_len = serialized.len;
-	uint64_t num_mappings = label_to_rowid_.size();
-	uint64_t num_tombstones = deleted_labels_.size();
+static vector<uint32_t> ReadTombstoneList(LinkedBlockReader &reader);
 
-	LinkedBlockWriter writer(*block_allocator_, root_block_ptr_);
-	writer.Reset();
+template <class T>
+static void WriteValue(LinkedBlockWriter &writer, const T &value) {
+	writer.Write(reinterpret_cast<const uint8_t *>(&value), sizeof(T));
+}
 
-	// Write version header
-	writer.Write(reinterpret_cast<const uint8_t *>(&DISKANN_STORAGE_VERSION), sizeof(uint32_t));
+template <class T>
+static T ReadValue(LinkedBlockReader &reader) {
+	T value {};
+	reader.Read(reinterpret_cast<uint8_t *>(&value), sizeof(T));
+	return value;
+}
 
-	writer.Write(reinterpret_cast<const uint8_t *>(&diskann_len), sizeof(uint64_t));
-	writer.Write(serialized.data, serialized.len);
+void DiskannIndex::ResetSegments() {
+	ResizeSegments(*block_allocator_, vector_segments_, 0);
+	ResizeSegments(*block_allocator_, adjacency_segments_, 0);
+	ResizeSegments(*block_allocator_, map_segments_, 0);
+	ResizeSegments(*block_allocator_, code_segments_, 0);
+	LinkedBlockWriter::FreeLinkedBlocks(*block_allocator_, codebook_ptr_);
+	codebook_ptr_ = IndexPointer();
+	persisted_vectors_ = 0;
+	persisted_mappings_ = 0;
+	dirty_map_pages_.clear();
+}
 
-	writer.Write(reinterpret_cast<const uint8_t *>(&num_mappings), sizeof(uint64_t));
-	if (num_mappings > 0) {
-		writer.Write(reinterpret_cast<const uint8_t *>(label_to_rowid_.data()), num_mappings * sizeof(row_t));
+void DiskannIndex::PersistToDisk() {
+	if (disk_storage_) {
+		PersistDiskStorage();
+		return;
+	}
+	if (!is_dirty_ || !rust_handle_) {
+		return;
 	}
 
-	writer.Write(reinterpret_cast<const uint8_t *>(&num_tombstones), sizeof(uint64_t));
-	if (num_tombstones > 0) {
-		vector<uint32_t> tombstone_vec(deleted_labels_.begin(), deleted_labels_.end());
-		writer.Write(reinterpret_cast<const uint8_t *>(tombstone_vec.data()), num_tombstones * sizeof(uint32_t));
+	// Exports below may fault pages in through ReadPage, which takes storage_lock_:
+	// hold it only around allocator access, never across a Rust call
+	unique_lock<mutex> guard(storage_lock_);
+	if (root_block_ptr_.Get() == 0) {
+		root_block_ptr_ = NewLinkedBlock(*block_allocator_);
+	}
+	guard.unlock();
+
+	auto page_nodes = static_cast<idx_t>(DiskannPageNodes());
+	auto num_vectors = static_cast<idx_t>(DiskannDetachedCount(rust_handle_));
+	auto num_pages = (num_vectors + page_nodes - 1) / page_nodes;
+
+	// Vectors change on the old tail page, new pages and wherever a recycled label was
+	// reused. Adjacency pages change wherever back-edges landed; Rust tracks both per page.
+	set<idx_t> vector_pages;
+	set<idx_t> adjacency_pages;
+	for (idx_t p = persisted_vectors_ / page_nodes; p < num_pages; p++) {
+		vector_pages.insert(p);
+		adjacency_pages.insert(p);
+	}
+	for (auto p : DiskannDetachedTakeDirtyVectorPages(rust_handle_)) {
+		if (p < num_pages) {
+			vector_pages.insert(p);
+		}
+	}
+	for (auto p : DiskannDetachedTakeDirtyPages(rust_handle_)) {
+		if (p < num_pages) {
+			adjacency_pages.insert(p);
+		}
+	}
+	// SQ8/PQ codes change exactly where vectors do; freshly trained codes rewrite them all
+	auto pq = DiskannDetachedIsPQ(rust_handle_);
+	auto quantized = !pq && DiskannDetachedIsQuantized(rust_handle_);
+	auto coded = pq || quantized;
+	// Half-width vector pages: ReadPage decodes every persisted vector page with half_format_
+	auto half = !coded && half_format_ != 0;
+	if (half && DiskannDetachedHalfFormat(rust_handle_) == 0) {
+		DiskannDetachedQuantizeHalf(rust_handle_, half_format_);
+	}
+	idx_t code_size = 0;
+	vector<uint8_t> codebook;
+	if (pq) {
+		code_size = static_cast<idx_t>(DiskannDetachedPQCodeSize(rust_handle_));
+		codebook = DiskannDetachedGetPQCodebook(rust_handle_);
+	} else if (quantized) {
+		code_size = static_cast<idx_t>(dimension_);
+		auto params = DiskannDetachedGetSQ8Params(rust_handle_);
+		codebook.resize(params.size() * sizeof(float));
+		memcpy(codebook.data(), params.data(), codebook.size());
+	}
+	guard.lock();
+	ResizeSegments(*block_allocator_, vector_segments_, num_pages);
+	ResizeSegments(*block_allocator_, adjacency_segments_, num_pages);
+	ResizeSegments(*block_allocator_, code_segments_, coded ? num_pages : 0);
+	if (coded && codebook_ptr_.Get() == 0) {
+		// The codebook never changes once trained: written once, with every code page
+		for (auto &segment : code_segments_) {
+			LinkedBlockWriter::FreeLinkedBlocks(*block_allocator_, segment);
+			segment = IndexPointer();
+		}
+		WriteSegment(*block_allocator_, codebook_ptr_, codebook.data(), codebook.size());
+	}
+	for (idx_t p = 0; p < num_pages; p++) {
+		if (vector_segments_[p].Get() == 0 || (coded && code_segments_[p].Get() == 0)) {
+			vector_pages.insert(p);
+		}
+		if (adjacency_segments_[p].Get() == 0) {
+			adjacency_pages.insert(p);
+		}
+	}
+	guard.unlock();
+
+	vector<float> vec_buf;
+	vector<uint16_t> half_buf;
+	vector<uint8_t> code_buf;
+	for (auto p : vector_pages) {
+		auto start = p * page_nodes;
+		auto count = MinValue<idx_t>(page_nodes, num_vectors - start);
+		if (half) {
+			half_buf.resize(count * dimension_);
+			DiskannDetachedExportHalfCodes(rust_handle_, static_cast<uint32_t>(start), static_cast<uint32_t>(count),
+			                               half_buf.data(), static_cast<int64_t>(half_buf.size()));
+			lock_guard<mutex> write_guard(storage_lock_);
+			WriteSegment(*block_allocator_, vector_segments_[p], half_buf.data(),
+			             half_buf.size() * sizeof(uint16_t));
+			continue;
+		}
+		vec_buf.resize(count * dimension_);
+		DiskannDetachedExportPage(rust_handle_, static_cast<uint32_t>(start), static_cast<uint32_t>(count),
+		                          vec_buf.data(), nullptr);
+		code_buf.resize(count * code_size);
+		if (pq) {
+			DiskannDetachedExportPQCodes(rust_handle_, static_cast<uint32_t>(start), static_cast<uint32_t>(count),
+			                             code_buf.data(), static_cast<int64_t>(code_buf.size()));
+		} else if (quantized) {
+			DiskannDetachedExportSQ8Codes(rust_handle_, static_cast<uint32_t>(start), static_cast<uint32_t>(count),
+			                              code_buf.data(), static_cast<int64_t>(code_buf.size()));
+		}
+		lock_guard<mutex> write_guard(storage_lock_);
+		WriteSegment(*block_allocator_, vector_segments_[p], vec_buf.data(), vec_buf.size() * sizeof(float));
+		if (coded) {
+			WriteSegment(*block_allocator_, code_segments_[p], code_buf.data(), code_buf.size());
+		}
+	}
+	vector<uint32_t> adj_buf;
+	for (auto p : adjacency_pages) {
+		auto start = p * page_nodes;
+		auto count = MinValue<idx_t>(page_nodes, num_vectors - start);
+		adj_buf.resize(count * max_degree_);
+		DiskannDetachedExportPage(rust_handle_, static_cast<uint32_t>(start), static_cast<uint32_t>(count), nullptr,
+		                          adj_buf.data());
+		lock_guard<mutex> write_guard(storage_lock_);
+		WriteSegment(*block_allocator_, adjacency_segments_[p], adj_buf.data(), adj_buf.size() * sizeof(uint32_t));
 	}
 
-	writer.Write(reinterpret_cast<const uint8_t *>(&dimension_), sizeof(int32_t));
-	writer.Write(reinterpret_cast<const uint8_t *>(&max_degree_), sizeof(int32_t));
-	writer.Write(reinterpret_cast<const uint8_t *>(&build_complexity_), sizeof(int32_t));
+	// Everything below is C++-side state: no more page faults
+	auto entry_points = DiskannDetachedGetEntryPoints(rust_handle_);
+	auto tombstones = DiskannDetachedGetTombstones(rust_handle_);
+	auto free_slots = DiskannDetachedGetFreeSlots(rust_handle_);
+	guard.lock();
+
+	PersistMappings();
+
+	// Root: parameters, entry points, segment directory, tombstones
+	LinkedBlockWriter writer(*block_allocator_, root_block_ptr_);
+	writer.Reset();
+
+	WriteValue(writer, DISKANN_STORAGE_VERSION);
+	WriteValue(writer, dimension_);
+	WriteValue(writer, max_degree_);
+	WriteValue(writer, build_complexity_);
 	uint32_t metric_len = static_cast<uint32_t>(metric_.size());
-	writer.Write(reinterpret_cast<const uint8_t *>(&metric_len), sizeof(uint32_t));
+	WriteValue(writer, metric_len);
 	writer.Write(reinterpret_cast<const uint8_t *>(metric_.data()), metric_len);
 	uint32_t alpha_bits;
 	memcpy(&alpha_bits, &alpha_, sizeof(float));
-	writer.Write(reinterpret_cast<const uint8_t *>(&alpha_bits), sizeof(uint32_t));
+	WriteValue(writer, alpha_bits);
+	auto quantization = pq ? DiskannQuantization::PQ : quantized ? DiskannQuantization::SQ8 : DiskannQuantization::NONE;
+	if (half) {
+		quantization = half_format_ == 1 ? DiskannQuantization::F16 : DiskannQuantization::BF16;
+	}
+	WriteValue(writer, static_cast<uint8_t>(quantization));
+	if (coded) {
+		WriteValue(writer, codebook_ptr_.Get());
+		WriteValue(writer, static_cast<uint64_t>(codebook.size()));
+		WriteValue(writer, static_cast<uint32_t>(code_size));
+	}
+
+	WriteValue(writer, static_cast<uint32_t>(page_nodes));
+	WriteValue(writer, static_cast<uint64_t>(num_vectors));
+	WriteValue(writer, static_cast<uint64_t>(entry_points.size()));
+	writer.Write(reinterpret_cast<const uint8_t *>(entry_points.data()), entry_points.size() * sizeof(uint32_t));
+
+	WriteValue(writer, static_cast<uint64_t>(num_pages));
+	for (idx_t p = 0; p < num_pages; p++) {
+		WriteValue(writer, vector_segments_[p].Get());
+		WriteValue(writer, adjacency_segments_[p].Get());
+		if (coded) {
+			WriteValue(writer, code_segments_[p].Get());
+		}
+	}
+	WriteMapDirectory(writer);
 
-	DiskannFreeSerializedBytes(serialized);
+	WriteValue(writer, static_cast<uint64_t>(tombstones.size()));
+	writer.Write(reinterpret_cast<const uint8_t *>(tombstones.data()), tombstones.size() * sizeof(uint64_t));
+	WriteValue(writer, static_cast<uint64_t>(free_slots.size()));
+	writer.Write(reinterpret_cast<const uint8_t *>(free_slots.data()), free_slots.size() * sizeof(uint32_t));
+	writer.FreeTail();
+
+	persisted_vectors_ = num_vectors;
 	is_dirty_ = false;
-}
+	guard.unlock();
 
-void DiskannIndex::LoadFromStorage(const IndexStorageInfo &info) {
-	if (!info.IsValid() || info.allocator_infos.empty()) {
-		return;
+	// Searches run on the codes now: full-precision vectors are read back from storage to re-rank
+	// (half-width vectors are read from memory instead)
+	if (coded || half) {
+		DiskannDetachedEvictVectors(rust_handle_, static_cast<uint32_t>(num_vectors), LoadPageCallback, this);
 	}
+}
 
-	root_block_ptr_.Set(info.root);
-	block_allocator_->Init(info.allocator_infos[0]);
+// Label -> row id map grows at the end and changes in place where labels were
+// recycled: rewrite from the old tail page on, plus the recycled pages
+void DiskannIndex::PersistMappings() {
+	idx_t num_mappings = label_to_rowid_.size();
+	auto num_map_pages = (num_mappings + MAP_PAGE_ENTRIES - 1) / MAP_PAGE_ENTRIES;
+	ResizeSegments(*block_allocator_, map_segments_, num_map_pages);
+	for (idx_t p = 0; p < num_map_pages; p++) {
+		if (map_segments_[p].Get() != 0 && (p + 1) * MAP_PAGE_ENTRIES <= persisted_mappings_ &&
+		    dirty_map_pages_.find(p) == dirty_map_pages_.end()) {
+			continue;
+		}
+		auto start = p * MAP_PAGE_ENTRIES;
+		auto count = MinValue<idx_t>(MAP_PAGE_ENTRIES, num_mappings - start);
+		WriteSegment(*block_allocator_, map_segments_[p], label_to_rowid_.data() + start, count * sizeof(row_t));
+	}
+	persisted_mappings_ = num_mappings;
+	dirty_map_pages_.clear();
+}
 
-	LinkedBlockReader reader(*block_allocator_, root_block_ptr_);
+void DiskannIndex::WriteMapDirectory(LinkedBlockWriter &writer) const {
+	WriteValue(writer, static_cast<uint64_t>(label_to_rowid_.size()));
+	WriteValue(writer, static_cast<uint64_t>(MAP_PAGE_ENTRIES));
+	WriteValue(writer, static_cast<uint64_t>(map_segments_.size()));
+	for (auto &segment : map_segments_) {
+		WriteValue(writer, segment.Get());
+	}
+}
 
-	// Read and validate version header
-	uint32_t version = 0;
-	reader.Read(reinterpret_cast<uint8_t *>(&version), sizeof(uint32_t));
-	if (version != DISKANN_STORAGE_VERSION) {
-		throw IOException("DiskANN index storage version mismatch: found %u, expected %u. "
-		                  "Drop and recreate the index.",
-		                  version, DISKANN_STORAGE_VERSION);
+// Either output may be null; [start, start + count) may be any range inside one page
+void DiskannIndex::ReadPage(uint32_t start, uint32_t count, float *out_vectors, uint32_t *out_adjacency) {
+	lock_guard<mutex> guard(storage_lock_);
+	auto page = start / DiskannPageNodes();
+	if (page >= vector_segments_.size() || page >= adjacency_segments_.size()) {
+		throw IOException("DiskANN index page %u is not in storage", page);
+	}
+	auto skip = idx_t(start - page * DiskannPageNodes());
+	if (out_vectors && half_format_) {
+		vector<uint16_t> half_buf(idx_t(count) * dimension_);
+		ReadSegment(*block_allocator_, vector_segments_[page], half_buf.data(), half_buf.size() * sizeof(uint16_t),
+		            skip * dimension_ * sizeof(uint16_t));
+		DiskannHalfToFloat(half_format_, half_buf.data(), half_buf.size(), out_vectors);
+	} else if (out_vectors) {
+		ReadSegment(*block_allocator_, vector_segments_[page], out_vectors, idx_t(count) * dimension_ * sizeof(float),
+		            skip * dimension_ * sizeof(float));
 	}
+	if (out_adjacency) {
+		ReadSegment(*block_allocator_, adjacency_segments_[page], out_adjacency,
+		            idx_t(count) * max_degree_ * sizeof(uint32_t), skip * max_degree_ * sizeof(uint32_t));
+	}
+}
 
-	uint64_t diskann_len = 0;
-	reader.Read(reinterpret_cast<uint8_t *>(&diskann_len), sizeof(uint64_t));
+int32_t DiskannIndex::LoadPageCallback(void *ctx, uint32_t start, uint32_t count, float *out_vectors,
+                                       uint32_t *out_adjacency) {
+	try {
+		static_cast<DiskannIndex *>(ctx)->ReadPage(start, count, out_vectors, out_adjacency);
+		return 0;
+	} catch (...) {
+		return -1;
+	}
+}
 
+// v1: one serialized Rust blob followed by mappings, tombstones and parameters
+void DiskannIndex::LoadMonolithic(LinkedBlockReader &reader) {
+	auto diskann_len = ReadValue<uint64_t>(reader);
 	vector<uint8_t> diskann_data(diskann_len);
 	reader.Read(diskann_data.data(), diskann_len);
 
-	uint64_t num_mappings = 0;
-	reader.Read(reinterpret_cast<uint8_t *>(&num_mappings), sizeof(uint64_t));
+	auto num_mappings = ReadValue<uint64_t>(reader);
 	label_to_rowid_.resize(num_mappings);
 	if (num_mappings > 0) {
 		reader.Read(reinterpret_cast<uint8_t *>(label_to_rowid_.data()), num_mappings * sizeof(row_t));
 	}
 
-	uint64_t num_tombstones = 0;
-	reader.Read(reinterpret_cast<uint8_t *>(&num_tombstones), sizeof(uint64_t));
-	if (num_tombstones > 0) {
-		vector<uint32_t> tombstones(num_tombstones);
-		reader.Read(reinterpret_cast<uint8_t *>(tombstones.data()), num_tombstones * sizeof(uint32_t));
-		deleted_labels_.insert(tombstones.begin(), tombstones.end());
-	}
+	auto tombstones = ReadTombstoneList(reader);
 
-	reader.Read(reinterpret_cast<uint8_t *>(&dimension_), sizeof(int32_t));
-	reader.Read(reinterpret_cast<uint8_t *>(&max_degree_), sizeof(int32_t));
-	reader.Read(reinterpret_cast<uint8_t *>(&build_complexity_), sizeof(int32_t));
-	uint32_t metric_len = 0;
-	reader.Read(reinterpret_cast<uint8_t *>(&metric_len), sizeof(uint32_t));
+	dimension_ = ReadValue<int32_t>(reader);
+	max_degree_ = ReadValue<int32_t>(reader);
+	build_complexity_ = ReadValue<int32_t>(reader);
+	auto metric_len = ReadValue<uint32_t>(reader);
 	vector<char> metric_buf(metric_len);
 	reader.Read(reinterpret_cast<uint8_t *>(metric_buf.data()), metric_len);
 	metric_.assign(metric_buf.data(), metric_len);
-	uint32_t alpha_bits = 0;
-	reader.Read(reinterpret_cast<uint8_t *>(&alpha_bits), sizeof(uint32_t));
+	auto alpha_bits = ReadValue<uint32_t>(reader);
 	memcpy(&alpha_, &alpha_bits, sizeof(float));
 
-	rowid_to_label_.reserve(num_mappings);
-	for (size_t i = 0; i < label_to_rowid_.size(); i++) {
-		if (deleted_labels_.count(static_cast<uint32_t>(i)) == 0) {
-			rowid_to_label_[label_to_rowid_[i]] = static_cast<uint32_t>(i);
-		}
-	}
-
 	rust_handle_ = DiskannDetachedDeserialize(diskann_data.data(), diskann_data.size(), alpha_);
-	is_dirty_ = false;
-}
-
-IndexStorageInfo DiskannIndex::SerializeToDisk(QueryContext context, const case_insensitive_map_t<Value> &options) {
-	PersistToDisk();
-
-	IndexStorageInfo info;
-	info.name = name;
-	info.root = root_block_ptr_.Get();
-
-	auto &block_manager = table_io_manager.GetIndexBlockManager();
-	PartialBlockManager partial_block_manager(context, block_manager, PartialBlockType::FULL_CHECKPOINT);
-	block_allocator_->SerializeBuffers(partial_block_manager);
-	partial_block_manager.FlushPartialBlocks();
-	info.allocator_infos.push_back(block_allocator_->GetInfo());
+	DiskannDetachedSetTombstones(rust_handle_, TombstoneWords(tombstones));
 
-	return info;
+	// No segments yet: the next checkpoint writes the v2 layout into the same root chain
+	is_dirty_ = true;
 }
 
-IndexStorageInfo DiskannIndex::SerializeToWAL(const case_insensitive_map_t<Value> &options) {
-	PersistToDisk();
+static vector<uint32_t> ReadTombstoneList(LinkedBlockReader &reader) {
+	vector<uint32_t> tombstones(ReadValue<uint64_t>(reader));
+	reader.Read(reinterpret_cast<uint8_t *>(tombstones.data()), tombstones.size() * sizeof(uint32_t));
+	return tombstones;
+}
+
+void DiskannIndex::LoadSegmented(LinkedBlockReader &reader, uint32_t version) {
+	dimension_ = ReadValue<int32_t>(reader);
+	max_degree_ = ReadValue<int32_t>(reader);
+	build_complexity_ = ReadValue<int32_t>(reader);
+	auto metric_len = ReadValue<uint32_t>(reader);
+	vector<char> metric_buf(metric_len);
+	reader.Read(reinterpret_cast<uint8_t *>(metric_buf.data()), metric_len);
+	metric_.assign(metric_buf.data(), metric_len);
+	auto alpha_bits = ReadValue<uint32_t>(reader);
+	memcpy(&alpha_, &alpha_bits, sizeof(float));
+	auto quantization = static_cast<DiskannQuantization>(ReadValue<uint8_t>(reader));
+	if (quantization > DiskannQuantization::BF16 ||
+	    (version <= DISKANN_STORAGE_VERSION_NO_HALF && quantization > DiskannQuantization::PQ) ||
+	    (version <= DISKANN_STORAGE_VERSION_NO_PQ && quantization > DiskannQuantization::SQ8)) {
+		throw IOException("DiskANN index storage is corrupt (quantization %u in a v%u index). "
+		                  "Drop and recreate the index.",
+		                  static_cast<uint32_t>(quantization), version);
+	}
+	// Codes are stored for PQ, and for SQ8 since v6
+	auto pq = quantization == DiskannQuantization::PQ;
+	auto derived_sq8 = quantization == DiskannQuantization::SQ8 && version <= DISKANN_STORAGE_VERSION_DERIVED_SQ8;
+	auto half = quantization == DiskannQuantization::F16 || quantization == DiskannQuantization::BF16;
+	auto coded = quantization != DiskannQuantization::NONE && !derived_sq8 && !half;
+	half_format_ = half ? (quantization == DiskannQuantization::F16 ? 1 : 2) : 0;
+	uint64_t codebook_len = 0;
+	idx_t code_size = 0;
+	if (coded) {
+		codebook_ptr_.Set(ReadValue<uint64_t>(reader));
+		codebook_len = ReadValue<uint64_t>(reader);
+		code_size = ReadValue<uint32_t>(reader);
+	}
+
+	auto page_nodes = static_cast<idx_t>(ReadValue<uint32_t>(reader));
+	auto num_vectors = ReadValue<uint64_t>(reader);
+	vector<uint32_t> entry_points(ReadValue<uint64_t>(reader));
+	reader.Read(reinterpret_cast<uint8_t *>(entry_points.data()), entry_points.size() * sizeof(uint32_t));
+
+	auto num_pages = ReadValue<uint64_t>(reader);
+	vector_segments_.resize(num_pages);
+	adjacency_segments_.resize(num_pages);
+	code_segments_.resize(coded ? num_pages : 0);
+	for (idx_t p = 0; p < num_pages; p++) {
+		vector_segments_[p].Set(ReadValue<uint64_t>(reader));
+		adjacency_segments_[p].Set(ReadValue<uint64_t>(reader));
+		if (coded) {
+			code_segments_[p].Set(ReadValue<uint64_t>(reader));
+		}
+	}
+	auto num_mappings = ReadValue<uint64_t>(reader);
+	auto map_page_entries = ReadValue<uint64_t>(reader);
+	map_segments_.resize(ReadValue<uint64_t>(reader));
+	for (auto &segment : map_segments_) {
+		segment.Set(ReadValue<uint64_t>(reader));
+	}
+
+	vector<uint64_t> tombstones;
+	if (version == DISKANN_STORAGE_VERSION_TOMBSTONE_LIST) {
+		tombstones = TombstoneWords(ReadTombstoneList(reader));
+		// Rewrite the root in the current format at the next checkpoint
+		is_dirty_ = true;
+	} else {
+		tombstones.resize(ReadValue<uint64_t>(reader));
+		reader.Read(reinterpret_cast<uint8_t *>(tombstones.data()), tombstones.size() * sizeof(uint64_t));
+	}
+	vector<uint32_t> free_slots;
+	if (version > DISKANN_STORAGE_VERSION_NO_FREE_SLOTS) {
+		free_slots.resize(ReadValue<uint64_t>(reader));
+		reader.Read(reinterpret_cast<uint8_t *>(free_slots.data()), free_slots.size() * sizeof(uint32_t));
+	}
+
+	rust_handle_ = DiskannCreateDetached(dimension_, metric_, max_degree_, build_complexity_, alpha_);
+	DiskannDetachedSetTombstones(rust_handle_, tombstones);
+	DiskannDetachedSetFreeSlots(rust_handle_, free_slots);
+	if (coded) {
+		// Codes stay resident (they drive the traversal); vectors are only read back to re-rank
+		vector<uint8_t> codebook(codebook_len);
+		ReadSegment(*block_allocator_, codebook_ptr_, codebook.data(), codebook.size());
+		vector<uint8_t> codes(num_vectors * code_size);
+		for (idx_t p = 0; p < num_pages; p++) {
+			auto start = p * page_nodes;
+			auto count = MinValue<idx_t>(page_nodes, num_vectors - start);
+			ReadSegment(*block_allocator_, code_segments_[p], codes.data() + start * code_size, count * code_size);
+		}
+		if (pq) {
+			DiskannDetachedLoadPQ(rust_handle_, codebook, codes);
+		} else {
+			vector<float> params(codebook.size() / sizeof(float));
+			memcpy(params.data(), codebook.data(), params.size() * sizeof(float));
+			DiskannDetachedLoadSQ8(rust_handle_, params, codes);
+		}
+	}
+	vector<uint16_t> half_codes;
+	if (half) {
+		// The vector pages are the half-width vectors: resident, like codes
+		half_codes.resize(num_vectors * dimension_);
+		for (idx_t p = 0; p < num_pages; p++) {
+			auto start = p * page_nodes;
+			auto count = MinValue<idx_t>(page_nodes, num_vectors - start);
+			ReadSegment(*block_allocator_, vector_segments_[p], half_codes.data() + start * dimension_,
+			            count * dimension_ * sizeof(uint16_t));
+		}
+		DiskannDetachedLoadHalf(rust_handle_, half_format_, half_codes);
+	}
+	auto same_geometry = page_nodes == DiskannPageNodes() && map_page_entries == MAP_PAGE_ENTRIES;
+	if (same_geometry) {
+		// Open in O(metadata): pages stay in their buffer-managed blocks until a query touches them
+		DiskannDetachedAttachPager(rust_handle_, static_cast<uint32_t>(num_vectors), entry_points, LoadPageCallback,
+		                           this);
+		if (coded || half) {
+			// Vectors stay in storage for good: only re-ranking reads them
+			DiskannDetachedEvictVectors(rust_handle_, static_cast<uint32_t>(num_vectors), LoadPageCallback, this);
+		}
+	} else {
+		// Different page size: import page by page now, the segments get rewritten below
+		vector<float> vec_buf;
+		vector<uint32_t> adj_buf;
+		for (idx_t p = 0; p < num_pages; p++) {
+			auto start = p * page_nodes;
+			auto count = MinValue<idx_t>(page_nodes, num_vectors - start);
+			vec_buf.resize(count * dimension_);
+			adj_buf.resize(count * max_degree_);
+			if (half) {
+				DiskannHalfToFloat(half_format_, half_codes.data() + start * dimension_, vec_buf.size(),
+				                   vec_buf.data());
+			} else {
+				ReadSegment(*block_allocator_, vector_segments_[p], vec_buf.data(), vec_buf.size() * sizeof(float));
+			}
+			ReadSegment(*block_allocator_, adjacency_segments_[p], adj_buf.data(),
+			            adj_buf.size() * sizeof(uint32_t));
+			DiskannDetachedImportPage(rust_handle_, static_cast<uint32_t>(start), static_cast<uint32_t>(count),
+			                          vec_buf.data(), adj_buf.data());
+		}
+		DiskannDetachedFinishImport(rust_handle_, static_cast<uint32_t>(num_vectors), entry_points);
+	}
+	if (derived_sq8) {
+		// v5 SQ8 codes were derived data: rebuild them from the full-precision pages, store them next checkpoint
+		DiskannDetachedQuantizeSQ8(rust_handle_);
+		is_dirty_ = true;
+	}
+
+	label_to_rowid_.resize(num_mappings);
+	for (idx_t p = 0; p < map_segments_.size(); p++) {
+		auto start = p * map_page_entries;
+		if (start >= num_mappings) {
+			break;
+		}
+		auto count = MinValue<idx_t>(map_page_entries, num_mappings - start);
+		ReadSegment(*block_allocator_, map_segments_[p], label_to_rowid_.data() + start, count * sizeof(row_t));
+	}
+
+	persisted_vectors_ = num_vectors;
+	persisted_mappings_ = num_mappings;
+
+	// Page geometry changed since this index was written: rewrite every segment on next checkpoint
+	if (!same_geometry) {
+		ResetSegments();
+		is_dirty_ = true;
+	}
+}
+
+void DiskannIndex::LoadFromStorage(const IndexStorageInfo &info) {
+	if (!info.IsValid() || info.allocator_infos.empty()) {
+		return;
+	}
+
+	root_block_ptr_.Set(info.root);
+	block_allocator_->Init(info.allocator_infos[0]);
+
+	LinkedBlockReader reader(*block_allocator_, root_block_ptr_);
+
+	// Read and validate version header
+	auto version = ReadValue<uint32_t>(reader);
+	if (version == DISKANN_STORAGE_VERSION_WAL) {
+		LoadWalLog(reader);
+		return;
+	}
+	if (version == DISKANN_STORAGE_VERSION_PARTITIONED) {
+		LoadPartitions(reader, info);
+		return;
+	}
+	if (version == DISKANN_STORAGE_VERSION_DISK || version == DISKANN_STORAGE_VERSION_DISK_NO_ID) {
+		LoadDiskStorage(reader, version == DISKANN_STORAGE_VERSION_DISK);
+	} else if (version >= DISKANN_STORAGE_VERSION_TOMBSTONE_LIST && version <= DISKANN_STORAGE_VERSION) {
+		LoadSegmented(reader, version);
+	} else if (version == DISKANN_STORAGE_VERSION_MONOLITHIC) {
+		LoadMonolithic(reader);
+	} else {
+		throw IOException("DiskANN index storage version mismatch: found %u, expected %u. "
+		                  "Drop and recreate the index.",
+		                  version, DISKANN_STORAGE_VERSION);
+	}
+
+	auto tombstones = GetTombstones();
+	rowid_to_label_.reserve(label_to_rowid_.size());
+	for (size_t i = 0; i < label_to_rowid_.size(); i++) {
+		if (!IsTombstoned(tombstones, static_cast<uint32_t>(i))) {
+			rowid_to_label_[label_to_rowid_[i]] = static_cast<uint32_t>(i);
+		}
+	}
+}
+
+void DiskannIndex::LoadWalLog(LinkedBlockReader &reader) {
+	auto dimension = ReadValue<int32_t>(reader);
+	if (dimension != dimension_) {
+		throw IOException("DiskANN WAL record of index \"%s\" has dimension %d, the index expects %d", name,
+		                  dimension, dimension_);
+	}
+	AnnWalLog::ReadRows(reader, static_cast<idx_t>(dimension_),
+	                    [&](const row_t *row_ids, const float *vectors, idx_t count) {
+		                    if (!rust_handle_) {
+			                    rust_handle_ =
+			                        DiskannCreateDetached(dimension_, metric_, max_degree_, build_complexity_, alpha_);
+		                    }
+		                    vector<int64_t> labels(count);
+		                    AddBatch(vectors, count, labels.data());
+		                    MapLabels(labels.data(), row_ids, count);
+	                    });
+	// The record only lived in the WAL: this index's block storage starts out empty
+	block_allocator_->Reset();
+	root_block_ptr_ = IndexPointer();
+	is_dirty_ = true;
+}
+
+void DiskannIndex::LoadPartitions(LinkedBlockReader &reader, const IndexStorageInfo &info) {
+	if (!IsPartitioned()) {
+		throw IOException("DiskANN index \"%s\" is stored partitioned but has no partition_by option", name);
+	}
+	auto directory = AnnReadPartitionDirectory(reader, partition_type_);
+	for (idx_t i = 0; i < directory.size(); i++) {
+		GetOrCreatePartition(directory[i].key,
+		                     AnnPartitionStorage::ChildInfo(info, i, directory[i].root, child_options_));
+	}
+}
+
+void DiskannIndex::WritePartitionRoot(const vector<AnnPartitionEntry> &directory) {
+	if (root_block_ptr_.Get() == 0) {
+		root_block_ptr_ = NewLinkedBlock(*block_allocator_);
+	}
+	LinkedBlockWriter writer(*block_allocator_, root_block_ptr_);
+	WriteValue(writer, DISKANN_STORAGE_VERSION_PARTITIONED);
+	AnnWritePartitionDirectory(writer, directory);
+	writer.FreeTail();
+}
+
+// ========================================
+// storage = 'disk'
+// ========================================
+
+string DiskannIndex::DiskFilePath(const string &file_id, uint64_t generation) const {
+	auto &db_path = db.GetStorageManager().GetDBPath();
+	if (file_id.empty()) {
+		return StringUtil::Format("%s.%s.%llu.diskann", db_path, name, generation);
+	}
+	return StringUtil::Format("%s.%s.%s.%llu.diskann", db_path, name, file_id, generation);
+}
+
+void DiskannIndex::RemoveDiskFile(const string &path) const {
+	auto &fs = FileSystem::Get(db);
+	if (fs.FileExists(path)) {
+		fs.RemoveFile(path);
+	}
+}
+
+void DiskannIndex::RemoveStaleDiskFiles() const {
+	if (db.IsReadOnly()) {
+		return;
+	}
+	// Generations only grow by one per compaction: everything below the current one is
+	// superseded, and the ones above were written by compactions no checkpoint committed
+	for (uint64_t generation = 1; generation < disk_generation_; generation++) {
+		RemoveDiskFile(DiskFilePath(disk_file_id_, generation));
+	}
+	auto &fs = FileSystem::Get(db);
+	for (auto generation = disk_generation_;; generation++) {
+		auto path = DiskFilePath(disk_file_id_, generation);
+		RemoveDiskFile(path + ".tmp");
+		if (generation == disk_generation_) {
+			continue;
+		}
+		if (!fs.FileExists(path)) {
+			break;
+		}
+		fs.RemoveFile(path);
+	}
+}
+
+static string NewDiskFileId() {
+	RandomEngine random;
+	return StringUtil::Format("%08x%08x", random.NextRandomInteger(), random.NextRandomInteger());
+}
+
+// Checkpoints merge the delta into the current file in place: its nodes are appended after
+// the file's and the file nodes that gained edges to them are patched. The root written
+// below records the new node count; until it is durable, the previous root still opens the
+// file as its first base_count_ nodes. Only the first checkpoint and a compaction (VACUUM)
+// write a whole new file, as the next generation.
+void DiskannIndex::PersistDiskStorage() {
+	// The previous checkpoint wrote the root naming their successor
+	for (auto &path : superseded_disk_files_) {
+		RemoveDiskFile(path);
+	}
+	superseded_disk_files_.clear();
+	if (!is_dirty_) {
+		return;
+	}
+	auto has_delta = rust_handle_ && DiskannDetachedCount(rust_handle_) > 0;
+	if (has_delta || (compact_disk_file_ && disk_handle_)) {
+		DiskannDiskHandle merged;
+		if (disk_handle_ && !compact_disk_file_) {
+			merged = DiskannDiskAppend(disk_handle_, rust_handle_, DiskFilePath(disk_file_id_, disk_generation_), -1,
+			                           RunTasks, &TaskScheduler::GetScheduler(db.GetDatabase()));
+		} else {
+			if (!rust_handle_) {
+				// Compaction with nothing appended since the last checkpoint
+				rust_handle_ = DiskannCreateDetached(dimension_, metric_, max_degree_, build_complexity_, alpha_);
+			}
+			auto file_id = disk_file_id_.empty() ? NewDiskFileId() : disk_file_id_;
+			merged = DiskannDiskMerge(disk_handle_, rust_handle_, DiskFilePath(file_id, disk_generation_ + 1), -1,
+			                          RunTasks, &TaskScheduler::GetScheduler(db.GetDatabase()));
+			if (disk_handle_) {
+				superseded_disk_files_.push_back(DiskFilePath(disk_file_id_, disk_generation_));
+			}
+			disk_file_id_ = file_id;
+			disk_generation_++;
+		}
+		if (disk_handle_) {
+			DiskannDiskFree(disk_handle_);
+		}
+		disk_handle_ = merged;
+		base_count_ = static_cast<idx_t>(DiskannDiskCount(disk_handle_));
+		compact_disk_file_ = false;
+		// Appends start a fresh delta; its labels continue after the new base
+		DiskannFreeDetached(rust_handle_);
+		rust_handle_ = nullptr;
+		result_cache_.Invalidate();
+	}
+	auto tombstones = disk_handle_ ? DiskannDiskGetTombstones(disk_handle_) : vector<uint64_t>();
+
+	lock_guard<mutex> guard(storage_lock_);
+	if (root_block_ptr_.Get() == 0) {
+		root_block_ptr_ = NewLinkedBlock(*block_allocator_);
+	}
+	PersistMappings();
+
+	LinkedBlockWriter writer(*block_allocator_, root_block_ptr_);
+	writer.Reset();
+	WriteValue(writer, DISKANN_STORAGE_VERSION_DISK);
+	WriteValue(writer, dimension_);
+	WriteValue(writer, max_degree_);
+	WriteValue(writer, build_complexity_);
+	uint32_t metric_len = static_cast<uint32_t>(metric_.size());
+	WriteValue(writer, metric_len);
+	writer.Write(reinterpret_cast<const uint8_t *>(metric_.data()), metric_len);
+	uint32_t alpha_bits;
+	memcpy(&alpha_bits, &alpha_, sizeof(float));
+	WriteValue(writer, alpha_bits);
+	uint32_t file_id_len = static_cast<uint32_t>(disk_file_id_.size());
+	WriteValue(writer, file_id_len);
+	writer.Write(reinterpret_cast<const uint8_t *>(disk_file_id_.data()), file_id_len);
+	WriteValue(writer, disk_generation_);
+	WriteValue(writer, static_cast<uint64_t>(base_count_));
+	WriteMapDirectory(writer);
+	WriteValue(writer, static_cast<uint64_t>(tombstones.size()));
+	writer.Write(reinterpret_cast<const uint8_t *>(tombstones.data()), tombstones.size() * sizeof(uint64_t));
+	writer.FreeTail();
+	is_dirty_ = false;
+}
+
+void DiskannIndex::LoadDiskStorage(LinkedBlockReader &reader, bool has_file_id) {
+	disk_storage_ = true;
+	dimension_ = ReadValue<int32_t>(reader);
+	max_degree_ = ReadValue<int32_t>(reader);
+	build_complexity_ = ReadValue<int32_t>(reader);
+	auto metric_len = ReadValue<uint32_t>(reader);
+	vector<char> metric_buf(metric_len);
+	reader.Read(reinterpret_cast<uint8_t *>(metric_buf.data()), metric_len);
+	metric_.assign(metric_buf.data(), metric_len);
+	auto alpha_bits = ReadValue<uint32_t>(reader);
+	memcpy(&alpha_, &alpha_bits, sizeof(float));
+	if (has_file_id) {
+		auto file_id_len = ReadValue<uint32_t>(reader);
+		vector<char> file_id_buf(file_id_len);
+		reader.Read(reinterpret_cast<uint8_t *>(file_id_buf.data()), file_id_len);
+		disk_file_id_.assign(file_id_buf.data(), file_id_len);
+	}
+	disk_generation_ = ReadValue<uint64_t>(reader);
+	base_count_ = ReadValue<uint64_t>(reader);
+
+	auto num_mappings = ReadValue<uint64_t>(reader);
+	auto map_page_entries = ReadValue<uint64_t>(reader);
+	map_segments_.resize(ReadValue<uint64_t>(reader));
+	for (auto &segment : map_segments_) {
+		segment.Set(ReadValue<uint64_t>(reader));
+	}
+	vector<uint64_t> tombstones(ReadValue<uint64_t>(reader));
+	reader.Read(reinterpret_cast<uint8_t *>(tombstones.data()), tombstones.size() * sizeof(uint64_t));
+
+	if (disk_generation_ > 0) {
+		RemoveStaleDiskFiles();
+		auto path = DiskFilePath(disk_file_id_, disk_generation_);
+		try {
+			// A checkpoint that appended to the file but never committed its root left nodes past
+			// base_count_: they are not this index's, and the next append writes over them
+			disk_handle_ = DiskannDiskOpen(path, -1, static_cast<int64_t>(base_count_));
+		} catch (std::exception &ex) {
+			throw IOException("DiskANN index \"%s\" cannot open its graph file: %s. Drop and recreate the index.",
+			                  name, ex.what());
+		}
+		if (static_cast<idx_t>(DiskannDiskCount(disk_handle_)) != base_count_) {
+			throw IOException("DiskANN graph file \"%s\" holds %lld nodes, the index expects %llu. "
+			                  "Drop and recreate the index.",
+			                  path, DiskannDiskCount(disk_handle_), base_count_);
+		}
+		DiskannDiskSetTombstones(disk_handle_, tombstones);
+	}
+
+	label_to_rowid_.resize(num_mappings);
+	for (idx_t p = 0; p < map_segments_.size(); p++) {
+		auto start = p * map_page_entries;
+		if (start >= num_mappings) {
+			break;
+		}
+		auto count = MinValue<idx_t>(map_page_entries, num_mappings - start);
+		ReadSegment(*block_allocator_, map_segments_[p], label_to_rowid_.data() + start, count * sizeof(row_t));
+	}
+	persisted_mappings_ = num_mappings;
+	if (map_page_entries != MAP_PAGE_ENTRIES) {
+		ResizeSegments(*block_allocator_, map_segments_, 0);
+		persisted_mappings_ = 0;
+		is_dirty_ = true;
+	}
+}
+
+IndexStorageInfo DiskannIndex::SerializeToDisk(QueryContext context, const case_insensitive_map_t<Value> &options) {
+	AnnPartitionStorage partitions;
+	{
+		std::shared_lock<std::shared_mutex> partitions_guard(partitions_lock_);
+		for (idx_t p = 0; p < partitions_.Size(); p++) {
+			auto &child = *partitions_.Get(p);
+			lock_guard<mutex> guard(child.lock);
+			partitions.Add(partitions_.Key(p), child.SerializeToDisk(context, child_options_));
+		}
+	}
+	if (IsPartitioned()) {
+		WritePartitionRoot(partitions.directory);
+	} else {
+		wal_log_.reset();
+		PersistToDisk();
+		UpdateReservation();
+	}
+
+	IndexStorageInfo info;
+	info.name = name;
+	info.root = root_block_ptr_.Get();
+
+	auto &block_manager = table_io_manager.GetIndexBlockManager();
+	PartialBlockManager partial_block_manager(context, block_manager, PartialBlockType::FULL_CHECKPOINT);
+	block_allocator_->SerializeBuffers(partial_block_manager);
+	partial_block_manager.FlushPartialBlocks();
+	info.allocator_infos.push_back(block_allocator_->GetInfo());
+	partitions.AppendTo(info);
+	info.options = options;
+	calibration_.Serialize(info.options);
+
+	return info;
+}
+
+IndexStorageInfo DiskannIndex::SerializeToWAL(const case_insensitive_map_t<Value> &options) {
+	AnnPartitionStorage partitions;
+	{
+		std::shared_lock<std::shared_mutex> partitions_guard(partitions_lock_);
+		for (idx_t p = 0; p < partitions_.Size(); p++) {
+			auto &child = *partitions_.Get(p);
+			lock_guard<mutex> guard(child.lock);
+			partitions.Add(partitions_.Key(p), child.SerializeToWAL(child_options_));
+		}
+	}
+	if (IsPartitioned()) {
+		WritePartitionRoot(partitions.directory);
+	}
+	// Nothing in block storage yet (a fresh in-memory index): log the rows, not the graph.
+	// Streaming builds that evicted vectors and storage = 'disk' have their image already.
+	if (!IsPartitioned() && !disk_storage_ && persisted_vectors_ == 0) {
+		wal_log_ = make_uniq<AnnWalLog>(table_io_manager.GetIndexBlockManager());
+		WriteValue(wal_log_->Writer(), DISKANN_STORAGE_VERSION_WAL);
+		WriteValue(wal_log_->Writer(), dimension_);
+		wal_log_->WriteRows(GetLiveRowIds(), static_cast<idx_t>(dimension_),
+		                    [&](const vector<row_t> &row_ids) { return GetVectors(row_ids); });
+		auto info = wal_log_->GetInfo(name, options);
+		calibration_.Serialize(info.options);
+		return info;
+	}
+
+	PersistToDisk();
 
 	IndexStorageInfo info;
 	info.name = name;
 	info.root = root_block_ptr_.Get();
 	info.buffers.push_back(block_allocator_->InitSerializationToWAL());
 	info.allocator_infos.push_back(block_allocator_->GetInfo());
+	partitions.AppendTo(info);
+	info.options = options;
+	calibration_.Serialize(info.options);
 
 	return info;
 }
@@ -549,19 +1800,41 @@ IndexStorageInfo DiskannIndex::SerializeToWAL(const case_insensitive_map_t<Value
 // Search
 // ========================================
 
+// storage = 'disk': the k nearest of the base and delta results
+static void KeepNearest(vector<pair<row_t, float>> &results, idx_t k) {
+	std::sort(results.begin(), results.end(),
+	          [](const pair<row_t, float> &a, const pair<row_t, float> &b) { return a.second < b.second; });
+	if (results.size() > k) {
+		results.resize(k);
+	}
+}
+
 vector<pair<row_t, float>> DiskannIndex::Search(const float *query, int32_t dimension, int32_t k,
                                                 int32_t search_complexity) {
-	if (!rust_handle_ || dimension != dimension_) {
+	if (IsPartitioned()) {
+		if (dimension != dimension_ || k <= 0) {
+			return {};
+		}
+		if (search_complexity <= 0) {
+			search_complexity = calibration_.For(k);
+		}
+		return SearchPartitions(
+		    k, [&](DiskannIndex &child) { return child.Search(query, dimension, k, search_complexity); });
+	}
+	if ((!rust_handle_ && !disk_handle_) || dimension != dimension_) {
 		return {};
 	}
 
-	int64_t request_k64 = static_cast<int64_t>(k) + static_cast<int64_t>(deleted_labels_.size());
-	int64_t total_count = static_cast<int64_t>(DiskannDetachedCount(rust_handle_));
-	request_k64 = MinValue<int64_t>(request_k64, total_count);
-	int32_t request_k = static_cast<int32_t>(MinValue<int64_t>(request_k64, static_cast<int64_t>(INT32_MAX)));
+	// Tombstoned labels are skipped inside the Rust search: no over-fetch for deletes
+	int64_t total_count = static_cast<int64_t>(GetVectorCount());
+	int32_t request_k = static_cast<int32_t>(MinValue<int64_t>(k, total_count));
 	if (request_k <= 0) {
 		return {};
 	}
+	if (search_complexity <= 0) {
+		search_complexity = calibration_.For(k);
+	}
+	auto start = AnnSearchStats::Clock::now();
 
 	// Thread-local scratch buffers — allocated once per thread, reused across queries
 	thread_local vector<int64_t> tl_labels;
@@ -569,8 +1842,21 @@ vector<pair<row_t, float>> DiskannIndex::Search(const float *query, int32_t dime
 	tl_labels.resize(request_k);
 	tl_distances.resize(request_k);
 
-	auto n = DiskannDetachedSearch(rust_handle_, query, dimension, request_k, search_complexity, tl_labels.data(),
-	                               tl_distances.data());
+	auto ffi_start = AnnSearchStats::Clock::now();
+	int32_t n = 0;
+	if (disk_handle_) {
+		n = DiskannDiskSearch(disk_handle_, query, dimension, request_k, search_complexity, nullptr, 0, false,
+		                      tl_labels.data(), tl_distances.data());
+	}
+	// The delta's hits follow the base's, labels shifted past it
+	auto base_n = n;
+	if (rust_handle_) {
+		tl_labels.resize(base_n + request_k);
+		tl_distances.resize(base_n + request_k);
+		n += DiskannDetachedSearch(rust_handle_, query, dimension, request_k, search_complexity,
+		                           tl_labels.data() + base_n, tl_distances.data() + base_n);
+	}
+	auto ffi_nanos = AnnSearchStats::NanosSince(ffi_start);
 
 	// Shrink thread-local buffers if a previous large request inflated them
 	if (tl_labels.capacity() > 4096 && request_k < 1024) {
@@ -581,27 +1867,151 @@ vector<pair<row_t, float>> DiskannIndex::Search(const float *query, int32_t dime
 	vector<pair<row_t, float>> results;
 	results.reserve(k);
 
-	for (int32_t i = 0; i < n && static_cast<int32_t>(results.size()) < k; i++) {
-		auto label = static_cast<uint32_t>(tl_labels[i]);
-		if (deleted_labels_.count(label) > 0) {
-			continue;
-		}
+	for (int32_t i = 0; i < n; i++) {
+		auto label = static_cast<idx_t>(tl_labels[i]) + (i < base_n ? 0 : base_count_);
 		if (label < label_to_rowid_.size()) {
 			results.emplace_back(label_to_rowid_[label], tl_distances[i]);
 		}
 	}
+	if (base_n > 0 && n > base_n) {
+		KeepNearest(results, static_cast<idx_t>(k));
+	}
+	search_stats_.RecordSearch(1, AnnSearchStats::NanosSince(start), ffi_nanos);
+	NoteSearch();
 
 	return results;
 }
 
+vector<pair<row_t, float>> DiskannIndex::SearchCoalesced(ClientContext &context, const float *query, int32_t dimension,
+                                                         int32_t k, int32_t search_complexity) {
+	if ((!rust_handle_ && !disk_handle_ && !IsPartitioned()) || dimension != dimension_) {
+		return {};
+	}
+	return query_batcher_.Search(
+	    context, query, dimension, k, search_complexity, [&]() { return Search(query, dimension, k, search_complexity); },
+	    [this](const vector<vector<float>> &queries, int32_t batch_k, int32_t batch_complexity) {
+		    return SearchBatch(queries, batch_k, batch_complexity);
+	    });
+}
+
+vector<pair<row_t, float>> DiskannIndex::SearchFiltered(const float *query, int32_t dimension, int32_t k,
+                                                        int32_t search_complexity,
+                                                        const vector<row_t> &allowed_rowids, bool exhaustive) {
+	if (IsPartitioned()) {
+		if (dimension != dimension_ || k <= 0 || allowed_rowids.empty()) {
+			return {};
+		}
+		if (search_complexity <= 0) {
+			search_complexity = calibration_.For(k);
+		}
+		return SearchPartitions(k, [&](DiskannIndex &child) {
+			return child.SearchFiltered(query, dimension, k, search_complexity, allowed_rowids, exhaustive);
+		});
+	}
+	if ((!rust_handle_ && !disk_handle_) || dimension != dimension_ || k <= 0) {
+		return {};
+	}
+	auto start = AnnSearchStats::Clock::now();
+
+	// Translate row ids to a label bitmap. Deleted rows are no longer in rowid_to_label_,
+	// so tombstones are excluded without over-fetching. With storage = 'disk' the base and
+	// the delta each get their own bitmap, over their own labels.
+	vector<uint64_t> base_words((base_count_ + 63) / 64, 0);
+	vector<uint64_t> filter_words((label_to_rowid_.size() - base_count_ + 63) / 64, 0);
+	idx_t num_base = 0;
+	idx_t num_allowed = 0;
+	for (auto row_id : allowed_rowids) {
+		auto it = rowid_to_label_.find(row_id);
+		if (it == rowid_to_label_.end()) {
+			continue;
+		}
+		if (it->second < base_count_) {
+			base_words[it->second >> 6] |= uint64_t(1) << (it->second & 63);
+			num_base++;
+			continue;
+		}
+		auto label = it->second - base_count_;
+		filter_words[label >> 6] |= uint64_t(1) << (label & 63);
+		num_allowed++;
+	}
+	if (num_allowed == 0 && num_base == 0) {
+		return {};
+	}
+
+	if (search_complexity <= 0) {
+		search_complexity = calibration_.For(k);
+	}
+	vector<pair<row_t, float>> results;
+	vector<int64_t> labels;
+	vector<float> distances;
+	auto collect = [&](int32_t n, idx_t label_offset) {
+		for (int32_t i = 0; i < n; i++) {
+			auto label = static_cast<idx_t>(labels[i]) + label_offset;
+			if (label < label_to_rowid_.size()) {
+				results.emplace_back(label_to_rowid_[label], distances[i]);
+			}
+		}
+	};
+	auto ffi_start = AnnSearchStats::Clock::now();
+	if (num_base > 0 && disk_handle_) {
+		auto request_k = static_cast<int32_t>(MinValue<idx_t>(static_cast<idx_t>(k), num_base));
+		labels.resize(request_k);
+		distances.resize(request_k);
+		collect(DiskannDiskSearch(disk_handle_, query, dimension, request_k, search_complexity, base_words.data(),
+		                          static_cast<int64_t>(base_words.size()), exhaustive, labels.data(), distances.data()),
+		        0);
+	}
+	if (num_allowed > 0 && rust_handle_) {
+		auto request_k = static_cast<int32_t>(MinValue<idx_t>(static_cast<idx_t>(k), num_allowed));
+		labels.resize(request_k);
+		distances.resize(request_k);
+		collect(DiskannDetachedSearchFiltered(rust_handle_, query, dimension, request_k, search_complexity,
+		                                      filter_words.data(), static_cast<int64_t>(filter_words.size()),
+		                                      exhaustive, labels.data(), distances.data()),
+		        base_count_);
+	}
+	auto ffi_nanos = AnnSearchStats::NanosSince(ffi_start);
+	if (num_base > 0 && num_allowed > 0) {
+		KeepNearest(results, static_cast<idx_t>(k));
+	}
+	search_stats_.RecordSearch(1, AnnSearchStats::NanosSince(start), ffi_nanos);
+	NoteSearch();
+	return results;
+}
+
 vector<vector<pair<row_t, float>>> DiskannIndex::SearchBatch(const vector<vector<float>> &queries, int32_t k,
                                                              int32_t search_complexity) {
 	auto nq = static_cast<int32_t>(queries.size());
 	vector<vector<pair<row_t, float>>> all_results(nq);
 
-	if (!rust_handle_ || nq == 0) {
+	if (IsPartitioned() && nq > 0 && k > 0) {
+		auto start = AnnSearchStats::Clock::now();
+		if (search_complexity <= 0) {
+			search_complexity = calibration_.For(k);
+		}
+		// Every child runs the whole batch; the batches are merged query by query
+		auto partitions = Partitions();
+		vector<vector<vector<pair<row_t, float>>>> partition_results(partitions.size());
+		auto tally = AnnSearchTally::Current();
+		AnnParallelFor(db.GetDatabase(), partitions.size(), [&](idx_t p) {
+			partition_results[p] = AnnSearchTally::RunChild(
+			    tally, [&]() { return partitions[p]->SearchBatch(queries, k, search_complexity); });
+		});
+		vector<vector<pair<row_t, float>>> lists(partitions.size());
+		for (int32_t qi = 0; qi < nq; qi++) {
+			for (idx_t p = 0; p < partitions.size(); p++) {
+				lists[p] = std::move(partition_results[p][qi]);
+			}
+			all_results[qi] = AnnMergeTopK(lists, static_cast<idx_t>(k));
+		}
+		search_stats_.RecordSearch(static_cast<idx_t>(nq), AnnSearchStats::NanosSince(start), 0);
+		NoteSearch();
 		return all_results;
 	}
+	if ((!rust_handle_ && !disk_handle_) || nq == 0) {
+		return all_results;
+	}
+	auto start = AnnSearchStats::Clock::now();
 
 	// Flatten queries into contiguous buffer
 	vector<float> flat_queries;
@@ -616,128 +2026,474 @@ vector<vector<pair<row_t, float>>> DiskannIndex::SearchBatch(const vector<vector
 	vector<float> flat_distances(total, std::numeric_limits<float>::max());
 	vector<int32_t> counts(nq, 0);
 
-	// Single batch FFI call — GPU-accelerated lock-step BFS
-	DiskannDetachedSearchBatch(rust_handle_, flat_queries.data(), nq, dimension_, k, search_complexity,
-	                           flat_labels.data(), flat_distances.data(), counts.data());
+	if (search_complexity <= 0) {
+		search_complexity = calibration_.For(k);
+	}
 
 	// Reconstruct per-query results with row_id mapping
-	for (int32_t qi = 0; qi < nq; qi++) {
-		auto n = counts[qi];
-		auto base = static_cast<size_t>(qi) * k;
-		all_results[qi].reserve(n);
-		for (int32_t i = 0; i < n; i++) {
-			auto label = static_cast<uint32_t>(flat_labels[base + i]);
-			if (label < label_to_rowid_.size()) {
-				all_results[qi].emplace_back(label_to_rowid_[label], flat_distances[base + i]);
+	auto collect = [&](idx_t label_offset) {
+		for (int32_t qi = 0; qi < nq; qi++) {
+			auto n = counts[qi];
+			auto base = static_cast<size_t>(qi) * k;
+			all_results[qi].reserve(all_results[qi].size() + n);
+			for (int32_t i = 0; i < n; i++) {
+				auto label = static_cast<idx_t>(flat_labels[base + i]) + label_offset;
+				if (label < label_to_rowid_.size()) {
+					all_results[qi].emplace_back(label_to_rowid_[label], flat_distances[base + i]);
+				}
 			}
 		}
+	};
+
+	// Single batch FFI call — GPU-accelerated lock-step BFS
+	auto ffi_start = AnnSearchStats::Clock::now();
+	if (disk_handle_) {
+		DiskannDiskSearchBatch(disk_handle_, flat_queries.data(), nq, dimension_, k, search_complexity,
+		                       flat_labels.data(), flat_distances.data(), counts.data());
+		collect(0);
 	}
+	if (rust_handle_) {
+		DiskannDetachedSearchBatch(rust_handle_, flat_queries.data(), nq, dimension_, k, search_complexity,
+		                           flat_labels.data(), flat_distances.data(), counts.data());
+		collect(base_count_);
+	}
+	auto ffi_nanos = AnnSearchStats::NanosSince(ffi_start);
+	if (disk_handle_ && rust_handle_) {
+		for (auto &results : all_results) {
+			KeepNearest(results, static_cast<idx_t>(k));
+		}
+	}
+	search_stats_.RecordSearch(static_cast<idx_t>(nq), AnnSearchStats::NanosSince(start), ffi_nanos);
+	NoteSearch();
 
 	return all_results;
 }
 
+vector<pair<row_t, float>> DiskannIndex::SearchPartitions(
+    int32_t k, const std::function<vector<pair<row_t, float>>(DiskannIndex &)> &search) {
+	auto start = AnnSearchStats::Clock::now();
+	auto partitions = Partitions();
+	vector<vector<pair<row_t, float>>> results(partitions.size());
+	auto tally = AnnSearchTally::Current();
+	AnnParallelFor(db.GetDatabase(), partitions.size(), [&](idx_t p) {
+		results[p] = AnnSearchTally::RunChild(tally, [&]() { return search(*partitions[p]); });
+	});
+	auto merged = AnnMergeTopK(results, static_cast<idx_t>(k));
+	search_stats_.RecordSearch(1, AnnSearchStats::NanosSince(start), 0);
+	NoteSearch();
+	return merged;
+}
+
+vector<pair<row_t, float>> DiskannIndex::SearchPartition(ClientContext &context, const Value &key, const float *query,
+                                                         int32_t dimension, int32_t k, int32_t search_complexity,
+                                                         const vector<row_t> *allowed_rowids, bool exhaustive) {
+	auto child = FindPartition(key);
+	if (!child || dimension != dimension_ || k <= 0) {
+		return {};
+	}
+	auto &index = *child;
+	if (search_complexity <= 0) {
+		search_complexity = calibration_.For(k);
+	}
+	// Counted as a search of the parent: the child's counters only contribute their traversal
+	auto search = [&]() {
+		auto start = AnnSearchStats::Clock::now();
+		auto results = AnnSearchTally::RunChild(AnnSearchTally::Current(), [&]() {
+			return allowed_rowids
+			           ? index.SearchFiltered(query, dimension, k, search_complexity, *allowed_rowids, exhaustive)
+			           : index.SearchCoalesced(context, query, dimension, k, search_complexity);
+		});
+		search_stats_.RecordSearch(1, AnnSearchStats::NanosSince(start), 0);
+		NoteSearch();
+		return results;
+	};
+	if (allowed_rowids) {
+		return search();
+	}
+	return index.GetResultCache().Get(context, query, dimension, k, search_complexity, 0, search);
+}
+
+AnnSearchCounters DiskannIndex::GetSearchCounters() const {
+	// Query count, latency and FFI time are measured here; the traversal is counted in Rust
+	auto counters = search_stats_.Snapshot();
+	for (auto *partition : Partitions()) {
+		// Latency is the parent's, over the whole fan-out; the work is the children's
+		counters.AddWork(partition->GetSearchCounters());
+	}
+	if (rust_handle_) {
+		auto traversal = DiskannDetachedSearchStats(rust_handle_);
+		counters.distance_computations = traversal.distance_computations;
+		counters.hops = traversal.hops;
+		counters.visited = traversal.visited;
+		counters.deleted_filtered = traversal.deleted_filtered;
+		counters.gpu_dispatches = traversal.gpu_dispatches;
+		counters.cpu_dispatches = traversal.cpu_dispatches;
+	}
+	return counters;
+}
+
+pair<idx_t, idx_t> DiskannIndex::GetBatchCounts() const {
+	auto counts = make_pair(query_batcher_.Batches(), query_batcher_.BatchedQueries());
+	for (auto *partition : Partitions()) {
+		auto child = partition->GetBatchCounts();
+		counts.first += child.first;
+		counts.second += child.second;
+	}
+	return counts;
+}
+
+pair<idx_t, idx_t> DiskannIndex::GetMergeCounts() const {
+	auto counts = make_pair(stitched_merges_.load(), reinserted_merges_.load());
+	for (auto *partition : Partitions()) {
+		auto child = partition->GetMergeCounts();
+		counts.first += child.first;
+		counts.second += child.second;
+	}
+	return counts;
+}
+
 // ========================================
 // Utility methods
 // ========================================
 
+idx_t DiskannIndex::GetVectorCount() const {
+	auto count = base_count_ + (rust_handle_ ? static_cast<idx_t>(DiskannDetachedCount(rust_handle_)) : 0);
+	for (auto *partition : Partitions()) {
+		count += partition->GetVectorCount();
+	}
+	return count;
+}
+
+idx_t DiskannIndex::GetDeletedCount() const {
+	auto deleted = rust_handle_ ? static_cast<idx_t>(DiskannDetachedDeletedCount(rust_handle_)) : 0;
+	deleted += disk_handle_ ? static_cast<idx_t>(DiskannDiskDeletedCount(disk_handle_)) : 0;
+	for (auto *partition : Partitions()) {
+		deleted += partition->GetDeletedCount();
+	}
+	return deleted;
+}
+
+bool DiskannIndex::IsQuantized() const {
+	for (auto *partition : Partitions()) {
+		if (partition->IsQuantized()) {
+			return true;
+		}
+	}
+	return rust_handle_ ? DiskannDetachedIsQuantized(rust_handle_) || DiskannDetachedIsPQ(rust_handle_) : false;
+}
+
+bool DiskannIndex::SearchesCodes() const {
+	for (auto *partition : Partitions()) {
+		if (partition->SearchesCodes()) {
+			return true;
+		}
+	}
+	return IsQuantized() || (rust_handle_ && DiskannDetachedHalfFormat(rust_handle_) != 0);
+}
+
+vector<row_t> DiskannIndex::GetLiveRowIds() const {
+	vector<row_t> row_ids;
+	row_ids.reserve(rowid_to_label_.size());
+	for (auto &entry : rowid_to_label_) {
+		row_ids.push_back(entry.first);
+	}
+	for (auto *partition : Partitions()) {
+		auto child = partition->GetLiveRowIds();
+		row_ids.insert(row_ids.end(), child.begin(), child.end());
+	}
+	std::sort(row_ids.begin(), row_ids.end());
+	return row_ids;
+}
+
+vector<float> DiskannIndex::GetVectors(const vector<row_t> &row_ids) const {
+	vector<float> vectors(row_ids.size() * dimension_);
+	if (IsPartitioned()) {
+		// Ask each child for the rows it holds, then put them back in the caller's order
+		for (auto *partition : Partitions()) {
+			auto &child = *partition;
+			vector<idx_t> positions;
+			vector<row_t> held;
+			for (idx_t i = 0; i < row_ids.size(); i++) {
+				if (child.rowid_to_label_.count(row_ids[i])) {
+					positions.push_back(i);
+					held.push_back(row_ids[i]);
+				}
+			}
+			auto child_vectors = child.GetVectors(held);
+			for (idx_t j = 0; j < positions.size(); j++) {
+				std::copy_n(child_vectors.data() + j * dimension_, dimension_,
+				            vectors.data() + positions[j] * dimension_);
+			}
+		}
+		return vectors;
+	}
+	for (idx_t i = 0; i < row_ids.size(); i++) {
+		auto it = rowid_to_label_.find(row_ids[i]);
+		if (it != rowid_to_label_.end()) {
+			ReadVector(it->second, vectors.data() + i * dimension_);
+		}
+	}
+	return vectors;
+}
+
+bool DiskannIndex::ReadVector(uint32_t label, float *out) const {
+	if (label < base_count_) {
+		return disk_handle_ && DiskannDiskGetVector(disk_handle_, label, out, dimension_) > 0;
+	}
+	return rust_handle_ &&
+	       DiskannDetachedGetVector(rust_handle_, static_cast<uint32_t>(label - base_count_), out, dimension_) > 0;
+}
+
+vector<uint64_t> DiskannIndex::GetTombstones() const {
+	auto words = disk_handle_ ? DiskannDiskGetTombstones(disk_handle_) : vector<uint64_t>();
+	if (!rust_handle_) {
+		return words;
+	}
+	if (base_count_ == 0) {
+		return DiskannDetachedGetTombstones(rust_handle_);
+	}
+	auto delta = DiskannDetachedGetTombstones(rust_handle_);
+	for (idx_t w = 0; w < delta.size(); w++) {
+		for (auto bits = delta[w]; bits != 0; bits &= bits - 1) {
+			auto label = base_count_ + w * 64 + static_cast<idx_t>(__builtin_ctzll(bits));
+			if ((label >> 6) >= words.size()) {
+				words.resize((label >> 6) + 1, 0);
+			}
+			words[label >> 6] |= uint64_t(1) << (label & 63);
+		}
+	}
+	return words;
+}
+
 idx_t DiskannIndex::GetInMemorySize(IndexLock &state) {
-	idx_t size = sizeof(DiskannIndex);
-	size += label_to_rowid_.size() * sizeof(row_t);
+	auto size = sizeof(DiskannIndex) + HeapBytes();
+	for (auto *partition : Partitions()) {
+		size += sizeof(DiskannIndex) + partition->HeapBytes();
+	}
+	return size;
+}
+
+idx_t DiskannIndex::HeapBytes() const {
+	idx_t size = label_to_rowid_.size() * sizeof(row_t);
 	size += rowid_to_label_.size() * (sizeof(row_t) + sizeof(uint32_t));
 	if (rust_handle_) {
-		auto count = DiskannDetachedCount(rust_handle_);
-		size += count * dimension_ * sizeof(float);
-		size += count * max_degree_ * sizeof(uint32_t);
+		// Only what is resident: pages still on disk and evicted vectors hold no memory
+		size += static_cast<idx_t>(DiskannDetachedMemoryBytes(rust_handle_));
+	}
+	if (disk_handle_) {
+		// The node cache and tombstones; the mapped file is the OS page cache's
+		size += static_cast<idx_t>(DiskannDiskMemoryBytes(disk_handle_));
 	}
 	return size;
 }
 
+void DiskannIndex::UpdateReservation(idx_t pending) {
+	reservation_->Update(HeapBytes() + pending);
+}
+
+void DiskannIndex::NoteSearch() {
+	// The traversal the Rust calls just counted belongs to this thread's operator
+	auto traversal = DiskannTakeSearchTally();
+	if (auto tally = AnnSearchTally::Current()) {
+		AnnSearchCounters work;
+		work.distance_computations = traversal.distance_computations;
+		work.hops = traversal.hops;
+		work.visited = traversal.visited;
+		work.deleted_filtered = traversal.deleted_filtered;
+		work.gpu_dispatches = traversal.gpu_dispatches;
+		work.cpu_dispatches = traversal.cpu_dispatches;
+		tally->AddWork(work);
+	}
+	reservation_->Touch();
+	// Faulted-in adjacency pages stay resident: account them once the search is done
+	auto loads = rust_handle_ ? DiskannDetachedPageLoads(rust_handle_) : 0;
+	if (loads != page_loads_seen_.exchange(loads)) {
+		UpdateReservation();
+	}
+}
+
+idx_t DiskannIndex::ReleaseMemory() {
+	// Asked by another index's reservation: give up rather than wait for this index's writers
+	unique_lock<mutex> guard(lock, std::try_to_lock);
+	if (!guard.owns_lock() || disk_storage_ || !rust_handle_ || !is_dirty_ || !SearchesCodes()) {
+		return 0;
+	}
+	// Writing the dirty pages evicts the coded index's vectors; re-ranking reads them back lazily
+	auto before = HeapBytes();
+	PersistToDisk();
+	auto after = HeapBytes();
+	return before > after ? before - after : 0;
+}
+
+idx_t DiskannIndex::GetEvictions() const {
+	auto evictions = reservation_->Evictions();
+	for (auto *partition : Partitions()) {
+		evictions += partition->GetEvictions();
+	}
+	return evictions;
+}
+
+idx_t DiskannIndex::GetPageLoads() const {
+	auto loads = rust_handle_ ? static_cast<idx_t>(DiskannDetachedPageLoads(rust_handle_)) : 0;
+	for (auto *partition : Partitions()) {
+		loads += partition->GetPageLoads();
+	}
+	return loads;
+}
+
 bool DiskannIndex::MergeIndexes(IndexLock &state, BoundIndex &other_index) {
 	auto &other = other_index.Cast<DiskannIndex>();
-	if (!other.rust_handle_ || !rust_handle_) {
+	if (IsPartitioned()) {
+		// Merged partition by partition: values new to this index get the other's child stitched in
+		std::shared_lock<std::shared_mutex> other_guard(other.partitions_lock_);
+		for (idx_t p = 0; p < other.partitions_.Size(); p++) {
+			auto &child = GetOrCreatePartition(other.partitions_.Key(p));
+			IndexLock child_lock;
+			child.InitializeLock(child_lock);
+			child.MergeIndexes(child_lock, *other.partitions_.Get(p));
+		}
+		result_cache_.Invalidate();
+		return true;
+	}
+	auto other_count = static_cast<int64_t>(other.GetVectorCount());
+	if (other_count == 0) {
+		return true;
+	}
+	if (!rust_handle_) {
+		rust_handle_ = DiskannCreateDetached(dimension_, metric_, max_degree_, build_complexity_, alpha_);
+	}
+
+	auto other_tombstones = other.GetTombstones();
+
+	if (!disk_storage_ && other.rust_handle_ && !other.disk_handle_ && other.base_count_ == 0) {
+		// Both graphs are in memory: keep every edge the other build already paid for and
+		// stitch the two graphs together instead of re-inserting vector by vector
+		auto offset = DiskannDetachedMerge(rust_handle_, other.rust_handle_, RunTasks,
+		                                   &TaskScheduler::GetScheduler(db.GetDatabase()));
+		stitched_merges_++;
+		result_cache_.Invalidate();
+		for (idx_t l = 0; l < other.label_to_rowid_.size(); l++) {
+			auto row_id = other.label_to_rowid_[l];
+			if (row_id < 0 || IsTombstoned(other_tombstones, static_cast<uint32_t>(l))) {
+				continue;
+			}
+			auto new_l = static_cast<uint32_t>(base_count_ + offset + l);
+			if (new_l >= label_to_rowid_.size()) {
+				label_to_rowid_.resize(new_l + 1, -1);
+			}
+			label_to_rowid_[new_l] = row_id;
+			rowid_to_label_[row_id] = new_l;
+		}
+		ApplyQuantization();
 		is_dirty_ = true;
+		UpdateReservation();
 		return true;
 	}
 
-	auto other_count = DiskannDetachedCount(other.rust_handle_);
+	// Gather the live vectors of the other index, then insert them with one batched call
+	reinserted_merges_++;
+	vector<float> matrix;
+	vector<row_t> row_ids;
+	matrix.reserve(static_cast<idx_t>(other_count) * dimension_);
+	row_ids.reserve(static_cast<idx_t>(other_count));
 	vector<float> vec_buf(dimension_);
 
 	for (int64_t label = 0; label < other_count; label++) {
 		auto l = static_cast<uint32_t>(label);
 
 		// Skip deleted labels in other index
-		if (other.deleted_labels_.count(l) > 0) {
+		if (IsTombstoned(other_tombstones, l) || l >= other.label_to_rowid_.size()) {
 			continue;
 		}
 
 		// Get the vector from other index
-		auto dim = DiskannDetachedGetVector(other.rust_handle_, l, vec_buf.data(), dimension_);
-		if (dim <= 0) {
-			continue;
-		}
-
-		// Get the row_id from other's mapping
-		if (l >= other.label_to_rowid_.size()) {
+		if (!other.ReadVector(l, vec_buf.data())) {
 			continue;
 		}
-		auto row_id = other.label_to_rowid_[l];
+		matrix.insert(matrix.end(), vec_buf.begin(), vec_buf.end());
+		row_ids.push_back(other.label_to_rowid_[l]);
+	}
 
-		// Add to this index
-		auto new_label = DiskannDetachedAdd(rust_handle_, vec_buf.data(), dimension_);
-		auto new_l = static_cast<uint32_t>(new_label);
+	if (!row_ids.empty()) {
+		vector<int64_t> labels(row_ids.size());
+		AddBatch(matrix.data(), row_ids.size(), labels.data());
+		result_cache_.Invalidate();
 
 		// Update mappings
-		if (new_l >= label_to_rowid_.size()) {
-			label_to_rowid_.resize(new_l + 1, -1);
+		for (idx_t i = 0; i < row_ids.size(); i++) {
+			auto new_l = static_cast<uint32_t>(base_count_ + labels[i]);
+			if (new_l >= label_to_rowid_.size()) {
+				label_to_rowid_.resize(new_l + 1, -1);
+			}
+			label_to_rowid_[new_l] = row_ids[i];
+			rowid_to_label_[row_ids[i]] = new_l;
 		}
-		label_to_rowid_[new_l] = row_id;
-		rowid_to_label_[row_id] = new_l;
 	}
 
+	ApplyQuantization();
 	is_dirty_ = true;
+	UpdateReservation();
 	return true;
 }
 
 void DiskannIndex::Vacuum(IndexLock &state) {
-	if (deleted_labels_.empty() || !rust_handle_) {
+	for (auto *partition : Partitions()) {
+		auto &child = *partition;
+		IndexLock child_lock;
+		child.InitializeLock(child_lock);
+		child.Vacuum(child_lock);
+	}
+	// storage = 'disk' keeps delta labels dense (they become file ids at the merge): nothing to
+	// recycle. The next checkpoint compacts the file instead of appending to it.
+	if (disk_storage_ && disk_handle_) {
+		compact_disk_file_ = true;
+		is_dirty_ = true;
+	}
+	if (disk_storage_ || !rust_handle_ || DiskannDetachedDeletedCount(rust_handle_) == 0) {
 		return;
 	}
+	// Repair the graph around every tombstone in place and recycle their labels:
+	// no rebuild, labels keep their meaning so no segment is invalidated
+	RunConsolidation(0);
+}
 
-	// Convert deleted_labels_ set to a vector for FFI
-	vector<uint32_t> deleted_vec(deleted_labels_.begin(), deleted_labels_.end());
-
-	// Compact in Rust: rebuild index without deleted labels
-	auto result = DiskannDetachedCompact(rust_handle_, deleted_vec.data(), deleted_vec.size());
-
-	// Swap handles
-	DiskannFreeDetached(rust_handle_);
-	rust_handle_ = result.new_handle;
-
-	// Rebuild row_id mappings using the label map
-	// old label_to_rowid_ has the row_id for each old label
-	// We need: new_label -> old row_id
-	vector<row_t> old_label_to_rowid = std::move(label_to_rowid_);
-
-	auto new_count = DiskannDetachedCount(rust_handle_);
-	label_to_rowid_.clear();
-	label_to_rowid_.resize(new_count, -1);
-	rowid_to_label_.clear();
-
-	for (size_t i = 0; i < result.map_len; i++) {
-		auto old_label = result.label_map[i * 2];
-		auto new_label = result.label_map[i * 2 + 1];
-		if (old_label < old_label_to_rowid.size()) {
-			auto row_id = old_label_to_rowid[old_label];
-			if (new_label < static_cast<uint32_t>(label_to_rowid_.size())) {
-				label_to_rowid_[new_label] = row_id;
-				rowid_to_label_[row_id] = new_label;
+DiskannConsolidateProgress DiskannIndex::Consolidate(idx_t max_nodes) {
+	IndexLock state;
+	InitializeLock(state);
+	if (IsPartitioned()) {
+		// max_nodes is spent across the children in partition order
+		DiskannConsolidateProgress total {0, 0, 0, true};
+		for (auto *partition : Partitions()) {
+			if (max_nodes != 0 && total.visited >= max_nodes) {
+				total.done = false;
+				break;
 			}
+			auto progress = partition->Consolidate(max_nodes == 0 ? 0 : max_nodes - total.visited);
+			total.visited += progress.visited;
+			total.freed += progress.freed;
+			total.remaining += progress.remaining;
+			total.done = total.done && progress.done;
+		}
+		if (total.visited > 0 || total.freed > 0) {
+			result_cache_.Invalidate();
 		}
+		return total;
 	}
+	if (disk_storage_ || !rust_handle_) {
+		return DiskannConsolidateProgress {0, 0, 0, true};
+	}
+	return RunConsolidation(max_nodes);
+}
 
-	DiskannFreeLabelMap(result.label_map, result.map_len);
-	deleted_labels_.clear();
-	is_dirty_ = true;
+DiskannConsolidateProgress DiskannIndex::RunConsolidation(idx_t max_nodes) {
+	auto progress = DiskannDetachedConsolidate(rust_handle_, max_nodes, RunTasks,
+	                                           &TaskScheduler::GetScheduler(db.GetDatabase()));
+	if (progress.visited > 0 || progress.freed > 0) {
+		// Repaired neighbour lists change what a search visits
+		result_cache_.Invalidate();
+		is_dirty_ = true;
+	}
+	return progress;
 }
 
 #ifdef DUCKDB_API_V15
@@ -745,12 +2501,20 @@ void DiskannIndex::Verify(IndexLock &state) {
 }
 
 string DiskannIndex::ToString(IndexLock &state, bool display_ascii) {
-	auto count = rust_handle_ ? DiskannDetachedCount(rust_handle_) : 0;
+	auto count = static_cast<int64_t>(GetVectorCount());
+	if (IsPartitioned()) {
+		return StringUtil::Format("DiskANN Index %s (dim=%d, vectors=%lld, metric=%s, partitions=%llu)", name,
+		                          dimension_, count, metric_, GetPartitionCount());
+	}
 	return StringUtil::Format("DiskANN Index %s (dim=%d, vectors=%lld, metric=%s)", name, dimension_, count, metric_);
 }
 #else
 string DiskannIndex::VerifyAndToString(IndexLock &state, const bool only_verify) {
-	auto count = rust_handle_ ? DiskannDetachedCount(rust_handle_) : 0;
+	auto count = static_cast<int64_t>(GetVectorCount());
+	if (IsPartitioned()) {
+		return StringUtil::Format("DiskANN Index %s (dim=%d, vectors=%lld, metric=%s, partitions=%llu)", name,
+		                          dimension_, count, metric_, GetPartitionCount());
+	}
 	return StringUtil::Format("DiskANN Index %s (dim=%d, vectors=%lld, metric=%s)", name, dimension_, count, metric_);
 }
 #endif
@@ -23,6 +23,10 @@ static unique_ptr<FunctionData> FaissGpuInfoBind(ClientContext &context, TableFu
 	return_types.push_back(LogicalType::BOOLEAN);
 	names.push_back("device");
 	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("backend");
+	return_types.push_back(LogicalType::VARCHAR);
+	names.push_back("device_count");
+	return_types.push_back(LogicalType::INTEGER);
 	return make_uniq<TableFunctionData>();
 }
 
@@ -43,6 +47,8 @@ static void FaissGpuInfoScan(ClientContext &context, TableFunctionInput &data, D
 	output.SetCardinality(1);
 	output.data[0].SetValue(0, Value::BOOLEAN(gpu.IsAvailable()));
 	output.data[1].SetValue(0, Value(gpu.DeviceInfo()));
+	output.data[2].SetValue(0, Value(gpu.BackendName()));
+	output.data[3].SetValue(0, Value::INTEGER(gpu.DeviceCount()));
 }
 
 // ========================================
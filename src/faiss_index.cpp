@@ -1,6 +1,8 @@
 #ifdef FAISS_AVAILABLE
 
 #include "faiss_index.hpp"
+#include "ann_memory.hpp"
+#include "ann_wal_log.hpp"
 #include "gpu_backend.hpp"
 #include "linked_block_storage.hpp"
 
@@ -9,16 +11,21 @@
 #include "duckdb/catalog/catalog_entry/table_catalog_entry.hpp"
 #include "duckdb/common/exception/transaction_exception.hpp"
 #include "duckdb/common/printer.hpp"
+#include "duckdb/common/random_engine.hpp"
+#include "duckdb/common/types/column/column_data_collection.hpp"
 #include "duckdb/common/types/vector.hpp"
 #include "duckdb/execution/operator/projection/physical_projection.hpp"
 #include "duckdb/function/table_function.hpp"
 #include "duckdb/planner/expression/bound_reference_expression.hpp"
 #include "duckdb/planner/operator/logical_create_index.hpp"
+#include "duckdb/storage/buffer_manager.hpp"
 #include "duckdb/storage/partial_block_manager.hpp"
 #include "duckdb/storage/table_io_manager.hpp"
 
 #include "faiss_wrapper.hpp"
 
+#include <algorithm>
+
 namespace duckdb {
 
 // ========================================
@@ -36,21 +43,90 @@ static faiss::MetricType ParseFaissMetric(const string &metric) {
 // Helper: create a FAISS index from parameters
 // ========================================
 
-static std::unique_ptr<faiss::Index> MakeFaissIndex(int32_t dimension, const string &metric, const string &index_type,
-                                                    const string &description, int32_t hnsw_m, int32_t ivf_nlist) {
-	auto faiss_metric = ParseFaissMetric(metric);
+static faiss::ScalarQuantizer::QuantizerType ParseSqType(const string &sq_type) {
+	auto lower = StringUtil::Lower(sq_type);
+	if (lower == "sq8") {
+		return faiss::ScalarQuantizer::QT_8bit;
+	}
+	if (lower == "sq6") {
+		return faiss::ScalarQuantizer::QT_6bit;
+	}
+	if (lower == "sq4") {
+		return faiss::ScalarQuantizer::QT_4bit;
+	}
+	if (lower == "fp16" || lower == "f16") {
+		return faiss::ScalarQuantizer::QT_fp16;
+	}
+	if (lower == "bf16") {
+		return faiss::ScalarQuantizer::QT_bf16;
+	}
+	if (lower == "sq8_uniform") {
+		return faiss::ScalarQuantizer::QT_8bit_uniform;
+	}
+	throw InvalidInputException(
+	    "Invalid sq_type '%s': expected 'sq8', 'sq6', 'sq4', 'fp16', 'bf16' or 'sq8_uniform'", sq_type);
+}
+
+static std::unique_ptr<faiss::Index> MakeFaissIndex(int32_t dimension, const FaissParams &params) {
+	auto faiss_metric = ParseFaissMetric(params.metric);
+	auto &index_type = params.index_type;
+
+	if (!params.description.empty()) {
+		if (params.precision != "f32") {
+			throw InvalidInputException("FAISS precision cannot be combined with description: use an SQfp16 / "
+			                            "SQbf16 component in the factory string");
+		}
+		return std::unique_ptr<faiss::Index>(faiss::index_factory(dimension, params.description.c_str(), faiss_metric));
+	}
 
-	if (!description.empty()) {
-		return std::unique_ptr<faiss::Index>(faiss::index_factory(dimension, description.c_str(), faiss_metric));
+	// Half precision: the same index over a 16-bit scalar quantizer (no training, 2 bytes per dimension)
+	if (params.precision != "f32") {
+		auto qtype = ParseSqType(params.precision);
+		if (index_type == "HNSW" || index_type == "hnsw") {
+			return make_faiss_unique<faiss::IndexHNSWSQ>(dimension, qtype, params.hnsw_m, faiss_metric);
+		}
+		if (index_type == "IVFFlat" || index_type == "ivfflat") {
+			auto quantizer = new faiss::IndexFlat(dimension, faiss_metric);
+			auto idx = make_faiss_unique<faiss::IndexIVFScalarQuantizer>(quantizer, dimension, params.ivf_nlist,
+			                                                             qtype, faiss_metric);
+			idx->own_fields = true;
+			return idx;
+		}
+		if (index_type != "Flat" && index_type != "flat") {
+			throw InvalidInputException("FAISS precision = '%s' is supported for Flat, HNSW and IVFFlat, not %s "
+			                            "(use sq_type for HNSWSQ)",
+			                            params.precision, index_type);
+		}
+		return make_faiss_unique<faiss::IndexScalarQuantizer>(dimension, qtype, faiss_metric);
 	}
 
 	if (index_type == "HNSW" || index_type == "hnsw") {
-		return make_faiss_unique<faiss::IndexHNSWFlat>(dimension, hnsw_m, faiss_metric);
+		return make_faiss_unique<faiss::IndexHNSWFlat>(dimension, params.hnsw_m, faiss_metric);
+	}
+
+	if (index_type == "HNSWSQ" || index_type == "hnswsq") {
+		return make_faiss_unique<faiss::IndexHNSWSQ>(dimension, ParseSqType(params.sq_type), params.hnsw_m,
+		                                             faiss_metric);
 	}
 
 	if (index_type == "IVFFlat" || index_type == "ivfflat") {
 		auto quantizer = new faiss::IndexFlat(dimension, faiss_metric);
-		auto idx = make_faiss_unique<faiss::IndexIVFFlat>(quantizer, dimension, ivf_nlist, faiss_metric);
+		auto idx = make_faiss_unique<faiss::IndexIVFFlat>(quantizer, dimension, params.ivf_nlist, faiss_metric);
+		idx->own_fields = true;
+		return idx;
+	}
+
+	if (index_type == "IVFPQ" || index_type == "ivfpq") {
+		if (params.pq_m <= 0 || dimension % params.pq_m != 0) {
+			throw InvalidInputException("FAISS IVFPQ: pq_m (%d) must divide the vector dimension (%d)", params.pq_m,
+			                            dimension);
+		}
+		if (params.pq_nbits < 1 || params.pq_nbits > 16) {
+			throw InvalidInputException("FAISS IVFPQ: pq_nbits must be between 1 and 16, got %d", params.pq_nbits);
+		}
+		auto quantizer = new faiss::IndexFlat(dimension, faiss_metric);
+		auto idx = make_faiss_unique<faiss::IndexIVFPQ>(quantizer, dimension, params.ivf_nlist, params.pq_m,
+		                                                params.pq_nbits, faiss_metric);
 		idx->own_fields = true;
 		return idx;
 	}
@@ -80,8 +156,18 @@ FaissIndex::FaissIndex(const string &name, IndexConstraintType constraint_type,
 	ivf_nlist_ = params.ivf_nlist;
 	nprobe_ = params.nprobe;
 	train_sample_ = params.train_sample;
+	pq_m_ = params.pq_m;
+	pq_nbits_ = params.pq_nbits;
+	sq_type_ = params.sq_type;
+	precision_ = params.precision;
 	description_ = params.description;
 	mode_ = params.mode;
+	partition_by_ = params.partition_by;
+	if (IsPartitioned() && unbound_expressions.size() == 2) {
+		partition_type_ = unbound_expressions[1]->return_type;
+		child_options_ = options;
+		child_options_.erase("partition_by");
+	}
 
 	// Detect dimension
 	if (!unbound_expressions.empty()) {
@@ -94,14 +180,19 @@ FaissIndex::FaissIndex(const string &name, IndexConstraintType constraint_type,
 	// Initialize block allocator
 	auto &block_manager = table_io_manager.GetIndexBlockManager();
 	block_allocator_ = make_uniq<FixedSizeAllocator>(LinkedBlock::BLOCK_SIZE, block_manager);
+	// FAISS indexes have no lazily loaded form: accounted, never released for another index
+	reservation_ = make_uniq<AnnMemoryReservation>(db.GetDatabase(), []() -> idx_t { return 0; });
 
 	// If loading from storage, deserialize
 	if (info.IsValid()) {
 		LoadFromStorage(info);
+		calibration_.Deserialize(info.options);
+		UpdateReservation();
 	}
 }
 
 FaissIndex::~FaissIndex() {
+	reservation_->Close();
 	gpu_index_.reset();
 }
 
@@ -122,6 +213,7 @@ void FaissIndex::EnsureGpuIndex() {
 		} catch (std::runtime_error &e) {
 			throw InvalidInputException("mode='gpu' requested but index type unsupported on GPU: %s", e.what());
 		}
+		RemoveFromGpuIndex(DeletedLabels());
 		return;
 	}
 
@@ -129,27 +221,85 @@ void FaissIndex::EnsureGpuIndex() {
 	if (!backend.IsAvailable()) {
 		return;
 	}
-	// HNSW unsupported on Metal
-	if (index_type_ == "HNSW" || index_type_ == "hnsw") {
+	// HNSW / HNSWSQ have no GPU implementation (Metal or CUDA)
+	if (StringUtil::StartsWith(StringUtil::Lower(index_type_), "hnsw")) {
 		return;
 	}
-	// Too few vectors — GPU overhead not worthwhile
-	if (faiss_index_->ntotal < 256) {
-		return;
-	}
-	// Low dimensions — GPU pays off at dim >= 128
-	if (dimension_ < 128) {
+	// Too little work per search — transfer and launch overhead dominate
+	if (!backend.WorthOffloading(faiss_index_->ntotal, dimension_)) {
 		return;
 	}
 	try {
 		gpu_index_ = backend.CpuToGpu(faiss_index_.get());
 	} catch (std::runtime_error &) {
 		// Silently fall back to CPU in auto mode
+		return;
 	}
+	RemoveFromGpuIndex(DeletedLabels());
+}
+
+FaissParams FaissIndex::CurrentParams() const {
+	FaissParams params;
+	params.metric = metric_;
+	params.index_type = index_type_;
+	params.hnsw_m = hnsw_m_;
+	params.ivf_nlist = ivf_nlist_;
+	params.nprobe = nprobe_;
+	params.train_sample = train_sample_;
+	params.pq_m = pq_m_;
+	params.pq_nbits = pq_nbits_;
+	params.sq_type = sq_type_;
+	params.precision = precision_;
+	params.description = description_;
+	params.mode = mode_;
+	return params;
 }
 
 void FaissIndex::InvalidateGpuIndex() {
 	gpu_index_.reset();
+	gpu_removed_ = 0;
+}
+
+void FaissIndex::AppendToGpuIndex(int64_t base_label, idx_t count, const float *vectors) {
+	// Inserts grow the device copy instead of re-uploading it; only Vacuum's compaction
+	// (which renumbers labels) or a backend that can't append forces a full rebuild
+	lock_guard<mutex> guard(gpu_search_lock_);
+	bool appended = false;
+	if (gpu_index_->ntotal == base_label) {
+		try {
+			appended = GetGpuBackend().AddToGpu(gpu_index_.get(), static_cast<faiss::idx_t>(count), vectors);
+		} catch (std::exception &) {
+			appended = false;
+		}
+	}
+	if (!appended) {
+		InvalidateGpuIndex();
+	}
+}
+
+void FaissIndex::RemoveFromGpuIndex(const vector<faiss::idx_t> &labels) {
+	if (!gpu_index_ || labels.empty()) {
+		return;
+	}
+	lock_guard<mutex> guard(gpu_search_lock_);
+	try {
+		if (GetGpuBackend().RemoveFromGpu(gpu_index_.get(), labels.data(), labels.size())) {
+			gpu_removed_ += labels.size();
+		}
+	} catch (std::exception &) {
+		// The labels stay on the device and are filtered from over-fetched results
+	}
+}
+
+vector<faiss::idx_t> FaissIndex::DeletedLabels() const {
+	vector<faiss::idx_t> labels;
+	labels.reserve(num_deleted_);
+	for (int64_t label = 0; label < static_cast<int64_t>(tombstones_.size()) * 8; label++) {
+		if (IsDeleted(label)) {
+			labels.push_back(label);
+		}
+	}
+	return labels;
 }
 
 // ========================================
@@ -165,7 +315,10 @@ PhysicalOperator &FaissIndex::CreatePlan(PlanIndexInput &input) {
 	auto &op = input.op;
 	auto &planner = input.planner;
 
-	if (op.unbound_expressions.size() != 1) {
+	auto partition_by = FaissParams::Parse(op.info->options).partition_by;
+	if (!partition_by.empty()) {
+		AnnCheckPartitionColumns(TYPE_NAME, partition_by, op.unbound_expressions);
+	} else if (op.unbound_expressions.size() != 1) {
 		throw InvalidInputException("FAISS index requires exactly one column");
 	}
 	auto &type = op.unbound_expressions[0]->return_type;
@@ -212,29 +365,156 @@ PhysicalCreateFaissIndex::PhysicalCreateFaissIndex(PhysicalPlan &physical_plan,
 	}
 }
 
-// Sink state: collect all vectors, then build index in Finalize (needed for IVF training)
+// Sink state: vectors stream into the FAISS index as they arrive. Indexes that need
+// training (IVF, HNSWSQ, factory strings) first buffer rows in a ColumnDataCollection,
+// which the buffer manager spills to temp storage, while a reservoir keeps a uniform
+// train_sample of them. Once enough rows have been seen the index is trained, the
+// buffer is drained into it, and later rows are added from thread-local batches.
+// With train_sample = 0 every row trains the index, so training waits for Finalize.
+// With partition_by the rows are grouped by partition value instead, and every
+// partition's child is built (and trained) from its own rows in Finalize.
+
+// Training starts once this many times train_sample rows have been seen, so the
+// reservoir is drawn from more than the first train_sample rows of the scan
+static constexpr idx_t FAISS_TRAIN_WINDOW_FACTOR = 4;
+// Thread-local batches are added to the index once they hold this many bytes
+static constexpr idx_t FAISS_ADD_BATCH_BYTES = 16 * 1024 * 1024;
+
 class CreateFaissGlobalSinkState : public GlobalSinkState {
 public:
-	vector<float> all_vectors;
-	vector<row_t> all_rowids;
+	explicit CreateFaissGlobalSinkState(BufferManager &buffer_manager) : buffer_manager(buffer_manager) {
+	}
+
+	BufferManager &buffer_manager;
 	int32_t dimension = 0;
 	FaissParams params;
+
+	mutex lock;
+	std::unique_ptr<faiss::Index> index;
+	bool trained = false;
+	vector<row_t> label_to_rowid; // in add order: position = FAISS label
+
+	// Before training: buffered rows and the reservoir sample
+	unique_ptr<ColumnDataCollection> pending;
+	vector<float> reservoir;
+	idx_t rows_seen = 0;
+	RandomEngine random {42};
+
+	AnnPartitionMap<AnnPartitionRows> partitions;
+};
+
+class CreateFaissLocalSinkState : public LocalSinkState {
+public:
+	vector<float> vectors;
+	vector<row_t> rowids;
+	AnnPartitionMap<AnnPartitionRows> partitions;
 };
 
-class CreateFaissLocalSinkState : public LocalSinkState {};
+// Appends the chunk's vectors (column 0) and row ids (last column)
+static void CollectChunkVectors(DataChunk &chunk, vector<float> &vectors, vector<row_t> &rowids) {
+	auto count = chunk.size();
+	auto &vec_col = chunk.data[0];
+	auto &rowid_col = chunk.data[chunk.ColumnCount() - 1];
+
+	auto &array_child = ArrayVector::GetEntry(vec_col);
+	auto array_size = ArrayType::GetSize(vec_col.GetType());
+	auto child_data = FlatVector::GetData<float>(array_child);
+
+	UnifiedVectorFormat rowid_format;
+	rowid_col.ToUnifiedFormat(count, rowid_format);
+	auto rowid_data = reinterpret_cast<row_t *>(rowid_format.data);
+
+	// Array children are contiguous: append the whole chunk at once
+	vectors.insert(vectors.end(), child_data, child_data + count * array_size);
+	for (idx_t i = 0; i < count; i++) {
+		rowids.push_back(rowid_data[rowid_format.sel->get_index(i)]);
+	}
+}
+
+// Adds a batch to the index; label order follows add order. Caller holds state.lock.
+static void AddToFaissIndex(CreateFaissGlobalSinkState &state, const vector<float> &vectors,
+                            const vector<row_t> &rowids) {
+	if (rowids.empty()) {
+		return;
+	}
+	state.index->add(static_cast<faiss::idx_t>(rowids.size()), vectors.data());
+	state.label_to_rowid.insert(state.label_to_rowid.end(), rowids.begin(), rowids.end());
+}
+
+// Keeps state.reservoir a uniform sample of train_sample of the rows seen so far
+static void SampleForTraining(CreateFaissGlobalSinkState &state, const vector<float> &vectors, idx_t count) {
+	auto dim = static_cast<idx_t>(state.dimension);
+	auto capacity = static_cast<idx_t>(state.params.train_sample);
+	for (idx_t i = 0; i < count; i++) {
+		auto seen = state.rows_seen++;
+		const float *vec = vectors.data() + i * dim;
+		if (seen < capacity) {
+			state.reservoir.insert(state.reservoir.end(), vec, vec + dim);
+			continue;
+		}
+		auto slot = static_cast<idx_t>(state.random.NextRandom() * static_cast<double>(seen + 1));
+		if (slot < capacity) {
+			memcpy(state.reservoir.data() + slot * dim, vec, dim * sizeof(float));
+		}
+	}
+}
+
+// Trains on the reservoir (or on every buffered row when train_sample = 0), then
+// moves the buffered rows into the index. Caller holds state.lock.
+static void TrainAndDrain(CreateFaissGlobalSinkState &state) {
+	vector<float> vectors;
+	vector<row_t> rowids;
+	if (state.params.train_sample > 0) {
+		auto n = state.reservoir.size() / state.dimension;
+		if (n > 0) {
+			state.index->train(static_cast<faiss::idx_t>(n), state.reservoir.data());
+		}
+		vector<float>().swap(state.reservoir);
+	} else if (state.pending) {
+		for (auto &chunk : state.pending->Chunks()) {
+			CollectChunkVectors(chunk, vectors, rowids);
+		}
+		state.pending.reset();
+		if (!rowids.empty()) {
+			state.index->train(static_cast<faiss::idx_t>(rowids.size()), vectors.data());
+		}
+		AddToFaissIndex(state, vectors, rowids);
+	}
+	state.trained = true;
+
+	if (state.pending) {
+		for (auto &chunk : state.pending->Chunks()) {
+			vectors.clear();
+			rowids.clear();
+			CollectChunkVectors(chunk, vectors, rowids);
+			AddToFaissIndex(state, vectors, rowids);
+		}
+		state.pending.reset();
+	}
+}
 
 unique_ptr<GlobalSinkState> PhysicalCreateFaissIndex::GetGlobalSinkState(ClientContext &context) const {
-	auto state = make_uniq<CreateFaissGlobalSinkState>();
+	auto state = make_uniq<CreateFaissGlobalSinkState>(BufferManager::GetBufferManager(context));
 
 	auto &type = unbound_expressions[0]->return_type;
 	state->dimension = static_cast<int32_t>(ArrayType::GetSize(type));
 
 	state->params = FaissParams::Parse(info->options);
 
-	// Pre-reserve based on estimated cardinality to avoid realloc+copy cycles
-	if (estimated_cardinality > 0) {
-		state->all_vectors.reserve(estimated_cardinality * state->dimension);
-		state->all_rowids.reserve(estimated_cardinality);
+	// Created up front so invalid options fail before the scan
+	state->index = MakeFaissIndex(state->dimension, state->params);
+	state->trained = state->index->is_trained;
+
+	// Set nprobe for IVF indexes (IVFFlat, IVFPQ and factory-built IVF variants)
+	if (state->params.nprobe > 1) {
+		auto *ivf = dynamic_cast<faiss::IndexIVF *>(state->index.get());
+		if (ivf) {
+			ivf->nprobe = static_cast<size_t>(state->params.nprobe);
+		}
+	}
+
+	if (state->trained && estimated_cardinality > 0) {
+		state->label_to_rowid.reserve(estimated_cardinality);
 	}
 
 	return std::move(state);
@@ -247,33 +527,48 @@ unique_ptr<LocalSinkState> PhysicalCreateFaissIndex::GetLocalSinkState(Execution
 SinkResultType PhysicalCreateFaissIndex::Sink(ExecutionContext &context, DataChunk &chunk,
                                               OperatorSinkInput &input) const {
 	auto &state = input.global_state.Cast<CreateFaissGlobalSinkState>();
+	auto &lstate = input.local_state.Cast<CreateFaissLocalSinkState>();
 
-	auto col_count = chunk.ColumnCount();
-	D_ASSERT(col_count >= 2);
-
-	auto &vec_col = chunk.data[0];
-	auto &rowid_col = chunk.data[col_count - 1];
-
+	D_ASSERT(chunk.ColumnCount() >= 2);
 	auto count = chunk.size();
 	if (count == 0) {
 		return SinkResultType::NEED_MORE_INPUT;
 	}
+	if (chunk.ColumnCount() == 3) {
+		// partition_by: [vector][partition column][row_id]
+		AnnGroupByPartition(chunk.data[1], chunk.data[2], count, lstate.partitions, &chunk.data[0]);
+		return SinkResultType::NEED_MORE_INPUT;
+	}
 
-	auto &array_child = ArrayVector::GetEntry(vec_col);
-	auto array_size = ArrayType::GetSize(vec_col.GetType());
-	auto child_data = FlatVector::GetData<float>(array_child);
-
-	UnifiedVectorFormat rowid_format;
-	rowid_col.ToUnifiedFormat(count, rowid_format);
-	auto rowid_data = reinterpret_cast<row_t *>(rowid_format.data);
-
-	for (idx_t i = 0; i < count; i++) {
-		auto row_idx = rowid_format.sel->get_index(i);
-		auto row_id = rowid_data[row_idx];
-		const float *vec_ptr = child_data + i * array_size;
+	{
+		lock_guard<mutex> guard(state.lock);
+		if (!state.trained) {
+			// Buffer the chunk until the index can take it
+			if (!state.pending) {
+				state.pending = make_uniq<ColumnDataCollection>(state.buffer_manager, chunk.GetTypes());
+			}
+			state.pending->Append(chunk);
+
+			if (state.params.train_sample > 0) {
+				vector<float> vectors;
+				vector<row_t> rowids;
+				CollectChunkVectors(chunk, vectors, rowids);
+				SampleForTraining(state, vectors, count);
+				if (state.rows_seen >= static_cast<idx_t>(state.params.train_sample) * FAISS_TRAIN_WINDOW_FACTOR) {
+					TrainAndDrain(state);
+				}
+			}
+			return SinkResultType::NEED_MORE_INPUT;
+		}
+	}
 
-		state.all_vectors.insert(state.all_vectors.end(), vec_ptr, vec_ptr + array_size);
-		state.all_rowids.push_back(row_id);
+	// Trained: batch locally, add under the lock once the batch is large enough
+	CollectChunkVectors(chunk, lstate.vectors, lstate.rowids);
+	if (lstate.vectors.size() * sizeof(float) >= FAISS_ADD_BATCH_BYTES) {
+		lock_guard<mutex> guard(state.lock);
+		AddToFaissIndex(state, lstate.vectors, lstate.rowids);
+		lstate.vectors.clear();
+		lstate.rowids.clear();
 	}
 
 	return SinkResultType::NEED_MORE_INPUT;
@@ -281,6 +576,22 @@ SinkResultType PhysicalCreateFaissIndex::Sink(ExecutionContext &context, DataChu
 
 SinkCombineResultType PhysicalCreateFaissIndex::Combine(ExecutionContext &context,
                                                         OperatorSinkCombineInput &input) const {
+	auto &state = input.global_state.Cast<CreateFaissGlobalSinkState>();
+	auto &lstate = input.local_state.Cast<CreateFaissLocalSinkState>();
+	if (!lstate.partitions.Empty()) {
+		lock_guard<mutex> guard(state.lock);
+		AnnMergePartitionRows(state.partitions, lstate.partitions);
+		return SinkCombineResultType::FINISHED;
+	}
+	if (lstate.rowids.empty()) {
+		return SinkCombineResultType::FINISHED;
+	}
+
+	// Local batches only exist once the index is trained
+	lock_guard<mutex> guard(state.lock);
+	AddToFaissIndex(state, lstate.vectors, lstate.rowids);
+	vector<float>().swap(lstate.vectors);
+	vector<row_t>().swap(lstate.rowids);
 	return SinkCombineResultType::FINISHED;
 }
 
@@ -294,50 +605,18 @@ SinkFinalizeType PhysicalCreateFaissIndex::Finalize(Pipeline &pipeline, Event &e
 		    "Transaction conflict: cannot add an index to a table that has been altered or dropped");
 	}
 
-	// Create FAISS index
-	auto faiss_idx = MakeFaissIndex(state.dimension, state.params.metric, state.params.index_type,
-	                                state.params.description, state.params.hnsw_m, state.params.ivf_nlist);
-
-	// Train if needed (IVF indexes)
-	idx_t n_vectors = state.all_rowids.size();
-	if (n_vectors > 0 && !faiss_idx->is_trained) {
-		if (state.params.train_sample > 0 && state.params.train_sample < static_cast<int64_t>(n_vectors)) {
-			// Use a subset of vectors for training
-			auto sample_n = static_cast<idx_t>(state.params.train_sample);
-			vector<float> sample(sample_n * state.dimension);
-			// Deterministic stride-based sampling
-			double stride = static_cast<double>(n_vectors) / sample_n;
-			for (idx_t i = 0; i < sample_n; i++) {
-				auto src_idx = static_cast<idx_t>(i * stride);
-				memcpy(sample.data() + i * state.dimension, state.all_vectors.data() + src_idx * state.dimension,
-				       state.dimension * sizeof(float));
-			}
-			faiss_idx->train(static_cast<faiss::idx_t>(sample_n), sample.data());
-		} else {
-			faiss_idx->train(static_cast<faiss::idx_t>(n_vectors), state.all_vectors.data());
-		}
-	}
-
-	// Set nprobe for IVF indexes
-	if (state.params.nprobe > 1) {
-		auto *ivf = dynamic_cast<faiss::IndexIVFFlat *>(faiss_idx.get());
-		if (ivf) {
-			ivf->nprobe = static_cast<size_t>(state.params.nprobe);
-		}
-	}
-
-	// Add all vectors
-	if (n_vectors > 0) {
-		faiss_idx->add(static_cast<faiss::idx_t>(n_vectors), state.all_vectors.data());
+	// Fewer rows than the training window (or train_sample = 0): train on what arrived
+	if (!state.trained && state.pending) {
+		TrainAndDrain(state);
 	}
+	auto faiss_idx = std::move(state.index);
 
 	// Build row ID mapping
-	vector<row_t> label_to_rowid(n_vectors);
+	auto label_to_rowid = std::move(state.label_to_rowid);
 	unordered_map<row_t, int64_t> rowid_to_label;
-	rowid_to_label.reserve(n_vectors);
-	for (idx_t i = 0; i < n_vectors; i++) {
-		label_to_rowid[i] = state.all_rowids[i];
-		rowid_to_label[state.all_rowids[i]] = static_cast<int64_t>(i);
+	rowid_to_label.reserve(label_to_rowid.size());
+	for (idx_t i = 0; i < label_to_rowid.size(); i++) {
+		rowid_to_label[label_to_rowid[i]] = static_cast<int64_t>(i);
 	}
 
 	auto options = state.params.ToOptions();
@@ -345,8 +624,18 @@ SinkFinalizeType PhysicalCreateFaissIndex::Finalize(Pipeline &pipeline, Event &e
 	auto index = make_uniq<FaissIndex>(info->index_name, info->constraint_type, storage_ids,
 	                                   TableIOManager::Get(storage), unbound_expressions, storage.db, options);
 
-	// Transfer built state
-	index->faiss_index_ = std::move(faiss_idx);
+	// Transfer built state; a partitioned index builds one child per partition from its rows instead
+	if (index->IsPartitioned()) {
+		for (idx_t p = 0; p < state.partitions.Size(); p++) {
+			auto &rows = state.partitions.Get(p);
+			auto &child = index->GetOrCreatePartition(state.partitions.Key(p));
+			child.AppendRows(rows.vectors.data(), rows.row_ids.data(), rows.row_ids.size());
+			child.EnsureGpuIndex();
+			rows = AnnPartitionRows();
+		}
+	} else {
+		index->faiss_index_ = std::move(faiss_idx);
+	}
 	index->dimension_ = state.dimension;
 	index->metric_ = state.params.metric;
 	index->index_type_ = state.params.index_type;
@@ -354,6 +643,10 @@ SinkFinalizeType PhysicalCreateFaissIndex::Finalize(Pipeline &pipeline, Event &e
 	index->ivf_nlist_ = state.params.ivf_nlist;
 	index->nprobe_ = state.params.nprobe;
 	index->train_sample_ = state.params.train_sample;
+	index->pq_m_ = state.params.pq_m;
+	index->pq_nbits_ = state.params.pq_nbits;
+	index->sq_type_ = state.params.sq_type;
+	index->precision_ = state.params.precision;
 	index->description_ = state.params.description;
 	index->mode_ = state.params.mode;
 	index->label_to_rowid_ = std::move(label_to_rowid);
@@ -365,6 +658,7 @@ SinkFinalizeType PhysicalCreateFaissIndex::Finalize(Pipeline &pipeline, Event &e
 
 	BoundIndex &bi = *index;
 	bi.Vacuum();
+	index->UpdateReservation();
 #ifdef DUCKDB_API_V15
 	bi.Verify();
 #else
@@ -437,38 +731,113 @@ ErrorData FaissIndex::Append(IndexLock &lock, DataChunk &entries, Vector &row_id
 	expr_chunk.Initialize(Allocator::DefaultAllocator(), logical_types);
 	ExecuteExpressions(entries, expr_chunk);
 
-	if (!faiss_index_) {
-		faiss_index_ = MakeFaissIndex(dimension_, metric_, index_type_, description_, hnsw_m_, ivf_nlist_);
+	if (IsPartitioned()) {
+		AnnPartitionMap<AnnPartitionRows> rows;
+		AnnGroupByPartition(expr_chunk.data[1], row_identifiers, count, rows, &expr_chunk.data[0]);
+		for (idx_t p = 0; p < rows.Size(); p++) {
+			auto &part = rows.Get(p);
+			GetOrCreatePartition(rows.Key(p)).AppendRows(part.vectors.data(), part.row_ids.data(),
+			                                             part.row_ids.size());
+		}
+		result_cache_.Invalidate();
+		return ErrorData {};
 	}
 
 	auto &vec_col = expr_chunk.data[0];
 	auto &array_child = ArrayVector::GetEntry(vec_col);
-	auto array_size = ArrayType::GetSize(vec_col.GetType());
 	auto child_data = FlatVector::GetData<float>(array_child);
 
 	UnifiedVectorFormat rowid_format;
 	row_identifiers.ToUnifiedFormat(count, rowid_format);
 	auto rowid_data = reinterpret_cast<row_t *>(rowid_format.data);
+	vector<row_t> row_ids(count);
+	for (idx_t i = 0; i < count; i++) {
+		row_ids[i] = rowid_data[rowid_format.sel->get_index(i)];
+	}
+	AppendRows(child_data, row_ids.data(), count);
+	return ErrorData {};
+}
+
+static idx_t FaissHeapBytes(const faiss::Index &index);
+
+void FaissIndex::AppendRows(const float *vectors, const row_t *row_ids, idx_t count) {
+	if (count == 0) {
+		return;
+	}
+	if (!faiss_index_) {
+		faiss_index_ = MakeFaissIndex(dimension_, CurrentParams());
+	}
+	if (!faiss_index_->is_trained) {
+		// A partition's child (or an index created on an empty table) trains on its first rows
+		auto dim = static_cast<idx_t>(dimension_);
+		auto n = train_sample_ > 0 ? MinValue<idx_t>(count, static_cast<idx_t>(train_sample_)) : count;
+		if (n == count) {
+			faiss_index_->train(static_cast<faiss::idx_t>(count), vectors);
+		} else {
+			vector<float> sample(n * dim);
+			for (idx_t i = 0; i < n; i++) {
+				memcpy(sample.data() + i * dim, vectors + (i * count / n) * dim, dim * sizeof(float));
+			}
+			faiss_index_->train(static_cast<faiss::idx_t>(n), sample.data());
+		}
+	}
+
+	// Reserve before adding, so an out-of-memory error leaves the index as it was: rows cost what the
+	// index's current rows cost on average (a full-precision vector while it is empty), plus label maps
+	auto ntotal = static_cast<idx_t>(faiss_index_->ntotal);
+	auto row_bytes = ntotal > 0 ? FaissHeapBytes(*faiss_index_) / ntotal : dimension_ * sizeof(float);
+	UpdateReservation(count * (row_bytes + 2 * sizeof(row_t) + sizeof(int64_t)));
 
 	// Batch add: single FAISS call for the entire chunk
 	auto base_label = faiss_index_->ntotal;
-	faiss_index_->add(static_cast<faiss::idx_t>(count), child_data);
+	faiss_index_->add(static_cast<faiss::idx_t>(count), vectors);
+	result_cache_.Invalidate();
 
 	auto new_size = base_label + static_cast<int64_t>(count);
 	if (new_size > static_cast<int64_t>(label_to_rowid_.size())) {
 		label_to_rowid_.resize(new_size, -1);
 	}
 	for (idx_t i = 0; i < count; i++) {
-		auto row_idx = rowid_format.sel->get_index(i);
-		auto row_id = rowid_data[row_idx];
 		auto label = base_label + static_cast<int64_t>(i);
-		label_to_rowid_[label] = row_id;
-		rowid_to_label_[row_id] = label;
+		label_to_rowid_[label] = row_ids[i];
+		rowid_to_label_[row_ids[i]] = label;
 	}
 
-	InvalidateGpuIndex();
+	if (gpu_index_) {
+		AppendToGpuIndex(base_label, count, vectors);
+	}
 	is_dirty_ = true;
-	return ErrorData {};
+	UpdateReservation();
+}
+
+FaissIndex &FaissIndex::GetOrCreatePartition(const Value &key, const IndexStorageInfo &info) {
+	auto existing = FindPartition(key);
+	if (existing) {
+		return *existing;
+	}
+	// Same columns and storage as the parent: only the options lose partition_by
+	auto child = make_uniq<FaissIndex>(name, index_constraint_type, GetColumnIds(), table_io_manager,
+	                                   unbound_expressions, db, child_options_, info);
+	std::unique_lock<std::shared_mutex> guard(partitions_lock_);
+	auto &entry = partitions_.GetOrCreate(key);
+	entry = std::move(child);
+	return *entry;
+}
+
+vector<FaissIndex *> FaissIndex::Partitions() const {
+	std::shared_lock<std::shared_mutex> guard(partitions_lock_);
+	vector<FaissIndex *> children;
+	children.reserve(partitions_.Size());
+	for (idx_t p = 0; p < partitions_.Size(); p++) {
+		children.push_back(partitions_.Get(p).get());
+	}
+	return children;
+}
+
+FaissIndex *FaissIndex::FindPartition(const Value &key) const {
+	std::shared_lock<std::shared_mutex> guard(partitions_lock_);
+	auto child = partitions_.Find(key);
+	return child ? child->get() : nullptr;
 }
 
 ErrorData FaissIndex::Insert(IndexLock &lock, DataChunk &data, Vector &row_ids) {
@@ -481,30 +850,84 @@ void FaissIndex::Delete(IndexLock &lock, DataChunk &entries, Vector &row_identif
 		return;
 	}
 
+	if (IsPartitioned()) {
+		// The deleted rows' old values name their partitions
+		DataChunk expr_chunk;
+		expr_chunk.Initialize(Allocator::DefaultAllocator(), logical_types);
+		ExecuteExpressions(entries, expr_chunk);
+		AnnPartitionMap<AnnPartitionRows> rows;
+		AnnGroupByPartition(expr_chunk.data[1], row_identifiers, count, rows);
+		for (idx_t p = 0; p < rows.Size(); p++) {
+			auto child = FindPartition(rows.Key(p));
+			if (child) {
+				child->DeleteRows(rows.Get(p).row_ids.data(), rows.Get(p).row_ids.size());
+			}
+		}
+		result_cache_.Invalidate();
+		return;
+	}
+
 	UnifiedVectorFormat rowid_format;
 	row_identifiers.ToUnifiedFormat(count, rowid_format);
 	auto rowid_data = reinterpret_cast<row_t *>(rowid_format.data);
+	vector<row_t> row_ids(count);
+	for (idx_t i = 0; i < count; i++) {
+		row_ids[i] = rowid_data[rowid_format.sel->get_index(i)];
+	}
+	DeleteRows(row_ids.data(), count);
+}
 
+void FaissIndex::DeleteRows(const row_t *row_ids, idx_t count) {
+	vector<faiss::idx_t> deleted_labels;
 	for (idx_t i = 0; i < count; i++) {
-		auto row_idx = rowid_format.sel->get_index(i);
-		auto row_id = rowid_data[row_idx];
+		auto row_id = row_ids[i];
 
 		auto it = rowid_to_label_.find(row_id);
 		if (it != rowid_to_label_.end()) {
-			deleted_labels_.insert(it->second);
+			if (!IsDeleted(it->second)) {
+				deleted_labels.push_back(it->second);
+			}
+			MarkDeleted(it->second);
 			rowid_to_label_.erase(it);
 		}
 	}
+	RemoveFromGpuIndex(deleted_labels);
+	result_cache_.Invalidate();
 
 	is_dirty_ = true;
 }
 
+void FaissIndex::MarkDeleted(int64_t label) {
+	auto byte = static_cast<idx_t>(label >> 3);
+	if (byte >= tombstones_.size()) {
+		tombstones_.resize(byte + 1, 0);
+	}
+	auto bit = static_cast<uint8_t>(1u << (label & 7));
+	if (!(tombstones_[byte] & bit)) {
+		tombstones_[byte] |= bit;
+		num_deleted_++;
+	}
+}
+
 void FaissIndex::CommitDrop(IndexLock &lock) {
-	gpu_index_.reset();
+	for (auto *partition : Partitions()) {
+		auto &child = *partition;
+		IndexLock child_lock;
+		child.InitializeLock(child_lock);
+		child.CommitDrop(child_lock);
+	}
+	{
+		std::unique_lock<std::shared_mutex> guard(partitions_lock_);
+		partitions_.Clear();
+	}
+	InvalidateGpuIndex();
 	faiss_index_.reset();
 	label_to_rowid_.clear();
 	rowid_to_label_.clear();
-	deleted_labels_.clear();
+	ClearTombstones();
+	result_cache_.Invalidate();
+	wal_log_.reset();
+	reservation_->Update(0);
 
 	if (root_block_ptr_.Get() != 0) {
 		block_allocator_->Reset();
@@ -517,6 +940,26 @@ void FaissIndex::CommitDrop(IndexLock &lock) {
 // ========================================
 
 static constexpr uint32_t FAISS_STORAGE_VERSION = 1;
+// Logical WAL record (AnnWalLog): the dimension, then the live (row id, vector) batches
+static constexpr uint32_t FAISS_STORAGE_VERSION_WAL = 101;
+// partition_by: the partition directory (ann_partition.hpp); every child is a FAISS index of its own
+static constexpr uint32_t FAISS_STORAGE_VERSION_PARTITIONED = 102;
+
+// Flat and HNSWFlat hold their vectors exactly and need no training: the index is rebuilt
+// from its rows as it was. Trained and quantized types keep their image in the WAL.
+static bool RebuildsFromRows(const faiss::Index &index, const string &description) {
+	return description.empty() &&
+	       (dynamic_cast<const faiss::IndexFlat *>(&index) || dynamic_cast<const faiss::IndexHNSWFlat *>(&index));
+}
+
+template <class T>
+static T ReadValue(LinkedBlockReader &reader) {
+	T value {};
+	if (reader.Read(reinterpret_cast<uint8_t *>(&value), sizeof(T)) != sizeof(T)) {
+		throw IOException("FAISS index storage is truncated. Drop and recreate the index.");
+	}
+	return value;
+}
 
 void FaissIndex::PersistToDisk() {
 	if (!is_dirty_ || !faiss_index_) {
@@ -533,7 +976,7 @@ void FaissIndex::PersistToDisk() {
 
 	uint64_t faiss_len = faiss_writer.data.size();
 	uint64_t num_mappings = label_to_rowid_.size();
-	uint64_t num_tombstones = deleted_labels_.size();
+	uint64_t num_tombstones = num_deleted_;
 
 	LinkedBlockWriter writer(*block_allocator_, root_block_ptr_);
 	writer.Reset();
@@ -554,7 +997,7 @@ void FaissIndex::PersistToDisk() {
 	// Write tombstones
 	writer.Write(reinterpret_cast<const uint8_t *>(&num_tombstones), sizeof(uint64_t));
 	if (num_tombstones > 0) {
-		vector<int64_t> tombstone_vec(deleted_labels_.begin(), deleted_labels_.end());
+		auto tombstone_vec = DeletedLabels();
 		writer.Write(reinterpret_cast<const uint8_t *>(tombstone_vec.data()), num_tombstones * sizeof(int64_t));
 	}
 
@@ -594,6 +1037,14 @@ void FaissIndex::LoadFromStorage(const IndexStorageInfo &info) {
 	// Read and validate version header
 	uint32_t version = 0;
 	reader.Read(reinterpret_cast<uint8_t *>(&version), sizeof(uint32_t));
+	if (version == FAISS_STORAGE_VERSION_WAL) {
+		LoadWalLog(reader);
+		return;
+	}
+	if (version == FAISS_STORAGE_VERSION_PARTITIONED) {
+		LoadPartitions(reader, info);
+		return;
+	}
 	if (version != FAISS_STORAGE_VERSION) {
 		throw IOException("FAISS index storage version mismatch: found %u, expected %u. "
 		                  "Drop and recreate the index.",
@@ -621,7 +1072,9 @@ void FaissIndex::LoadFromStorage(const IndexStorageInfo &info) {
 	if (num_tombstones > 0) {
 		vector<int64_t> tombstones(num_tombstones);
 		reader.Read(reinterpret_cast<uint8_t *>(tombstones.data()), num_tombstones * sizeof(int64_t));
-		deleted_labels_.insert(tombstones.begin(), tombstones.end());
+		for (auto label : tombstones) {
+			MarkDeleted(label);
+		}
 	}
 
 	// Read index parameters
@@ -657,7 +1110,7 @@ void FaissIndex::LoadFromStorage(const IndexStorageInfo &info) {
 	// Rebuild rowid_to_label_ from label_to_rowid_
 	rowid_to_label_.reserve(num_mappings);
 	for (size_t i = 0; i < label_to_rowid_.size(); i++) {
-		if (deleted_labels_.count(static_cast<int64_t>(i)) == 0) {
+		if (!IsDeleted(static_cast<int64_t>(i))) {
 			rowid_to_label_[label_to_rowid_[i]] = static_cast<int64_t>(i);
 		}
 	}
@@ -673,7 +1126,63 @@ void FaissIndex::LoadFromStorage(const IndexStorageInfo &info) {
 	is_dirty_ = false;
 }
 
+void FaissIndex::LoadWalLog(LinkedBlockReader &reader) {
+	auto dimension = ReadValue<int32_t>(reader);
+	if (dimension != dimension_) {
+		throw IOException("FAISS WAL record of index \"%s\" has dimension %d, the index expects %d", name, dimension,
+		                  dimension_);
+	}
+	faiss_index_ = MakeFaissIndex(dimension_, CurrentParams());
+	AnnWalLog::ReadRows(reader, static_cast<idx_t>(dimension_),
+	                    [&](const row_t *row_ids, const float *vectors, idx_t count) {
+		                    auto base_label = faiss_index_->ntotal;
+		                    faiss_index_->add(static_cast<faiss::idx_t>(count), vectors);
+		                    label_to_rowid_.resize(base_label + static_cast<int64_t>(count), -1);
+		                    for (idx_t i = 0; i < count; i++) {
+			                    label_to_rowid_[base_label + static_cast<int64_t>(i)] = row_ids[i];
+			                    rowid_to_label_[row_ids[i]] = base_label + static_cast<int64_t>(i);
+		                    }
+	                    });
+	// The record only lived in the WAL: this index's block storage starts out empty
+	block_allocator_->Reset();
+	root_block_ptr_ = IndexPointer();
+	EnsureGpuIndex();
+	is_dirty_ = true;
+}
+
+void FaissIndex::LoadPartitions(LinkedBlockReader &reader, const IndexStorageInfo &info) {
+	if (!IsPartitioned()) {
+		throw IOException("FAISS index \"%s\" is stored partitioned but has no partition_by option", name);
+	}
+	auto directory = AnnReadPartitionDirectory(reader, partition_type_);
+	for (idx_t i = 0; i < directory.size(); i++) {
+		GetOrCreatePartition(directory[i].key,
+		                     AnnPartitionStorage::ChildInfo(info, i, directory[i].root, child_options_));
+	}
+}
+
+void FaissIndex::WritePartitionRoot(const vector<AnnPartitionEntry> &directory) {
+	if (root_block_ptr_.Get() == 0) {
+		root_block_ptr_ = block_allocator_->New();
+	}
+	LinkedBlockWriter writer(*block_allocator_, root_block_ptr_);
+	writer.Reset();
+	writer.Write(reinterpret_cast<const uint8_t *>(&FAISS_STORAGE_VERSION_PARTITIONED), sizeof(uint32_t));
+	AnnWritePartitionDirectory(writer, directory);
+}
+
 IndexStorageInfo FaissIndex::SerializeToDisk(QueryContext context, const case_insensitive_map_t<Value> &options) {
+	AnnPartitionStorage partitions;
+	{
+		std::shared_lock<std::shared_mutex> partitions_guard(partitions_lock_);
+		for (idx_t p = 0; p < partitions_.Size(); p++) {
+			partitions.Add(partitions_.Key(p), partitions_.Get(p)->SerializeToDisk(context, child_options_));
+		}
+	}
+	if (IsPartitioned()) {
+		WritePartitionRoot(partitions.directory);
+	}
+	wal_log_.reset();
 	PersistToDisk();
 
 	IndexStorageInfo info;
@@ -685,11 +1194,38 @@ IndexStorageInfo FaissIndex::SerializeToDisk(QueryContext context, const case_in
 	block_allocator_->SerializeBuffers(partial_block_manager);
 	partial_block_manager.FlushPartialBlocks();
 	info.allocator_infos.push_back(block_allocator_->GetInfo());
+	partitions.AppendTo(info);
+	info.options = options;
+	calibration_.Serialize(info.options);
 
 	return info;
 }
 
 IndexStorageInfo FaissIndex::SerializeToWAL(const case_insensitive_map_t<Value> &options) {
+	AnnPartitionStorage partitions;
+	{
+		std::shared_lock<std::shared_mutex> partitions_guard(partitions_lock_);
+		for (idx_t p = 0; p < partitions_.Size(); p++) {
+			partitions.Add(partitions_.Key(p), partitions_.Get(p)->SerializeToWAL(child_options_));
+		}
+	}
+	if (IsPartitioned()) {
+		WritePartitionRoot(partitions.directory);
+	}
+	// Never persisted and rebuildable from its rows: log the rows, not the serialized index
+	if (!IsPartitioned() && root_block_ptr_.Get() == 0 &&
+	    (!faiss_index_ || RebuildsFromRows(*faiss_index_, description_))) {
+		wal_log_ = make_uniq<AnnWalLog>(table_io_manager.GetIndexBlockManager());
+		auto &writer = wal_log_->Writer();
+		writer.Write(reinterpret_cast<const uint8_t *>(&FAISS_STORAGE_VERSION_WAL), sizeof(uint32_t));
+		writer.Write(reinterpret_cast<const uint8_t *>(&dimension_), sizeof(int32_t));
+		wal_log_->WriteRows(GetLiveRowIds(), static_cast<idx_t>(dimension_),
+		                    [&](const vector<row_t> &row_ids) { return GetVectors(row_ids); });
+		auto info = wal_log_->GetInfo(name, options);
+		calibration_.Serialize(info.options);
+		return info;
+	}
+
 	PersistToDisk();
 
 	IndexStorageInfo info;
@@ -697,6 +1233,9 @@ IndexStorageInfo FaissIndex::SerializeToWAL(const case_insensitive_map_t<Value>
 	info.root = root_block_ptr_.Get();
 	info.buffers.push_back(block_allocator_->InitSerializationToWAL());
 	info.allocator_infos.push_back(block_allocator_->GetInfo());
+	partitions.AppendTo(info);
+	info.options = options;
+	calibration_.Serialize(info.options);
 
 	return info;
 }
@@ -705,28 +1244,120 @@ IndexStorageInfo FaissIndex::SerializeToWAL(const case_insensitive_map_t<Value>
 // Search
 // ========================================
 
-vector<pair<row_t, float>> FaissIndex::Search(const float *query, int32_t dimension, int32_t k) {
-	if (!faiss_index_ || dimension != dimension_) {
-		return {};
+void FaissIndex::SearchWithSelector(faiss::idx_t nq, const float *queries, int32_t k, const faiss::IDSelector &sel,
+                                    float *distances, faiss::idx_t *labels) const {
+	// Search parameters replace the index defaults, so carry nprobe / efSearch over
+	if (auto *ivf = dynamic_cast<faiss::IndexIVF *>(faiss_index_.get())) {
+		faiss::SearchParametersIVF params;
+		params.sel = const_cast<faiss::IDSelector *>(&sel);
+		params.nprobe = ivf->nprobe;
+		faiss_index_->search(nq, queries, k, distances, labels, &params);
+	} else if (auto *hnsw = dynamic_cast<faiss::IndexHNSW *>(faiss_index_.get())) {
+		faiss::SearchParametersHNSW params;
+		params.sel = const_cast<faiss::IDSelector *>(&sel);
+		params.efSearch = MaxValue<int>(hnsw->hnsw.efSearch, k);
+		faiss_index_->search(nq, queries, k, distances, labels, &params);
+	} else {
+		faiss::SearchParameters params;
+		params.sel = const_cast<faiss::IDSelector *>(&sel);
+		faiss_index_->search(nq, queries, k, distances, labels, &params);
 	}
+}
 
-	int64_t request_k64 = static_cast<int64_t>(k) + static_cast<int64_t>(deleted_labels_.size());
-	request_k64 = MinValue<int64_t>(request_k64, static_cast<int64_t>(faiss_index_->ntotal));
-	int32_t request_k = static_cast<int32_t>(MinValue<int64_t>(request_k64, static_cast<int64_t>(INT32_MAX)));
-	if (request_k <= 0) {
-		return {};
+int32_t FaissIndex::CandidateCount(int32_t k) const {
+	// Tombstones are excluded inside the CPU search through an IDSelector, so the
+	// candidate list is sized by k alone. GPU indexes ignore selectors and over-fetch
+	// by the deleted labels still on the device.
+	auto ntotal = static_cast<int64_t>(faiss_index_->ntotal);
+	auto num_deleted = static_cast<int64_t>(num_deleted_);
+	auto gpu_deleted = static_cast<int64_t>(num_deleted_ - gpu_removed_);
+	int64_t request_k64 = gpu_index_ ? MinValue<int64_t>(static_cast<int64_t>(k) + gpu_deleted, ntotal)
+	                                 : MinValue<int64_t>(k, ntotal - num_deleted);
+	return static_cast<int32_t>(MinValue<int64_t>(request_k64, static_cast<int64_t>(INT32_MAX)));
+}
+
+int32_t FaissIndex::NprobeFor(int32_t k) const {
+	auto calibrated = calibration_.For(k);
+	return calibrated > 0 ? calibrated : nprobe_;
+}
+
+uint64_t FaissIndex::DistanceComputationsPerQuery(int32_t nprobe) const {
+	auto ntotal = static_cast<uint64_t>(faiss_index_->ntotal);
+	if (auto *ivf = dynamic_cast<faiss::IndexIVF *>(faiss_index_.get())) {
+		auto nlist = MaxValue<uint64_t>(ivf->nlist, 1);
+		auto probed = MinValue<uint64_t>(static_cast<uint64_t>(MaxValue<int32_t>(nprobe, 1)), nlist);
+		return nlist + ntotal * probed / nlist;
+	}
+	if (dynamic_cast<faiss::IndexHNSW *>(faiss_index_.get())) {
+		return 0;
 	}
+	return ntotal;
+}
 
+uint64_t FaissIndex::SearchCandidates(faiss::idx_t nq, const float *queries, int32_t request_k, int32_t nprobe,
+                                      float *distances, faiss::idx_t *labels) {
 	// Set nprobe for IVF indexes before searching
-	if (nprobe_ > 1) {
-		auto *ivf = dynamic_cast<faiss::IndexIVFFlat *>(faiss_index_.get());
-		if (ivf) {
-			ivf->nprobe = static_cast<size_t>(nprobe_);
+	if (auto *ivf = dynamic_cast<faiss::IndexIVF *>(faiss_index_.get())) {
+		ivf->nprobe = static_cast<size_t>(MaxValue<int32_t>(nprobe, 1));
+	}
+
+	auto start = AnnSearchStats::Clock::now();
+	auto max_gpu_k = GetGpuBackend().MaxSearchK();
+	bool on_gpu = gpu_index_ && (max_gpu_k == 0 || request_k <= max_gpu_k);
+	if (on_gpu) {
+		// GPU index (uploaded after Finalize/LoadFromStorage/Vacuum, updated in place by
+		// Append/Delete). Its resources are not safe for concurrent searches.
+		lock_guard<mutex> guard(gpu_search_lock_);
+		GetGpuBackend().SetNprobe(gpu_index_.get(), static_cast<size_t>(MaxValue<int32_t>(nprobe, 1)));
+		gpu_index_->search(nq, queries, request_k, distances, labels);
+	} else if (num_deleted_ == 0) {
+		faiss_index_->search(nq, queries, request_k, distances, labels);
+	} else {
+		faiss::IDSelectorBitmap deleted(tombstones_.size(), tombstones_.data());
+		faiss::IDSelectorNot live(&deleted);
+		SearchWithSelector(nq, queries, request_k, live, distances, labels);
+	}
+	auto engine_nanos = AnnSearchStats::NanosSince(start);
+	search_stats_.RecordDispatch(static_cast<uint64_t>(nq) * DistanceComputationsPerQuery(nprobe), on_gpu);
+	return engine_nanos;
+}
+
+idx_t FaissIndex::CollectResults(const faiss::idx_t *labels, const float *distances, int32_t request_k, int32_t k,
+                                 vector<pair<row_t, float>> &results) const {
+	results.reserve(k);
+	idx_t skipped = 0;
+	for (int32_t i = 0; i < request_k && static_cast<int32_t>(results.size()) < k; i++) {
+		auto label = labels[i];
+		if (label < 0) {
+			continue; // FAISS returns -1 for unfilled slots
+		}
+		if (gpu_index_ && IsDeleted(label)) {
+			skipped++;
+			continue;
+		}
+		if (label < static_cast<int64_t>(label_to_rowid_.size())) {
+			results.emplace_back(label_to_rowid_[label], distances[i]);
 		}
 	}
+	return skipped;
+}
 
-	// Use GPU index if available (rebuilt after Finalize/LoadFromStorage/Vacuum, not per-query)
-	auto *search_index = gpu_index_ ? gpu_index_.get() : faiss_index_.get();
+vector<pair<row_t, float>> FaissIndex::Search(const float *query, int32_t dimension, int32_t k, int32_t nprobe) {
+	if (IsPartitioned()) {
+		if (dimension != dimension_ || k <= 0) {
+			return {};
+		}
+		nprobe = nprobe > 0 ? nprobe : NprobeFor(k);
+		return SearchPartitions(k, [&](FaissIndex &child) { return child.Search(query, dimension, k, nprobe); });
+	}
+	if (!faiss_index_ || dimension != dimension_) {
+		return {};
+	}
+	auto request_k = CandidateCount(k);
+	if (request_k <= 0) {
+		return {};
+	}
+	auto start = AnnSearchStats::Clock::now();
 
 	// Thread-local scratch buffers — allocated once per thread, reused across queries
 	thread_local vector<faiss::idx_t> tl_labels;
@@ -734,54 +1365,399 @@ vector<pair<row_t, float>> FaissIndex::Search(const float *query, int32_t dimens
 	tl_labels.resize(request_k);
 	tl_distances.resize(request_k);
 
-	search_index->search(1, query, request_k, tl_distances.data(), tl_labels.data());
+	auto engine_nanos = SearchCandidates(1, query, request_k, nprobe > 0 ? nprobe : NprobeFor(k),
+	                                     tl_distances.data(), tl_labels.data());
+
+	vector<pair<row_t, float>> results;
+	search_stats_.RecordDeletedFiltered(CollectResults(tl_labels.data(), tl_distances.data(), request_k, k, results));
+	search_stats_.RecordSearch(1, AnnSearchStats::NanosSince(start), engine_nanos);
+	reservation_->Touch();
 
 	// Shrink thread-local buffers if a previous large request inflated them
 	if (tl_labels.capacity() > 4096 && request_k < 1024) {
 		tl_labels.shrink_to_fit();
 		tl_distances.shrink_to_fit();
 	}
+	return results;
+}
 
-	vector<pair<row_t, float>> results;
-	results.reserve(k);
+vector<vector<pair<row_t, float>>> FaissIndex::SearchBatch(const vector<vector<float>> &queries, int32_t k,
+                                                           int32_t nprobe) {
+	auto nq = queries.size();
+	vector<vector<pair<row_t, float>>> all_results(nq);
+	if (IsPartitioned() && nq > 0 && k > 0) {
+		auto start = AnnSearchStats::Clock::now();
+		nprobe = nprobe > 0 ? nprobe : NprobeFor(k);
+		// Every child runs the whole batch; the batches are merged query by query
+		auto partitions = Partitions();
+		vector<vector<vector<pair<row_t, float>>>> partition_results(partitions.size());
+		auto tally = AnnSearchTally::Current();
+		AnnParallelFor(db.GetDatabase(), partitions.size(), [&](idx_t p) {
+			partition_results[p] =
+			    AnnSearchTally::RunChild(tally, [&]() { return partitions[p]->SearchBatch(queries, k, nprobe); });
+		});
+		vector<vector<pair<row_t, float>>> lists(partitions.size());
+		for (idx_t qi = 0; qi < nq; qi++) {
+			for (idx_t p = 0; p < partitions.size(); p++) {
+				lists[p] = std::move(partition_results[p][qi]);
+			}
+			all_results[qi] = AnnMergeTopK(lists, static_cast<idx_t>(k), LargerIsNearer());
+		}
+		search_stats_.RecordSearch(nq, AnnSearchStats::NanosSince(start), 0);
+		reservation_->Touch();
+		return all_results;
+	}
+	if (!faiss_index_ || nq == 0) {
+		return all_results;
+	}
+	auto request_k = CandidateCount(k);
+	if (request_k <= 0) {
+		return all_results;
+	}
+	auto start = AnnSearchStats::Clock::now();
+
+	// One nq-row search: FAISS parallelizes over queries and uses its batched (GEMM) kernels.
+	// Queries of the wrong dimension get a zero row and no results.
+	vector<float> flat_queries(nq * dimension_, 0.0f);
+	vector<bool> valid(nq, false);
+	for (idx_t qi = 0; qi < nq; qi++) {
+		if (queries[qi].size() == static_cast<size_t>(dimension_)) {
+			std::copy(queries[qi].begin(), queries[qi].end(), flat_queries.begin() + qi * dimension_);
+			valid[qi] = true;
+		}
+	}
 
-	for (int32_t i = 0; i < request_k && static_cast<int32_t>(results.size()) < k; i++) {
-		auto label = tl_labels[i];
-		if (label < 0) {
-			continue; // FAISS returns -1 for unfilled slots
+	auto total = nq * static_cast<idx_t>(request_k);
+	vector<faiss::idx_t> flat_labels(total, -1);
+	vector<float> flat_distances(total);
+	auto engine_nanos =
+	    SearchCandidates(static_cast<faiss::idx_t>(nq), flat_queries.data(), request_k,
+	                     nprobe > 0 ? nprobe : NprobeFor(k), flat_distances.data(), flat_labels.data());
+
+	// Tombstones the GPU index returned are dropped per query row
+	idx_t skipped = 0;
+	for (idx_t qi = 0; qi < nq; qi++) {
+		if (valid[qi]) {
+			auto base = qi * static_cast<idx_t>(request_k);
+			skipped +=
+			    CollectResults(flat_labels.data() + base, flat_distances.data() + base, request_k, k, all_results[qi]);
 		}
-		if (deleted_labels_.count(label) > 0) {
-			continue;
+	}
+	search_stats_.RecordDeletedFiltered(skipped);
+	search_stats_.RecordSearch(nq, AnnSearchStats::NanosSince(start), engine_nanos);
+	reservation_->Touch();
+	return all_results;
+}
+
+vector<pair<row_t, float>> FaissIndex::SearchFiltered(const float *query, int32_t dimension, int32_t k,
+                                                      const vector<row_t> &allowed_rowids, bool exhaustive) {
+	if (IsPartitioned()) {
+		if (dimension != dimension_ || k <= 0 || allowed_rowids.empty()) {
+			return {};
 		}
-		if (label < static_cast<int64_t>(label_to_rowid_.size())) {
-			results.emplace_back(label_to_rowid_[label], tl_distances[i]);
+		return SearchPartitions(k, [&](FaissIndex &child) {
+			return child.SearchFiltered(query, dimension, k, allowed_rowids, exhaustive);
+		});
+	}
+	if (!faiss_index_ || dimension != dimension_ || k <= 0) {
+		return {};
+	}
+	reservation_->Touch();
+
+	// Deleted rows are no longer in rowid_to_label_, so tombstones never pass the selector
+	auto ntotal = faiss_index_->ntotal;
+	vector<uint8_t> bitmap((static_cast<size_t>(ntotal) + 7) / 8, 0);
+	int64_t num_allowed = 0;
+	for (auto row_id : allowed_rowids) {
+		auto it = rowid_to_label_.find(row_id);
+		if (it == rowid_to_label_.end() || it->second >= ntotal) {
+			continue;
 		}
+		bitmap[it->second >> 3] |= static_cast<uint8_t>(1u << (it->second & 7));
+		num_allowed++;
+	}
+	if (num_allowed == 0) {
+		return {};
+	}
+	faiss::IDSelectorBitmap selector(bitmap.size(), bitmap.data());
+
+	auto request_k = static_cast<int32_t>(MinValue<int64_t>(k, num_allowed));
+	vector<faiss::idx_t> labels(request_k, -1);
+	vector<float> distances(request_k);
+
+	// Widen probing by the inverse selectivity so enough allowed vectors are visited.
+	// GPU indexes do not take search parameters, so filtered search always runs on the CPU index.
+	auto widen = [&](int64_t base) {
+		return MinValue<int64_t>(ntotal, MaxValue<int64_t>(base, 1) * ntotal / num_allowed);
+	};
+	if (auto *ivf = dynamic_cast<faiss::IndexIVF *>(faiss_index_.get())) {
+		faiss::SearchParametersIVF params;
+		params.sel = &selector;
+		auto nlist = static_cast<int64_t>(ivf->nlist);
+		params.nprobe = static_cast<size_t>(exhaustive ? nlist : MinValue<int64_t>(nlist, widen(NprobeFor(k))));
+		faiss_index_->search(1, query, request_k, distances.data(), labels.data(), &params);
+	} else if (auto *hnsw = dynamic_cast<faiss::IndexHNSW *>(faiss_index_.get())) {
+		faiss::SearchParametersHNSW params;
+		params.sel = &selector;
+		auto ef = MaxValue<int64_t>(hnsw->hnsw.efSearch, request_k);
+		params.efSearch = static_cast<int>(exhaustive ? ntotal : widen(ef));
+		faiss_index_->search(1, query, request_k, distances.data(), labels.data(), &params);
+	} else {
+		faiss::SearchParameters params;
+		params.sel = &selector;
+		faiss_index_->search(1, query, request_k, distances.data(), labels.data(), &params);
 	}
 
+	vector<pair<row_t, float>> results;
+	results.reserve(request_k);
+	for (int32_t i = 0; i < request_k; i++) {
+		auto label = labels[i];
+		if (label < 0 || label >= static_cast<int64_t>(label_to_rowid_.size())) {
+			continue;
+		}
+		results.emplace_back(label_to_rowid_[label], distances[i]);
+	}
 	return results;
 }
 
+vector<pair<row_t, float>> FaissIndex::SearchPartitions(
+    int32_t k, const std::function<vector<pair<row_t, float>>(FaissIndex &)> &search) {
+	auto start = AnnSearchStats::Clock::now();
+	auto partitions = Partitions();
+	vector<vector<pair<row_t, float>>> results(partitions.size());
+	auto tally = AnnSearchTally::Current();
+	AnnParallelFor(db.GetDatabase(), partitions.size(), [&](idx_t p) {
+		results[p] = AnnSearchTally::RunChild(tally, [&]() { return search(*partitions[p]); });
+	});
+	auto merged = AnnMergeTopK(results, static_cast<idx_t>(k), LargerIsNearer());
+	search_stats_.RecordSearch(1, AnnSearchStats::NanosSince(start), 0);
+	reservation_->Touch();
+	return merged;
+}
+
+vector<pair<row_t, float>> FaissIndex::SearchPartition(ClientContext &context, const Value &key, const float *query,
+                                                       int32_t dimension, int32_t k,
+                                                       const vector<row_t> *allowed_rowids, bool exhaustive) {
+	auto child = FindPartition(key);
+	if (!child || dimension != dimension_ || k <= 0) {
+		return {};
+	}
+	auto &index = *child;
+	auto nprobe = NprobeFor(k);
+	// Counted as a search of the parent: the child's counters only contribute the FAISS work
+	auto search = [&]() {
+		auto start = AnnSearchStats::Clock::now();
+		auto results = AnnSearchTally::RunChild(AnnSearchTally::Current(), [&]() {
+			return allowed_rowids ? index.SearchFiltered(query, dimension, k, *allowed_rowids, exhaustive)
+			                      : index.Search(query, dimension, k, nprobe);
+		});
+		search_stats_.RecordSearch(1, AnnSearchStats::NanosSince(start), 0);
+		reservation_->Touch();
+		return results;
+	};
+	if (allowed_rowids) {
+		return search();
+	}
+	return index.GetResultCache().Get(context, query, dimension, k, 0, nprobe, search);
+}
+
+bool FaissIndex::LargerIsNearer() const {
+	return ParseFaissMetric(metric_) == faiss::METRIC_INNER_PRODUCT;
+}
+
+AnnSearchCounters FaissIndex::GetSearchCounters() const {
+	auto counters = search_stats_.Snapshot();
+	for (auto *partition : Partitions()) {
+		// Latency is the parent's, over the whole fan-out; the work is the children's
+		counters.AddWork(partition->GetSearchCounters());
+	}
+	return counters;
+}
+
 // ========================================
 // Utility methods
 // ========================================
 
-idx_t FaissIndex::GetInMemorySize(IndexLock &state) {
-	idx_t size = sizeof(FaissIndex);
-	size += label_to_rowid_.size() * sizeof(row_t);
-	size += rowid_to_label_.size() * (sizeof(row_t) + sizeof(int64_t));
-	if (faiss_index_) {
-		// Estimate: vectors + overhead
-		size += faiss_index_->ntotal * dimension_ * sizeof(float);
+idx_t FaissIndex::GetVectorCount() const {
+	auto count = faiss_index_ ? static_cast<idx_t>(faiss_index_->ntotal) : 0;
+	for (auto *partition : Partitions()) {
+		count += partition->GetVectorCount();
+	}
+	return count;
+}
+
+idx_t FaissIndex::GetDeletedCount() const {
+	auto deleted = num_deleted_;
+	for (auto *partition : Partitions()) {
+		deleted += partition->GetDeletedCount();
+	}
+	return deleted;
+}
+
+int64_t FaissIndex::GetNlist() const {
+	auto partitions = Partitions();
+	if (!partitions.empty()) {
+		return partitions[0]->GetNlist();
+	}
+	auto *ivf = dynamic_cast<faiss::IndexIVF *>(faiss_index_.get());
+	return ivf ? static_cast<int64_t>(ivf->nlist) : 0;
+}
+
+vector<row_t> FaissIndex::GetLiveRowIds() const {
+	vector<row_t> row_ids;
+	row_ids.reserve(rowid_to_label_.size());
+	for (auto &entry : rowid_to_label_) {
+		row_ids.push_back(entry.first);
+	}
+	for (auto *partition : Partitions()) {
+		auto child = partition->GetLiveRowIds();
+		row_ids.insert(row_ids.end(), child.begin(), child.end());
+	}
+	std::sort(row_ids.begin(), row_ids.end());
+	return row_ids;
+}
+
+vector<float> FaissIndex::GetVectors(const vector<row_t> &row_ids) const {
+	vector<float> vectors(row_ids.size() * dimension_);
+	if (IsPartitioned()) {
+		// Ask each child for the rows it holds, then put them back in the caller's order
+		for (auto *partition : Partitions()) {
+			auto &child = *partition;
+			vector<idx_t> positions;
+			vector<row_t> held;
+			for (idx_t i = 0; i < row_ids.size(); i++) {
+				if (child.rowid_to_label_.count(row_ids[i])) {
+					positions.push_back(i);
+					held.push_back(row_ids[i]);
+				}
+			}
+			auto child_vectors = child.GetVectors(held);
+			for (idx_t j = 0; j < positions.size(); j++) {
+				std::copy_n(child_vectors.data() + j * dimension_, dimension_,
+				            vectors.data() + positions[j] * dimension_);
+			}
+		}
+		return vectors;
+	}
+	if (!faiss_index_) {
+		return vectors;
+	}
+	auto ivf = dynamic_cast<faiss::IndexIVF *>(faiss_index_.get());
+	if (!ivf) {
+		for (idx_t i = 0; i < row_ids.size(); i++) {
+			auto it = rowid_to_label_.find(row_ids[i]);
+			if (it != rowid_to_label_.end()) {
+				faiss_index_->reconstruct(it->second, vectors.data() + i * dimension_);
+			}
+		}
+		return vectors;
+	}
+	// IVF indexes keep no label -> list direct map, so reconstruct(label) throws. Find the
+	// requested labels by their ids in the lists and decode only those entries (IVFPQ
+	// returns the quantized vectors).
+	unordered_map<int64_t, vector<idx_t>> wanted;
+	for (idx_t i = 0; i < row_ids.size(); i++) {
+		auto it = rowid_to_label_.find(row_ids[i]);
+		if (it != rowid_to_label_.end()) {
+			wanted[it->second].push_back(i);
+		}
+	}
+	idx_t remaining = wanted.size();
+	for (size_t list_no = 0; list_no < ivf->nlist && remaining > 0; list_no++) {
+		auto list_size = ivf->invlists->list_size(list_no);
+		if (list_size == 0) {
+			continue;
+		}
+		faiss::InvertedLists::ScopedIds ids(ivf->invlists, list_no);
+		for (size_t offset = 0; offset < list_size && remaining > 0; offset++) {
+			auto it = wanted.find(ids[offset]);
+			if (it == wanted.end()) {
+				continue;
+			}
+			auto out = vectors.data() + it->second[0] * dimension_;
+			ivf->reconstruct_from_offset(static_cast<int64_t>(list_no), static_cast<int64_t>(offset), out);
+			for (idx_t j = 1; j < it->second.size(); j++) {
+				std::copy_n(out, dimension_, vectors.data() + it->second[j] * dimension_);
+			}
+			remaining--;
+		}
+	}
+	return vectors;
+}
+
+// Bytes FAISS holds for the index: its code arrays, graph and quantizers at their actual size
+static idx_t FaissHeapBytes(const faiss::Index &index) {
+	if (auto hnsw = dynamic_cast<const faiss::IndexHNSW *>(&index)) {
+		idx_t size = hnsw->hnsw.neighbors.size() * sizeof(faiss::HNSW::storage_idx_t);
+		size += hnsw->hnsw.offsets.size() * sizeof(size_t);
+		size += hnsw->hnsw.levels.size() * sizeof(int);
+		return size + (hnsw->storage ? FaissHeapBytes(*hnsw->storage) : 0);
+	}
+	if (auto ivf = dynamic_cast<const faiss::IndexIVF *>(&index)) {
+		// Every list entry is a code and its id
+		idx_t size = static_cast<idx_t>(ivf->ntotal) * (ivf->code_size + sizeof(faiss::idx_t));
+		size += ivf->quantizer ? FaissHeapBytes(*ivf->quantizer) : 0;
+		if (auto ivfpq = dynamic_cast<const faiss::IndexIVFPQ *>(&index)) {
+			size += ivfpq->pq.centroids.size() * sizeof(float);
+			size += ivfpq->precomputed_table.size() * sizeof(float);
+		}
+		return size;
+	}
+	if (auto codes = dynamic_cast<const faiss::IndexFlatCodes *>(&index)) {
+		return codes->codes.size();
 	}
+	return static_cast<idx_t>(index.ntotal) * index.d * sizeof(float);
+}
+
+idx_t FaissIndex::GetInMemorySize(IndexLock &state) {
+	idx_t size = sizeof(FaissIndex) + HeapBytes();
 	if (gpu_index_) {
-		// GPU copy uses roughly the same amount of memory
+		// Device memory, not reserved with the buffer manager: GPU copy uses roughly the same amount
 		size += faiss_index_ ? faiss_index_->ntotal * dimension_ * sizeof(float) : 0;
 	}
+	for (auto *partition : Partitions()) {
+		size += sizeof(FaissIndex) + partition->HeapBytes();
+	}
 	return size;
 }
 
+idx_t FaissIndex::HeapBytes() const {
+	idx_t size = label_to_rowid_.size() * sizeof(row_t);
+	size += rowid_to_label_.size() * (sizeof(row_t) + sizeof(int64_t));
+	size += tombstones_.size();
+	if (faiss_index_) {
+		size += FaissHeapBytes(*faiss_index_);
+	}
+	return size;
+}
+
+void FaissIndex::UpdateReservation(idx_t pending) {
+	reservation_->Update(HeapBytes() + pending);
+}
+
+idx_t FaissIndex::GetEvictions() const {
+	auto evictions = reservation_->Evictions();
+	for (auto *partition : Partitions()) {
+		evictions += partition->GetEvictions();
+	}
+	return evictions;
+}
+
 bool FaissIndex::MergeIndexes(IndexLock &state, BoundIndex &other_index) {
 	auto &other = other_index.Cast<FaissIndex>();
+	if (IsPartitioned()) {
+		// Merged partition by partition through AppendRows, which trains a child new to this index
+		std::shared_lock<std::shared_mutex> other_guard(other.partitions_lock_);
+		for (idx_t p = 0; p < other.partitions_.Size(); p++) {
+			auto &other_child = *other.partitions_.Get(p);
+			auto row_ids = other_child.GetLiveRowIds();
+			auto vectors = other_child.GetVectors(row_ids);
+			auto &child = GetOrCreatePartition(other.partitions_.Key(p));
+			child.AppendRows(vectors.data(), row_ids.data(), row_ids.size());
+		}
+		result_cache_.Invalidate();
+		return true;
+	}
 
 	if (!other.faiss_index_ || !faiss_index_) {
 		is_dirty_ = true;
@@ -805,7 +1781,7 @@ bool FaissIndex::MergeIndexes(IndexLock &state, BoundIndex &other_index) {
 	kept_rowids.reserve(other_ntotal);
 
 	for (int64_t label = 0; label < other_ntotal; label++) {
-		if (other.deleted_labels_.count(label) > 0) {
+		if (other.IsDeleted(label)) {
 			continue;
 		}
 		if (label >= static_cast<int64_t>(other.label_to_rowid_.size())) {
@@ -820,6 +1796,7 @@ bool FaissIndex::MergeIndexes(IndexLock &state, BoundIndex &other_index) {
 	if (!kept_rowids.empty()) {
 		auto base_label = faiss_index_->ntotal;
 		faiss_index_->add(static_cast<faiss::idx_t>(kept_rowids.size()), kept_vectors.data());
+		result_cache_.Invalidate();
 
 		auto new_size = base_label + static_cast<int64_t>(kept_rowids.size());
 		if (new_size > static_cast<int64_t>(label_to_rowid_.size())) {
@@ -834,17 +1811,24 @@ bool FaissIndex::MergeIndexes(IndexLock &state, BoundIndex &other_index) {
 
 	InvalidateGpuIndex();
 	is_dirty_ = true;
+	UpdateReservation();
 	return true;
 }
 
 void FaissIndex::Vacuum(IndexLock &state) {
-	if (deleted_labels_.empty() || !faiss_index_) {
+	for (auto *partition : Partitions()) {
+		auto &child = *partition;
+		IndexLock child_lock;
+		child.InitializeLock(child_lock);
+		child.Vacuum(child_lock);
+	}
+	if (num_deleted_ == 0 || !faiss_index_) {
 		return;
 	}
 
 	auto old_ntotal = faiss_index_->ntotal;
 	if (old_ntotal == 0) {
-		deleted_labels_.clear();
+		ClearTombstones();
 		return;
 	}
 
@@ -855,11 +1839,11 @@ void FaissIndex::Vacuum(IndexLock &state) {
 	// Build lists of surviving vectors
 	vector<float> kept_vectors;
 	vector<row_t> kept_rowids;
-	kept_vectors.reserve((old_ntotal - deleted_labels_.size()) * dimension_);
-	kept_rowids.reserve(old_ntotal - deleted_labels_.size());
+	kept_vectors.reserve((old_ntotal - num_deleted_) * dimension_);
+	kept_rowids.reserve(old_ntotal - num_deleted_);
 
 	for (int64_t i = 0; i < old_ntotal; i++) {
-		if (deleted_labels_.count(i) > 0) {
+		if (IsDeleted(i)) {
 			continue;
 		}
 		kept_vectors.insert(kept_vectors.end(), all_vectors.data() + i * dimension_,
@@ -870,9 +1854,9 @@ void FaissIndex::Vacuum(IndexLock &state) {
 	}
 
 	// Create fresh index with same parameters
-	auto new_index = MakeFaissIndex(dimension_, metric_, index_type_, description_, hnsw_m_, ivf_nlist_);
+	auto new_index = MakeFaissIndex(dimension_, CurrentParams());
 
-	// Train if needed (IVFFlat)
+	// Train if needed (IVF indexes)
 	if (!kept_vectors.empty() && !new_index->is_trained) {
 		new_index->train((faiss::idx_t)kept_rowids.size(), kept_vectors.data());
 	}
@@ -893,9 +1877,11 @@ void FaissIndex::Vacuum(IndexLock &state) {
 
 	// Swap in new index
 	faiss_index_ = std::move(new_index);
-	deleted_labels_.clear();
+	ClearTombstones();
 	InvalidateGpuIndex();
+	result_cache_.Invalidate();
 	is_dirty_ = true;
+	UpdateReservation();
 }
 
 #ifdef DUCKDB_API_V15
@@ -903,15 +1889,23 @@ void FaissIndex::Verify(IndexLock &state) {
 }
 
 string FaissIndex::ToString(IndexLock &state, bool display_ascii) {
-	auto count = faiss_index_ ? faiss_index_->ntotal : 0;
+	auto count = static_cast<int64_t>(GetVectorCount());
 	const char *mode_str = mode_ == FaissGpuMode::GPU ? "gpu" : mode_ == FaissGpuMode::AUTO ? "auto" : "cpu";
+	if (IsPartitioned()) {
+		return StringUtil::Format("FAISS Index %s (type=%s, dim=%d, vectors=%lld, metric=%s, mode=%s, partitions=%llu)",
+		                          name, index_type_, dimension_, count, metric_, mode_str, GetPartitionCount());
+	}
 	return StringUtil::Format("FAISS Index %s (type=%s, dim=%d, vectors=%lld, metric=%s, mode=%s)", name, index_type_,
 	                          dimension_, count, metric_, mode_str);
 }
 #else
 string FaissIndex::VerifyAndToString(IndexLock &state, const bool only_verify) {
-	auto count = faiss_index_ ? faiss_index_->ntotal : 0;
+	auto count = static_cast<int64_t>(GetVectorCount());
 	const char *mode_str = mode_ == FaissGpuMode::GPU ? "gpu" : mode_ == FaissGpuMode::AUTO ? "auto" : "cpu";
+	if (IsPartitioned()) {
+		return StringUtil::Format("FAISS Index %s (type=%s, dim=%d, vectors=%lld, metric=%s, mode=%s, partitions=%llu)",
+		                          name, index_type_, dimension_, count, metric_, mode_str, GetPartitionCount());
+	}
 	return StringUtil::Format("FAISS Index %s (type=%s, dim=%d, vectors=%lld, metric=%s, mode=%s)", name, index_type_,
 	                          dimension_, count, metric_, mode_str);
 }
@@ -29,7 +29,7 @@ public:
 	}
 };
 
-#ifndef FAISS_METAL_ENABLED
+#if !defined(FAISS_METAL_ENABLED) && !defined(FAISS_CUDA_ENABLED)
 // When no GPU backend is compiled, return CPU fallback
 GpuBackend &GetGpuBackend() {
 	static CpuGpuBackend instance;
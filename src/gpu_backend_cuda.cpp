@@ -0,0 +1,169 @@
+#ifdef FAISS_AVAILABLE
+
+#include "gpu_backend.hpp"
+
+#ifdef FAISS_CUDA_ENABLED
+
+#include "faiss_wrapper.hpp"
+
+#include <faiss/IndexIVFPQ.h>
+#include <faiss/gpu/GpuCloner.h>
+#include <faiss/gpu/GpuClonerOptions.h>
+#include <faiss/gpu/StandardGpuResources.h>
+#include <faiss/gpu/utils/DeviceUtils.h>
+#include <faiss/impl/FaissException.h>
+
+#include <cuda_runtime_api.h>
+
+#include <stdexcept>
+#include <vector>
+
+namespace duckdb {
+
+/// CUDA backend on faiss's GPU module: GpuIndexFlat, GpuIndexIVFFlat and GpuIndexIVFPQ.
+/// Flat indexes are spread over every visible GPU: sharded when one device cannot hold
+/// the vectors, replicated otherwise (each replica serves whole searches).
+class CudaGpuBackend : public GpuBackend {
+public:
+	CudaGpuBackend() {
+		try {
+			auto count = faiss::gpu::getNumDevices();
+			for (int device = 0; device < count; device++) {
+				resources_.push_back(std::make_shared<faiss::gpu::StandardGpuResources>());
+				devices_.push_back(device);
+				cudaDeviceProp props;
+				if (cudaGetDeviceProperties(&props, device) == cudaSuccess) {
+					names_.emplace_back(props.name);
+				} else {
+					names_.emplace_back("unknown");
+				}
+			}
+		} catch (...) {
+			resources_.clear();
+			devices_.clear();
+			names_.clear();
+		}
+	}
+
+	bool IsAvailable() const override {
+		return !devices_.empty();
+	}
+
+	std::string DeviceInfo() const override {
+		if (devices_.empty()) {
+			return "CUDA: no device available";
+		}
+		std::string info = "CUDA GPU (";
+		for (size_t i = 0; i < names_.size(); i++) {
+			info += (i > 0 ? ", " : "") + names_[i];
+		}
+		return info + ")";
+	}
+
+	std::string BackendName() const override {
+		return "cuda";
+	}
+
+	int DeviceCount() const override {
+		return static_cast<int>(devices_.size());
+	}
+
+	bool WorthOffloading(int64_t ntotal, int32_t dimension) const override {
+		// Vectors stay resident in device memory; only queries cross PCIe, so the
+		// break-even is lower than Metal's but kernel launches still need enough work
+		return ntotal >= 1024 && ntotal * dimension >= 262144;
+	}
+
+	int64_t MaxSearchK() const override {
+		// faiss GPU k-selection limit (GPU_MAX_SELECTION_K)
+		return 2048;
+	}
+
+	void SetNprobe(faiss::Index *gpu_index, size_t nprobe) const override {
+		// GpuIndexIVFFlat and GpuIndexIVFPQ both implement IndexIVFInterface
+		if (auto *gpu_ivf = dynamic_cast<faiss::IndexIVFInterface *>(gpu_index)) {
+			gpu_ivf->nprobe = nprobe;
+		}
+	}
+
+	bool AddToGpu(faiss::Index *gpu_index, faiss::idx_t n, const float *x) const override {
+		// GPU indexes and IndexReplicas append from ntotal; IndexShards without
+		// successive ids reject add(), which falls back to a fresh upload
+		try {
+			gpu_index->add(n, x);
+			return true;
+		} catch (faiss::FaissException &) {
+			return false;
+		}
+	}
+
+	std::unique_ptr<faiss::Index> CpuToGpu(faiss::Index *cpu_index) override {
+		if (devices_.empty()) {
+			throw std::runtime_error("CUDA GPU backend not available");
+		}
+		bool is_flat = dynamic_cast<faiss::IndexFlat *>(cpu_index) != nullptr;
+		// IndexIVFScalarQuantizer (IVFFlat with precision = 'f16') uploads its fp16 codes as they are
+		if (!is_flat && !dynamic_cast<faiss::IndexIVFFlat *>(cpu_index) &&
+		    !dynamic_cast<faiss::IndexIVFPQ *>(cpu_index) &&
+		    !dynamic_cast<faiss::IndexIVFScalarQuantizer *>(cpu_index)) {
+			throw std::runtime_error("CUDA GPU supports IndexFlat, IndexIVFFlat, IndexIVFScalarQuantizer and "
+			                         "IndexIVFPQ. Got an unsupported index type.");
+		}
+
+		try {
+			if (is_flat && devices_.size() > 1) {
+				faiss::gpu::GpuMultipleClonerOptions options;
+				options.shard = !FitsOnOneDevice(*cpu_index);
+				std::vector<faiss::gpu::GpuResourcesProvider *> providers;
+				for (auto &res : resources_) {
+					providers.push_back(res.get());
+				}
+				auto devices = devices_;
+				return std::unique_ptr<faiss::Index>(
+				    faiss::gpu::index_cpu_to_gpu_multiple(providers, devices, cpu_index, &options));
+			}
+			faiss::gpu::GpuClonerOptions options;
+			return std::unique_ptr<faiss::Index>(
+			    faiss::gpu::index_cpu_to_gpu(resources_[0].get(), devices_[0], cpu_index, &options));
+		} catch (faiss::FaissException &e) {
+			throw std::runtime_error(e.what());
+		}
+	}
+
+	std::unique_ptr<faiss::Index> GpuToCpu(faiss::Index *gpu_index) override {
+		try {
+			// Also unwraps the IndexShards / IndexReplicas of a multi-GPU flat index
+			return std::unique_ptr<faiss::Index>(faiss::gpu::index_gpu_to_cpu(gpu_index));
+		} catch (faiss::FaissException &e) {
+			throw std::runtime_error(std::string("Index is not a CUDA index -- cannot convert to CPU: ") + e.what());
+		}
+	}
+
+private:
+	// Vectors of a flat index take at most half of the first device's free memory,
+	// leaving room for query and distance buffers
+	bool FitsOnOneDevice(const faiss::Index &index) const {
+		size_t free_bytes = 0;
+		size_t total_bytes = 0;
+		if (cudaSetDevice(devices_[0]) != cudaSuccess || cudaMemGetInfo(&free_bytes, &total_bytes) != cudaSuccess) {
+			return true;
+		}
+		auto bytes = static_cast<size_t>(index.ntotal) * static_cast<size_t>(index.d) * sizeof(float);
+		return bytes <= free_bytes / 2;
+	}
+
+	std::vector<std::shared_ptr<faiss::gpu::StandardGpuResources>> resources_;
+	std::vector<int> devices_;
+	std::vector<std::string> names_;
+};
+
+GpuBackend &GetGpuBackend() {
+	static CudaGpuBackend instance;
+	return instance;
+}
+
+} // namespace duckdb
+
+#endif // FAISS_CUDA_ENABLED
+
+#endif // FAISS_AVAILABLE
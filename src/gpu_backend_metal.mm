@@ -8,8 +8,11 @@
 
 #include <faiss-metal/MetalIndexFlat.h>
 #include <faiss-metal/MetalIndexIVFFlat.h>
+#include <faiss-metal/MetalIndexIVFPQ.h>
 #include <faiss-metal/StandardMetalResources.h>
 
+#include <algorithm>
+
 namespace duckdb {
 
 class MetalGpuBackend : public GpuBackend {
@@ -44,27 +47,74 @@ class MetalGpuBackend : public GpuBackend {
             throw std::runtime_error("Metal GPU backend not available");
         }
 
-        // Try IndexIVFFlat first (it also contains an IndexFlat quantizer)
+        // Try the IVF types first (they also contain an IndexFlat quantizer)
         auto *ivfflat = dynamic_cast<faiss::IndexIVFFlat *>(cpu_index);
         if (ivfflat) {
             return faiss_metal::index_cpu_to_metal_ivf(resources_, ivfflat);
         }
 
+        auto *ivfpq = dynamic_cast<faiss::IndexIVFPQ *>(cpu_index);
+        if (ivfpq) {
+            if (ivfpq->pq.nbits != 8) {
+                throw std::runtime_error("Metal GPU supports IndexIVFPQ with pq_nbits=8 only.");
+            }
+            return faiss_metal::index_cpu_to_metal_ivfpq(resources_, ivfpq);
+        }
+
         auto *flat = dynamic_cast<faiss::IndexFlat *>(cpu_index);
         if (flat) {
             return faiss_metal::index_cpu_to_metal(resources_, flat);
         }
 
-        throw std::runtime_error("Metal GPU supports IndexFlat and IndexIVFFlat. "
+        throw std::runtime_error("Metal GPU supports IndexFlat, IndexIVFFlat and IndexIVFPQ. "
                                  "Got an unsupported index type.");
     }
 
+    void SetNprobe(faiss::Index *gpu_index, size_t nprobe) const override {
+        // Metal IVF indexes reject nprobe > nlist, unlike faiss::IndexIVF which clamps
+        if (auto *metal_ivf = dynamic_cast<faiss_metal::MetalIndexIVFFlat *>(gpu_index)) {
+            metal_ivf->setNprobe(std::min(nprobe, metal_ivf->getNlist()));
+        } else if (auto *metal_ivfpq = dynamic_cast<faiss_metal::MetalIndexIVFPQ *>(gpu_index)) {
+            metal_ivfpq->setNprobe(std::min(nprobe, metal_ivfpq->getNlist()));
+        }
+    }
+
+    bool AddToGpu(faiss::Index *gpu_index, faiss::idx_t n, const float *x) const override {
+        // Every Metal index numbers appended vectors from ntotal, like the CPU indexes.
+        // MetalIndexFlat grows its device buffers by doubling; IVF lists grow in place.
+        if (!dynamic_cast<faiss_metal::MetalIndexFlat *>(gpu_index) &&
+            !dynamic_cast<faiss_metal::MetalIndexIVFFlat *>(gpu_index) &&
+            !dynamic_cast<faiss_metal::MetalIndexIVFPQ *>(gpu_index)) {
+            return false;
+        }
+        gpu_index->add(n, x);
+        return true;
+    }
+
+    bool RemoveFromGpu(faiss::Index *gpu_index, const faiss::idx_t *labels, size_t n) const override {
+        // IVF lists drop the entries; a flat index keeps them (its labels are row offsets)
+        if (auto *metal_ivf = dynamic_cast<faiss_metal::MetalIndexIVFFlat *>(gpu_index)) {
+            metal_ivf->removeIds(n, labels);
+            return true;
+        }
+        if (auto *metal_ivfpq = dynamic_cast<faiss_metal::MetalIndexIVFPQ *>(gpu_index)) {
+            metal_ivfpq->removeIds(n, labels);
+            return true;
+        }
+        return false;
+    }
+
     std::unique_ptr<faiss::Index> GpuToCpu(faiss::Index *gpu_index) override {
         auto *metal_ivf = dynamic_cast<faiss_metal::MetalIndexIVFFlat *>(gpu_index);
         if (metal_ivf) {
             return faiss_metal::index_metal_to_cpu_ivf(metal_ivf);
         }
 
+        auto *metal_ivfpq = dynamic_cast<faiss_metal::MetalIndexIVFPQ *>(gpu_index);
+        if (metal_ivfpq) {
+            return faiss_metal::index_metal_to_cpu_ivfpq(metal_ivfpq);
+        }
+
         auto *metal_flat = dynamic_cast<faiss_metal::MetalIndexFlat *>(gpu_index);
         if (metal_flat) {
             return faiss_metal::index_metal_to_cpu(metal_flat);
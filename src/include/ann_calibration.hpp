@@ -0,0 +1,87 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/mutex.hpp"
+
+namespace duckdb {
+
+// ========================================
+// AnnCalibration: recall-calibrated search parameter per k bucket
+// ========================================
+// Written by ann_calibrate (search_complexity for DISKANN, nprobe for FAISS IVF), used by
+// every search that does not pass its own value. Persisted in the index storage options,
+// so it needs no storage format change and survives a restart.
+
+class AnnCalibration {
+public:
+	static constexpr auto OPTION_NAME = "ann_calibration";
+
+	// (k, value) pairs ascending by k
+	void Set(vector<pair<int32_t, int32_t>> points_p) {
+		lock_guard<mutex> guard(lock_);
+		points_ = std::move(points_p);
+	}
+
+	// Value for k: the smallest calibrated bucket >= k, scaled linearly past the largest.
+	// 0 when the index was never calibrated.
+	int32_t For(int32_t k) const {
+		lock_guard<mutex> guard(lock_);
+		if (points_.empty()) {
+			return 0;
+		}
+		for (auto &point : points_) {
+			if (k <= point.first) {
+				return point.second;
+			}
+		}
+		auto &last = points_.back();
+		auto scaled = static_cast<int64_t>(last.second) * k / MaxValue<int32_t>(last.first, 1);
+		return static_cast<int32_t>(MinValue<int64_t>(scaled, NumericLimits<int32_t>::Maximum()));
+	}
+
+	// "k:value,..." for ann_index_info, empty when uncalibrated
+	string ToString() const {
+		lock_guard<mutex> guard(lock_);
+		string result;
+		for (auto &point : points_) {
+			if (!result.empty()) {
+				result += ",";
+			}
+			result += std::to_string(point.first) + ":" + std::to_string(point.second);
+		}
+		return result;
+	}
+
+	// Flat LIST(INTEGER) of k, value pairs; nothing is written for an uncalibrated index
+	void Serialize(case_insensitive_map_t<Value> &options) const {
+		lock_guard<mutex> guard(lock_);
+		if (points_.empty()) {
+			return;
+		}
+		vector<Value> values;
+		for (auto &point : points_) {
+			values.push_back(Value::INTEGER(point.first));
+			values.push_back(Value::INTEGER(point.second));
+		}
+		options[OPTION_NAME] = Value::LIST(LogicalType::INTEGER, std::move(values));
+	}
+
+	void Deserialize(const case_insensitive_map_t<Value> &options) {
+		auto entry = options.find(OPTION_NAME);
+		if (entry == options.end() || entry->second.IsNull()) {
+			return;
+		}
+		auto &values = ListValue::GetChildren(entry->second);
+		vector<pair<int32_t, int32_t>> points;
+		for (idx_t i = 0; i + 1 < values.size(); i += 2) {
+			points.emplace_back(values[i].GetValue<int32_t>(), values[i + 1].GetValue<int32_t>());
+		}
+		Set(std::move(points));
+	}
+
+private:
+	mutable mutex lock_;
+	vector<pair<int32_t, int32_t>> points_;
+};
+
+} // namespace duckdb
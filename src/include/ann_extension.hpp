@@ -14,6 +14,7 @@ public:
 // DiskANN function registration (always available)
 void RegisterDiskannIndexScanFunction(ExtensionLoader &loader);
 void RegisterDiskannStreamingBuildFunction(ExtensionLoader &loader);
+void RegisterDiskannConsolidateFunction(ExtensionLoader &loader);
 
 // Convenience search (works with both DISKANN and FAISS indexes)
 void RegisterAnnSearchFunction(ExtensionLoader &loader);
@@ -21,6 +22,12 @@ void RegisterAnnSearchFunction(ExtensionLoader &loader);
 // Unified listing
 void RegisterAnnListFunction(ExtensionLoader &loader);
 
+// Per-index search counters
+void RegisterAnnIndexStatsFunction(ExtensionLoader &loader);
+
+// Recall-targeted tuning of search_complexity / nprobe
+void RegisterAnnCalibrateFunction(ExtensionLoader &loader);
+
 // Optimizer: ORDER BY array_distance(...) LIMIT k → ANN index scan
 void RegisterAnnOptimizer(DatabaseInstance &db);
 
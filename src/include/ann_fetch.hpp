@@ -0,0 +1,27 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/types/data_chunk.hpp"
+#include "duckdb/common/types/selection_vector.hpp"
+#include "duckdb/storage/storage_index.hpp"
+
+namespace duckdb {
+
+class DataTable;
+
+// Late materialization for the ANN scans: fetch the table rows of row_ids[0, count)
+// straight into output columns out_cols (storage_ids[i] lands in out_cols[i]), in
+// row_ids order. Rows are fetched sorted by row id for row-group locality and put
+// back in order through a selection vector, so no value is copied one by one.
+// Returns the number of rows written; kept receives, per output row, its position
+// in row_ids (rows this transaction can no longer see are dropped).
+idx_t AnnFetchRows(ClientContext &context, DataTable &storage, const vector<StorageIndex> &storage_ids,
+                   const vector<idx_t> &out_cols, const row_t *row_ids, idx_t count, DataChunk &output,
+                   SelectionVector &kept);
+
+// Query vectors of column col_idx (LIST or ARRAY of a numeric type) of input, one per
+// row, read straight from the child vector (cast to FLOAT first when it is another type);
+// a NULL row yields an empty vector and NULL elements read as 0.
+vector<vector<float>> AnnExtractVectors(DataChunk &input, idx_t col_idx);
+
+} // namespace duckdb
@@ -0,0 +1,45 @@
+#pragma once
+
+#include "duckdb.hpp"
+
+#include <functional>
+
+namespace duckdb {
+
+// ========================================
+// AnnMemoryReservation: an index's heap, accounted in DuckDB's buffer manager
+// ========================================
+// The Rust provider and FAISS allocate outside DuckDB's allocator, so memory_limit does not
+// see them. Each bound index reserves its resident size with the buffer manager, which evicts
+// or spills its own buffers to make room and raises an out-of-memory error instead of letting
+// the process overcommit. When a reservation cannot be granted, the least recently searched
+// indexes of the same database are asked to release what they can reload from storage (for
+// DiskANN: their vectors, faulted back in through the page loader), and the reservation is
+// retried before the error is raised.
+
+class AnnMemoryReservation {
+public:
+	// release: drop what the index can reload on demand and return the bytes freed. It runs on
+	// the thread of another index's reservation, so it must not block on its own index lock
+	AnnMemoryReservation(DatabaseInstance &db, std::function<idx_t()> release);
+	~AnnMemoryReservation();
+
+	// Account bytes in total for this index; throws OutOfMemoryException when even releasing
+	// cold indexes leaves no room
+	void Update(idx_t bytes);
+	// Return the reservation and stop taking part in eviction (first thing an index destructor does)
+	void Close();
+	// A search used the index
+	void Touch();
+
+	idx_t Reserved() const;
+	// Times this index released memory for another one
+	idx_t Evictions() const;
+
+	struct State;
+
+private:
+	shared_ptr<State> state_;
+};
+
+} // namespace duckdb
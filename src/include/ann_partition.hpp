@@ -0,0 +1,122 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/storage/index_storage_info.hpp"
+#include "linked_block_storage.hpp"
+
+#include <functional>
+#include <unordered_map>
+
+namespace duckdb {
+
+class DatabaseInstance;
+
+// ========================================
+// Partitioned ANN indexes (partition_by)
+// ========================================
+// CREATE INDEX ... USING DISKANN (embedding, tenant_id) WITH (partition_by = 'tenant_id') keeps
+// one child index of the same engine per value of the index's second column. The parent holds
+// no vectors itself: appends and deletes are routed to the child of their key, a query filtering
+// on the key searches that child alone, and any other query searches every child on DuckDB's
+// worker threads and merges their top k.
+
+// Lookup key of a partition value; NULL is a partition of its own
+string AnnPartitionKey(const Value &value);
+
+// with partition_by set: the index columns must be the vector column, then the partition column
+void AnnCheckPartitionColumns(const string &engine, const string &partition_by,
+                              const vector<unique_ptr<Expression>> &expressions);
+
+// Entries by partition value, in first-seen order. Pointers from Find / GetOrCreate stay
+// valid until the next entry is created.
+template <class T>
+class AnnPartitionMap {
+public:
+	idx_t Size() const {
+		return values_.size();
+	}
+	bool Empty() const {
+		return values_.empty();
+	}
+	const Value &Key(idx_t i) const {
+		return keys_[i];
+	}
+	T &Get(idx_t i) {
+		return values_[i];
+	}
+	const T &Get(idx_t i) const {
+		return values_[i];
+	}
+	T *Find(const Value &key) {
+		auto entry = lookup_.find(AnnPartitionKey(key));
+		return entry == lookup_.end() ? nullptr : &values_[entry->second];
+	}
+	const T *Find(const Value &key) const {
+		auto entry = lookup_.find(AnnPartitionKey(key));
+		return entry == lookup_.end() ? nullptr : &values_[entry->second];
+	}
+	// The entry of key, default-constructed on first use
+	T &GetOrCreate(const Value &key) {
+		auto entry = lookup_.emplace(AnnPartitionKey(key), values_.size());
+		if (entry.second) {
+			keys_.push_back(key);
+			values_.emplace_back();
+		}
+		return values_[entry.first->second];
+	}
+	void Clear() {
+		keys_.clear();
+		values_.clear();
+		lookup_.clear();
+	}
+
+private:
+	vector<Value> keys_;
+	vector<T> values_;
+	std::unordered_map<string, idx_t> lookup_;
+};
+
+// Rows of one partition: vectors row-major, row ids in the same order
+struct AnnPartitionRows {
+	vector<float> vectors;
+	vector<row_t> row_ids;
+};
+
+// Group count rows by their value in keys, taking the row ids and, when given, the rows of a
+// FLOAT[N] vectors column along
+void AnnGroupByPartition(Vector &keys, Vector &row_ids, idx_t count, AnnPartitionMap<AnnPartitionRows> &out,
+                         Vector *vectors = nullptr);
+// Move the rows of every partition of rows into out (a CREATE INDEX sink's Combine)
+void AnnMergePartitionRows(AnnPartitionMap<AnnPartitionRows> &out, AnnPartitionMap<AnnPartitionRows> &rows);
+
+// body(0) ... body(n - 1) on the database's TaskScheduler, the calling thread working on them too
+void AnnParallelFor(DatabaseInstance &db, idx_t n, const std::function<void(idx_t)> &body);
+
+// k-way merge of per-partition results, each ordered nearest first, into the k nearest overall.
+// descending: larger is nearer (FAISS inner product similarities).
+vector<pair<row_t, float>> AnnMergeTopK(vector<vector<pair<row_t, float>>> &lists, idx_t k, bool descending = false);
+
+// Directory in a partitioned index's root chain: per partition its value and the root of its
+// child index. The children's allocators follow the parent's in the storage info, in this order.
+struct AnnPartitionEntry {
+	Value key;
+	idx_t root;
+};
+void AnnWritePartitionDirectory(LinkedBlockWriter &writer, const vector<AnnPartitionEntry> &entries);
+vector<AnnPartitionEntry> AnnReadPartitionDirectory(LinkedBlockReader &reader, const LogicalType &key_type);
+
+// The children's storage collected for a checkpoint or WAL record. Children without a root
+// (nothing to store) are left out of the directory.
+struct AnnPartitionStorage {
+	vector<AnnPartitionEntry> directory;
+	vector<IndexStorageInfo> children;
+
+	void Add(const Value &key, IndexStorageInfo child);
+	// Append the children's allocators (and WAL buffers) to the parent's info, after its own
+	void AppendTo(IndexStorageInfo &info);
+	// Storage info of the i-th directory entry of a loaded parent
+	static IndexStorageInfo ChildInfo(const IndexStorageInfo &info, idx_t i, idx_t root,
+	                                  const case_insensitive_map_t<Value> &options);
+};
+
+} // namespace duckdb
@@ -0,0 +1,78 @@
+#pragma once
+
+#include "ann_search_stats.hpp"
+#include "duckdb.hpp"
+#include "duckdb/common/error_data.hpp"
+#include "duckdb/common/mutex.hpp"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+
+namespace duckdb {
+
+// ========================================
+// AnnQueryBatcher: per-index micro-batching of concurrent single-query searches
+// ========================================
+// Opt-in via ann_batch_window_us (0 = off). The first query to arrive opens a batch and
+// becomes its leader; queries with the same k / search_complexity from other connections
+// join it. The leader waits up to the window (or until ann_batch_max_queries joined), runs
+// the whole batch as one lock-step SearchBatch (where the GPU path pays off) and hands each
+// waiting caller its own results and an equal share of the batch's search work in its
+// AnnSearchTally. There is no background thread.
+
+class AnnQueryBatcher {
+public:
+	using Results = vector<pair<row_t, float>>;
+	using BatchSearch = std::function<vector<Results>(const vector<vector<float>> &queries, int32_t k,
+	                                                  int32_t search_complexity)>;
+
+	struct Config {
+		idx_t window_us = 0;
+		idx_t max_queries = 0;
+	};
+	static Config Configured(ClientContext &context);
+
+	// Results of search() when batching is off, else of this query's slot in a shared batch
+	template <class SEARCH>
+	Results Search(ClientContext &context, const float *query, int32_t dimension, int32_t k, int32_t search_complexity,
+	               SEARCH &&search, const BatchSearch &batch_search) {
+		auto config = Configured(context);
+		if (config.window_us == 0 || config.max_queries <= 1) {
+			return search();
+		}
+		return Submit(config, query, dimension, k, search_complexity, batch_search);
+	}
+
+	// Batches run and the queries they carried
+	idx_t Batches() const {
+		return batches_.load();
+	}
+	idx_t BatchedQueries() const {
+		return batched_queries_.load();
+	}
+
+private:
+	struct Batch {
+		int32_t dimension;
+		int32_t k;
+		int32_t search_complexity;
+		vector<vector<float>> queries;
+		vector<AnnSearchTally *> tallies; // each caller's, parallel to queries
+		vector<Results> results;
+		ErrorData error; // the leader's search failed: every caller rethrows it
+		bool done = false;
+		std::condition_variable cv;
+	};
+
+	Results Submit(const Config &config, const float *query, int32_t dimension, int32_t k, int32_t search_complexity,
+	               const BatchSearch &batch_search);
+
+	mutex lock_;
+	// Batches still accepting queries, at most one per (dimension, k, search_complexity)
+	vector<shared_ptr<Batch>> open_;
+	std::atomic<idx_t> batches_ {0};
+	std::atomic<idx_t> batched_queries_ {0};
+};
+
+} // namespace duckdb
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/mutex.hpp"
+
+#include <atomic>
+#include <list>
+#include <unordered_map>
+
+namespace duckdb {
+
+// ========================================
+// AnnResultCache: per-index LRU cache of single-query search results
+// ========================================
+// Used by ann_search and the optimizer's index scan; sized by the ann_result_cache_size
+// setting (cached queries per index, 0 = off). Entries are keyed on the exact query vector
+// and search parameters. Any write to the index calls Invalidate(), which clears the cache
+// and bumps its generation so a search that raced the write is not cached either.
+
+class AnnResultCache {
+public:
+	using Results = vector<pair<row_t, float>>;
+
+	static idx_t ConfiguredCapacity(ClientContext &context);
+
+	// Cached results for this query, else the results of search(), cached for next time
+	template <class SEARCH>
+	Results Get(ClientContext &context, const float *query, int32_t dimension, int32_t k, int32_t search_complexity,
+	            int32_t nprobe, SEARCH &&search) {
+		auto capacity = ConfiguredCapacity(context);
+		if (capacity == 0) {
+			return search();
+		}
+		Key key(query, dimension, k, search_complexity, nprobe);
+		Results results;
+		uint64_t generation;
+		if (Lookup(key, capacity, results, generation)) {
+			return results;
+		}
+		results = search();
+		Insert(std::move(key), generation, results);
+		return results;
+	}
+
+	// The index changed: every cached result is stale
+	void Invalidate();
+
+	idx_t Hits() const {
+		return hits_.load();
+	}
+	idx_t Misses() const {
+		return misses_.load();
+	}
+
+private:
+	struct Key {
+		Key(const float *query, int32_t dimension, int32_t k, int32_t search_complexity, int32_t nprobe);
+
+		vector<float> query;
+		int32_t k;
+		int32_t search_complexity;
+		int32_t nprobe;
+		hash_t hash;
+
+		bool operator==(const Key &other) const {
+			return k == other.k && search_complexity == other.search_complexity && nprobe == other.nprobe &&
+			       query == other.query;
+		}
+	};
+	struct Entry {
+		Key key;
+		Results results;
+	};
+
+	bool Lookup(const Key &key, idx_t capacity, Results &results, uint64_t &generation);
+	void Insert(Key key, uint64_t generation, const Results &results);
+	void EvictTo(idx_t capacity);
+
+	mutex lock_;
+	std::list<Entry> lru_; // most recently used first
+	std::unordered_map<hash_t, std::list<Entry>::iterator> entries_;
+	idx_t capacity_ = 0;
+	uint64_t generation_ = 0;
+	std::atomic<idx_t> hits_ {0};
+	std::atomic<idx_t> misses_ {0};
+};
+
+} // namespace duckdb
@@ -0,0 +1,247 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/common/atomic.hpp"
+#include "duckdb/common/insertion_order_preserving_map.hpp"
+#include "duckdb/common/mutex.hpp"
+
+#include <array>
+#include <chrono>
+
+namespace duckdb {
+
+class BoundIndex;
+
+// ========================================
+// AnnSearchStats: per-index search instrumentation
+// ========================================
+// Read by ann_index_stats(). The index's search paths record each call with relaxed atomics:
+// query count, per-query latency and the time spent in the engine (the Rust FFI call for
+// DISKANN, the FAISS search call for FAISS). DISKANN counts its traversal (distances, hops,
+// tombstones...) inside the Rust provider and merges it in when the counters are read; FAISS
+// adds its own here. Every record also goes to the calling thread's AnnSearchTally, if any.
+
+struct AnnSearchCounters {
+	// Per-query latency: bucket b counts [2^b, 2^(b+1)) microseconds, b = 0 also below 1us
+	static constexpr idx_t LATENCY_BUCKETS = 24;
+
+	uint64_t searches = 0;
+	uint64_t distance_computations = 0;
+	uint64_t hops = 0;
+	uint64_t visited = 0;
+	uint64_t deleted_filtered = 0;
+	uint64_t gpu_dispatches = 0;
+	uint64_t cpu_dispatches = 0;
+	uint64_t engine_nanos = 0;
+	std::array<uint64_t, LATENCY_BUCKETS> latency_histogram {};
+
+	// The work of `other` (traversal and engine time, not its searches or latency): a partition
+	// child's, counted under the parent's search
+	void AddWork(const AnnSearchCounters &other) {
+		distance_computations += other.distance_computations;
+		hops += other.hops;
+		visited += other.visited;
+		deleted_filtered += other.deleted_filtered;
+		gpu_dispatches += other.gpu_dispatches;
+		cpu_dispatches += other.cpu_dispatches;
+		engine_nanos += other.engine_nanos;
+	}
+
+	void Add(const AnnSearchCounters &other) {
+		AddWork(other);
+		searches += other.searches;
+		for (idx_t b = 0; b < LATENCY_BUCKETS; b++) {
+			latency_histogram[b] += other.latency_histogram[b];
+		}
+	}
+
+	// Share `i` of `n` equal shares of every counter; the n shares add up to the whole
+	AnnSearchCounters Share(idx_t i, idx_t n) const {
+		auto part = [&](uint64_t value) { return value / n + (i < value % n ? 1 : 0); };
+		AnnSearchCounters share;
+		share.searches = part(searches);
+		share.distance_computations = part(distance_computations);
+		share.hops = part(hops);
+		share.visited = part(visited);
+		share.deleted_filtered = part(deleted_filtered);
+		share.gpu_dispatches = part(gpu_dispatches);
+		share.cpu_dispatches = part(cpu_dispatches);
+		share.engine_nanos = part(engine_nanos);
+		for (idx_t b = 0; b < LATENCY_BUCKETS; b++) {
+			share.latency_histogram[b] = part(latency_histogram[b]);
+		}
+		return share;
+	}
+
+	// Upper bound in microseconds of the bucket holding the q-quantile, 0 without searches
+	double LatencyQuantileMicros(double q) const {
+		uint64_t total = 0;
+		for (auto count : latency_histogram) {
+			total += count;
+		}
+		if (total == 0) {
+			return 0;
+		}
+		auto rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+		uint64_t seen = 0;
+		for (idx_t b = 0; b < LATENCY_BUCKETS; b++) {
+			seen += latency_histogram[b];
+			if (seen >= rank) {
+				return static_cast<double>(uint64_t(1) << (b + 1));
+			}
+		}
+		return static_cast<double>(uint64_t(1) << LATENCY_BUCKETS);
+	}
+};
+
+// ========================================
+// AnnSearchTally: the counters of one operator's searches (EXPLAIN ANALYZE)
+// ========================================
+// The operator installs a tally with a Scope around its search calls. Whatever the index
+// records on that thread meanwhile is added to it as well, Rust traversal included (taken
+// from the Rust thread tally after each call). Work handed to other threads carries the tally
+// along: partition fan-out adds each child's work, and a coalesced batch gives every caller
+// its share. Searches other queries run on the same index at the same time never show up.
+
+class AnnSearchTally {
+public:
+	class Scope {
+	public:
+		explicit Scope(AnnSearchTally *tally) : previous(Slot()) {
+			Slot() = tally;
+		}
+		~Scope() {
+			Slot() = previous;
+		}
+
+	private:
+		AnnSearchTally *previous;
+	};
+
+	// The tally of the calling thread's current operator, or null
+	static AnnSearchTally *Current() {
+		return Slot();
+	}
+
+	void Add(const AnnSearchCounters &counters) {
+		lock_guard<mutex> guard(lock);
+		this->counters.Add(counters);
+	}
+	void AddWork(const AnnSearchCounters &counters) {
+		lock_guard<mutex> guard(lock);
+		this->counters.AddWork(counters);
+	}
+
+	AnnSearchCounters Get() const {
+		lock_guard<mutex> guard(lock);
+		return counters;
+	}
+
+	// Run a partition child's search for the operator whose tally is `parent`, possibly on
+	// another thread: the child's work adds to it, the searches and latency are the parent's
+	template <class SEARCH>
+	static auto RunChild(AnnSearchTally *parent, SEARCH &&search) -> decltype(search()) {
+		AnnSearchTally child;
+		Scope scope(parent ? &child : nullptr);
+		auto results = search();
+		if (parent) {
+			parent->AddWork(child.Get());
+		}
+		return results;
+	}
+
+private:
+	static AnnSearchTally *&Slot() {
+		thread_local AnnSearchTally *current = nullptr;
+		return current;
+	}
+
+	mutable mutex lock;
+	AnnSearchCounters counters;
+};
+
+class AnnSearchStats {
+public:
+	using Clock = std::chrono::steady_clock;
+
+	static uint64_t NanosSince(Clock::time_point start) {
+		return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+	}
+
+	// One search call of `queries` queries: end-to-end and engine time of the whole call.
+	// Batches record their mean per-query latency once per query.
+	void RecordSearch(idx_t queries, uint64_t total_nanos, uint64_t engine_nanos) {
+		if (queries == 0) {
+			return;
+		}
+		searches_.fetch_add(queries, std::memory_order_relaxed);
+		engine_nanos_.fetch_add(engine_nanos, std::memory_order_relaxed);
+		auto micros = total_nanos / queries / 1000;
+		idx_t bucket = 0;
+		while (micros > 1 && bucket + 1 < AnnSearchCounters::LATENCY_BUCKETS) {
+			micros >>= 1;
+			bucket++;
+		}
+		latency_histogram_[bucket].fetch_add(queries, std::memory_order_relaxed);
+		if (auto tally = AnnSearchTally::Current()) {
+			AnnSearchCounters counters;
+			counters.searches = queries;
+			counters.engine_nanos = engine_nanos;
+			counters.latency_histogram[bucket] = queries;
+			tally->Add(counters);
+		}
+	}
+
+	// Traversal counters of engines that do not keep their own (FAISS): one engine call
+	void RecordDispatch(uint64_t distance_computations, bool gpu) {
+		distance_computations_.fetch_add(distance_computations, std::memory_order_relaxed);
+		(gpu ? gpu_dispatches_ : cpu_dispatches_).fetch_add(1, std::memory_order_relaxed);
+		if (auto tally = AnnSearchTally::Current()) {
+			AnnSearchCounters counters;
+			counters.distance_computations = distance_computations;
+			(gpu ? counters.gpu_dispatches : counters.cpu_dispatches) = 1;
+			tally->AddWork(counters);
+		}
+	}
+	void RecordDeletedFiltered(uint64_t deleted_filtered) {
+		if (deleted_filtered > 0) {
+			deleted_filtered_.fetch_add(deleted_filtered, std::memory_order_relaxed);
+			if (auto tally = AnnSearchTally::Current()) {
+				AnnSearchCounters counters;
+				counters.deleted_filtered = deleted_filtered;
+				tally->AddWork(counters);
+			}
+		}
+	}
+
+	AnnSearchCounters Snapshot() const {
+		AnnSearchCounters counters;
+		counters.searches = searches_.load(std::memory_order_relaxed);
+		counters.distance_computations = distance_computations_.load(std::memory_order_relaxed);
+		counters.deleted_filtered = deleted_filtered_.load(std::memory_order_relaxed);
+		counters.gpu_dispatches = gpu_dispatches_.load(std::memory_order_relaxed);
+		counters.cpu_dispatches = cpu_dispatches_.load(std::memory_order_relaxed);
+		counters.engine_nanos = engine_nanos_.load(std::memory_order_relaxed);
+		for (idx_t b = 0; b < AnnSearchCounters::LATENCY_BUCKETS; b++) {
+			counters.latency_histogram[b] = latency_histogram_[b].load(std::memory_order_relaxed);
+		}
+		return counters;
+	}
+
+private:
+	atomic<uint64_t> searches_ {0};
+	atomic<uint64_t> distance_computations_ {0};
+	atomic<uint64_t> deleted_filtered_ {0};
+	atomic<uint64_t> gpu_dispatches_ {0};
+	atomic<uint64_t> cpu_dispatches_ {0};
+	atomic<uint64_t> engine_nanos_ {0};
+	std::array<atomic<uint64_t>, AnnSearchCounters::LATENCY_BUCKETS> latency_histogram_ {};
+};
+
+// Counters of a bound DISKANN or FAISS index (zeros for anything else)
+AnnSearchCounters GetAnnSearchCounters(BoundIndex &index);
+
+// EXPLAIN ANALYZE entries for the tally of one operator's searches
+void AnnSearchCountersToString(const AnnSearchCounters &counters, InsertionOrderPreservingMap<string> &result);
+
+} // namespace duckdb
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "duckdb.hpp"
+#include "duckdb/storage/index_storage_info.hpp"
+#include "linked_block_storage.hpp"
+
+#include <functional>
+
+namespace duckdb {
+
+// Logical WAL records for the ANN indexes.
+//
+// DuckDB writes an index to the WAL once, with the CREATE INDEX that made it; every later
+// change to the table is logged as table rows and replayed into the index by DuckDB itself.
+// Instead of the index image (graph, codes, label maps), the CREATE INDEX record holds the
+// live (row id, vector) pairs in batches, and replay inserts them into the empty index.
+// The record sits in an allocator of its own, so the index's block storage is untouched.
+//
+// Layout after the caller's header: batches of [u64 count][count row ids][count vectors],
+// closed by a count of 0.
+class AnnWalLog {
+public:
+	explicit AnnWalLog(BlockManager &block_manager);
+
+	// Write batches of row_ids; fetch returns the vectors of one batch (dimension floats each)
+	void WriteRows(const vector<row_t> &row_ids, idx_t dimension,
+	               const std::function<vector<float>(const vector<row_t> &)> &fetch);
+	LinkedBlockWriter &Writer() {
+		return writer_;
+	}
+	// The record as WAL storage: its only allocator, buffers inline
+	IndexStorageInfo GetInfo(const string &name, const case_insensitive_map_t<Value> &options);
+
+	// Replay a record's batches (after the caller read its header): apply(row_ids, vectors, count)
+	static void ReadRows(LinkedBlockReader &reader, idx_t dimension,
+	                     const std::function<void(const row_t *, const float *, idx_t)> &apply);
+
+private:
+	unique_ptr<FixedSizeAllocator> allocator_;
+	IndexPointer root_;
+	LinkedBlockWriter writer_;
+};
+
+} // namespace duckdb
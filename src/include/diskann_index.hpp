@@ -1,20 +1,34 @@
 #pragma once
 
+#include "duckdb/common/set.hpp"
 #include "duckdb/execution/index/bound_index.hpp"
 #include "duckdb/execution/index/fixed_size_allocator.hpp"
 #include "duckdb/execution/index/index_pointer.hpp"
 #include "duckdb/execution/index/index_type.hpp"
 #include "duckdb/execution/physical_operator.hpp"
+#include "duckdb/main/config.hpp"
 #include "duckdb/parser/parsed_data/create_index_info.hpp"
 #include "duckdb/storage/data_table.hpp"
+#include "ann_calibration.hpp"
+#include "ann_partition.hpp"
+#include "ann_query_batcher.hpp"
+#include "ann_result_cache.hpp"
+#include "ann_search_stats.hpp"
 #include "rust_ffi.hpp"
 
+#include <atomic>
+#include <functional>
+#include <shared_mutex>
 #include <unordered_map>
-#include <unordered_set>
 
 namespace duckdb {
 
+class AnnMemoryReservation;
+class AnnWalLog;
+class ColumnDataCollection;
 class DuckTableEntry;
+class LinkedBlockReader;
+class LinkedBlockWriter;
 
 // Shared DiskANN option parsing — single source of truth
 struct DiskannParams {
@@ -22,7 +36,24 @@ struct DiskannParams {
 	int32_t max_degree = 64;
 	int32_t build_complexity = 128;
 	float alpha = 1.2f;
+	// quantization = 'sq8' / 'pq': traverse on the codes, re-rank on full precision
 	bool quantize_sq8 = false;
+	bool quantize_pq = false;
+	int32_t pq_subspaces = 0; // 0 = about 4 dims per subspace
+	int32_t pq_bits = 8;
+	int32_t rerank = 0; // candidates re-ranked per search, 0 = 4 * k
+	// precision = 'f16' / 'bf16': vectors kept and persisted at half width, searched without re-ranking
+	uint8_t half_format = 0; // 0 = f32, 1 = f16, 2 = bf16
+	// build_mode = 'streaming': CREATE INDEX spills rows to buffer-managed storage and builds
+	// a pilot graph from a sample, then inserts the rest within memory_limit
+	bool streaming_build = false;
+	idx_t memory_limit = 0; // bytes, 0 = half of DuckDB's memory_limit
+	int64_t sample_size = 0; // pilot graph size, 0 = max(sqrt(N), 1000)
+	// storage = 'disk': the graph lives in a sector-aligned .diskann file next to the database,
+	// rows appended since the last checkpoint in an in-memory delta merged into it at checkpoint
+	bool disk_storage = false;
+	// partition_by = '<column>': one child index per value of the index's second column
+	string partition_by;
 
 	static DiskannParams Parse(const case_insensitive_map_t<Value> &options) {
 		DiskannParams p;
@@ -39,9 +70,66 @@ struct DiskannParams {
 				auto val = kv.second.ToString();
 				if (val == "sq8" || val == "SQ8") {
 					p.quantize_sq8 = true;
+				} else if (val == "pq" || val == "PQ") {
+					p.quantize_pq = true;
 				}
+			} else if (kv.first == "precision") {
+				auto val = StringUtil::Lower(kv.second.ToString());
+				if (val != "f32" && val != "f16" && val != "bf16") {
+					throw InvalidInputException("DISKANN precision must be 'f32', 'f16' or 'bf16', got '%s'",
+					                            kv.second.ToString());
+				}
+				p.half_format = val == "f16" ? 1 : val == "bf16" ? 2 : 0;
+			} else if (kv.first == "pq_subspaces") {
+				p.pq_subspaces = kv.second.GetValue<int32_t>();
+			} else if (kv.first == "pq_bits") {
+				p.pq_bits = kv.second.GetValue<int32_t>();
+			} else if (kv.first == "rerank" || kv.first == "pq_rerank") {
+				p.rerank = kv.second.GetValue<int32_t>();
+			} else if (kv.first == "build_mode") {
+				auto val = StringUtil::Lower(kv.second.ToString());
+				if (val != "memory" && val != "streaming") {
+					throw InvalidInputException("DISKANN build_mode must be 'memory' or 'streaming', got '%s'",
+					                            kv.second.ToString());
+				}
+				p.streaming_build = val == "streaming";
+			} else if (kv.first == "memory_limit") {
+				p.memory_limit = DBConfig::ParseMemoryLimit(kv.second.ToString());
+			} else if (kv.first == "sample_size") {
+				p.sample_size = kv.second.GetValue<int64_t>();
+			} else if (kv.first == "storage") {
+				auto val = StringUtil::Lower(kv.second.ToString());
+				if (val != "memory" && val != "disk") {
+					throw InvalidInputException("DISKANN storage must be 'memory' or 'disk', got '%s'",
+					                            kv.second.ToString());
+				}
+				p.disk_storage = val == "disk";
+			} else if (kv.first == "partition_by") {
+				p.partition_by = kv.second.ToString();
 			}
 		}
+		// A disk index reads full-precision vectors from the node's own sector: no codes to traverse on
+		if (p.disk_storage && (p.quantize_sq8 || p.quantize_pq)) {
+			throw InvalidInputException("DISKANN storage = 'disk' does not support quantization");
+		}
+		if (p.half_format && (p.quantize_sq8 || p.quantize_pq)) {
+			throw InvalidInputException("DISKANN precision cannot be combined with quantization");
+		}
+		if (p.disk_storage && p.half_format) {
+			throw InvalidInputException("DISKANN storage = 'disk' does not support precision = 'f16' / 'bf16'");
+		}
+		if (p.disk_storage && p.streaming_build) {
+			throw InvalidInputException("DISKANN storage = 'disk' does not support build_mode = 'streaming'");
+		}
+		if (!p.partition_by.empty() && (p.disk_storage || p.streaming_build)) {
+			throw InvalidInputException(
+			    "DISKANN partition_by does not support storage = 'disk' or build_mode = 'streaming'");
+		}
+		// Vectors leave memory during a streaming build: the graph is traversed on SQ8
+		// codes unless PQ or half precision was asked for
+		if (p.streaming_build && !p.quantize_sq8 && !p.quantize_pq && !p.half_format) {
+			p.quantize_sq8 = true;
+		}
 		return p;
 	}
 
@@ -54,6 +142,23 @@ struct DiskannParams {
 		if (quantize_sq8) {
 			opts["quantization"] = Value("sq8");
 		}
+		if (quantize_pq) {
+			opts["quantization"] = Value("pq");
+			opts["pq_subspaces"] = Value::INTEGER(pq_subspaces);
+			opts["pq_bits"] = Value::INTEGER(pq_bits);
+		}
+		if (quantize_sq8 || quantize_pq) {
+			opts["rerank"] = Value::INTEGER(rerank);
+		}
+		if (half_format) {
+			opts["precision"] = Value(half_format == 1 ? "f16" : "bf16");
+		}
+		if (disk_storage) {
+			opts["storage"] = Value("disk");
+		}
+		if (!partition_by.empty()) {
+			opts["partition_by"] = Value(partition_by);
+		}
 		return opts;
 	}
 };
@@ -100,28 +205,78 @@ public:
 	string GetConstraintViolationMessage(VerifyExistenceType verify_type, idx_t failed_index,
 	                                     DataChunk &input) override;
 
-	// ANN search (called by optimizer/index scan)
+	// ANN search (called by optimizer/index scan). search_complexity = 0 uses the
+	// ann_calibrate value for k, else the build complexity.
 	vector<pair<row_t, float>> Search(const float *query, int32_t dimension, int32_t k, int32_t search_complexity);
 
+	// Search for ann_search and the optimizer: with ann_batch_window_us set, concurrent
+	// callers with the same k are coalesced into one lock-step SearchBatch
+	vector<pair<row_t, float>> SearchCoalesced(ClientContext &context, const float *query, int32_t dimension, int32_t k,
+	                                           int32_t search_complexity);
+
+	// Filtered ANN search restricted to allowed_rowids. exhaustive=true scores every
+	// allowed row exactly (pre-filter); false filters inside graph traversal.
+	vector<pair<row_t, float>> SearchFiltered(const float *query, int32_t dimension, int32_t k,
+	                                          int32_t search_complexity, const vector<row_t> &allowed_rowids,
+	                                          bool exhaustive);
+
 	// Batch ANN search: multiple queries. Returns per-query results.
 	vector<vector<pair<row_t, float>>> SearchBatch(const vector<vector<float>> &queries, int32_t k,
 	                                               int32_t search_complexity);
 
+	// partition_by: search the child of one partition value alone (no results when the value has
+	// no rows), through its result cache; with allowed_rowids, SearchFiltered within the partition
+	vector<pair<row_t, float>> SearchPartition(ClientContext &context, const Value &key, const float *query,
+	                                           int32_t dimension, int32_t k, int32_t search_complexity,
+	                                           const vector<row_t> *allowed_rowids, bool exhaustive);
+
+	// One bounded slice of in-place delete consolidation (max_nodes = 0 finishes the
+	// pass). Takes the index lock; Vacuum runs the whole pass.
+	DiskannConsolidateProgress Consolidate(idx_t max_nodes);
+
 	int32_t GetDimension() const {
 		return dimension_;
 	}
 	const string &GetMetric() const {
 		return metric_;
 	}
-	idx_t GetVectorCount() const {
-		return rust_handle_ ? static_cast<idx_t>(DiskannDetachedCount(rust_handle_)) : 0;
+	// Summed over the partitions of a partitioned index
+	idx_t GetVectorCount() const;
+	idx_t GetDeletedCount() const;
+	bool IsDiskStorage() const {
+		return disk_storage_;
 	}
-	idx_t GetDeletedCount() const {
-		return deleted_labels_.size();
+	bool IsQuantized() const;
+	// SQ8/PQ codes or half-width vectors: full-precision vectors can leave memory after a checkpoint
+	bool SearchesCodes() const;
+	bool IsPartitioned() const {
+		return !partition_by_.empty();
 	}
-	bool IsQuantized() const {
-		return rust_handle_ ? DiskannDetachedIsQuantized(rust_handle_) : false;
+	const string &GetPartitionColumn() const {
+		return partition_by_;
 	}
+	idx_t GetPartitionCount() const {
+		std::shared_lock<std::shared_mutex> guard(partitions_lock_);
+		return partitions_.Size();
+	}
+	AnnResultCache &GetResultCache() {
+		return result_cache_;
+	}
+	AnnCalibration &GetCalibration() {
+		return calibration_;
+	}
+	// Search counters: latency and FFI time kept here, traversal counters read from Rust
+	AnnSearchCounters GetSearchCounters() const;
+	// Batches the query batcher ran and the queries they carried, the partitions' included
+	pair<idx_t, idx_t> GetBatchCounts() const;
+	// MergeIndexes calls that stitched the other graph in, and those that re-inserted its vectors
+	pair<idx_t, idx_t> GetMergeCounts() const;
+	// Row ids of every live vector, and the vectors of the given rows (row-major, dimension floats each)
+	vector<row_t> GetLiveRowIds() const;
+	vector<float> GetVectors(const vector<row_t> &row_ids) const;
+	// Times the index released memory for another one, and pages or vectors read back since
+	idx_t GetEvictions() const;
+	idx_t GetPageLoads() const;
 
 	// PhysicalCreateDiskannIndex needs to set internal state after build
 	friend class PhysicalCreateDiskannIndex;
@@ -129,10 +284,98 @@ public:
 private:
 	void PersistToDisk();
 	void LoadFromStorage(const IndexStorageInfo &info);
-
-	// Rust DiskANN index handle
+	void LoadMonolithic(LinkedBlockReader &reader);
+	void LoadSegmented(LinkedBlockReader &reader, uint32_t version);
+	// Replay a logical WAL record into the empty index
+	void LoadWalLog(LinkedBlockReader &reader);
+	// Page fault handler for lazily opened indexes (DiskannPageLoader); never throws
+	static int32_t LoadPageCallback(void *ctx, uint32_t start, uint32_t count, float *out_vectors,
+	                                uint32_t *out_adjacency);
+	void ReadPage(uint32_t start, uint32_t count, float *out_vectors, uint32_t *out_adjacency);
+	// Resident heap of the index: label maps, the Rust graph and the disk base's caches
+	idx_t HeapBytes() const;
+	// Reserve HeapBytes() plus pending bytes a mutation is about to allocate with the buffer manager;
+	// may release cold indexes or throw out of memory
+	void UpdateReservation(idx_t pending = 0);
+	// After each search: mark the index as used, account pages the search faulted in
+	void NoteSearch();
+	// Release callback of reservation_: persist dirty pages and evict the vectors of a coded index
+	idx_t ReleaseMemory();
+	// DiskannParallelFor over the database's TaskScheduler (ctx): Rust's insert, consolidation, merge and PQ
+	// training tasks run on DuckDB's worker threads, within SET threads
+	static void RunTasks(void *ctx, uint64_t n, DiskannTaskBody body, void *body_ctx);
+	// DiskannDetachedAddBatch into rust_handle_, with the inserts run through RunTasks
+	void AddBatch(const float *matrix, idx_t n, int64_t *out_labels);
+	// Push the re-rank depth to Rust and train SQ8/PQ once there are enough vectors
+	void ApplyQuantization();
+	// Free every segment chain; the next checkpoint rewrites all of them
+	void ResetSegments();
+	// build_mode = 'streaming': pilot graph from a sample of rows, then the remaining rows in
+	// batches, writing vector pages to storage and evicting them whenever memory_limit is exceeded
+	void StreamingBuild(ColumnDataCollection &rows, const DiskannParams &params, idx_t memory_limit);
+	// Record the labels AddBatch assigned to row_ids
+	void MapLabels(const int64_t *labels, const row_t *row_ids, idx_t count);
+	// Append / Delete once the rows are known to belong to this index (a partition's child)
+	void AppendRows(const float *vectors, const row_t *row_ids, idx_t count);
+	void DeleteRows(const row_t *row_ids, idx_t count);
+	// The child index of a partition value, created (or loaded from info) on first use
+	DiskannIndex &GetOrCreatePartition(const Value &key, const IndexStorageInfo &info = IndexStorageInfo());
+	// The children in partition order, and the child of key (nullptr if none): read under
+	// partitions_lock_, so searches can walk them while an append creates a partition
+	vector<DiskannIndex *> Partitions() const;
+	DiskannIndex *FindPartition(const Value &key) const;
+	// Rewrite the root chain of a partitioned index: the partition directory over the children's roots
+	void WritePartitionRoot(const vector<AnnPartitionEntry> &directory);
+	void LoadPartitions(LinkedBlockReader &reader, const IndexStorageInfo &info);
+	// Run search on every child on DuckDB's worker threads and merge their k nearest
+	vector<pair<row_t, float>>
+	SearchPartitions(int32_t k, const std::function<vector<pair<row_t, float>>(DiskannIndex &)> &search);
+	DiskannConsolidateProgress RunConsolidation(idx_t max_nodes);
+	// Write label_to_rowid_ pages that changed since the last checkpoint (storage_lock_ held)
+	void PersistMappings();
+	void WriteMapDirectory(LinkedBlockWriter &writer) const;
+	// Tombstones and vectors by label, across the disk base and the delta
+	vector<uint64_t> GetTombstones() const;
+	bool ReadVector(uint32_t label, float *out) const;
+
+	// storage = 'disk': merge the delta into the .diskann file (a new generation on compaction)
+	// and write the root
+	void PersistDiskStorage();
+	void LoadDiskStorage(LinkedBlockReader &reader, bool has_file_id);
+	// <database path>.<index name>.<file id>.<generation>.diskann (no file id: written before there was one)
+	string DiskFilePath(const string &file_id, uint64_t generation) const;
+	void RemoveDiskFile(const string &path) const;
+	// Generations of this index's file other than the current one: left by a compaction whose
+	// checkpoint never completed, or superseded before the process stopped
+	void RemoveStaleDiskFiles() const;
+
+	// partition_by: the children by partition value; the parent holds no vectors of its own.
+	// The children's options are the parent's without partition_by.
+	string partition_by_;
+	LogicalType partition_type_;
+	case_insensitive_map_t<Value> child_options_;
+	AnnPartitionMap<unique_ptr<DiskannIndex>> partitions_;
+	// Creating a child takes it exclusively; everything else that reads partitions_ shares it.
+	// Children live until CommitDrop, so pointers read under it stay valid after it is released
+	mutable std::shared_mutex partitions_lock_;
+
+	// Rust DiskANN index handle. With storage = 'disk' it is the delta: labels from base_count_ on
 	DiskannHandle rust_handle_ = nullptr;
 
+	// storage = 'disk': the .diskann file holding labels [0, base_count_), and its generation.
+	// The file id is random, stored in the root, so indexes of the same name in different
+	// schemas (or partition children) never share a file.
+	bool disk_storage_ = false;
+	DiskannDiskHandle disk_handle_ = nullptr;
+	idx_t base_count_ = 0;
+	string disk_file_id_;
+	uint64_t disk_generation_ = 0;
+	// VACUUM asked for the next checkpoint to rewrite the file as a new generation
+	bool compact_disk_file_ = false;
+	// Files a compaction replaced: removed at the next checkpoint, once the root naming their
+	// successor is durable
+	vector<string> superseded_disk_files_;
+
 	// Index parameters
 	int32_t dimension_ = 0;
 	string metric_ = "L2";
@@ -140,18 +383,52 @@ private:
 	int32_t build_complexity_ = 128;
 	float alpha_ = 1.2f;
 	bool quantize_sq8_ = false;
+	bool quantize_pq_ = false;
+	int32_t pq_subspaces_ = 0;
+	int32_t pq_bits_ = 8;
+	int32_t rerank_ = 0;
+	// 0 = f32, 1 = f16, 2 = bf16; also the format of the persisted vector pages
+	uint8_t half_format_ = 0;
 
 	// Row ID mapping: internal label (0,1,2,...) <-> DuckDB row_t
 	vector<row_t> label_to_rowid_;
 	unordered_map<row_t, uint32_t> rowid_to_label_;
 
-	// Tombstones for deleted vectors
-	unordered_set<uint32_t> deleted_labels_;
+	// Tombstones for deleted vectors live in the Rust provider as a bitmap
+
+	// Cached single-query results, invalidated by every change to the graph or the label map
+	AnnResultCache result_cache_;
+	// Concurrent single-query searches coalesced into SearchBatch calls (ann_batch_window_us)
+	AnnQueryBatcher query_batcher_;
+	// search_complexity per k bucket from ann_calibrate, kept in the storage options
+	AnnCalibration calibration_;
+	// Per-call search latency and FFI time for ann_index_stats()
+	AnnSearchStats search_stats_;
+	// HeapBytes() as reserved with DuckDB's buffer manager, so memory_limit counts it
+	unique_ptr<AnnMemoryReservation> reservation_;
+	std::atomic<uint64_t> page_loads_seen_ {0};
+	// GetMergeCounts() of this index alone
+	std::atomic<idx_t> stitched_merges_ {0};
+	std::atomic<idx_t> reinserted_merges_ {0};
 
 	// Block storage for serialized data
 	unique_ptr<FixedSizeAllocator> block_allocator_;
 	IndexPointer root_block_ptr_;
 	bool is_dirty_ = false;
+	// The last logical WAL record, kept until the WAL has written its buffers
+	unique_ptr<AnnWalLog> wal_log_;
+
+	// Segmented storage: one linked-block chain per page, listed in the root chain
+	vector<IndexPointer> vector_segments_;
+	vector<IndexPointer> adjacency_segments_;
+	vector<IndexPointer> map_segments_;
+	vector<IndexPointer> code_segments_; // SQ8/PQ codes, one chain per page (written with the vector page)
+	IndexPointer codebook_ptr_;          // SQ8 min/scale or the PQ codebook
+	idx_t persisted_vectors_ = 0;  // vectors [0, n) are on disk (vector pages are append-only)
+	idx_t persisted_mappings_ = 0; // label_to_rowid_ [0, n) is on disk
+	set<idx_t> dirty_map_pages_;   // persisted map pages holding recycled labels
+	// Guards block_allocator_ and the segment directories: pages are faulted in from Rust worker threads
+	mutex storage_lock_;
 };
 
 // ========================================
@@ -195,7 +472,7 @@ public:
 		return true;
 	}
 	bool ParallelSink() const override {
-		return false; // DiskANN insert is not thread-safe currently
+		return true;
 	}
 };
 
@@ -15,6 +15,10 @@ enum class FaissGpuMode : uint8_t {
 
 #ifdef FAISS_AVAILABLE
 
+#include "ann_calibration.hpp"
+#include "ann_partition.hpp"
+#include "ann_result_cache.hpp"
+#include "ann_search_stats.hpp"
 #include "duckdb/execution/index/bound_index.hpp"
 #include "duckdb/execution/index/fixed_size_allocator.hpp"
 #include "duckdb/execution/index/index_pointer.hpp"
@@ -26,12 +30,17 @@ enum class FaissGpuMode : uint8_t {
 
 #include <faiss/Index.h>
 
+#include <functional>
+#include <shared_mutex>
 #include <unordered_map>
 #include <unordered_set>
 
 namespace duckdb {
 
+class AnnMemoryReservation;
+class AnnWalLog;
 class DuckTableEntry;
+class LinkedBlockReader;
 
 // Shared FAISS option parsing — single source of truth
 struct FaissParams {
@@ -41,8 +50,14 @@ struct FaissParams {
 	int32_t ivf_nlist = 100;
 	int32_t nprobe = 1;
 	int64_t train_sample = 0;
+	int32_t pq_m = 8;       // IVFPQ: sub-quantizers per vector (must divide the dimension)
+	int32_t pq_nbits = 8;   // IVFPQ: bits per sub-quantizer code
+	string sq_type = "sq8"; // HNSWSQ: scalar quantizer ('sq8', 'sq6', 'sq4', 'fp16', 'sq8_uniform')
+	string precision = "f32"; // Flat / HNSW / IVFFlat: vectors stored as 'f32', 'f16' or 'bf16'
 	string description;
 	FaissGpuMode mode = FaissGpuMode::AUTO;
+	// partition_by = '<column>': one child index per value of the index's second column
+	string partition_by;
 
 	static FaissParams Parse(const case_insensitive_map_t<Value> &options) {
 		FaissParams p;
@@ -60,6 +75,18 @@ struct FaissParams {
 				p.nprobe = MaxValue<int32_t>(1, kv.second.GetValue<int32_t>());
 			} else if (kv.first == "train_sample") {
 				p.train_sample = kv.second.GetValue<int64_t>();
+			} else if (kv.first == "pq_m") {
+				p.pq_m = kv.second.GetValue<int32_t>();
+			} else if (kv.first == "pq_nbits") {
+				p.pq_nbits = kv.second.GetValue<int32_t>();
+			} else if (kv.first == "sq_type") {
+				p.sq_type = kv.second.ToString();
+			} else if (kv.first == "precision") {
+				p.precision = StringUtil::Lower(kv.second.ToString());
+				if (p.precision != "f32" && p.precision != "f16" && p.precision != "bf16") {
+					throw InvalidInputException("FAISS precision must be 'f32', 'f16' or 'bf16', got '%s'",
+					                            kv.second.ToString());
+				}
 			} else if (kv.first == "description") {
 				p.description = kv.second.ToString();
 			} else if (kv.first == "mode") {
@@ -80,6 +107,8 @@ struct FaissParams {
 					bool gpu_val = BooleanValue::Get(kv.second.DefaultCastAs(LogicalType::BOOLEAN));
 					p.mode = gpu_val ? FaissGpuMode::GPU : FaissGpuMode::CPU;
 				}
+			} else if (kv.first == "partition_by") {
+				p.partition_by = kv.second.ToString();
 			}
 		}
 		if (p.index_type.empty()) {
@@ -94,6 +123,12 @@ struct FaissParams {
 		opts["type"] = Value(index_type);
 		opts["hnsw_m"] = Value::INTEGER(hnsw_m);
 		opts["ivf_nlist"] = Value::INTEGER(ivf_nlist);
+		opts["pq_m"] = Value::INTEGER(pq_m);
+		opts["pq_nbits"] = Value::INTEGER(pq_nbits);
+		opts["sq_type"] = Value(sq_type);
+		if (precision != "f32") {
+			opts["precision"] = Value(precision);
+		}
 		if (!description.empty()) {
 			opts["description"] = Value(description);
 		}
@@ -108,6 +143,9 @@ struct FaissParams {
 			opts["mode"] = Value("auto");
 			break;
 		}
+		if (!partition_by.empty()) {
+			opts["partition_by"] = Value(partition_by);
+		}
 		return opts;
 	}
 };
@@ -152,8 +190,24 @@ public:
 	string GetConstraintViolationMessage(VerifyExistenceType verify_type, idx_t failed_index,
 	                                     DataChunk &input) override;
 
-	// ANN search
-	vector<pair<row_t, float>> Search(const float *query, int32_t dimension, int32_t k);
+	// ANN search. nprobe = 0 uses the ann_calibrate value for k, else the index nprobe.
+	vector<pair<row_t, float>> Search(const float *query, int32_t dimension, int32_t k, int32_t nprobe = 0);
+
+	// Multi-query search: all queries go to FAISS as one nq-row search (results per query, in order).
+	// nprobe = 0 uses the ann_calibrate value for k, else the index nprobe.
+	vector<vector<pair<row_t, float>>> SearchBatch(const vector<vector<float>> &queries, int32_t k,
+	                                               int32_t nprobe = 0);
+
+	// Filtered search restricted to allowed_rowids via a FAISS IDSelector.
+	// exhaustive=true widens IVF/HNSW probing so every allowed row is scored.
+	vector<pair<row_t, float>> SearchFiltered(const float *query, int32_t dimension, int32_t k,
+	                                          const vector<row_t> &allowed_rowids, bool exhaustive);
+
+	// partition_by: search the child of one partition value alone (no results when the value has
+	// no rows), through its result cache; with allowed_rowids, SearchFiltered within the partition
+	vector<pair<row_t, float>> SearchPartition(ClientContext &context, const Value &key, const float *query,
+	                                           int32_t dimension, int32_t k, const vector<row_t> *allowed_rowids,
+	                                           bool exhaustive);
 
 	int32_t GetDimension() const {
 		return dimension_;
@@ -167,21 +221,95 @@ public:
 	int32_t GetNprobe() const {
 		return nprobe_;
 	}
+	// IVF lists probed for k results: the calibrated value, else nprobe_
+	int32_t NprobeFor(int32_t k) const;
 	FaissGpuMode GetGpuMode() const {
 		return mode_;
 	}
-	idx_t GetVectorCount() const {
-		return faiss_index_ ? static_cast<idx_t>(faiss_index_->ntotal) : 0;
+	// Summed over the partitions of a partitioned index
+	idx_t GetVectorCount() const;
+	idx_t GetDeletedCount() const;
+	bool IsPartitioned() const {
+		return !partition_by_.empty();
 	}
-	idx_t GetDeletedCount() const {
-		return deleted_labels_.size();
+	const string &GetPartitionColumn() const {
+		return partition_by_;
 	}
+	idx_t GetPartitionCount() const {
+		std::shared_lock<std::shared_mutex> guard(partitions_lock_);
+		return partitions_.Size();
+	}
+	AnnResultCache &GetResultCache() {
+		return result_cache_;
+	}
+	AnnCalibration &GetCalibration() {
+		return calibration_;
+	}
+	AnnSearchCounters GetSearchCounters() const;
+	// Inverted lists of an IVF index (of its first partition), 0 for other types
+	int64_t GetNlist() const;
+	// Row ids of every live vector, and the vectors of the given rows (row-major, dimension floats each)
+	vector<row_t> GetLiveRowIds() const;
+	vector<float> GetVectors(const vector<row_t> &row_ids) const;
+	// Times the index released memory for another one (never: FAISS has no lazy form)
+	idx_t GetEvictions() const;
 
 	friend class PhysicalCreateFaissIndex;
 
 private:
 	void PersistToDisk();
 	void LoadFromStorage(const IndexStorageInfo &info);
+	// Replay a logical WAL record into the empty index
+	void LoadWalLog(LinkedBlockReader &reader);
+	// Append / Delete once the rows are known to belong to this index (a partition's child).
+	// An untrained child is trained on its first rows (train_sample of them, evenly strided).
+	void AppendRows(const float *vectors, const row_t *row_ids, idx_t count);
+	void DeleteRows(const row_t *row_ids, idx_t count);
+	// The child index of a partition value, created (or loaded from info) on first use
+	FaissIndex &GetOrCreatePartition(const Value &key, const IndexStorageInfo &info = IndexStorageInfo());
+	// The children in partition order, and the child of key (nullptr if none): read under
+	// partitions_lock_, so searches can walk them while an append creates a partition
+	vector<FaissIndex *> Partitions() const;
+	FaissIndex *FindPartition(const Value &key) const;
+	// Rewrite the root chain of a partitioned index: the partition directory over the children's roots
+	void WritePartitionRoot(const vector<AnnPartitionEntry> &directory);
+	void LoadPartitions(LinkedBlockReader &reader, const IndexStorageInfo &info);
+	// Run search on every child on DuckDB's worker threads and merge their k nearest
+	vector<pair<row_t, float>> SearchPartitions(int32_t k,
+	                                            const std::function<vector<pair<row_t, float>>(FaissIndex &)> &search);
+	// Inner product results are similarities: larger is nearer
+	bool LargerIsNearer() const;
+	// Host memory of the index: label maps, tombstones and FAISS's own arrays
+	idx_t HeapBytes() const;
+	// Reserve HeapBytes() plus pending bytes a mutation is about to allocate with the buffer manager;
+	// may release cold indexes or throw out of memory
+	void UpdateReservation(idx_t pending = 0);
+	// CPU search of nq queries excluding labels not passing sel; search parameters follow the index type
+	void SearchWithSelector(faiss::idx_t nq, const float *queries, int32_t k, const faiss::IDSelector &sel,
+	                        float *distances, faiss::idx_t *labels) const;
+	// Candidates requested per query for k live results
+	int32_t CandidateCount(int32_t k) const;
+	// Raw nq x request_k search excluding tombstones (CPU) or including them (GPU).
+	// Returns the nanoseconds spent in FAISS.
+	uint64_t SearchCandidates(faiss::idx_t nq, const float *queries, int32_t request_k, int32_t nprobe,
+	                          float *distances, faiss::idx_t *labels);
+	// Map one query's candidates to row ids, skipping empty slots and tombstones.
+	// Returns the number of tombstones skipped.
+	idx_t CollectResults(const faiss::idx_t *labels, const float *distances, int32_t request_k, int32_t k,
+	                     vector<pair<row_t, float>> &results) const;
+	// Codes a search of one query scores with nprobe lists: every vector for Flat, the
+	// centroids plus the expected probed lists for IVF; HNSW does not report it (0)
+	uint64_t DistanceComputationsPerQuery(int32_t nprobe) const;
+
+	// partition_by: the children by partition value; the parent holds no vectors of its own.
+	// The children's options are the parent's without partition_by.
+	string partition_by_;
+	LogicalType partition_type_;
+	case_insensitive_map_t<Value> child_options_;
+	AnnPartitionMap<unique_ptr<FaissIndex>> partitions_;
+	// Creating a child takes it exclusively; everything else that reads partitions_ shares it.
+	// Children live until CommitDrop, so pointers read under it stay valid after it is released
+	mutable std::shared_mutex partitions_lock_;
 
 	// FAISS index
 	std::unique_ptr<faiss::Index> faiss_index_;
@@ -189,6 +317,12 @@ private:
 	// GPU acceleration helpers
 	void EnsureGpuIndex();
 	void InvalidateGpuIndex();
+	// Keep gpu_index_ in step with an append / delete in place; drops it when the backend can't
+	void AppendToGpuIndex(int64_t base_label, idx_t count, const float *vectors);
+	void RemoveFromGpuIndex(const vector<faiss::idx_t> &labels);
+	vector<faiss::idx_t> DeletedLabels() const;
+	// Options of this index, for rebuilding the FAISS index in Append / Vacuum
+	FaissParams CurrentParams() const;
 
 	// Index parameters
 	int32_t dimension_ = 0;
@@ -198,23 +332,51 @@ private:
 	int32_t ivf_nlist_ = 100;
 	int32_t nprobe_ = 1;
 	int64_t train_sample_ = 0; // 0 = use all vectors for training
+	int32_t pq_m_ = 8;
+	int32_t pq_nbits_ = 8;
+	string sq_type_ = "sq8";
+	string precision_ = "f32";
 	string description_;
 	FaissGpuMode mode_ = FaissGpuMode::AUTO;
 
 	// GPU-resident copy of faiss_index_ (for search acceleration)
 	std::unique_ptr<faiss::Index> gpu_index_;
+	// Serializes searches and in-place updates on gpu_index_
+	mutex gpu_search_lock_;
+	// Deleted labels already removed from gpu_index_; the rest are over-fetched and filtered
+	idx_t gpu_removed_ = 0;
 
 	// Row ID mapping: internal label (0,1,2,...) <-> DuckDB row_t
 	vector<row_t> label_to_rowid_;
 	unordered_map<row_t, int64_t> rowid_to_label_;
 
-	// Tombstones for deleted vectors
-	unordered_set<int64_t> deleted_labels_;
+	// Tombstones for deleted vectors: bit l of the bitmap (faiss::IDSelectorBitmap layout)
+	vector<uint8_t> tombstones_;
+	idx_t num_deleted_ = 0;
+	// Cached single-query results, invalidated on every append, delete and rebuild
+	AnnResultCache result_cache_;
+	// nprobe per k bucket from ann_calibrate, kept in the storage options
+	AnnCalibration calibration_;
+	// Search counters for ann_index_stats()
+	AnnSearchStats search_stats_;
+	// HeapBytes() as reserved with DuckDB's buffer manager, so memory_limit counts it
+	unique_ptr<AnnMemoryReservation> reservation_;
+	bool IsDeleted(int64_t label) const {
+		return label >= 0 && static_cast<idx_t>(label >> 3) < tombstones_.size() &&
+		       (tombstones_[label >> 3] >> (label & 7)) & 1;
+	}
+	void MarkDeleted(int64_t label);
+	void ClearTombstones() {
+		tombstones_.clear();
+		num_deleted_ = 0;
+	}
 
 	// Block storage for serialized data
 	unique_ptr<FixedSizeAllocator> block_allocator_;
 	IndexPointer root_block_ptr_;
 	bool is_dirty_ = false;
+	// The last logical WAL record, kept until the WAL has written its buffers
+	unique_ptr<AnnWalLog> wal_log_;
 };
 
 // ========================================
@@ -258,7 +420,7 @@ public:
 		return true;
 	}
 	bool ParallelSink() const override {
-		return false;
+		return true;
 	}
 };
 
@@ -22,6 +22,42 @@ public:
 	/// Backend name for index tracking (e.g., "metal", "cuda")
 	virtual std::string BackendName() const = 0;
 
+	/// Number of GPUs an index can be placed on.
+	virtual int DeviceCount() const {
+		return IsAvailable() ? 1 : 0;
+	}
+
+	/// AUTO mode: whether searching an index of ntotal x dimension vectors on the GPU pays off.
+	/// The default is tuned for Metal's unified memory (~400K n*dim per dispatch).
+	virtual bool WorthOffloading(int64_t ntotal, int32_t dimension) const {
+		return ntotal >= 256 && dimension >= 128;
+	}
+
+	/// Largest k a GPU search accepts (0 = no limit); larger searches run on the CPU index.
+	virtual int64_t MaxSearchK() const {
+		return 0;
+	}
+
+	/// Set the lists probed by the next search of an IVF index returned by CpuToGpu
+	/// (no-op for other index types). Called with the search lock held.
+	virtual void SetNprobe(faiss::Index *gpu_index, size_t nprobe) const {
+	}
+
+	/// Append n vectors to an index returned by CpuToGpu, in place. They take labels
+	/// ntotal .. ntotal + n - 1, matching the CPU index they were just added to. Returns
+	/// false when the index cannot grow on the device; the caller then drops it and
+	/// uploads a fresh copy on the next search. Called with the search lock held.
+	virtual bool AddToGpu(faiss::Index *gpu_index, faiss::idx_t n, const float *x) const {
+		return false;
+	}
+
+	/// Exclude labels from later searches of an index returned by CpuToGpu, in place.
+	/// Returns false when unsupported; deleted labels are then over-fetched and
+	/// filtered out of the results. Called with the search lock held.
+	virtual bool RemoveFromGpu(faiss::Index *gpu_index, const faiss::idx_t *labels, size_t n) const {
+		return false;
+	}
+
 	/// Move a CPU index to GPU. Returns new GPU index. Throws on failure.
 	virtual std::unique_ptr<faiss::Index> CpuToGpu(faiss::Index *cpu_index) = 0;
 
@@ -29,7 +65,7 @@ public:
 	virtual std::unique_ptr<faiss::Index> GpuToCpu(faiss::Index *gpu_index) = 0;
 };
 
-/// Get the singleton GPU backend (Metal on macOS, CPU fallback otherwise).
+/// Get the singleton GPU backend (Metal on macOS, CUDA on Linux, CPU fallback otherwise).
 GpuBackend &GetGpuBackend();
 
 } // namespace duckdb
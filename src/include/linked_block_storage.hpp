@@ -36,6 +36,7 @@ public:
 				pos_ = 0;
 				if (block->next_block.Get() == 0) {
 					block->next_block = allocator_.New();
+					allocator_.Get<LinkedBlock>(block->next_block, true)->next_block = IndexPointer();
 				}
 				current_ = block->next_block;
 			}
@@ -43,6 +44,23 @@ public:
 		return written;
 	}
 
+	// Free every block after the one currently being written (chain got shorter).
+	void FreeTail() {
+		auto block = allocator_.Get<LinkedBlock>(current_, true);
+		auto next = block->next_block;
+		block->next_block = IndexPointer();
+		FreeLinkedBlocks(allocator_, next);
+	}
+
+	// Free a whole chain starting at root (no-op for a null pointer).
+	static void FreeLinkedBlocks(FixedSizeAllocator &allocator, IndexPointer root) {
+		while (root.Get() != 0) {
+			auto next = allocator.Get<LinkedBlock>(root, false)->next_block;
+			allocator.Free(root);
+			root = next;
+		}
+	}
+
 private:
 	FixedSizeAllocator &allocator_;
 	IndexPointer root_;
@@ -76,6 +94,26 @@ public:
 		return total_read;
 	}
 
+	// Advance past length bytes without copying them (blocks are still walked).
+	idx_t Skip(idx_t length) {
+		idx_t skipped = 0;
+		while (skipped < length && !exhausted_) {
+			auto to_skip = MinValue<idx_t>(length - skipped, LinkedBlock::BLOCK_DATA_SIZE - pos_);
+			skipped += to_skip;
+			pos_ += to_skip;
+			if (pos_ == LinkedBlock::BLOCK_DATA_SIZE) {
+				pos_ = 0;
+				auto block = allocator_.Get<LinkedBlock>(current_, false);
+				if (block->next_block.Get() == 0) {
+					exhausted_ = true;
+				} else {
+					current_ = block->next_block;
+				}
+			}
+		}
+		return skipped;
+	}
+
 private:
 	FixedSizeAllocator &allocator_;
 	IndexPointer current_;
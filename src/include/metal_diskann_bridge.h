@@ -22,6 +22,25 @@ int diskann_metal_batch_distances(const float *query, const float *candidates, i
 int diskann_metal_multi_batch_distances(const float *queries, const float *candidates, const unsigned int *query_map,
                                         int total_n, int nq, int dim, int metric, float *out_distances);
 
+/// Resident vectors: an index's vectors copied once into a shared Metal buffer, so
+/// lock-step batch search uploads neighbour ids instead of their vectors.
+/// Returns an opaque handle holding rows [0, n) of vectors (n*dim floats), or NULL.
+void *diskann_metal_resident_create(const float *vectors, unsigned int n, int dim);
+
+/// Overwrite rows [first, first + n) of a resident buffer, growing it if they extend
+/// past the end (first must not be past the current end). Returns 0 on success, -1 on error.
+int diskann_metal_resident_write(void *resident, const float *vectors, unsigned int first, unsigned int n);
+
+/// Release a resident buffer (NULL is ignored).
+void diskann_metal_resident_free(void *resident);
+
+/// Multi-query batch distances against resident rows.
+/// ids: (total_n) row ids, query_map: (total_n) query index per id,
+/// queries: (nq * dim) floats. Returns 0 on success, -1 on error.
+int diskann_metal_resident_multi_batch_distances(void *resident, const float *queries, const unsigned int *ids,
+                                                 const unsigned int *query_map, int total_n, int nq, int metric,
+                                                 float *out_distances);
+
 #ifdef __cplusplus
 }
 #endif
@@ -13,6 +13,13 @@ namespace duckdb {
 // Opaque handle to a Rust InMemoryIndex
 typedef void *DiskannHandle;
 
+// Parallel loop callback: run body(body_ctx, i) for every i in [0, n) and return once all calls
+// have finished. The Rust side's multi-core work (batched inserts, consolidation) is cut into
+// tasks and handed to this, so it runs on DuckDB's task scheduler rather than threads of its own.
+// Must be callable from any thread; body never throws.
+typedef void (*DiskannTaskBody)(void *body_ctx, uint64_t i);
+typedef void (*DiskannParallelFor)(void *ctx, uint64_t n, DiskannTaskBody body, void *body_ctx);
+
 // Create a detached index (not in global registry). Returns handle, throws on error.
 DiskannHandle DiskannCreateDetached(int32_t dimension, const std::string &metric, int32_t max_degree,
                                     int32_t build_complexity, float alpha);
@@ -23,10 +30,22 @@ void DiskannFreeDetached(DiskannHandle handle);
 // Add vector to detached index. Returns assigned label.
 int64_t DiskannDetachedAdd(DiskannHandle handle, const float *vector, int32_t dimension);
 
+// Add n row-major vectors in one call, as concurrent insert tasks run through run(run_ctx, ...)
+// (inline on the calling thread when run is null).
+// Writes the assigned label of each row to out_labels (may be null).
+void DiskannDetachedAddBatch(DiskannHandle handle, const float *matrix, int64_t n, int32_t dimension,
+                             int64_t *out_labels, DiskannParallelFor run = nullptr, void *run_ctx = nullptr);
+
 // Search detached index. Returns number of results.
 int32_t DiskannDetachedSearch(DiskannHandle handle, const float *query, int32_t dimension, int32_t k,
                               int32_t search_complexity, int64_t *out_labels, float *out_distances);
 
+// Filtered search: only labels whose bit is set in filter_words (label l -> word l/64, bit l%64)
+// are returned. exhaustive=true scores every allowed label exactly; false traverses the graph.
+int32_t DiskannDetachedSearchFiltered(DiskannHandle handle, const float *query, int32_t dimension, int32_t k,
+                                      int32_t search_complexity, const uint64_t *filter_words, int64_t num_words,
+                                      bool exhaustive, int64_t *out_labels, float *out_distances);
+
 // Get vector count.
 int64_t DiskannDetachedCount(DiskannHandle handle);
 
@@ -50,21 +69,36 @@ DiskannHandle DiskannDetachedDeserialize(const uint8_t *data, size_t len, float
 void DiskannFreeSerializedBytes(DiskannSerializedData bytes);
 
 // ========================================
-// Compact / vacuum
+// Graph merge
+// ========================================
+
+// Merge other into handle without re-inserting: other's nodes are appended with their
+// edges and both graphs are stitched with cross edges searched from a sample of each
+// side, as tasks through run(run_ctx, ...). Returns the label offset: other label l is
+// now offset + l. other is only read.
+uint32_t DiskannDetachedMerge(DiskannHandle handle, DiskannHandle other, DiskannParallelFor run = nullptr,
+                              void *run_ctx = nullptr);
+
+// ========================================
+// In-place delete consolidation / vacuum
 // ========================================
 
-struct DiskannCompactResult {
-	DiskannHandle new_handle; // New index (caller owns). Null on error.
-	uint32_t *label_map;      // [old0, new0, old1, new1, ...] pairs
-	size_t map_len;           // Number of pairs
+struct DiskannConsolidateProgress {
+	uint64_t visited;   // Live nodes repaired by this slice
+	uint64_t freed;     // Tombstoned slots recycled by this slice
+	uint64_t remaining; // Nodes left before the current pass frees its tombstones
+	bool done;          // No pass in progress after this slice
 };
 
-// Compact a detached index by rebuilding without deleted labels.
-// Returns new handle + label map. Old handle is NOT freed.
-DiskannCompactResult DiskannDetachedCompact(DiskannHandle handle, const uint32_t *deleted_labels, size_t num_deleted);
+// Repair up to max_nodes live nodes whose neighbours were deleted (0 = finish the
+// pass). A finished pass unlinks its tombstones and recycles their labels. The repairs run
+// as tasks through run(run_ctx, ...), inline when run is null.
+DiskannConsolidateProgress DiskannDetachedConsolidate(DiskannHandle handle, uint64_t max_nodes,
+                                                      DiskannParallelFor run = nullptr, void *run_ctx = nullptr);
 
-// Free the label map from DiskannDetachedCompact.
-void DiskannFreeLabelMap(uint32_t *map, size_t map_len);
+// Recycled labels awaiting reuse (persisted with the index).
+std::vector<uint32_t> DiskannDetachedGetFreeSlots(DiskannHandle handle);
+void DiskannDetachedSetFreeSlots(DiskannHandle handle, const std::vector<uint32_t> &slots);
 
 // ========================================
 // Vector accessor (for MergeIndexes)
@@ -73,6 +107,102 @@ void DiskannFreeLabelMap(uint32_t *map, size_t map_len);
 // Get a vector by label. Returns dimension copied, or 0 if not found.
 int32_t DiskannDetachedGetVector(DiskannHandle handle, uint32_t label, float *out_vec, int32_t capacity);
 
+// ========================================
+// Distance kernels
+// ========================================
+
+// Distances from query to n row-major candidates of dim floats, with the SIMD kernels of the
+// graph search (AVX2 / AVX-512 picked at run time on x86-64, NEON on aarch64). metric: 0 = squared
+// L2, 1 = negated inner product.
+void DiskannComputeDistances(const float *query, const float *candidates, uint64_t n, uint32_t dim, int32_t metric,
+                             float *out);
+
+// ========================================
+// Paged persistence (segmented checkpoint format)
+// ========================================
+
+// Nodes per storage page; vectors and adjacency are persisted one page per segment.
+uint32_t DiskannPageNodes();
+
+// Drain the pages whose adjacency changed since the last call (ascending).
+std::vector<uint32_t> DiskannDetachedTakeDirtyPages(DiskannHandle handle);
+
+// Drain the pages whose vectors were written since the last call (appends, recycled labels).
+std::vector<uint32_t> DiskannDetachedTakeDirtyVectorPages(DiskannHandle handle);
+
+// Copy nodes [start, start+count): vectors (count*dim floats) and/or adjacency
+// (count*max_degree u32s, UINT32_MAX padded). Either output may be null.
+void DiskannDetachedExportPage(DiskannHandle handle, uint32_t start, uint32_t count, float *out_vectors,
+                               uint32_t *out_adjacency);
+
+// Load one page into an empty detached index; finish with DiskannDetachedFinishImport.
+void DiskannDetachedImportPage(DiskannHandle handle, uint32_t start, uint32_t count, const float *vectors,
+                               const uint32_t *adjacency);
+void DiskannDetachedFinishImport(DiskannHandle handle, uint32_t num_vectors, const std::vector<uint32_t> &entry_points);
+
+// Graph entry point labels.
+std::vector<uint32_t> DiskannDetachedGetEntryPoints(DiskannHandle handle);
+
+// Page fault callback: fill nodes [start, start+count) exactly as DiskannDetachedExportPage
+// wrote them. Must not throw; return 0 on success. May be called from Rust worker threads.
+typedef int32_t (*DiskannPageLoader)(void *ctx, uint32_t start, uint32_t count, float *out_vectors,
+                                     uint32_t *out_adjacency);
+
+// Open an empty detached index lazily: pages are faulted in through load(ctx, ...) on first access.
+// ctx must outlive the handle.
+void DiskannDetachedAttachPager(DiskannHandle handle, uint32_t num_vectors, const std::vector<uint32_t> &entry_points,
+                                DiskannPageLoader load, void *ctx);
+
+// Pages not yet faulted in (0 when fully resident).
+uint32_t DiskannDetachedNonresidentPages(DiskannHandle handle);
+
+// Fault in every page still on storage.
+void DiskannDetachedLoadAllPages(DiskannHandle handle);
+
+// Storage now holds the vectors of [0, num_persisted): an SQ8/PQ index drops them from
+// memory and reads them back through load(ctx, ...) to re-rank. Returns false if kept.
+bool DiskannDetachedEvictVectors(DiskannHandle handle, uint32_t num_persisted, DiskannPageLoader load, void *ctx);
+
+// Resident memory estimate in bytes (vectors, codes and loaded adjacency).
+uint64_t DiskannDetachedMemoryBytes(DiskannHandle handle);
+
+// Node pages and vectors faulted back in from storage since the index was opened.
+uint64_t DiskannDetachedPageLoads(DiskannHandle handle);
+
+// ========================================
+// Search counters (ann_index_stats)
+// ========================================
+
+// Totals since the index was created or loaded; layout shared with the Rust side.
+struct DiskannSearchStats {
+	uint64_t searches;              // Queries searched
+	uint64_t distance_computations; // Full-precision or code distances, re-ranking included
+	uint64_t hops;                  // Candidates whose neighbor list was expanded
+	uint64_t visited;               // Distinct nodes scored
+	uint64_t deleted_filtered;      // Tombstoned candidates skipped while collecting results
+	uint64_t gpu_dispatches;        // Lock-step batch iterations scored on the GPU
+	uint64_t cpu_dispatches;        // Lock-step batch iterations scored on the CPU
+};
+
+DiskannSearchStats DiskannDetachedSearchStats(DiskannHandle handle);
+
+// What the calling thread's searches (on any index) counted since its previous call
+DiskannSearchStats DiskannTakeSearchTally();
+
+// ========================================
+// Tombstones (deleted labels route searches but are never returned)
+// ========================================
+
+// Tombstone labels. Returns the number newly deleted.
+int64_t DiskannDetachedMarkDeleted(DiskannHandle handle, const std::vector<uint32_t> &labels);
+
+// Number of tombstoned labels.
+int64_t DiskannDetachedDeletedCount(DiskannHandle handle);
+
+// Tombstone bitmap: label l is bit l%64 of word l/64.
+std::vector<uint64_t> DiskannDetachedGetTombstones(DiskannHandle handle);
+void DiskannDetachedSetTombstones(DiskannHandle handle, const std::vector<uint64_t> &words);
+
 // ========================================
 // Streaming build API
 // ========================================
@@ -91,6 +221,88 @@ DiskannStreamingBuildResult DiskannStreamingBuild(const std::string &input_path,
 // SQ8 Quantization
 void DiskannDetachedQuantizeSQ8(DiskannHandle handle);
 bool DiskannDetachedIsQuantized(DiskannHandle handle);
+// Per-dimension min then scale (2 * dim floats); empty when SQ8 is not active.
+std::vector<float> DiskannDetachedGetSQ8Params(DiskannHandle handle);
+// Copy the codes (dim bytes each) of nodes [start, start + count) into out. Returns nodes copied.
+int64_t DiskannDetachedExportSQ8Codes(DiskannHandle handle, uint32_t start, uint32_t count, uint8_t *out,
+                                      int64_t capacity);
+void DiskannDetachedLoadSQ8(DiskannHandle handle, const std::vector<float> &params, const std::vector<uint8_t> &codes);
+
+// PQ Quantization: m = 0 picks about 4 dims per subspace, trained one per task on run (inline when null).
+// Throws if the index has fewer than 2^bits vectors or m does not divide the dimension.
+void DiskannDetachedQuantizePQ(DiskannHandle handle, int32_t m, int32_t bits, DiskannParallelFor run = nullptr,
+                               void *run_ctx = nullptr);
+bool DiskannDetachedIsPQ(DiskannHandle handle);
+// Candidates re-ranked on full precision per SQ8/PQ search (0 = 4 * k).
+void DiskannDetachedSetRerank(DiskannHandle handle, uint32_t rerank);
+int32_t DiskannDetachedPQCodeSize(DiskannHandle handle);
+std::vector<uint8_t> DiskannDetachedGetPQCodebook(DiskannHandle handle);
+// Copy the codes of nodes [start, start + count) into out. Returns nodes copied.
+int64_t DiskannDetachedExportPQCodes(DiskannHandle handle, uint32_t start, uint32_t count, uint8_t *out,
+                                     int64_t capacity);
+void DiskannDetachedLoadPQ(DiskannHandle handle, const std::vector<uint8_t> &codebook,
+                           const std::vector<uint8_t> &codes);
+
+// Half-precision vectors (format 1 = f16, 2 = bf16): every vector is also kept at half width
+// and searches score those copies directly, without re-ranking.
+void DiskannDetachedQuantizeHalf(DiskannHandle handle, uint8_t format);
+// 0 when the index keeps f32 vectors only.
+uint8_t DiskannDetachedHalfFormat(DiskannHandle handle);
+// Copy the half-width vectors (dim u16s each) of nodes [start, start + count) into out. Returns nodes copied.
+int64_t DiskannDetachedExportHalfCodes(DiskannHandle handle, uint32_t start, uint32_t count, uint16_t *out,
+                                       int64_t capacity);
+void DiskannDetachedLoadHalf(DiskannHandle handle, uint8_t format, const std::vector<uint16_t> &codes);
+// Widen n half-width values to f32.
+void DiskannHalfToFloat(uint8_t format, const uint16_t *src, uint64_t n, float *out);
+
+// ========================================
+// Disk-resident indexes (storage = 'disk')
+// ========================================
+
+// Opaque handle to a Rust DiskProvider: a read-only, mmap'd sector-aligned .diskann file
+typedef void *DiskannDiskHandle;
+
+// Open a .diskann file; cache_nodes nodes around the entry points stay in memory (negative = 64MB worth).
+// num_nodes >= 0 opens only the first num_nodes nodes (a later append that was never checkpointed is
+// skipped), negative opens all of them.
+DiskannDiskHandle DiskannDiskOpen(const std::string &path, int64_t cache_nodes, int64_t num_nodes);
+void DiskannDiskFree(DiskannDiskHandle handle);
+
+// Write base (may be null) followed by every node of delta to out_path (atomically) and open it. Delta label l
+// becomes DiskannDiskCount(base) + l; the tombstones of both carry over. Neither input is modified. The graph
+// repair runs as tasks on run (inline when null).
+DiskannDiskHandle DiskannDiskMerge(DiskannDiskHandle base, DiskannHandle delta, const std::string &out_path,
+                                   int64_t cache_nodes, DiskannParallelFor run = nullptr, void *run_ctx = nullptr);
+
+// Merge delta into base's own file at path: delta sectors appended, the touched base adjacency rows patched in
+// place. Returns a handle on the grown file (labels as for DiskannDiskMerge); base must still be freed.
+DiskannDiskHandle DiskannDiskAppend(DiskannDiskHandle base, DiskannHandle delta, const std::string &path,
+                                    int64_t cache_nodes, DiskannParallelFor run = nullptr, void *run_ctx = nullptr);
+
+// Nodes in the file, tombstones included.
+int64_t DiskannDiskCount(DiskannDiskHandle handle);
+
+// Search; filter_words (may be null) and exhaustive as for DiskannDetachedSearchFiltered. Returns results written.
+int32_t DiskannDiskSearch(DiskannDiskHandle handle, const float *query, int32_t dimension, int32_t k,
+                          int32_t search_complexity, const uint64_t *filter_words, int64_t num_words, bool exhaustive,
+                          int64_t *out_labels, float *out_distances);
+
+// Multi-query search; buffers as for DiskannDetachedSearchBatch.
+void DiskannDiskSearchBatch(DiskannDiskHandle handle, const float *query_matrix, int32_t nq, int32_t dimension,
+                            int32_t k, int32_t search_complexity, int64_t *out_labels, float *out_distances,
+                            int32_t *out_counts);
+
+// Tombstones, as for the detached handle.
+int64_t DiskannDiskMarkDeleted(DiskannDiskHandle handle, const std::vector<uint32_t> &labels);
+int64_t DiskannDiskDeletedCount(DiskannDiskHandle handle);
+std::vector<uint64_t> DiskannDiskGetTombstones(DiskannDiskHandle handle);
+void DiskannDiskSetTombstones(DiskannDiskHandle handle, const std::vector<uint64_t> &words);
+
+// Copy a node's vector. Returns dimension copied, or 0 if out of range.
+int32_t DiskannDiskGetVector(DiskannDiskHandle handle, uint32_t label, float *out_vec, int32_t capacity);
+
+// Resident bytes: the hot-node cache and the tombstones (not the mapped file).
+uint64_t DiskannDiskMemoryBytes(DiskannDiskHandle handle);
 
 // ========================================
 // Batch search (multi-query, GPU-accelerated for DiskIndex)
@@ -4,6 +4,7 @@
 
 #import <Metal/Metal.h>
 #import <Foundation/Foundation.h>
+#include <algorithm>
 #include <cstring>
 #include <mach/mach.h>
 
@@ -19,12 +20,31 @@ struct BufferSet {
     id<MTLBuffer> distances = nil;
     id<MTLBuffer> params = nil;
     id<MTLBuffer> query_map = nil; // multi-query: per-candidate query index
+    id<MTLBuffer> ids = nil;       // resident: per-candidate row id
     size_t query_capacity = 0;
     size_t candidates_capacity = 0;
     size_t distances_capacity = 0;
     size_t query_map_capacity = 0;
+    size_t ids_capacity = 0;
 };
 
+/// An index's vectors held on the device across dispatches (diskann_metal_resident_*).
+struct ResidentVectors {
+    id<MTLBuffer> buffer = nil;
+    size_t capacity = 0; // bytes
+    unsigned int rows = 0;
+    int dim = 0;
+};
+
+/// Drop our reference to a buffer this file created with new* (owned under MRC).
+static void release_buffer(id<MTLBuffer> buf) {
+#if !__has_feature(objc_arc)
+    [buf release];
+#else
+    (void)buf;
+#endif
+}
+
 /// Round up to next power of 2 (minimum 4096 = page size).
 static size_t next_pow2(size_t n) {
     if (n <= 4096)
@@ -46,6 +66,8 @@ struct DiskannMetalState {
     id<MTLComputePipelineState> ip_pipeline = nil;
     id<MTLComputePipelineState> multi_l2_pipeline = nil;
     id<MTLComputePipelineState> multi_ip_pipeline = nil;
+    id<MTLComputePipelineState> multi_l2_ids_pipeline = nil;
+    id<MTLComputePipelineState> multi_ip_ids_pipeline = nil;
     bool initialized = false;
 
     // Ring buffer pool: 3 pre-allocated buffer sets
@@ -77,7 +99,9 @@ struct DiskannMetalState {
             id<MTLFunction> ip_fn = [library newFunctionWithName:@"diskann_batch_ip"];
             id<MTLFunction> multi_l2_fn = [library newFunctionWithName:@"diskann_multi_batch_l2"];
             id<MTLFunction> multi_ip_fn = [library newFunctionWithName:@"diskann_multi_batch_ip"];
-            if (!l2_fn || !ip_fn || !multi_l2_fn || !multi_ip_fn)
+            id<MTLFunction> multi_l2_ids_fn = [library newFunctionWithName:@"diskann_multi_batch_l2_ids"];
+            id<MTLFunction> multi_ip_ids_fn = [library newFunctionWithName:@"diskann_multi_batch_ip_ids"];
+            if (!l2_fn || !ip_fn || !multi_l2_fn || !multi_ip_fn || !multi_l2_ids_fn || !multi_ip_ids_fn)
                 return false;
 
             l2_pipeline = [device newComputePipelineStateWithFunction:l2_fn error:&error];
@@ -96,6 +120,14 @@ struct DiskannMetalState {
             if (!multi_ip_pipeline)
                 return false;
 
+            multi_l2_ids_pipeline = [device newComputePipelineStateWithFunction:multi_l2_ids_fn error:&error];
+            if (!multi_l2_ids_pipeline)
+                return false;
+
+            multi_ip_ids_pipeline = [device newComputePipelineStateWithFunction:multi_ip_ids_fn error:&error];
+            if (!multi_ip_ids_pipeline)
+                return false;
+
             initialized = true;
         }
         return true;
@@ -322,4 +354,139 @@ extern "C" int diskann_metal_multi_batch_distances(const float *queries, const f
     return 0;
 }
 
+extern "C" void *diskann_metal_resident_create(const float *vectors, unsigned int n, int dim) {
+    if (dim <= 0 || (n > 0 && !vectors)) {
+        return nullptr;
+    }
+
+    auto &state = DiskannMetalState::instance();
+    if (!state.initialized && !state.init()) {
+        return nullptr;
+    }
+
+    auto *res = new ResidentVectors();
+    res->dim = dim;
+    if (diskann_metal_resident_write(res, vectors, 0, n) != 0) {
+        diskann_metal_resident_free(res);
+        return nullptr;
+    }
+    return res;
+}
+
+extern "C" int diskann_metal_resident_write(void *resident, const float *vectors, unsigned int first, unsigned int n) {
+    auto *res = static_cast<ResidentVectors *>(resident);
+    if (!res || first > res->rows || (n > 0 && !vectors)) {
+        return -1;
+    }
+
+    auto &state = DiskannMetalState::instance();
+    size_t row_size = (size_t)res->dim * sizeof(float);
+    size_t needed = ((size_t)first + n) * row_size;
+
+    @autoreleasepool {
+        // Grow by doubling; shared storage, so the old rows are a plain memcpy away.
+        // Dispatches wait for completion, so no command buffer still reads the old one.
+        if (!res->buffer || needed > res->capacity) {
+            size_t alloc_size = next_pow2(needed);
+            id<MTLBuffer> grown = [state.device newBufferWithLength:alloc_size options:MTLResourceStorageModeShared];
+            if (!grown) {
+                return -1;
+            }
+            if (res->buffer) {
+                memcpy([grown contents], [res->buffer contents], (size_t)res->rows * row_size);
+                release_buffer(res->buffer);
+            }
+            res->buffer = grown;
+            res->capacity = alloc_size;
+        }
+
+        if (n > 0) {
+            memcpy((char *)[res->buffer contents] + (size_t)first * row_size, vectors, (size_t)n * row_size);
+        }
+    }
+    res->rows = std::max(res->rows, first + n);
+    return 0;
+}
+
+extern "C" void diskann_metal_resident_free(void *resident) {
+    auto *res = static_cast<ResidentVectors *>(resident);
+    if (!res) {
+        return;
+    }
+    if (res->buffer) {
+        release_buffer(res->buffer);
+    }
+    delete res;
+}
+
+extern "C" int diskann_metal_resident_multi_batch_distances(void *resident, const float *queries,
+                                                            const unsigned int *ids, const unsigned int *query_map,
+                                                            int total_n, int nq, int metric, float *out_distances) {
+    auto *res = static_cast<ResidentVectors *>(resident);
+    if (!res || !res->buffer || total_n <= 0 || nq <= 0 || !queries || !ids || !query_map || !out_distances) {
+        return -1;
+    }
+
+    auto &state = DiskannMetalState::instance();
+    if (!state.initialized && !state.init()) {
+        return -1;
+    }
+
+    @autoreleasepool {
+        id<MTLComputePipelineState> pipeline =
+            (metric == 0) ? state.multi_l2_ids_pipeline : state.multi_ip_ids_pipeline;
+
+        size_t queries_size = (size_t)nq * res->dim * sizeof(float);
+        size_t ids_size = (size_t)total_n * sizeof(uint32_t);
+        size_t distances_size = (size_t)total_n * sizeof(float);
+
+        // The candidates buffer of the ring slot is not used: vectors are read by id
+        auto *bs = state.next_buffers(queries_size, 0, distances_size);
+        if (!bs) {
+            return -1;
+        }
+        if (!state.ensure_buffer(bs->ids, bs->ids_capacity, ids_size) ||
+            !state.ensure_buffer(bs->query_map, bs->query_map_capacity, ids_size)) {
+            return -1;
+        }
+
+        memcpy([bs->query contents], queries, queries_size);
+        memcpy([bs->ids contents], ids, ids_size);
+        memcpy([bs->query_map contents], query_map, ids_size);
+
+        struct {
+            uint32_t n;
+            uint32_t dim;
+        } params = {(uint32_t)total_n, (uint32_t)res->dim};
+        memcpy([bs->params contents], &params, sizeof(params));
+
+        id<MTLCommandBuffer> cmd_buf = [state.queue commandBuffer];
+        id<MTLComputeCommandEncoder> encoder = [cmd_buf computeCommandEncoder];
+
+        [encoder setComputePipelineState:pipeline];
+        [encoder setBuffer:bs->query offset:0 atIndex:0];     // queries
+        [encoder setBuffer:res->buffer offset:0 atIndex:1];   // resident vectors
+        [encoder setBuffer:bs->ids offset:0 atIndex:2];       // ids
+        [encoder setBuffer:bs->query_map offset:0 atIndex:3]; // query_map
+        [encoder setBuffer:bs->distances offset:0 atIndex:4]; // out_distances
+        [encoder setBuffer:bs->params offset:0 atIndex:5];    // params
+
+        MTLSize grid_size = MTLSizeMake(total_n, 1, 1);
+        MTLSize group_size = MTLSizeMake(32, 1, 1);
+        [encoder dispatchThreadgroups:grid_size threadsPerThreadgroup:group_size];
+
+        [encoder endEncoding];
+        [cmd_buf commit];
+        [cmd_buf waitUntilCompleted];
+
+        if (cmd_buf.status == MTLCommandBufferStatusError) {
+            return -1;
+        }
+
+        memcpy(out_distances, [bs->distances contents], distances_size);
+    }
+
+    return 0;
+}
+
 #endif // FAISS_METAL_ENABLED
@@ -23,4 +23,24 @@ extern "C" int diskann_metal_multi_batch_distances(const float * /*queries*/, co
 	return -1;
 }
 
+extern "C" void *diskann_metal_resident_create(const float * /*vectors*/, unsigned int /*n*/, int /*dim*/) {
+	return nullptr;
+}
+
+extern "C" int diskann_metal_resident_write(void * /*resident*/, const float * /*vectors*/, unsigned int /*first*/,
+                                            unsigned int /*n*/) {
+	return -1;
+}
+
+extern "C" void diskann_metal_resident_free(void * /*resident*/) {
+}
+
+extern "C" int diskann_metal_resident_multi_batch_distances(void * /*resident*/, const float * /*queries*/,
+                                                            const unsigned int * /*ids*/,
+                                                            const unsigned int * /*query_map*/, int /*total_n*/,
+                                                            int /*nq*/, int /*metric*/, float * /*out_distances*/
+) {
+	return -1;
+}
+
 #endif // !FAISS_METAL_ENABLED
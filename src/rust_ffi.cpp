@@ -1,6 +1,8 @@
 // Rust DiskANN FFI wrapper for DuckDB extension (detached handle API only)
 
 #include "rust_ffi.hpp"
+#include "duckdb/common/exception.hpp"
+#include <cstring>
 #include <limits>
 #include <stdexcept>
 #include <string>
@@ -30,10 +32,19 @@ void diskann_free_detached(void *handle);
 int64_t diskann_detached_add(void *handle, const float *vector_ptr, int32_t dimension, char *err_buf,
                              int32_t err_buf_len);
 
+int64_t diskann_detached_add_batch(void *handle, const float *matrix, int64_t n, int32_t dimension,
+                                   int64_t *out_labels, duckdb::DiskannParallelFor run, void *run_ctx, char *err_buf,
+                                   int32_t err_buf_len);
+
 int32_t diskann_detached_search(void *handle, const float *query_ptr, int32_t dimension, int32_t k,
                                 int32_t search_complexity, int64_t *out_labels, float *out_distances, char *err_buf,
                                 int32_t err_buf_len);
 
+int32_t diskann_detached_search_filtered(void *handle, const float *query_ptr, int32_t dimension, int32_t k,
+                                         int32_t search_complexity, const uint64_t *filter_words, int64_t num_words,
+                                         int32_t exhaustive, int64_t *out_labels, float *out_distances, char *err_buf,
+                                         int32_t err_buf_len);
+
 int64_t diskann_detached_count(void *handle);
 
 DiskannBytes diskann_detached_serialize(void *handle, char *err_buf, int32_t err_buf_len);
@@ -42,30 +53,114 @@ void *diskann_detached_deserialize(const uint8_t *data, size_t len, float alpha,
 
 void diskann_free_bytes(DiskannBytes bytes);
 
-// Compact / vacuum
-struct DiskannCompactResultFFI {
-	void *new_handle;
-	uint32_t *label_map;
-	size_t map_len;
-};
+// In-place delete consolidation / vacuum
+// Graph merge
+int64_t diskann_detached_merge(void *handle, void *other, duckdb::DiskannParallelFor run, void *run_ctx,
+                               char *err_buf, int32_t err_buf_len);
 
-DiskannCompactResultFFI diskann_detached_compact(void *handle, const uint32_t *deleted_labels, size_t num_deleted,
-                                                 char *err_buf, int32_t err_buf_len);
+struct DiskannConsolidateProgressFFI {
+	uint64_t visited;
+	uint64_t freed;
+	uint64_t remaining;
+	int32_t done;
+};
 
-void diskann_free_label_map(uint32_t *map, size_t map_len);
+int32_t diskann_detached_consolidate(void *handle, uint64_t max_nodes, duckdb::DiskannParallelFor run, void *run_ctx,
+                                     DiskannConsolidateProgressFFI *out, char *err_buf, int32_t err_buf_len);
+int64_t diskann_detached_get_free_slots(void *handle, uint32_t *out, int64_t capacity);
+void diskann_detached_set_free_slots(void *handle, const uint32_t *slots, int64_t n);
+
+// Paged persistence
+uint32_t diskann_page_nodes();
+int64_t diskann_detached_take_dirty_pages(void *handle, uint32_t *out_pages, int64_t capacity, char *err_buf,
+                                          int32_t err_buf_len);
+int64_t diskann_detached_take_dirty_vector_pages(void *handle, uint32_t *out_pages, int64_t capacity, char *err_buf,
+                                                 int32_t err_buf_len);
+int32_t diskann_detached_export_page(void *handle, uint32_t start, uint32_t count, float *out_vectors,
+                                     uint32_t *out_adjacency, char *err_buf, int32_t err_buf_len);
+int32_t diskann_detached_import_page(void *handle, uint32_t start, uint32_t count, const float *vectors,
+                                     const uint32_t *adjacency, char *err_buf, int32_t err_buf_len);
+int32_t diskann_detached_finish_import(void *handle, uint32_t num_vectors, const uint32_t *entry_points,
+                                       uint32_t num_entry_points, char *err_buf, int32_t err_buf_len);
+int32_t diskann_detached_get_entry_points(void *handle, uint32_t *out, int32_t capacity);
+int32_t diskann_detached_attach_pager(void *handle, uint32_t num_vectors, const uint32_t *entry_points,
+                                      uint32_t num_entry_points, duckdb::DiskannPageLoader load, void *ctx,
+                                      char *err_buf, int32_t err_buf_len);
+uint32_t diskann_detached_nonresident_pages(void *handle);
+int64_t diskann_detached_mark_deleted(void *handle, const uint32_t *labels, int64_t n);
+int64_t diskann_detached_deleted_count(void *handle);
+int64_t diskann_detached_get_tombstones(void *handle, uint64_t *out, int64_t capacity);
+void diskann_detached_set_tombstones(void *handle, const uint64_t *words, int64_t num_words);
+int32_t diskann_detached_load_all_pages(void *handle, char *err_buf, int32_t err_buf_len);
+int32_t diskann_detached_evict_vectors(void *handle, uint32_t num_persisted, duckdb::DiskannPageLoader load, void *ctx);
+uint64_t diskann_detached_memory_bytes(void *handle);
+uint64_t diskann_detached_page_loads(void *handle);
+void diskann_detached_search_stats(void *handle, duckdb::DiskannSearchStats *out);
+void diskann_take_search_tally(duckdb::DiskannSearchStats *out);
 
 // Vector accessor
 int32_t diskann_detached_get_vector(void *handle, uint32_t label, float *out_vec, int32_t out_capacity);
 
+// Distance kernels
+void diskann_compute_distances(const float *query, const float *candidates, uint64_t n, uint32_t dim, int32_t metric,
+                               float *out);
+
 // SQ8 Quantization
 int32_t diskann_detached_quantize_sq8(void *handle);
 int32_t diskann_detached_is_quantized(void *handle);
+int64_t diskann_detached_get_sq8_params(void *handle, float *out, int64_t capacity);
+int64_t diskann_detached_export_sq8_codes(void *handle, uint32_t start, uint32_t count, uint8_t *out,
+                                          int64_t capacity);
+int32_t diskann_detached_load_sq8(void *handle, const float *params, int64_t num_params, const uint8_t *codes,
+                                  int64_t codes_len);
+
+// PQ Quantization
+int32_t diskann_detached_quantize_pq(void *handle, int32_t m, int32_t bits, duckdb::DiskannParallelFor run, void *run_ctx,
+                                    char *err_buf, int32_t err_buf_len);
+int32_t diskann_detached_is_pq(void *handle);
+void diskann_detached_set_rerank(void *handle, uint32_t rerank);
+int32_t diskann_detached_pq_code_size(void *handle);
+int64_t diskann_detached_get_pq_codebook(void *handle, uint8_t *out, int64_t capacity);
+int64_t diskann_detached_export_pq_codes(void *handle, uint32_t start, uint32_t count, uint8_t *out, int64_t capacity);
+int32_t diskann_detached_load_pq(void *handle, const uint8_t *codebook, int64_t codebook_len, const uint8_t *codes,
+                                 int64_t codes_len, char *err_buf, int32_t err_buf_len);
+
+// Half-precision vectors
+int32_t diskann_detached_quantize_half(void *handle, uint8_t format, char *err_buf, int32_t err_buf_len);
+uint8_t diskann_detached_half_format(void *handle);
+int64_t diskann_detached_export_half_codes(void *handle, uint32_t start, uint32_t count, uint16_t *out,
+                                           int64_t capacity);
+int32_t diskann_detached_load_half(void *handle, uint8_t format, const uint16_t *codes, int64_t codes_len);
+int32_t diskann_half_to_float(uint8_t format, const uint16_t *src, uint64_t n, float *out);
 
 // Detached batch search (multi-query, GPU-accelerated)
 int32_t diskann_detached_search_batch(void *handle, const float *query_matrix, int32_t nq, int32_t dimension, int32_t k,
                                       int32_t search_complexity, int64_t *out_labels, float *out_distances,
                                       int32_t *out_counts, char *err_buf, int32_t err_buf_len);
 
+// Disk-resident index FFI (storage = 'disk')
+void *diskann_disk_open(const char *path, int64_t cache_nodes, int64_t num_nodes, char *err_buf,
+                        int32_t err_buf_len);
+void diskann_disk_free(void *handle);
+void *diskann_disk_merge(void *base, void *delta, const char *out_path, int64_t cache_nodes,
+                         duckdb::DiskannParallelFor run, void *run_ctx, char *err_buf, int32_t err_buf_len);
+void *diskann_disk_append(void *base, void *delta, const char *path, int64_t cache_nodes,
+                          duckdb::DiskannParallelFor run, void *run_ctx, char *err_buf, int32_t err_buf_len);
+int64_t diskann_disk_count(void *handle);
+int32_t diskann_disk_search(void *handle, const float *query_ptr, int32_t dimension, int32_t k,
+                            int32_t search_complexity, const uint64_t *filter_words, int64_t num_words,
+                            int32_t exhaustive, int64_t *out_labels, float *out_distances, char *err_buf,
+                            int32_t err_buf_len);
+int32_t diskann_disk_search_batch(void *handle, const float *query_matrix, int32_t nq, int32_t dimension, int32_t k,
+                                  int32_t search_complexity, int64_t *out_labels, float *out_distances,
+                                  int32_t *out_counts, char *err_buf, int32_t err_buf_len);
+int64_t diskann_disk_mark_deleted(void *handle, const uint32_t *labels, int64_t n);
+int64_t diskann_disk_deleted_count(void *handle);
+int64_t diskann_disk_get_tombstones(void *handle, uint64_t *out, int64_t capacity);
+void diskann_disk_set_tombstones(void *handle, const uint64_t *words, int64_t num_words);
+int32_t diskann_disk_get_vector(void *handle, uint32_t label, float *out_vec, int32_t out_capacity);
+uint64_t diskann_disk_memory_bytes(void *handle);
+
 // Batch search (multi-query, global registry)
 int32_t diskann_batch_search_buf(const char *name, const float *query_matrix, int32_t nq, int32_t dimension, int32_t k,
                                  int32_t search_complexity, int64_t *out_labels, float *out_distances,
@@ -76,6 +171,17 @@ namespace duckdb {
 
 constexpr int ERR_BUF_LEN = 512;
 
+// Prefix of Rust errors from an operation whose page loads failed (PAGE_LOAD_ERROR in provider.rs)
+static constexpr const char PAGE_LOAD_ERROR[] = "page load failed: ";
+
+// Storage read failures surface as I/O errors, anything else as a plain runtime error
+[[noreturn]] static void ThrowRustError(const char *operation, const char *err_buf) {
+	if (strncmp(err_buf, PAGE_LOAD_ERROR, sizeof(PAGE_LOAD_ERROR) - 1) == 0) {
+		throw IOException("%s: %s", operation, err_buf);
+	}
+	throw std::runtime_error(std::string(operation) + ": " + err_buf);
+}
+
 // ========================================
 // Streaming build wrapper
 // ========================================
@@ -91,7 +197,7 @@ DiskannStreamingBuildResult DiskannStreamingBuild(const std::string &input_path,
 	                                         build_complexity, alpha, sample_size, &out_num_vectors, &out_dimension,
 	                                         &out_sample_size, err_buf, ERR_BUF_LEN);
 	if (rc != 0) {
-		throw std::runtime_error("DiskANN streaming build: " + std::string(err_buf));
+		ThrowRustError("DiskANN streaming build", err_buf);
 	}
 	return {out_num_vectors, out_dimension, out_sample_size};
 }
@@ -106,7 +212,7 @@ DiskannHandle DiskannCreateDetached(int32_t dimension, const std::string &metric
 	auto handle =
 	    diskann_create_detached(dimension, metric.c_str(), max_degree, build_complexity, alpha, err_buf, ERR_BUF_LEN);
 	if (!handle) {
-		throw std::runtime_error("DiskANN create detached: " + std::string(err_buf));
+		ThrowRustError("DiskANN create detached", err_buf);
 	}
 	return handle;
 }
@@ -119,18 +225,40 @@ int64_t DiskannDetachedAdd(DiskannHandle handle, const float *vector, int32_t di
 	char err_buf[ERR_BUF_LEN] = {0};
 	int64_t label = diskann_detached_add(handle, vector, dimension, err_buf, ERR_BUF_LEN);
 	if (label < 0) {
-		throw std::runtime_error("DiskANN detached add: " + std::string(err_buf));
+		ThrowRustError("DiskANN detached add", err_buf);
 	}
 	return label;
 }
 
+void DiskannDetachedAddBatch(DiskannHandle handle, const float *matrix, int64_t n, int32_t dimension,
+                             int64_t *out_labels, DiskannParallelFor run, void *run_ctx) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	int64_t added =
+	    diskann_detached_add_batch(handle, matrix, n, dimension, out_labels, run, run_ctx, err_buf, ERR_BUF_LEN);
+	if (added < 0) {
+		ThrowRustError("DiskANN detached add batch", err_buf);
+	}
+}
+
 int32_t DiskannDetachedSearch(DiskannHandle handle, const float *query, int32_t dimension, int32_t k,
                               int32_t search_complexity, int64_t *out_labels, float *out_distances) {
 	char err_buf[ERR_BUF_LEN] = {0};
 	int32_t n = diskann_detached_search(handle, query, dimension, k, search_complexity, out_labels, out_distances,
 	                                    err_buf, ERR_BUF_LEN);
 	if (n < 0) {
-		throw std::runtime_error("DiskANN detached search: " + std::string(err_buf));
+		ThrowRustError("DiskANN detached search", err_buf);
+	}
+	return n;
+}
+
+int32_t DiskannDetachedSearchFiltered(DiskannHandle handle, const float *query, int32_t dimension, int32_t k,
+                                      int32_t search_complexity, const uint64_t *filter_words, int64_t num_words,
+                                      bool exhaustive, int64_t *out_labels, float *out_distances) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	int32_t n = diskann_detached_search_filtered(handle, query, dimension, k, search_complexity, filter_words, num_words,
+	                                             exhaustive ? 1 : 0, out_labels, out_distances, err_buf, ERR_BUF_LEN);
+	if (n < 0) {
+		ThrowRustError("DiskANN detached filtered search", err_buf);
 	}
 	return n;
 }
@@ -143,7 +271,7 @@ DiskannSerializedData DiskannDetachedSerialize(DiskannHandle handle) {
 	char err_buf[ERR_BUF_LEN] = {0};
 	auto result = diskann_detached_serialize(handle, err_buf, ERR_BUF_LEN);
 	if (!result.data) {
-		throw std::runtime_error("DiskANN serialize: " + std::string(err_buf));
+		ThrowRustError("DiskANN serialize", err_buf);
 	}
 	return {result.data, result.len};
 }
@@ -152,7 +280,7 @@ DiskannHandle DiskannDetachedDeserialize(const uint8_t *data, size_t len, float
 	char err_buf[ERR_BUF_LEN] = {0};
 	auto handle = diskann_detached_deserialize(data, len, alpha, err_buf, ERR_BUF_LEN);
 	if (!handle) {
-		throw std::runtime_error("DiskANN deserialize: " + std::string(err_buf));
+		ThrowRustError("DiskANN deserialize", err_buf);
 	}
 	return handle;
 }
@@ -165,20 +293,43 @@ void DiskannFreeSerializedBytes(DiskannSerializedData bytes) {
 }
 
 // ========================================
-// Compact / vacuum wrappers
+// Graph merge wrapper
 // ========================================
 
-DiskannCompactResult DiskannDetachedCompact(DiskannHandle handle, const uint32_t *deleted_labels, size_t num_deleted) {
+uint32_t DiskannDetachedMerge(DiskannHandle handle, DiskannHandle other, DiskannParallelFor run, void *run_ctx) {
 	char err_buf[ERR_BUF_LEN] = {0};
-	auto result = diskann_detached_compact(handle, deleted_labels, num_deleted, err_buf, ERR_BUF_LEN);
-	if (!result.new_handle) {
-		throw std::runtime_error("DiskANN compact: " + std::string(err_buf));
+	int64_t offset = diskann_detached_merge(handle, other, run, run_ctx, err_buf, ERR_BUF_LEN);
+	if (offset < 0) {
+		ThrowRustError("DiskANN merge", err_buf);
 	}
-	return {result.new_handle, result.label_map, result.map_len};
+	return static_cast<uint32_t>(offset);
 }
 
-void DiskannFreeLabelMap(uint32_t *map, size_t map_len) {
-	diskann_free_label_map(map, map_len);
+// ========================================
+// In-place delete consolidation wrappers
+// ========================================
+
+DiskannConsolidateProgress DiskannDetachedConsolidate(DiskannHandle handle, uint64_t max_nodes,
+                                                      DiskannParallelFor run, void *run_ctx) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	DiskannConsolidateProgressFFI out {};
+	if (diskann_detached_consolidate(handle, max_nodes, run, run_ctx, &out, err_buf, ERR_BUF_LEN) != 0) {
+		ThrowRustError("DiskANN consolidate", err_buf);
+	}
+	return {out.visited, out.freed, out.remaining, out.done != 0};
+}
+
+std::vector<uint32_t> DiskannDetachedGetFreeSlots(DiskannHandle handle) {
+	auto n = diskann_detached_get_free_slots(handle, nullptr, 0);
+	std::vector<uint32_t> slots(static_cast<size_t>(n > 0 ? n : 0));
+	if (!slots.empty()) {
+		diskann_detached_get_free_slots(handle, slots.data(), static_cast<int64_t>(slots.size()));
+	}
+	return slots;
+}
+
+void DiskannDetachedSetFreeSlots(DiskannHandle handle, const std::vector<uint32_t> &slots) {
+	diskann_detached_set_free_slots(handle, slots.data(), static_cast<int64_t>(slots.size()));
 }
 
 // ========================================
@@ -189,6 +340,152 @@ int32_t DiskannDetachedGetVector(DiskannHandle handle, uint32_t label, float *ou
 	return diskann_detached_get_vector(handle, label, out_vec, capacity);
 }
 
+// ========================================
+// Distance kernels
+// ========================================
+
+void DiskannComputeDistances(const float *query, const float *candidates, uint64_t n, uint32_t dim, int32_t metric,
+                             float *out) {
+	diskann_compute_distances(query, candidates, n, dim, metric, out);
+}
+
+// ========================================
+// Paged persistence wrappers
+// ========================================
+
+uint32_t DiskannPageNodes() {
+	return diskann_page_nodes();
+}
+
+using TakeDirtyPagesFn = int64_t (*)(void *, uint32_t *, int64_t, char *, int32_t);
+
+static std::vector<uint32_t> TakeDirtyPages(DiskannHandle handle, TakeDirtyPagesFn take) {
+	auto count = diskann_detached_count(handle);
+	auto page_nodes = diskann_page_nodes();
+	std::vector<uint32_t> pages(static_cast<size_t>((count + page_nodes - 1) / page_nodes) + 1);
+	char err_buf[ERR_BUF_LEN] = {0};
+	auto n = take(handle, pages.data(), static_cast<int64_t>(pages.size()), err_buf, ERR_BUF_LEN);
+	if (n < 0) {
+		ThrowRustError("DiskANN take dirty pages", err_buf);
+	}
+	pages.resize(static_cast<size_t>(n));
+	return pages;
+}
+
+std::vector<uint32_t> DiskannDetachedTakeDirtyPages(DiskannHandle handle) {
+	return TakeDirtyPages(handle, diskann_detached_take_dirty_pages);
+}
+
+std::vector<uint32_t> DiskannDetachedTakeDirtyVectorPages(DiskannHandle handle) {
+	return TakeDirtyPages(handle, diskann_detached_take_dirty_vector_pages);
+}
+
+void DiskannDetachedExportPage(DiskannHandle handle, uint32_t start, uint32_t count, float *out_vectors,
+                               uint32_t *out_adjacency) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	if (diskann_detached_export_page(handle, start, count, out_vectors, out_adjacency, err_buf, ERR_BUF_LEN) != 0) {
+		ThrowRustError("DiskANN export page", err_buf);
+	}
+}
+
+void DiskannDetachedImportPage(DiskannHandle handle, uint32_t start, uint32_t count, const float *vectors,
+                               const uint32_t *adjacency) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	if (diskann_detached_import_page(handle, start, count, vectors, adjacency, err_buf, ERR_BUF_LEN) != 0) {
+		ThrowRustError("DiskANN import page", err_buf);
+	}
+}
+
+void DiskannDetachedFinishImport(DiskannHandle handle, uint32_t num_vectors, const std::vector<uint32_t> &entry_points) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	if (diskann_detached_finish_import(handle, num_vectors, entry_points.data(),
+	                                   static_cast<uint32_t>(entry_points.size()), err_buf, ERR_BUF_LEN) != 0) {
+		ThrowRustError("DiskANN finish import", err_buf);
+	}
+}
+
+std::vector<uint32_t> DiskannDetachedGetEntryPoints(DiskannHandle handle) {
+	auto n = diskann_detached_get_entry_points(handle, nullptr, 0);
+	std::vector<uint32_t> eps(static_cast<size_t>(n > 0 ? n : 0));
+	if (!eps.empty()) {
+		diskann_detached_get_entry_points(handle, eps.data(), static_cast<int32_t>(eps.size()));
+	}
+	return eps;
+}
+
+void DiskannDetachedAttachPager(DiskannHandle handle, uint32_t num_vectors, const std::vector<uint32_t> &entry_points,
+                                DiskannPageLoader load, void *ctx) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	if (diskann_detached_attach_pager(handle, num_vectors, entry_points.data(),
+	                                  static_cast<uint32_t>(entry_points.size()), load, ctx, err_buf,
+	                                  ERR_BUF_LEN) != 0) {
+		ThrowRustError("DiskANN attach pager", err_buf);
+	}
+}
+
+uint32_t DiskannDetachedNonresidentPages(DiskannHandle handle) {
+	return diskann_detached_nonresident_pages(handle);
+}
+
+void DiskannDetachedLoadAllPages(DiskannHandle handle) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	if (diskann_detached_load_all_pages(handle, err_buf, ERR_BUF_LEN) != 0) {
+		ThrowRustError("DiskANN load pages", err_buf);
+	}
+}
+
+bool DiskannDetachedEvictVectors(DiskannHandle handle, uint32_t num_persisted, DiskannPageLoader load, void *ctx) {
+	return diskann_detached_evict_vectors(handle, num_persisted, load, ctx) != 0;
+}
+
+uint64_t DiskannDetachedMemoryBytes(DiskannHandle handle) {
+	return diskann_detached_memory_bytes(handle);
+}
+
+uint64_t DiskannDetachedPageLoads(DiskannHandle handle) {
+	return diskann_detached_page_loads(handle);
+}
+
+DiskannSearchStats DiskannDetachedSearchStats(DiskannHandle handle) {
+	DiskannSearchStats stats {};
+	diskann_detached_search_stats(handle, &stats);
+	return stats;
+}
+
+DiskannSearchStats DiskannTakeSearchTally() {
+	DiskannSearchStats stats {};
+	diskann_take_search_tally(&stats);
+	return stats;
+}
+
+// ========================================
+// Tombstone wrappers
+// ========================================
+
+int64_t DiskannDetachedMarkDeleted(DiskannHandle handle, const std::vector<uint32_t> &labels) {
+	if (labels.empty()) {
+		return 0;
+	}
+	return diskann_detached_mark_deleted(handle, labels.data(), static_cast<int64_t>(labels.size()));
+}
+
+int64_t DiskannDetachedDeletedCount(DiskannHandle handle) {
+	return diskann_detached_deleted_count(handle);
+}
+
+std::vector<uint64_t> DiskannDetachedGetTombstones(DiskannHandle handle) {
+	auto n = diskann_detached_get_tombstones(handle, nullptr, 0);
+	std::vector<uint64_t> words(static_cast<size_t>(n > 0 ? n : 0));
+	if (!words.empty()) {
+		diskann_detached_get_tombstones(handle, words.data(), static_cast<int64_t>(words.size()));
+	}
+	return words;
+}
+
+void DiskannDetachedSetTombstones(DiskannHandle handle, const std::vector<uint64_t> &words) {
+	diskann_detached_set_tombstones(handle, words.data(), static_cast<int64_t>(words.size()));
+}
+
 // ========================================
 // SQ8 Quantization wrappers
 // ========================================
@@ -201,6 +498,105 @@ bool DiskannDetachedIsQuantized(DiskannHandle handle) {
 	return diskann_detached_is_quantized(handle) != 0;
 }
 
+std::vector<float> DiskannDetachedGetSQ8Params(DiskannHandle handle) {
+	auto n = diskann_detached_get_sq8_params(handle, nullptr, 0);
+	std::vector<float> params(static_cast<size_t>(n > 0 ? n : 0));
+	if (!params.empty()) {
+		diskann_detached_get_sq8_params(handle, params.data(), static_cast<int64_t>(params.size()));
+	}
+	return params;
+}
+
+int64_t DiskannDetachedExportSQ8Codes(DiskannHandle handle, uint32_t start, uint32_t count, uint8_t *out,
+                                      int64_t capacity) {
+	return diskann_detached_export_sq8_codes(handle, start, count, out, capacity);
+}
+
+void DiskannDetachedLoadSQ8(DiskannHandle handle, const std::vector<float> &params, const std::vector<uint8_t> &codes) {
+	if (diskann_detached_load_sq8(handle, params.data(), static_cast<int64_t>(params.size()), codes.data(),
+	                              static_cast<int64_t>(codes.size())) != 0) {
+		throw std::runtime_error("DiskANN load SQ8: parameter count does not match the dimension");
+	}
+}
+
+// ========================================
+// PQ Quantization wrappers
+// ========================================
+
+void DiskannDetachedQuantizePQ(DiskannHandle handle, int32_t m, int32_t bits, DiskannParallelFor run, void *run_ctx) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	if (diskann_detached_quantize_pq(handle, m, bits, run, run_ctx, err_buf, ERR_BUF_LEN) != 0) {
+		ThrowRustError("DiskANN quantize PQ", err_buf);
+	}
+}
+
+bool DiskannDetachedIsPQ(DiskannHandle handle) {
+	return diskann_detached_is_pq(handle) != 0;
+}
+
+void DiskannDetachedSetRerank(DiskannHandle handle, uint32_t rerank) {
+	diskann_detached_set_rerank(handle, rerank);
+}
+
+int32_t DiskannDetachedPQCodeSize(DiskannHandle handle) {
+	return diskann_detached_pq_code_size(handle);
+}
+
+std::vector<uint8_t> DiskannDetachedGetPQCodebook(DiskannHandle handle) {
+	auto n = diskann_detached_get_pq_codebook(handle, nullptr, 0);
+	std::vector<uint8_t> codebook(static_cast<size_t>(n > 0 ? n : 0));
+	if (!codebook.empty()) {
+		diskann_detached_get_pq_codebook(handle, codebook.data(), static_cast<int64_t>(codebook.size()));
+	}
+	return codebook;
+}
+
+int64_t DiskannDetachedExportPQCodes(DiskannHandle handle, uint32_t start, uint32_t count, uint8_t *out,
+                                     int64_t capacity) {
+	return diskann_detached_export_pq_codes(handle, start, count, out, capacity);
+}
+
+void DiskannDetachedLoadPQ(DiskannHandle handle, const std::vector<uint8_t> &codebook,
+                           const std::vector<uint8_t> &codes) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	if (diskann_detached_load_pq(handle, codebook.data(), static_cast<int64_t>(codebook.size()), codes.data(),
+	                             static_cast<int64_t>(codes.size()), err_buf, ERR_BUF_LEN) != 0) {
+		ThrowRustError("DiskANN load PQ", err_buf);
+	}
+}
+
+// ========================================
+// Half-precision vector wrappers
+// ========================================
+
+void DiskannDetachedQuantizeHalf(DiskannHandle handle, uint8_t format) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	if (diskann_detached_quantize_half(handle, format, err_buf, ERR_BUF_LEN) != 0) {
+		ThrowRustError("DiskANN half precision", err_buf);
+	}
+}
+
+uint8_t DiskannDetachedHalfFormat(DiskannHandle handle) {
+	return diskann_detached_half_format(handle);
+}
+
+int64_t DiskannDetachedExportHalfCodes(DiskannHandle handle, uint32_t start, uint32_t count, uint16_t *out,
+                                       int64_t capacity) {
+	return diskann_detached_export_half_codes(handle, start, count, out, capacity);
+}
+
+void DiskannDetachedLoadHalf(DiskannHandle handle, uint8_t format, const std::vector<uint16_t> &codes) {
+	if (diskann_detached_load_half(handle, format, codes.data(), static_cast<int64_t>(codes.size())) != 0) {
+		throw std::runtime_error("DiskANN load half precision: unknown format " + std::to_string(format));
+	}
+}
+
+void DiskannHalfToFloat(uint8_t format, const uint16_t *src, uint64_t n, float *out) {
+	if (diskann_half_to_float(format, src, n, out) != 0) {
+		throw std::runtime_error("DiskANN half precision: unknown format " + std::to_string(format));
+	}
+}
+
 // ========================================
 // Detached batch search wrapper
 // ========================================
@@ -212,11 +608,107 @@ int32_t DiskannDetachedSearchBatch(DiskannHandle handle, const float *query_matr
 	int32_t rc = diskann_detached_search_batch(handle, query_matrix, nq, dimension, k, search_complexity, out_labels,
 	                                           out_distances, out_counts, err_buf, ERR_BUF_LEN);
 	if (rc != 0) {
-		throw std::runtime_error("DiskANN detached batch search: " + std::string(err_buf));
+		ThrowRustError("DiskANN detached batch search", err_buf);
 	}
 	return 0;
 }
 
+// ========================================
+// Disk-resident index wrappers
+// ========================================
+
+DiskannDiskHandle DiskannDiskOpen(const std::string &path, int64_t cache_nodes, int64_t num_nodes) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	auto handle = diskann_disk_open(path.c_str(), cache_nodes, num_nodes, err_buf, ERR_BUF_LEN);
+	if (!handle) {
+		ThrowRustError("DiskANN disk open", err_buf);
+	}
+	return handle;
+}
+
+void DiskannDiskFree(DiskannDiskHandle handle) {
+	diskann_disk_free(handle);
+}
+
+DiskannDiskHandle DiskannDiskMerge(DiskannDiskHandle base, DiskannHandle delta, const std::string &out_path,
+                                   int64_t cache_nodes, DiskannParallelFor run, void *run_ctx) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	auto handle = diskann_disk_merge(base, delta, out_path.c_str(), cache_nodes, run, run_ctx, err_buf, ERR_BUF_LEN);
+	if (!handle) {
+		ThrowRustError("DiskANN disk merge", err_buf);
+	}
+	return handle;
+}
+
+DiskannDiskHandle DiskannDiskAppend(DiskannDiskHandle base, DiskannHandle delta, const std::string &path,
+                                    int64_t cache_nodes, DiskannParallelFor run, void *run_ctx) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	auto handle = diskann_disk_append(base, delta, path.c_str(), cache_nodes, run, run_ctx, err_buf, ERR_BUF_LEN);
+	if (!handle) {
+		ThrowRustError("DiskANN disk append", err_buf);
+	}
+	return handle;
+}
+
+int64_t DiskannDiskCount(DiskannDiskHandle handle) {
+	return diskann_disk_count(handle);
+}
+
+int32_t DiskannDiskSearch(DiskannDiskHandle handle, const float *query, int32_t dimension, int32_t k,
+                          int32_t search_complexity, const uint64_t *filter_words, int64_t num_words, bool exhaustive,
+                          int64_t *out_labels, float *out_distances) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	int32_t n = diskann_disk_search(handle, query, dimension, k, search_complexity, filter_words, num_words,
+	                                exhaustive ? 1 : 0, out_labels, out_distances, err_buf, ERR_BUF_LEN);
+	if (n < 0) {
+		ThrowRustError("DiskANN disk search", err_buf);
+	}
+	return n;
+}
+
+void DiskannDiskSearchBatch(DiskannDiskHandle handle, const float *query_matrix, int32_t nq, int32_t dimension,
+                            int32_t k, int32_t search_complexity, int64_t *out_labels, float *out_distances,
+                            int32_t *out_counts) {
+	char err_buf[ERR_BUF_LEN] = {0};
+	int32_t rc = diskann_disk_search_batch(handle, query_matrix, nq, dimension, k, search_complexity, out_labels,
+	                                       out_distances, out_counts, err_buf, ERR_BUF_LEN);
+	if (rc != 0) {
+		ThrowRustError("DiskANN disk batch search", err_buf);
+	}
+}
+
+int64_t DiskannDiskMarkDeleted(DiskannDiskHandle handle, const std::vector<uint32_t> &labels) {
+	if (labels.empty()) {
+		return 0;
+	}
+	return diskann_disk_mark_deleted(handle, labels.data(), static_cast<int64_t>(labels.size()));
+}
+
+int64_t DiskannDiskDeletedCount(DiskannDiskHandle handle) {
+	return diskann_disk_deleted_count(handle);
+}
+
+std::vector<uint64_t> DiskannDiskGetTombstones(DiskannDiskHandle handle) {
+	auto n = diskann_disk_get_tombstones(handle, nullptr, 0);
+	std::vector<uint64_t> words(static_cast<size_t>(n > 0 ? n : 0));
+	if (!words.empty()) {
+		diskann_disk_get_tombstones(handle, words.data(), static_cast<int64_t>(words.size()));
+	}
+	return words;
+}
+
+void DiskannDiskSetTombstones(DiskannDiskHandle handle, const std::vector<uint64_t> &words) {
+	diskann_disk_set_tombstones(handle, words.data(), static_cast<int64_t>(words.size()));
+}
+
+int32_t DiskannDiskGetVector(DiskannDiskHandle handle, uint32_t label, float *out_vec, int32_t capacity) {
+	return diskann_disk_get_vector(handle, label, out_vec, capacity);
+}
+
+uint64_t DiskannDiskMemoryBytes(DiskannDiskHandle handle) {
+	return diskann_disk_memory_bytes(handle);
+}
+
 // ========================================
 // Global registry batch search wrapper
 // ========================================
@@ -233,7 +725,7 @@ DiskannBatchSearchResult DiskannBatchSearch(const std::string &name, const float
 	    diskann_batch_search_buf(name.c_str(), query_matrix, nq, dimension, k, search_complexity, result.labels.data(),
 	                             result.distances.data(), result.counts.data(), err_buf, ERR_BUF_LEN);
 	if (rc != 0) {
-		throw std::runtime_error("DiskANN batch search: " + std::string(err_buf));
+		ThrowRustError("DiskANN batch search", err_buf);
 	}
 	return result;
 }